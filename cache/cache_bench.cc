@@ -22,15 +22,21 @@ int main() {
 #include "util/gflags_compat.h"
 #include "util/mutexlock.h"
 #include "util/random.h"
+#include "util/string_util.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 
 static const uint32_t KB = 1024;
 
 DEFINE_int32(threads, 16, "Number of concurrent threads to run.");
+DEFINE_string(threads_list, "",
+              "If set, a comma-separated list of thread counts to run the "
+              "benchmark with, one after the other, instead of --threads.");
 DEFINE_int64(cache_size, 8 * KB * KB,
              "Number of bytes to use as a cache of uncompressed data.");
 DEFINE_int32(num_shard_bits, 4, "shard_bits.");
+DEFINE_uint32(value_bytes, 8 * KB,
+              "Size of each value added, which is also its charge.");
 
 DEFINE_int64(max_key, 1 * KB * KB * KB, "Max number of key to place in cache");
 DEFINE_uint64(ops_per_thread, 1200000, "Number of operations per thread.");
@@ -43,22 +49,25 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
-DEFINE_bool(use_clock_cache, false, "");
+DEFINE_string(cache_type, "lru_cache",
+              "A comma-separated list of the cache implementations to run the "
+              "benchmark on: lru_cache, clock_cache.");
+DEFINE_bool(use_clock_cache, false, "Same as --cache_type=clock_cache.");
 
 namespace rocksdb {
 
 class CacheBench;
 namespace {
 void deleter(const Slice& /*key*/, void* value) {
-    delete reinterpret_cast<char *>(value);
+  delete[] reinterpret_cast<char*>(value);
 }
 
 // State shared by all concurrent executions of the same benchmark.
 class SharedState {
  public:
-  explicit SharedState(CacheBench* cache_bench)
+  SharedState(CacheBench* cache_bench, uint32_t num_threads)
       : cv_(&mu_),
-        num_threads_(FLAGS_threads),
+        num_threads_(num_threads),
         num_initialized_(0),
         start_(false),
         num_done_(0),
@@ -128,28 +137,33 @@ struct ThreadState {
 
 class CacheBench {
  public:
-  CacheBench() : num_threads_(FLAGS_threads) {
-    if (FLAGS_use_clock_cache) {
-      cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits);
-      if (!cache_) {
-        fprintf(stderr, "Clock cache not supported.\n");
-        exit(1);
-      }
-    } else {
+  CacheBench(const std::string& cache_type, uint32_t num_threads)
+      : cache_type_(cache_type), num_threads_(num_threads), qps_(0) {
+    if (cache_type == "clock_cache") {
+      cache_ = NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits,
+                             false /* strict_capacity_limit */,
+                             kDefaultCacheMetadataChargePolicy,
+                             FLAGS_value_bytes /* estimated_entry_charge */);
+    } else if (cache_type == "lru_cache") {
       cache_ = NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits);
     }
+    if (!cache_) {
+      fprintf(stderr, "Cache type not supported: %s\n", cache_type.c_str());
+      exit(1);
+    }
   }
 
   ~CacheBench() {}
 
   void PopulateCache() {
     Random rnd(1);
-    for (int64_t i = 0; i < FLAGS_cache_size; i++) {
+    for (int64_t i = 0; i < FLAGS_cache_size / FLAGS_value_bytes; i++) {
       uint64_t rand_key = rnd.Next() % FLAGS_max_key;
       // Cast uint64* to be char*, data would be copied to cache
       Slice key(reinterpret_cast<char*>(&rand_key), 8);
       // do insert
-      cache_->Insert(key, new char[10], 1, &deleter);
+      cache_->Insert(key, new char[FLAGS_value_bytes], FLAGS_value_bytes,
+                     &deleter);
     }
   }
 
@@ -157,7 +171,7 @@ class CacheBench {
     rocksdb::Env* env = rocksdb::Env::Default();
 
     PrintEnv();
-    SharedState shared(this);
+    SharedState shared(this, num_threads_);
     std::vector<ThreadState*> threads(num_threads_);
     for (uint32_t i = 0; i < num_threads_; i++) {
       threads[i] = new ThreadState(i, &shared);
@@ -183,16 +197,21 @@ class CacheBench {
       // Record end time
       uint64_t end_time = env->NowMicros();
       double elapsed = static_cast<double>(end_time - start_time) * 1e-6;
-      uint32_t qps = static_cast<uint32_t>(
-          static_cast<double>(FLAGS_threads * FLAGS_ops_per_thread) / elapsed);
-      fprintf(stdout, "Complete in %.3f s; QPS = %u\n", elapsed, qps);
+      qps_ = static_cast<uint64_t>(
+          static_cast<double>(num_threads_ * FLAGS_ops_per_thread) / elapsed);
+      fprintf(stdout, "Complete in %.3f s; QPS = %" PRIu64 "\n", elapsed,
+              qps_);
     }
     return true;
   }
 
+  uint64_t GetQps() const { return qps_; }
+
  private:
+  const std::string cache_type_;
   std::shared_ptr<Cache> cache_;
   uint32_t num_threads_;
+  uint64_t qps_;
 
   static void ThreadBody(void* v) {
     ThreadState* thread = reinterpret_cast<ThreadState*>(v);
@@ -227,16 +246,16 @@ class CacheBench {
       int32_t prob_op = thread->rnd.Uniform(100);
       if (prob_op >= 0 && prob_op < FLAGS_insert_percent) {
         // do insert
-        cache_->Insert(key, new char[10], 1, &deleter);
-      } else if (prob_op -= FLAGS_insert_percent &&
-                 prob_op < FLAGS_lookup_percent) {
+        cache_->Insert(key, new char[FLAGS_value_bytes], FLAGS_value_bytes,
+                       &deleter);
+      } else if ((prob_op -= FLAGS_insert_percent) <
+                 FLAGS_lookup_percent) {
         // do lookup
         auto handle = cache_->Lookup(key);
         if (handle) {
           cache_->Release(handle);
         }
-      } else if (prob_op -= FLAGS_lookup_percent &&
-                 prob_op < FLAGS_erase_percent) {
+      } else if ((prob_op -= FLAGS_lookup_percent) < FLAGS_erase_percent) {
         // do erase
         cache_->Erase(key);
       }
@@ -245,10 +264,12 @@ class CacheBench {
 
   void PrintEnv() const {
     printf("RocksDB version     : %d.%d\n", kMajorVersion, kMinorVersion);
-    printf("Number of threads   : %d\n", FLAGS_threads);
+    printf("Cache type          : %s\n", cache_type_.c_str());
+    printf("Number of threads   : %u\n", num_threads_);
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %d\n", FLAGS_num_shard_bits);
+    printf("Value bytes         : %u\n", FLAGS_value_bytes);
     printf("Max key             : %" PRIu64 "\n", FLAGS_max_key);
     printf("Populate cache      : %d\n", FLAGS_populate_cache);
     printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
@@ -262,20 +283,55 @@ class CacheBench {
 int main(int argc, char** argv) {
   ParseCommandLineFlags(&argc, &argv, true);
 
-  if (FLAGS_threads <= 0) {
-    fprintf(stderr, "threads number <= 0\n");
+  std::vector<int> thread_counts;
+  if (FLAGS_threads_list.empty()) {
+    thread_counts.push_back(FLAGS_threads);
+  } else {
+    for (const std::string& count :
+         rocksdb::StringSplit(FLAGS_threads_list, ',')) {
+      thread_counts.push_back(rocksdb::ParseInt(count));
+    }
+  }
+  for (int count : thread_counts) {
+    if (count <= 0) {
+      fprintf(stderr, "threads number <= 0\n");
+      exit(1);
+    }
+  }
+  if (FLAGS_value_bytes == 0) {
+    fprintf(stderr, "value_bytes must be positive\n");
     exit(1);
   }
-
-  rocksdb::CacheBench bench;
-  if (FLAGS_populate_cache) {
-    bench.PopulateCache();
+  std::vector<std::string> cache_types =
+      FLAGS_use_clock_cache ? std::vector<std::string>{"clock_cache"}
+                            : rocksdb::StringSplit(FLAGS_cache_type, ',');
+
+  // One run per cache type and thread count, followed by a summary to
+  // compare them side by side.
+  std::vector<uint64_t> qps;
+  for (const std::string& cache_type : cache_types) {
+    for (int count : thread_counts) {
+      rocksdb::CacheBench bench(cache_type, static_cast<uint32_t>(count));
+      if (FLAGS_populate_cache) {
+        bench.PopulateCache();
+      }
+      if (!bench.Run()) {
+        return 1;
+      }
+      qps.push_back(bench.GetQps());
+    }
   }
-  if (bench.Run()) {
-    return 0;
-  } else {
-    return 1;
+  if (qps.size() > 1) {
+    printf("\n%-16s %8s %14s\n", "Cache type", "Threads", "QPS");
+    size_t i = 0;
+    for (const std::string& cache_type : cache_types) {
+      for (int count : thread_counts) {
+        printf("%-16s %8d %14" PRIu64 "\n", cache_type.c_str(), count,
+               qps[i++]);
+      }
+    }
   }
+  return 0;
 }
 
 #endif  // GFLAGS
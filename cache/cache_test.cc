@@ -9,6 +9,7 @@
 
 #include "rocksdb/cache.h"
 
+#include <atomic>
 #include <forward_list>
 #include <functional>
 #include <iostream>
@@ -16,8 +17,10 @@
 #include <vector>
 #include "cache/clock_cache.h"
 #include "cache/lru_cache.h"
+#include "port/port.h"
 #include "test_util/testharness.h"
 #include "util/coding.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace rocksdb {
@@ -56,6 +59,9 @@ class CacheTest : public testing::TestWithParam<std::string> {
     current_->deleted_values_.push_back(DecodeValue(v));
   }
 
+  // Most entries in these tests have a charge of 1.
+  size_t clock_estimated_entry_charge_ = 1;
+
   static const int kCacheSize = 1000;
   static const int kNumShardBits = 4;
 
@@ -101,7 +107,7 @@ class CacheTest : public testing::TestWithParam<std::string> {
     }
     if (type == kClock) {
       return NewClockCache(capacity, num_shard_bits, strict_capacity_limit,
-                           charge_policy);
+                           charge_policy, clock_estimated_entry_charge_);
     }
     return nullptr;
   }
@@ -156,6 +162,7 @@ class LRUCacheTest : public CacheTest {};
 TEST_P(CacheTest, UsageTest) {
   // cache is std::shared_ptr and will be automatically cleaned up.
   const uint64_t kCapacity = 100000;
+  clock_estimated_entry_charge_ = 10;  // Keep the tables small to scan.
   auto cache = NewCache(kCapacity, 8, false, kDontChargeCacheMetadata);
   auto precise_cache = NewCache(kCapacity, 0, false, kFullChargeCacheMetadata);
   ASSERT_EQ(0, cache->GetUsage());
@@ -199,6 +206,7 @@ TEST_P(CacheTest, UsageTest) {
 TEST_P(CacheTest, PinnedUsageTest) {
   // cache is std::shared_ptr and will be automatically cleaned up.
   const uint64_t kCapacity = 200000;
+  clock_estimated_entry_charge_ = 10;  // Keep the tables small to scan.
   auto cache = NewCache(kCapacity, 8, false, kDontChargeCacheMetadata);
   auto precise_cache = NewCache(kCapacity, 8, false, kFullChargeCacheMetadata);
 
@@ -755,14 +763,138 @@ TEST_P(CacheTest, GetCharge) {
   cache_->Release(h1);
 }
 
-#ifdef SUPPORT_CLOCK_CACHE
-std::shared_ptr<Cache> (*new_clock_cache_func)(
-    size_t, int, bool, CacheMetadataChargePolicy) = NewClockCache;
+namespace {
+std::atomic<int> live_values{0};
+void countingDeleter(const Slice& /*key*/, void* value) {
+  delete static_cast<Value*>(value);
+  live_values.fetch_sub(1);
+}
+}  // namespace
+
+TEST_P(CacheTest, ConcurrentOperations) {
+  const int kNumThreads = 4;
+  const int kOpsPerThread = 20000;
+  const int kNumKeys = 500;
+  std::shared_ptr<Cache> cache = NewCache(100, 2, false);
+  live_values = 0;
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      std::vector<Cache::Handle*> pinned;
+      for (int i = 0; i < kOpsPerThread; i++) {
+        std::string key = EncodeKey(rnd.Uniform(kNumKeys));
+        switch (rnd.Uniform(4)) {
+          case 0: {
+            Cache::Handle* h = nullptr;
+            live_values.fetch_add(1);
+            Status s = cache->Insert(key, new Value(i), 1, &countingDeleter,
+                                     rnd.OneIn(2) ? &h : nullptr);
+            ASSERT_OK(s);
+            if (h != nullptr) {
+              pinned.push_back(h);
+            }
+            break;
+          }
+          case 1: {
+            Cache::Handle* h = cache->Lookup(key);
+            if (h != nullptr) {
+              ASSERT_NE(nullptr, cache->Value(h));
+              pinned.push_back(h);
+            }
+            break;
+          }
+          case 2:
+            cache->Erase(key);
+            break;
+          default:
+            break;
+        }
+        if (pinned.size() > 5 || (!pinned.empty() && rnd.OneIn(3))) {
+          cache->Release(pinned.back());
+          pinned.pop_back();
+        }
+      }
+      for (Cache::Handle* h : pinned) {
+        cache->Release(h);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  ASSERT_EQ(0U, cache->GetPinnedUsage());
+  cache->EraseUnRefEntries();
+  ASSERT_EQ(0U, cache->GetUsage());
+  ASSERT_EQ(0, live_values.load());
+}
+
+class ClockCacheTest : public testing::Test {};
+
+TEST_F(ClockCacheTest, FullTable) {
+  // Room for 8 entries of the estimated charge, so the table has its
+  // minimum length of 16 slots, and takes 13 entries before it is full.
+  const size_t kCapacity = 8 * 1000;
+  std::shared_ptr<Cache> cache =
+      NewClockCache(kCapacity, 0, false, kDontChargeCacheMetadata,
+                    1000 /* estimated_entry_charge */);
+  ClockCacheShard* shard = static_cast<ClockCacheShard*>(
+      static_cast<ShardedCache*>(cache.get())->GetShard(0));
+  ASSERT_EQ(16U, shard->GetTableLength());
+
+  std::vector<Cache::Handle*> handles;
+  for (int i = 0; i < 13; i++) {
+    Cache::Handle* h = nullptr;
+    ASSERT_OK(cache->Insert(EncodeKey(i), EncodeValue(i), 1, &dumbDeleter,
+                            &h));
+    handles.push_back(h);
+  }
+  ASSERT_EQ(13U, cache->GetUsage());
+
+  // Nothing can be evicted, so the entry is returned through its handle
+  // without being added to the table.
+  Cache::Handle* detached = nullptr;
+  ASSERT_OK(cache->Insert(EncodeKey(13), EncodeValue(13), 1, &dumbDeleter,
+                          &detached));
+  ASSERT_NE(nullptr, detached);
+  ASSERT_EQ(13, DecodeValue(cache->Value(detached)));
+  ASSERT_EQ(nullptr, cache->Lookup(EncodeKey(13)));
+  ASSERT_EQ(14U, cache->GetUsage());
+  ASSERT_EQ(14U, cache->GetPinnedUsage());
+
+  // Without a handle, the entry is dropped.
+  ASSERT_OK(cache->Insert(EncodeKey(14), EncodeValue(14), 1, &dumbDeleter));
+  ASSERT_EQ(nullptr, cache->Lookup(EncodeKey(14)));
+  ASSERT_EQ(14U, cache->GetUsage());
+
+  // With a strict capacity limit, the insert fails.
+  cache->SetStrictCapacityLimit(true);
+  Cache::Handle* h = nullptr;
+  ASSERT_TRUE(cache->Insert(EncodeKey(15), EncodeValue(15), 1, &dumbDeleter,
+                            &h)
+                  .IsIncomplete());
+  ASSERT_EQ(nullptr, h);
+  cache->SetStrictCapacityLimit(false);
+
+  ASSERT_TRUE(cache->Release(detached));
+  ASSERT_EQ(13U, cache->GetUsage());
+
+  // Once released, the entries can be evicted to make room in the table.
+  for (Cache::Handle* handle : handles) {
+    cache->Release(handle);
+  }
+  ASSERT_EQ(0U, cache->GetPinnedUsage());
+  ASSERT_OK(cache->Insert(EncodeKey(16), EncodeValue(16), 1, &dumbDeleter));
+  h = cache->Lookup(EncodeKey(16));
+  ASSERT_NE(nullptr, h);
+  cache->Release(h);
+  ASSERT_EQ(13U, cache->GetUsage());
+}
+
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
                         testing::Values(kLRU, kClock));
-#else
-INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest, testing::Values(kLRU));
-#endif  // SUPPORT_CLOCK_CACHE
 INSTANTIATE_TEST_CASE_P(CacheTestInstance, LRUCacheTest, testing::Values(kLRU));
 
 }  // namespace rocksdb
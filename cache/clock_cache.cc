@@ -9,753 +9,580 @@
 
 #include "cache/clock_cache.h"
 
-#ifndef SUPPORT_CLOCK_CACHE
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cmath>
 
 namespace rocksdb {
 
-std::shared_ptr<Cache> NewClockCache(
-    size_t /*capacity*/, int /*num_shard_bits*/, bool /*strict_capacity_limit*/,
-    CacheMetadataChargePolicy /*metadata_charge_policy*/) {
-  // Clock cache not supported.
-  return nullptr;
-}
-
-}  // namespace rocksdb
+namespace {
 
-#else
+// Entries per slot the table is sized for, and the most it is filled to.
+constexpr double kLoadFactor = 0.7;
+constexpr double kStrictLoadFactor = 0.84;
 
-#include <assert.h>
-#include <atomic>
-#include <deque>
+constexpr int kMinLengthBits = 4;
+constexpr int kMaxLengthBits = 30;
 
-// "tbb/concurrent_hash_map.h" requires RTTI if exception is enabled.
-// Disable it so users can chooose to disable RTTI.
-#ifndef ROCKSDB_USE_RTTI
-#define TBB_USE_EXCEPTIONS 0
-#endif
-#include "tbb/concurrent_hash_map.h"
+// Used when the caller gives no estimate.
+constexpr size_t kDefaultEstimatedEntryCharge = 4 * 1024;
 
-#include "cache/sharded_cache.h"
-#include "port/malloc.h"
-#include "port/port.h"
-#include "util/autovector.h"
-#include "util/mutexlock.h"
+// Number of slots the clock hand claims at a time.
+constexpr uint64_t kClockStepSize = 4;
 
-namespace rocksdb {
+int CalcLengthBits(size_t capacity, size_t estimated_entry_charge) {
+  double num_slots = std::ceil(static_cast<double>(capacity) /
+                               static_cast<double>(estimated_entry_charge) /
+                               kLoadFactor);
+  int length_bits = kMinLengthBits;
+  while (length_bits < kMaxLengthBits &&
+         static_cast<double>(uint64_t{1} << length_bits) < num_slots) {
+    length_bits++;
+  }
+  return length_bits;
+}
 
-namespace {
+// The home slot of a key is given by the low bits of its hash. The increment
+// between the slots of its probe sequence is derived from all the bits of
+// the hash, and is odd so that the sequence visits every slot of the table.
+inline uint32_t ProbeIncrement(uint32_t hash) {
+  return static_cast<uint32_t>((uint64_t{hash} * 0x9E3779B97F4A7C15U) >> 32) |
+         1U;
+}
 
-// An implementation of the Cache interface based on CLOCK algorithm, with
-// better concurrent performance than LRUCache. The idea of CLOCK algorithm
-// is to maintain all cache entries in a circular list, and an iterator
-// (the "head") pointing to the last examined entry. Eviction starts from the
-// current head. Each entry is given a second chance before eviction, if it
-// has been access since last examine. In contrast to LRU, no modification
-// to the internal data-structure (except for flipping the usage bit) needs
-// to be done upon lookup. This gives us oppertunity to implement a cache
-// with better concurrency.
-//
-// Each cache entry is represented by a cache handle, and all the handles
-// are arranged in a circular list, as describe above. Upon erase of an entry,
-// we never remove the handle. Instead, the handle is put into a recycle bin
-// to be re-use. This is to avoid memory dealocation, which is hard to deal
-// with in concurrent environment.
-//
-// The cache also maintains a concurrent hash map for lookup. Any concurrent
-// hash map implementation should do the work. We currently use
-// tbb::concurrent_hash_map because it supports concurrent erase.
-//
-// Each cache handle has the following flags and counters, which are squeeze
-// in an atomic interger, to make sure the handle always be in a consistent
-// state:
-//
-//   * In-cache bit: whether the entry is reference by the cache itself. If
-//     an entry is in cache, its key would also be available in the hash map.
-//   * Usage bit: whether the entry has been access by user since last
-//     examine for eviction. Can be reset by eviction.
-//   * Reference count: reference count by user.
-//
-// An entry can be reference only when it's in cache. An entry can be evicted
-// only when it is in cache, has no usage since last examine, and reference
-// count is zero.
-//
-// The follow figure shows a possible layout of the cache. Boxes represents
-// cache handles and numbers in each box being in-cache bit, usage bit and
-// reference count respectively.
-//
-//    hash map:
-//      +-------+--------+
-//      |  key  | handle |
-//      +-------+--------+
-//      | "foo" |    5   |-------------------------------------+
-//      +-------+--------+                                     |
-//      | "bar" |    2   |--+                                  |
-//      +-------+--------+  |                                  |
-//                          |                                  |
-//                     head |                                  |
-//                       |  |                                  |
-//    circular list:     |  |                                  |
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//         |(0,0,0)|---|(1,1,0)|---|(0,0,0)|---|(0,1,3)|---|(1,0,0)|---|  ...
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//             |                       |
-//             +-------+   +-----------+
-//                     |   |
-//                   +---+---+
-//    recycle bin:   | 1 | 3 |
-//                   +---+---+
-//
-// Suppose we try to insert "baz" into the cache at this point and the cache is
-// full. The cache will first look for entries to evict, starting from where
-// head points to (the second entry). It resets usage bit of the second entry,
-// skips the third and fourth entry since they are not in cache, and finally
-// evict the fifth entry ("foo"). It looks at recycle bin for available handle,
-// grabs handle 3, and insert the key into the handle. The following figure
-// shows the resulting layout.
-//
-//    hash map:
-//      +-------+--------+
-//      |  key  | handle |
-//      +-------+--------+
-//      | "baz" |    3   |-------------+
-//      +-------+--------+             |
-//      | "bar" |    2   |--+          |
-//      +-------+--------+  |          |
-//                          |          |
-//                          |          |                                 head
-//                          |          |                                   |
-//    circular list:        |          |                                   |
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//         |(0,0,0)|---|(1,0,0)|---|(1,0,0)|---|(0,1,3)|---|(0,0,0)|---|  ...
-//         +-------+   +-------+   +-------+   +-------+   +-------+   +-------
-//             |                                               |
-//             +-------+   +-----------------------------------+
-//                     |   |
-//                   +---+---+
-//    recycle bin:   | 1 | 5 |
-//                   +---+---+
-//
-// A global mutex guards the circular list, the head, and the recycle bin.
-// We additionally require that modifying the hash map needs to hold the mutex.
-// As such, Modifying the cache (such as Insert() and Erase()) require to
-// hold the mutex. Lookup() only access the hash map and the flags associated
-// with each handle, and don't require explicit locking. Release() has to
-// acquire the mutex only when it releases the last reference to the entry and
-// the entry has been erased from cache explicitly. A future improvement could
-// be to remove the mutex completely.
-//
-// Benchmark:
-// We run readrandom db_bench on a test DB of size 13GB, with size of each
-// level:
-//
-//    Level    Files   Size(MB)
-//    -------------------------
-//      L0        1       0.01
-//      L1       18      17.32
-//      L2      230     182.94
-//      L3     1186    1833.63
-//      L4     4602    8140.30
-//
-// We test with both 32 and 16 read threads, with 2GB cache size (the whole DB
-// doesn't fits in) and 64GB cache size (the whole DB can fit in cache), and
-// whether to put index and filter blocks in block cache. The benchmark runs
-// with
-// with RocksDB 4.10. We got the following result:
-//
-// Threads Cache     Cache               ClockCache               LRUCache
-//         Size  Index/Filter Throughput(MB/s)   Hit Throughput(MB/s)    Hit
-//     32   2GB       yes               466.7  85.9%           433.7   86.5%
-//     32   2GB       no                529.9  72.7%           532.7   73.9%
-//     32  64GB       yes               649.9  99.9%           507.9   99.9%
-//     32  64GB       no                740.4  99.9%           662.8   99.9%
-//     16   2GB       yes               278.4  85.9%           283.4   86.5%
-//     16   2GB       no                318.6  72.7%           335.8   73.9%
-//     16  64GB       yes               391.9  99.9%           353.3   99.9%
-//     16  64GB       no                433.8  99.8%           419.4   99.8%
-
-// Cache entry meta data.
-struct CacheHandle {
-  Slice key;
-  uint32_t hash;
-  void* value;
-  size_t charge;
-  void (*deleter)(const Slice&, void* value);
-
-  // Flags and counters associated with the cache handle:
-  //   lowest bit: n-cache bit
-  //   second lowest bit: usage bit
-  //   the rest bits: reference count
-  // The handle is unused when flags equals to 0. The thread decreases the count
-  // to 0 is responsible to put the handle back to recycle_ and cleanup memory.
-  std::atomic<uint32_t> flags;
-
-  CacheHandle() = default;
-
-  CacheHandle(const CacheHandle& a) { *this = a; }
-
-  CacheHandle(const Slice& k, void* v,
-              void (*del)(const Slice& key, void* value))
-      : key(k), value(v), deleter(del) {}
-
-  CacheHandle& operator=(const CacheHandle& a) {
-    // Only copy members needed for deletion.
-    key = a.key;
-    value = a.value;
-    deleter = a.deleter;
-    return *this;
-  }
-
-  inline static size_t CalcTotalCharge(
-      Slice key, size_t charge,
-      CacheMetadataChargePolicy metadata_charge_policy) {
-    size_t meta_charge = 0;
-    if (metadata_charge_policy == kFullChargeCacheMetadata) {
-      meta_charge += sizeof(CacheHandle);
-#ifdef ROCKSDB_MALLOC_USABLE_SIZE
-      meta_charge +=
-          malloc_usable_size(static_cast<void*>(const_cast<char*>(key.data())));
-#else
-      meta_charge += key.size();
-#endif
-    }
-    return charge + meta_charge;
-  }
-
-  inline size_t CalcTotalCharge(
-      CacheMetadataChargePolicy metadata_charge_policy) {
-    return CalcTotalCharge(key, charge, metadata_charge_policy);
-  }
-};
-
-// Key of hash map. We store hash value with the key for convenience.
-struct CacheKey {
-  Slice key;
-  uint32_t hash_value;
-
-  CacheKey() = default;
-
-  CacheKey(const Slice& k, uint32_t h) {
-    key = k;
-    hash_value = h;
-  }
-
-  static bool equal(const CacheKey& a, const CacheKey& b) {
-    return a.hash_value == b.hash_value && a.key == b.key;
-  }
-
-  static size_t hash(const CacheKey& a) {
-    return static_cast<size_t>(a.hash_value);
-  }
-};
-
-struct CleanupContext {
-  // List of values to be deleted, along with the key and deleter.
-  autovector<CacheHandle> to_delete_value;
-
-  // List of keys to be deleted.
-  autovector<const char*> to_delete_key;
-};
-
-// A cache shard which maintains its own CLOCK cache.
-class ClockCacheShard final : public CacheShard {
- public:
-  // Hash map type.
-  typedef tbb::concurrent_hash_map<CacheKey, CacheHandle*, CacheKey> HashTable;
-
-  ClockCacheShard();
-  ~ClockCacheShard() override;
-
-  // Interfaces
-  void SetCapacity(size_t capacity) override;
-  void SetStrictCapacityLimit(bool strict_capacity_limit) override;
-  Status Insert(const Slice& key, uint32_t hash, void* value, size_t charge,
-                void (*deleter)(const Slice& key, void* value),
-                Cache::Handle** handle, Cache::Priority priority) override;
-  Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
-  // If the entry in in cache, increase reference count and return true.
-  // Return false otherwise.
-  //
-  // Not necessary to hold mutex_ before being called.
-  bool Ref(Cache::Handle* handle) override;
-  bool Release(Cache::Handle* handle, bool force_erase = false) override;
-  void Erase(const Slice& key, uint32_t hash) override;
-  bool EraseAndConfirm(const Slice& key, uint32_t hash,
-                       CleanupContext* context);
-  size_t GetUsage() const override;
-  size_t GetPinnedUsage() const override;
-  void EraseUnRefEntries() override;
-  void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
-                              bool thread_safe) override;
-
- private:
-  static const uint32_t kInCacheBit = 1;
-  static const uint32_t kUsageBit = 2;
-  static const uint32_t kRefsOffset = 2;
-  static const uint32_t kOneRef = 1 << kRefsOffset;
-
-  // Helper functions to extract cache handle flags and counters.
-  static bool InCache(uint32_t flags) { return flags & kInCacheBit; }
-  static bool HasUsage(uint32_t flags) { return flags & kUsageBit; }
-  static uint32_t CountRefs(uint32_t flags) { return flags >> kRefsOffset; }
-
-  // Decrease reference count of the entry. If this decreases the count to 0,
-  // recycle the entry. If set_usage is true, also set the usage bit.
-  //
-  // returns true if a value is erased.
-  //
-  // Not necessary to hold mutex_ before being called.
-  bool Unref(CacheHandle* handle, bool set_usage, CleanupContext* context);
-
-  // Unset in-cache bit of the entry. Recycle the handle if necessary.
-  //
-  // returns true if a value is erased.
-  //
-  // Has to hold mutex_ before being called.
-  bool UnsetInCache(CacheHandle* handle, CleanupContext* context);
-
-  // Put the handle back to recycle_ list, and put the value associated with
-  // it into to-be-deleted list. It doesn't cleanup the key as it might be
-  // reused by another handle.
-  //
-  // Has to hold mutex_ before being called.
-  void RecycleHandle(CacheHandle* handle, CleanupContext* context);
-
-  // Delete keys and values in to-be-deleted list. Call the method without
-  // holding mutex, as destructors can be expensive.
-  void Cleanup(const CleanupContext& context);
-
-  // Examine the handle for eviction. If the handle is in cache, usage bit is
-  // not set, and referece count is 0, evict it from cache. Otherwise unset
-  // the usage bit.
-  //
-  // Has to hold mutex_ before being called.
-  bool TryEvict(CacheHandle* value, CleanupContext* context);
-
-  // Scan through the circular list, evict entries until we get enough capacity
-  // for new cache entry of specific size. Return true if success, false
-  // otherwise.
-  //
-  // Has to hold mutex_ before being called.
-  bool EvictFromCache(size_t charge, CleanupContext* context);
-
-  CacheHandle* Insert(const Slice& key, uint32_t hash, void* value,
-                      size_t change,
-                      void (*deleter)(const Slice& key, void* value),
-                      bool hold_reference, CleanupContext* context);
-
-  // Guards list_, head_, and recycle_. In addition, updating table_ also has
-  // to hold the mutex, to avoid the cache being in inconsistent state.
-  mutable port::Mutex mutex_;
-
-  // The circular list of cache handles. Initially the list is empty. Once a
-  // handle is needed by insertion, and no more handles are available in
-  // recycle bin, one more handle is appended to the end.
-  //
-  // We use std::deque for the circular list because we want to make sure
-  // pointers to handles are valid through out the life-cycle of the cache
-  // (in contrast to std::vector), and be able to grow the list (in contrast
-  // to statically allocated arrays).
-  std::deque<CacheHandle> list_;
-
-  // Pointer to the next handle in the circular list to be examine for
-  // eviction.
-  size_t head_;
-
-  // Recycle bin of cache handles.
-  autovector<CacheHandle*> recycle_;
-
-  // Maximum cache size.
-  std::atomic<size_t> capacity_;
-
-  // Current total size of the cache.
-  std::atomic<size_t> usage_;
-
-  // Total un-released cache size.
-  std::atomic<size_t> pinned_usage_;
-
-  // Whether allow insert into cache if cache is full.
-  std::atomic<bool> strict_capacity_limit_;
-
-  // Hash table (tbb::concurrent_hash_map) for lookup.
-  HashTable table_;
-};
-
-ClockCacheShard::ClockCacheShard()
-    : head_(0), usage_(0), pinned_usage_(0), strict_capacity_limit_(false) {}
+}  // namespace
+
+ClockCacheShard::ClockCacheShard(
+    size_t capacity, bool strict_capacity_limit,
+    size_t estimated_entry_charge,
+    CacheMetadataChargePolicy metadata_charge_policy)
+    : length_bits_(CalcLengthBits(capacity, estimated_entry_charge)),
+      length_bits_mask_((uint32_t{1} << length_bits_) - 1),
+      occupancy_limit_(static_cast<uint32_t>(
+          (uint64_t{1} << length_bits_) * kStrictLoadFactor)),
+      array_(new ClockHandle[size_t{1} << length_bits_]),
+      clock_pointer_(0),
+      occupancy_(0),
+      usage_(0),
+      detached_usage_(0),
+      capacity_(capacity),
+      strict_capacity_limit_(strict_capacity_limit) {
+  set_metadata_charge_policy(metadata_charge_policy);
+}
 
 ClockCacheShard::~ClockCacheShard() {
-  for (auto& handle : list_) {
-    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
-    if (InCache(flags) || CountRefs(flags) > 0) {
-      if (handle.deleter != nullptr) {
-        (*handle.deleter)(handle.key, handle.value);
-      }
-      delete[] handle.key.data();
+  // Entries that are still referenced are leaked, as in LRUCache.
+  for (uint32_t i = 0; i <= length_bits_mask_; i++) {
+    ClockHandle* h = &array_[i];
+    uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if ((ClockHandle::GetState(meta) & ClockHandle::kStateShareableBit) &&
+        ClockHandle::GetRefcount(meta) == 0) {
+      FreeSlot(h);
     }
   }
 }
 
-size_t ClockCacheShard::GetUsage() const {
-  return usage_.load(std::memory_order_relaxed);
-}
-
-size_t ClockCacheShard::GetPinnedUsage() const {
-  return pinned_usage_.load(std::memory_order_relaxed);
+size_t ClockCacheShard::CalcTotalCharge(size_t key_length,
+                                        size_t charge) const {
+  size_t meta_charge = 0;
+  if (metadata_charge_policy_ == kFullChargeCacheMetadata) {
+    meta_charge += sizeof(ClockHandle) + key_length;
+  }
+  return charge + meta_charge;
 }
 
-void ClockCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
-                                             bool thread_safe) {
-  if (thread_safe) {
-    mutex_.Lock();
-  }
-  for (auto& handle : list_) {
-    // Use relaxed semantics instead of acquire semantics since we are either
-    // holding mutex, or don't have thread safe requirement.
-    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
-    if (InCache(flags)) {
-      callback(handle.value, handle.charge);
-    }
-  }
-  if (thread_safe) {
-    mutex_.Unlock();
+void ClockCacheShard::SetCapacity(size_t capacity) {
+  capacity_.store(capacity, std::memory_order_relaxed);
+  size_t usage = usage_.load(std::memory_order_relaxed);
+  if (usage > capacity) {
+    Evict(usage - capacity);
   }
 }
 
-void ClockCacheShard::RecycleHandle(CacheHandle* handle,
-                                    CleanupContext* context) {
-  mutex_.AssertHeld();
-  assert(!InCache(handle->flags) && CountRefs(handle->flags) == 0);
-  context->to_delete_key.push_back(handle->key.data());
-  context->to_delete_value.emplace_back(*handle);
-  size_t total_charge = handle->CalcTotalCharge(metadata_charge_policy_);
-  handle->key.clear();
-  handle->value = nullptr;
-  handle->deleter = nullptr;
-  recycle_.push_back(handle);
-  usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+void ClockCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
+  strict_capacity_limit_.store(strict_capacity_limit,
+                               std::memory_order_relaxed);
 }
 
-void ClockCacheShard::Cleanup(const CleanupContext& context) {
-  for (const CacheHandle& handle : context.to_delete_value) {
-    if (handle.deleter) {
-      (*handle.deleter)(handle.key, handle.value);
-    }
+bool ClockCacheShard::TryReserveOccupancy() {
+  uint32_t old_occupancy = occupancy_.fetch_add(1, std::memory_order_acquire);
+  if (old_occupancy >= occupancy_limit_) {
+    occupancy_.fetch_sub(1, std::memory_order_relaxed);
+    return false;
   }
-  for (const char* key : context.to_delete_key) {
-    delete[] key;
-  }
-}
-
-bool ClockCacheShard::Ref(Cache::Handle* h) {
-  auto handle = reinterpret_cast<CacheHandle*>(h);
-  // CAS loop to increase reference count.
-  uint32_t flags = handle->flags.load(std::memory_order_relaxed);
-  while (InCache(flags)) {
-    // Use acquire semantics on success, as further operations on the cache
-    // entry has to be order after reference count is increased.
-    if (handle->flags.compare_exchange_weak(flags, flags + kOneRef,
-                                            std::memory_order_acquire,
-                                            std::memory_order_relaxed)) {
-      if (CountRefs(flags) == 0) {
-        // No reference count before the operation.
-        size_t total_charge = handle->CalcTotalCharge(metadata_charge_policy_);
-        pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
-      }
-      return true;
+  return true;
+}
+
+ClockHandle* ClockCacheShard::ClaimSlot(uint32_t hash) {
+  const uint32_t increment = ProbeIncrement(hash);
+  uint32_t index = hash & length_bits_mask_;
+  for (uint32_t probe = 0; probe <= length_bits_mask_; probe++) {
+    ClockHandle* h = &array_[index];
+    uint64_t old_meta = h->meta.fetch_or(
+        uint64_t{ClockHandle::kStateOccupiedBit} << ClockHandle::kStateShift,
+        std::memory_order_acq_rel);
+    if (ClockHandle::GetState(old_meta) == ClockHandle::kStateEmpty) {
+      h->hash = hash;
+      return h;
     }
+    h->displacements.fetch_add(1, std::memory_order_relaxed);
+    index = (index + increment) & length_bits_mask_;
   }
-  return false;
-}
-
-bool ClockCacheShard::Unref(CacheHandle* handle, bool set_usage,
-                            CleanupContext* context) {
-  if (set_usage) {
-    handle->flags.fetch_or(kUsageBit, std::memory_order_relaxed);
-  }
-  // Use acquire-release semantics as previous operations on the cache entry
-  // has to be order before reference count is decreased, and potential cleanup
-  // of the entry has to be order after.
-  uint32_t flags = handle->flags.fetch_sub(kOneRef, std::memory_order_acq_rel);
-  assert(CountRefs(flags) > 0);
-  if (CountRefs(flags) == 1) {
-    // this is the last reference.
-    size_t total_charge = handle->CalcTotalCharge(metadata_charge_policy_);
-    pinned_usage_.fetch_sub(total_charge, std::memory_order_relaxed);
-    // Cleanup if it is the last reference.
-    if (!InCache(flags)) {
-      MutexLock l(&mutex_);
-      RecycleHandle(handle, context);
-    }
+  // Every slot was taken when we got to it, by concurrent inserts reusing
+  // the slots freed meanwhile. Give up.
+  index = hash & length_bits_mask_;
+  for (uint32_t probe = 0; probe <= length_bits_mask_; probe++) {
+    array_[index].displacements.fetch_sub(1, std::memory_order_relaxed);
+    index = (index + increment) & length_bits_mask_;
   }
-  return context->to_delete_value.size();
+  occupancy_.fetch_sub(1, std::memory_order_relaxed);
+  return nullptr;
 }
 
-bool ClockCacheShard::UnsetInCache(CacheHandle* handle,
-                                   CleanupContext* context) {
-  mutex_.AssertHeld();
-  // Use acquire-release semantics as previous operations on the cache entry
-  // has to be order before reference count is decreased, and potential cleanup
-  // of the entry has to be order after.
-  uint32_t flags =
-      handle->flags.fetch_and(~kInCacheBit, std::memory_order_acq_rel);
-  // Cleanup if it is the last reference.
-  if (InCache(flags) && CountRefs(flags) == 0) {
-    RecycleHandle(handle, context);
+void ClockCacheShard::ReleaseSlot(ClockHandle* h) {
+  const uint32_t hash = h->hash;
+  const uint32_t increment = ProbeIncrement(hash);
+  uint32_t index = hash & length_bits_mask_;
+  while (&array_[index] != h) {
+    array_[index].displacements.fetch_sub(1, std::memory_order_relaxed);
+    index = (index + increment) & length_bits_mask_;
   }
-  return context->to_delete_value.size();
+  h->meta.store(0, std::memory_order_release);
+  occupancy_.fetch_sub(1, std::memory_order_release);
 }
 
-bool ClockCacheShard::TryEvict(CacheHandle* handle, CleanupContext* context) {
-  mutex_.AssertHeld();
-  uint32_t flags = kInCacheBit;
-  if (handle->flags.compare_exchange_strong(flags, 0, std::memory_order_acquire,
-                                            std::memory_order_relaxed)) {
-    bool erased __attribute__((__unused__)) =
-        table_.erase(CacheKey(handle->key, handle->hash));
-    assert(erased);
-    RecycleHandle(handle, context);
-    return true;
+void ClockCacheShard::FreeSlot(ClockHandle* h) {
+  void* value = h->value;
+  auto deleter = h->deleter;
+  char* key_data = h->key_data;
+  size_t key_length = h->key_length;
+  size_t total_charge = h->total_charge;
+  ReleaseSlot(h);
+  usage_.fetch_sub(total_charge, std::memory_order_relaxed);
+  (*deleter)(Slice(key_data, key_length), value);
+  delete[] key_data;
+}
+
+void ClockCacheShard::FreeDetached(ClockHandle* h) {
+  usage_.fetch_sub(h->total_charge, std::memory_order_relaxed);
+  detached_usage_.fetch_sub(h->total_charge, std::memory_order_relaxed);
+  (*h->deleter)(h->key(), h->value);
+  delete[] h->key_data;
+  delete h;
+}
+
+void ClockCacheShard::CorrectNearOverflow(uint64_t meta,
+                                          std::atomic<uint64_t>* target) {
+  if (meta & (ClockHandle::kCounterTopBit
+              << ClockHandle::kReleaseCounterShift)) {
+    target->fetch_and(
+        ~((ClockHandle::kCounterTopBit << ClockHandle::kAcquireCounterShift) |
+          (ClockHandle::kCounterTopBit << ClockHandle::kReleaseCounterShift)),
+        std::memory_order_relaxed);
   }
-  handle->flags.fetch_and(~kUsageBit, std::memory_order_relaxed);
-  return false;
 }
 
-bool ClockCacheShard::EvictFromCache(size_t charge, CleanupContext* context) {
+Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
+                               size_t charge,
+                               void (*deleter)(const Slice& key, void* value),
+                               Cache::Handle** handle,
+                               Cache::Priority priority) {
+  // As in LRUCache, the new entry replaces any existing one for the key.
+  // Concurrent inserts of the same key may leave several of them in the
+  // table, which is harmless: Lookup returns one of them, and the others are
+  // evicted in time.
+  Erase(key, hash);
+
+  const size_t total_charge = CalcTotalCharge(key.size(), charge);
+  const size_t capacity = capacity_.load(std::memory_order_relaxed);
+  const bool strict_capacity_limit =
+      strict_capacity_limit_.load(std::memory_order_relaxed);
+
+  // Make room for the charge and for a slot.
+  bool have_slot = TryReserveOccupancy();
   size_t usage = usage_.load(std::memory_order_relaxed);
-  size_t capacity = capacity_.load(std::memory_order_relaxed);
-  if (usage == 0) {
-    return charge <= capacity;
-  }
-  size_t new_head = head_;
-  bool second_iteration = false;
-  while (usage + charge > capacity) {
-    assert(new_head < list_.size());
-    if (TryEvict(&list_[new_head], context)) {
-      usage = usage_.load(std::memory_order_relaxed);
+  if (!have_slot || usage + total_charge > capacity) {
+    size_t requested_charge =
+        usage + total_charge > capacity ? usage + total_charge - capacity : 0;
+    Evict(requested_charge);
+    if (!have_slot) {
+      have_slot = TryReserveOccupancy();
     }
-    new_head = (new_head + 1 >= list_.size()) ? 0 : new_head + 1;
-    if (new_head == head_) {
-      if (second_iteration) {
-        return false;
-      } else {
-        second_iteration = true;
+  }
+  ClockHandle* h = have_slot ? ClaimSlot(hash) : nullptr;
+
+  // Charge the entry. Without a slot, the entry can still be returned
+  // through the handle, if the capacity is not strict.
+  bool charged = false;
+  if (h != nullptr || (!strict_capacity_limit && handle != nullptr)) {
+    usage = usage_.load(std::memory_order_relaxed);
+    while (!charged) {
+      if (usage + total_charge > capacity &&
+          (strict_capacity_limit || handle == nullptr)) {
+        break;
       }
+      charged = usage_.compare_exchange_weak(usage, usage + total_charge,
+                                             std::memory_order_relaxed);
     }
   }
-  head_ = new_head;
-  return true;
+  if (!charged) {
+    if (h != nullptr) {
+      ReleaseSlot(h);
+    }
+    if (handle == nullptr) {
+      // Don't insert the entry but still return ok, as if the entry inserted
+      // into cache and get evicted immediately.
+      (*deleter)(key, value);
+      return Status::OK();
+    }
+    *handle = nullptr;
+    return Status::Incomplete("Insert failed due to clock cache being full.");
+  }
+
+  const bool detached = h == nullptr;
+  if (detached) {
+    h = new ClockHandle();
+    detached_usage_.fetch_add(total_charge, std::memory_order_relaxed);
+  }
+  h->hash = hash;
+  h->value = value;
+  h->deleter = deleter;
+  h->key_data = new char[key.size()];
+  memcpy(h->key_data, key.data(), key.size());
+  h->key_length = key.size();
+  h->charge = charge;
+  h->total_charge = total_charge;
+  h->detached = detached;
+
+  uint64_t meta;
+  if (detached) {
+    // Only reachable through the returned handle.
+    meta =
+        (uint64_t{ClockHandle::kStateInvisible} << ClockHandle::kStateShift) |
+        ClockHandle::kAcquireIncrement;
+  } else {
+    uint64_t countdown = priority == Cache::Priority::HIGH
+                             ? ClockHandle::kHighCountdown
+                             : ClockHandle::kLowCountdown;
+    uint64_t acquires = countdown + (handle != nullptr ? 1 : 0);
+    meta = (uint64_t{ClockHandle::kStateVisible} << ClockHandle::kStateShift) |
+           (acquires << ClockHandle::kAcquireCounterShift) |
+           (countdown << ClockHandle::kReleaseCounterShift);
+  }
+  h->meta.store(meta, std::memory_order_release);
+
+  if (handle != nullptr) {
+    *handle = reinterpret_cast<Cache::Handle*>(h);
+  }
+  return Status::OK();
 }
 
-void ClockCacheShard::SetCapacity(size_t capacity) {
-  CleanupContext context;
-  {
-    MutexLock l(&mutex_);
-    capacity_.store(capacity, std::memory_order_relaxed);
-    EvictFromCache(0, &context);
+ClockHandle* ClockCacheShard::FindAndRef(const Slice& key, uint32_t hash) {
+  const uint32_t increment = ProbeIncrement(hash);
+  uint32_t index = hash & length_bits_mask_;
+  for (uint32_t probe = 0; probe <= length_bits_mask_; probe++) {
+    ClockHandle* h = &array_[index];
+    uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if (ClockHandle::GetState(meta) == ClockHandle::kStateVisible) {
+      // Take a reference before looking at the entry, so that it cannot be
+      // freed meanwhile.
+      meta = h->meta.fetch_add(ClockHandle::kAcquireIncrement,
+                               std::memory_order_acquire);
+      uint8_t state = ClockHandle::GetState(meta);
+      if (state == ClockHandle::kStateVisible && h->hash == hash &&
+          h->key() == key) {
+        return h;
+      }
+      if (state & ClockHandle::kStateShareableBit) {
+        h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                          std::memory_order_release);
+      }
+      // Otherwise the slot is being filled or freed, which overwrites the
+      // counters.
+    }
+    if (h->displacements.load(std::memory_order_relaxed) == 0) {
+      break;
+    }
+    index = (index + increment) & length_bits_mask_;
   }
-  Cleanup(context);
+  return nullptr;
 }
 
-void ClockCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
-  strict_capacity_limit_.store(strict_capacity_limit,
-                               std::memory_order_relaxed);
+Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
+  return reinterpret_cast<Cache::Handle*>(FindAndRef(key, hash));
 }
 
-CacheHandle* ClockCacheShard::Insert(
-    const Slice& key, uint32_t hash, void* value, size_t charge,
-    void (*deleter)(const Slice& key, void* value), bool hold_reference,
-    CleanupContext* context) {
-  size_t total_charge =
-      CacheHandle::CalcTotalCharge(key, charge, metadata_charge_policy_);
-  MutexLock l(&mutex_);
-  bool success = EvictFromCache(total_charge, context);
-  bool strict = strict_capacity_limit_.load(std::memory_order_relaxed);
-  if (!success && (strict || !hold_reference)) {
-    context->to_delete_key.push_back(key.data());
-    if (!hold_reference) {
-      context->to_delete_value.emplace_back(key, value, deleter);
-    }
-    return nullptr;
-  }
-  // Grab available handle from recycle bin. If recycle bin is empty, create
-  // and append new handle to end of circular list.
-  CacheHandle* handle = nullptr;
-  if (!recycle_.empty()) {
-    handle = recycle_.back();
-    recycle_.pop_back();
-  } else {
-    list_.emplace_back();
-    handle = &list_.back();
-  }
-  // Fill handle.
-  handle->key = key;
-  handle->hash = hash;
-  handle->value = value;
-  handle->charge = charge;
-  handle->deleter = deleter;
-  uint32_t flags = hold_reference ? kInCacheBit + kOneRef : kInCacheBit;
-  handle->flags.store(flags, std::memory_order_relaxed);
-  HashTable::accessor accessor;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* existing_handle = accessor->second;
-    table_.erase(accessor);
-    UnsetInCache(existing_handle, context);
-  }
-  table_.insert(HashTable::value_type(CacheKey(key, hash), handle));
-  if (hold_reference) {
-    pinned_usage_.fetch_add(total_charge, std::memory_order_relaxed);
-  }
-  usage_.fetch_add(total_charge, std::memory_order_relaxed);
-  return handle;
+bool ClockCacheShard::Ref(Cache::Handle* handle) {
+  ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+  // To be called only while already holding a reference.
+  assert(ClockHandle::GetRefcount(h->meta.load(std::memory_order_relaxed)) >
+         0);
+  h->meta.fetch_add(ClockHandle::kAcquireIncrement, std::memory_order_relaxed);
+  return true;
 }
 
-Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
-                               size_t charge,
-                               void (*deleter)(const Slice& key, void* value),
-                               Cache::Handle** out_handle,
-                               Cache::Priority /*priority*/) {
-  CleanupContext context;
-  HashTable::accessor accessor;
-  char* key_data = new char[key.size()];
-  memcpy(key_data, key.data(), key.size());
-  Slice key_copy(key_data, key.size());
-  CacheHandle* handle = Insert(key_copy, hash, value, charge, deleter,
-                               out_handle != nullptr, &context);
-  Status s;
-  if (out_handle != nullptr) {
-    if (handle == nullptr) {
-      s = Status::Incomplete("Insert failed due to LRU cache being full.");
-    } else {
-      *out_handle = reinterpret_cast<Cache::Handle*>(handle);
-    }
+bool ClockCacheShard::Release(Cache::Handle* handle, bool force_erase) {
+  if (handle == nullptr) {
+    return false;
   }
-  Cleanup(context);
-  return s;
-}
+  ClockHandle* h = reinterpret_cast<ClockHandle*>(handle);
+  uint64_t old_meta = h->meta.fetch_add(ClockHandle::kReleaseIncrement,
+                                        std::memory_order_acq_rel);
+  assert(ClockHandle::GetState(old_meta) & ClockHandle::kStateShareableBit);
+  assert(ClockHandle::GetRefcount(old_meta) > 0);
+  uint64_t meta = old_meta + ClockHandle::kReleaseIncrement;
 
-Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
-  HashTable::const_accessor accessor;
-  if (!table_.find(accessor, CacheKey(key, hash))) {
-    return nullptr;
+  if (h->detached) {
+    if (ClockHandle::GetRefcount(meta) == 0) {
+      FreeDetached(h);
+      return true;
+    }
+    return false;
   }
-  CacheHandle* handle = accessor->second;
-  accessor.release();
-  // Ref() could fail if another thread sneak in and evict/erase the cache
-  // entry before we are able to hold reference.
-  if (!Ref(reinterpret_cast<Cache::Handle*>(handle))) {
-    return nullptr;
+
+  // An entry that is still visible is kept, unless the cache is over
+  // capacity.
+  if (!force_erase &&
+      ClockHandle::GetState(old_meta) == ClockHandle::kStateVisible &&
+      usage_.load(std::memory_order_relaxed) <=
+          capacity_.load(std::memory_order_relaxed)) {
+    CorrectNearOverflow(meta, &h->meta);
+    return false;
   }
-  // Double check the key since the handle may now representing another key
-  // if other threads sneak in, evict/erase the entry and re-used the handle
-  // for another cache entry.
-  if (hash != handle->hash || key != handle->key) {
-    CleanupContext context;
-    Unref(handle, false, &context);
-    // It is possible Unref() delete the entry, so we need to cleanup.
-    Cleanup(context);
-    return nullptr;
+
+  // Free the entry if that was the last reference.
+  for (;;) {
+    if (ClockHandle::GetRefcount(meta) != 0 ||
+        !(ClockHandle::GetState(meta) & ClockHandle::kStateShareableBit)) {
+      CorrectNearOverflow(meta, &h->meta);
+      return false;
+    }
+    if (h->meta.compare_exchange_weak(
+            meta,
+            uint64_t{ClockHandle::kStateConstruction}
+                << ClockHandle::kStateShift,
+            std::memory_order_acquire)) {
+      break;
+    }
   }
-  return reinterpret_cast<Cache::Handle*>(handle);
+  FreeSlot(h);
+  return true;
 }
 
-bool ClockCacheShard::Release(Cache::Handle* h, bool force_erase) {
-  CleanupContext context;
-  CacheHandle* handle = reinterpret_cast<CacheHandle*>(h);
-  bool erased = Unref(handle, true, &context);
-  if (force_erase && !erased) {
-    erased = EraseAndConfirm(handle->key, handle->hash, &context);
+void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
+  for (;;) {
+    ClockHandle* h = FindAndRef(key, hash);
+    if (h == nullptr) {
+      return;
+    }
+    h->meta.fetch_and(~(uint64_t{ClockHandle::kStateVisibleBit}
+                        << ClockHandle::kStateShift),
+                      std::memory_order_acq_rel);
+    Release(reinterpret_cast<Cache::Handle*>(h), true /* force_erase */);
   }
-  Cleanup(context);
-  return erased;
 }
 
-void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
-  CleanupContext context;
-  EraseAndConfirm(key, hash, &context);
-  Cleanup(context);
+bool ClockCacheShard::ClockUpdate(ClockHandle* h, size_t* freed_charge) {
+  uint64_t meta = h->meta.load(std::memory_order_relaxed);
+  uint8_t state = ClockHandle::GetState(meta);
+  if (!(state & ClockHandle::kStateShareableBit) ||
+      ClockHandle::GetRefcount(meta) != 0) {
+    return false;
+  }
+  uint64_t countdown =
+      (meta >> ClockHandle::kAcquireCounterShift) & ClockHandle::kCounterMask;
+  if (state == ClockHandle::kStateVisible && countdown > 0) {
+    uint64_t new_countdown =
+        std::min(countdown - 1, ClockHandle::kMaxCountdown - 1);
+    uint64_t new_meta =
+        (uint64_t{state} << ClockHandle::kStateShift) |
+        (new_countdown << ClockHandle::kAcquireCounterShift) |
+        (new_countdown << ClockHandle::kReleaseCounterShift);
+    // Losing a race with a Lookup or Release is fine.
+    h->meta.compare_exchange_strong(meta, new_meta,
+                                    std::memory_order_relaxed);
+    return false;
+  }
+  if (!h->meta.compare_exchange_strong(
+          meta,
+          uint64_t{ClockHandle::kStateConstruction}
+              << ClockHandle::kStateShift,
+          std::memory_order_acquire)) {
+    return false;
+  }
+  *freed_charge = h->total_charge;
+  FreeSlot(h);
+  return true;
 }
 
-bool ClockCacheShard::EraseAndConfirm(const Slice& key, uint32_t hash,
-                                      CleanupContext* context) {
-  MutexLock l(&mutex_);
-  HashTable::accessor accessor;
-  bool erased = false;
-  if (table_.find(accessor, CacheKey(key, hash))) {
-    CacheHandle* handle = accessor->second;
-    table_.erase(accessor);
-    erased = UnsetInCache(handle, context);
+void ClockCacheShard::Evict(size_t requested_charge) {
+  size_t freed_charge = 0;
+  uint64_t old_clock_pointer =
+      clock_pointer_.fetch_add(kClockStepSize, std::memory_order_relaxed);
+  // Enough for each entry to have its countdown run out.
+  const uint64_t max_clock_pointer =
+      old_clock_pointer +
+      ((ClockHandle::kMaxCountdown + 1) << length_bits_);
+  for (;;) {
+    for (uint64_t i = 0; i < kClockStepSize; i++) {
+      ClockHandle* h = &array_[(old_clock_pointer + i) & length_bits_mask_];
+      size_t charge = 0;
+      if (ClockUpdate(h, &charge)) {
+        freed_charge += charge;
+        if (freed_charge >= requested_charge) {
+          return;
+        }
+      }
+    }
+    if (old_clock_pointer >= max_clock_pointer) {
+      return;
+    }
+    old_clock_pointer =
+        clock_pointer_.fetch_add(kClockStepSize, std::memory_order_relaxed);
   }
-  return erased;
 }
 
-void ClockCacheShard::EraseUnRefEntries() {
-  CleanupContext context;
-  {
-    MutexLock l(&mutex_);
-    table_.clear();
-    for (auto& handle : list_) {
-      UnsetInCache(&handle, &context);
+size_t ClockCacheShard::GetUsage() const {
+  return usage_.load(std::memory_order_relaxed);
+}
+
+size_t ClockCacheShard::GetPinnedUsage() const {
+  size_t pinned_usage = detached_usage_.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i <= length_bits_mask_; i++) {
+    const ClockHandle* h = &array_[i];
+    uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if ((ClockHandle::GetState(meta) & ClockHandle::kStateShareableBit) &&
+        ClockHandle::GetRefcount(meta) > 0) {
+      pinned_usage += h->total_charge;
     }
   }
-  Cleanup(context);
+  return pinned_usage;
 }
 
-class ClockCache final : public ShardedCache {
- public:
-  ClockCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-             CacheMetadataChargePolicy metadata_charge_policy)
-      : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
-    int num_shards = 1 << num_shard_bits;
-    shards_ = new ClockCacheShard[num_shards];
-    for (int i = 0; i < num_shards; i++) {
-      shards_[i].set_metadata_charge_policy(metadata_charge_policy);
+void ClockCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
+                                             bool /*thread_safe*/) {
+  for (uint32_t i = 0; i <= length_bits_mask_; i++) {
+    ClockHandle* h = &array_[i];
+    uint64_t meta = h->meta.load(std::memory_order_acquire);
+    if (ClockHandle::GetState(meta) != ClockHandle::kStateVisible) {
+      continue;
+    }
+    meta = h->meta.fetch_add(ClockHandle::kAcquireIncrement,
+                             std::memory_order_acquire);
+    uint8_t state = ClockHandle::GetState(meta);
+    if (state == ClockHandle::kStateVisible) {
+      (*callback)(h->value, h->charge);
+    }
+    if (state & ClockHandle::kStateShareableBit) {
+      h->meta.fetch_sub(ClockHandle::kAcquireIncrement,
+                        std::memory_order_release);
     }
-    SetCapacity(capacity);
-    SetStrictCapacityLimit(strict_capacity_limit);
   }
+}
 
-  ~ClockCache() override { delete[] shards_; }
+void ClockCacheShard::EraseUnRefEntries() {
+  for (uint32_t i = 0; i <= length_bits_mask_; i++) {
+    ClockHandle* h = &array_[i];
+    uint64_t meta = h->meta.load(std::memory_order_relaxed);
+    if ((ClockHandle::GetState(meta) & ClockHandle::kStateShareableBit) &&
+        ClockHandle::GetRefcount(meta) == 0 &&
+        h->meta.compare_exchange_strong(
+            meta,
+            uint64_t{ClockHandle::kStateConstruction}
+                << ClockHandle::kStateShift,
+            std::memory_order_acquire)) {
+      FreeSlot(h);
+    }
+  }
+}
 
-  const char* Name() const override { return "ClockCache"; }
+std::string ClockCacheShard::GetPrintableOptions() const {
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    table_length : %u\n",
+           GetTableLength());
+  return std::string(buffer);
+}
 
-  CacheShard* GetShard(int shard) override {
-    return reinterpret_cast<CacheShard*>(&shards_[shard]);
+ClockCache::ClockCache(size_t capacity, int num_shard_bits,
+                       bool strict_capacity_limit,
+                       CacheMetadataChargePolicy metadata_charge_policy,
+                       size_t estimated_entry_charge)
+    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
+  num_shards_ = 1 << num_shard_bits;
+  shards_ = reinterpret_cast<ClockCacheShard*>(
+      port::cacheline_aligned_alloc(sizeof(ClockCacheShard) * num_shards_));
+  size_t per_shard = (capacity + (num_shards_ - 1)) / num_shards_;
+  for (int i = 0; i < num_shards_; i++) {
+    new (&shards_[i])
+        ClockCacheShard(per_shard, strict_capacity_limit,
+                        estimated_entry_charge, metadata_charge_policy);
   }
+}
 
-  const CacheShard* GetShard(int shard) const override {
-    return reinterpret_cast<CacheShard*>(&shards_[shard]);
+ClockCache::~ClockCache() {
+  if (shards_ != nullptr) {
+    assert(num_shards_ > 0);
+    for (int i = 0; i < num_shards_; i++) {
+      shards_[i].~ClockCacheShard();
+    }
+    port::cacheline_aligned_free(shards_);
   }
+}
 
-  void* Value(Handle* handle) override {
-    return reinterpret_cast<const CacheHandle*>(handle)->value;
-  }
+CacheShard* ClockCache::GetShard(int shard) {
+  return reinterpret_cast<CacheShard*>(&shards_[shard]);
+}
 
-  size_t GetCharge(Handle* handle) const override {
-    return reinterpret_cast<const CacheHandle*>(handle)->charge;
-  }
+const CacheShard* ClockCache::GetShard(int shard) const {
+  return reinterpret_cast<CacheShard*>(&shards_[shard]);
+}
 
-  uint32_t GetHash(Handle* handle) const override {
-    return reinterpret_cast<const CacheHandle*>(handle)->hash;
-  }
+void* ClockCache::Value(Handle* handle) {
+  return reinterpret_cast<const ClockHandle*>(handle)->value;
+}
 
-  void DisownData() override { shards_ = nullptr; }
+size_t ClockCache::GetCharge(Handle* handle) const {
+  return reinterpret_cast<const ClockHandle*>(handle)->charge;
+}
 
- private:
-  ClockCacheShard* shards_;
-};
+uint32_t ClockCache::GetHash(Handle* handle) const {
+  return reinterpret_cast<const ClockHandle*>(handle)->hash;
+}
 
-}  // end anonymous namespace
+void ClockCache::DisownData() {
+#if defined(__clang__)
+#if !defined(__has_feature) || !__has_feature(address_sanitizer)
+  shards_ = nullptr;
+  num_shards_ = 0;
+#endif
+#else  // __clang__
+#ifndef __SANITIZE_ADDRESS__
+  shards_ = nullptr;
+  num_shards_ = 0;
+#endif  // !__SANITIZE_ADDRESS__
+#endif  // __clang__
+}
 
 std::shared_ptr<Cache> NewClockCache(
     size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-    CacheMetadataChargePolicy metadata_charge_policy) {
+    CacheMetadataChargePolicy metadata_charge_policy,
+    size_t estimated_entry_charge) {
+  if (num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
   if (num_shard_bits < 0) {
     num_shard_bits = GetDefaultCacheShardBits(capacity);
   }
-  return std::make_shared<ClockCache>(
-      capacity, num_shard_bits, strict_capacity_limit, metadata_charge_policy);
+  if (estimated_entry_charge == 0) {
+    estimated_entry_charge = kDefaultEstimatedEntryCharge;
+  }
+  return std::make_shared<ClockCache>(capacity, num_shard_bits,
+                                      strict_capacity_limit,
+                                      metadata_charge_policy,
+                                      estimated_entry_charge);
 }
 
 }  // namespace rocksdb
-
-#endif  // SUPPORT_CLOCK_CACHE
@@ -9,8 +9,232 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "cache/sharded_cache.h"
+#include "port/port.h"
 #include "rocksdb/cache.h"
 
-#if defined(TBB) && !defined(ROCKSDB_LITE)
-#define SUPPORT_CLOCK_CACHE
-#endif
+namespace rocksdb {
+
+// An implementation of the Cache interface based on the CLOCK algorithm,
+// with better concurrent performance than LRUCache. Each shard keeps its
+// entries in a fixed-size, open-addressing hash table, and every operation
+// (Insert, Lookup, Release, Erase and eviction) works on the table slots with
+// atomic operations only: there is no mutex, and a Lookup followed by a
+// Release never writes anything but the slot it found.
+//
+// Each slot has a 64-bit atomic "meta" word holding the slot state and two
+// counters, of acquires and of releases:
+//
+//   bits  0..29: acquire counter
+//   bits 30..59: release counter
+//   bits 61..63: state (occupied, shareable and visible bits)
+//
+// The states are:
+//   Empty:        the slot is free.
+//   Construction: the slot is owned exclusively by one thread, which is
+//                 filling it or freeing it. The counters are meaningless.
+//   Visible:      the slot holds an entry that Lookup can find.
+//   Invisible:    the slot holds an entry that was erased or replaced, but
+//                 is still referenced. It is freed on its last Release.
+//
+// The difference of the two counters is the number of external references.
+// A Lookup takes a reference optimistically, by incrementing the acquire
+// counter before comparing the key, and undoes it if the key does not match.
+// A thread can only move an entry to Construction, to free it, with a
+// compare-and-swap that sees no reference, so an entry cannot go away under
+// a reference.
+//
+// When an entry is not referenced, the counters are equal and their value is
+// the entry's CLOCK countdown. The countdown starts from a value that depends
+// on the entry priority, and each Lookup increments it. The eviction sweep
+// ("clock hand") decrements the countdown of each unreferenced entry it
+// passes, capped at kMaxCountdown, and evicts the entries whose countdown is
+// already zero.
+//
+// Keys are located by double hashing. Each slot also counts how many entries
+// had their probe sequence pass over it ("displacements"), so that a Lookup
+// can stop at the first slot that no entry was displaced from.
+//
+// The table is sized when the cache is created, from the capacity and the
+// estimated charge of an entry. It does not grow: once it is full, the cache
+// evicts entries even if it is under capacity. A handle returned by an Insert
+// into a full table is kept outside of the table, and cannot be looked up.
+struct ClockHandle {
+  std::atomic<uint64_t> meta{0};
+  // Number of entries whose probe sequence passed over this slot.
+  std::atomic<uint32_t> displacements{0};
+  uint32_t hash = 0;
+  void* value = nullptr;
+  void (*deleter)(const Slice&, void* value) = nullptr;
+  char* key_data = nullptr;
+  size_t key_length = 0;
+  // The charge given by the user, and the one accounted to the cache.
+  size_t charge = 0;
+  size_t total_charge = 0;
+  // Whether the entry was allocated outside of the table.
+  bool detached = false;
+
+  Slice key() const { return Slice(key_data, key_length); }
+
+  static constexpr int kCounterNumBits = 30;
+  static constexpr uint64_t kCounterMask = (uint64_t{1} << kCounterNumBits) - 1;
+  static constexpr uint64_t kCounterTopBit = uint64_t{1}
+                                             << (kCounterNumBits - 1);
+  static constexpr int kAcquireCounterShift = 0;
+  static constexpr uint64_t kAcquireIncrement = uint64_t{1}
+                                                << kAcquireCounterShift;
+  static constexpr int kReleaseCounterShift = kCounterNumBits;
+  static constexpr uint64_t kReleaseIncrement = uint64_t{1}
+                                                << kReleaseCounterShift;
+
+  static constexpr int kStateShift = 61;
+  static constexpr uint8_t kStateOccupiedBit = 0b001;
+  static constexpr uint8_t kStateShareableBit = 0b010;
+  static constexpr uint8_t kStateVisibleBit = 0b100;
+
+  static constexpr uint8_t kStateEmpty = 0b000;
+  static constexpr uint8_t kStateConstruction = kStateOccupiedBit;
+  static constexpr uint8_t kStateInvisible =
+      kStateOccupiedBit | kStateShareableBit;
+  static constexpr uint8_t kStateVisible =
+      kStateOccupiedBit | kStateShareableBit | kStateVisibleBit;
+
+  // Initial countdowns, by priority, and the cap on the countdown.
+  static constexpr uint64_t kHighCountdown = 3;
+  static constexpr uint64_t kLowCountdown = 2;
+  static constexpr uint64_t kMaxCountdown = kHighCountdown;
+
+  static uint8_t GetState(uint64_t meta) {
+    return static_cast<uint8_t>(meta >> kStateShift);
+  }
+  static uint64_t GetRefcount(uint64_t meta) {
+    return ((meta >> kAcquireCounterShift) - (meta >> kReleaseCounterShift)) &
+           kCounterMask;
+  }
+};
+
+class ALIGN_AS(CACHE_LINE_SIZE) ClockCacheShard final : public CacheShard {
+ public:
+  ClockCacheShard(size_t capacity, bool strict_capacity_limit,
+                  size_t estimated_entry_charge,
+                  CacheMetadataChargePolicy metadata_charge_policy);
+  virtual ~ClockCacheShard() override;
+
+  // If current usage is more than the new capacity, evicts unreferenced
+  // entries to free the needed space. The hash table keeps its size.
+  virtual void SetCapacity(size_t capacity) override;
+
+  // Set the flag to reject insertion if cache if full.
+  virtual void SetStrictCapacityLimit(bool strict_capacity_limit) override;
+
+  using CacheShard::Insert;
+  using CacheShard::Lookup;
+
+  // Like Cache methods, but with an extra "hash" parameter.
+  virtual Status Insert(const Slice& key, uint32_t hash, void* value,
+                        size_t charge,
+                        void (*deleter)(const Slice& key, void* value),
+                        Cache::Handle** handle,
+                        Cache::Priority priority) override;
+  virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  virtual bool Ref(Cache::Handle* handle) override;
+  virtual bool Release(Cache::Handle* handle,
+                       bool force_erase = false) override;
+  virtual void Erase(const Slice& key, uint32_t hash) override;
+
+  virtual size_t GetUsage() const override;
+  virtual size_t GetPinnedUsage() const override;
+
+  virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
+                                      bool thread_safe) override;
+
+  virtual void EraseUnRefEntries() override;
+
+  virtual std::string GetPrintableOptions() const override;
+
+  // Returns the number of slots in the hash table.
+  uint32_t GetTableLength() const { return length_bits_mask_ + 1; }
+
+ private:
+  size_t CalcTotalCharge(size_t key_length, size_t charge) const;
+
+  // Reserves a slot in the table, without picking one, if the table is not
+  // already filled up to its load factor.
+  bool TryReserveOccupancy();
+
+  // Claims an empty slot on the probe sequence of `hash`, puts it in the
+  // Construction state and sets its hash. Requires a reserved occupancy,
+  // which is released if no slot could be found.
+  ClockHandle* ClaimSlot(uint32_t hash);
+
+  // Empties a slot in the Construction state, undoing ClaimSlot().
+  void ReleaseSlot(ClockHandle* h);
+
+  // Frees the entry of a slot in the Construction state, and empties it.
+  void FreeSlot(ClockHandle* h);
+
+  // Frees an entry allocated outside of the table.
+  void FreeDetached(ClockHandle* h);
+
+  // Finds a visible entry for the key, and takes a reference to it.
+  ClockHandle* FindAndRef(const Slice& key, uint32_t hash);
+
+  // Advances the clock hand over the table until at least one unreferenced
+  // entry is evicted, and entries of a total charge of at least
+  // `requested_charge`, or until every entry has had its countdown run out.
+  void Evict(size_t requested_charge);
+
+  // Clock hand step for one slot: decrements the countdown of an
+  // unreferenced entry, or evicts it if the countdown is zero. Returns
+  // whether the entry was evicted, and its charge.
+  bool ClockUpdate(ClockHandle* h, size_t* freed_charge);
+
+  // Keeps the counters from overflowing into each other, by clearing the top
+  // bit of both once the release counter reaches it.
+  static void CorrectNearOverflow(uint64_t meta, std::atomic<uint64_t>* target);
+
+  // Number of slots is a power of two.
+  const int length_bits_;
+  const uint32_t length_bits_mask_;
+  // Maximum number of entries in the table.
+  const uint32_t occupancy_limit_;
+  const std::unique_ptr<ClockHandle[]> array_;
+
+  // Position of the clock hand. Only the low length_bits_ bits are used as
+  // the slot index.
+  std::atomic<uint64_t> clock_pointer_;
+  // Number of slots reserved or in use.
+  std::atomic<uint32_t> occupancy_;
+  // Total charge of the entries, including the detached ones.
+  std::atomic<size_t> usage_;
+  // Charge of the entries allocated outside of the table.
+  std::atomic<size_t> detached_usage_;
+
+  std::atomic<size_t> capacity_;
+  std::atomic<bool> strict_capacity_limit_;
+};
+
+class ClockCache final : public ShardedCache {
+ public:
+  ClockCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+             CacheMetadataChargePolicy metadata_charge_policy,
+             size_t estimated_entry_charge);
+  virtual ~ClockCache();
+  virtual const char* Name() const override { return "ClockCache"; }
+  virtual CacheShard* GetShard(int shard) override;
+  virtual const CacheShard* GetShard(int shard) const override;
+  virtual void* Value(Handle* handle) override;
+  virtual size_t GetCharge(Handle* handle) const override;
+  virtual uint32_t GetHash(Handle* handle) const override;
+  virtual void DisownData() override;
+
+ private:
+  ClockCacheShard* shards_ = nullptr;
+  int num_shards_ = 0;
+};
+
+}  // namespace rocksdb
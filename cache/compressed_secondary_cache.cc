@@ -0,0 +1,210 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_secondary_cache.h"
+
+#include <stdio.h>
+#include <memory>
+#include <string>
+
+#include "memory/memory_allocator.h"
+#include "util/compression.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Compress `raw` into `output`. Returns false if the compression type is not
+// supported by this build or the compression library failed.
+bool CompressEntry(const Slice& raw, CompressionType type,
+                   uint32_t format_version, std::string* output) {
+  CompressionOptions opts;
+  CompressionContext context(type);
+  CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(), type,
+                       0 /* sample_for_compression */);
+  switch (type) {
+    case kSnappyCompression:
+      return Snappy_Compress(info, raw.data(), raw.size(), output);
+    case kZlibCompression:
+      return Zlib_Compress(info, format_version, raw.data(), raw.size(),
+                           output);
+    case kBZip2Compression:
+      return BZip2_Compress(info, format_version, raw.data(), raw.size(),
+                            output);
+    case kLZ4Compression:
+      return LZ4_Compress(info, format_version, raw.data(), raw.size(),
+                          output);
+    case kLZ4HCCompression:
+      return LZ4HC_Compress(info, format_version, raw.data(), raw.size(),
+                            output);
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      return ZSTD_Compress(info, raw.data(), raw.size(), output);
+    default:
+      return false;
+  }
+}
+
+// Uncompress an entry produced by CompressEntry(). Returns nullptr on
+// failure, or if the result is not `uncompressed_size` bytes long.
+CacheAllocationPtr UncompressEntry(const Slice& compressed,
+                                   CompressionType type,
+                                   uint32_t format_version,
+                                   size_t uncompressed_size,
+                                   MemoryAllocator* allocator) {
+  UncompressionContext context(type);
+  UncompressionInfo info(context, UncompressionDict::GetEmptyDict(), type);
+  CacheAllocationPtr result;
+  int decompress_size = 0;
+  switch (type) {
+    case kSnappyCompression:
+      result = AllocateBlock(uncompressed_size, allocator);
+      if (!Snappy_Uncompress(compressed.data(), compressed.size(),
+                             result.get())) {
+        return nullptr;
+      }
+      return result;
+    case kZlibCompression:
+      result = Zlib_Uncompress(info, compressed.data(), compressed.size(),
+                               &decompress_size, format_version, allocator);
+      break;
+    case kBZip2Compression:
+      result = BZip2_Uncompress(compressed.data(), compressed.size(),
+                                &decompress_size, format_version, allocator);
+      break;
+    case kLZ4Compression:
+    case kLZ4HCCompression:
+      result = LZ4_Uncompress(info, compressed.data(), compressed.size(),
+                              &decompress_size, format_version, allocator);
+      break;
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      result = ZSTD_Uncompress(info, compressed.data(), compressed.size(),
+                               &decompress_size, allocator);
+      break;
+    default:
+      return nullptr;
+  }
+  if (!result || static_cast<size_t>(decompress_size) != uncompressed_size) {
+    return nullptr;
+  }
+  return result;
+}
+
+}  // namespace
+
+struct CompressedSecondaryCache::CacheValue {
+  CompressionType type = kNoCompression;
+  size_t uncompressed_size = 0;
+  std::string data;
+};
+
+CompressedSecondaryCache::CompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts)
+    : opts_(opts),
+      cache_(NewLRUCache(opts.capacity, opts.num_shard_bits,
+                         false /* strict_capacity_limit */,
+                         0.0 /* high_pri_pool_ratio */)) {}
+
+CompressedSecondaryCache::~CompressedSecondaryCache() { cache_.reset(); }
+
+void CompressedSecondaryCache::DeleteCacheValue(const Slice& /*key*/,
+                                                void* value) {
+  delete reinterpret_cast<CacheValue*>(value);
+}
+
+Status CompressedSecondaryCache::Insert(const Slice& key, void* value,
+                                        const Cache::CacheItemHelper* helper) {
+  if (helper == nullptr || helper->size_cb == nullptr ||
+      helper->saveto_cb == nullptr) {
+    return Status::InvalidArgument("Entry cannot be serialized");
+  }
+  size_t size = (*helper->size_cb)(value);
+  std::string raw;
+  raw.resize(size);
+  Status s = (*helper->saveto_cb)(value, 0, size, &raw[0]);
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::unique_ptr<CacheValue> entry(new CacheValue());
+  entry->uncompressed_size = size;
+  if (opts_.compression_type != kNoCompression &&
+      CompressionTypeSupported(opts_.compression_type) &&
+      CompressEntry(raw, opts_.compression_type, opts_.compress_format_version,
+                    &entry->data) &&
+      entry->data.size() < size) {
+    entry->type = opts_.compression_type;
+  } else {
+    // Not worth compressing
+    entry->data = std::move(raw);
+  }
+
+  size_t charge = entry->data.size();
+  // On failure the value has already been deleted.
+  return cache_->Insert(key, entry.release(), charge, &DeleteCacheValue);
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
+    const Slice& key, const Cache::CreateCallback& create_cb,
+    bool /*wait*/) {
+  Cache::Handle* handle = cache_->Lookup(key);
+  if (handle == nullptr) {
+    return nullptr;
+  }
+
+  CacheValue* entry = reinterpret_cast<CacheValue*>(cache_->Value(handle));
+  void* value = nullptr;
+  size_t charge = 0;
+  Status s;
+  if (entry->type == kNoCompression) {
+    s = create_cb(entry->data.data(), entry->data.size(), &value, &charge);
+  } else {
+    CacheAllocationPtr uncompressed = UncompressEntry(
+        entry->data, entry->type, opts_.compress_format_version,
+        entry->uncompressed_size, opts_.memory_allocator.get());
+    if (!uncompressed) {
+      s = Status::Corruption("Failed to uncompress secondary cache entry");
+    } else {
+      s = create_cb(uncompressed.get(), entry->uncompressed_size, &value,
+                    &charge);
+    }
+  }
+
+  // The entry moves back into the primary cache, so drop this copy.
+  cache_->Erase(key);
+  cache_->Release(handle);
+
+  if (!s.ok()) {
+    return nullptr;
+  }
+  return std::unique_ptr<SecondaryCacheResultHandle>(
+      new CompressedSecondaryCacheResultHandle(value, charge));
+}
+
+void CompressedSecondaryCache::Erase(const Slice& key) { cache_->Erase(key); }
+
+std::string CompressedSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  ret.reserve(20000);
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    compression_type : %s\n",
+           CompressionTypeToString(opts_.compression_type).c_str());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    compress_format_version : %u\n",
+           opts_.compress_format_version);
+  ret.append(buffer);
+  ret.append(cache_->GetPrintableOptions());
+  return ret;
+}
+
+std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts) {
+  return std::make_shared<CompressedSecondaryCache>(opts);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,79 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/secondary_cache.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// The result of a CompressedSecondaryCache lookup. Lookups are served from
+// memory, so it is always ready.
+class CompressedSecondaryCacheResultHandle : public SecondaryCacheResultHandle {
+ public:
+  CompressedSecondaryCacheResultHandle(void* value, size_t size)
+      : value_(value), size_(size) {}
+  ~CompressedSecondaryCacheResultHandle() override = default;
+
+  CompressedSecondaryCacheResultHandle(
+      const CompressedSecondaryCacheResultHandle&) = delete;
+  CompressedSecondaryCacheResultHandle& operator=(
+      const CompressedSecondaryCacheResultHandle&) = delete;
+
+  bool IsReady() override { return true; }
+
+  void Wait() override {}
+
+  void* Value() override { return value_; }
+
+  size_t Size() override { return size_; }
+
+ private:
+  void* value_;
+  size_t size_;
+};
+
+// A secondary cache that keeps the serialized entries compressed in an
+// LRUCache of its own. An entry is erased once it is found by a lookup, as
+// the primary cache holds it from then on.
+class CompressedSecondaryCache : public SecondaryCache {
+ public:
+  explicit CompressedSecondaryCache(
+      const CompressedSecondaryCacheOptions& opts);
+  ~CompressedSecondaryCache() override;
+
+  const char* Name() const override { return "CompressedSecondaryCache"; }
+
+  Status Insert(const Slice& key, void* value,
+                const Cache::CacheItemHelper* helper) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CreateCallback& create_cb,
+      bool wait) override;
+
+  void Erase(const Slice& key) override;
+
+  std::string GetPrintableOptions() const override;
+
+  // Returns the charge of all entries, i.e. their compressed size.
+  size_t TEST_GetUsage() const { return cache_->GetUsage(); }
+
+ private:
+  // A serialized entry, as stored in cache_.
+  struct CacheValue;
+
+  static void DeleteCacheValue(const Slice& key, void* value);
+
+  const CompressedSecondaryCacheOptions opts_;
+  std::shared_ptr<Cache> cache_;
+};
+
+}  // namespace rocksdb
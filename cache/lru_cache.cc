@@ -95,10 +95,10 @@ void LRUHandleTable::Resize() {
   length_ = new_length;
 }
 
-LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
-                             double high_pri_pool_ratio,
-                             bool use_adaptive_mutex,
-                             CacheMetadataChargePolicy metadata_charge_policy)
+LRUCacheShard::LRUCacheShard(
+    size_t capacity, bool strict_capacity_limit, double high_pri_pool_ratio,
+    bool use_adaptive_mutex, CacheMetadataChargePolicy metadata_charge_policy,
+    const std::shared_ptr<SecondaryCache>& secondary_cache)
     : capacity_(0),
       high_pri_pool_usage_(0),
       strict_capacity_limit_(strict_capacity_limit),
@@ -106,7 +106,8 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
       high_pri_pool_capacity_(0),
       usage_(0),
       lru_usage_(0),
-      mutex_(use_adaptive_mutex) {
+      mutex_(use_adaptive_mutex),
+      secondary_cache_(secondary_cache) {
   set_metadata_charge_policy(metadata_charge_policy);
   // Make empty circular linked list
   lru_.next = &lru_;
@@ -258,7 +259,17 @@ void LRUCacheShard::SetCapacity(size_t capacity) {
   }
 
   // Free the entries outside of mutex for performance reasons
-  for (auto entry : last_reference_list) {
+  SpillAndFree(last_reference_list);
+}
+
+void LRUCacheShard::SpillAndFree(const autovector<LRUHandle*>& evicted) {
+  for (auto entry : evicted) {
+    if (secondary_cache_ && entry->helper != nullptr &&
+        entry->value != nullptr) {
+      // The secondary cache may drop the entry, so the status is only
+      // informational.
+      secondary_cache_->Insert(entry->key(), entry->value, entry->helper);
+    }
     entry->Free();
   }
 }
@@ -283,6 +294,89 @@ Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
   return reinterpret_cast<Cache::Handle*>(e);
 }
 
+Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash,
+                                     const Cache::CacheItemHelper* helper,
+                                     const Cache::CreateCallback& create_cb,
+                                     Cache::Priority priority, bool wait) {
+  Cache::Handle* handle = Lookup(key, hash);
+  if (handle != nullptr || !secondary_cache_ || helper == nullptr ||
+      !create_cb) {
+    return handle;
+  }
+
+  std::unique_ptr<SecondaryCacheResultHandle> sec_handle =
+      secondary_cache_->Lookup(key, create_cb, wait);
+  if (!sec_handle) {
+    return nullptr;
+  }
+
+  // Hand out a pending handle, which is not in the cache until promoted.
+  LRUHandle* e = reinterpret_cast<LRUHandle*>(
+      new char[sizeof(LRUHandle) - 1 + key.size()]);
+  e->sec_handle = sec_handle.release();
+  e->deleter = helper->del_cb;
+  e->helper = helper;
+  e->charge = 0;
+  e->key_length = key.size();
+  e->flags = 0;
+  e->hash = hash;
+  e->refs = 0;
+  e->next = e->prev = nullptr;
+  e->SetPriority(priority);
+  e->SetPending(true);
+  memcpy(e->key_data, key.data(), key.size());
+  e->Ref();
+
+  if (e->sec_handle->IsReady()) {
+    Promote(e);
+    if (e->value == nullptr) {
+      Release(reinterpret_cast<Cache::Handle*>(e));
+      return nullptr;
+    }
+  }
+  return reinterpret_cast<Cache::Handle*>(e);
+}
+
+void LRUCacheShard::Promote(LRUHandle* e) {
+  SecondaryCacheResultHandle* sec_handle = e->sec_handle;
+  assert(e->IsPending());
+  assert(sec_handle->IsReady());
+  assert(e->refs == 1);
+  e->SetPending(false);
+  e->value = sec_handle->Value();
+  e->charge = sec_handle->Size();
+  delete sec_handle;
+
+  if (e->value != nullptr) {
+    // InsertItem takes its own reference for the handle it returns.
+    e->Unref();
+    e->SetInCache(true);
+    Cache::Handle* handle = nullptr;
+    Status s = InsertItem(e, &handle, false /* free_handle_on_fail */);
+    assert(handle == reinterpret_cast<Cache::Handle*>(e));
+    (void)s;
+  } else {
+    // The lookup failed. The handle stays outside of the cache, with no
+    // value, until it is released.
+    e->deleter = nullptr;
+    MutexLock l(&mutex_);
+    usage_ += e->CalcTotalCharge(metadata_charge_policy_);
+  }
+}
+
+bool LRUCacheShard::IsReady(Cache::Handle* handle) {
+  LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
+  return !e->IsPending() || e->sec_handle->IsReady();
+}
+
+void LRUCacheShard::Wait(Cache::Handle* handle) {
+  LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
+  if (e->IsPending()) {
+    e->sec_handle->Wait();
+    Promote(e);
+  }
+}
+
 bool LRUCacheShard::Ref(Cache::Handle* h) {
   LRUHandle* e = reinterpret_cast<LRUHandle*>(h);
   MutexLock l(&mutex_);
@@ -304,6 +398,12 @@ bool LRUCacheShard::Release(Cache::Handle* handle, bool force_erase) {
     return false;
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
+  if (e->IsPending()) {
+    // Never inserted nor charged, so only the owner knows about it.
+    e->Unref();
+    e->Free();
+    return true;
+  }
   bool last_reference = false;
   {
     MutexLock l(&mutex_);
@@ -345,11 +445,10 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   // It shouldn't happen very often though.
   LRUHandle* e = reinterpret_cast<LRUHandle*>(
       new char[sizeof(LRUHandle) - 1 + key.size()]);
-  Status s = Status::OK();
-  autovector<LRUHandle*> last_reference_list;
 
   e->value = value;
   e->deleter = deleter;
+  e->helper = nullptr;
   e->charge = charge;
   e->key_length = key.size();
   e->flags = 0;
@@ -359,6 +458,39 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   e->SetInCache(true);
   e->SetPriority(priority);
   memcpy(e->key_data, key.data(), key.size());
+
+  return InsertItem(e, handle, true /* free_handle_on_fail */);
+}
+
+Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
+                             const Cache::CacheItemHelper* helper,
+                             size_t charge, Cache::Handle** handle,
+                             Cache::Priority priority) {
+  LRUHandle* e = reinterpret_cast<LRUHandle*>(
+      new char[sizeof(LRUHandle) - 1 + key.size()]);
+
+  e->value = value;
+  e->deleter = helper->del_cb;
+  e->helper = helper;
+  e->charge = charge;
+  e->key_length = key.size();
+  e->flags = 0;
+  e->hash = hash;
+  e->refs = 0;
+  e->next = e->prev = nullptr;
+  e->SetInCache(true);
+  e->SetPriority(priority);
+  memcpy(e->key_data, key.data(), key.size());
+
+  return InsertItem(e, handle, true /* free_handle_on_fail */);
+}
+
+Status LRUCacheShard::InsertItem(LRUHandle* e, Cache::Handle** handle,
+                                 bool free_handle_on_fail) {
+  Status s = Status::OK();
+  // Entries evicted to make room, which may move to the secondary cache
+  autovector<LRUHandle*> evicted_list;
+  autovector<LRUHandle*> last_reference_list;
   size_t total_charge = e->CalcTotalCharge(metadata_charge_policy_);
 
   {
@@ -366,18 +498,25 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 
     // Free the space following strict LRU policy until enough space
     // is freed or the lru list is empty
-    EvictFromLRU(total_charge, &last_reference_list);
+    EvictFromLRU(total_charge, &evicted_list);
 
     if ((usage_ + total_charge) > capacity_ &&
         (strict_capacity_limit_ || handle == nullptr)) {
+      e->SetInCache(false);
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
         // into cache and get evicted immediately.
-        e->SetInCache(false);
-        last_reference_list.push_back(e);
+        evicted_list.push_back(e);
       } else {
-        delete[] reinterpret_cast<char*>(e);
-        *handle = nullptr;
+        if (free_handle_on_fail) {
+          delete[] reinterpret_cast<char*>(e);
+          *handle = nullptr;
+        } else {
+          // Keep the entry outside of the cache, charged until released.
+          usage_ += total_charge;
+          e->Ref();
+          *handle = reinterpret_cast<Cache::Handle*>(e);
+        }
         s = Status::Incomplete("Insert failed due to LRU cache being full.");
       }
     } else {
@@ -408,6 +547,7 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   }
 
   // Free the entries here outside of mutex for performance reasons
+  SpillAndFree(evicted_list);
   for (auto entry : last_reference_list) {
     entry->Free();
   }
@@ -461,14 +601,22 @@ std::string LRUCacheShard::GetPrintableOptions() const {
     snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
              high_pri_pool_ratio_);
   }
-  return std::string(buffer);
+  std::string ret(buffer);
+  snprintf(buffer, kBufferSize, "    secondary_cache: %s\n",
+           secondary_cache_ ? secondary_cache_->Name() : "None");
+  ret.append(buffer);
+  if (secondary_cache_) {
+    ret.append(secondary_cache_->GetPrintableOptions());
+  }
+  return ret;
 }
 
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
                    bool strict_capacity_limit, double high_pri_pool_ratio,
                    std::shared_ptr<MemoryAllocator> allocator,
                    bool use_adaptive_mutex,
-                   CacheMetadataChargePolicy metadata_charge_policy)
+                   CacheMetadataChargePolicy metadata_charge_policy,
+                   const std::shared_ptr<SecondaryCache>& secondary_cache)
     : ShardedCache(capacity, num_shard_bits, strict_capacity_limit,
                    std::move(allocator)) {
   num_shards_ = 1 << num_shard_bits;
@@ -478,7 +626,8 @@ LRUCache::LRUCache(size_t capacity, int num_shard_bits,
   for (int i = 0; i < num_shards_; i++) {
     new (&shards_[i])
         LRUCacheShard(per_shard, strict_capacity_limit, high_pri_pool_ratio,
-                      use_adaptive_mutex, metadata_charge_policy);
+                      use_adaptive_mutex, metadata_charge_policy,
+                      secondary_cache);
   }
 }
 
@@ -544,31 +693,33 @@ double LRUCache::GetHighPriPoolRatio() {
 }
 
 std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts) {
-  return NewLRUCache(cache_opts.capacity, cache_opts.num_shard_bits,
-                     cache_opts.strict_capacity_limit,
-                     cache_opts.high_pri_pool_ratio,
-                     cache_opts.memory_allocator, cache_opts.use_adaptive_mutex,
-                     cache_opts.metadata_charge_policy);
-}
-
-std::shared_ptr<Cache> NewLRUCache(
-    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-    double high_pri_pool_ratio,
-    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
-    CacheMetadataChargePolicy metadata_charge_policy) {
-  if (num_shard_bits >= 20) {
+  if (cache_opts.num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+  if (cache_opts.high_pri_pool_ratio < 0.0 ||
+      cache_opts.high_pri_pool_ratio > 1.0) {
     // invalid high_pri_pool_ratio
     return nullptr;
   }
+  int num_shard_bits = cache_opts.num_shard_bits;
   if (num_shard_bits < 0) {
-    num_shard_bits = GetDefaultCacheShardBits(capacity);
+    num_shard_bits = GetDefaultCacheShardBits(cache_opts.capacity);
   }
   return std::make_shared<LRUCache>(
+      cache_opts.capacity, num_shard_bits, cache_opts.strict_capacity_limit,
+      cache_opts.high_pri_pool_ratio, cache_opts.memory_allocator,
+      cache_opts.use_adaptive_mutex, cache_opts.metadata_charge_policy,
+      cache_opts.secondary_cache);
+}
+
+std::shared_ptr<Cache> NewLRUCache(
+    size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+    double high_pri_pool_ratio,
+    std::shared_ptr<MemoryAllocator> memory_allocator, bool use_adaptive_mutex,
+    CacheMetadataChargePolicy metadata_charge_policy) {
+  return NewLRUCache(LRUCacheOptions(
       capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
-      std::move(memory_allocator), use_adaptive_mutex, metadata_charge_policy);
+      std::move(memory_allocator), use_adaptive_mutex, metadata_charge_policy));
 }
 
 }  // namespace rocksdb
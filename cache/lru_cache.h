@@ -8,12 +8,14 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "cache/sharded_cache.h"
 
 #include "port/malloc.h"
 #include "port/port.h"
+#include "rocksdb/secondary_cache.h"
 #include "util/autovector.h"
 
 namespace rocksdb {
@@ -46,10 +48,22 @@ namespace rocksdb {
 // that any successful LRUCacheShard::Lookup/LRUCacheShard::Insert have a
 // matching LRUCache::Release (to move into state 2) or LRUCacheShard::Erase
 // (to move into state 3).
+//
+// A lookup with wait == false that misses and goes to the secondary cache
+// returns a pending handle, which is referenced externally but is neither in
+// the hash table nor charged to the cache. Once the secondary lookup
+// completes, LRUCacheShard::Wait promotes it into state 1 (or state 3 if
+// it could not be inserted).
 
 struct LRUHandle {
-  void* value;
+  union {
+    void* value;
+    // The outstanding secondary cache lookup, while the entry is pending.
+    SecondaryCacheResultHandle* sec_handle;
+  };
   void (*deleter)(const Slice&, void* value);
+  // Set if the entry can be moved to the secondary cache, nullptr otherwise.
+  const Cache::CacheItemHelper* helper;
   LRUHandle* next_hash;
   LRUHandle* next;
   LRUHandle* prev;
@@ -69,6 +83,8 @@ struct LRUHandle {
     IN_HIGH_PRI_POOL = (1 << 2),
     // Wwhether this entry has had any lookups (hits).
     HAS_HIT = (1 << 3),
+    // Whether this entry is waiting for a secondary cache lookup.
+    IS_PENDING = (1 << 4),
   };
 
   uint8_t flags;
@@ -95,6 +111,7 @@ struct LRUHandle {
   bool IsHighPri() const { return flags & IS_HIGH_PRI; }
   bool InHighPriPool() const { return flags & IN_HIGH_PRI_POOL; }
   bool HasHit() const { return flags & HAS_HIT; }
+  bool IsPending() const { return flags & IS_PENDING; }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -122,9 +139,26 @@ struct LRUHandle {
 
   void SetHit() { flags |= HAS_HIT; }
 
+  void SetPending(bool pending) {
+    if (pending) {
+      flags |= IS_PENDING;
+    } else {
+      flags &= ~IS_PENDING;
+    }
+  }
+
   void Free() {
     assert(refs == 0);
-    if (deleter) {
+    if (IsPending()) {
+      // Released without being waited on. Let the lookup finish so that
+      // the object it created, if any, can be deleted.
+      sec_handle->Wait();
+      void* obj = sec_handle->Value();
+      if (obj != nullptr && deleter) {
+        (*deleter)(key(), obj);
+      }
+      delete sec_handle;
+    } else if (deleter) {
       (*deleter)(key(), value);
     }
     delete[] reinterpret_cast<char*>(this);
@@ -193,7 +227,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
  public:
   LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                 double high_pri_pool_ratio, bool use_adaptive_mutex,
-                CacheMetadataChargePolicy metadata_charge_policy);
+                CacheMetadataChargePolicy metadata_charge_policy,
+                const std::shared_ptr<SecondaryCache>& secondary_cache =
+                    nullptr);
   virtual ~LRUCacheShard() override = default;
 
   // Separate from constructor so caller can easily make an array of LRUCache
@@ -214,6 +250,16 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  virtual Status Insert(const Slice& key, uint32_t hash, void* value,
+                        const Cache::CacheItemHelper* helper, size_t charge,
+                        Cache::Handle** handle,
+                        Cache::Priority priority) override;
+  virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash,
+                                const Cache::CacheItemHelper* helper,
+                                const Cache::CreateCallback& create_cb,
+                                Cache::Priority priority, bool wait) override;
+  virtual bool IsReady(Cache::Handle* handle) override;
+  virtual void Wait(Cache::Handle* handle) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual bool Release(Cache::Handle* handle,
                        bool force_erase = false) override;
@@ -256,6 +302,21 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // holding the mutex_
   void EvictFromLRU(size_t charge, autovector<LRUHandle*>* deleted);
 
+  // Insert a fully initialized handle into the cache. If the cache is full
+  // and a handle is requested, the entry is freed and *handle set to nullptr
+  // when free_handle_on_fail is true; otherwise the entry is handed back
+  // outside of the cache, and stays charged until it is released.
+  Status InsertItem(LRUHandle* e, Cache::Handle** handle,
+                    bool free_handle_on_fail);
+
+  // Move the result of a completed secondary cache lookup into the pending
+  // handle, and insert the handle into the cache.
+  void Promote(LRUHandle* e);
+
+  // Offer entries that were evicted for lack of capacity to the secondary
+  // cache, then free them. Must be called without holding mutex_.
+  void SpillAndFree(const autovector<LRUHandle*>& evicted);
+
   // Initialized before use.
   size_t capacity_;
 
@@ -303,6 +364,10 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShard {
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
   mutable port::Mutex mutex_;
+
+  // Tier below this shard, or nullptr. Not protected by mutex_, since it is
+  // only set in the constructor.
+  std::shared_ptr<SecondaryCache> secondary_cache_;
 };
 
 class LRUCache
@@ -316,7 +381,8 @@ class LRUCache
            std::shared_ptr<MemoryAllocator> memory_allocator = nullptr,
            bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
            CacheMetadataChargePolicy metadata_charge_policy =
-               kDontChargeCacheMetadata);
+               kDontChargeCacheMetadata,
+           const std::shared_ptr<SecondaryCache>& secondary_cache = nullptr);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
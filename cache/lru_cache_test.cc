@@ -5,10 +5,14 @@
 
 #include "cache/lru_cache.h"
 
+#include <map>
 #include <string>
 #include <vector>
+#include "cache/compressed_secondary_cache.h"
 #include "port/port.h"
+#include "rocksdb/secondary_cache.h"
 #include "test_util/testharness.h"
+#include "util/compression.h"
 
 namespace rocksdb {
 
@@ -190,6 +194,264 @@ TEST_F(LRUCacheTest, EntriesWithPriority) {
   ValidateLRUList({"e", "f", "g", "Z", "d"}, 2);
 }
 
+
+class LRUSecondaryCacheTest : public testing::Test {
+ public:
+  // A cache entry, serialized as its string contents.
+  class TestItem {
+   public:
+    explicit TestItem(const std::string& buf) : buf_(buf) {}
+    const std::string& buf() const { return buf_; }
+
+   private:
+    std::string buf_;
+  };
+
+  static size_t SizeCallback(void* obj) {
+    return reinterpret_cast<TestItem*>(obj)->buf().size();
+  }
+
+  static Status SaveToCallback(void* from_obj, size_t from_offset,
+                               size_t length, void* out) {
+    const std::string& buf = reinterpret_cast<TestItem*>(from_obj)->buf();
+    memcpy(out, buf.data() + from_offset, length);
+    return Status::OK();
+  }
+
+  static void DeletionCallback(const Slice& /*key*/, void* obj) {
+    delete reinterpret_cast<TestItem*>(obj);
+  }
+
+  static Cache::CacheItemHelper helper_;
+
+  static Cache::CreateCallback MakeCreateCallback() {
+    return [](const void* buf, size_t size, void** out_obj,
+              size_t* charge) -> Status {
+      *out_obj = new TestItem(
+          std::string(reinterpret_cast<const char*>(buf), size));
+      *charge = size;
+      return Status::OK();
+    };
+  }
+
+  class TestResultHandle : public SecondaryCacheResultHandle {
+   public:
+    TestResultHandle(std::string buf, Cache::CreateCallback create_cb,
+                     bool ready)
+        : buf_(std::move(buf)),
+          create_cb_(std::move(create_cb)),
+          ready_(false) {
+      if (ready) {
+        Wait();
+      }
+    }
+
+    bool IsReady() override { return ready_; }
+
+    void Wait() override {
+      if (!ready_) {
+        create_cb_(buf_.data(), buf_.size(), &value_, &size_);
+        ready_ = true;
+      }
+    }
+
+    void* Value() override { return value_; }
+
+    size_t Size() override { return size_; }
+
+   private:
+    std::string buf_;
+    Cache::CreateCallback create_cb_;
+    bool ready_;
+    void* value_ = nullptr;
+    size_t size_ = 0;
+  };
+
+  // Keeps inserted entries in a map. Lookups complete on Wait() unless the
+  // caller asks to wait.
+  class TestSecondaryCache : public SecondaryCache {
+   public:
+    const char* Name() const override { return "TestSecondaryCache"; }
+
+    Status Insert(const Slice& key, void* value,
+                  const Cache::CacheItemHelper* helper) override {
+      std::string buf;
+      buf.resize((*helper->size_cb)(value));
+      Status s = (*helper->saveto_cb)(value, 0, buf.size(), &buf[0]);
+      if (s.ok()) {
+        entries_[key.ToString()] = std::move(buf);
+        num_inserts_++;
+      }
+      return s;
+    }
+
+    std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+        const Slice& key, const Cache::CreateCallback& create_cb,
+        bool wait) override {
+      auto iter = entries_.find(key.ToString());
+      if (iter == entries_.end()) {
+        return nullptr;
+      }
+      num_hits_++;
+      std::unique_ptr<SecondaryCacheResultHandle> result(
+          new TestResultHandle(iter->second, create_cb, wait));
+      entries_.erase(iter);
+      return result;
+    }
+
+    void Erase(const Slice& key) override { entries_.erase(key.ToString()); }
+
+    size_t num_inserts() const { return num_inserts_; }
+    size_t num_hits() const { return num_hits_; }
+
+   private:
+    std::map<std::string, std::string> entries_;
+    size_t num_inserts_ = 0;
+    size_t num_hits_ = 0;
+  };
+
+  std::shared_ptr<Cache> NewCacheWithSecondary(
+      size_t capacity, std::shared_ptr<SecondaryCache> secondary_cache) {
+    LRUCacheOptions opts(capacity, 0 /* num_shard_bits */,
+                         false /* strict_capacity_limit */,
+                         0.0 /* high_pri_pool_ratio */, nullptr,
+                         kDefaultToAdaptiveMutex, kDontChargeCacheMetadata);
+    opts.secondary_cache = std::move(secondary_cache);
+    return NewLRUCache(opts);
+  }
+
+  void InsertItem(Cache* cache, const std::string& key,
+                  const std::string& value) {
+    TestItem* item = new TestItem(value);
+    ASSERT_OK(cache->Insert(key, item, &helper_, value.size()));
+  }
+
+  std::string LookupItem(Cache* cache, const std::string& key) {
+    Cache::Handle* handle =
+        cache->Lookup(key, &helper_, MakeCreateCallback(),
+                      Cache::Priority::LOW, true /* wait */);
+    if (handle == nullptr) {
+      return "NOT_FOUND";
+    }
+    std::string result =
+        reinterpret_cast<TestItem*>(cache->Value(handle))->buf();
+    cache->Release(handle);
+    return result;
+  }
+};
+
+Cache::CacheItemHelper LRUSecondaryCacheTest::helper_(
+    LRUSecondaryCacheTest::SizeCallback, LRUSecondaryCacheTest::SaveToCallback,
+    LRUSecondaryCacheTest::DeletionCallback);
+
+TEST_F(LRUSecondaryCacheTest, EvictToAndPromoteFromSecondary) {
+  std::shared_ptr<TestSecondaryCache> secondary(new TestSecondaryCache());
+  std::shared_ptr<Cache> cache = NewCacheWithSecondary(1024, secondary);
+
+  InsertItem(cache.get(), "k1", std::string(600, 'a'));
+  ASSERT_EQ(0u, secondary->num_inserts());
+  // Evicts k1 into the secondary cache
+  InsertItem(cache.get(), "k2", std::string(600, 'b'));
+  ASSERT_EQ(1u, secondary->num_inserts());
+
+  // The plain Lookup() does not consult the secondary cache
+  ASSERT_EQ(nullptr, cache->Lookup("k1"));
+  // k1 is promoted back, evicting k2
+  ASSERT_EQ(std::string(600, 'a'), LookupItem(cache.get(), "k1"));
+  ASSERT_EQ(1u, secondary->num_hits());
+  ASSERT_EQ(2u, secondary->num_inserts());
+  ASSERT_EQ(600u, cache->GetUsage());
+
+  // k1 is in the primary cache now
+  ASSERT_EQ(std::string(600, 'a'), LookupItem(cache.get(), "k1"));
+  ASSERT_EQ(1u, secondary->num_hits());
+  ASSERT_EQ(std::string(600, 'b'), LookupItem(cache.get(), "k2"));
+  ASSERT_EQ(2u, secondary->num_hits());
+  ASSERT_EQ(3u, secondary->num_inserts());
+  ASSERT_EQ("NOT_FOUND", LookupItem(cache.get(), "k3"));
+
+  // Entries inserted without a helper are dropped when evicted
+  ASSERT_OK(cache->Insert("k4", new TestItem(std::string(600, 'c')), 600,
+                          &DeletionCallback));
+  ASSERT_EQ(4u, secondary->num_inserts());
+  InsertItem(cache.get(), "k5", std::string(600, 'd'));
+  ASSERT_EQ(4u, secondary->num_inserts());
+  ASSERT_EQ("NOT_FOUND", LookupItem(cache.get(), "k4"));
+
+  // Erased entries are not moved to the secondary cache
+  cache->Erase("k5");
+  ASSERT_EQ(4u, secondary->num_inserts());
+  ASSERT_EQ(0u, cache->GetUsage());
+}
+
+TEST_F(LRUSecondaryCacheTest, PendingLookup) {
+  std::shared_ptr<TestSecondaryCache> secondary(new TestSecondaryCache());
+  std::shared_ptr<Cache> cache = NewCacheWithSecondary(1024, secondary);
+
+  InsertItem(cache.get(), "k1", std::string(600, 'a'));
+  InsertItem(cache.get(), "k2", std::string(600, 'b'));
+  InsertItem(cache.get(), "k3", std::string(600, 'c'));
+  ASSERT_EQ(2u, secondary->num_inserts());
+
+  Cache::Handle* handle1 =
+      cache->Lookup("k1", &helper_, MakeCreateCallback(), Cache::Priority::LOW,
+                    false /* wait */);
+  ASSERT_NE(nullptr, handle1);
+  ASSERT_FALSE(cache->IsReady(handle1));
+  // Pending lookups are not charged
+  ASSERT_EQ(600u, cache->GetUsage());
+  cache->Wait(handle1);
+  ASSERT_TRUE(cache->IsReady(handle1));
+  ASSERT_EQ(std::string(600, 'a'),
+            reinterpret_cast<TestItem*>(cache->Value(handle1))->buf());
+  ASSERT_EQ(600u, cache->GetUsage());
+  ASSERT_EQ(3u, secondary->num_inserts());
+  cache->Release(handle1);
+
+  // A pending handle can be released without waiting
+  Cache::Handle* handle2 =
+      cache->Lookup("k2", &helper_, MakeCreateCallback(), Cache::Priority::LOW,
+                    false /* wait */);
+  ASSERT_NE(nullptr, handle2);
+  ASSERT_FALSE(cache->IsReady(handle2));
+  cache->Release(handle2);
+  ASSERT_EQ(std::string(600, 'a'), LookupItem(cache.get(), "k1"));
+  ASSERT_EQ("NOT_FOUND", LookupItem(cache.get(), "k2"));
+}
+
+TEST_F(LRUSecondaryCacheTest, CompressedSecondaryCache) {
+  CompressedSecondaryCacheOptions secondary_opts(
+      4096, 0 /* num_shard_bits */,
+      Zlib_Supported() ? kZlibCompression : kNoCompression);
+  std::shared_ptr<CompressedSecondaryCache> secondary(
+      new CompressedSecondaryCache(secondary_opts));
+  std::shared_ptr<Cache> cache = NewCacheWithSecondary(1024, secondary);
+
+  std::string value1(1000, 'a');
+  std::string value2;
+  for (int i = 0; i < 100; i++) {
+    value2.append("0123456789");
+  }
+  InsertItem(cache.get(), "k1", value1);
+  InsertItem(cache.get(), "k2", value2);
+  if (Zlib_Supported()) {
+    ASSERT_LT(secondary->TEST_GetUsage(), value1.size());
+  } else {
+    ASSERT_EQ(value1.size(), secondary->TEST_GetUsage());
+  }
+
+  ASSERT_EQ(value1, LookupItem(cache.get(), "k1"));
+  ASSERT_EQ(value2, LookupItem(cache.get(), "k2"));
+  ASSERT_EQ(value1, LookupItem(cache.get(), "k1"));
+  ASSERT_EQ("NOT_FOUND", LookupItem(cache.get(), "k3"));
+
+  // An entry found in the secondary cache is removed from it
+  secondary->Erase("k2");
+  ASSERT_EQ("NOT_FOUND", LookupItem(cache.get(), "k2"));
+  ASSERT_NE(std::string::npos,
+            cache->GetPrintableOptions().find("CompressedSecondaryCache"));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
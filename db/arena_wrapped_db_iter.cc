@@ -35,7 +35,7 @@ void ArenaWrappedDBIter::Init(Env* env, const ReadOptions& read_options,
                               const MutableCFOptions& mutable_cf_options,
                               const SequenceNumber& sequence,
                               uint64_t max_sequential_skip_in_iteration,
-                              uint64_t version_number,
+                              uint64_t version_number, Version* version,
                               ReadCallback* read_callback, DBImpl* db_impl,
                               ColumnFamilyData* cfd, bool allow_blob,
                               bool allow_refresh) {
@@ -43,7 +43,8 @@ void ArenaWrappedDBIter::Init(Env* env, const ReadOptions& read_options,
   db_iter_ = new (mem) DBIter(env, read_options, cf_options, mutable_cf_options,
                               cf_options.user_comparator, nullptr, sequence,
                               true, max_sequential_skip_in_iteration,
-                              read_callback, db_impl, cfd, allow_blob);
+                              read_callback, db_impl, cfd, allow_blob,
+                              version);
   sv_number_ = version_number;
   allow_refresh_ = allow_refresh;
 }
@@ -70,8 +71,8 @@ Status ArenaWrappedDBIter::Refresh() {
     }
     Init(env, read_options_, *(cfd_->ioptions()), sv->mutable_cf_options,
          latest_seq, sv->mutable_cf_options.max_sequential_skip_in_iterations,
-         cur_sv_number, read_callback_, db_impl_, cfd_, allow_blob_,
-         allow_refresh_);
+         cur_sv_number, sv->current, read_callback_, db_impl_, cfd_,
+         allow_blob_, allow_refresh_);
 
     InternalIterator* internal_iter = db_impl_->NewInternalIterator(
         read_options_, cfd_, sv, &arena_, db_iter_->GetRangeDelAggregator(),
@@ -89,12 +90,12 @@ ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     const ImmutableCFOptions& cf_options,
     const MutableCFOptions& mutable_cf_options, const SequenceNumber& sequence,
     uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
-    ReadCallback* read_callback, DBImpl* db_impl, ColumnFamilyData* cfd,
-    bool allow_blob, bool allow_refresh) {
+    Version* version, ReadCallback* read_callback, DBImpl* db_impl,
+    ColumnFamilyData* cfd, bool allow_blob, bool allow_refresh) {
   ArenaWrappedDBIter* iter = new ArenaWrappedDBIter();
   iter->Init(env, read_options, cf_options, mutable_cf_options, sequence,
-             max_sequential_skip_in_iterations, version_number, read_callback,
-             db_impl, cfd, allow_blob, allow_refresh);
+             max_sequential_skip_in_iterations, version_number, version,
+             read_callback, db_impl, cfd, allow_blob, allow_refresh);
   if (db_impl != nullptr && cfd != nullptr && allow_refresh) {
     iter->StoreRefreshInfo(read_options, db_impl, cfd, read_callback,
                            allow_blob);
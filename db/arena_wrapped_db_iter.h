@@ -71,8 +71,8 @@ class ArenaWrappedDBIter : public Iterator {
             const MutableCFOptions& mutable_cf_options,
             const SequenceNumber& sequence,
             uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
-            ReadCallback* read_callback, DBImpl* db_impl, ColumnFamilyData* cfd,
-            bool allow_blob, bool allow_refresh);
+            Version* version, ReadCallback* read_callback, DBImpl* db_impl,
+            ColumnFamilyData* cfd, bool allow_blob, bool allow_refresh);
 
   // Store some parameters so we can refresh the iterator at a later point
   // with these same params
@@ -106,7 +106,7 @@ extern ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     const ImmutableCFOptions& cf_options,
     const MutableCFOptions& mutable_cf_options, const SequenceNumber& sequence,
     uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
-    ReadCallback* read_callback, DBImpl* db_impl = nullptr,
+    Version* version, ReadCallback* read_callback, DBImpl* db_impl = nullptr,
     ColumnFamilyData* cfd = nullptr, bool allow_blob = false,
     bool allow_refresh = true);
 }  // namespace rocksdb
@@ -0,0 +1,15 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <cstdint>
+
+namespace rocksdb {
+
+// The compression format version used for blobs, the same as the StackableDB
+// BlobDB's, so that both use the same blob log format.
+constexpr uint32_t kBlobCompressionFormatVersion = 2;
+
+}  // namespace rocksdb
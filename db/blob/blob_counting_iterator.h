@@ -0,0 +1,145 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <cassert>
+
+#include "db/blob/blob_garbage_meter.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/status.h"
+#include "table/internal_iterator.h"
+
+namespace rocksdb {
+
+// An internal iterator that passes each entry it lands on to a
+// BlobGarbageMeter as the in-flow of a compaction. Used as the input of a
+// subcompaction, so entries at or past the (exclusive) end of the
+// subcompaction, which the compaction iterator may still peek at, are not
+// counted.
+class BlobCountingIterator : public InternalIterator {
+ public:
+  BlobCountingIterator(InternalIterator* iter,
+                       BlobGarbageMeter* blob_garbage_meter,
+                       const Comparator* user_comparator, const Slice* end)
+      : iter_(iter),
+        blob_garbage_meter_(blob_garbage_meter),
+        user_comparator_(user_comparator),
+        end_(end) {
+    assert(iter_);
+    assert(blob_garbage_meter_);
+    assert(user_comparator_);
+
+    UpdateAndCountBlobIfNeeded();
+  }
+
+  bool Valid() const override { return iter_->Valid() && status_.ok(); }
+
+  void SeekToFirst() override {
+    iter_->SeekToFirst();
+    UpdateAndCountBlobIfNeeded();
+  }
+
+  void SeekToLast() override {
+    iter_->SeekToLast();
+    UpdateAndCountBlobIfNeeded();
+  }
+
+  void Seek(const Slice& target) override {
+    iter_->Seek(target);
+    UpdateAndCountBlobIfNeeded();
+  }
+
+  void SeekForPrev(const Slice& target) override {
+    iter_->SeekForPrev(target);
+    UpdateAndCountBlobIfNeeded();
+  }
+
+  void Next() override {
+    assert(Valid());
+    iter_->Next();
+    UpdateAndCountBlobIfNeeded();
+  }
+
+  bool NextAndGetResult(IterateResult* result) override {
+    assert(Valid());
+    const bool res = iter_->NextAndGetResult(result);
+    UpdateAndCountBlobIfNeeded();
+    return res && status_.ok();
+  }
+
+  void Prev() override {
+    assert(Valid());
+    iter_->Prev();
+    UpdateAndCountBlobIfNeeded();
+  }
+
+  Slice key() const override {
+    assert(Valid());
+    return iter_->key();
+  }
+
+  Slice user_key() const override {
+    assert(Valid());
+    return iter_->user_key();
+  }
+
+  Slice value() const override {
+    assert(Valid());
+    return iter_->value();
+  }
+
+  Status status() const override {
+    return status_.ok() ? iter_->status() : status_;
+  }
+
+  bool IsOutOfBound() override { return iter_->IsOutOfBound(); }
+
+  bool MayBeOutOfLowerBound() override {
+    return iter_->MayBeOutOfLowerBound();
+  }
+
+  bool MayBeOutOfUpperBound() override {
+    return iter_->MayBeOutOfUpperBound();
+  }
+
+  void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) override {
+    iter_->SetPinnedItersMgr(pinned_iters_mgr);
+  }
+
+  bool IsKeyPinned() const override { return iter_->IsKeyPinned(); }
+
+  bool IsValuePinned() const override { return iter_->IsValuePinned(); }
+
+  Status GetProperty(std::string prop_name, std::string* prop) override {
+    return iter_->GetProperty(prop_name, prop);
+  }
+
+ private:
+  void UpdateAndCountBlobIfNeeded() {
+    if (!iter_->Valid() || !status_.ok()) {
+      return;
+    }
+
+    if (end_ != nullptr &&
+        user_comparator_->Compare(iter_->user_key(), *end_) >= 0) {
+      return;
+    }
+
+    status_ =
+        blob_garbage_meter_->ProcessInFlow(iter_->key(), iter_->value());
+  }
+
+  InternalIterator* iter_;
+  BlobGarbageMeter* blob_garbage_meter_;
+  const Comparator* user_comparator_;
+  const Slice* end_;
+  Status status_;
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
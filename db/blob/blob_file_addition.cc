@@ -0,0 +1,51 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/blob/blob_file_addition.h"
+
+#include "util/coding.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+void BlobFileAddition::EncodeTo(std::string* output) const {
+  PutVarint64(output, blob_file_number_);
+  PutVarint64Varint64(output, total_blob_count_, total_blob_bytes_);
+}
+
+const char* BlobFileAddition::DecodeFrom(Slice* input) {
+  if (!GetVarint64(input, &blob_file_number_)) {
+    return "blob file addition: file number";
+  }
+  if (!GetVarint64(input, &total_blob_count_)) {
+    return "blob file addition: total blob count";
+  }
+  if (!GetVarint64(input, &total_blob_bytes_)) {
+    return "blob file addition: total blob bytes";
+  }
+  return nullptr;
+}
+
+std::string BlobFileAddition::DebugString() const {
+  std::string r = "blob_file_number: ";
+  AppendNumberTo(&r, blob_file_number_);
+  r.append(" total_blob_count: ");
+  AppendNumberTo(&r, total_blob_count_);
+  r.append(" total_blob_bytes: ");
+  AppendNumberTo(&r, total_blob_bytes_);
+  return r;
+}
+
+bool operator==(const BlobFileAddition& lhs, const BlobFileAddition& rhs) {
+  return lhs.GetBlobFileNumber() == rhs.GetBlobFileNumber() &&
+         lhs.GetTotalBlobCount() == rhs.GetTotalBlobCount() &&
+         lhs.GetTotalBlobBytes() == rhs.GetTotalBlobBytes();
+}
+
+bool operator!=(const BlobFileAddition& lhs, const BlobFileAddition& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,51 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// A blob file written by a flush or compaction, as recorded in the
+// VersionEdit that installs the output of the job.
+class BlobFileAddition {
+ public:
+  BlobFileAddition() = default;
+
+  BlobFileAddition(uint64_t blob_file_number, uint64_t total_blob_count,
+                   uint64_t total_blob_bytes)
+      : blob_file_number_(blob_file_number),
+        total_blob_count_(total_blob_count),
+        total_blob_bytes_(total_blob_bytes) {
+    assert(total_blob_count_ > 0);
+  }
+
+  uint64_t GetBlobFileNumber() const { return blob_file_number_; }
+  uint64_t GetTotalBlobCount() const { return total_blob_count_; }
+  uint64_t GetTotalBlobBytes() const { return total_blob_bytes_; }
+
+  void EncodeTo(std::string* output) const;
+  // Returns nullptr on success, or a description of the error.
+  const char* DecodeFrom(Slice* input);
+
+  std::string DebugString() const;
+
+ private:
+  uint64_t blob_file_number_ = 0;
+  uint64_t total_blob_count_ = 0;
+  // Size of the blob records, headers and keys included, that is, of the
+  // blob file without its header and footer.
+  uint64_t total_blob_bytes_ = 0;
+};
+
+bool operator==(const BlobFileAddition& lhs, const BlobFileAddition& rhs);
+bool operator!=(const BlobFileAddition& lhs, const BlobFileAddition& rhs);
+
+}  // namespace rocksdb
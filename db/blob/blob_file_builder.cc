@@ -0,0 +1,263 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#ifndef ROCKSDB_LITE
+
+#include "db/blob/blob_file_builder.h"
+
+#include <cassert>
+
+#include "db/blob/blob_constants.h"
+#include "db/blob/blob_file_addition.h"
+#include "db/blob_index.h"
+#include "db/version_set.h"
+#include "file/filename.h"
+#include "file/read_write_util.h"
+#include "file/writable_file_writer.h"
+#include "monitoring/statistics.h"
+#include "options/cf_options.h"
+#include "table/block_based/block_based_table_builder.h"
+#include "util/compression.h"
+#include "util/stop_watch.h"
+#include "utilities/blob_db/blob_log_format.h"
+
+namespace rocksdb {
+
+BlobFileBuilder::BlobFileBuilder(
+    VersionSet* versions, Env* env, FileSystem* fs,
+    const ImmutableCFOptions* immutable_cf_options,
+    const MutableCFOptions* mutable_cf_options,
+    const FileOptions* file_options, uint32_t column_family_id,
+    Env::IOPriority io_priority, Env::WriteLifeTimeHint write_hint,
+    std::vector<BlobFileAddition>* blob_file_additions)
+    : versions_(versions),
+      env_(env),
+      fs_(fs),
+      immutable_cf_options_(immutable_cf_options),
+      min_blob_size_(mutable_cf_options->min_blob_size),
+      blob_file_size_(mutable_cf_options->blob_file_size),
+      blob_compression_type_(mutable_cf_options->blob_compression_type),
+      file_options_(file_options),
+      column_family_id_(column_family_id),
+      io_priority_(io_priority),
+      write_hint_(write_hint),
+      blob_file_additions_(blob_file_additions),
+      blob_file_number_(0),
+      file_size_(0),
+      blob_count_(0),
+      blob_bytes_(0) {
+  assert(versions_);
+  assert(env_);
+  assert(fs_);
+  assert(immutable_cf_options_);
+  assert(!immutable_cf_options_->cf_paths.empty());
+  assert(file_options_);
+  assert(blob_file_additions_);
+}
+
+BlobFileBuilder::~BlobFileBuilder() = default;
+
+Status BlobFileBuilder::Add(const Slice& key, const Slice& value,
+                            std::string* blob_index) {
+  assert(blob_index);
+  assert(blob_index->empty());
+
+  if (value.size() < min_blob_size_) {
+    return Status::OK();
+  }
+
+  Status s = OpenBlobFileIfNeeded();
+  if (!s.ok()) {
+    return s;
+  }
+
+  Slice blob = value;
+  std::string compressed_blob;
+  CompressionType compression = kNoCompression;
+  s = CompressBlobIfNeeded(&blob, &compressed_blob, &compression);
+  if (!s.ok()) {
+    return s;
+  }
+
+  uint64_t blob_file_number = 0;
+  uint64_t blob_offset = 0;
+  s = WriteBlobToFile(key, blob, &blob_file_number, &blob_offset);
+  if (!s.ok()) {
+    return s;
+  }
+
+  s = CloseBlobFileIfNeeded();
+  if (!s.ok()) {
+    return s;
+  }
+
+  BlobIndex::EncodeBlob(blob_index, blob_file_number, blob_offset, blob.size(),
+                        compression);
+  return Status::OK();
+}
+
+Status BlobFileBuilder::OpenBlobFileIfNeeded() {
+  if (IsBlobFileOpen()) {
+    return Status::OK();
+  }
+
+  assert(!blob_count_);
+  assert(!blob_bytes_);
+
+  const uint64_t blob_file_number = versions_->NewFileNumber();
+  versions_->AddUninstalledBlobFile(blob_file_number);
+  const std::string blob_file_path = BlobFileName(
+      immutable_cf_options_->cf_paths.front().path, blob_file_number);
+
+  std::unique_ptr<FSWritableFile> file;
+  Status s = NewWritableFile(fs_, blob_file_path, &file, *file_options_);
+  if (!s.ok()) {
+    return s;
+  }
+  file->SetIOPriority(io_priority_);
+  file->SetWriteLifeTimeHint(write_hint_);
+
+  std::unique_ptr<WritableFileWriter> writer(new WritableFileWriter(
+      std::move(file), blob_file_path, *file_options_, env_,
+      immutable_cf_options_->statistics, immutable_cf_options_->listeners));
+
+  blob_db::BlobLogHeader header(column_family_id_, blob_compression_type_,
+                                false /* has_ttl */,
+                                blob_db::ExpirationRange());
+  std::string header_buf;
+  header.EncodeTo(&header_buf);
+  s = writer->Append(header_buf);
+  if (!s.ok()) {
+    return s;
+  }
+
+  writer_ = std::move(writer);
+  blob_file_number_ = blob_file_number;
+  file_size_ = blob_db::BlobLogHeader::kSize;
+  return Status::OK();
+}
+
+Status BlobFileBuilder::CompressBlobIfNeeded(
+    Slice* blob, std::string* compressed_blob,
+    CompressionType* compression) const {
+  assert(blob);
+  assert(compressed_blob);
+  assert(compression);
+
+  *compression = kNoCompression;
+  if (blob_compression_type_ == kNoCompression) {
+    return Status::OK();
+  }
+
+  CompressionOptions opts;
+  CompressionContext context(blob_compression_type_);
+  CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(),
+                       blob_compression_type_,
+                       0 /* sample_for_compression */);
+
+  // Falls back to no compression if the blob does not compress well.
+  *blob = CompressBlock(*blob, info, compression,
+                        kBlobCompressionFormatVersion, false /* do_sample */,
+                        compressed_blob, nullptr, nullptr);
+  return Status::OK();
+}
+
+Status BlobFileBuilder::WriteBlobToFile(const Slice& key, const Slice& blob,
+                                        uint64_t* blob_file_number,
+                                        uint64_t* blob_offset) {
+  assert(IsBlobFileOpen());
+  assert(blob_file_number);
+  assert(blob_offset);
+
+  blob_db::BlobLogRecord record;
+  record.key = key;
+  record.value = blob;
+  record.expiration = 0;
+  std::string header_buf;
+  record.EncodeHeaderTo(&header_buf);
+
+  Status s = writer_->Append(header_buf);
+  if (s.ok()) {
+    s = writer_->Append(key);
+  }
+  if (s.ok()) {
+    s = writer_->Append(blob);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  const uint64_t record_size =
+      blob_db::BlobLogRecord::kHeaderSize + key.size() + blob.size();
+  *blob_file_number = blob_file_number_;
+  *blob_offset = file_size_ + blob_db::BlobLogRecord::kHeaderSize + key.size();
+
+  file_size_ += record_size;
+  ++blob_count_;
+  blob_bytes_ += record_size;
+  return Status::OK();
+}
+
+Status BlobFileBuilder::CloseBlobFile() {
+  assert(IsBlobFileOpen());
+
+  blob_db::BlobLogFooter footer;
+  footer.blob_count = blob_count_;
+  std::string footer_buf;
+  footer.EncodeTo(&footer_buf);
+
+  Status s = writer_->Append(footer_buf);
+  if (s.ok()) {
+    StopWatch sw(env_, immutable_cf_options_->statistics, TABLE_SYNC_MICROS);
+    s = writer_->Sync(immutable_cf_options_->use_fsync);
+  }
+  if (s.ok()) {
+    s = writer_->Close();
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  blob_file_additions_->emplace_back(blob_file_number_, blob_count_,
+                                     blob_bytes_);
+
+  writer_.reset();
+  blob_file_number_ = 0;
+  file_size_ = 0;
+  blob_count_ = 0;
+  blob_bytes_ = 0;
+  return Status::OK();
+}
+
+Status BlobFileBuilder::CloseBlobFileIfNeeded() {
+  assert(IsBlobFileOpen());
+
+  if (file_size_ < blob_file_size_) {
+    return Status::OK();
+  }
+  return CloseBlobFile();
+}
+
+Status BlobFileBuilder::Finish() {
+  if (!IsBlobFileOpen()) {
+    return Status::OK();
+  }
+  return CloseBlobFile();
+}
+
+void BlobFileBuilder::Abandon() {
+  if (!IsBlobFileOpen()) {
+    return;
+  }
+  writer_->Close();
+  writer_.reset();
+  blob_file_number_ = 0;
+  file_size_ = 0;
+  blob_count_ = 0;
+  blob_bytes_ = 0;
+}
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,95 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/options.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+class VersionSet;
+class WritableFileWriter;
+class BlobFileAddition;
+struct ImmutableCFOptions;
+struct MutableCFOptions;
+
+// Writes the large values of a flush or compaction to blob files, in the
+// blob log format of the StackableDB BlobDB (see
+// utilities/blob_db/blob_log_format.h), and hands out the blob indexes
+// (see db/blob_index.h) to store in their place. Starts a new blob file
+// whenever the current one reaches blob_file_size, and reports each finished
+// file to *blob_file_additions.
+//
+// Not thread-safe.
+class BlobFileBuilder {
+ public:
+  BlobFileBuilder(VersionSet* versions, Env* env, FileSystem* fs,
+                  const ImmutableCFOptions* immutable_cf_options,
+                  const MutableCFOptions* mutable_cf_options,
+                  const FileOptions* file_options, uint32_t column_family_id,
+                  Env::IOPriority io_priority,
+                  Env::WriteLifeTimeHint write_hint,
+                  std::vector<BlobFileAddition>* blob_file_additions);
+
+  BlobFileBuilder(const BlobFileBuilder&) = delete;
+  BlobFileBuilder& operator=(const BlobFileBuilder&) = delete;
+
+  ~BlobFileBuilder();
+
+  // Writes the value to a blob file and sets *blob_index to the index to
+  // store in its place, unless the value is smaller than min_blob_size, in
+  // which case *blob_index is left empty. "key" is the user key.
+  Status Add(const Slice& key, const Slice& value, std::string* blob_index);
+
+  // Finishes the current blob file, if any. No more values may be added.
+  Status Finish();
+
+  // Gives up on the current blob file, if any, without reporting it. The
+  // file is left for the obsolete file purge to delete.
+  void Abandon();
+
+ private:
+  bool IsBlobFileOpen() const { return writer_ != nullptr; }
+  Status OpenBlobFileIfNeeded();
+  Status CompressBlobIfNeeded(Slice* blob, std::string* compressed_blob,
+                              CompressionType* compression) const;
+  Status WriteBlobToFile(const Slice& key, const Slice& blob,
+                         uint64_t* blob_file_number, uint64_t* blob_offset);
+  Status CloseBlobFile();
+  Status CloseBlobFileIfNeeded();
+
+  VersionSet* versions_;
+  Env* env_;
+  FileSystem* fs_;
+  const ImmutableCFOptions* immutable_cf_options_;
+  uint64_t min_blob_size_;
+  uint64_t blob_file_size_;
+  CompressionType blob_compression_type_;
+  const FileOptions* file_options_;
+  uint32_t column_family_id_;
+  Env::IOPriority io_priority_;
+  Env::WriteLifeTimeHint write_hint_;
+  std::vector<BlobFileAddition>* blob_file_additions_;
+
+  // State of the blob file being written
+  std::unique_ptr<WritableFileWriter> writer_;
+  uint64_t blob_file_number_;
+  uint64_t file_size_;
+  uint64_t blob_count_;
+  uint64_t blob_bytes_;
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,89 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#ifndef ROCKSDB_LITE
+
+#include "db/blob/blob_file_cache.h"
+
+#include <cassert>
+#include <memory>
+
+#include "db/blob/blob_file_reader.h"
+#include "options/cf_options.h"
+#include "test_util/sync_point.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+namespace {
+
+void DeleteBlobFileReader(const Slice& /*key*/, void* value) {
+  delete static_cast<BlobFileReader*>(value);
+}
+
+// Same key encoding as the table readers (see TableCache).
+Slice GetSliceForBlobFileNumber(const uint64_t* blob_file_number) {
+  return Slice(reinterpret_cast<const char*>(blob_file_number),
+               sizeof(*blob_file_number));
+}
+
+}  // namespace
+
+BlobFileCache::BlobFileCache(Cache* cache,
+                             const ImmutableCFOptions* immutable_cf_options,
+                             const FileOptions* file_options,
+                             uint32_t column_family_id)
+    : cache_(cache),
+      immutable_cf_options_(immutable_cf_options),
+      file_options_(*file_options),
+      column_family_id_(column_family_id) {
+  assert(cache_);
+  assert(immutable_cf_options_);
+}
+
+Status BlobFileCache::GetBlobFileReader(uint64_t blob_file_number,
+                                        Cache::Handle** handle) {
+  assert(handle);
+
+  const Slice key = GetSliceForBlobFileNumber(&blob_file_number);
+  *handle = cache_->Lookup(key);
+  if (*handle != nullptr) {
+    return Status::OK();
+  }
+
+  TEST_SYNC_POINT("BlobFileCache::GetBlobFileReader:DoOpen");
+
+  std::unique_ptr<BlobFileReader> reader;
+  Status s =
+      BlobFileReader::Create(*immutable_cf_options_, file_options_,
+                             column_family_id_, blob_file_number, &reader);
+  if (!s.ok()) {
+    // Do not cache the error, so that the open is retried next time.
+    return s;
+  }
+
+  s = cache_->Insert(key, reader.get(), 1 /* charge */, &DeleteBlobFileReader,
+                     handle);
+  if (s.ok()) {
+    reader.release();
+  }
+  return s;
+}
+
+BlobFileReader* BlobFileCache::GetReaderFromHandle(
+    Cache::Handle* handle) const {
+  return static_cast<BlobFileReader*>(cache_->Value(handle));
+}
+
+void BlobFileCache::ReleaseHandle(Cache::Handle* handle) {
+  cache_->Release(handle);
+}
+
+void BlobFileCache::Evict(Cache* cache, uint64_t blob_file_number) {
+  cache->Erase(GetSliceForBlobFileNumber(&blob_file_number));
+}
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,51 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <cinttypes>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+struct ImmutableCFOptions;
+class BlobFileReader;
+
+// Keeps the BlobFileReaders of a column family open. The readers live in the
+// table cache next to the table readers; both kinds of entries are keyed by
+// file number, and blob and table files never share a number.
+class BlobFileCache {
+ public:
+  BlobFileCache(Cache* cache, const ImmutableCFOptions* immutable_cf_options,
+                const FileOptions* file_options, uint32_t column_family_id);
+
+  BlobFileCache(const BlobFileCache&) = delete;
+  BlobFileCache& operator=(const BlobFileCache&) = delete;
+
+  // Finds or opens the reader of the given blob file. On success, the caller
+  // must release *handle with ReleaseHandle.
+  Status GetBlobFileReader(uint64_t blob_file_number, Cache::Handle** handle);
+
+  BlobFileReader* GetReaderFromHandle(Cache::Handle* handle) const;
+
+  void ReleaseHandle(Cache::Handle* handle);
+
+  // Evicts the reader of the given blob file, if any, from the cache.
+  static void Evict(Cache* cache, uint64_t blob_file_number);
+
+ private:
+  Cache* cache_;
+  const ImmutableCFOptions* immutable_cf_options_;
+  const FileOptions file_options_;
+  uint32_t column_family_id_;
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
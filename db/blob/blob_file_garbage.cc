@@ -0,0 +1,51 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/blob/blob_file_garbage.h"
+
+#include "util/coding.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+void BlobFileGarbage::EncodeTo(std::string* output) const {
+  PutVarint64(output, blob_file_number_);
+  PutVarint64Varint64(output, garbage_blob_count_, garbage_blob_bytes_);
+}
+
+const char* BlobFileGarbage::DecodeFrom(Slice* input) {
+  if (!GetVarint64(input, &blob_file_number_)) {
+    return "blob file garbage: file number";
+  }
+  if (!GetVarint64(input, &garbage_blob_count_)) {
+    return "blob file garbage: garbage blob count";
+  }
+  if (!GetVarint64(input, &garbage_blob_bytes_)) {
+    return "blob file garbage: garbage blob bytes";
+  }
+  return nullptr;
+}
+
+std::string BlobFileGarbage::DebugString() const {
+  std::string r = "blob_file_number: ";
+  AppendNumberTo(&r, blob_file_number_);
+  r.append(" garbage_blob_count: ");
+  AppendNumberTo(&r, garbage_blob_count_);
+  r.append(" garbage_blob_bytes: ");
+  AppendNumberTo(&r, garbage_blob_bytes_);
+  return r;
+}
+
+bool operator==(const BlobFileGarbage& lhs, const BlobFileGarbage& rhs) {
+  return lhs.GetBlobFileNumber() == rhs.GetBlobFileNumber() &&
+         lhs.GetGarbageBlobCount() == rhs.GetGarbageBlobCount() &&
+         lhs.GetGarbageBlobBytes() == rhs.GetGarbageBlobBytes();
+}
+
+bool operator!=(const BlobFileGarbage& lhs, const BlobFileGarbage& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,51 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// Blobs of an existing blob file that a compaction stopped referencing, as
+// recorded in the VersionEdit that installs the output of the compaction.
+// A blob file is obsolete once all its blobs are garbage.
+class BlobFileGarbage {
+ public:
+  BlobFileGarbage() = default;
+
+  BlobFileGarbage(uint64_t blob_file_number, uint64_t garbage_blob_count,
+                  uint64_t garbage_blob_bytes)
+      : blob_file_number_(blob_file_number),
+        garbage_blob_count_(garbage_blob_count),
+        garbage_blob_bytes_(garbage_blob_bytes) {
+    assert(garbage_blob_count_ > 0);
+  }
+
+  uint64_t GetBlobFileNumber() const { return blob_file_number_; }
+  uint64_t GetGarbageBlobCount() const { return garbage_blob_count_; }
+  uint64_t GetGarbageBlobBytes() const { return garbage_blob_bytes_; }
+
+  void EncodeTo(std::string* output) const;
+  // Returns nullptr on success, or a description of the error.
+  const char* DecodeFrom(Slice* input);
+
+  std::string DebugString() const;
+
+ private:
+  uint64_t blob_file_number_ = 0;
+  uint64_t garbage_blob_count_ = 0;
+  // Counted like BlobFileAddition's total_blob_bytes.
+  uint64_t garbage_blob_bytes_ = 0;
+};
+
+bool operator==(const BlobFileGarbage& lhs, const BlobFileGarbage& rhs);
+bool operator!=(const BlobFileGarbage& lhs, const BlobFileGarbage& rhs);
+
+}  // namespace rocksdb
@@ -0,0 +1,189 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#ifndef ROCKSDB_LITE
+
+#include "db/blob/blob_file_reader.h"
+
+#include <cassert>
+#include <string>
+
+#include "db/blob/blob_constants.h"
+#include "file/filename.h"
+#include "file/random_access_file_reader.h"
+#include "monitoring/statistics.h"
+#include "options/cf_options.h"
+#include "table/format.h"
+#include "util/compression.h"
+#include "util/stop_watch.h"
+#include "utilities/blob_db/blob_log_format.h"
+
+namespace rocksdb {
+
+Status BlobFileReader::Create(const ImmutableCFOptions& immutable_cf_options,
+                              const FileOptions& file_options,
+                              uint32_t column_family_id,
+                              uint64_t blob_file_number,
+                              std::unique_ptr<BlobFileReader>* reader) {
+  assert(reader);
+  assert(!immutable_cf_options.cf_paths.empty());
+
+  const std::string blob_file_path = BlobFileName(
+      immutable_cf_options.cf_paths.front().path, blob_file_number);
+  FileSystem* const fs = immutable_cf_options.fs;
+
+  uint64_t file_size = 0;
+  Status s = fs->GetFileSize(blob_file_path, IOOptions(), &file_size, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  if (file_size <
+      blob_db::BlobLogHeader::kSize + blob_db::BlobLogFooter::kSize) {
+    return Status::Corruption("Malformed blob file");
+  }
+
+  std::unique_ptr<FSRandomAccessFile> file;
+  s = fs->NewRandomAccessFile(blob_file_path, file_options, &file, nullptr);
+  RecordTick(immutable_cf_options.statistics, NO_FILE_OPENS);
+  if (!s.ok()) {
+    return s;
+  }
+  if (immutable_cf_options.advise_random_on_open) {
+    file->Hint(FSRandomAccessFile::kRandom);
+  }
+
+  std::unique_ptr<RandomAccessFileReader> file_reader(
+      new RandomAccessFileReader(std::move(file), blob_file_path,
+                                 immutable_cf_options.env,
+                                 immutable_cf_options.statistics,
+                                 BLOB_DB_BLOB_FILE_READ_MICROS, nullptr,
+                                 immutable_cf_options.rate_limiter,
+                                 immutable_cf_options.listeners));
+
+  char header_buf[blob_db::BlobLogHeader::kSize];
+  Slice header_slice;
+  s = file_reader->Read(0, blob_db::BlobLogHeader::kSize, &header_slice,
+                        header_buf);
+  if (!s.ok()) {
+    return s;
+  }
+  blob_db::BlobLogHeader header;
+  s = header.DecodeFrom(header_slice);
+  if (!s.ok()) {
+    return s;
+  }
+  if (header.column_family_id != column_family_id) {
+    return Status::Corruption("Column family ID mismatch in blob file");
+  }
+  if (header.has_ttl) {
+    return Status::Corruption("Unexpected TTL blob file");
+  }
+
+  char footer_buf[blob_db::BlobLogFooter::kSize];
+  Slice footer_slice;
+  s = file_reader->Read(file_size - blob_db::BlobLogFooter::kSize,
+                        blob_db::BlobLogFooter::kSize, &footer_slice,
+                        footer_buf);
+  if (!s.ok()) {
+    return s;
+  }
+  blob_db::BlobLogFooter footer;
+  s = footer.DecodeFrom(footer_slice);
+  if (!s.ok()) {
+    return s;
+  }
+
+  reader->reset(
+      new BlobFileReader(std::move(file_reader), immutable_cf_options));
+  return Status::OK();
+}
+
+BlobFileReader::BlobFileReader(
+    std::unique_ptr<RandomAccessFileReader>&& file_reader,
+    const ImmutableCFOptions& immutable_cf_options)
+    : file_reader_(std::move(file_reader)),
+      immutable_cf_options_(immutable_cf_options) {
+  assert(file_reader_);
+}
+
+BlobFileReader::~BlobFileReader() = default;
+
+Status BlobFileReader::GetBlob(const ReadOptions& read_options,
+                               const Slice& user_key, uint64_t offset,
+                               uint64_t value_size,
+                               CompressionType compression_type,
+                               PinnableSlice* value) const {
+  assert(value);
+
+  const uint64_t key_size = user_key.size();
+  if (offset < blob_db::BlobLogHeader::kSize +
+                   blob_db::BlobLogRecord::kHeaderSize + key_size) {
+    return Status::Corruption("Invalid blob offset");
+  }
+
+  // Read the whole record so that the key stored in it can be checked.
+  const uint64_t record_offset =
+      offset - blob_db::BlobLogRecord::kHeaderSize - key_size;
+  const uint64_t record_size =
+      blob_db::BlobLogRecord::kHeaderSize + key_size + value_size;
+
+  std::string buf(static_cast<size_t>(record_size), '\0');
+  Slice record_slice;
+  Status s = file_reader_->Read(record_offset,
+                                static_cast<size_t>(record_size),
+                                &record_slice, &buf[0]);
+  RecordTick(immutable_cf_options_.statistics, BLOB_DB_BLOB_FILE_BYTES_READ,
+             record_slice.size());
+  if (!s.ok()) {
+    return s;
+  }
+  if (record_slice.size() != record_size) {
+    return Status::Corruption("Failed to read blob record");
+  }
+
+  blob_db::BlobLogRecord record;
+  s = record.DecodeHeaderFrom(
+      Slice(record_slice.data(), blob_db::BlobLogRecord::kHeaderSize));
+  if (!s.ok()) {
+    return s;
+  }
+  if (record.key_size != key_size || record.value_size != value_size) {
+    return Status::Corruption("Blob record size mismatch");
+  }
+  record.key = Slice(record_slice.data() + blob_db::BlobLogRecord::kHeaderSize,
+                     static_cast<size_t>(key_size));
+  record.value = Slice(record.key.data() + key_size,
+                       static_cast<size_t>(value_size));
+  if (record.key != user_key) {
+    return Status::Corruption("Key mismatch in blob record");
+  }
+  if (read_options.verify_checksums) {
+    s = record.CheckBlobCRC();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  if (compression_type == kNoCompression) {
+    value->PinSelf(record.value);
+    return Status::OK();
+  }
+
+  BlockContents contents;
+  UncompressionContext context(compression_type);
+  UncompressionInfo info(context, UncompressionDict::GetEmptyDict(),
+                         compression_type);
+  s = UncompressBlockContentsForCompressionType(
+      info, record.value.data(), record.value.size(), &contents,
+      kBlobCompressionFormatVersion, immutable_cf_options_);
+  if (!s.ok()) {
+    return Status::Corruption("Unable to uncompress blob");
+  }
+  value->PinSelf(contents.data);
+  return Status::OK();
+}
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,54 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <cinttypes>
+#include <memory>
+
+#include "rocksdb/file_system.h"
+#include "rocksdb/options.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+struct ImmutableCFOptions;
+class RandomAccessFileReader;
+class PinnableSlice;
+class Slice;
+
+// Reads the blobs of a blob file written by BlobFileBuilder. The header and
+// the footer of the file are validated when the reader is created.
+class BlobFileReader {
+ public:
+  static Status Create(const ImmutableCFOptions& immutable_cf_options,
+                       const FileOptions& file_options,
+                       uint32_t column_family_id, uint64_t blob_file_number,
+                       std::unique_ptr<BlobFileReader>* reader);
+
+  BlobFileReader(const BlobFileReader&) = delete;
+  BlobFileReader& operator=(const BlobFileReader&) = delete;
+
+  ~BlobFileReader();
+
+  // Reads the blob stored at "offset" for "user_key" and sets *value to its
+  // uncompressed contents. Returns Corruption if the record found there does
+  // not belong to "user_key".
+  Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
+                 uint64_t offset, uint64_t value_size,
+                 CompressionType compression_type, PinnableSlice* value) const;
+
+ private:
+  BlobFileReader(std::unique_ptr<RandomAccessFileReader>&& file_reader,
+                 const ImmutableCFOptions& immutable_cf_options);
+
+  std::unique_ptr<RandomAccessFileReader> file_reader_;
+  const ImmutableCFOptions& immutable_cf_options_;
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,297 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "db/column_family.h"
+#include "db/db_test_util.h"
+#include "db/version_set.h"
+#include "file/filename.h"
+#include "port/stack_trace.h"
+#include "util/compression.h"
+#include "utilities/merge_operators.h"
+
+namespace rocksdb {
+
+class DBBlobBasicTest : public DBTestBase {
+ protected:
+  DBBlobBasicTest() : DBTestBase("/db_blob_basic_test") {}
+
+  Options GetBlobOptions() {
+    Options options = CurrentOptions();
+    options.enable_blob_files = true;
+    options.min_blob_size = 0;
+    options.disable_auto_compactions = true;
+    return options;
+  }
+
+  std::vector<uint64_t> GetBlobFileNumbers() {
+    ColumnFamilyData* cfd =
+        reinterpret_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())
+            ->cfd();
+    std::vector<uint64_t> result;
+    for (const auto& pair : cfd->current()->storage_info()->GetBlobFiles()) {
+      result.push_back(pair.first);
+    }
+    return result;
+  }
+
+  std::vector<uint64_t> ListBlobFiles() {
+    std::vector<std::string> files;
+    EXPECT_OK(env_->GetChildren(dbname_, &files));
+    std::vector<uint64_t> result;
+    for (const auto& file : files) {
+      uint64_t number = 0;
+      FileType type;
+      if (ParseFileName(file, &number, &type) && type == kBlobFile) {
+        result.push_back(number);
+      }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+};
+
+TEST_F(DBBlobBasicTest, GetBlob) {
+  Options options = GetBlobOptions();
+  options.min_blob_size = 10;
+  Reopen(options);
+
+  const std::string large_value(100, 'v');
+  ASSERT_OK(Put("large", large_value));
+  ASSERT_OK(Put("small", "tiny"));
+  ASSERT_OK(Flush());
+
+  ASSERT_EQ(1, GetBlobFileNumbers().size());
+  ASSERT_EQ(large_value, Get("large"));
+  ASSERT_EQ("tiny", Get("small"));
+
+  PinnableSlice value;
+  ASSERT_OK(db_->Get(ReadOptions(), db_->DefaultColumnFamily(), "large",
+                     &value));
+  ASSERT_EQ(large_value, value.ToString());
+
+  // Blobs cannot be read without I/O.
+  ReadOptions read_options;
+  read_options.read_tier = kBlockCacheTier;
+  bool value_found = true;
+  std::string result;
+  ASSERT_TRUE(
+      db_->KeyMayExist(read_options, "large", &result, &value_found));
+  ASSERT_FALSE(value_found);
+  ASSERT_TRUE(db_->Get(read_options, "large", &result).IsIncomplete());
+}
+
+TEST_F(DBBlobBasicTest, IteratorAndMultiGet) {
+  Options options = GetBlobOptions();
+  options.blob_compression_type = kSnappyCompression;
+  if (!Snappy_Supported()) {
+    options.blob_compression_type = kNoCompression;
+  }
+  Reopen(options);
+
+  const int kNumKeys = 10;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumKeys; ++i) {
+    keys.push_back(Key(i));
+    ASSERT_OK(Put(Key(i), std::string(1000, static_cast<char>('a' + i))));
+  }
+  ASSERT_OK(Flush());
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    ASSERT_EQ(Key(i), iter->key().ToString());
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i)),
+              iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, i);
+
+  i = kNumKeys - 1;
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), --i) {
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i)),
+              iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(-1, i);
+
+  std::vector<std::string> values = MultiGet(keys);
+  ASSERT_EQ(keys.size(), values.size());
+  for (i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(std::string(1000, static_cast<char>('a' + i)), values[i]);
+  }
+}
+
+TEST_F(DBBlobBasicTest, Reopen) {
+  Options options = GetBlobOptions();
+  Reopen(options);
+
+  ASSERT_OK(Put("key", "blob"));
+  ASSERT_OK(Flush());
+  const std::vector<uint64_t> blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(1, blob_files.size());
+
+  Reopen(options);
+  ASSERT_EQ(blob_files, GetBlobFileNumbers());
+  ASSERT_EQ("blob", Get("key"));
+}
+
+TEST_F(DBBlobBasicTest, MergeWithBlobBase) {
+  Options options = GetBlobOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+
+  ASSERT_OK(Put("key", "base"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Merge("key", "op"));
+
+  ASSERT_EQ("base,op", Get("key"));
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("base,op", iter->value().ToString());
+
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("base,op", Get("key"));
+}
+
+TEST_F(DBBlobBasicTest, OverwrittenBlobFileIsDeleted) {
+  Options options = GetBlobOptions();
+  Reopen(options);
+
+  ASSERT_OK(Put("key1", "old1"));
+  ASSERT_OK(Put("key2", "old2"));
+  ASSERT_OK(Flush());
+  const std::vector<uint64_t> old_blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(1, old_blob_files.size());
+
+  ASSERT_OK(Put("key1", "new1"));
+  ASSERT_OK(Delete("key2"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(2, GetBlobFileNumbers().size());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  const std::vector<uint64_t> blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(1, blob_files.size());
+  ASSERT_NE(old_blob_files.front(), blob_files.front());
+  ASSERT_EQ("new1", Get("key1"));
+  ASSERT_EQ("NOT_FOUND", Get("key2"));
+}
+
+TEST_F(DBBlobBasicTest, GarbageCollection) {
+  Options options = GetBlobOptions();
+  options.enable_blob_garbage_collection = true;
+  options.blob_garbage_collection_age_cutoff = 1.0;
+  Reopen(options);
+
+  ASSERT_OK(Put("key1", "value1"));
+  ASSERT_OK(Put("key3", "value3"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("key2", "value2"));
+  ASSERT_OK(Flush());
+  const std::vector<uint64_t> old_blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(2, old_blob_files.size());
+
+  // All the blobs are still referenced, but they get relocated to a new
+  // blob file.
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  const std::vector<uint64_t> blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(1, blob_files.size());
+  ASSERT_GT(blob_files.front(), old_blob_files.back());
+  ASSERT_EQ("value1", Get("key1"));
+  ASSERT_EQ("value2", Get("key2"));
+  ASSERT_EQ("value3", Get("key3"));
+}
+
+TEST_F(DBBlobBasicTest, NoGarbageCollectionKeepsBlobFiles) {
+  Options options = GetBlobOptions();
+  Reopen(options);
+
+  ASSERT_OK(Put("key1", "value1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("key2", "value2"));
+  ASSERT_OK(Flush());
+  const std::vector<uint64_t> old_blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(2, old_blob_files.size());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  ASSERT_EQ(old_blob_files, GetBlobFileNumbers());
+  ASSERT_EQ("value1", Get("key1"));
+  ASSERT_EQ("value2", Get("key2"));
+}
+
+TEST_F(DBBlobBasicTest, PurgeOnlyOwnBlobFiles) {
+  Options options = GetBlobOptions();
+  options.enable_blob_garbage_collection = true;
+  options.blob_garbage_collection_age_cutoff = 1.0;
+  Reopen(options);
+
+  // A blob file of a stacked BlobDB that shares the DB directory
+  const uint64_t foreign_blob_file = 1;
+  ASSERT_OK(WriteStringToFile(env_, "foreign",
+                              BlobFileName(dbname_, foreign_blob_file)));
+
+  ASSERT_OK(Put("key1", "value1"));
+  ASSERT_OK(Put("key3", "value3"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("key2", "value2"));
+  ASSERT_OK(Flush());
+  std::vector<uint64_t> expected_blob_files = GetBlobFileNumbers();
+  ASSERT_EQ(2, expected_blob_files.size());
+  expected_blob_files.push_back(foreign_blob_file);
+  std::sort(expected_blob_files.begin(), expected_blob_files.end());
+
+  // Pause the compaction after it has started relocating the blobs to a
+  // new blob file, which is left behind
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():PausingManualCompaction:2", [&](void* arg) {
+        auto paused = reinterpret_cast<std::atomic<bool>*>(arg);
+        paused->store(true, std::memory_order_release);
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  db_->CompactRange(CompactRangeOptions(), nullptr, nullptr);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  dbfull()->EnableManualCompaction();
+  ASSERT_EQ(expected_blob_files.size() + 1, ListBlobFiles().size());
+
+  // A full scan deletes the blob file of the failed compaction only
+  ASSERT_OK(db_->DisableFileDeletions());
+  ASSERT_OK(db_->EnableFileDeletions(true /* force */));
+  ASSERT_EQ(expected_blob_files, ListBlobFiles());
+
+  Reopen(options);
+  ASSERT_EQ(expected_blob_files, ListBlobFiles());
+  ASSERT_EQ("value1", Get("key1"));
+  ASSERT_EQ("value2", Get("key2"));
+  ASSERT_EQ("value3", Get("key3"));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr, "SKIPPED as blob files are not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
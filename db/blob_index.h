@@ -83,6 +83,11 @@ class BlobIndex {
     return size_;
   }
 
+  CompressionType compression() const {
+    assert(!IsInlined());
+    return compression_;
+  }
+
   Status DecodeFrom(Slice slice) {
     static const std::string kErrorMessage = "Error while decoding blob index";
     assert(slice.size() > 0);
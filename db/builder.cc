@@ -13,6 +13,7 @@
 #include <deque>
 #include <vector>
 
+#include "db/blob/blob_file_builder.h"
 #include "db/compaction/compaction_iterator.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
@@ -87,7 +88,8 @@ Status BuildTable(
     TableFileCreationReason reason, EventLogger* event_logger, int job_id,
     const Env::IOPriority io_priority, TableProperties* table_properties,
     int level, const uint64_t creation_time, const uint64_t oldest_key_time,
-    Env::WriteLifeTimeHint write_hint, const uint64_t file_creation_time) {
+    Env::WriteLifeTimeHint write_hint, const uint64_t file_creation_time,
+    VersionSet* versions, std::vector<BlobFileAddition>* blob_file_additions) {
   assert((column_family_id ==
           TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) ==
          column_family_name.empty());
@@ -157,11 +159,31 @@ Status BuildTable(
                       snapshots.empty() ? 0 : snapshots.back(),
                       snapshot_checker);
 
+#ifndef ROCKSDB_LITE
+    std::unique_ptr<BlobFileBuilder> blob_file_builder(
+        (mutable_cf_options.enable_blob_files && versions != nullptr &&
+         blob_file_additions != nullptr)
+            ? new BlobFileBuilder(versions, env, fs, &ioptions,
+                                  &mutable_cf_options, &file_options,
+                                  column_family_id, io_priority, write_hint,
+                                  blob_file_additions)
+            : nullptr);
+    BlobFileBuilder* const blob_file_builder_ptr = blob_file_builder.get();
+#else
+    (void)versions;
+    (void)blob_file_additions;
+    BlobFileBuilder* const blob_file_builder_ptr = nullptr;
+#endif  // !ROCKSDB_LITE
+
     CompactionIterator c_iter(
         iter, internal_comparator.user_comparator(), &merge, kMaxSequenceNumber,
         &snapshots, earliest_write_conflict_snapshot, snapshot_checker, env,
         ShouldReportDetailedTime(env, ioptions.statistics),
-        true /* internal key corruption is not ok */, range_del_agg.get());
+        true /* internal key corruption is not ok */, range_del_agg.get(),
+        nullptr /* compaction */, nullptr /* compaction_filter */,
+        nullptr /* shutting_down */, 0 /* preserve_deletes_seqnum */,
+        nullptr /* manual_compaction_paused */, nullptr /* info_log */,
+        blob_file_builder_ptr);
     c_iter.SeekToFirst();
     for (; c_iter.Valid(); c_iter.Next()) {
       const Slice& key = c_iter.key();
@@ -197,6 +219,15 @@ Status BuildTable(
     } else {
       s = builder->Finish();
     }
+#ifndef ROCKSDB_LITE
+    if (blob_file_builder) {
+      if (s.ok() && !empty) {
+        s = blob_file_builder->Finish();
+      } else {
+        blob_file_builder->Abandon();
+      }
+    }
+#endif  // !ROCKSDB_LITE
 
     if (s.ok() && !empty) {
       uint64_t file_size = builder->FileSize();
@@ -9,6 +9,7 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "db/blob/blob_file_addition.h"
 #include "db/range_tombstone_fragmenter.h"
 #include "db/table_properties_collector.h"
 #include "logging/event_logger.h"
@@ -33,6 +34,7 @@ class Iterator;
 class SnapshotChecker;
 class TableCache;
 class VersionEdit;
+class VersionSet;
 class TableBuilder;
 class WritableFileWriter;
 class InternalStats;
@@ -61,6 +63,10 @@ TableBuilder* NewTableBuilder(
 //
 // @param column_family_name Name of the column family that is also identified
 //    by column_family_id, or empty string if unknown.
+// @param versions, blob_file_additions If both are non-null and blob files are
+//    enabled (see AdvancedColumnFamilyOptions::enable_blob_files), large values
+//    are written to new blob files, numbered by versions, which are reported
+//    to *blob_file_additions.
 extern Status BuildTable(
     const std::string& dbname, Env* env, FileSystem* fs,
     const ImmutableCFOptions& options,
@@ -83,6 +89,7 @@ extern Status BuildTable(
     TableProperties* table_properties = nullptr, int level = -1,
     const uint64_t creation_time = 0, const uint64_t oldest_key_time = 0,
     Env::WriteLifeTimeHint write_hint = Env::WLTH_NOT_SET,
-    const uint64_t file_creation_time = 0);
+    const uint64_t file_creation_time = 0, VersionSet* versions = nullptr,
+    std::vector<BlobFileAddition>* blob_file_additions = nullptr);
 
 }  // namespace rocksdb
@@ -246,6 +246,12 @@ ColumnFamilyOptions SanitizeOptions(const ImmutableDBOptions& db_options,
   } else if (result.memtable_prefix_bloom_size_ratio < 0) {
     result.memtable_prefix_bloom_size_ratio = 0;
   }
+  // Same limit for the memtable hash index buckets.
+  if (result.memtable_hash_index_size_ratio > 0.25) {
+    result.memtable_hash_index_size_ratio = 0.25;
+  } else if (result.memtable_hash_index_size_ratio < 0) {
+    result.memtable_hash_index_size_ratio = 0;
+  }
 
   if (!result.prefix_extractor) {
     assert(result.memtable_factory);
@@ -519,6 +525,10 @@ ColumnFamilyData::ColumnFamilyData(
         new InternalStats(ioptions_.num_levels, db_options.env, this));
     table_cache_.reset(new TableCache(ioptions_, file_options, _table_cache,
                                       block_cache_tracer));
+#ifndef ROCKSDB_LITE
+    blob_file_cache_.reset(
+        new BlobFileCache(_table_cache, &ioptions_, &file_options, id_));
+#endif  // !ROCKSDB_LITE
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(
           new LevelCompactionPicker(ioptions_, &internal_comparator_));
@@ -1266,6 +1276,14 @@ Status ColumnFamilyData::ValidateOptions(
     }
   }
 
+  if (db_options.skip_opening_sst_files_on_db_open &&
+      cf_options.compaction_style == kCompactionStyleFIFO &&
+      cf_options.ttl > 0 && cf_options.ttl != kDefaultTtl) {
+    return Status::NotSupported(
+        "FIFO compaction ttl is not supported with "
+        "skip_opening_sst_files_on_db_open");
+  }
+
   if (cf_options.periodic_compaction_seconds > 0 &&
       cf_options.periodic_compaction_seconds != kDefaultPeriodicCompSecs) {
     if (cf_options.table_factory->Name() != BlockBasedTableFactory().Name()) {
@@ -14,6 +14,7 @@
 #include <vector>
 #include <atomic>
 
+#include "db/blob/blob_file_cache.h"
 #include "db/memtable_list.h"
 #include "db/table_cache.h"
 #include "db/table_properties_collector.h"
@@ -381,6 +382,9 @@ class ColumnFamilyData {
                          SequenceNumber earliest_seq);
 
   TableCache* table_cache() const { return table_cache_.get(); }
+#ifndef ROCKSDB_LITE
+  BlobFileCache* blob_file_cache() const { return blob_file_cache_.get(); }
+#endif  // !ROCKSDB_LITE
 
   // See documentation in compaction_picker.h
   // REQUIRES: DB mutex held
@@ -537,6 +541,9 @@ class ColumnFamilyData {
   const bool is_delete_range_supported_;
 
   std::unique_ptr<TableCache> table_cache_;
+#ifndef ROCKSDB_LITE
+  std::unique_ptr<BlobFileCache> blob_file_cache_;
+#endif  // !ROCKSDB_LITE
 
   std::unique_ptr<InternalStats> internal_stats_;
 
@@ -144,6 +144,8 @@ Status CompactedDBImpl::Open(const Options& options,
     return Status::InvalidArgument("merge operator is not supported");
   }
   DBOptions db_options(options);
+  // CompactedDBImpl reads through the table readers of the files directly
+  db_options.skip_opening_sst_files_on_db_open = false;
   std::unique_ptr<CompactedDBImpl> db(new CompactedDBImpl(db_options, dbname));
   Status s = db->Init(options);
   if (s.ok()) {
@@ -6,7 +6,10 @@
 #include <cinttypes>
 
 #include "db/compaction/compaction_iterator.h"
+#include "db/blob/blob_file_builder.h"
+#include "db/blob_index.h"
 #include "db/snapshot_checker.h"
+#include "db/version_set.h"
 #include "port/likely.h"
 #include "rocksdb/listener.h"
 #include "table/internal_iterator.h"
@@ -41,7 +44,8 @@ CompactionIterator::CompactionIterator(
     const std::atomic<bool>* shutting_down,
     const SequenceNumber preserve_deletes_seqnum,
     const std::atomic<bool>* manual_compaction_paused,
-    const std::shared_ptr<Logger> info_log)
+    const std::shared_ptr<Logger> info_log,
+    BlobFileBuilder* blob_file_builder)
     : CompactionIterator(
           input, cmp, merge_helper, last_sequence, snapshots,
           earliest_write_conflict_snapshot, snapshot_checker, env,
@@ -49,7 +53,7 @@ CompactionIterator::CompactionIterator(
           std::unique_ptr<CompactionProxy>(
               compaction ? new CompactionProxy(compaction) : nullptr),
           compaction_filter, shutting_down, preserve_deletes_seqnum,
-          manual_compaction_paused, info_log) {}
+          manual_compaction_paused, info_log, blob_file_builder) {}
 
 CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
@@ -63,7 +67,8 @@ CompactionIterator::CompactionIterator(
     const std::atomic<bool>* shutting_down,
     const SequenceNumber preserve_deletes_seqnum,
     const std::atomic<bool>* manual_compaction_paused,
-    const std::shared_ptr<Logger> info_log)
+    const std::shared_ptr<Logger> info_log,
+    BlobFileBuilder* blob_file_builder)
     : input_(input),
       cmp_(cmp),
       merge_helper_(merge_helper),
@@ -75,6 +80,9 @@ CompactionIterator::CompactionIterator(
       expect_valid_internal_key_(expect_valid_internal_key),
       range_del_agg_(range_del_agg),
       compaction_(std::move(compaction)),
+      blob_file_builder_(blob_file_builder),
+      blob_garbage_collection_cutoff_file_number_(
+          ComputeBlobGarbageCollectionCutoffFileNumber(compaction_.get())),
       compaction_filter_(compaction_filter),
       shutting_down_(shutting_down),
       manual_compaction_paused_(manual_compaction_paused),
@@ -90,6 +98,11 @@ CompactionIterator::CompactionIterator(
       compaction_ == nullptr ? false : compaction_->bottommost_level();
   if (compaction_ != nullptr) {
     level_ptrs_ = std::vector<size_t>(compaction_->number_levels(), 0);
+    Version* const version = compaction_->input_version();
+    if (version != nullptr &&
+        !version->storage_info()->GetBlobFiles().empty()) {
+      blob_fetcher_.reset(new BlobFetcher(version, ReadOptions()));
+    }
   }
   if (snapshots_->size() == 0) {
     // optimize for fast path if there are no snapshots
@@ -573,8 +586,9 @@ void CompactionIterator::NextFromInput() {
       // have hit (A)
       // We encapsulate the merge related state machine in a different
       // object to minimize change to the existing flow.
-      Status s = merge_helper_->MergeUntil(input_, range_del_agg_,
-                                           prev_snapshot, bottommost_level_);
+      Status s =
+          merge_helper_->MergeUntil(input_, range_del_agg_, prev_snapshot,
+                                    bottommost_level_, blob_fetcher_.get());
       merge_out_iter_.SeekToFirst();
 
       if (!s.ok() && !s.IsMergeInProgress()) {
@@ -638,8 +652,121 @@ void CompactionIterator::NextFromInput() {
   }
 }
 
+void CompactionIterator::ExtractLargeValueIfNeeded() {
+#ifndef ROCKSDB_LITE
+  assert(ikey_.type == kTypeValue);
+
+  if (blob_file_builder_ == nullptr) {
+    return;
+  }
+
+  blob_index_.clear();
+  const Status s = blob_file_builder_->Add(user_key(), value_, &blob_index_);
+  if (!s.ok()) {
+    status_ = s;
+    valid_ = false;
+    return;
+  }
+
+  if (blob_index_.empty()) {
+    return;
+  }
+
+  value_ = blob_index_;
+  ikey_.type = kTypeBlobIndex;
+  current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+#endif  // !ROCKSDB_LITE
+}
+
+void CompactionIterator::GarbageCollectBlobIfNeeded() {
+#ifndef ROCKSDB_LITE
+  assert(ikey_.type == kTypeBlobIndex);
+
+  if (blob_fetcher_ == nullptr ||
+      blob_garbage_collection_cutoff_file_number_ == 0) {
+    return;
+  }
+
+  BlobIndex blob_index;
+  Status s = blob_index.DecodeFrom(value_);
+  if (!s.ok()) {
+    status_ = s;
+    valid_ = false;
+    return;
+  }
+  if (blob_index.IsInlined() || blob_index.HasTTL()) {
+    status_ = Status::Corruption("Unexpected TTL/inlined blob index");
+    valid_ = false;
+    return;
+  }
+  if (blob_index.file_number() >=
+      blob_garbage_collection_cutoff_file_number_) {
+    return;
+  }
+
+  blob_value_.Reset();
+  s = blob_fetcher_->FetchBlob(user_key(), value_, &blob_value_);
+  if (!s.ok()) {
+    status_ = s;
+    valid_ = false;
+    return;
+  }
+
+  // Without a blob file builder (blob files disabled since), the blob moves
+  // back into the table file.
+  blob_index_.clear();
+  if (blob_file_builder_ != nullptr) {
+    s = blob_file_builder_->Add(user_key(), blob_value_, &blob_index_);
+    if (!s.ok()) {
+      status_ = s;
+      valid_ = false;
+      return;
+    }
+  }
+
+  if (blob_index_.empty()) {
+    value_ = blob_value_;
+    ikey_.type = kTypeValue;
+    current_key_.UpdateInternalKey(ikey_.sequence, ikey_.type);
+  } else {
+    value_ = blob_index_;
+  }
+#endif  // !ROCKSDB_LITE
+}
+
+uint64_t CompactionIterator::ComputeBlobGarbageCollectionCutoffFileNumber(
+    const CompactionProxy* compaction) {
+  if (compaction == nullptr || !compaction->enable_blob_garbage_collection()) {
+    return 0;
+  }
+
+  Version* const version = compaction->input_version();
+  if (version == nullptr) {
+    return 0;
+  }
+
+  // Blob files are numbered in the order they were created, so the oldest
+  // ones come first.
+  const auto& blob_files = version->storage_info()->GetBlobFiles();
+  const size_t cutoff_index = static_cast<size_t>(
+      compaction->blob_garbage_collection_age_cutoff() * blob_files.size());
+  if (cutoff_index >= blob_files.size()) {
+    return port::kMaxUint64;
+  }
+
+  auto it = blob_files.begin();
+  std::advance(it, cutoff_index);
+  return it->first;
+}
+
 void CompactionIterator::PrepareOutput() {
   if (valid_) {
+    if (ikey_.type == kTypeValue) {
+      ExtractLargeValueIfNeeded();
+    } else if (ikey_.type == kTypeBlobIndex) {
+      GarbageCollectBlobIfNeeded();
+    }
+
     if (compaction_filter_ && ikey_.type == kTypeBlobIndex) {
       const auto blob_decision = compaction_filter_->PrepareBlobOutput(
           user_key(), value_, &compaction_filter_value_);
@@ -10,6 +10,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "db/blob/blob_fetcher.h"
 #include "db/compaction/compaction.h"
 #include "db/compaction/compaction_iteration_stats.h"
 #include "db/merge_helper.h"
@@ -21,6 +22,8 @@
 
 namespace rocksdb {
 
+class BlobFileBuilder;
+
 class CompactionIterator {
  public:
   // A wrapper around Compaction. Has a much smaller interface, only what
@@ -51,6 +54,16 @@ class CompactionIterator {
     virtual bool preserve_deletes() const {
       return compaction_->immutable_cf_options()->preserve_deletes;
     }
+    virtual bool enable_blob_garbage_collection() const {
+      return compaction_->mutable_cf_options()->enable_blob_garbage_collection;
+    }
+    virtual double blob_garbage_collection_age_cutoff() const {
+      return compaction_->mutable_cf_options()
+          ->blob_garbage_collection_age_cutoff;
+    }
+    virtual Version* input_version() const {
+      return compaction_->input_version();
+    }
 
    protected:
     CompactionProxy() = default;
@@ -71,7 +84,8 @@ class CompactionIterator {
       const std::atomic<bool>* shutting_down = nullptr,
       const SequenceNumber preserve_deletes_seqnum = 0,
       const std::atomic<bool>* manual_compaction_paused = nullptr,
-      const std::shared_ptr<Logger> info_log = nullptr);
+      const std::shared_ptr<Logger> info_log = nullptr,
+      BlobFileBuilder* blob_file_builder = nullptr);
 
   // Constructor with custom CompactionProxy, used for tests.
   CompactionIterator(
@@ -86,7 +100,8 @@ class CompactionIterator {
       const std::atomic<bool>* shutting_down = nullptr,
       const SequenceNumber preserve_deletes_seqnum = 0,
       const std::atomic<bool>* manual_compaction_paused = nullptr,
-      const std::shared_ptr<Logger> info_log = nullptr);
+      const std::shared_ptr<Logger> info_log = nullptr,
+      BlobFileBuilder* blob_file_builder = nullptr);
 
   ~CompactionIterator();
 
@@ -123,6 +138,20 @@ class CompactionIterator {
   // Invoke compaction filter if needed.
   void InvokeFilterIfNeeded(bool* need_skip, Slice* skip_until);
 
+  // Moves the value of the current output to a blob file if it is large
+  // enough (see BlobFileBuilder).
+  void ExtractLargeValueIfNeeded();
+
+  // Relocates the blob of the current output if it lives in one of the
+  // oldest blob files (see blob_garbage_collection_age_cutoff), so that the
+  // old file eventually becomes garbage.
+  void GarbageCollectBlobIfNeeded();
+
+  // Returns the number of the first blob file that is not subject to garbage
+  // collection by this compaction.
+  static uint64_t ComputeBlobGarbageCollectionCutoffFileNumber(
+      const CompactionProxy* compaction);
+
   // Given a sequence number, return the sequence number of the
   // earliest snapshot that this sequence number is visible in.
   // The snapshots themselves are arranged in ascending order of
@@ -163,6 +192,10 @@ class CompactionIterator {
   bool expect_valid_internal_key_;
   CompactionRangeDelAggregator* range_del_agg_;
   std::unique_ptr<CompactionProxy> compaction_;
+  BlobFileBuilder* blob_file_builder_;
+  // Set if the input version has blob files
+  std::unique_ptr<BlobFetcher> blob_fetcher_;
+  uint64_t blob_garbage_collection_cutoff_file_number_;
   const CompactionFilter* compaction_filter_;
   const std::atomic<bool>* shutting_down_;
   const std::atomic<bool>* manual_compaction_paused_;
@@ -212,6 +245,10 @@ class CompactionIterator {
   PinnedIteratorsManager pinned_iters_mgr_;
   std::string compaction_filter_value_;
   InternalKey compaction_filter_skip_until_;
+  // Backing storage of value_ when the output is a new blob index or a blob
+  // read during garbage collection
+  std::string blob_index_;
+  PinnableSlice blob_value_;
   // "level_ptrs" holds indices that remember which file of an associated
   // level we were last checking during the last call to compaction->
   // KeyNotExistsBeyondOutputLevel(). This allows future calls to the function
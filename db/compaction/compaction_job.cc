@@ -11,6 +11,7 @@
 #include <cinttypes>
 #include <functional>
 #include <list>
+#include <map>
 #include <memory>
 #include <random>
 #include <set>
@@ -18,8 +19,13 @@
 #include <utility>
 #include <vector>
 
+#include "db/blob/blob_counting_iterator.h"
+#include "db/blob/blob_file_addition.h"
+#include "db/blob/blob_file_builder.h"
+#include "db/blob/blob_garbage_meter.h"
 #include "db/builder.h"
 #include "db/compaction/compaction_job.h"
+#include "db/compaction/compaction_service.h"
 #include "db/db_impl/db_impl.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
@@ -42,7 +48,9 @@
 #include "monitoring/iostats_context_imp.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/thread_status_util.h"
+#include "options/options_helper.h"
 #include "port/port.h"
+#include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/statistics.h"
@@ -142,6 +150,14 @@ struct CompactionJob::SubcompactionState {
 
   uint64_t current_output_file_size;
 
+  // Blob files produced by this subcompaction
+  std::vector<BlobFileAddition> blob_file_additions;
+#ifndef ROCKSDB_LITE
+  // The blob references this subcompaction read and wrote, to tell how much
+  // garbage it left in the existing blob files
+  std::unique_ptr<BlobGarbageMeter> blob_garbage_meter;
+#endif  // ROCKSDB_LITE
+
   // State during the subcompaction
   uint64_t total_bytes;
   uint64_t num_output_records;
@@ -183,6 +199,10 @@ struct CompactionJob::SubcompactionState {
     outfile = std::move(o.outfile);
     builder = std::move(o.builder);
     current_output_file_size = std::move(o.current_output_file_size);
+    blob_file_additions = std::move(o.blob_file_additions);
+#ifndef ROCKSDB_LITE
+    blob_garbage_meter = std::move(o.blob_garbage_meter);
+#endif  // ROCKSDB_LITE
     total_bytes = std::move(o.total_bytes);
     num_output_records = std::move(o.num_output_records);
     compaction_job_stats = std::move(o.compaction_job_stats);
@@ -427,6 +447,36 @@ void CompactionJob::Prepare() {
   }
 }
 
+#ifndef ROCKSDB_LITE
+void CompactionJob::PrepareForCompactionService(const Slice* begin,
+                                                const Slice* end) {
+  AutoThreadOperationStageUpdater stage_updater(
+      ThreadStatus::STAGE_COMPACTION_PREPARE);
+
+  auto* c = compact_->compaction;
+  assert(c->column_family_data() != nullptr);
+
+  write_hint_ =
+      c->column_family_data()->CalculateSSTWriteHint(c->output_level());
+  bottommost_level_ = c->bottommost_level();
+
+  // The subcompaction refers to its boundaries through pointers into
+  // boundaries_.
+  boundaries_.reserve(2);
+  Slice* start = nullptr;
+  Slice* limit = nullptr;
+  if (begin != nullptr) {
+    boundaries_.push_back(*begin);
+    start = &boundaries_.back();
+  }
+  if (end != nullptr) {
+    boundaries_.push_back(*end);
+    limit = &boundaries_.back();
+  }
+  compact_->sub_compact_states.emplace_back(c, start, limit);
+}
+#endif  // !ROCKSDB_LITE
+
 struct RangeWithSize {
   Range range;
   uint64_t size;
@@ -480,6 +530,43 @@ void CompactionJob::GenSubcompactionBoundaries() {
     }
   }
 
+  // The file boundaries are too coarse to split compactions whose inputs are
+  // a few large files, like the L0 files or sorted runs of a universal
+  // compaction, which may each span the whole key space. Add anchors
+  // sampled from inside the input files in that case.
+  const size_t kBoundsPerSubcompaction = 8;
+  size_t wanted_bounds = kBoundsPerSubcompaction * c->max_subcompactions();
+  if (bounds.size() < wanted_bounds) {
+    size_t num_files = 0;
+    for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+      num_files += c->num_input_files(lvl_idx);
+    }
+    size_t anchors_per_file =
+        (wanted_bounds - bounds.size() + num_files - 1) / num_files;
+    std::vector<std::string> anchors;
+    // Reading the index blocks may incur I/O. Unlock db mutex to reduce
+    // contention, as for ApproximateSize() below.
+    db_mutex_->Unlock();
+    for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+      const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
+      for (size_t i = 0; i < flevel->num_files; i++) {
+        // The anchors are only hints, so errors are ignored.
+        cfd->table_cache()->ApproximateKeyAnchors(
+            ReadOptions(), cfd->internal_comparator(), flevel->files[i].fd,
+            anchors_per_file, &anchors,
+            c->mutable_cf_options()->prefix_extractor.get());
+      }
+    }
+    db_mutex_->Lock();
+    anchor_keys_.reserve(anchors.size());
+    for (const std::string& anchor : anchors) {
+      anchor_keys_.emplace_back(anchor, kMaxSequenceNumber, kValueTypeForSeek);
+    }
+    for (const InternalKey& anchor_key : anchor_keys_) {
+      bounds.emplace_back(anchor_key.Encode());
+    }
+  }
+
   std::sort(bounds.begin(), bounds.end(),
             [cfd_comparator](const Slice& a, const Slice& b) -> bool {
               return cfd_comparator->Compare(ExtractUserKey(a),
@@ -801,9 +888,169 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
   return status;
 }
 
+#ifndef ROCKSDB_LITE
+CompactionServiceJobStatus
+CompactionJob::ProcessKeyValueCompactionWithCompactionService(
+    SubcompactionState* sub_compact) {
+  assert(sub_compact != nullptr);
+  assert(db_options_.compaction_service != nullptr);
+
+  const Compaction* compaction = sub_compact->compaction;
+  ColumnFamilyData* cfd = compaction->column_family_data();
+  const MutableCFOptions* mutable_cf_options = compaction->mutable_cf_options();
+  // The worker has neither the blob file builder nor the snapshot checker.
+  if (mutable_cf_options->enable_blob_files || snapshot_checker_ != nullptr) {
+    return CompactionServiceJobStatus::kUseLocal;
+  }
+
+  CompactionServiceInput input;
+  input.column_family_name = cfd->GetName();
+  Status s = GetStringFromDBOptions(
+      &input.db_options, BuildDBOptions(db_options_, MutableDBOptions()));
+  if (s.ok()) {
+    s = GetStringFromColumnFamilyOptions(
+        &input.cf_options, BuildColumnFamilyOptions(cfd->initial_cf_options(),
+                                                    *mutable_cf_options));
+  }
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(db_options_.info_log,
+                   "[%s] [JOB %d] Cannot serialize the options for the "
+                   "compaction service, compacting locally: %s",
+                   cfd->GetName().c_str(), job_id_, s.ToString().c_str());
+    return CompactionServiceJobStatus::kUseLocal;
+  }
+  input.cf_paths = compaction->immutable_cf_options()->cf_paths;
+  input.snapshots = existing_snapshots_;
+  input.earliest_write_conflict_snapshot = earliest_write_conflict_snapshot_;
+  for (size_t i = 0; i < compaction->num_input_levels(); i++) {
+    for (size_t j = 0; j < compaction->num_input_files(i); j++) {
+      input.input_files.push_back(compaction->input(i, j)->fd.GetNumber());
+    }
+  }
+  input.output_level = compaction->output_level();
+  input.target_file_size = compaction->max_output_file_size();
+  input.max_compaction_bytes = compaction->max_compaction_bytes();
+  input.compression = compaction->output_compression();
+  if (sub_compact->start != nullptr) {
+    input.has_begin = true;
+    input.begin = sub_compact->start->ToString();
+  }
+  if (sub_compact->end != nullptr) {
+    input.has_end = true;
+    input.end = sub_compact->end->ToString();
+  }
+  std::string input_str;
+  input.EncodeTo(&input_str);
+
+  // Subcompactions share the job id of the compaction.
+  const uint64_t sub_job_id =
+      (static_cast<uint64_t>(job_id_) << 32) |
+      static_cast<uint64_t>(sub_compact - &compact_->sub_compact_states[0]);
+  ROCKS_LOG_INFO(db_options_.info_log,
+                 "[%s] [JOB %d] Starting remote compaction %" PRIu64
+                 " (output level: %d)",
+                 cfd->GetName().c_str(), job_id_, sub_job_id,
+                 compaction->output_level());
+
+  CompactionService* service = db_options_.compaction_service.get();
+  CompactionServiceJobStatus job_status = service->Start(input_str, sub_job_id);
+  if (job_status == CompactionServiceJobStatus::kUseLocal) {
+    return job_status;
+  }
+  if (job_status != CompactionServiceJobStatus::kSuccess) {
+    sub_compact->status =
+        Status::Incomplete("CompactionService failed to start compaction job");
+    return CompactionServiceJobStatus::kFailure;
+  }
+
+  std::string result_str;
+  job_status = service->WaitForComplete(sub_job_id, &result_str);
+  if (job_status == CompactionServiceJobStatus::kUseLocal) {
+    return job_status;
+  }
+
+  CompactionServiceResult result;
+  s = result.DecodeFrom(result_str);
+  if (s.ok()) {
+    s = result.status;
+  }
+  if (s.ok() && job_status != CompactionServiceJobStatus::kSuccess) {
+    s = Status::Incomplete("CompactionService failed to run compaction job");
+  }
+  if (!s.ok()) {
+    sub_compact->status = s;
+    return CompactionServiceJobStatus::kFailure;
+  }
+
+  // Take over the output files, under file numbers of this DB. The numbers
+  // are protected by the pending outputs of the compaction.
+  const uint32_t output_path_id = compaction->output_path_id();
+  const auto& cf_paths = compaction->immutable_cf_options()->cf_paths;
+  auto prefix_extractor = mutable_cf_options->prefix_extractor.get();
+  for (const auto& file : result.output_files) {
+    const uint64_t file_number = versions_->NewFileNumber();
+    const std::string src = result.output_path + "/" + file.file_name;
+    const std::string fname =
+        TableFileName(cf_paths, file_number, output_path_id);
+    s = fs_->RenameFile(src, fname, IOOptions(), nullptr);
+    uint64_t file_size = 0;
+    if (s.ok()) {
+      s = fs_->GetFileSize(fname, IOOptions(), &file_size, nullptr);
+    }
+    if (!s.ok()) {
+      break;
+    }
+
+    SubcompactionState::Output out;
+    out.meta.fd = FileDescriptor(file_number, output_path_id, file_size,
+                                 file.smallest_seqno, file.largest_seqno);
+    out.meta.smallest.DecodeFrom(file.smallest_internal_key);
+    out.meta.largest.DecodeFrom(file.largest_internal_key);
+    out.meta.oldest_ancester_time = file.oldest_ancester_time;
+    out.meta.file_creation_time = file.file_creation_time;
+    out.meta.marked_for_compaction = file.marked_for_compaction;
+    out.finished = true;
+    s = cfd->table_cache()->GetTableProperties(
+        file_options_, cfd->internal_comparator(), out.meta.fd,
+        &out.table_properties, prefix_extractor);
+    sub_compact->outputs.push_back(std::move(out));
+    sub_compact->total_bytes += file_size;
+    if (!s.ok()) {
+      break;
+    }
+
+    auto sfm =
+        static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
+    if (sfm && output_path_id == 0) {
+      sfm->OnAddFile(fname);
+    }
+  }
+  sub_compact->num_output_records = result.num_output_records;
+  sub_compact->status = s;
+
+  ROCKS_LOG_INFO(db_options_.info_log,
+                 "[%s] [JOB %d] Remote compaction %" PRIu64
+                 " finished with %" ROCKSDB_PRIszt " output files: %s",
+                 cfd->GetName().c_str(), job_id_, sub_job_id,
+                 sub_compact->outputs.size(), s.ToString().c_str());
+  return s.ok() ? CompactionServiceJobStatus::kSuccess
+                : CompactionServiceJobStatus::kFailure;
+}
+#endif  // !ROCKSDB_LITE
+
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   assert(sub_compact != nullptr);
 
+#ifndef ROCKSDB_LITE
+  if (db_options_.compaction_service != nullptr) {
+    CompactionServiceJobStatus job_status =
+        ProcessKeyValueCompactionWithCompactionService(sub_compact);
+    if (job_status != CompactionServiceJobStatus::kUseLocal) {
+      return;
+    }
+  }
+#endif  // !ROCKSDB_LITE
+
   uint64_t prev_cpu_micros = env_->NowCPUNanos() / 1000;
 
   ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
@@ -832,6 +1079,35 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // the AddTombstones calls will be propagated down to the v1 aggregator.
   std::unique_ptr<InternalIterator> input(versions_->MakeInputIterator(
       sub_compact->compaction, &range_del_agg, file_options_for_read_));
+  InternalIterator* input_iter = input.get();
+
+#ifndef ROCKSDB_LITE
+  // Count the blob references of the input to find out, at the end, which
+  // blobs the compaction turned into garbage.
+  std::unique_ptr<InternalIterator> blob_counting_iter;
+  Version* input_version = sub_compact->compaction->input_version();
+  if (input_version != nullptr &&
+      !input_version->storage_info()->GetBlobFiles().empty()) {
+    sub_compact->blob_garbage_meter.reset(new BlobGarbageMeter());
+    blob_counting_iter.reset(new BlobCountingIterator(
+        input_iter, sub_compact->blob_garbage_meter.get(),
+        cfd->user_comparator(), sub_compact->end));
+    input_iter = blob_counting_iter.get();
+  }
+
+  const MutableCFOptions* mutable_cf_options =
+      sub_compact->compaction->mutable_cf_options();
+  std::unique_ptr<BlobFileBuilder> blob_file_builder(
+      mutable_cf_options->enable_blob_files
+          ? new BlobFileBuilder(versions_, env_, fs_, cfd->ioptions(),
+                                mutable_cf_options, &file_options_,
+                                cfd->GetID(), Env::IO_LOW, write_hint_,
+                                &sub_compact->blob_file_additions)
+          : nullptr);
+  BlobFileBuilder* blob_file_builder_ptr = blob_file_builder.get();
+#else
+  BlobFileBuilder* blob_file_builder_ptr = nullptr;
+#endif  // ROCKSDB_LITE
 
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_PROCESS_KV);
@@ -875,19 +1151,19 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   if (start != nullptr) {
     IterKey start_iter;
     start_iter.SetInternalKey(*start, kMaxSequenceNumber, kValueTypeForSeek);
-    input->Seek(start_iter.GetInternalKey());
+    input_iter->Seek(start_iter.GetInternalKey());
   } else {
-    input->SeekToFirst();
+    input_iter->SeekToFirst();
   }
 
   Status status;
   sub_compact->c_iter.reset(new CompactionIterator(
-      input.get(), cfd->user_comparator(), &merge, versions_->LastSequence(),
+      input_iter, cfd->user_comparator(), &merge, versions_->LastSequence(),
       &existing_snapshots_, earliest_write_conflict_snapshot_,
       snapshot_checker_, env_, ShouldReportDetailedTime(env_, stats_), false,
       &range_del_agg, sub_compact->compaction, compaction_filter,
       shutting_down_, preserve_deletes_seqnum_, manual_compaction_paused_,
-      db_options_.info_log));
+      db_options_.info_log, blob_file_builder_ptr));
   auto c_iter = sub_compact->c_iter.get();
   c_iter->SeekToFirst();
   if (c_iter->Valid() && sub_compact->compaction->output_level() != 0) {
@@ -934,6 +1210,15 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         key, value, ikey.sequence, ikey.type);
     sub_compact->num_output_records++;
 
+#ifndef ROCKSDB_LITE
+    if (sub_compact->blob_garbage_meter != nullptr) {
+      status = sub_compact->blob_garbage_meter->ProcessOutFlow(key, value);
+      if (!status.ok()) {
+        break;
+      }
+    }
+#endif  // ROCKSDB_LITE
+
     // Close output file if it is big enough. Two possibilities determine it's
     // time to close it: (1) the current key should be this file's last key, (2)
     // the next key should not be in this file.
@@ -949,7 +1234,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
             sub_compact->compaction->max_output_file_size()) {
       // (1) this key terminates the file. For historical reasons, the iterator
       // status before advancing will be given to FinishCompactionOutputFile().
-      input_status = input->status();
+      input_status = input_iter->status();
       output_file_ended = true;
     }
     TEST_SYNC_POINT_CALLBACK(
@@ -968,7 +1253,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       // (2) this key belongs to the next file. For historical reasons, the
       // iterator status after advancing will be given to
       // FinishCompactionOutputFile().
-      input_status = input->status();
+      input_status = input_iter->status();
       output_file_ended = true;
     }
     if (output_file_ended) {
@@ -1017,7 +1302,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     status = Status::Incomplete(Status::SubCode::kManualCompactionPaused);
   }
   if (status.ok()) {
-    status = input->status();
+    status = input_iter->status();
   }
   if (status.ok()) {
     status = c_iter->status();
@@ -1041,6 +1326,16 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     RecordDroppedKeys(range_del_out_stats, &sub_compact->compaction_job_stats);
   }
 
+#ifndef ROCKSDB_LITE
+  if (blob_file_builder != nullptr) {
+    if (status.ok()) {
+      status = blob_file_builder->Finish();
+    } else {
+      blob_file_builder->Abandon();
+    }
+  }
+#endif  // ROCKSDB_LITE
+
   sub_compact->compaction_job_stats.cpu_micros =
       env_->NowCPUNanos() / 1000 - prev_cpu_micros;
 
@@ -1063,6 +1358,9 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   }
 
   sub_compact->c_iter.reset();
+#ifndef ROCKSDB_LITE
+  blob_counting_iter.reset();
+#endif  // ROCKSDB_LITE
   input.reset();
   sub_compact->status = status;
 }
@@ -1417,7 +1715,42 @@ Status CompactionJob::InstallCompactionResults(
     for (const auto& out : sub_compact.outputs) {
       compaction->edit()->AddFile(compaction->output_level(), out.meta);
     }
+    for (const auto& blob : sub_compact.blob_file_additions) {
+      compaction->edit()->AddBlobFile(blob);
+    }
+  }
+
+#ifndef ROCKSDB_LITE
+  // Record the blobs of the existing blob files that the compaction dropped
+  // or relocated, summed over the subcompactions.
+  std::map<uint64_t, std::pair<uint64_t, uint64_t>> blob_garbage;
+  for (const auto& sub_compact : compact_->sub_compact_states) {
+    if (sub_compact.blob_garbage_meter == nullptr) {
+      continue;
+    }
+    for (const auto& pair : sub_compact.blob_garbage_meter->flows()) {
+      const auto& flow = pair.second;
+      if (!flow.HasGarbage()) {
+        continue;
+      }
+      auto& garbage = blob_garbage[pair.first];
+      garbage.first += flow.GetGarbageCount();
+      garbage.second += flow.GetGarbageBytes();
+    }
+  }
+  const auto& blob_files =
+      compaction->input_version()->storage_info()->GetBlobFiles();
+  for (const auto& pair : blob_garbage) {
+    // Skip the blob files that are not native, e.g. the StackableDB
+    // BlobDB's.
+    if (blob_files.find(pair.first) == blob_files.end()) {
+      continue;
+    }
+    compaction->edit()->AddBlobFileGarbage(pair.first, pair.second.first,
+                                           pair.second.second);
   }
+#endif  // ROCKSDB_LITE
+
   return versions_->LogAndApply(compaction->column_family_data(),
                                 mutable_cf_options, compaction->edit(),
                                 db_mutex_, db_directory_);
@@ -1530,6 +1863,41 @@ Status CompactionJob::OpenCompactionOutputFile(
   return s;
 }
 
+#ifndef ROCKSDB_LITE
+void CompactionJob::FinishForCompactionService(
+    CompactionServiceResult* result) {
+  db_mutex_->AssertHeld();
+  assert(result != nullptr);
+
+  const Compaction* compaction = compact_->compaction;
+  result->status = compact_->status;
+  result->output_files.clear();
+  result->output_path =
+      compaction->immutable_cf_options()
+          ->cf_paths[compaction->output_path_id()]
+          .path;
+  result->num_output_records = compact_->num_output_records;
+  result->total_bytes = compact_->total_bytes;
+  if (result->status.ok()) {
+    for (const auto& sub_compact : compact_->sub_compact_states) {
+      for (const auto& out : sub_compact.outputs) {
+        CompactionServiceOutputFile file;
+        file.file_name = MakeTableFileName(out.meta.fd.GetNumber());
+        file.smallest_seqno = out.meta.fd.smallest_seqno;
+        file.largest_seqno = out.meta.fd.largest_seqno;
+        file.smallest_internal_key = out.meta.smallest.Encode().ToString();
+        file.largest_internal_key = out.meta.largest.Encode().ToString();
+        file.oldest_ancester_time = out.meta.oldest_ancester_time;
+        file.file_creation_time = out.meta.file_creation_time;
+        file.marked_for_compaction = out.meta.marked_for_compaction;
+        result->output_files.push_back(std::move(file));
+      }
+    }
+  }
+  CleanupCompaction();
+}
+#endif  // !ROCKSDB_LITE
+
 void CompactionJob::CleanupCompaction() {
   for (SubcompactionState& sub_compact : compact_->sub_compact_states) {
     const auto& sub_status = sub_compact.status;
@@ -1598,6 +1966,9 @@ void CompactionJob::UpdateCompactionStats() {
     for (const auto& out : sub_compact.outputs) {
       compaction_stats_.bytes_written += out.meta.fd.file_size;
     }
+    for (const auto& blob : sub_compact.blob_file_additions) {
+      compaction_stats_.bytes_written += blob.GetTotalBlobBytes();
+    }
   }
 
   if (compaction_stats_.num_input_records > num_output_records) {
@@ -48,6 +48,7 @@ namespace rocksdb {
 
 class Arena;
 class ErrorHandler;
+struct CompactionServiceResult;
 class MemTable;
 class SnapshotChecker;
 class TableCache;
@@ -100,6 +101,22 @@ class CompactionJob {
   // Add compaction input/output to the current version
   Status Install(const MutableCFOptions& mutable_cf_options);
 
+#ifndef ROCKSDB_LITE
+  // The following two stand in for Prepare() and Install() when the
+  // compaction runs on behalf of another DB instance, which offloaded it to
+  // its CompactionService (see DB::OpenAndCompact()).
+
+  // REQUIRED: mutex held
+  // Prepare a single subcompaction over the user key range [*begin, *end),
+  // where nullptr means unbounded. The keys must outlive the job.
+  void PrepareForCompactionService(const Slice* begin, const Slice* end);
+
+  // REQUIRED: mutex held
+  // Describe the outcome of Run() in *result, for the other DB instance to
+  // install the output files.
+  void FinishForCompactionService(CompactionServiceResult* result);
+#endif  // !ROCKSDB_LITE
+
  private:
   struct SubcompactionState;
 
@@ -118,6 +135,13 @@ class CompactionJob {
   // Call compaction filter. Then iterate through input and compact the
   // kv-pairs
   void ProcessKeyValueCompaction(SubcompactionState* sub_compact);
+#ifndef ROCKSDB_LITE
+  // Hand the subcompaction to the CompactionService, and take over the
+  // output files it produced. Returns kUseLocal if the subcompaction is to
+  // be run locally instead.
+  CompactionServiceJobStatus ProcessKeyValueCompactionWithCompactionService(
+      SubcompactionState* sub_compact);
+#endif  // !ROCKSDB_LITE
 
   Status FinishCompactionOutputFile(
       const Status& input_status, SubcompactionState* sub_compact,
@@ -187,6 +211,8 @@ class CompactionJob {
   bool bottommost_level_;
   bool paranoid_file_checks_;
   bool measure_io_stats_;
+  // Keys sampled from inside the input files that boundaries_ may point into
+  std::vector<InternalKey> anchor_keys_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<Slice> boundaries_;
   // Stores the approx size of keys covered in the range of each subcompaction
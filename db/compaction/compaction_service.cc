@@ -0,0 +1,244 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#ifndef ROCKSDB_LITE
+
+#include "db/compaction/compaction_service.h"
+
+#include "util/coding.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Bumped whenever the encoding changes, so that a DB and a worker running
+// different versions fail cleanly rather than misread each other.
+const uint32_t kCompactionServiceFormatVersion = 1;
+
+Status CheckFormatVersion(Slice* input) {
+  uint32_t format_version = 0;
+  if (!GetVarint32(input, &format_version)) {
+    return Status::Corruption("compaction service: format version");
+  }
+  if (format_version != kCompactionServiceFormatVersion) {
+    return Status::NotSupported("compaction service: unknown format version");
+  }
+  return Status::OK();
+}
+
+bool GetLengthPrefixedString(Slice* input, std::string* value) {
+  Slice slice;
+  if (!GetLengthPrefixedSlice(input, &slice)) {
+    return false;
+  }
+  value->assign(slice.data(), slice.size());
+  return true;
+}
+
+bool GetBool(Slice* input, bool* value) {
+  uint32_t v = 0;
+  if (!GetVarint32(input, &v)) {
+    return false;
+  }
+  *value = v != 0;
+  return true;
+}
+
+void EncodeStatus(std::string* output, const Status& status) {
+  PutVarint32(output, static_cast<uint32_t>(status.code()));
+  const char* state = status.getState();
+  PutLengthPrefixedSlice(output, state != nullptr ? Slice(state) : Slice());
+}
+
+bool DecodeStatus(Slice* input, Status* status) {
+  uint32_t code = 0;
+  std::string msg;
+  if (!GetVarint32(input, &code) || !GetLengthPrefixedString(input, &msg)) {
+    return false;
+  }
+  switch (static_cast<Status::Code>(code)) {
+    case Status::kOk:
+      *status = Status::OK();
+      break;
+    case Status::kNotFound:
+      *status = Status::NotFound(msg);
+      break;
+    case Status::kNotSupported:
+      *status = Status::NotSupported(msg);
+      break;
+    case Status::kInvalidArgument:
+      *status = Status::InvalidArgument(msg);
+      break;
+    case Status::kIOError:
+      *status = Status::IOError(msg);
+      break;
+    case Status::kIncomplete:
+      *status = Status::Incomplete(msg);
+      break;
+    case Status::kShutdownInProgress:
+      *status = Status::ShutdownInProgress(msg);
+      break;
+    case Status::kAborted:
+      *status = Status::Aborted(msg);
+      break;
+    case Status::kColumnFamilyDropped:
+      *status = Status::ColumnFamilyDropped(msg);
+      break;
+    default:
+      // Whatever else went wrong, the output cannot be installed.
+      *status = Status::Corruption(msg);
+      break;
+  }
+  return true;
+}
+
+}  // namespace
+
+void CompactionServiceInput::EncodeTo(std::string* output) const {
+  PutVarint32(output, kCompactionServiceFormatVersion);
+  PutLengthPrefixedSlice(output, column_family_name);
+  PutLengthPrefixedSlice(output, db_options);
+  PutLengthPrefixedSlice(output, cf_options);
+  PutVarint32(output, static_cast<uint32_t>(cf_paths.size()));
+  for (const auto& cf_path : cf_paths) {
+    PutLengthPrefixedSlice(output, cf_path.path);
+    PutVarint64(output, cf_path.target_size);
+  }
+  PutVarint32(output, static_cast<uint32_t>(snapshots.size()));
+  for (SequenceNumber snapshot : snapshots) {
+    PutVarint64(output, snapshot);
+  }
+  PutVarint64(output, earliest_write_conflict_snapshot);
+  PutVarint32(output, static_cast<uint32_t>(input_files.size()));
+  for (uint64_t file_number : input_files) {
+    PutVarint64(output, file_number);
+  }
+  PutVarint32(output, static_cast<uint32_t>(output_level));
+  PutVarint64(output, target_file_size);
+  PutVarint64(output, max_compaction_bytes);
+  PutVarint32(output, static_cast<uint32_t>(compression));
+  PutVarint32(output, has_begin);
+  PutLengthPrefixedSlice(output, begin);
+  PutVarint32(output, has_end);
+  PutLengthPrefixedSlice(output, end);
+}
+
+Status CompactionServiceInput::DecodeFrom(const Slice& src) {
+  Slice input = src;
+  Status s = CheckFormatVersion(&input);
+  if (!s.ok()) {
+    return s;
+  }
+  const Status corruption = Status::Corruption("compaction service input");
+
+  uint32_t count = 0;
+  if (!GetLengthPrefixedString(&input, &column_family_name) ||
+      !GetLengthPrefixedString(&input, &db_options) ||
+      !GetLengthPrefixedString(&input, &cf_options) ||
+      !GetVarint32(&input, &count)) {
+    return corruption;
+  }
+  cf_paths.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    DbPath cf_path;
+    if (!GetLengthPrefixedString(&input, &cf_path.path) ||
+        !GetVarint64(&input, &cf_path.target_size)) {
+      return corruption;
+    }
+    cf_paths.push_back(cf_path);
+  }
+  if (!GetVarint32(&input, &count)) {
+    return corruption;
+  }
+  snapshots.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    SequenceNumber snapshot = 0;
+    if (!GetVarint64(&input, &snapshot)) {
+      return corruption;
+    }
+    snapshots.push_back(snapshot);
+  }
+  if (!GetVarint64(&input, &earliest_write_conflict_snapshot) ||
+      !GetVarint32(&input, &count)) {
+    return corruption;
+  }
+  input_files.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    uint64_t file_number = 0;
+    if (!GetVarint64(&input, &file_number)) {
+      return corruption;
+    }
+    input_files.push_back(file_number);
+  }
+  uint32_t level = 0;
+  uint32_t compression_type = 0;
+  if (!GetVarint32(&input, &level) ||
+      !GetVarint64(&input, &target_file_size) ||
+      !GetVarint64(&input, &max_compaction_bytes) ||
+      !GetVarint32(&input, &compression_type) ||
+      !GetBool(&input, &has_begin) ||
+      !GetLengthPrefixedString(&input, &begin) ||
+      !GetBool(&input, &has_end) || !GetLengthPrefixedString(&input, &end)) {
+    return corruption;
+  }
+  output_level = static_cast<int>(level);
+  compression = static_cast<CompressionType>(compression_type);
+  return Status::OK();
+}
+
+void CompactionServiceResult::EncodeTo(std::string* output) const {
+  PutVarint32(output, kCompactionServiceFormatVersion);
+  EncodeStatus(output, status);
+  PutVarint32(output, static_cast<uint32_t>(output_files.size()));
+  for (const auto& file : output_files) {
+    PutLengthPrefixedSlice(output, file.file_name);
+    PutVarint64Varint64(output, file.smallest_seqno, file.largest_seqno);
+    PutLengthPrefixedSlice(output, file.smallest_internal_key);
+    PutLengthPrefixedSlice(output, file.largest_internal_key);
+    PutVarint64Varint64(output, file.oldest_ancester_time,
+                        file.file_creation_time);
+    PutVarint32(output, file.marked_for_compaction);
+  }
+  PutLengthPrefixedSlice(output, output_path);
+  PutVarint64Varint64(output, num_output_records, total_bytes);
+}
+
+Status CompactionServiceResult::DecodeFrom(const Slice& src) {
+  Slice input = src;
+  Status s = CheckFormatVersion(&input);
+  if (!s.ok()) {
+    return s;
+  }
+  const Status corruption = Status::Corruption("compaction service result");
+
+  uint32_t count = 0;
+  if (!DecodeStatus(&input, &status) || !GetVarint32(&input, &count)) {
+    return corruption;
+  }
+  output_files.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    CompactionServiceOutputFile file;
+    if (!GetLengthPrefixedString(&input, &file.file_name) ||
+        !GetVarint64(&input, &file.smallest_seqno) ||
+        !GetVarint64(&input, &file.largest_seqno) ||
+        !GetLengthPrefixedString(&input, &file.smallest_internal_key) ||
+        !GetLengthPrefixedString(&input, &file.largest_internal_key) ||
+        !GetVarint64(&input, &file.oldest_ancester_time) ||
+        !GetVarint64(&input, &file.file_creation_time) ||
+        !GetBool(&input, &file.marked_for_compaction)) {
+      return corruption;
+    }
+    output_files.push_back(std::move(file));
+  }
+  if (!GetLengthPrefixedString(&input, &output_path) ||
+      !GetVarint64(&input, &num_output_records) ||
+      !GetVarint64(&input, &total_bytes)) {
+    return corruption;
+  }
+  return Status::OK();
+}
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,80 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// The compaction a DB hands to its CompactionService, as passed to
+// DB::OpenAndCompact() in serialized form. The worker looks the input files
+// up in the current version of its secondary instance of the DB.
+struct CompactionServiceInput {
+  std::string column_family_name;
+  // Options of the DB and the column family, as option strings (see
+  // GetStringFromDBOptions()). The options that are objects of the
+  // application come from CompactionServiceOptionsOverride instead.
+  std::string db_options;
+  std::string cf_options;
+  // The data paths of the column family, which the option strings miss.
+  std::vector<DbPath> cf_paths;
+
+  std::vector<SequenceNumber> snapshots;
+  SequenceNumber earliest_write_conflict_snapshot = kMaxSequenceNumber;
+
+  std::vector<uint64_t> input_files;
+  int output_level = 0;
+  uint64_t target_file_size = 0;
+  uint64_t max_compaction_bytes = 0;
+  CompressionType compression = kNoCompression;
+
+  // The user key range of the subcompaction: begin inclusive, end exclusive.
+  bool has_begin = false;
+  std::string begin;
+  bool has_end = false;
+  std::string end;
+
+  void EncodeTo(std::string* output) const;
+  Status DecodeFrom(const Slice& input);
+};
+
+// An output file of a compaction run by DB::OpenAndCompact(), with the
+// metadata the DB needs to install it.
+struct CompactionServiceOutputFile {
+  std::string file_name;
+  SequenceNumber smallest_seqno = 0;
+  SequenceNumber largest_seqno = 0;
+  std::string smallest_internal_key;
+  std::string largest_internal_key;
+  uint64_t oldest_ancester_time = 0;
+  uint64_t file_creation_time = 0;
+  bool marked_for_compaction = false;
+};
+
+// What DB::OpenAndCompact() hands back to the DB, in serialized form.
+struct CompactionServiceResult {
+  Status status;
+  std::vector<CompactionServiceOutputFile> output_files;
+  // The directory the output files are in.
+  std::string output_path;
+  uint64_t num_output_records = 0;
+  uint64_t total_bytes = 0;
+
+  void EncodeTo(std::string* output) const;
+  Status DecodeFrom(const Slice& input);
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,301 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include <map>
+#include <string>
+
+#include "db/compaction/compaction_service.h"
+#include "db/db_test_util.h"
+#include "port/port.h"
+#include "port/stack_trace.h"
+#include "test_util/testutil.h"
+
+namespace rocksdb {
+
+// Runs the compactions in the same process, through DB::OpenAndCompact(), as
+// a remote worker would.
+class MyTestCompactionService : public CompactionService {
+ public:
+  MyTestCompactionService(const std::string& db_path, Env* env)
+      : db_path_(db_path), env_(env) {}
+
+  const char* Name() const override { return "MyTestCompactionService"; }
+
+  CompactionServiceJobStatus Start(const std::string& compaction_service_input,
+                                   uint64_t job_id) override {
+    MutexLock l(&mutex_);
+    if (start_status_ != CompactionServiceJobStatus::kSuccess) {
+      return start_status_;
+    }
+    jobs_.emplace(job_id, compaction_service_input);
+    return CompactionServiceJobStatus::kSuccess;
+  }
+
+  CompactionServiceJobStatus WaitForComplete(
+      uint64_t job_id, std::string* compaction_service_result) override {
+    std::string input;
+    {
+      MutexLock l(&mutex_);
+      auto it = jobs_.find(job_id);
+      if (it == jobs_.end()) {
+        return CompactionServiceJobStatus::kFailure;
+      }
+      input = std::move(it->second);
+      jobs_.erase(it);
+      if (wait_status_ != CompactionServiceJobStatus::kSuccess) {
+        return wait_status_;
+      }
+    }
+
+    CompactionServiceOptionsOverride options_override;
+    options_override.env = env_;
+    Status s = DB::OpenAndCompact(db_path_, OutputDirectory(job_id), input,
+                                  compaction_service_result, options_override);
+    MutexLock l(&mutex_);
+    ++compaction_num_;
+    return s.ok() ? CompactionServiceJobStatus::kSuccess
+                  : CompactionServiceJobStatus::kFailure;
+  }
+
+  std::string OutputDirectory(uint64_t job_id) const {
+    return db_path_ + "_remote_" + ToString(job_id);
+  }
+
+  int GetCompactionNum() {
+    MutexLock l(&mutex_);
+    return compaction_num_;
+  }
+
+  void SetStartStatus(CompactionServiceJobStatus status) {
+    MutexLock l(&mutex_);
+    start_status_ = status;
+  }
+
+  void SetWaitStatus(CompactionServiceJobStatus status) {
+    MutexLock l(&mutex_);
+    wait_status_ = status;
+  }
+
+ private:
+  port::Mutex mutex_;
+  std::string db_path_;
+  Env* env_;
+  std::map<uint64_t, std::string> jobs_;
+  int compaction_num_ = 0;
+  CompactionServiceJobStatus start_status_ =
+      CompactionServiceJobStatus::kSuccess;
+  CompactionServiceJobStatus wait_status_ =
+      CompactionServiceJobStatus::kSuccess;
+};
+
+class CompactionServiceTest : public DBTestBase {
+ public:
+  CompactionServiceTest() : DBTestBase("/compaction_service_test") {}
+
+  ~CompactionServiceTest() override {
+    std::vector<std::string> children;
+    std::string parent = dbname_.substr(0, dbname_.rfind('/'));
+    std::string prefix = dbname_.substr(dbname_.rfind('/') + 1) + "_remote_";
+    env_->GetChildren(parent, &children);
+    for (const auto& child : children) {
+      if (child.compare(0, prefix.size(), prefix) == 0) {
+        test::DestroyDir(env_, parent + "/" + child);
+      }
+    }
+  }
+
+ protected:
+  Options GetServiceOptions() {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    service_ = std::make_shared<MyTestCompactionService>(dbname_, env_);
+    options.compaction_service = service_;
+    return options;
+  }
+
+  void GenerateTestData() {
+    // Two overlapping L0 files.
+    for (int i = 0; i < 20; i++) {
+      ASSERT_OK(Put(Key(i), "value" + ToString(i)));
+    }
+    ASSERT_OK(Flush());
+    for (int i = 10; i < 30; i++) {
+      ASSERT_OK(Put(Key(i), "value_new" + ToString(i)));
+    }
+    ASSERT_OK(Delete(Key(0)));
+    ASSERT_OK(Flush());
+  }
+
+  void VerifyTestData() {
+    ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+    for (int i = 1; i < 10; i++) {
+      ASSERT_EQ("value" + ToString(i), Get(Key(i)));
+    }
+    for (int i = 10; i < 30; i++) {
+      ASSERT_EQ("value_new" + ToString(i), Get(Key(i)));
+    }
+  }
+
+  std::shared_ptr<MyTestCompactionService> service_;
+};
+
+TEST_F(CompactionServiceTest, BasicCompaction) {
+  Options options = GetServiceOptions();
+  Reopen(options);
+  GenerateTestData();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(service_->GetCompactionNum(), 0);
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+
+  // The installed output survives a reopen without the service.
+  options.compaction_service = nullptr;
+  Reopen(options);
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, PreservesSnapshot) {
+  Options options = GetServiceOptions();
+  Reopen(options);
+
+  ASSERT_OK(Put("a", "value"));
+  ASSERT_OK(Put("key", "old"));
+  ASSERT_OK(Put("z", "value"));
+  ASSERT_OK(Flush());
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Put("key", "new"));
+  ASSERT_OK(Put("m", "value"));
+  ASSERT_OK(Flush());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(service_->GetCompactionNum(), 0);
+  ASSERT_EQ("new", Get("key"));
+  ASSERT_EQ("old", Get("key", snapshot));
+  db_->ReleaseSnapshot(snapshot);
+}
+
+TEST_F(CompactionServiceTest, UseLocal) {
+  Options options = GetServiceOptions();
+  service_->SetStartStatus(CompactionServiceJobStatus::kUseLocal);
+  Reopen(options);
+  GenerateTestData();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, service_->GetCompactionNum());
+  ASSERT_EQ("0,1", FilesPerLevel());
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, Failure) {
+  Options options = GetServiceOptions();
+  service_->SetWaitStatus(CompactionServiceJobStatus::kFailure);
+  Reopen(options);
+  GenerateTestData();
+
+  ASSERT_NOK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("2", FilesPerLevel());
+  VerifyTestData();
+}
+
+TEST_F(CompactionServiceTest, InputAndResultEncoding) {
+  CompactionServiceInput input;
+  input.column_family_name = "cf";
+  input.db_options = "max_open_files=-1;";
+  input.cf_options = "num_levels=4;";
+  input.cf_paths.emplace_back("/path/a", 100);
+  input.cf_paths.emplace_back("/path/b", port::kMaxUint64);
+  input.snapshots = {5, 10};
+  input.earliest_write_conflict_snapshot = 5;
+  input.input_files = {7, 8, 9};
+  input.output_level = 2;
+  input.target_file_size = 1 << 20;
+  input.max_compaction_bytes = 1 << 25;
+  input.compression = kSnappyCompression;
+  input.has_end = true;
+  input.end = "end";
+
+  std::string encoded;
+  input.EncodeTo(&encoded);
+  CompactionServiceInput decoded_input;
+  ASSERT_OK(decoded_input.DecodeFrom(encoded));
+  ASSERT_EQ(input.column_family_name, decoded_input.column_family_name);
+  ASSERT_EQ(input.db_options, decoded_input.db_options);
+  ASSERT_EQ(input.cf_options, decoded_input.cf_options);
+  ASSERT_EQ(input.cf_paths.size(), decoded_input.cf_paths.size());
+  for (size_t i = 0; i < input.cf_paths.size(); i++) {
+    ASSERT_EQ(input.cf_paths[i].path, decoded_input.cf_paths[i].path);
+    ASSERT_EQ(input.cf_paths[i].target_size,
+              decoded_input.cf_paths[i].target_size);
+  }
+  ASSERT_EQ(input.snapshots, decoded_input.snapshots);
+  ASSERT_EQ(input.earliest_write_conflict_snapshot,
+            decoded_input.earliest_write_conflict_snapshot);
+  ASSERT_EQ(input.input_files, decoded_input.input_files);
+  ASSERT_EQ(input.output_level, decoded_input.output_level);
+  ASSERT_EQ(input.target_file_size, decoded_input.target_file_size);
+  ASSERT_EQ(input.max_compaction_bytes, decoded_input.max_compaction_bytes);
+  ASSERT_EQ(input.compression, decoded_input.compression);
+  ASSERT_FALSE(decoded_input.has_begin);
+  ASSERT_TRUE(decoded_input.has_end);
+  ASSERT_EQ(input.end, decoded_input.end);
+  ASSERT_TRUE(
+      decoded_input.DecodeFrom(Slice(encoded.data(), encoded.size() / 2))
+          .IsCorruption());
+
+  CompactionServiceResult result;
+  result.status = Status::Incomplete("partial");
+  result.output_path = "/path/b";
+  result.num_output_records = 42;
+  result.total_bytes = 4096;
+  CompactionServiceOutputFile file;
+  file.file_name = "000012.sst";
+  file.smallest_seqno = 3;
+  file.largest_seqno = 9;
+  file.smallest_internal_key = "a";
+  file.largest_internal_key = "z";
+  file.marked_for_compaction = true;
+  result.output_files.push_back(file);
+
+  encoded.clear();
+  result.EncodeTo(&encoded);
+  CompactionServiceResult decoded_result;
+  ASSERT_OK(decoded_result.DecodeFrom(encoded));
+  ASSERT_TRUE(decoded_result.status.IsIncomplete());
+  ASSERT_EQ(result.status.ToString(), decoded_result.status.ToString());
+  ASSERT_EQ(result.output_path, decoded_result.output_path);
+  ASSERT_EQ(result.num_output_records, decoded_result.num_output_records);
+  ASSERT_EQ(result.total_bytes, decoded_result.total_bytes);
+  ASSERT_EQ(1, decoded_result.output_files.size());
+  const auto& decoded_file = decoded_result.output_files[0];
+  ASSERT_EQ(file.file_name, decoded_file.file_name);
+  ASSERT_EQ(file.smallest_seqno, decoded_file.smallest_seqno);
+  ASSERT_EQ(file.largest_seqno, decoded_file.largest_seqno);
+  ASSERT_EQ(file.smallest_internal_key, decoded_file.smallest_internal_key);
+  ASSERT_EQ(file.largest_internal_key, decoded_file.largest_internal_key);
+  ASSERT_TRUE(decoded_file.marked_for_compaction);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as CompactionService is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
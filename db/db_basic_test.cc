@@ -1405,6 +1405,89 @@ TEST_F(DBBasicTest, MultiGetBatchedMultiLevel) {
   }
 }
 
+TEST_F(DBBasicTest, MultiGetBatchedAsyncIO) {
+  std::shared_ptr<DeferredReadFileSystem> fs =
+      std::make_shared<DeferredReadFileSystem>(FileSystem::Default());
+  Options options = CurrentOptions();
+  options.file_system = fs;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  // Non-overlapping files, so that they are trivially moved down and keys
+  // of a MultiGet batch are spread across many files of each level
+  for (int i = 0; i < 256; ++i) {
+    ASSERT_OK(Put(Key(i), "val_l2_" + std::to_string(i)));
+    if (i % 16 == 15) {
+      ASSERT_OK(Flush());
+    }
+  }
+  MoveFilesToLevel(2);
+  for (int i = 0; i < 256; i += 3) {
+    ASSERT_OK(Put(Key(i), "val_l1_" + std::to_string(i)));
+    if (i % 24 == 21) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+  ASSERT_GT(NumTableFilesAtLevel(2), 1);
+  Reopen(options);
+
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < 256; i += 5) {
+    key_strs.push_back(Key(i));
+  }
+  key_strs.push_back(Key(1000));
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+
+  ReadOptions ro;
+  ro.async_io = true;
+  for (int iter = 0; iter < 2; ++iter) {
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(ro, dbfull()->DefaultColumnFamily(), keys.size(),
+                  keys.data(), values.data(), statuses.data());
+    for (size_t j = 0; j + 1 < keys.size(); ++j) {
+      int key = static_cast<int>(j) * 5;
+      ASSERT_OK(statuses[j]);
+      if (key % 3 == 0) {
+        ASSERT_EQ(values[j], "val_l1_" + std::to_string(key));
+      } else {
+        ASSERT_EQ(values[j], "val_l2_" + std::to_string(key));
+      }
+    }
+    ASSERT_TRUE(statuses.back().IsNotFound());
+    if (iter == 0) {
+      // Blocks were read from the files in batches
+      ASSERT_GT(fs->num_async_reads_.load(), 0);
+      ASSERT_GT(fs->num_polls_.load(), 0);
+    }
+  }
+
+  // When the reads cannot be waited for, they are cancelled before their
+  // buffers are freed, and the lookups fail
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  fs->fail_poll_ = true;
+  {
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(ro, dbfull()->DefaultColumnFamily(), keys.size(),
+                  keys.data(), values.data(), statuses.data());
+    bool io_error = false;
+    for (const Status& s : statuses) {
+      io_error |= s.IsIOError();
+    }
+    ASSERT_TRUE(io_error);
+    ASSERT_GT(fs->num_aborted_reads_.load(), 0);
+  }
+  fs->fail_poll_ = false;
+  Close();
+}
+
 // Test class for batched MultiGet with prefix extractor
 // Param bool - If true, use partitioned filters
 //              If false, use full filter block
@@ -1799,6 +1882,9 @@ class DBBasicTestWithParallelIO
 
     virtual const char* Name() const override { return "MyBlockCache"; }
 
+    using Cache::Insert;
+    using Cache::Lookup;
+
     virtual Status Insert(const Slice& key, void* value, size_t charge,
                           void (*deleter)(const Slice& key, void* value),
                           Handle** handle = nullptr,
@@ -7,6 +7,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include <cstdlib>
+#include "cache/compressed_secondary_cache.h"
 #include "cache/lru_cache.h"
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
@@ -453,6 +454,16 @@ class MockCache : public LRUCache {
     }
     return LRUCache::Insert(key, value, charge, deleter, handle, priority);
   }
+
+  Status Insert(const Slice& key, void* value, const CacheItemHelper* helper,
+                size_t charge, Handle** handle, Priority priority) override {
+    if (priority == Priority::LOW) {
+      low_pri_insert_count++;
+    } else {
+      high_pri_insert_count++;
+    }
+    return LRUCache::Insert(key, value, helper, charge, handle, priority);
+  }
 };
 
 uint32_t MockCache::high_pri_insert_count = 0;
@@ -517,6 +528,43 @@ TEST_F(DBBlockCacheTest, IndexAndFilterBlocksCachePriority) {
   }
 }
 
+TEST_F(DBBlockCacheTest, SecondaryCache) {
+  ReadOptions read_options;
+  auto table_options = GetTableOptions();
+  auto options = GetOptions(table_options);
+  InitTable(options);
+
+  std::shared_ptr<CompressedSecondaryCache> secondary_cache(
+      new CompressedSecondaryCache(CompressedSecondaryCacheOptions(
+          1 << 20 /* capacity */, 0 /* num_shard_bits */,
+          Zlib_Supported() ? kZlibCompression : kNoCompression)));
+  // Only room for a few of the blocks
+  LRUCacheOptions cache_opts(1024 /* capacity */, 0 /* num_shard_bits */,
+                             false /* strict_capacity_limit */,
+                             0.0 /* high_pri_pool_ratio */);
+  cache_opts.secondary_cache = secondary_cache;
+  std::shared_ptr<Cache> cache = NewLRUCache(cache_opts);
+  table_options.block_cache = cache;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(kValueSize, 'a');
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  uint64_t data_misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  ASSERT_EQ(kNumBlocks, data_misses);
+  // Blocks evicted from the block cache went to the secondary cache
+  ASSERT_LT(0u, secondary_cache->TEST_GetUsage());
+
+  // Every block is now served by one of the two tiers
+  for (size_t i = 0; i < kNumBlocks; i++) {
+    ASSERT_EQ(value, Get(ToString(i)));
+  }
+  ASSERT_EQ(data_misses, TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(kNumBlocks, TestGetTickerCount(options, BLOCK_CACHE_DATA_HIT));
+}
+
 TEST_F(DBBlockCacheTest, ParanoidFileChecks) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
@@ -525,7 +525,10 @@ INSTANTIATE_TEST_CASE_P(
         std::make_tuple(BFP::kDeprecatedBlock, false,
                         test::kLatestFormatVersion),
         std::make_tuple(BFP::kAuto, true, test::kLatestFormatVersion),
-        std::make_tuple(BFP::kAuto, false, test::kLatestFormatVersion)));
+        std::make_tuple(BFP::kAuto, false, test::kLatestFormatVersion),
+        std::make_tuple(BFP::kStandardRibbon, true, test::kLatestFormatVersion),
+        std::make_tuple(BFP::kStandardRibbon, false,
+                        test::kLatestFormatVersion)));
 #endif  // ROCKSDB_VALGRIND_RUN
 
 TEST_F(DBBloomFilterTest, BloomFilterRate) {
@@ -1198,6 +1201,8 @@ INSTANTIATE_TEST_CASE_P(
                       std::make_tuple(BFP::kLegacyBloom, true),
                       std::make_tuple(BFP::kFastLocalBloom, false),
                       std::make_tuple(BFP::kFastLocalBloom, true),
+                      std::make_tuple(BFP::kStandardRibbon, false),
+                      std::make_tuple(BFP::kStandardRibbon, true),
                       std::make_tuple(BFP2::kPlainTable, false)));
 
 namespace {
@@ -179,6 +179,7 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       write_thread_(immutable_db_options_),
       nonmem_write_thread_(immutable_db_options_),
       write_controller_(mutable_db_options_.delayed_write_rate),
+      wbm_write_stall_condition_(WriteStallCondition::kNormal),
       last_batch_group_size_(0),
       unscheduled_flushes_(0),
       unscheduled_compactions_(0),
@@ -248,6 +249,11 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
                                  &write_controller_, &block_cache_tracer_));
   column_family_memtables_.reset(
       new ColumnFamilyMemTablesImpl(versions_->GetColumnFamilySet()));
+  if (immutable_db_options_.max_memtable_insert_threads_per_batch > 1) {
+    // The calling thread inserts a chunk of the batch too
+    memtable_insert_thread_pool_.reset(NewThreadPool(static_cast<int>(
+        immutable_db_options_.max_memtable_insert_threads_per_batch - 1)));
+  }
 
   DumpRocksDBBuildVersion(immutable_db_options_.info_log.get());
   DumpDBFileSummary(immutable_db_options_, dbname_);
@@ -607,6 +613,9 @@ DBImpl::~DBImpl() {
     closed_ = true;
     CloseHelper();
   }
+  if (memtable_insert_thread_pool_ != nullptr) {
+    memtable_insert_thread_pool_->JoinAllThreads();
+  }
 }
 
 void DBImpl::MaybeIgnoreError(Status* s) const {
@@ -2560,7 +2569,7 @@ ArenaWrappedDBIter* DBImpl::NewIteratorImpl(const ReadOptions& read_options,
   ArenaWrappedDBIter* db_iter = NewArenaWrappedDbIterator(
       env_, read_options, *cfd->ioptions(), sv->mutable_cf_options, snapshot,
       sv->mutable_cf_options.max_sequential_skip_in_iterations,
-      sv->version_number, read_callback, this, cfd, allow_blob,
+      sv->version_number, sv->current, read_callback, this, cfd, allow_blob,
       ((read_options.snapshot != nullptr) ? false : allow_refresh));
 
   InternalIterator* internal_iter =
@@ -2619,6 +2628,216 @@ Status DBImpl::NewIterators(
   return Status::OK();
 }
 
+namespace {
+// Owns the bounds of the iterator over one shard of NewShardedIterators(),
+// which are deleted along with the iterator.
+struct ScanShardBounds {
+  std::string lower_key;
+  std::string upper_key;
+  Slice lower;
+  Slice upper;
+};
+
+void DeleteScanShardBounds(void* arg1, void* /*arg2*/) {
+  delete reinterpret_cast<ScanShardBounds*>(arg1);
+}
+}  // namespace
+
+Status DBImpl::NewShardedIterators(const ReadOptions& read_options,
+                                   ColumnFamilyHandle* column_family,
+                                   size_t num_shards,
+                                   std::vector<Iterator*>* iterators) {
+  if (read_options.managed) {
+    return Status::NotSupported("Managed iterator is not supported anymore.");
+  }
+  if (read_options.read_tier == kPersistedTier) {
+    return Status::NotSupported(
+        "ReadTier::kPersistedData is not yet supported in iterators.");
+  }
+  if (read_options.tailing) {
+    return Status::NotSupported("Tailing iterators cannot be sharded.");
+  }
+  if (num_shards == 0) {
+    return Status::InvalidArgument("num_shards must be positive.");
+  }
+  auto cfd = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family)->cfd();
+  iterators->clear();
+
+  // Hold a snapshot while the iterators are created. Otherwise a compaction
+  // installing a new version between two of them could drop keys that the
+  // later iterators would need to read the same state as the earlier ones.
+  // Note: no need to consider the special case of
+  // last_seq_same_as_publish_seq_==false since NewShardedIterators is
+  // overridden in WritePreparedTxnDB
+  const Snapshot* snapshot = read_options.snapshot;
+  if (snapshot == nullptr) {
+    snapshot = GetSnapshot();
+  }
+  SequenceNumber seq = snapshot != nullptr ? snapshot->GetSequenceNumber()
+                                           : versions_->LastSequence();
+
+  std::vector<std::string> boundaries;
+  SuperVersion* sv = GetAndRefSuperVersion(cfd);
+  GenScanShardBoundaries(read_options, cfd, sv, num_shards, &boundaries);
+  ReturnAndCleanupSuperVersion(cfd, sv);
+
+  iterators->reserve(boundaries.size() + 1);
+  for (size_t i = 0; i <= boundaries.size(); i++) {
+    ScanShardBounds* bounds = new ScanShardBounds;
+    ReadOptions shard_options = read_options;
+    shard_options.iterate_lower_bound = nullptr;
+    shard_options.iterate_upper_bound = nullptr;
+    const Slice* lower = i == 0 ? read_options.iterate_lower_bound : nullptr;
+    const Slice* upper =
+        i == boundaries.size() ? read_options.iterate_upper_bound : nullptr;
+    if (i > 0) {
+      bounds->lower_key = boundaries[i - 1];
+    } else if (lower != nullptr) {
+      bounds->lower_key = lower->ToString();
+    }
+    if (i < boundaries.size()) {
+      bounds->upper_key = boundaries[i];
+    } else if (upper != nullptr) {
+      bounds->upper_key = upper->ToString();
+    }
+    bounds->lower = bounds->lower_key;
+    bounds->upper = bounds->upper_key;
+    if (i > 0 || lower != nullptr) {
+      shard_options.iterate_lower_bound = &bounds->lower;
+    }
+    if (i < boundaries.size() || upper != nullptr) {
+      shard_options.iterate_upper_bound = &bounds->upper;
+    }
+    ArenaWrappedDBIter* iter =
+        NewIteratorImpl(shard_options, cfd, seq, nullptr /* read_callback */);
+    iter->RegisterCleanup(&DeleteScanShardBounds, bounds, nullptr);
+    iterators->push_back(iter);
+  }
+
+  if (snapshot != read_options.snapshot) {
+    ReleaseSnapshot(snapshot);
+  }
+  return Status::OK();
+}
+
+void DBImpl::GenScanShardBoundaries(const ReadOptions& read_options,
+                                    ColumnFamilyData* cfd, SuperVersion* sv,
+                                    size_t num_shards,
+                                    std::vector<std::string>* boundaries) {
+  if (num_shards <= 1) {
+    return;
+  }
+  const Comparator* ucmp = cfd->user_comparator();
+  const Slice* lower = read_options.iterate_lower_bound;
+  const Slice* upper = read_options.iterate_upper_bound;
+
+  // Collect the files overlapping the range
+  VersionStorageInfo* vstorage = sv->current->storage_info();
+  std::vector<FileMetaData*> files;
+  uint64_t total_file_size = 0;
+  for (int level = 0; level < vstorage->num_non_empty_levels(); level++) {
+    for (FileMetaData* f : vstorage->LevelFiles(level)) {
+      if ((lower != nullptr &&
+           ucmp->Compare(f->largest.user_key(), *lower) < 0) ||
+          (upper != nullptr &&
+           ucmp->Compare(f->smallest.user_key(), *upper) >= 0)) {
+        continue;
+      }
+      files.push_back(f);
+      total_file_size += f->fd.GetFileSize();
+    }
+  }
+  if (files.empty()) {
+    return;
+  }
+
+  // The candidate boundaries are the file boundaries, and anchors sampled
+  // from inside the files, more of them from larger files, so that there
+  // are several candidates per shard.
+  const size_t kCandidatesPerShard = 8;
+  size_t wanted_anchors = kCandidatesPerShard * num_shards;
+  std::vector<std::string> candidates;
+  for (FileMetaData* f : files) {
+    candidates.push_back(f->smallest.user_key().ToString());
+    candidates.push_back(f->largest.user_key().ToString());
+    size_t anchors = 1;
+    if (total_file_size > 0) {
+      anchors += static_cast<size_t>(wanted_anchors * f->fd.GetFileSize() /
+                                     total_file_size);
+    }
+    // The anchors are only hints, so errors are ignored.
+    cfd->table_cache()->ApproximateKeyAnchors(
+        read_options, cfd->internal_comparator(), f->fd, anchors, &candidates,
+        sv->mutable_cf_options.prefix_extractor.get());
+  }
+  candidates.erase(
+      std::remove_if(candidates.begin(), candidates.end(),
+                     [&](const std::string& key) {
+                       return (lower != nullptr &&
+                               ucmp->Compare(key, *lower) <= 0) ||
+                              (upper != nullptr &&
+                               ucmp->Compare(key, *upper) >= 0);
+                     }),
+      candidates.end());
+  std::sort(candidates.begin(), candidates.end(),
+            [ucmp](const std::string& a, const std::string& b) {
+              return ucmp->Compare(a, b) < 0;
+            });
+  candidates.erase(std::unique(candidates.begin(), candidates.end(),
+                               [ucmp](const std::string& a,
+                                      const std::string& b) {
+                                 return ucmp->Compare(a, b) == 0;
+                               }),
+                   candidates.end());
+  if (candidates.empty()) {
+    return;
+  }
+
+  // Measure the data between consecutive candidates, and between the bounds
+  // of the range and the first and last candidates.
+  std::vector<InternalKey> points;
+  points.reserve(candidates.size() + 2);
+  if (lower != nullptr) {
+    points.emplace_back(*lower, kMaxSequenceNumber, kValueTypeForSeek);
+  }
+  for (const std::string& key : candidates) {
+    points.emplace_back(key, kMaxSequenceNumber, kValueTypeForSeek);
+  }
+  if (upper != nullptr) {
+    points.emplace_back(*upper, kMaxSequenceNumber, kValueTypeForSeek);
+  }
+  std::vector<uint64_t> sizes;
+  sizes.reserve(points.size());
+  uint64_t sum = 0;
+  for (size_t i = 0; i + 1 < points.size(); i++) {
+    const Slice a = points[i].Encode();
+    const Slice b = points[i + 1].Encode();
+    uint64_t size = versions_->ApproximateSize(
+        SizeApproximationOptions(), sv->current, a, b, /*start_level=*/0,
+        /*end_level=*/-1, TableReaderCaller::kUserApproximateSize);
+    size += sv->mem->ApproximateStats(a, b).size;
+    size += sv->imm->ApproximateStats(a, b).size;
+    sizes.push_back(size);
+    sum += size;
+  }
+
+  // Close a shard at the end of a range once the shards so far hold their
+  // share of the data. The last point, the upper bound or the largest key,
+  // is never a boundary.
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i + 1 < sizes.size(); i++) {
+    cumulative += sizes[i];
+    if (boundaries->size() + 1 >= num_shards) {
+      break;
+    }
+    double target =
+        static_cast<double>(sum) * (boundaries->size() + 1) / num_shards;
+    if (cumulative > 0 && cumulative >= target) {
+      boundaries->push_back(points[i + 1].user_key().ToString());
+    }
+  }
+}
+
 const Snapshot* DBImpl::GetSnapshot() { return GetSnapshotImpl(false); }
 
 #ifndef ROCKSDB_LITE
@@ -50,6 +50,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/status.h"
+#include "rocksdb/threadpool.h"
 #include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/transaction_log.h"
 #include "rocksdb/write_buffer_manager.h"
@@ -240,6 +241,10 @@ class DBImpl : public DB {
       const ReadOptions& options,
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) override;
+  virtual Status NewShardedIterators(const ReadOptions& options,
+                                     ColumnFamilyHandle* column_family,
+                                     size_t num_shards,
+                                     std::vector<Iterator*>* iterators) override;
 
   virtual const Snapshot* GetSnapshot() override;
   virtual void ReleaseSnapshot(const Snapshot* snapshot) override;
@@ -464,6 +469,15 @@ class DBImpl : public DB {
                                       bool allow_blob = false,
                                       bool allow_refresh = true);
 
+  // Picks at most num_shards - 1 user keys, in ascending order, that split
+  // the keys of sv in [options.iterate_lower_bound,
+  // options.iterate_upper_bound) into ranges of roughly equal size. Used by
+  // NewShardedIterators().
+  void GenScanShardBoundaries(const ReadOptions& options,
+                              ColumnFamilyData* cfd, SuperVersion* sv,
+                              size_t num_shards,
+                              std::vector<std::string>* boundaries);
+
   virtual SequenceNumber GetLastPublishedSequence() const {
     if (last_seq_same_as_publish_seq_) {
       return versions_->LastSequence();
@@ -595,6 +609,24 @@ class DBImpl : public DB {
   // being deleted.
   uint64_t MinObsoleteSstNumberToKeep();
 
+  // How far a secondary instance has got in catching up with the primary.
+  struct SecondaryCatchUpStats {
+    // NowMicros() when TryCatchUpWithPrimary() last succeeded, or when the
+    // instance was opened.
+    uint64_t last_catch_up_micros = 0;
+    // Total size of the WAL records replayed.
+    uint64_t replayed_wal_bytes = 0;
+    // Number of times wal_dir was listed to find new WAL files.
+    uint64_t wal_dir_listings = 0;
+  };
+
+  // Returns false unless this is a secondary instance.
+  // REQUIRES: mutex_ held
+  virtual bool GetSecondaryCatchUpStats(
+      SecondaryCatchUpStats* /*stats*/) const {
+    return false;
+  }
+
   // Returns the list of live files in 'live' and the list
   // of all files in the filesystem in 'candidate_files'.
   // If force == false and the last call was less than
@@ -1123,6 +1155,7 @@ class DBImpl : public DB {
   friend class DB;
   friend class ErrorHandler;
   friend class InternalStats;
+  friend class OptimisticTransactionDBImpl;
   friend class PessimisticTransaction;
   friend class TransactionBaseImpl;
   friend class WriteCommittedTxn;
@@ -1136,6 +1169,7 @@ class DBImpl : public DB {
   friend class ForwardIterator;
 #endif
   friend struct SuperVersion;
+  friend class DBImplSecondary;
   friend class CompactedDBImpl;
   friend class DBTest_ConcurrentFlushWAL_Test;
   friend class DBTest_MixedSlowdownOptionsStop_Test;
@@ -1362,6 +1396,15 @@ class DBImpl : public DB {
                          SequenceNumber* next_sequence, bool read_only,
                          bool* corrupted_log_found);
 
+  // Inserts consecutive batches of log log_number, which may be inserted in
+  // any order, concurrently with the calling thread and the threads of
+  // thread_pool, which RecoverLogFiles() keeps for all the log files.
+  // On failure, *failed_batch is the index of the first batch that failed.
+  // See DBOptions::wal_recovery_threads.
+  Status InsertRecoveredBatches(const std::vector<WriteBatch>& batches,
+                                uint64_t log_number, ThreadPool* thread_pool,
+                                bool* has_valid_writes, size_t* failed_batch);
+
   // The following two methods are used to flush a memtable to
   // storage. The first one is used at database RecoveryTime (when the
   // database is opened) and is heavyweight because it holds the mutex
@@ -1378,7 +1421,20 @@ class DBImpl : public DB {
 
   // num_bytes: for slowdown case, delay time is calculated based on
   //            `num_bytes` going through.
-  Status DelayWrite(uint64_t num_bytes, const WriteOptions& write_options);
+  // While write_buffer_manager_ stops the writes, the memtables of this DB
+  // are switched and flushed, which needs write_context.
+  Status DelayWrite(uint64_t num_bytes, const WriteOptions& write_options,
+                    WriteContext* write_context);
+
+  // Returns true if the mutable memtable of any column family has entries.
+  bool HasNonEmptyMemTable();
+
+  // Applies the write stall condition of write_buffer_manager_ to this DB by
+  // taking or releasing wbm_write_controller_token_. The condition changes
+  // with the memory use of all the DBs sharing write_buffer_manager_, so it
+  // is also re-applied when this DB schedules background work and when the
+  // write stall properties are read, not only on writes.
+  void UpdateWriteBufferManagerStall();
 
   Status ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
                                       WriteBatch* my_batch);
@@ -1486,6 +1542,16 @@ class DBImpl : public DB {
   // Used by WriteImpl to update bg_error_ in case of memtable insert error.
   void MemTableInsertStatusCheck(const Status& memtable_insert_status);
 
+  // Whether the batch of the writer is large enough, and allowed, to be
+  // inserted into the memtables by InsertBatchInParallel().
+  bool ShouldInsertBatchInParallel(WriteThread::Writer* w) const;
+
+  // Inserts the batch of the writer into the memtables as chunks, inserted by
+  // the calling thread and memtable_insert_thread_pool_. See
+  // DBOptions::max_memtable_insert_threads_per_batch.
+  Status InsertBatchInParallel(WriteThread::Writer* w,
+                               const WriteOptions& write_options);
+
 #ifndef ROCKSDB_LITE
 
   Status CompactFilesImpl(const CompactionOptions& compact_options,
@@ -1840,8 +1906,17 @@ class DBImpl : public DB {
   // in 2PC to batch the prepares separately from the serial commit.
   WriteThread nonmem_write_thread_;
 
+  // The threads that insert the chunks of InsertBatchInParallel(), besides
+  // the writer itself. nullptr unless
+  // DBOptions::max_memtable_insert_threads_per_batch > 1.
+  std::unique_ptr<ThreadPool> memtable_insert_thread_pool_;
+
   WriteController write_controller_;
 
+  // Held while write_buffer_manager_ asks its DBs to delay or stop writes.
+  std::unique_ptr<WriteControllerToken> wbm_write_controller_token_;
+  WriteStallCondition wbm_write_stall_condition_;
+
   // Size of the last batch group. In slowdown mode, next write needs to
   // sleep if it uses up the quota.
   // Note: This is to protect memtable and compaction. If the batch only writes
@@ -1903,6 +1903,9 @@ void DBImpl::MaybeScheduleFlushOrCompaction() {
     // DB is being deleted; no more background compactions
     return;
   }
+  // Flushes, in this DB or in the others sharing write_buffer_manager_, may
+  // have ended its write stall since the last write
+  UpdateWriteBufferManagerStall();
   auto bg_job_limits = GetBGJobLimits();
   bool is_flush_pool_empty =
       env_->GetBackgroundThreads(Env::Priority::HIGH) == 0;
@@ -11,6 +11,7 @@
 #include <cinttypes>
 #include <set>
 #include <unordered_set>
+#include "db/blob/blob_file_cache.h"
 #include "db/event_helpers.h"
 #include "db/memtable_list.h"
 #include "file/file_util.h"
@@ -86,6 +87,7 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
   // Get obsolete files.  This function will also update the list of
   // pending files in VersionSet().
   versions_->GetObsoleteFiles(&job_context->sst_delete_files,
+                              &job_context->blob_delete_files,
                               &job_context->manifest_delete_files,
                               job_context->min_pending_output);
 
@@ -103,7 +105,7 @@ void DBImpl::FindObsoleteFiles(JobContext* job_context, bool force,
   job_context->log_number = MinLogNumberToKeep();
   job_context->prev_log_number = versions_->prev_log_number();
 
-  versions_->AddLiveFiles(&job_context->sst_live);
+  versions_->AddLiveFiles(&job_context->sst_live, &job_context->blob_live);
   if (doing_the_full_scan) {
     InfoLogPrefix info_log_prefix(!immutable_db_options_.db_log_dir.empty(),
                                   dbname_);
@@ -309,13 +311,16 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
   for (const FileDescriptor& fd : state.sst_live) {
     sst_live_map[fd.GetNumber()] = &fd;
   }
+  std::unordered_set<uint64_t> blob_live_set(state.blob_live.begin(),
+                                             state.blob_live.end());
   std::unordered_set<uint64_t> log_recycle_files_set(
       state.log_recycle_files.begin(), state.log_recycle_files.end());
 
   auto candidate_files = state.full_scan_candidate_files;
   candidate_files.reserve(
       candidate_files.size() + state.sst_delete_files.size() +
-      state.log_delete_files.size() + state.manifest_delete_files.size());
+      state.blob_delete_files.size() + state.log_delete_files.size() +
+      state.manifest_delete_files.size());
   // We may ignore the dbname when generating the file names.
   for (auto& file : state.sst_delete_files) {
     candidate_files.emplace_back(
@@ -326,6 +331,16 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
     file.DeleteMetadata();
   }
 
+  // The full scan may also find the blob files of a stacked BlobDB, so only
+  // the ones that this DB dropped from its Versions, or wrote and failed to
+  // install, are deleted
+  std::unordered_set<uint64_t> blob_obsolete_set;
+  for (const auto& blob_file : state.blob_delete_files) {
+    candidate_files.emplace_back(BlobFileName("", blob_file.blob_file_number),
+                                 blob_file.path);
+    blob_obsolete_set.insert(blob_file.blob_file_number);
+  }
+
   for (auto file_num : state.log_delete_files) {
     if (file_num > 0) {
       candidate_files.emplace_back(LogFileName(file_num),
@@ -446,11 +461,18 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
             "DBImpl::PurgeObsoleteFiles:CheckOptionsFiles:2",
             reinterpret_cast<void*>(&keep));
         break;
+      case kBlobFile:
+        keep = (blob_live_set.find(number) != blob_live_set.end()) ||
+               number >= state.min_pending_output;
+        if (!keep &&
+            blob_obsolete_set.find(number) == blob_obsolete_set.end()) {
+          keep = !versions_->RemoveUninstalledBlobFile(number);
+        }
+        break;
       case kCurrentFile:
       case kDBLockFile:
       case kIdentityFile:
       case kMetaDatabase:
-      case kBlobFile:
         keep = true;
         break;
     }
@@ -466,6 +488,13 @@ void DBImpl::PurgeObsoleteFiles(JobContext& state, bool schedule_only) {
       TableCache::Evict(table_cache_.get(), number);
       fname = MakeTableFileName(candidate_file.file_path, number);
       dir_to_sync = candidate_file.file_path;
+    } else if (type == kBlobFile) {
+#ifndef ROCKSDB_LITE
+      // Blob file readers share the table cache, keyed by file number too
+      BlobFileCache::Evict(table_cache_.get(), number);
+#endif  // !ROCKSDB_LITE
+      fname = BlobFileName(candidate_file.file_path, number);
+      dir_to_sync = candidate_file.file_path;
     } else {
       dir_to_sync =
           (type == kLogFile) ? immutable_db_options_.wal_dir : dbname_;
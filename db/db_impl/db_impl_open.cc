@@ -9,6 +9,7 @@
 #include "db/db_impl/db_impl.h"
 
 #include <cinttypes>
+#include <deque>
 
 #include "db/builder.h"
 #include "db/error_handler.h"
@@ -21,6 +22,9 @@
 #include "rocksdb/wal_filter.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "test_util/sync_point.h"
+#include "util/compression.h"
+#include "util/countdown_latch.h"
+#include "util/mutexlock.h"
 #include "util/rate_limiter.h"
 
 #include "lemma.h"
@@ -254,6 +258,13 @@ Status DBImpl::ValidateOptions(const DBOptions& db_options) {
         "atomic_flush is incompatible with enable_pipelined_write");
   }
 
+  if (db_options.wal_compression != kNoCompression &&
+      !StreamingCompressionTypeSupported(db_options.wal_compression)) {
+    return Status::InvalidArgument(
+        "wal_compression type is not supported or not linked with the "
+        "binary.");
+  }
+
   return Status::OK();
 }
 
@@ -684,6 +695,195 @@ Status DBImpl::InitPersistStatsColumnFamily() {
   return s;
 }
 
+namespace {
+// With wal_recovery_threads > 2, RecoverLogFiles() inserts batches that can
+// be inserted concurrently once it has read this many bytes of them.
+const size_t kMaxConcurrentRecoveryBytes = 1 << 20;
+
+// The number of bytes of records WalRecordPrefetcher reads ahead.
+const size_t kMaxPrefetchedRecoveryBytes = 8 << 20;
+
+// Joins the threads of a ThreadPool before deleting it.
+struct ThreadPoolDeleter {
+  void operator()(ThreadPool* thread_pool) const {
+    thread_pool->JoinAllThreads();
+    delete thread_pool;
+  }
+};
+
+// Reads the records of a WAL file on a thread of its own during recovery,
+// ahead of RecoverLogFiles() inserting them into the memtables.
+class WalRecordPrefetcher {
+ public:
+  // Reading stops at the end of the file, or once read_status, which the
+  // reporter of reader sets, is not ok. If classify_batches is true, the
+  // reading thread also checks which batches can be inserted concurrently.
+  WalRecordPrefetcher(log::Reader* reader, const Status* read_status,
+                      WALRecoveryMode wal_recovery_mode, bool classify_batches)
+      : reader_(reader),
+        read_status_(read_status),
+        wal_recovery_mode_(wal_recovery_mode),
+        classify_batches_(classify_batches),
+        cv_(&mu_),
+        buffered_bytes_(0),
+        done_(false),
+        stop_(false) {
+    thread_ = port::Thread(&WalRecordPrefetcher::Run, this);
+  }
+
+  ~WalRecordPrefetcher() {
+    {
+      MutexLock l(&mu_);
+      stop_ = true;
+      cv_.SignalAll();
+    }
+    thread_.join();
+  }
+
+  // Moves the next record into *batch. Returns false once all the records
+  // read have been returned.
+  bool Next(WriteBatch* batch, bool* can_insert_concurrently) {
+    MutexLock l(&mu_);
+    while (records_.empty() && !done_) {
+      cv_.Wait();
+    }
+    if (records_.empty()) {
+      return false;
+    }
+    Record& record = records_.front();
+    buffered_bytes_ -= WriteBatchInternal::ByteSize(&record.batch);
+    *batch = std::move(record.batch);
+    *can_insert_concurrently = record.can_insert_concurrently;
+    records_.pop_front();
+    cv_.SignalAll();
+    return true;
+  }
+
+ private:
+  struct Record {
+    WriteBatch batch;
+    bool can_insert_concurrently;
+  };
+
+  void Run() {
+    std::string scratch;
+    Slice contents;
+    std::vector<WriteBatchChunk> chunks;
+    while (true) {
+      {
+        MutexLock l(&mu_);
+        while (buffered_bytes_ >= kMaxPrefetchedRecoveryBytes && !stop_) {
+          cv_.Wait();
+        }
+        if (stop_) {
+          break;
+        }
+      }
+      if (!reader_->ReadRecord(&contents, &scratch, wal_recovery_mode_) ||
+          !read_status_->ok()) {
+        break;
+      }
+      Record record;
+      record.batch = WriteBatch(contents.ToString());
+      record.can_insert_concurrently =
+          classify_batches_ && CanInsertConcurrently(&record.batch, &chunks);
+      MutexLock l(&mu_);
+      buffered_bytes_ += contents.size();
+      records_.push_back(std::move(record));
+      cv_.SignalAll();
+    }
+    MutexLock l(&mu_);
+    done_ = true;
+    cv_.SignalAll();
+  }
+
+  static bool CanInsertConcurrently(WriteBatch* batch,
+                                    std::vector<WriteBatchChunk>* chunks) {
+    // Splitting into a single chunk parses all the records. A malformed batch
+    // is inserted serially, so that it fails at the same record as in serial
+    // recovery.
+    if (!WriteBatchInternal::SplitIntoChunks(batch, 1, chunks).ok()) {
+      return false;
+    }
+    // Merges may read the memtable for records of earlier batches, and the
+    // transaction markers rely on the order of the batches.
+    return !batch->HasMerge() && !batch->HasBeginPrepare() &&
+           !batch->HasEndPrepare() && !batch->HasCommit() &&
+           !batch->HasRollback();
+  }
+
+  log::Reader* reader_;
+  const Status* read_status_;
+  const WALRecoveryMode wal_recovery_mode_;
+  const bool classify_batches_;
+
+  port::Mutex mu_;
+  port::CondVar cv_;
+  std::deque<Record> records_;
+  size_t buffered_bytes_;
+  bool done_;
+  bool stop_;
+  port::Thread thread_;
+};
+}  // namespace
+
+Status DBImpl::InsertRecoveredBatches(const std::vector<WriteBatch>& batches,
+                                      uint64_t log_number,
+                                      ThreadPool* thread_pool,
+                                      bool* has_valid_writes,
+                                      size_t* failed_batch) {
+  assert(immutable_db_options_.wal_recovery_threads > 2);
+  assert(thread_pool != nullptr);
+  const size_t num_threads = std::min(
+      immutable_db_options_.wal_recovery_threads - 1, batches.size());
+  std::vector<Status> statuses(batches.size());
+  std::atomic<size_t> next_batch(0);
+  std::atomic<bool> failed(false);
+  std::atomic<bool> any_valid_writes(false);
+  auto insert_batches = [&]() {
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    bool valid_writes = false;
+    for (size_t i = next_batch.fetch_add(1);
+         i < batches.size() && !failed.load(std::memory_order_relaxed);
+         i = next_batch.fetch_add(1)) {
+      // The batches only have records of their own sequence numbers, so they
+      // can be inserted in any order.
+      statuses[i] = WriteBatchInternal::InsertInto(
+          &batches[i], &column_family_memtables, &flush_scheduler_,
+          &trim_history_scheduler_, true /*ignore_missing_column_families*/,
+          log_number, this, true /*concurrent_memtable_writes*/,
+          nullptr /*next_seq*/, &valid_writes, seq_per_batch_, batch_per_txn_);
+      if (!statuses[i].ok()) {
+        failed.store(true, std::memory_order_relaxed);
+      }
+    }
+    if (valid_writes) {
+      any_valid_writes.store(true, std::memory_order_relaxed);
+    }
+  };
+  size_t num_batches = batches.size();
+  TEST_SYNC_POINT_CALLBACK("DBImpl::InsertRecoveredBatches:NumBatches",
+                           &num_batches);
+  CountDownLatch latch(num_threads - 1);
+  for (size_t i = 1; i < num_threads; i++) {
+    thread_pool->SubmitJob([&insert_batches, &latch]() {
+      insert_batches();
+      latch.CountDown();
+    });
+  }
+  insert_batches();
+  latch.Wait();
+  *has_valid_writes = any_valid_writes.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < statuses.size(); i++) {
+    if (!statuses[i].ok()) {
+      *failed_batch = i;
+      return statuses[i];
+    }
+  }
+  return Status::OK();
+}
+
 // REQUIRES: log_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
                                SequenceNumber* next_sequence, bool read_only,
@@ -740,6 +940,24 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
   }
 #endif
 
+  // See DBOptions::wal_recovery_threads.
+  bool insert_concurrently =
+      immutable_db_options_.wal_recovery_threads > 2 &&
+      immutable_db_options_.allow_concurrent_memtable_write &&
+      !seq_per_batch_ && batch_per_txn_;
+#ifndef ROCKSDB_LITE
+  if (immutable_db_options_.wal_filter != nullptr) {
+    insert_concurrently = false;
+  }
+#endif  // ROCKSDB_LITE
+  // The threads that insert the batches with this one, started once for all
+  // the log files rather than for each group of batches.
+  std::unique_ptr<ThreadPool, ThreadPoolDeleter> insert_thread_pool;
+  if (insert_concurrently) {
+    insert_thread_pool.reset(NewThreadPool(
+        static_cast<int>(immutable_db_options_.wal_recovery_threads - 2)));
+  }
+
   bool stop_replay_by_wal_filter = false;
   bool stop_replay_for_corruption = false;
   bool flushed = false;
@@ -812,25 +1030,99 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
     // paranoid_checks==false so that corruptions cause entire commits
     // to be skipped instead of propagating bad information (like overly
     // large sequence numbers).
+    // A prefetcher reads the records on another thread, so the reader gets a
+    // reporter of its own, and its errors are only taken once the records
+    // before them are inserted.
+    const bool prefetch = immutable_db_options_.wal_recovery_threads > 1;
+    Status read_status;
+    LogReporter read_reporter = reporter;
+    if (read_reporter.status != nullptr) {
+      read_reporter.status = &read_status;
+    }
     log::Reader reader(immutable_db_options_.info_log, std::move(file_reader),
-                       &reporter, true /*checksum*/, log_number);
+                       prefetch ? &read_reporter : &reporter,
+                       true /*checksum*/, log_number);
+    std::unique_ptr<WalRecordPrefetcher> prefetcher;
+    if (prefetch) {
+      prefetcher.reset(new WalRecordPrefetcher(
+          &reader, &read_status, immutable_db_options_.wal_recovery_mode,
+          insert_concurrently));
+    }
+
+    // Flushes the memtables that inserting filled up. We can do this because
+    // this is called before client has access to the DB and there is only a
+    // single thread operating on DB
+    auto flush_full_memtables = [&]() {
+      ColumnFamilyData* cfd;
+      while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+        cfd->UnrefAndTryDelete();
+        // If this asserts, it means that InsertInto failed in
+        // filtering updates to already-flushed column families
+        assert(cfd->GetLogNumber() <= log_number);
+        auto iter = version_edits.find(cfd->GetID());
+        assert(iter != version_edits.end());
+        VersionEdit* edit = &iter->second;
+        Status s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+        if (!s.ok()) {
+          return s;
+        }
+        flushed = true;
+
+        cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                               *next_sequence);
+      }
+      return Status::OK();
+    };
+
+    // Batches read for concurrent insertion and not inserted yet.
+    std::vector<WriteBatch> concurrent_batches;
+    size_t concurrent_batch_bytes = 0;
+    auto insert_concurrent_batches = [&](bool* has_valid_writes) {
+      if (concurrent_batches.empty()) {
+        return Status::OK();
+      }
+      size_t failed_batch = 0;
+      Status s = InsertRecoveredBatches(concurrent_batches, log_number,
+                                        insert_thread_pool.get(),
+                                        has_valid_writes, &failed_batch);
+      MaybeIgnoreError(&s);
+      if (!s.ok()) {
+        reporter.Corruption(
+            WriteBatchInternal::ByteSize(&concurrent_batches[failed_batch]), s);
+      }
+      concurrent_batches.clear();
+      concurrent_batch_bytes = 0;
+      return s;
+    };
 
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
     std::string scratch;
     Slice record;
     WriteBatch batch;
+    bool read_all_records = false;
 
-    while (!stop_replay_by_wal_filter &&
-           reader.ReadRecord(&record, &scratch,
-                             immutable_db_options_.wal_recovery_mode) &&
-           status.ok()) {
+    while (!stop_replay_by_wal_filter && status.ok()) {
+      bool can_insert_concurrently = false;
+      if (prefetcher != nullptr) {
+        if (!prefetcher->Next(&batch, &can_insert_concurrently)) {
+          read_all_records = true;
+          break;
+        }
+        record = WriteBatchInternal::Contents(&batch);
+      } else if (!reader.ReadRecord(&record, &scratch,
+                                    immutable_db_options_.wal_recovery_mode) ||
+                 !status.ok()) {
+        break;
+      }
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
         continue;
       }
-      WriteBatchInternal::SetContents(&batch, record);
+      if (prefetcher == nullptr) {
+        WriteBatchInternal::SetContents(&batch, record);
+      }
       SequenceNumber sequence = WriteBatchInternal::Sequence(&batch);
 
       if (immutable_db_options_.wal_recovery_mode ==
@@ -926,50 +1218,73 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       }
 #endif  // ROCKSDB_LITE
 
-      // If column family was not found, it might mean that the WAL write
-      // batch references to the column family that was dropped after the
-      // insert. We don't want to fail the whole write batch in that case --
-      // we just ignore the update.
-      // That's why we set ignore missing column families to true
+      if (can_insert_concurrently) {
+        // The batch only takes the sequence numbers of its records.
+        *next_sequence = sequence + WriteBatchInternal::Count(&batch);
+        concurrent_batch_bytes += record.size();
+        concurrent_batches.push_back(std::move(batch));
+        if (concurrent_batch_bytes < kMaxConcurrentRecoveryBytes) {
+          continue;
+        }
+      }
+
+      // The batches read for concurrent insertion go first.
       bool has_valid_writes = false;
-      status = WriteBatchInternal::InsertInto(
-          &batch, column_family_memtables_.get(), &flush_scheduler_,
-          &trim_history_scheduler_, true, log_number, this,
-          false /* concurrent_memtable_writes */, next_sequence,
-          &has_valid_writes, seq_per_batch_, batch_per_txn_);
-      MaybeIgnoreError(&status);
+      status = insert_concurrent_batches(&has_valid_writes);
+      if (status.ok() && !can_insert_concurrently) {
+        // If column family was not found, it might mean that the WAL write
+        // batch references to the column family that was dropped after the
+        // insert. We don't want to fail the whole write batch in that case --
+        // we just ignore the update.
+        // That's why we set ignore missing column families to true
+        status = WriteBatchInternal::InsertInto(
+            &batch, column_family_memtables_.get(), &flush_scheduler_,
+            &trim_history_scheduler_, true, log_number, this,
+            false /* concurrent_memtable_writes */, next_sequence,
+            &has_valid_writes, seq_per_batch_, batch_per_txn_);
+        MaybeIgnoreError(&status);
+        if (!status.ok()) {
+          // We are treating this as a failure while reading since we read
+          // valid blocks that do not form coherent data
+          reporter.Corruption(record.size(), status);
+        }
+      }
       if (!status.ok()) {
-        // We are treating this as a failure while reading since we read valid
-        // blocks that do not form coherent data
-        reporter.Corruption(record.size(), status);
         continue;
       }
 
       if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->UnrefAndTryDelete();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= log_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
+        status = flush_full_memtables();
+        if (!status.ok()) {
+          // Reflect errors immediately so that conditions like full
+          // file-systems cause the DB::Open() to fail.
+          return status;
+        }
+      }
+    }
 
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
+    // Serial recovery would have inserted the batches left as soon as it read
+    // them, whatever stopped the replay after them.
+    if (!concurrent_batches.empty()) {
+      bool has_valid_writes = false;
+      Status s = insert_concurrent_batches(&has_valid_writes);
+      if (s.ok() && has_valid_writes && !read_only) {
+        s = flush_full_memtables();
+        if (!s.ok()) {
+          return s;
         }
       }
+      if (status.ok()) {
+        status = s;
+      }
+    }
+    if (prefetcher != nullptr) {
+      prefetcher.reset();
+      // The prefetcher may have read past where the replay stopped, and
+      // errors there do not count.
+      if (read_all_records && status.ok()) {
+        status = read_status;
+      }
     }
 
     if (!status.ok()) {
@@ -1197,6 +1512,7 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
   Arena arena;
   Status s;
   TableProperties table_properties;
+  std::vector<BlobFileAddition> blob_file_additions;
   {
     ScopedArenaIterator iter(mem->NewIterator(ro, &arena));
     ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
@@ -1244,7 +1560,8 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
           cfd->ioptions()->compression_opts, paranoid_file_checks,
           cfd->internal_stats(), TableFileCreationReason::kRecovery,
           &event_logger_, job_id, Env::IO_HIGH, nullptr /* table_properties */,
-          -1 /* level */, current_time, write_hint);
+          -1 /* level */, current_time, 0 /* oldest_key_time */, write_hint,
+          0 /* file_creation_time */, versions_.get(), &blob_file_additions);
       LogFlush(immutable_db_options_.info_log);
       ROCKS_LOG_DEBUG(immutable_db_options_.info_log,
                       "[%s] [WriteLevel0TableForRecovery]"
@@ -1265,11 +1582,17 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
                   meta.fd.smallest_seqno, meta.fd.largest_seqno,
                   meta.marked_for_compaction, meta.oldest_blob_file_number,
                   meta.oldest_ancester_time, meta.file_creation_time);
+    for (const auto& blob_file_addition : blob_file_additions) {
+      edit->AddBlobFile(blob_file_addition);
+    }
   }
 
   InternalStats::CompactionStats stats(CompactionReason::kFlush, 1);
   stats.micros = env_->NowMicros() - start_micros;
   stats.bytes_written = meta.fd.GetFileSize();
+  for (const auto& blob_file_addition : blob_file_additions) {
+    stats.bytes_written += blob_file_addition.GetTotalBlobBytes();
+  }
   stats.num_output_files = 1;
   cfd->internal_stats()->AddCompactionStats(level, Env::Priority::USER, stats);
   cfd->internal_stats()->AddCFStats(InternalStats::BYTES_FLUSHED,
@@ -1381,7 +1704,15 @@ Status DBImpl::CreateWAL(uint64_t log_file_num, uint64_t recycle_log_number,
                                env_, nullptr /* stats */, listeners));
     *new_log = new log::Writer(std::move(file_writer), log_file_num,
                                immutable_db_options_.recycle_log_file_num > 0,
-                               immutable_db_options_.manual_wal_flush);
+                               immutable_db_options_.manual_wal_flush,
+                               immutable_db_options_.wal_compression);
+    if (immutable_db_options_.wal_compression != kNoCompression) {
+      s = (*new_log)->AddCompressionTypeRecord();
+      if (!s.ok()) {
+        delete *new_log;
+        *new_log = nullptr;
+      }
+    }
   }
   return s;
 }
@@ -39,6 +39,12 @@ class DBImplReadOnly : public DBImpl {
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) override;
 
+  virtual Status NewShardedIterators(
+      const ReadOptions& /*options*/, ColumnFamilyHandle* /*column_family*/,
+      size_t /*num_shards*/, std::vector<Iterator*>* /*iterators*/) override {
+    return Status::NotSupported("Not supported operation in read only mode.");
+  }
+
   using DBImpl::Put;
   virtual Status Put(const WriteOptions& /*options*/,
                      ColumnFamilyHandle* /*column_family*/,
@@ -8,9 +8,14 @@
 #include <cinttypes>
 
 #include "db/arena_wrapped_db_iter.h"
+#include "db/compaction/compaction_job.h"
+#include "db/compaction/compaction_picker.h"
+#include "db/compaction/compaction_service.h"
 #include "db/merge_context.h"
 #include "logging/auto_roll_logger.h"
+#include "logging/log_buffer.h"
 #include "monitoring/perf_context_imp.h"
+#include "rocksdb/convenience.h"
 #include "util/cast_util.h"
 
 namespace rocksdb {
@@ -68,6 +73,9 @@ Status DBImplSecondary::Recover(
     s = Status::OK();
   }
   // TODO: update options_file_number_ needed?
+  if (s.ok()) {
+    catch_up_stats_.last_catch_up_micros = env_->NowMicros();
+  }
 
   job_context.Clean();
   return s;
@@ -92,15 +100,52 @@ Status DBImplSecondary::FindAndRecoverLogFiles(
 // List wal_dir and find all new WALs, return these log numbers
 Status DBImplSecondary::FindNewLogNumbers(std::vector<uint64_t>* logs) {
   assert(logs != nullptr);
+  const std::string& wal_dir = immutable_db_options_.wal_dir;
+  int64_t listing_time = 0;
+  uint64_t wal_dir_mtime = 0;
+  if (immutable_db_options_.skip_listing_unchanged_wal_dir) {
+    // Take the time of the listing from the file system that sets the mtime
+    // of wal_dir, rather than from the local clock, which may be skewed: the
+    // latest write to the WAL being tailed happened before the listing, so
+    // any change to wal_dir after the listing gives wal_dir an mtime of at
+    // least listing_time.
+    uint64_t latest_log_mtime = 0;
+    if (!env_->GetFileModificationTime(wal_dir, &wal_dir_mtime).ok() ||
+        log_readers_.empty() ||
+        !env_->GetFileModificationTime(
+                  LogFileName(wal_dir, log_readers_.rbegin()->first),
+                  &latest_log_mtime)
+             .ok()) {
+      wal_dir_mtime = 0;
+      latest_log_mtime = 0;
+    }
+    listing_time = static_cast<int64_t>(latest_log_mtime);
+    // No WAL can have been created or deleted since the last listing if
+    // wal_dir still has the mtime it had then, and that mtime is older than
+    // the listing. Otherwise the listing may have raced with a change made
+    // within the same second, so list again.
+    if (!log_readers_.empty() && wal_dir_mtime != 0 &&
+        wal_dir_mtime == wal_dir_mtime_ &&
+        static_cast<int64_t>(wal_dir_mtime_) < wal_dir_listing_time_) {
+      for (const auto& log_reader : log_readers_) {
+        logs->push_back(log_reader.first);
+      }
+      return Status::OK();
+    }
+  }
+
   std::vector<std::string> filenames;
   Status s;
-  s = env_->GetChildren(immutable_db_options_.wal_dir, &filenames);
+  s = env_->GetChildren(wal_dir, &filenames);
   if (s.IsNotFound()) {
     return Status::InvalidArgument("Failed to open wal_dir",
                                    immutable_db_options_.wal_dir);
   } else if (!s.ok()) {
     return s;
   }
+  wal_dir_mtime_ = wal_dir_mtime;
+  wal_dir_listing_time_ = listing_time;
+  ++catch_up_stats_.wal_dir_listings;
 
   // if log_readers_ is non-empty, it means we have applied all logs with log
   // numbers smaller than the smallest log in log_readers_, so there is no
@@ -208,6 +253,7 @@ Status DBImplSecondary::RecoverLogFiles(
             record.size(), Status::Corruption("log record too small"));
         continue;
       }
+      catch_up_stats_.replayed_wal_bytes += record.size();
       WriteBatchInternal::SetContents(&batch, record);
       SequenceNumber seq_of_batch = WriteBatchInternal::Sequence(&batch);
       std::vector<uint32_t> column_family_ids;
@@ -412,7 +458,7 @@ ArenaWrappedDBIter* DBImplSecondary::NewIteratorImpl(
       env_, read_options, *cfd->ioptions(), super_version->mutable_cf_options,
       snapshot,
       super_version->mutable_cf_options.max_sequential_skip_in_iterations,
-      super_version->version_number, read_callback);
+      super_version->version_number, super_version->current, read_callback);
   auto internal_iter =
       NewInternalIterator(read_options, cfd, super_version, db_iter->GetArena(),
                           db_iter->GetRangeDelAggregator(), snapshot);
@@ -543,6 +589,7 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
         cfd->InstallSuperVersion(&sv_context, &mutex_);
         sv_context.NewSuperVersion();
       }
+      catch_up_stats_.last_catch_up_micros = env_->NowMicros();
     }
   }
   job_context.Clean();
@@ -562,6 +609,97 @@ Status DBImplSecondary::TryCatchUpWithPrimary() {
   return s;
 }
 
+Status DBImplSecondary::CompactWithoutInstallation(
+    ColumnFamilyHandle* cfh, const CompactionServiceInput& input,
+    CompactionServiceResult* result) {
+  assert(result != nullptr);
+  InstrumentedMutexLock l(&mutex_);
+  auto cfd = static_cast_with_check<ColumnFamilyHandleImpl,
+                                    ColumnFamilyHandle>(cfh)->cfd();
+  if (input.output_level < 0 || input.output_level >= cfd->NumberLevels()) {
+    return Status::InvalidArgument("Invalid output level");
+  }
+
+  // Look the input files up in the current version. A compaction spans all
+  // the levels from its first input level to its output level.
+  Version* version = cfd->current();
+  VersionStorageInfo* vstorage = version->storage_info();
+  std::unordered_set<uint64_t> input_set(input.input_files.begin(),
+                                         input.input_files.end());
+  std::vector<CompactionInputFiles> inputs;
+  size_t num_found = 0;
+  for (int level = 0; level <= input.output_level; ++level) {
+    CompactionInputFiles level_inputs;
+    level_inputs.level = level;
+    for (FileMetaData* f : vstorage->LevelFiles(level)) {
+      if (input_set.count(f->fd.GetNumber()) != 0) {
+        level_inputs.files.push_back(f);
+      }
+    }
+    if (inputs.empty() && level_inputs.empty() &&
+        level < input.output_level) {
+      continue;
+    }
+    num_found += level_inputs.size();
+    inputs.push_back(std::move(level_inputs));
+  }
+  if (num_found != input_set.size()) {
+    return Status::NotFound(
+        "Not all the input files of the compaction are in the current version "
+        "of the secondary instance");
+  }
+
+  const ImmutableCFOptions& ioptions = *cfd->ioptions();
+  const MutableCFOptions& mutable_cf_options =
+      *cfd->GetLatestMutableCFOptions();
+  // DB::OpenAndCompact() adds the output directory as the last path.
+  assert(!ioptions.cf_paths.empty());
+  const uint32_t output_path_id =
+      static_cast<uint32_t>(ioptions.cf_paths.size() - 1);
+  std::unique_ptr<Compaction> c(new Compaction(
+      vstorage, ioptions, mutable_cf_options, std::move(inputs),
+      input.output_level, input.target_file_size, input.max_compaction_bytes,
+      output_path_id, input.compression,
+      GetCompressionOptions(ioptions, vstorage, input.output_level),
+      1 /* max_subcompactions */, {} /* grandparents */,
+      true /* manual_compaction */));
+  c->SetInputVersion(version);
+
+  std::unique_ptr<Directory> output_dir;
+  Status s = env_->NewDirectory(ioptions.cf_paths[output_path_id].path,
+                                &output_dir);
+  if (!s.ok()) {
+    c->ReleaseCompactionFiles(s);
+    return s;
+  }
+
+  LogBuffer log_buffer(InfoLogLevel::INFO_LEVEL,
+                       immutable_db_options_.info_log.get());
+  CompactionJobStats compaction_job_stats;
+  CompactionJob compaction_job(
+      next_job_id_.fetch_add(1), c.get(), immutable_db_options_,
+      file_options_for_compaction_, versions_.get(), &shutting_down_,
+      0 /* preserve_deletes_seqnum */, &log_buffer, nullptr /* db_directory */,
+      output_dir.get(), stats_, &mutex_, &error_handler_, input.snapshots,
+      input.earliest_write_conflict_snapshot, nullptr /* snapshot_checker */,
+      table_cache_, &event_logger_, mutable_cf_options.paranoid_file_checks,
+      mutable_cf_options.report_bg_io_stats, dbname_, &compaction_job_stats,
+      Env::Priority::USER);
+
+  Slice begin(input.begin);
+  Slice end(input.end);
+  compaction_job.PrepareForCompactionService(
+      input.has_begin ? &begin : nullptr, input.has_end ? &end : nullptr);
+  mutex_.Unlock();
+  s = compaction_job.Run();
+  mutex_.Lock();
+  compaction_job.FinishForCompactionService(result);
+  c->ReleaseCompactionFiles(s);
+  c.reset();
+  log_buffer.FlushBufferToLog();
+  return s;
+}
+
 Status DB::OpenAsSecondary(const Options& options, const std::string& dbname,
                            const std::string& secondary_path, DB** dbptr) {
   *dbptr = nullptr;
@@ -650,6 +788,83 @@ Status DB::OpenAsSecondary(
   }
   return s;
 }
+
+Status DB::OpenAndCompact(
+    const std::string& name, const std::string& output_directory,
+    const std::string& input, std::string* output,
+    const CompactionServiceOptionsOverride& override_options) {
+  assert(output != nullptr);
+  CompactionServiceInput compaction_input;
+  Status s = compaction_input.DecodeFrom(input);
+  if (!s.ok()) {
+    return s;
+  }
+
+  DBOptions db_options;
+  s = GetDBOptionsFromString(DBOptions(), compaction_input.db_options,
+                             &db_options);
+  if (!s.ok()) {
+    return s;
+  }
+  db_options.env = override_options.env;
+  db_options.max_open_files = -1;
+  db_options.compaction_service = nullptr;
+
+  ColumnFamilyOptions cf_options;
+  s = GetColumnFamilyOptionsFromString(
+      ColumnFamilyOptions(), compaction_input.cf_options, &cf_options);
+  if (!s.ok()) {
+    return s;
+  }
+  if (override_options.comparator != nullptr) {
+    cf_options.comparator = override_options.comparator;
+  }
+  cf_options.merge_operator = override_options.merge_operator;
+  cf_options.compaction_filter = override_options.compaction_filter;
+  cf_options.compaction_filter_factory =
+      override_options.compaction_filter_factory;
+  cf_options.prefix_extractor = override_options.prefix_extractor;
+  if (override_options.table_factory != nullptr) {
+    cf_options.table_factory = override_options.table_factory;
+  }
+  // The output files go to the output directory, which the compaction
+  // addresses as the last path of the column family.
+  cf_options.cf_paths = compaction_input.cf_paths;
+  cf_options.cf_paths.emplace_back(output_directory,
+                                   port::kMaxUint64 /* target_size */);
+
+  s = db_options.env->CreateDirIfMissing(output_directory);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // The default column family must always be opened.
+  std::vector<ColumnFamilyDescriptor> column_families;
+  column_families.emplace_back(compaction_input.column_family_name,
+                               cf_options);
+  if (compaction_input.column_family_name != kDefaultColumnFamilyName) {
+    column_families.emplace_back(kDefaultColumnFamilyName, cf_options);
+  }
+  std::vector<ColumnFamilyHandle*> handles;
+  DB* db = nullptr;
+  s = DB::OpenAsSecondary(db_options, name, output_directory, column_families,
+                          &handles, &db);
+  if (!s.ok()) {
+    return s;
+  }
+
+  CompactionServiceResult result;
+  s = static_cast_with_check<DBImplSecondary, DB>(db)
+          ->CompactWithoutInstallation(handles[0], compaction_input, &result);
+  result.EncodeTo(output);
+
+  for (auto h : handles) {
+    delete h;
+  }
+  delete db;
+  return s;
+}
+
 #else   // !ROCKSDB_LITE
 
 Status DB::OpenAsSecondary(const Options& /*options*/,
@@ -666,6 +881,13 @@ Status DB::OpenAsSecondary(
     std::vector<ColumnFamilyHandle*>* /*handles*/, DB** /*dbptr*/) {
   return Status::NotSupported("Not supported in ROCKSDB_LITE.");
 }
+
+Status DB::OpenAndCompact(
+    const std::string& /*name*/, const std::string& /*output_directory*/,
+    const std::string& /*input*/, std::string* /*output*/,
+    const CompactionServiceOptionsOverride& /*override_options*/) {
+  return Status::NotSupported("Not supported in ROCKSDB_LITE.");
+}
 #endif  // !ROCKSDB_LITE
 
 }  // namespace rocksdb
@@ -13,6 +13,9 @@
 
 namespace rocksdb {
 
+struct CompactionServiceInput;
+struct CompactionServiceResult;
+
 // A wrapper class to hold log reader, log reporter, log status.
 class LogReaderContainer {
  public:
@@ -102,6 +105,13 @@ class DBImplSecondary : public DBImpl {
                       const std::vector<ColumnFamilyHandle*>& column_families,
                       std::vector<Iterator*>* iterators) override;
 
+  Status NewShardedIterators(const ReadOptions& /*options*/,
+                             ColumnFamilyHandle* /*column_family*/,
+                             size_t /*num_shards*/,
+                             std::vector<Iterator*>* /*iterators*/) override {
+    return Status::NotSupported("Not supported operation in secondary mode.");
+  }
+
   using DBImpl::Put;
   Status Put(const WriteOptions& /*options*/,
              ColumnFamilyHandle* /*column_family*/, const Slice& /*key*/,
@@ -222,6 +232,20 @@ class DBImplSecondary : public DBImpl {
   // not flag the missing file as inconsistency.
   Status CheckConsistency() override;
 
+  // Run a compaction that another DB instance offloaded to its
+  // CompactionService, and describe its output in *result instead of
+  // installing it (see DB::OpenAndCompact()). The output files are written
+  // to the last path of the column family.
+  Status CompactWithoutInstallation(ColumnFamilyHandle* cfh,
+                                    const CompactionServiceInput& input,
+                                    CompactionServiceResult* result);
+
+  bool GetSecondaryCatchUpStats(SecondaryCatchUpStats* stats) const override {
+    mutex_.AssertHeld();
+    *stats = catch_up_stats_;
+    return true;
+  }
+
  protected:
   // ColumnFamilyCollector is a write batch handler which does nothing
   // except recording unique column family IDs
@@ -326,6 +350,15 @@ class DBImplSecondary : public DBImpl {
 
   // Current WAL number replayed for each column family.
   std::unordered_map<ColumnFamilyData*, uint64_t> cfd_to_current_log_;
+
+  // Modification time of wal_dir before it was last listed, and the time of
+  // that listing according to the file system of wal_dir (the mtime of the
+  // latest WAL file), both in seconds, for skip_listing_unchanged_wal_dir. 0
+  // if unknown.
+  uint64_t wal_dir_mtime_ = 0;
+  int64_t wal_dir_listing_time_ = 0;
+
+  SecondaryCatchUpStats catch_up_stats_;
 };
 
 }  // namespace rocksdb
@@ -14,6 +14,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
 #include "test_util/sync_point.h"
+#include "util/countdown_latch.h"
 
 namespace rocksdb {
 // Convenience methods
@@ -169,14 +170,19 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       PERF_TIMER_STOP(write_pre_and_post_process_time);
       PERF_TIMER_GUARD(write_memtable_time);
 
-      ColumnFamilyMemTablesImpl column_family_memtables(
-          versions_->GetColumnFamilySet());
-      w.status = WriteBatchInternal::InsertInto(
-          &w, w.sequence, &column_family_memtables, &flush_scheduler_,
-          &trim_history_scheduler_,
-          write_options.ignore_missing_column_families, 0 /*log_number*/, this,
-          true /*concurrent_memtable_writes*/, seq_per_batch_, w.batch_cnt,
-          batch_per_txn_, write_options.memtable_insert_hint_per_batch);
+      if (ShouldInsertBatchInParallel(&w)) {
+        w.status = InsertBatchInParallel(&w, write_options);
+      } else {
+        ColumnFamilyMemTablesImpl column_family_memtables(
+            versions_->GetColumnFamilySet());
+        w.status = WriteBatchInternal::InsertInto(
+            &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+            &trim_history_scheduler_,
+            write_options.ignore_missing_column_families, 0 /*log_number*/,
+            this, true /*concurrent_memtable_writes*/, seq_per_batch_,
+            w.batch_cnt, batch_per_txn_,
+            write_options.memtable_insert_hint_per_batch);
+      }
 
       PERF_TIMER_START(write_pre_and_post_process_time);
     }
@@ -375,7 +381,11 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     if (status.ok()) {
       PERF_TIMER_GUARD(write_memtable_time);
 
-      if (!parallel) {
+      if (!parallel && write_group.size == 1 &&
+          ShouldInsertBatchInParallel(&w)) {
+        assert(w.sequence == current_sequence);
+        w.status = InsertBatchInParallel(&w, write_options);
+      } else if (!parallel) {
         // w.sequence will be set inside InsertInto
         w.status = WriteBatchInternal::InsertInto(
             write_group, current_sequence, column_family_memtables_.get(),
@@ -390,7 +400,10 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
 
         // Each parallel follower is doing each own writes. The leader should
         // also do its own.
-        if (w.ShouldWriteToMemtable()) {
+        if (ShouldInsertBatchInParallel(&w)) {
+          assert(w.sequence == current_sequence);
+          w.status = InsertBatchInParallel(&w, write_options);
+        } else if (w.ShouldWriteToMemtable()) {
           ColumnFamilyMemTablesImpl column_family_memtables(
               versions_->GetColumnFamilySet());
           assert(w.sequence == current_sequence);
@@ -549,6 +562,12 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     if (memtable_write_group.size > 1 &&
         immutable_db_options_.allow_concurrent_memtable_write) {
       write_thread_.LaunchParallelMemTableWriters(&memtable_write_group);
+    } else if (memtable_write_group.size == 1 &&
+               ShouldInsertBatchInParallel(&w)) {
+      w.status = InsertBatchInParallel(&w, write_options);
+      memtable_write_group.status = w.status;
+      versions_->SetLastSequence(memtable_write_group.last_sequence);
+      write_thread_.ExitAsMemTableWriter(&w, memtable_write_group);
     } else {
       memtable_write_group.status = WriteBatchInternal::InsertInto(
           memtable_write_group, w.sequence, column_family_memtables_.get(),
@@ -562,14 +581,19 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
 
   if (w.state == WriteThread::STATE_PARALLEL_MEMTABLE_WRITER) {
     assert(w.ShouldWriteToMemtable());
-    ColumnFamilyMemTablesImpl column_family_memtables(
-        versions_->GetColumnFamilySet());
-    w.status = WriteBatchInternal::InsertInto(
-        &w, w.sequence, &column_family_memtables, &flush_scheduler_,
-        &trim_history_scheduler_, write_options.ignore_missing_column_families,
-        0 /*log_number*/, this, true /*concurrent_memtable_writes*/,
-        false /*seq_per_batch*/, 0 /*batch_cnt*/, true /*batch_per_txn*/,
-        write_options.memtable_insert_hint_per_batch);
+    if (ShouldInsertBatchInParallel(&w)) {
+      w.status = InsertBatchInParallel(&w, write_options);
+    } else {
+      ColumnFamilyMemTablesImpl column_family_memtables(
+          versions_->GetColumnFamilySet());
+      w.status = WriteBatchInternal::InsertInto(
+          &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+          &trim_history_scheduler_,
+          write_options.ignore_missing_column_families, 0 /*log_number*/, this,
+          true /*concurrent_memtable_writes*/, false /*seq_per_batch*/,
+          0 /*batch_cnt*/, true /*batch_per_txn*/,
+          write_options.memtable_insert_hint_per_batch);
+    }
     if (write_thread_.CompleteParallelMemTableWriter(&w)) {
       MemTableInsertStatusCheck(w.status);
       versions_->SetLastSequence(w.write_group->last_sequence);
@@ -837,6 +861,73 @@ void DBImpl::MemTableInsertStatusCheck(const Status& status) {
   }
 }
 
+namespace {
+// The minimum number of records each thread of InsertBatchInParallel()
+// inserts, so that the threads are worth starting.
+const size_t kMinRecordsPerInsertThread = 1000;
+}  // namespace
+
+bool DBImpl::ShouldInsertBatchInParallel(WriteThread::Writer* w) const {
+  if (immutable_db_options_.max_memtable_insert_threads_per_batch <= 1 ||
+      !immutable_db_options_.allow_concurrent_memtable_write ||
+      seq_per_batch_ || !w->ShouldWriteToMemtable()) {
+    return false;
+  }
+  if (WriteBatchInternal::Count(w->batch) < 2 * kMinRecordsPerInsertThread) {
+    return false;
+  }
+  // Merges may read the memtable for records of the same batch, which another
+  // thread may not have inserted yet, and the transaction markers rely on
+  // the order of the records.
+  return !w->batch->HasMerge() && !w->batch->HasBeginPrepare() &&
+         !w->batch->HasEndPrepare() && !w->batch->HasCommit() &&
+         !w->batch->HasRollback();
+}
+
+Status DBImpl::InsertBatchInParallel(WriteThread::Writer* w,
+                                     const WriteOptions& write_options) {
+  assert(ShouldInsertBatchInParallel(w));
+  const size_t num_chunks = std::min(
+      immutable_db_options_.max_memtable_insert_threads_per_batch,
+      WriteBatchInternal::Count(w->batch) / kMinRecordsPerInsertThread);
+  std::vector<WriteBatchChunk> chunks;
+  Status s = WriteBatchInternal::SplitIntoChunks(w->batch, num_chunks, &chunks);
+  if (!s.ok()) {
+    return s;
+  }
+  TEST_SYNC_POINT_CALLBACK("DBImpl::InsertBatchInParallel:NumChunks",
+                           &chunks);
+  WriteBatchInternal::SetSequence(w->batch, w->sequence);
+
+  std::vector<Status> statuses(chunks.size());
+  auto insert_chunk = [&](size_t i) {
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    statuses[i] = WriteBatchInternal::InsertInto(
+        w->batch, chunks[i], w->sequence, &column_family_memtables,
+        &flush_scheduler_, &trim_history_scheduler_,
+        write_options.ignore_missing_column_families, w->log_ref, this,
+        write_options.memtable_insert_hint_per_batch);
+  };
+  // Insert the first chunk in the current thread, like the subcompactions of
+  // CompactionJob::Run(), and the others in memtable_insert_thread_pool_.
+  CountDownLatch latch(chunks.size() - 1);
+  for (size_t i = 1; i < chunks.size(); i++) {
+    memtable_insert_thread_pool_->SubmitJob([&insert_chunk, &latch, i]() {
+      insert_chunk(i);
+      latch.CountDown();
+    });
+  }
+  insert_chunk(0);
+  latch.Wait();
+  for (const auto& chunk_status : statuses) {
+    if (!chunk_status.ok()) {
+      return chunk_status;
+    }
+  }
+  return Status::OK();
+}
+
 Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
                                bool* need_log_sync,
                                WriteContext* write_context) {
@@ -877,6 +968,10 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
     status = ScheduleFlushes(write_context);
   }
 
+  if (UNLIKELY(status.ok() && write_buffer_manager_->stop_limit() > 0)) {
+    UpdateWriteBufferManagerStall();
+  }
+
   PERF_TIMER_STOP(write_scheduling_flushes_compactions_time);
   PERF_TIMER_GUARD(write_pre_and_post_process_time);
 
@@ -888,7 +983,7 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
     // for previous one. It might create a fairness issue that expiration
     // might happen for smaller writes but larger writes can go through.
     // Can optimize it if it is an issue.
-    status = DelayWrite(last_batch_group_size_, write_options);
+    status = DelayWrite(last_batch_group_size_, write_options, write_context);
     PERF_TIMER_START(write_pre_and_post_process_time);
   }
 
@@ -1368,10 +1463,11 @@ uint64_t DBImpl::GetMaxTotalWalSize() const {
 
 // REQUIRES: mutex_ is held
 // REQUIRES: this thread is currently at the front of the writer queue
-Status DBImpl::DelayWrite(uint64_t num_bytes,
-                          const WriteOptions& write_options) {
+Status DBImpl::DelayWrite(uint64_t num_bytes, const WriteOptions& write_options,
+                          WriteContext* write_context) {
   uint64_t time_delayed = 0;
   bool delayed = false;
+  bool wbm_stalled = wbm_write_stall_condition_ != WriteStallCondition::kNormal;
   {
     StopWatch sw(env_, stats_, WRITE_STALL, &time_delayed);
     uint64_t delay = write_controller_.GetDelay(env_, num_bytes);
@@ -1414,11 +1510,35 @@ Status DBImpl::DelayWrite(uint64_t num_bytes,
       }
       delayed = true;
 
+      if (wbm_write_stall_condition_ == WriteStallCondition::kStopped &&
+          HasNonEmptyMemTable()) {
+        // The memory may be held by DBs that do not write, and so never
+        // flush. Flush the memtables of this DB so that the stop does not
+        // depend on them alone.
+        WaitForPendingWrites();
+        Status s = HandleWriteBufferFull(write_context);
+        if (!s.ok()) {
+          return s;
+        }
+      }
+
       // Notify write_thread_ about the stall so it can setup a barrier and
       // fail any pending writers with no_slowdown
       write_thread_.BeginWriteStall();
       TEST_SYNC_POINT("DBImpl::DelayWrite:Wait");
-      bg_cv_.Wait();
+      if (wbm_write_stall_condition_ == WriteStallCondition::kStopped) {
+        // The memory may be freed by the flushes of any of the DBs sharing
+        // write_buffer_manager_, which do not signal bg_cv_. The wait is
+        // bounded so that background errors are still noticed.
+        const uint64_t kWriteBufferManagerWaitMicros = 10000;
+        mutex_.Unlock();
+        write_buffer_manager_->WaitWhileWritesStopped(
+            kWriteBufferManagerWaitMicros);
+        mutex_.Lock();
+        UpdateWriteBufferManagerStall();
+      } else {
+        bg_cv_.Wait();
+      }
       write_thread_.EndWriteStall();
     }
   }
@@ -1427,6 +1547,9 @@ Status DBImpl::DelayWrite(uint64_t num_bytes,
     default_cf_internal_stats_->AddDBStats(
         InternalStats::kIntStatsWriteStallMicros, time_delayed);
     RecordTick(stats_, STALL_MICROS, time_delayed);
+    if (wbm_stalled) {
+      RecordTick(stats_, WRITE_BUFFER_MANAGER_STALL_MICROS, time_delayed);
+    }
   }
 
   // If DB is not in read-only mode and write_controller is not stopping
@@ -1444,6 +1567,55 @@ Status DBImpl::DelayWrite(uint64_t num_bytes,
   return s;
 }
 
+bool DBImpl::HasNonEmptyMemTable() {
+  mutex_.AssertHeld();
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (!cfd->IsDropped() && !cfd->mem()->IsEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void DBImpl::UpdateWriteBufferManagerStall() {
+  mutex_.AssertHeld();
+  if (write_buffer_manager_->stop_limit() == 0) {
+    return;
+  }
+  WriteStallCondition condition = WriteStallCondition::kNormal;
+  if (write_buffer_manager_->ShouldStopWrites()) {
+    condition = WriteStallCondition::kStopped;
+  } else if (write_buffer_manager_->ShouldDelayWrites()) {
+    condition = WriteStallCondition::kDelayed;
+  }
+  if (condition == wbm_write_stall_condition_) {
+    return;
+  }
+  if (condition == WriteStallCondition::kStopped) {
+    wbm_write_controller_token_ = write_controller_.GetStopToken();
+    RecordTick(stats_, WRITE_BUFFER_MANAGER_STOP_COUNT);
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Stopping writes because the write buffer manager uses "
+                   "%" ROCKSDB_PRIszt " bytes, stop limit %" ROCKSDB_PRIszt,
+                   write_buffer_manager_->memory_usage(),
+                   write_buffer_manager_->stop_limit());
+  } else if (condition == WriteStallCondition::kDelayed) {
+    wbm_write_controller_token_ =
+        write_controller_.GetDelayToken(write_controller_.delayed_write_rate());
+    RecordTick(stats_, WRITE_BUFFER_MANAGER_DELAY_COUNT);
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Delaying writes because the write buffer manager uses "
+                   "%" ROCKSDB_PRIszt " bytes, buffer size %" ROCKSDB_PRIszt
+                   ", rate %" PRIu64,
+                   write_buffer_manager_->memory_usage(),
+                   write_buffer_manager_->buffer_size(),
+                   write_controller_.delayed_write_rate());
+  } else {
+    wbm_write_controller_token_.reset();
+  }
+  wbm_write_stall_condition_ = condition;
+}
+
 Status DBImpl::ThrottleLowPriWritesIfNeeded(const WriteOptions& write_options,
                                             WriteBatch* my_batch) {
   assert(write_options.low_pri);
@@ -334,6 +334,124 @@ TEST_F(DBSecondaryTest, OpenAsSecondaryWALTailing) {
   verify_db_func("new_foo_value_1", "new_bar_value");
 }
 
+TEST_F(DBSecondaryTest, SkipListingUnchangedWalDir) {
+  // Makes the modification times of the primary's directory and WAL files
+  // deterministic, and the current time seen by the secondary far off, as
+  // with a skewed clock.
+  class WalDirTimeEnv : public EnvWrapper {
+   public:
+    WalDirTimeEnv(Env* target, const std::string& wal_dir)
+        : EnvWrapper(target), wal_dir_(wal_dir) {}
+
+    Status GetFileModificationTime(const std::string& fname,
+                                   uint64_t* file_mtime) override {
+      if (fname == wal_dir_) {
+        *file_mtime = wal_dir_mtime;
+        return Status::OK();
+      }
+      uint64_t number = 0;
+      FileType type;
+      if (fname.compare(0, wal_dir_.size() + 1, wal_dir_ + "/") == 0 &&
+          ParseFileName(fname.substr(wal_dir_.size() + 1), &number, &type) &&
+          type == kLogFile) {
+        *file_mtime = log_mtime;
+        return Status::OK();
+      }
+      return EnvWrapper::GetFileModificationTime(fname, file_mtime);
+    }
+
+    Status GetCurrentTime(int64_t* unix_time) override {
+      *unix_time = 0;
+      return Status::OK();
+    }
+
+    std::atomic<uint64_t> wal_dir_mtime{100};
+    std::atomic<uint64_t> log_mtime{200};
+
+   private:
+    std::string wal_dir_;
+  };
+
+  Options options;
+  options.env = env_;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "v1"));
+
+  WalDirTimeEnv time_env(env_, dbname_);
+  Options options1;
+  options1.env = &time_env;
+  options1.max_open_files = -1;
+  options1.skip_listing_unchanged_wal_dir = true;
+  OpenSecondary(options1);
+
+  uint64_t value = 0;
+  ASSERT_FALSE(
+      db_->GetIntProperty(DB::Properties::kSecondaryWalDirListings, &value));
+  const auto listings = [&]() {
+    uint64_t num_listings = 0;
+    EXPECT_TRUE(db_secondary_->GetIntProperty(
+        DB::Properties::kSecondaryWalDirListings, &num_listings));
+    return num_listings;
+  };
+  const auto get = [&](const std::string& key) {
+    std::string result;
+    Status s = db_secondary_->Get(ReadOptions(), key, &result);
+    return s.IsNotFound() ? "NOT_FOUND" : result;
+  };
+  ASSERT_EQ(1U, listings());
+  ASSERT_EQ("v1", get("foo"));
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondaryReplayedWalBytes, &value));
+  uint64_t replayed_wal_bytes = value;
+  ASSERT_GT(replayed_wal_bytes, 0U);
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondarySecondsSinceCatchUp, &value));
+
+  // The listing on open had no WAL file to take its time from, so the first
+  // catch-up lists wal_dir again.
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(2U, listings());
+
+  // New records in the current WAL are found without listing wal_dir.
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(2U, listings());
+  ASSERT_EQ("v2", get("foo"));
+  ASSERT_TRUE(db_secondary_->GetIntProperty(
+      DB::Properties::kSecondaryReplayedWalBytes, &value));
+  ASSERT_GT(value, replayed_wal_bytes);
+
+  // The WAL created by the flush is only found once wal_dir's mtime changes.
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("bar", "v1"));
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(2U, listings());
+  ASSERT_EQ("v2", get("foo"));
+  ASSERT_EQ("NOT_FOUND", get("bar"));
+  time_env.wal_dir_mtime = 150;
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(3U, listings());
+  ASSERT_EQ("v1", get("bar"));
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(3U, listings());
+
+  // A change in the same second as the latest write to the WAL file, and so
+  // possibly as the listing, could have been missed, so wal_dir is listed
+  // again until the WAL file is written to in a later second.
+  time_env.wal_dir_mtime = 200;
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(4U, listings());
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(5U, listings());
+  time_env.log_mtime = 201;
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(6U, listings());
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(6U, listings());
+
+  CloseSecondary();
+}
+
 TEST_F(DBSecondaryTest, OpenWithNonExistColumnFamily) {
   Options options;
   options.env = env_;
@@ -16,6 +16,7 @@
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
 #include "db/pinned_iterators_manager.h"
+#include "db/version_set.h"
 #include "file/filename.h"
 #include "logging/logging.h"
 #include "memory/arena.h"
@@ -52,7 +53,7 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
                const Comparator* cmp, InternalIterator* iter, SequenceNumber s,
                bool arena_mode, uint64_t max_sequential_skip_in_iterations,
                ReadCallback* read_callback, DBImpl* db_impl,
-               ColumnFamilyData* cfd, bool allow_blob)
+               ColumnFamilyData* cfd, bool allow_blob, Version* version)
     : prefix_extractor_(mutable_cf_options.prefix_extractor.get()),
       env_(_env),
       logger_(cf_options.info_log),
@@ -80,8 +81,12 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
       is_blob_(false),
       arena_mode_(arena_mode),
       range_del_agg_(&cf_options.internal_comparator, s),
+      failed_range_del_seq_(0),
       db_impl_(db_impl),
       cfd_(cfd),
+      version_(version),
+      read_tier_(read_options.read_tier),
+      verify_checksums_(read_options.verify_checksums),
       start_seqnum_(read_options.iter_start_seqnum) {
   RecordTick(statistics_, NO_ITERATOR_CREATED);
   max_skip_ = max_sequential_skip_in_iterations;
@@ -127,6 +132,54 @@ bool DBIter::ParseKey(ParsedInternalKey* ikey) {
   }
 }
 
+bool DBIter::CanResolveBlobIndex() const {
+  return !allow_blob_ && version_ != nullptr &&
+         !version_->storage_info()->GetBlobFiles().empty();
+}
+
+bool DBIter::FetchBlobValue(const Slice& user_key, const Slice& blob_index) {
+  assert(CanResolveBlobIndex());
+
+  ReadOptions read_options;
+  read_options.read_tier = read_tier_;
+  read_options.verify_checksums = verify_checksums_;
+
+  const Status s =
+      version_->GetBlob(read_options, user_key, blob_index, &blob_value_);
+  if (!s.ok()) {
+    status_ = s;
+    valid_ = false;
+    return false;
+  }
+  return true;
+}
+
+bool DBIter::SetBlobValueIfNeeded(const Slice& user_key,
+                                  const Slice& blob_index) {
+  assert(!is_blob_);
+
+  if (allow_blob_) {
+    // The caller resolves the blob index.
+    is_blob_ = true;
+    return true;
+  }
+
+  if (!CanResolveBlobIndex()) {
+    ROCKS_LOG_ERROR(logger_, "Encounter unexpected blob index.");
+    status_ = Status::NotSupported(
+        "Encounter unexpected blob index. Please open DB with "
+        "rocksdb::blob_db::BlobDB instead.");
+    valid_ = false;
+    return false;
+  }
+
+  if (!FetchBlobValue(user_key, blob_index)) {
+    return false;
+  }
+  is_blob_ = true;
+  return true;
+}
+
 void DBIter::Next() {
   assert(valid_);
   assert(status_.ok());
@@ -228,6 +281,8 @@ bool DBIter::FindNextUserEntryInternal(bool skipping_saved_key,
       is_key_seqnum_zero_ = false;
       return false;
     }
+    // Whether the current entry is covered by a range tombstone.
+    bool range_deleted = false;
 
     is_key_seqnum_zero_ = (ikey_.sequence == 0);
 
@@ -317,20 +372,15 @@ bool DBIter::FindNextUserEntryInternal(bool skipping_saved_key,
                 // Arrange to skip all upcoming entries for this key since
                 // they are hidden by this deletion.
                 skipping_saved_key = true;
+                range_deleted = true;
                 num_skipped = 0;
                 reseek_done = false;
                 PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
               } else if (ikey_.type == kTypeBlobIndex) {
-                if (!allow_blob_) {
-                  ROCKS_LOG_ERROR(logger_, "Encounter unexpected blob index.");
-                  status_ = Status::NotSupported(
-                      "Encounter unexpected blob index. Please open DB with "
-                      "rocksdb::blob_db::BlobDB instead.");
-                  valid_ = false;
+                if (!SetBlobValueIfNeeded(ikey_.user_key, iter_.value())) {
                   return false;
                 }
 
-                is_blob_ = true;
                 valid_ = true;
                 return true;
               } else {
@@ -348,6 +398,7 @@ bool DBIter::FindNextUserEntryInternal(bool skipping_saved_key,
               // Arrange to skip all upcoming entries for this key since
               // they are hidden by this deletion.
               skipping_saved_key = true;
+              range_deleted = true;
               num_skipped = 0;
               reseek_done = false;
               PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
@@ -418,7 +469,7 @@ bool DBIter::FindNextUserEntryInternal(bool skipping_saved_key,
       }
       iter_.Seek(last_key);
       RecordTick(statistics_, NUMBER_OF_RESEEKS_IN_ITERATION);
-    } else {
+    } else if (!range_deleted || !SkipRangeDeletedEntries()) {
       iter_.Next();
     }
   } while (iter_.Valid());
@@ -427,6 +478,27 @@ bool DBIter::FindNextUserEntryInternal(bool skipping_saved_key,
   return iter_.status().ok();
 }
 
+bool DBIter::SkipRangeDeletedEntries() {
+  ParsedInternalKey end_key;
+  SequenceNumber seq;
+  if (!range_del_agg_.GetForwardCoveringTombstone(&end_key, &seq)) {
+    return false;
+  }
+  range_del_end_key_.clear();
+  AppendInternalKey(&range_del_end_key_, end_key);
+  if (seq == failed_range_del_seq_ &&
+      range_del_end_key_ == failed_range_del_end_key_) {
+    return false;
+  }
+  if (!iter_.SkipCoveredEntries(range_del_end_key_, seq)) {
+    failed_range_del_end_key_.swap(range_del_end_key_);
+    failed_range_del_seq_ = seq;
+    return false;
+  }
+  PERF_COUNTER_ADD(internal_range_del_reseek_count, 1);
+  return true;
+}
+
 // Merge values of the same user key starting from the current iter_ position
 // Scan from the newer entries to older entries.
 // PRE: iter_.key() points to the first merge type entry
@@ -467,10 +539,17 @@ bool DBIter::MergeValuesNewToOld() {
       // iter_ is positioned after delete
       iter_.Next();
       break;
-    } else if (kTypeValue == ikey.type) {
+    } else if (kTypeValue == ikey.type ||
+               (kTypeBlobIndex == ikey.type && CanResolveBlobIndex())) {
       // hit a put, merge the put value with operands and store the
       // final result in saved_value_. We are done!
-      const Slice val = iter_.value();
+      Slice val = iter_.value();
+      if (kTypeBlobIndex == ikey.type) {
+        if (!FetchBlobValue(ikey.user_key, val)) {
+          return false;
+        }
+        val = blob_value_;
+      }
       s = MergeHelper::TimedFullMerge(
           merge_operator_, ikey.user_key, &val, merge_context_.GetOperands(),
           &saved_value_, logger_, statistics_, env_, &pinned_value_, true);
@@ -793,6 +872,16 @@ bool DBIter::FindValueForCurrentKey() {
             merge_operator_, saved_key_.GetUserKey(), nullptr,
             merge_context_.GetOperands(), &saved_value_, logger_, statistics_,
             env_, &pinned_value_, true);
+      } else if (last_not_merge_type == kTypeBlobIndex &&
+                 CanResolveBlobIndex()) {
+        if (!FetchBlobValue(saved_key_.GetUserKey(), pinned_value_)) {
+          return false;
+        }
+        const Slice val = blob_value_;
+        s = MergeHelper::TimedFullMerge(
+            merge_operator_, saved_key_.GetUserKey(), &val,
+            merge_context_.GetOperands(), &saved_value_, logger_, statistics_,
+            env_, &pinned_value_, true);
       } else if (last_not_merge_type == kTypeBlobIndex) {
         if (!allow_blob_) {
           ROCKS_LOG_ERROR(logger_, "Encounter unexpected blob index.");
@@ -817,15 +906,9 @@ bool DBIter::FindValueForCurrentKey() {
       // do nothing - we've already has value in pinned_value_
       break;
     case kTypeBlobIndex:
-      if (!allow_blob_) {
-        ROCKS_LOG_ERROR(logger_, "Encounter unexpected blob index.");
-        status_ = Status::NotSupported(
-            "Encounter unexpected blob index. Please open DB with "
-            "rocksdb::blob_db::BlobDB instead.");
-        valid_ = false;
+      if (!SetBlobValueIfNeeded(saved_key_.GetUserKey(), pinned_value_)) {
         return false;
       }
-      is_blob_ = true;
       break;
     default:
       assert(false);
@@ -888,18 +971,13 @@ bool DBIter::FindValueForCurrentKeyUsingSeek() {
     valid_ = false;
     return true;
   }
-  if (ikey.type == kTypeBlobIndex && !allow_blob_) {
-    ROCKS_LOG_ERROR(logger_, "Encounter unexpected blob index.");
-    status_ = Status::NotSupported(
-        "Encounter unexpected blob index. Please open DB with "
-        "rocksdb::blob_db::BlobDB instead.");
-    valid_ = false;
-    return false;
-  }
   if (ikey.type == kTypeValue || ikey.type == kTypeBlobIndex) {
     assert(iter_.iter()->IsValuePinned());
     pinned_value_ = iter_.value();
-    is_blob_ = (ikey.type == kTypeBlobIndex);
+    if (ikey.type == kTypeBlobIndex &&
+        !SetBlobValueIfNeeded(ikey.user_key, pinned_value_)) {
+      return false;
+    }
     valid_ = true;
     return true;
   }
@@ -932,8 +1010,15 @@ bool DBIter::FindValueForCurrentKeyUsingSeek() {
         range_del_agg_.ShouldDelete(
             ikey, RangeDelPositioningMode::kForwardTraversal)) {
       break;
-    } else if (ikey.type == kTypeValue) {
-      const Slice val = iter_.value();
+    } else if (ikey.type == kTypeValue ||
+               (ikey.type == kTypeBlobIndex && CanResolveBlobIndex())) {
+      Slice val = iter_.value();
+      if (ikey.type == kTypeBlobIndex) {
+        if (!FetchBlobValue(ikey.user_key, val)) {
+          return false;
+        }
+        val = blob_value_;
+      }
       Status s = MergeHelper::TimedFullMerge(
           merge_operator_, saved_key_.GetUserKey(), &val,
           merge_context_.GetOperands(), &saved_value_, logger_, statistics_,
@@ -1316,11 +1401,12 @@ Iterator* NewDBIterator(Env* env, const ReadOptions& read_options,
                         const SequenceNumber& sequence,
                         uint64_t max_sequential_skip_in_iterations,
                         ReadCallback* read_callback, DBImpl* db_impl,
-                        ColumnFamilyData* cfd, bool allow_blob) {
+                        ColumnFamilyData* cfd, bool allow_blob,
+                        Version* version) {
   DBIter* db_iter = new DBIter(
       env, read_options, cf_options, mutable_cf_options, user_key_comparator,
       internal_iter, sequence, false, max_sequential_skip_in_iterations,
-      read_callback, db_impl, cfd, allow_blob);
+      read_callback, db_impl, cfd, allow_blob, version);
   return db_iter;
 }
 
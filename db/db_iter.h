@@ -117,7 +117,7 @@ class DBIter final : public Iterator {
          InternalIterator* iter, SequenceNumber s, bool arena_mode,
          uint64_t max_sequential_skip_in_iterations,
          ReadCallback* read_callback, DBImpl* db_impl, ColumnFamilyData* cfd,
-         bool allow_blob);
+         bool allow_blob, Version* version = nullptr);
 
   // No copying allowed
   DBIter(const DBIter&) = delete;
@@ -157,6 +157,9 @@ class DBIter final : public Iterator {
       // If pinned_value_ is set then the result of merge operator is one of
       // the merge operands and we should return it.
       return pinned_value_.data() ? pinned_value_ : saved_value_;
+    } else if (is_blob_ && !allow_blob_) {
+      // The blob the blob index of the current entry refers to.
+      return blob_value_;
     } else if (direction_ == kReverse) {
       return pinned_value_;
     } else {
@@ -172,8 +175,10 @@ class DBIter final : public Iterator {
     }
   }
   bool IsBlob() const {
-    assert(valid_ && (allow_blob_ || !is_blob_));
-    return is_blob_;
+    assert(valid_);
+    // Blobs read from the blob files of version_ are regular values as far
+    // as the user is concerned.
+    return allow_blob_ && is_blob_;
   }
 
   Status GetProperty(std::string prop_name, std::string* prop) override;
@@ -218,6 +223,19 @@ class DBIter final : public Iterator {
   bool FindNextUserEntryInternal(bool skipping_saved_key, const Slice* prefix);
   bool ParseKey(ParsedInternalKey* key);
   bool MergeValuesNewToOld();
+  // Called when the current entry was found covered by a range tombstone
+  // while moving forward. Asks iter_ to skip the rest of the entries the
+  // tombstone covers and returns true if iter_ moved past the current entry.
+  bool SkipRangeDeletedEntries();
+
+  // Whether blob indexes are resolved by this iterator, i.e. whether they
+  // refer to the blob files of version_ rather than to the StackableDB
+  // BlobDB, which resolves them on its own (allow_blob_).
+  bool CanResolveBlobIndex() const;
+  // Reads the blob a blob index refers to into blob_value_.
+  bool FetchBlobValue(const Slice& user_key, const Slice& blob_index);
+  // Handles a blob index found as the value of the current entry.
+  bool SetBlobValueIfNeeded(const Slice& user_key, const Slice& blob_index);
 
   // If prefix is not null, we need to set the iterator to invalid if no more
   // entry can be found within the prefix.
@@ -316,6 +334,12 @@ class DBIter final : public Iterator {
   // List of operands for merge operator.
   MergeContext merge_context_;
   ReadRangeDelAggregator range_del_agg_;
+  // Encoded end key of the covering tombstone, for SkipRangeDeletedEntries().
+  std::string range_del_end_key_;
+  // The tombstone SkipRangeDeletedEntries() last failed to skip, so that it
+  // is not retried for every entry that tombstone covers.
+  std::string failed_range_del_end_key_;
+  SequenceNumber failed_range_del_seq_;
   LocalStatistics local_stats_;
   PinnedIteratorsManager pinned_iters_mgr_;
 #ifdef ROCKSDB_LITE
@@ -326,6 +350,11 @@ class DBIter final : public Iterator {
   ROCKSDB_FIELD_UNUSED
 #endif
   ColumnFamilyData* cfd_;
+  // Used to read the blobs that blob indexes refer to, unless allow_blob_
+  Version* version_;
+  ReadTier read_tier_;
+  bool verify_checksums_;
+  PinnableSlice blob_value_;
   // for diff snapshots we want the lower bound on the seqnum;
   // if this value > 0 iterator will return internal keys
   SequenceNumber start_seqnum_;
@@ -340,6 +369,7 @@ extern Iterator* NewDBIterator(
     const Comparator* user_key_comparator, InternalIterator* internal_iter,
     const SequenceNumber& sequence, uint64_t max_sequential_skip_in_iterations,
     ReadCallback* read_callback, DBImpl* db_impl = nullptr,
-    ColumnFamilyData* cfd = nullptr, bool allow_blob = false);
+    ColumnFamilyData* cfd = nullptr, bool allow_blob = false,
+    Version* version = nullptr);
 
 }  // namespace rocksdb
@@ -2178,6 +2178,126 @@ TEST_P(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+TEST_P(DBIteratorTest, AdaptiveReadahead) {
+  Options options;
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(1024, 'a');
+  for (int i = 0; i < 200; i++) {
+    ASSERT_OK(Put(Key(i), value));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<size_t> readahead_sizes;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableIterator:AutoReadahead", [&](void* arg) {
+        readahead_sizes.push_back(*static_cast<size_t*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto scan = [&](const ReadOptions& read_options, int num_keys) {
+    readahead_sizes.clear();
+    std::unique_ptr<Iterator> iter(NewIterator(read_options));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid() && count < num_keys;
+         iter->Next()) {
+      ASSERT_EQ(value, iter->value());
+      count++;
+    }
+    ASSERT_EQ(num_keys, count);
+  };
+
+  // The first iterator ramps up from the default size.
+  ReadOptions read_options;
+  read_options.adaptive_readahead = true;
+  scan(read_options, 100);
+  ASSERT_GT(readahead_sizes.size(), 1U);
+  ASSERT_EQ(8 * 1024U, readahead_sizes.front());
+  size_t reached = readahead_sizes.back() * 2;
+
+  // The next one starts where it stopped.
+  scan(read_options, 100);
+  ASSERT_EQ(reached, readahead_sizes.front());
+
+  // Iterators without the option are not affected.
+  scan(ReadOptions(), 100);
+  ASSERT_EQ(8 * 1024U, readahead_sizes.front());
+
+  // A short scan halves the size.
+  scan(read_options, 1);
+  ASSERT_TRUE(readahead_sizes.empty());
+  scan(read_options, 100);
+  ASSERT_EQ(reached / 2, readahead_sizes.front());
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_P(DBIteratorTest, AsyncReadahead) {
+  for (bool supports_async_read : {true, false}) {
+    std::shared_ptr<DeferredReadFileSystem> fs =
+        std::make_shared<DeferredReadFileSystem>(FileSystem::Default(),
+                                                 supports_async_read);
+    Options options;
+    options.env = env_;
+    options.file_system = fs;
+    options.create_if_missing = true;
+    options.disable_auto_compactions = true;
+    options.compression = kNoCompression;
+    options.compaction_readahead_size = 16 * 1024;
+    options.async_compaction_readahead = true;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    table_options.no_block_cache = true;
+    options.table_factory.reset(new BlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    for (int round = 0; round < 2; round++) {
+      for (int i = 0; i < 500; i++) {
+        ASSERT_OK(
+            Put(Key(i), std::string(1024, static_cast<char>('a' + round))));
+      }
+      ASSERT_OK(Flush());
+    }
+    // The compaction reads both files with asynchronous readahead, if the
+    // files support asynchronous reads.
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    const int compaction_async_reads = fs->num_async_reads_;
+    if (supports_async_read) {
+      ASSERT_GT(compaction_async_reads, 0);
+    } else {
+      ASSERT_EQ(0, compaction_async_reads);
+    }
+
+    ReadOptions read_options;
+    read_options.async_io = true;
+    read_options.readahead_size = 16 * 1024;
+    std::unique_ptr<Iterator> iter(NewIterator(read_options));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(count), iter->key().ToString());
+      ASSERT_EQ(std::string(1024, 'b'), iter->value().ToString());
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(500, count);
+    if (supports_async_read) {
+      ASSERT_GT(fs->num_async_reads_, compaction_async_reads);
+    } else {
+      ASSERT_EQ(0, fs->num_async_reads_);
+    }
+    iter.reset();
+    Close();
+  }
+}
+
 // Insert a key, create a snapshot iterator, overwrite key lots of times,
 // seek to a smaller key. Expect DBIter to fall back to a seek instead of
 // going through all the overwrites linearly.
@@ -2851,6 +2971,96 @@ TEST_P(DBIteratorTest, IterateWithLowerBoundAcrossFileBoundary) {
   ASSERT_OK(iter->status());
 }
 
+TEST_P(DBIteratorTest, ShardedIterators) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  const int kNumKeys = 1000;
+  // Two overlapping files, compacted into a single one, which can only be
+  // split with keys sampled from its index
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 1; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+
+  auto scan_shards = [&](const ReadOptions& read_options, size_t num_shards,
+                         std::vector<std::vector<std::string>>* shards) {
+    std::vector<Iterator*> iters;
+    ASSERT_OK(db_->NewShardedIterators(read_options, db_->DefaultColumnFamily(),
+                                       num_shards, &iters));
+    // Written after the iterators were created, so invisible to all of them
+    ASSERT_OK(Put(Key(kNumKeys / 2) + "a", "v"));
+    ASSERT_OK(Delete(Key(kNumKeys / 2 + 1)));
+    shards->clear();
+    for (Iterator* iter : iters) {
+      shards->emplace_back();
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        shards->back().push_back(iter->key().ToString());
+      }
+      ASSERT_OK(iter->status());
+      delete iter;
+    }
+    ASSERT_OK(Delete(Key(kNumKeys / 2) + "a"));
+    ASSERT_OK(Put(Key(kNumKeys / 2 + 1), "v"));
+  };
+
+  std::vector<std::vector<std::string>> shards;
+  scan_shards(ReadOptions(), 4, &shards);
+  ASSERT_GT(shards.size(), 1U);
+  ASSERT_LE(shards.size(), 4U);
+  std::vector<std::string> keys;
+  for (auto& shard : shards) {
+    // The shards are roughly balanced
+    ASSERT_GT(shard.size(), kNumKeys / shards.size() / 2);
+    ASSERT_LT(shard.size(), kNumKeys / shards.size() * 2);
+    keys.insert(keys.end(), shard.begin(), shard.end());
+  }
+  ASSERT_EQ(static_cast<size_t>(kNumKeys), keys.size());
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(Key(i), keys[i]);
+  }
+
+  // The shards cover exactly the range of the bounds
+  std::string lower_key = Key(100);
+  std::string upper_key = Key(900);
+  Slice lower(lower_key);
+  Slice upper(upper_key);
+  ReadOptions read_options;
+  read_options.iterate_lower_bound = &lower;
+  read_options.iterate_upper_bound = &upper;
+  scan_shards(read_options, 3, &shards);
+  ASSERT_GT(shards.size(), 1U);
+  ASSERT_LE(shards.size(), 3U);
+  keys.clear();
+  for (auto& shard : shards) {
+    keys.insert(keys.end(), shard.begin(), shard.end());
+  }
+  ASSERT_EQ(800U, keys.size());
+  for (int i = 0; i < 800; i++) {
+    ASSERT_EQ(Key(100 + i), keys[i]);
+  }
+
+  scan_shards(ReadOptions(), 1, &shards);
+  ASSERT_EQ(1U, shards.size());
+  ASSERT_EQ(static_cast<size_t>(kNumKeys), shards[0].size());
+
+  std::vector<Iterator*> iters;
+  ASSERT_TRUE(db_->NewShardedIterators(ReadOptions(),
+                                       db_->DefaultColumnFamily(), 0, &iters)
+                  .IsInvalidArgument());
+}
+
 INSTANTIATE_TEST_CASE_P(DBIteratorTestInstance, DBIteratorTest,
                         testing::Values(true, false));
 
@@ -274,6 +274,178 @@ TEST_F(DBMemTableTest, ConcurrentMergeWrite) {
   delete mem;
 }
 
+// Compares the lookups of memtables with and without a hash index.
+TEST_F(DBMemTableTest, HashIndexGet) {
+  Options options;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.allow_concurrent_memtable_write = true;
+  InternalKeyComparator cmp(BytewiseComparator());
+  ImmutableCFOptions ioptions(options);
+  WriteBufferManager wb(options.db_write_buffer_size);
+  MemTable* mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                               kMaxSequenceNumber, 0 /* column_family_id */);
+  options.memtable_hash_index_size_ratio = 0.01;
+  MemTable* indexed_mem =
+      new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                   kMaxSequenceNumber, 0 /* column_family_id */);
+
+  const int kNumKeys = 50;
+  Random rnd(301);
+  MemTablePostProcessInfo post_process_info;
+  SequenceNumber seq = 0;
+  for (int i = 0; i < 2000; i++) {
+    std::string key = "key" + ToString(rnd.Uniform(kNumKeys));
+    std::string value = "v" + ToString(i);
+    ValueType type;
+    switch (rnd.Uniform(4)) {
+      case 0:
+        type = kTypeValue;
+        break;
+      case 1:
+        type = kTypeMerge;
+        break;
+      case 2:
+        type = kTypeDeletion;
+        value.clear();
+        break;
+      default:
+        type = kTypeSingleDeletion;
+        value.clear();
+        break;
+    }
+    seq++;
+    bool concurrent = rnd.OneIn(2);
+    ASSERT_TRUE(mem->Add(seq, type, key, value, concurrent,
+                         concurrent ? &post_process_info : nullptr));
+    ASSERT_TRUE(indexed_mem->Add(seq, type, key, value, concurrent,
+                                 concurrent ? &post_process_info : nullptr));
+  }
+
+  ReadOptions roptions;
+  for (int k = 0; k < kNumKeys + 10; k++) {
+    std::string key = "key" + ToString(k);
+    for (SequenceNumber snapshot = 0; snapshot <= seq + 1; snapshot += 37) {
+      LookupKey lkey(key, snapshot);
+      std::string value, indexed_value;
+      Status s, indexed_s;
+      MergeContext merge_context, indexed_merge_context;
+      SequenceNumber max_covering_tombstone_seq = 0;
+      SequenceNumber indexed_max_covering_tombstone_seq = 0;
+      bool found = mem->Get(lkey, &value, &s, &merge_context,
+                            &max_covering_tombstone_seq, roptions);
+      bool indexed_found = indexed_mem->Get(
+          lkey, &indexed_value, &indexed_s, &indexed_merge_context,
+          &indexed_max_covering_tombstone_seq, roptions);
+      ASSERT_EQ(found, indexed_found);
+      ASSERT_EQ(s.ToString(), indexed_s.ToString());
+      ASSERT_EQ(value, indexed_value);
+      ASSERT_EQ(merge_context.GetNumOperands(),
+                indexed_merge_context.GetNumOperands());
+    }
+  }
+  delete mem;
+  delete indexed_mem;
+
+  // Concurrent writers of the same keys leave the newest entry indexed.
+  indexed_mem = new MemTable(cmp, ioptions, MutableCFOptions(options), &wb,
+                             kMaxSequenceNumber, 0 /* column_family_id */);
+  const int kNumThreads = 4;
+  const int kOpsPerThread = 1000;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      MemTablePostProcessInfo thread_post_process_info;
+      for (int i = 0; i < kOpsPerThread; i++) {
+        SequenceNumber s = static_cast<SequenceNumber>(i * kNumThreads + t + 1);
+        ASSERT_TRUE(indexed_mem->Add(s, kTypeValue,
+                                     "key" + ToString(i % kNumKeys),
+                                     ToString(s), true,
+                                     &thread_post_process_info));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int k = 0; k < kNumKeys; k++) {
+    SequenceNumber newest =
+        (kOpsPerThread - kNumKeys + k) * kNumThreads + kNumThreads;
+    std::string value;
+    Status s;
+    MergeContext merge_context;
+    SequenceNumber max_covering_tombstone_seq = 0;
+    ASSERT_TRUE(indexed_mem->Get(LookupKey("key" + ToString(k),
+                                           kMaxSequenceNumber),
+                                 &value, &s, &merge_context,
+                                 &max_covering_tombstone_seq, roptions));
+    ASSERT_OK(s);
+    ASSERT_EQ(ToString(newest), value);
+  }
+  delete indexed_mem;
+}
+
+TEST_F(DBMemTableTest, BTreeRep) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.memtable_factory.reset(new BTreeRepFactory());
+  options.allow_concurrent_memtable_write = true;
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+
+  // Enough keys for the tree to grow a few levels, with several versions
+  // of each key in the memtable.
+  const int kNumKeys = 3000;
+  Random rnd(301);
+  std::map<std::string, std::string> model;
+  for (int i = 0; i < 4 * kNumKeys; i++) {
+    std::string key = Key(rnd.Uniform(kNumKeys));
+    switch (rnd.Uniform(3)) {
+      case 0:
+        ASSERT_OK(Put(key, "v" + ToString(i)));
+        model[key] = "v" + ToString(i);
+        break;
+      case 1:
+        ASSERT_OK(Merge(key, "m" + ToString(i)));
+        if (model.count(key) > 0) {
+          model[key] += ",m" + ToString(i);
+        } else {
+          model[key] = "m" + ToString(i);
+        }
+        break;
+      default:
+        ASSERT_OK(Delete(key));
+        model.erase(key);
+        break;
+    }
+  }
+
+  auto verify = [&]() {
+    for (int k = 0; k < kNumKeys; k++) {
+      std::string key = Key(k);
+      auto it = model.find(key);
+      ASSERT_EQ(it == model.end() ? "NOT_FOUND" : it->second, Get(key));
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    auto model_iter = model.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++model_iter) {
+      ASSERT_TRUE(model_iter != model.end());
+      ASSERT_EQ(model_iter->first, iter->key().ToString());
+      ASSERT_EQ(model_iter->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(model_iter == model.end());
+    auto model_riter = model.rbegin();
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++model_riter) {
+      ASSERT_TRUE(model_riter != model.rend());
+      ASSERT_EQ(model_riter->first, iter->key().ToString());
+    }
+    ASSERT_TRUE(model_riter == model.rend());
+  };
+  verify();
+  ASSERT_OK(Flush());
+  verify();
+}
+
 TEST_F(DBMemTableTest, InsertWithHint) {
   Options options;
   options.allow_concurrent_memtable_write = false;
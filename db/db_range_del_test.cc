@@ -5,6 +5,7 @@
 
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
+#include "rocksdb/perf_context.h"
 #include "test_util/testutil.h"
 #include "utilities/merge_operators.h"
 
@@ -831,6 +832,68 @@ TEST_F(DBRangeDelTest, IteratorIgnoresRangeDeletions) {
   db_->ReleaseSnapshot(snapshot);
 }
 
+TEST_F(DBRangeDelTest, IteratorSkipsCoveredKeysInBulk) {
+  const int kNum = 100, kRangeBegin = 10, kRangeEnd = 90;
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  Reopen(opts);
+
+  for (int i = 0; i < kNum; ++i) {
+    ASSERT_OK(Put(Key(i), "old"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(kRangeBegin), Key(kRangeEnd)));
+  // Newer keys inside the range, in L0 and in the memtable, must survive the
+  // jump over the covered keys of L1.
+  ASSERT_OK(Put(Key(30), "new"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(60), "new"));
+
+  std::vector<int> expected;
+  for (int i = 0; i < kNum; ++i) {
+    if (i < kRangeBegin || i >= kRangeEnd || i == 30 || i == 60) {
+      expected.push_back(i);
+    }
+  }
+
+  get_perf_context()->Reset();
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  size_t idx = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++idx) {
+    ASSERT_LT(idx, expected.size());
+    ASSERT_EQ(Key(expected[idx]), iter->key());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(expected.size(), idx);
+  ASSERT_EQ(
+      1, static_cast<int>(get_perf_context()->internal_range_del_reseek_count));
+  ASSERT_EQ(
+      1, static_cast<int>(get_perf_context()->internal_delete_skipped_count));
+
+  // Backward iteration still steps through the covered keys.
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    ASSERT_GT(idx, 0U);
+    ASSERT_EQ(Key(expected[--idx]), iter->key());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(0U, idx);
+
+  // An iterator over the snapshot does not see the tombstone.
+  ReadOptions read_opts;
+  read_opts.snapshot = snapshot;
+  iter.reset(db_->NewIterator(read_opts));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++i) {
+    ASSERT_EQ(Key(i), iter->key());
+  }
+  ASSERT_EQ(kNum, i);
+  iter.reset();
+  db_->ReleaseSnapshot(snapshot);
+}
+
 #ifndef ROCKSDB_UBSAN_RUN
 TEST_F(DBRangeDelTest, TailingIteratorRangeTombstoneUnsupported) {
   db_->Put(WriteOptions(), "key", "val");
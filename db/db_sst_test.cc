@@ -138,6 +138,48 @@ TEST_F(DBSSTTest, SkipCheckingSSTFileSizesOnDBOpen) {
   ASSERT_EQ("choo", Get("pika"));
 }
 
+TEST_F(DBSSTTest, SkipOpeningSSTFilesOnDBOpen) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_open_files = -1;
+  DestroyAndReopen(options);
+
+  const int kNumFiles = 5;
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  ASSERT_EQ(kNumFiles, TestGetTickerCount(options, NO_FILE_OPENS));
+
+  options.skip_opening_sst_files_on_db_open = true;
+  options.skip_stats_update_on_db_open = true;
+  options.statistics = CreateDBStatistics();
+  Reopen(options);
+  ASSERT_EQ(0, TestGetTickerCount(options, NO_FILE_OPENS));
+
+  // A file is opened on its first access only
+  ASSERT_EQ("v0", Get(Key(0)));
+  ASSERT_EQ(1, TestGetTickerCount(options, NO_FILE_OPENS));
+  ASSERT_EQ("v0", Get(Key(0)));
+  ASSERT_EQ(1, TestGetTickerCount(options, NO_FILE_OPENS));
+  for (int i = 0; i < kNumFiles; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  ASSERT_EQ(kNumFiles, TestGetTickerCount(options, NO_FILE_OPENS));
+
+  // Files written after open are opened as usual
+  ASSERT_OK(Put(Key(kNumFiles), "v"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(kNumFiles + 1, TestGetTickerCount(options, NO_FILE_OPENS));
+
+  options.compaction_style = kCompactionStyleFIFO;
+  options.ttl = 3600;
+  ASSERT_TRUE(TryReopen(options).IsNotSupported());
+}
+
 #ifndef ROCKSDB_LITE
 TEST_F(DBSSTTest, DontDeleteMovedFile) {
   // This test triggers move compaction and verifies that the file is not
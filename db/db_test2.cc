@@ -456,6 +456,158 @@ TEST_F(DBTest2, SharedWriteBufferLimitAcrossDB) {
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBTest2, SharedWriteBufferStopLimitAcrossDB) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  options.statistics = CreateDBStatistics();
+  options.write_buffer_size = 500000;  // this is never hit
+  options.max_write_buffer_number = 20;
+  options.delayed_write_rate = 64 << 20;
+  // Writes are delayed from 100000 bytes and stopped from 200000 bytes.
+  std::shared_ptr<WriteBufferManager> wbm(
+      new WriteBufferManager(100000, {}, 200000));
+  options.write_buffer_manager = wbm;
+  Reopen(options);
+
+  std::string dbname2 = test::PerThreadDBPath("db_shared_wb_db2");
+  ASSERT_OK(DestroyDB(dbname2, options));
+  DB* db2 = nullptr;
+  ASSERT_OK(DB::Open(options, dbname2, &db2));
+
+  // Block the flushes so that the memtables of db_ keep growing.
+  env_->SetBackgroundThreads(1, Env::HIGH);
+  test::SleepingBackgroundTask sleeping_task;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                 Env::Priority::HIGH);
+  sleeping_task.WaitUntilSleeping();
+
+  std::atomic<int> num_stopped_writers(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::DelayWrite:Wait",
+      [&](void* /*arg*/) { num_stopped_writers++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  auto wait_for_stopped_writers = [&](int n) {
+    while (num_stopped_writers.load() < n) {
+      env_->SleepForMicroseconds(1000);
+    }
+  };
+
+  // Fill the memtables of db_ until its writes stop.
+  WriteOptions wo;
+  wo.disableWAL = true;
+  const int kNumKeys = 30;
+  port::Thread filler([&]() {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), DummyString(10000), wo));
+    }
+  });
+  wait_for_stopped_writers(1);
+  ASSERT_TRUE(wbm->ShouldStopWrites());
+  ASSERT_GE(options.statistics->getTickerCount(
+                WRITE_BUFFER_MANAGER_DELAY_COUNT),
+            1U);
+
+  // Both DBs stop their writes.
+  WriteOptions no_slowdown = wo;
+  no_slowdown.no_slowdown = true;
+  ASSERT_TRUE(Put(Key(kNumKeys), "v", no_slowdown).IsIncomplete());
+  ASSERT_TRUE(db2->Put(no_slowdown, Key(kNumKeys), "v").IsIncomplete());
+  ASSERT_EQ(2U, options.statistics->getTickerCount(
+                    WRITE_BUFFER_MANAGER_STOP_COUNT));
+  std::string is_stopped;
+  ASSERT_TRUE(db2->GetProperty("rocksdb.is-write-stopped", &is_stopped));
+  ASSERT_EQ("1", is_stopped);
+
+  // The writes to both DBs resume once the flushes of db_ free the memory.
+  port::Thread writer(
+      [&]() { ASSERT_OK(db2->Put(wo, Key(kNumKeys), "v")); });
+  wait_for_stopped_writers(2);
+  sleeping_task.WakeUp();
+  writer.join();
+  filler.join();
+  sleeping_task.WaitUntilDone();
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(options.statistics->getTickerCount(
+                WRITE_BUFFER_MANAGER_STALL_MICROS),
+            0U);
+
+  ASSERT_TRUE(db2->GetProperty("rocksdb.is-write-stopped", &is_stopped));
+  ASSERT_EQ("0", is_stopped);
+  std::string value;
+  ASSERT_OK(db2->Get(ReadOptions(), Key(kNumKeys), &value));
+  ASSERT_EQ("v", value);
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options));
+}
+
+TEST_F(DBTest2, SharedWriteBufferStopLimitHeldByIdleDB) {
+  Options options = CurrentOptions();
+  options.arena_block_size = 4096;
+  options.statistics = CreateDBStatistics();
+  options.write_buffer_size = 500000;  // this is never hit
+  options.max_write_buffer_number = 20;
+  options.delayed_write_rate = 64 << 20;
+  // Writes are delayed from 100000 bytes and stopped from 200000 bytes.
+  std::shared_ptr<WriteBufferManager> wbm(
+      new WriteBufferManager(100000, {}, 200000));
+  options.write_buffer_manager = wbm;
+  Reopen(options);
+
+  // db2 keeps its flushed memtables, so that it holds most of the memory
+  // after it stops writing.
+  Options options2 = options;
+  options2.max_write_buffer_size_to_maintain = 1 << 20;
+  std::string dbname2 = test::PerThreadDBPath("db_shared_wb_db2");
+  ASSERT_OK(DestroyDB(dbname2, options2));
+  DB* db2 = nullptr;
+  ASSERT_OK(DB::Open(options2, dbname2, &db2));
+  WriteOptions wo;
+  wo.disableWAL = true;
+  for (int i = 0; wbm->memory_usage() < 160000; i++) {
+    ASSERT_OK(db2->Put(wo, Key(i), DummyString(10000)));
+  }
+  ASSERT_OK(db2->Flush(FlushOptions()));
+  ASSERT_FALSE(wbm->ShouldStopWrites());
+  ASSERT_FALSE(wbm->ShouldFlush());
+
+  // The writes to db_ stop with less than half of buffer_size in its
+  // memtables, so they never ask it to flush. db_ flushes them itself while
+  // it is stopped, which frees enough memory to resume.
+  WriteOptions no_slowdown = wo;
+  no_slowdown.no_slowdown = true;
+  std::atomic<int> num_stopped_writers(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::DelayWrite:Wait", [&](void* /*arg*/) {
+        if (num_stopped_writers++ == 0) {
+          ASSERT_TRUE(wbm->ShouldStopWrites());
+          ASSERT_TRUE(db2->Put(no_slowdown, "foo", "v").IsIncomplete());
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  const int kNumKeys = 10;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), DummyString(10000), wo));
+  }
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GE(num_stopped_writers.load(), 1);
+  ASSERT_GE(options.statistics->getTickerCount(
+                WRITE_BUFFER_MANAGER_STOP_COUNT),
+            2U);
+  ASSERT_OK(dbfull()->TEST_WaitForFlushMemTable());
+  ASSERT_FALSE(wbm->ShouldStopWrites());
+
+  // db2 has not written since it was stopped, and it is no longer.
+  std::string is_stopped;
+  ASSERT_TRUE(db2->GetProperty("rocksdb.is-write-stopped", &is_stopped));
+  ASSERT_EQ("0", is_stopped);
+
+  delete db2;
+  ASSERT_OK(DestroyDB(dbname2, options2));
+}
+
 TEST_F(DBTest2, TestWriteBufferNoLimitWithCache) {
   Options options = CurrentOptions();
   options.arena_block_size = 4096;
@@ -647,6 +647,109 @@ class TestPutOperator : public MergeOperator {
   virtual const char* Name() const override { return "TestPutOperator"; }
 };
 
+// A FileSystem that leaves the reads issued by ReadAsync() outstanding
+// until they are polled, and then completes them in reverse order. Its files
+// report whether they support asynchronous reads as told. Poll() fails while
+// fail_poll_ is set, and AbortIO() then completes the reads as cancelled.
+class DeferredReadFileSystem : public FileSystemWrapper {
+ public:
+  struct DeferredRead {
+    FSRandomAccessFile* file;
+    FSReadRequest req;
+    std::function<void(const FSReadRequest&, void*)> cb;
+    void* cb_arg;
+    bool done;
+  };
+
+  class DeferredReadFile : public FSRandomAccessFileWrapper {
+   public:
+    DeferredReadFile(std::unique_ptr<FSRandomAccessFile>&& target,
+                     DeferredReadFileSystem* fs)
+        : FSRandomAccessFileWrapper(target.get()),
+          target_(std::move(target)),
+          fs_(fs) {}
+
+    IOStatus ReadAsync(FSReadRequest& req, const IOOptions& /*opts*/,
+                       std::function<void(const FSReadRequest&, void*)> cb,
+                       void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                       IODebugContext* /*dbg*/) override {
+      *io_handle = new DeferredRead{target_.get(), req, cb, cb_arg, false};
+      *del_fn = [](void* h) { delete static_cast<DeferredRead*>(h); };
+      fs_->num_async_reads_++;
+      return IOStatus::OK();
+    }
+
+    bool SupportsAsyncRead() const override {
+      return fs_->supports_async_read_;
+    }
+
+   private:
+    std::unique_ptr<FSRandomAccessFile> target_;
+    DeferredReadFileSystem* fs_;
+  };
+
+  explicit DeferredReadFileSystem(const std::shared_ptr<FileSystem>& target,
+                                  bool supports_async_read = true)
+      : FileSystemWrapper(target.get()),
+        supports_async_read_(supports_async_read),
+        target_(target) {}
+
+  const char* Name() const override { return "DeferredReadFileSystem"; }
+
+  IOStatus NewRandomAccessFile(const std::string& fname,
+                               const FileOptions& file_opts,
+                               std::unique_ptr<FSRandomAccessFile>* result,
+                               IODebugContext* dbg) override {
+    std::unique_ptr<FSRandomAccessFile> file;
+    IOStatus s = target()->NewRandomAccessFile(fname, file_opts, &file, dbg);
+    if (s.ok()) {
+      result->reset(new DeferredReadFile(std::move(file), this));
+    }
+    return s;
+  }
+
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t /*min_completions*/) override {
+    if (fail_poll_) {
+      return IOStatus::IOError("Injected poll failure");
+    }
+    for (auto iter = io_handles.rbegin(); iter != io_handles.rend(); ++iter) {
+      DeferredRead* read = static_cast<DeferredRead*>(*iter);
+      if (!read->done) {
+        FSReadRequest& req = read->req;
+        req.status = read->file->Read(req.offset, req.len, IOOptions(),
+                                      &req.result, req.scratch, nullptr);
+        read->done = true;
+        read->cb(req, read->cb_arg);
+      }
+    }
+    num_polls_++;
+    return IOStatus::OK();
+  }
+
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    for (void* handle : io_handles) {
+      DeferredRead* read = static_cast<DeferredRead*>(handle);
+      if (!read->done) {
+        read->req.status = IOStatus::IOError("Read cancelled");
+        read->done = true;
+        read->cb(read->req, read->cb_arg);
+        num_aborted_reads_++;
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  const bool supports_async_read_;
+  std::atomic<bool> fail_poll_{false};
+  std::atomic<int> num_async_reads_{0};
+  std::atomic<int> num_polls_{0};
+  std::atomic<int> num_aborted_reads_{0};
+
+ private:
+  std::shared_ptr<FileSystem> target_;
+};
+
 class DBTestBase : public testing::Test {
  public:
   // Sequence of option configurations to try
@@ -2238,6 +2238,47 @@ TEST_F(DBTestUniversalCompaction2, PeriodicCompaction) {
   ASSERT_EQ(4, output_level);
 }
 
+TEST_F(DBTestUniversalCompaction2, SubcompactionsSplitOverlappingFiles) {
+  const int kNumFiles = 4;
+  const int kKeysPerFile = 1000;
+  Options opts = CurrentOptions();
+  opts.compaction_style = kCompactionStyleUniversal;
+  opts.num_levels = 4;
+  opts.max_subcompactions = 4;
+  opts.disable_auto_compactions = true;
+  opts.target_file_size_base = 64 << 10;
+  opts.compression = kNoCompression;
+  opts.statistics = CreateDBStatistics();
+  Reopen(opts);
+
+  // Every file spans the whole key space, so the file boundaries alone would
+  // put nearly all of the data into a single subcompaction.
+  Random rnd(301);
+  for (int i = 0; i < kNumFiles; ++i) {
+    for (int j = 0; j < kKeysPerFile; ++j) {
+      ASSERT_OK(Put(Key(j * kNumFiles + i), RandomString(&rnd, 100)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(0));
+
+  ASSERT_OK(dbfull()->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  HistogramData num_subcompactions;
+  opts.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                 &num_subcompactions);
+  ASSERT_EQ(opts.max_subcompactions, num_subcompactions.max);
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(count), iter->key());
+    ++count;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumFiles * kKeysPerFile, count);
+}
+
 }  // namespace rocksdb
 
 #endif  // !defined(ROCKSDB_LITE)
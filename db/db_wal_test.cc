@@ -570,6 +570,113 @@ TEST_F(DBWALTest, GetSortedWalFiles) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, RecoverCompressedWAL) {
+  for (CompressionType type : {kZlibCompression, kZSTD}) {
+    Options options = CurrentOptions();
+    options.wal_compression = type;
+    if (!StreamingCompressionTypeSupported(type)) {
+      ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+      continue;
+    }
+    DestroyAndReopen(options);
+    const std::string value(1000, 'v');
+    for (int i = 0; i < 100; i++) {
+      ASSERT_OK(Put(Key(i), value));
+    }
+    VectorLogPtr wal_files;
+    ASSERT_OK(dbfull()->GetSortedWalFiles(wal_files));
+    ASSERT_EQ(1U, wal_files.size());
+    ASSERT_LT(wal_files[0]->SizeFileBytes(), 100 * value.size() / 10);
+
+    // The WAL records its compression type, so it can be recovered with
+    // any wal_compression.
+    options.wal_compression = kNoCompression;
+    Reopen(options);
+    for (int i = 0; i < 100; i++) {
+      ASSERT_EQ(value, Get(Key(i)));
+    }
+    ASSERT_OK(Put(Key(100), "uncompressed"));
+    options.wal_compression = type;
+    Reopen(options);
+    ASSERT_EQ(value, Get(Key(99)));
+    ASSERT_EQ("uncompressed", Get(Key(100)));
+  }
+}
+
+TEST_F(DBWALTest, RecoverWithWalRecoveryThreads) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+
+  // Overwrite, delete and merge the same keys, in batches that span the
+  // column families, so that the batches must keep their sequence numbers.
+  std::map<std::string, std::string> expected[3];
+  auto write_data = [&]() {
+    for (auto& cf_expected : expected) {
+      cf_expected.clear();
+    }
+    Random rnd(301);
+    for (int i = 0; i < 2000; i++) {
+      WriteBatch batch;
+      for (int j = 0; j < 5; j++) {
+        const int cf = rnd.Uniform(3);
+        const std::string key = Key(rnd.Uniform(300));
+        const std::string value = RandomString(&rnd, 100);
+        if (i % 100 == 0) {
+          ASSERT_OK(batch.Merge(handles_[cf], key, value));
+          auto it = expected[cf].find(key);
+          if (it == expected[cf].end()) {
+            expected[cf][key] = value;
+          } else {
+            it->second += "," + value;
+          }
+        } else if (j == 4) {
+          ASSERT_OK(batch.Delete(handles_[cf], key));
+          expected[cf].erase(key);
+        } else {
+          ASSERT_OK(batch.Put(handles_[cf], key, value));
+          expected[cf][key] = value;
+        }
+      }
+      ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+    }
+  };
+
+  for (size_t threads : {2, 4}) {
+    options.write_buffer_size = CurrentOptions().write_buffer_size;
+    DestroyAndReopen(options);
+    CreateAndReopenWithCF({"one", "two"}, options);
+    write_data();
+
+    size_t max_concurrent_batches = 0;
+    SyncPoint::GetInstance()->SetCallBack(
+        "DBImpl::InsertRecoveredBatches:NumBatches", [&](void* arg) {
+          max_concurrent_batches = std::max(max_concurrent_batches,
+                                            *static_cast<size_t*>(arg));
+        });
+    SyncPoint::GetInstance()->EnableProcessing();
+    // Small memtables make recovery flush several times.
+    options.write_buffer_size = 64 << 10;
+    options.wal_recovery_threads = threads;
+    ReopenWithColumnFamilies({"default", "one", "two"}, options);
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+    if (threads > 2) {
+      ASSERT_GT(max_concurrent_batches, 1U);
+    } else {
+      ASSERT_EQ(0U, max_concurrent_batches);
+    }
+    ASSERT_GT(NumTableFilesAtLevel(0, 1), 1);
+
+    for (int cf = 0; cf < 3; cf++) {
+      for (int k = 0; k < 300; k++) {
+        auto it = expected[cf].find(Key(k));
+        ASSERT_EQ(it == expected[cf].end() ? "NOT_FOUND" : it->second,
+                  Get(cf, Key(k)));
+      }
+    }
+  }
+}
+
 TEST_F(DBWALTest, GetCurrentWalFile) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -1150,6 +1257,39 @@ TEST_F(DBWALTest, kPointInTimeRecovery) {
   }
 }
 
+// Test scope:
+// - We expect recovery with wal_recovery_threads to stop, or fail, at the
+//   same records as serial recovery
+TEST_F(DBWALTest, CorruptedWALWithWalRecoveryThreads) {
+  const int j = RecoveryTestHelper::kWALFileOffset + 4;
+  for (auto mode : {WALRecoveryMode::kTolerateCorruptedTailRecords,
+                    WALRecoveryMode::kAbsoluteConsistency,
+                    WALRecoveryMode::kPointInTimeRecovery,
+                    WALRecoveryMode::kSkipAnyCorruptedRecords}) {
+    for (auto trunc : {true, false}) { /* Corruption style */
+      for (int i = 0; i < 4; i++) {    /* Offset of corruption */
+        bool opened[2];
+        size_t recovered_row_count[2] = {0, 0};
+        for (int k = 0; k < 2; k++) {
+          Options options = CurrentOptions();
+          RecoveryTestHelper::FillData(this, &options);
+          RecoveryTestHelper::CorruptWAL(this, options, /*off=*/i * .3,
+                                         /*len%=*/.1, j, trunc);
+          options.wal_recovery_mode = mode;
+          options.wal_recovery_threads = k == 0 ? 1 : 4;
+          options.create_if_missing = false;
+          opened[k] = TryReopen(options).ok();
+          if (opened[k]) {
+            recovered_row_count[k] = RecoveryTestHelper::GetData(this);
+          }
+        }
+        ASSERT_EQ(opened[0], opened[1]);
+        ASSERT_EQ(recovered_row_count[0], recovered_row_count[1]);
+      }
+    }
+  }
+}
+
 // Test scope:
 // - We expect to open the data store under all scenarios
 // - We expect to have recovered records past the corruption zone
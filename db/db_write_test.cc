@@ -312,6 +312,58 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
     ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, ParallelBatchInsert) {
+  Options options = GetOptions();
+  options.max_memtable_insert_threads_per_batch = 4;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  size_t num_chunks = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::InsertBatchInParallel:NumChunks", [&](void* arg) {
+        num_chunks = static_cast<std::vector<WriteBatchChunk>*>(arg)->size();
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Overwrites and deletes of keys in the same batch must land in other
+  // chunks than the records they shadow.
+  const int kNumKeys = 4000;
+  WriteBatch batch;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(batch.Put(handles_[i % 2], Key(i), "v1_" + ToString(i)));
+  }
+  for (int i = 0; i < kNumKeys; i += 3) {
+    ASSERT_OK(batch.Put(handles_[i % 2], Key(i), "v2_" + ToString(i)));
+  }
+  for (int i = 0; i < kNumKeys; i += 5) {
+    ASSERT_OK(batch.Delete(handles_[i % 2], Key(i)));
+  }
+  ASSERT_OK(batch.PutLogData("log data"));
+  const SequenceNumber seq_before = dbfull()->GetLatestSequenceNumber();
+  ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  ASSERT_EQ(4, num_chunks);
+  ASSERT_EQ(seq_before + WriteBatchInternal::Count(&batch),
+            dbfull()->GetLatestSequenceNumber());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  auto verify = [&]() {
+    for (int i = 0; i < kNumKeys; i++) {
+      std::string expected = "v1_" + ToString(i);
+      if (i % 5 == 0) {
+        expected = "NOT_FOUND";
+      } else if (i % 3 == 0) {
+        expected = "v2_" + ToString(i);
+      }
+      ASSERT_EQ(expected, Get(i % 2, Key(i)));
+    }
+  };
+  verify();
+
+  // Recovery from the WAL inserts the batch serially with the same result.
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  verify();
+}
+
 INSTANTIATE_TEST_CASE_P(DBWriteTestInstance, DBWriteTest,
                         testing::Values(DBTestBase::kDefault,
                                         DBTestBase::kConcurrentWALWrites,
@@ -253,6 +253,12 @@ static const std::string num_running_flushes = "num-running-flushes";
 static const std::string actual_delayed_write_rate =
     "actual-delayed-write-rate";
 static const std::string is_write_stopped = "is-write-stopped";
+static const std::string secondary_seconds_since_catch_up =
+    "secondary-seconds-since-catch-up";
+static const std::string secondary_replayed_wal_bytes =
+    "secondary-replayed-wal-bytes";
+static const std::string secondary_wal_dir_listings =
+    "secondary-wal-dir-listings";
 static const std::string estimate_oldest_key_time = "estimate-oldest-key-time";
 static const std::string block_cache_capacity = "block-cache-capacity";
 static const std::string block_cache_usage = "block-cache-usage";
@@ -337,6 +343,12 @@ const std::string DB::Properties::kActualDelayedWriteRate =
     rocksdb_prefix + actual_delayed_write_rate;
 const std::string DB::Properties::kIsWriteStopped =
     rocksdb_prefix + is_write_stopped;
+const std::string DB::Properties::kSecondarySecondsSinceCatchUp =
+    rocksdb_prefix + secondary_seconds_since_catch_up;
+const std::string DB::Properties::kSecondaryReplayedWalBytes =
+    rocksdb_prefix + secondary_replayed_wal_bytes;
+const std::string DB::Properties::kSecondaryWalDirListings =
+    rocksdb_prefix + secondary_wal_dir_listings;
 const std::string DB::Properties::kEstimateOldestKeyTime =
     rocksdb_prefix + estimate_oldest_key_time;
 const std::string DB::Properties::kBlockCacheCapacity =
@@ -471,6 +483,15 @@ const std::unordered_map<std::string, DBPropertyInfo>
         {DB::Properties::kIsWriteStopped,
          {false, nullptr, &InternalStats::HandleIsWriteStopped, nullptr,
           nullptr}},
+        {DB::Properties::kSecondarySecondsSinceCatchUp,
+         {false, nullptr, &InternalStats::HandleSecondarySecondsSinceCatchUp,
+          nullptr, nullptr}},
+        {DB::Properties::kSecondaryReplayedWalBytes,
+         {false, nullptr, &InternalStats::HandleSecondaryReplayedWalBytes,
+          nullptr, nullptr}},
+        {DB::Properties::kSecondaryWalDirListings,
+         {false, nullptr, &InternalStats::HandleSecondaryWalDirListings,
+          nullptr, nullptr}},
         {DB::Properties::kEstimateOldestKeyTime,
          {false, nullptr, &InternalStats::HandleEstimateOldestKeyTime, nullptr,
           nullptr}},
@@ -858,6 +879,7 @@ bool InternalStats::HandleMinObsoleteSstNumberToKeep(uint64_t* value,
 
 bool InternalStats::HandleActualDelayedWriteRate(uint64_t* value, DBImpl* db,
                                                  Version* /*version*/) {
+  db->UpdateWriteBufferManagerStall();
   const WriteController& wc = db->write_controller();
   if (!wc.NeedsDelay()) {
     *value = 0;
@@ -869,10 +891,46 @@ bool InternalStats::HandleActualDelayedWriteRate(uint64_t* value, DBImpl* db,
 
 bool InternalStats::HandleIsWriteStopped(uint64_t* value, DBImpl* db,
                                          Version* /*version*/) {
+  db->UpdateWriteBufferManagerStall();
   *value = db->write_controller().IsStopped() ? 1 : 0;
   return true;
 }
 
+bool InternalStats::HandleSecondarySecondsSinceCatchUp(uint64_t* value,
+                                                       DBImpl* db,
+                                                       Version* /*version*/) {
+  DBImpl::SecondaryCatchUpStats stats;
+  if (!db->GetSecondaryCatchUpStats(&stats)) {
+    return false;
+  }
+  uint64_t now_micros = db->GetEnv()->NowMicros();
+  *value = now_micros > stats.last_catch_up_micros
+               ? (now_micros - stats.last_catch_up_micros) / 1000000
+               : 0;
+  return true;
+}
+
+bool InternalStats::HandleSecondaryReplayedWalBytes(uint64_t* value,
+                                                    DBImpl* db,
+                                                    Version* /*version*/) {
+  DBImpl::SecondaryCatchUpStats stats;
+  if (!db->GetSecondaryCatchUpStats(&stats)) {
+    return false;
+  }
+  *value = stats.replayed_wal_bytes;
+  return true;
+}
+
+bool InternalStats::HandleSecondaryWalDirListings(uint64_t* value, DBImpl* db,
+                                                  Version* /*version*/) {
+  DBImpl::SecondaryCatchUpStats stats;
+  if (!db->GetSecondaryCatchUpStats(&stats)) {
+    return false;
+  }
+  *value = stats.wal_dir_listings;
+  return true;
+}
+
 bool InternalStats::HandleEstimateOldestKeyTime(uint64_t* value, DBImpl* /*db*/,
                                                 Version* /*version*/) {
   // TODO(yiwu): The property is currently available for fifo compaction
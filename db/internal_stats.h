@@ -575,6 +575,12 @@ class InternalStats {
   bool HandleActualDelayedWriteRate(uint64_t* value, DBImpl* db,
                                     Version* version);
   bool HandleIsWriteStopped(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleSecondarySecondsSinceCatchUp(uint64_t* value, DBImpl* db,
+                                          Version* version);
+  bool HandleSecondaryReplayedWalBytes(uint64_t* value, DBImpl* db,
+                                       Version* version);
+  bool HandleSecondaryWalDirListings(uint64_t* value, DBImpl* db,
+                                     Version* version);
   bool HandleEstimateOldestKeyTime(uint64_t* value, DBImpl* db,
                                    Version* version);
   bool HandleBlockCacheCapacity(uint64_t* value, DBImpl* db, Version* version);
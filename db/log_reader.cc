@@ -14,6 +14,7 @@
 #include "rocksdb/env.h"
 #include "test_util/sync_point.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/util.h"
 
@@ -38,7 +39,9 @@ Reader::Reader(std::shared_ptr<Logger> info_log,
       last_record_offset_(0),
       end_of_buffer_offset_(0),
       log_number_(log_num),
-      recycled_(false) {}
+      recycled_(false),
+      first_record_offset_(0),
+      compression_type_(kNoCompression) {}
 
 Reader::~Reader() {
   delete[] backing_store_;
@@ -78,6 +81,10 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         prospective_record_offset = physical_record_offset;
         scratch->clear();
         *record = fragment;
+        if (!MaybeUncompressRecord(record)) {
+          in_fragmented_record = false;
+          break;
+        }
         last_record_offset_ = prospective_record_offset;
         return true;
 
@@ -113,11 +120,20 @@ bool Reader::ReadRecord(Slice* record, std::string* scratch,
         } else {
           scratch->append(fragment.data(), fragment.size());
           *record = Slice(*scratch);
+          if (!MaybeUncompressRecord(record)) {
+            in_fragmented_record = false;
+            scratch->clear();
+            break;
+          }
           last_record_offset_ = prospective_record_offset;
           return true;
         }
         break;
 
+      case kSetCompressionType:
+        InitCompression(fragment);
+        break;
+
       case kBadHeader:
         if (wal_recovery_mode == WALRecoveryMode::kAbsoluteConsistency) {
           // in clean shutdown we don't expect any error in the log files
@@ -270,7 +286,42 @@ void Reader::ReportCorruption(size_t bytes, const char* reason) {
   ReportDrop(bytes, Status::Corruption(reason));
 }
 
+void Reader::InitCompression(const Slice& payload) {
+  if (compression_type_ != kNoCompression || payload.size() != 1 ||
+      payload[0] == kNoCompression) {
+    ReportCorruption(payload.size(), "unexpected compression type record");
+    return;
+  }
+  compression_type_ = static_cast<CompressionType>(payload[0]);
+  // Whether the log is recycled is told by its first record after this one.
+  first_record_offset_ = end_of_buffer_offset_ - buffer_.size();
+  uncompress_ = NewStreamingUncompress(compression_type_);
+  if (uncompress_ == nullptr) {
+    ReportDrop(payload.size(), Status::NotSupported(
+                                   "WAL compression type not supported",
+                                   CompressionTypeToString(compression_type_)));
+  }
+}
+
+bool Reader::MaybeUncompressRecord(Slice* record) {
+  if (compression_type_ == kNoCompression) {
+    return true;
+  }
+  uncompressed_record_.clear();
+  if (uncompress_ == nullptr ||
+      !uncompress_->Uncompress(*record, &uncompressed_record_)) {
+    ReportCorruption(record->size(), "failed to uncompress record");
+    return false;
+  }
+  *record = Slice(uncompressed_record_);
+  return true;
+}
+
 void Reader::ReportDrop(size_t bytes, const Status& reason) {
+  if (bytes > 0) {
+    // The records that follow dropped data cannot be uncompressed.
+    uncompress_.reset();
+  }
   if (reporter_ != nullptr) {
     reporter_->Corruption(bytes, reason);
   }
@@ -332,7 +383,7 @@ unsigned int Reader::ReadPhysicalRecord(Slice* result, size_t* drop_size) {
     const uint32_t length = a | (b << 8);
     int header_size = kHeaderSize;
     if (type >= kRecyclableFullType && type <= kRecyclableLastType) {
-      if (end_of_buffer_offset_ - buffer_.size() == 0) {
+      if (end_of_buffer_offset_ - buffer_.size() == first_record_offset_) {
         recycled_ = true;
       }
       header_size = kRecyclableHeaderSize;
@@ -417,9 +468,12 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
         }
         fragments_.clear();
         *record = fragment;
+        in_fragmented_record_ = false;
+        if (!MaybeUncompressRecord(record)) {
+          break;
+        }
         prospective_record_offset = physical_record_offset;
         last_record_offset_ = prospective_record_offset;
-        in_fragmented_record_ = false;
         return true;
 
       case kFirstType:
@@ -452,12 +506,20 @@ bool FragmentBufferedReader::ReadRecord(Slice* record, std::string* scratch,
           scratch->assign(fragments_.data(), fragments_.size());
           fragments_.clear();
           *record = Slice(*scratch);
-          last_record_offset_ = prospective_record_offset;
           in_fragmented_record_ = false;
+          if (!MaybeUncompressRecord(record)) {
+            scratch->clear();
+            break;
+          }
+          last_record_offset_ = prospective_record_offset;
           return true;
         }
         break;
 
+      case kSetCompressionType:
+        InitCompression(fragment);
+        break;
+
       case kBadHeader:
       case kBadRecord:
       case kEof:
@@ -564,7 +626,7 @@ bool FragmentBufferedReader::TryReadFragment(
   const uint32_t length = a | (b << 8);
   int header_size = kHeaderSize;
   if (type >= kRecyclableFullType && type <= kRecyclableLastType) {
-    if (end_of_buffer_offset_ - buffer_.size() == 0) {
+    if (end_of_buffer_offset_ - buffer_.size() == first_record_offset_) {
       recycled_ = true;
     }
     header_size = kRecyclableHeaderSize;
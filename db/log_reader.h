@@ -10,6 +10,7 @@
 #pragma once
 #include <memory>
 #include <stdint.h>
+#include <string>
 
 #include "db/log_format.h"
 #include "file/sequence_file_reader.h"
@@ -19,6 +20,7 @@
 
 namespace rocksdb {
 class Logger;
+class StreamingUncompress;
 
 namespace log {
 
@@ -123,6 +125,17 @@ class Reader {
 
   // Whether this is a recycled log file
   bool recycled_;
+  // Offset of the first record of the file that is not a kSetCompressionType
+  // record
+  uint64_t first_record_offset_;
+
+  // Compression of the records of a compressed log, as set by its
+  // kSetCompressionType record. uncompress_ is reset when data is dropped,
+  // since the records that follow cannot be uncompressed without it.
+  CompressionType compression_type_;
+  std::unique_ptr<StreamingUncompress> uncompress_;
+  // Uncompressed form of the last record returned by ReadRecord
+  std::string uncompressed_record_;
 
   // Extend record types with the following special values
   enum {
@@ -150,6 +163,14 @@ class Reader {
 
   void UnmarkEOFInternal();
 
+  // Sets up the uncompression of the records that follow a
+  // kSetCompressionType record with the given payload.
+  void InitCompression(const Slice& payload);
+
+  // Uncompresses *record in place if the log is compressed. Returns false,
+  // after reporting a corruption, if it cannot be uncompressed.
+  bool MaybeUncompressRecord(Slice* record);
+
   // Reports dropped bytes to the reporter.
   // buffer_ must be updated to remove the dropped bytes prior to invocation.
   void ReportCorruption(size_t bytes, const char* reason);
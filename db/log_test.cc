@@ -16,6 +16,7 @@
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/random.h"
 
@@ -45,10 +46,12 @@ static std::string RandomSkewedString(int i, Random* rnd) {
   return BigString(NumberString(i), rnd->Skewed(17));
 }
 
-// Param type is tuple<int, bool>
+// Param type is tuple<int, bool, CompressionType>
 // get<0>(tuple): non-zero if recycling log, zero if regular log
 // get<1>(tuple): true if allow retry after read EOF, false otherwise
-class LogTest : public ::testing::TestWithParam<std::tuple<int, bool>> {
+// get<2>(tuple): compression type of the log
+class LogTest
+    : public ::testing::TestWithParam<std::tuple<int, bool, CompressionType>> {
  private:
   class StringSource : public SequentialFile {
    public:
@@ -176,8 +179,12 @@ class LogTest : public ::testing::TestWithParam<std::tuple<int, bool>> {
         source_holder_(test::GetSequentialFileReader(
             new StringSource(reader_contents_, !std::get<1>(GetParam())),
             "" /* file name */)),
-        writer_(std::move(dest_holder_), 123, std::get<0>(GetParam())),
+        writer_(std::move(dest_holder_), 123, std::get<0>(GetParam()),
+                false /* manual_flush */, std::get<2>(GetParam())),
         allow_retry_read_(std::get<1>(GetParam())) {
+    if (std::get<2>(GetParam()) != kNoCompression) {
+      writer_.AddCompressionTypeRecord();
+    }
     if (allow_retry_read_) {
       reader_.reset(new FragmentBufferedReader(
           nullptr, std::move(source_holder_), &report_, true /* checksum */,
@@ -699,11 +706,155 @@ TEST_P(LogTest, Recycle) {
   ASSERT_EQ("EOF", Read());
 }
 
-INSTANTIATE_TEST_CASE_P(bool, LogTest,
-                        ::testing::Values(std::make_tuple(0, false),
-                                          std::make_tuple(0, true),
-                                          std::make_tuple(1, false),
-                                          std::make_tuple(1, true)));
+INSTANTIATE_TEST_CASE_P(
+    bool, LogTest,
+    ::testing::Values(std::make_tuple(0, false, kNoCompression),
+                      std::make_tuple(0, true, kNoCompression),
+                      std::make_tuple(1, false, kNoCompression),
+                      std::make_tuple(1, true, kNoCompression)));
+
+class CompressionLogTest : public LogTest {
+ public:
+  bool Supported() const {
+    return StreamingCompressionTypeSupported(std::get<2>(GetParam()));
+  }
+};
+
+TEST_P(CompressionLogTest, Empty) {
+  if (!Supported()) {
+    return;
+  }
+  ASSERT_EQ(kHeaderSize + 1U, WrittenBytes());
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_P(CompressionLogTest, ReadWrite) {
+  if (!Supported()) {
+    return;
+  }
+  Write("foo");
+  Write("bar");
+  Write("");
+  Write("xxxx");
+  ASSERT_EQ("foo", Read());
+  ASSERT_EQ("bar", Read());
+  ASSERT_EQ("", Read());
+  ASSERT_EQ("xxxx", Read());
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ("EOF", Read());  // Make sure reads at eof work
+}
+
+TEST_P(CompressionLogTest, ManyBlocks) {
+  if (!Supported()) {
+    return;
+  }
+  for (int i = 0; i < 100000; i++) {
+    Write(NumberString(i));
+  }
+  for (int i = 0; i < 100000; i++) {
+    ASSERT_EQ(NumberString(i), Read());
+  }
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_P(CompressionLogTest, Fragmentation) {
+  if (!Supported()) {
+    return;
+  }
+  Random rnd(301);
+  // Incompressible, so that the records still span several blocks.
+  std::string medium;
+  std::string large;
+  test::RandomString(&rnd, 50000, &medium);
+  test::RandomString(&rnd, 100000, &large);
+  Write("small");
+  Write(medium);
+  Write(large);
+  ASSERT_EQ("small", Read());
+  ASSERT_EQ(medium, Read());
+  ASSERT_EQ(large, Read());
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_P(CompressionLogTest, CompressesAcrossRecords) {
+  if (!Supported()) {
+    return;
+  }
+  // Each record is too small to compress on its own, but repeats the
+  // previous ones.
+  const std::string record = "{\"key\": \"user1234\", \"value\": 42}";
+  for (int i = 0; i < 1000; i++) {
+    Write(record);
+  }
+  const size_t header_size =
+      std::get<0>(GetParam()) ? kRecyclableHeaderSize : kHeaderSize;
+  ASSERT_LT(WrittenBytes(), 1000 * (header_size + record.size()) / 2);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(record, Read());
+  }
+  ASSERT_EQ("EOF", Read());
+}
+
+TEST_P(CompressionLogTest, CorruptionStopsUncompression) {
+  if (!Supported()) {
+    return;
+  }
+  int header_size =
+      std::get<0>(GetParam()) ? kRecyclableHeaderSize : kHeaderSize;
+  Write("foo");
+  size_t second_record_offset = WrittenBytes();
+  Write("bar");
+  size_t third_record_offset = WrittenBytes();
+  Write("baz");
+  Write("qux");
+  // Break the payload of "bar" but keep its checksum valid, so that only
+  // uncompression can fail. 0xff starts a block of a reserved type in both
+  // the zlib and ZSTD formats.
+  int payload_size = static_cast<int>(third_record_offset -
+                                      second_record_offset - header_size);
+  for (int i = 0; i < payload_size; i++) {
+    SetByte(static_cast<int>(second_record_offset) + header_size + i, '\xff');
+  }
+  FixChecksum(static_cast<int>(second_record_offset), payload_size,
+              std::get<0>(GetParam()) != 0);
+
+  ASSERT_EQ("foo", Read());
+  // The records after the corruption cannot be uncompressed either.
+  ASSERT_EQ("EOF", Read(WALRecoveryMode::kSkipAnyCorruptedRecords));
+  ASSERT_GT(DroppedBytes(), 0U);
+  ASSERT_EQ("OK", MatchError("failed to uncompress record"));
+}
+
+TEST_P(CompressionLogTest, RecycledLog) {
+  if (!Supported() || std::get<0>(GetParam()) == 0) {
+    return;  // test is only valid for recycled logs
+  }
+  Write("foo");
+  Write("bar");
+  Write("baz");
+  while (get_reader_contents()->size() < log::kBlockSize * 2) {
+    Write("xxxxxxxxxxxxxxxx");
+  }
+  std::unique_ptr<WritableFileWriter> dest_holder(test::GetWritableFileWriter(
+      new test::OverwritingStringSink(get_reader_contents()),
+      "" /* don't care */));
+  Writer recycle_writer(std::move(dest_holder), 123, true,
+                        false /* manual_flush */, std::get<2>(GetParam()));
+  ASSERT_OK(recycle_writer.AddCompressionTypeRecord());
+  recycle_writer.AddRecord(Slice("foooo"));
+  recycle_writer.AddRecord(Slice("bar"));
+  ASSERT_GE(get_reader_contents()->size(), log::kBlockSize * 2);
+  ASSERT_EQ("foooo", Read());
+  ASSERT_EQ("bar", Read());
+  // The old records that follow are not reported as corruptions.
+  ASSERT_EQ("EOF", Read());
+  ASSERT_EQ(0U, DroppedBytes());
+}
+
+INSTANTIATE_TEST_CASE_P(
+    Compression, CompressionLogTest,
+    ::testing::Combine(::testing::Values(0, 1), ::testing::Bool(),
+                       ::testing::Values(kZlibCompression, kZSTD)));
 
 class RetriableLogTest : public ::testing::TestWithParam<int> {
  private:
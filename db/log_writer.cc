@@ -13,18 +13,21 @@
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 
 namespace rocksdb {
 namespace log {
 
 Writer::Writer(std::unique_ptr<WritableFileWriter>&& dest, uint64_t log_number,
-               bool recycle_log_files, bool manual_flush)
+               bool recycle_log_files, bool manual_flush,
+               CompressionType compression_type)
     : dest_(std::move(dest)),
       block_offset_(0),
       log_number_(log_number),
       recycle_log_files_(recycle_log_files),
-      manual_flush_(manual_flush) {
+      manual_flush_(manual_flush),
+      compression_type_(compression_type) {
   for (int i = 0; i <= kMaxRecordType; i++) {
     char t = static_cast<char>(i);
     type_crc_[i] = crc32c::Value(&t, 1);
@@ -52,6 +55,17 @@ Status Writer::AddRecord(const Slice& slice) {
   const char* ptr = slice.data();
   size_t left = slice.size();
 
+  if (compress_) {
+    compressed_buffer_.clear();
+    if (!compress_->Compress(slice, &compressed_buffer_)) {
+      return Status::Corruption("failed to compress WAL record");
+    }
+    ptr = compressed_buffer_.data();
+    left = compressed_buffer_.size();
+  } else {
+    assert(compression_type_ == kNoCompression);
+  }
+
   // Header size varies depending on whether we are recycling or not.
   const int header_size =
       recycle_log_files_ ? kRecyclableHeaderSize : kHeaderSize;
@@ -112,6 +126,28 @@ Status Writer::AddRecord(const Slice& slice) {
   return s;
 }
 
+Status Writer::AddCompressionTypeRecord() {
+  assert(compression_type_ != kNoCompression);
+  // The record is always at the start of the file, where the reader expects
+  // it.
+  assert(block_offset_ == 0);
+  if (compress_) {
+    return Status::OK();
+  }
+  compress_ = NewStreamingCompress(compression_type_);
+  if (!compress_) {
+    return Status::NotSupported("WAL compression type not supported",
+                                CompressionTypeToString(compression_type_));
+  }
+
+  char type = static_cast<char>(compression_type_);
+  Status s = EmitPhysicalRecord(kSetCompressionType, &type, 1);
+  if (s.ok() && !manual_flush_) {
+    s = dest_->Flush();
+  }
+  return s;
+}
+
 bool Writer::TEST_BufferIsEmpty() { return dest_->TEST_BufferIsEmpty(); }
 
 Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
@@ -126,7 +162,7 @@ Status Writer::EmitPhysicalRecord(RecordType t, const char* ptr, size_t n) {
   buf[6] = static_cast<char>(t);
 
   uint32_t crc = type_crc_[t];
-  if (t < kRecyclableFullType) {
+  if (t < kRecyclableFullType || t == kSetCompressionType) {
     // Legacy record format
     assert(block_offset_ + kHeaderSize + n <= kBlockSize);
     header_size = kHeaderSize;
@@ -11,13 +11,16 @@
 #include <stdint.h>
 
 #include <memory>
+#include <string>
 
 #include "db/log_format.h"
+#include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
 namespace rocksdb {
 
+class StreamingCompress;
 class WritableFileWriter;
 
 namespace log {
@@ -64,6 +67,16 @@ namespace log {
  * Same as above, with the addition of
  * Log number = 32bit log file number, so that we can distinguish between
  * records written by the most recent log writer vs a previous one.
+ *
+ * Compressed logs:
+ *
+ * A log written with a compression type other than kNoCompression starts
+ * with a kSetCompressionType record in the legacy record format, whose
+ * payload is the compression type (1B). The payload of every following
+ * logical record is then compressed by a single StreamingCompress, so that
+ * each record is compressed with the history of the ones before it, and
+ * fragmented into physical records as above. Reading a record thus requires
+ * reading all the preceding ones.
  */
 class Writer {
  public:
@@ -72,7 +85,8 @@ class Writer {
   // "*dest" must remain live while this Writer is in use.
   explicit Writer(std::unique_ptr<WritableFileWriter>&& dest,
                   uint64_t log_number, bool recycle_log_files,
-                  bool manual_flush = false);
+                  bool manual_flush = false,
+                  CompressionType compression_type = kNoCompression);
   // No copying allowed
   Writer(const Writer&) = delete;
   void operator=(const Writer&) = delete;
@@ -81,6 +95,11 @@ class Writer {
 
   Status AddRecord(const Slice& slice);
 
+  // Writes the kSetCompressionType record of a compressed log. Must be
+  // called before the first AddRecord(), and only if the compression type
+  // is not kNoCompression.
+  Status AddCompressionTypeRecord();
+
   WritableFileWriter* file() { return dest_.get(); }
   const WritableFileWriter* file() const { return dest_.get(); }
 
@@ -108,6 +127,12 @@ class Writer {
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
   bool manual_flush_;
+
+  // Compression of the records, see AddCompressionTypeRecord().
+  CompressionType compression_type_;
+  std::unique_ptr<StreamingCompress> compress_;
+  // Compressed form of the record being added.
+  std::string compressed_buffer_;
 };
 
 }  // namespace log
@@ -52,6 +52,10 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       memtable_huge_page_size(mutable_cf_options.memtable_huge_page_size),
       memtable_whole_key_filtering(
           mutable_cf_options.memtable_whole_key_filtering),
+      memtable_hash_index_buckets(static_cast<uint32_t>(
+          static_cast<double>(mutable_cf_options.write_buffer_size) *
+          mutable_cf_options.memtable_hash_index_size_ratio /
+          sizeof(void*))),
       inplace_update_support(ioptions.inplace_update_support),
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       inplace_callback(ioptions.inplace_callback),
@@ -119,6 +123,18 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
                          6 /* hard coded 6 probes */,
                          moptions_.memtable_huge_page_size, ioptions.info_log));
   }
+
+  // The index finds entries by hashing the user key bytes, and cannot follow
+  // in-place updates.
+  const Comparator* user_comparator = comparator_.comparator.user_comparator();
+  if (moptions_.memtable_hash_index_buckets > 0 &&
+      !moptions_.inplace_update_support &&
+      user_comparator->timestamp_size() == 0 &&
+      !user_comparator->CanKeysWithDifferentByteContentsBeEqual()) {
+    hash_index_.reset(new MemTableHashIndex(
+        &arena_, moptions_.memtable_hash_index_buckets,
+        moptions_.memtable_huge_page_size, ioptions.info_log));
+  }
 }
 
 MemTable::~MemTable() {
@@ -534,6 +550,9 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
       bloom_filter_->Add(StripTimestampFromUserKey(key, ts_sz));
     }
+    if (hash_index_ && type != kTypeRangeDeletion) {
+      hash_index_->Insert(buf);
+    }
 
     // The first sequence number inserted into the memtable
     assert(first_seqno_ == 0 || s >= first_seqno_);
@@ -570,6 +589,9 @@ bool MemTable::Add(SequenceNumber s, ValueType type,
     if (bloom_filter_ && moptions_.memtable_whole_key_filtering) {
       bloom_filter_->AddConcurrently(StripTimestampFromUserKey(key, ts_sz));
     }
+    if (hash_index_ && type != kTypeRangeDeletion) {
+      hash_index_->Insert(buf);
+    }
 
     // atomically update first_seqno_ and earliest_seqno_.
     uint64_t cur_seq_num = first_seqno_.load(std::memory_order_relaxed);
@@ -852,10 +874,51 @@ void MemTable::GetFromTable(const LookupKey& key,
   saver.callback_ = callback;
   saver.is_blob_index = is_blob_index;
   saver.do_merge = do_merge;
+  if (hash_index_ && GetFromHashIndex(key, callback, &saver)) {
+    *seq = saver.seq;
+    return;
+  }
   table_->Get(key, &saver, SaveValue);
   *seq = saver.seq;
 }
 
+bool MemTable::GetFromHashIndex(const LookupKey& key, ReadCallback* callback,
+                                void* saver) {
+  assert(hash_index_);
+  // Entries are indexed before their sequence numbers are published, so a
+  // user key missing from the index has no visible entry in the memtable.
+  const char* entry = hash_index_->Get(key.user_key());
+  if (entry == nullptr) {
+    return true;
+  }
+  if (callback != nullptr) {
+    return false;
+  }
+  uint64_t tag;
+  MemTableHashIndex::DecodeEntry(entry, &tag);
+  SequenceNumber entry_seq;
+  ValueType type;
+  UnPackSequenceAndType(tag, &entry_seq, &type);
+  if (entry_seq > GetInternalKeySeqno(key.internal_key())) {
+    return false;
+  }
+  // The newest entry is the first one the memtable search would visit, and
+  // unless it is a merge operand it ends the search.
+  switch (type) {
+    case kTypeValue:
+    case kTypeDeletion:
+    case kTypeSingleDeletion:
+    case kTypeBlobIndex: {
+      bool more = SaveValue(saver, entry);
+      assert(!more);
+      (void)more;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
 void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
                         ReadCallback* callback, bool* is_blob) {
   // The sequence number is updated synchronously in version_set.h
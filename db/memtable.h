@@ -21,6 +21,7 @@
 #include "db/version_edit.h"
 #include "memory/allocator.h"
 #include "memory/concurrent_arena.h"
+#include "memtable/memtable_hash_index.h"
 #include "monitoring/instrumented_mutex.h"
 #include "options/cf_options.h"
 #include "rocksdb/db.h"
@@ -44,6 +45,7 @@ struct ImmutableMemTableOptions {
   uint32_t memtable_prefix_bloom_bits;
   size_t memtable_huge_page_size;
   bool memtable_whole_key_filtering;
+  uint32_t memtable_hash_index_buckets;
   bool inplace_update_support;
   size_t inplace_update_num_locks;
   UpdateStatus (*inplace_callback)(char* existing_value,
@@ -489,6 +491,8 @@ class MemTable {
 
   const SliceTransform* const prefix_extractor_;
   std::unique_ptr<DynamicBloom> bloom_filter_;
+  // Newest entry of each user key in table_, if enabled.
+  std::unique_ptr<MemTableHashIndex> hash_index_;
 
   std::atomic<FlushStateEnum> flush_state_;
 
@@ -535,6 +539,11 @@ class MemTable {
                     std::string* value, Status* s, MergeContext* merge_context,
                     SequenceNumber* seq, bool* found_final_value,
                     bool* merge_in_progress);
+
+  // Serves the lookup of GetFromTable() from hash_index_ and returns true if
+  // that is possible; saver is the state of the lookup.
+  bool GetFromHashIndex(const LookupKey& key, ReadCallback* callback,
+                        void* saver);
 };
 
 extern const char* EncodeKey(std::string* scratch, const Slice& target);
@@ -7,6 +7,7 @@
 
 #include <string>
 
+#include "db/blob/blob_fetcher.h"
 #include "db/dbformat.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics.h"
@@ -116,7 +117,8 @@ Status MergeHelper::TimedFullMerge(const MergeOperator* merge_operator,
 Status MergeHelper::MergeUntil(InternalIterator* iter,
                                CompactionRangeDelAggregator* range_del_agg,
                                const SequenceNumber stop_before,
-                               const bool at_bottom) {
+                               const bool at_bottom,
+                               const BlobFetcher* blob_fetcher) {
   // Get a copy of the internal key, before it's invalidated by iter->Next()
   // Also maintain the list of merge operands seen.
   assert(HasOperator());
@@ -201,12 +203,22 @@ Status MergeHelper::MergeUntil(InternalIterator* iter,
       // want. Also if we're in compaction and it's a put, it would be nice to
       // run compaction filter on it.
       const Slice val = iter->value();
+      PinnableSlice blob_value;
       const Slice* val_ptr;
-      if (kTypeValue == ikey.type &&
+      if ((kTypeValue == ikey.type ||
+           (kTypeBlobIndex == ikey.type && blob_fetcher != nullptr)) &&
           (range_del_agg == nullptr ||
            !range_del_agg->ShouldDelete(
                ikey, RangeDelPositioningMode::kForwardTraversal))) {
-        val_ptr = &val;
+        if (kTypeBlobIndex == ikey.type) {
+          s = blob_fetcher->FetchBlob(ikey.user_key, val, &blob_value);
+          if (!s.ok()) {
+            return s;
+          }
+          val_ptr = &blob_value;
+        } else {
+          val_ptr = &val;
+        }
       } else {
         val_ptr = nullptr;
       }
@@ -20,6 +20,7 @@
 
 namespace rocksdb {
 
+class BlobFetcher;
 class Comparator;
 class Iterator;
 class Logger;
@@ -66,6 +67,9 @@ class MergeHelper {
   //                   0 means no restriction
   // at_bottom:   (IN) true if the iterator covers the bottem level, which means
   //                   we could reach the start of the history of this user key.
+  // blob_fetcher: (IN) reads the blob of a blob index the operands are merged
+  //                    into. If null, such a blob index is treated like a
+  //                    missing value.
   //
   // Returns one of the following statuses:
   // - OK: Entries were successfully merged.
@@ -80,7 +84,8 @@ class MergeHelper {
   Status MergeUntil(InternalIterator* iter,
                     CompactionRangeDelAggregator* range_del_agg = nullptr,
                     const SequenceNumber stop_before = 0,
-                    const bool at_bottom = false);
+                    const bool at_bottom = false,
+                    const BlobFetcher* blob_fetcher = nullptr);
 
   // Filters a merge operand using the compaction filter specified
   // in the constructor. Returns the decision that the filter made.
@@ -273,6 +273,17 @@ bool RangeDelAggregator::StripeRep::ShouldDelete(
   }
 }
 
+bool RangeDelAggregator::StripeRep::GetForwardCoveringTombstone(
+    ParsedInternalKey* end_key, SequenceNumber* seq) const {
+  const TruncatedRangeDelIterator* iter = forward_iter_.NewestActiveIter();
+  if (iter == nullptr) {
+    return false;
+  }
+  *end_key = iter->end_key();
+  *seq = iter->seq();
+  return true;
+}
+
 bool RangeDelAggregator::StripeRep::IsRangeOverlapped(const Slice& start,
                                                       const Slice& end) {
   Invalidate();
@@ -115,6 +115,12 @@ class ForwardRangeDelIterator {
   bool ShouldDelete(const ParsedInternalKey& parsed);
   void Invalidate();
 
+  // Returns the newest tombstone covering the key last passed to
+  // ShouldDelete(), or nullptr if there is none.
+  const TruncatedRangeDelIterator* NewestActiveIter() const {
+    return active_seqnums_.empty() ? nullptr : *active_seqnums_.begin();
+  }
+
   void AddNewIter(TruncatedRangeDelIterator* iter,
                   const ParsedInternalKey& parsed) {
     iter->Seek(parsed.user_key);
@@ -328,6 +334,9 @@ class RangeDelAggregator {
 
     bool IsRangeOverlapped(const Slice& start, const Slice& end);
 
+    bool GetForwardCoveringTombstone(ParsedInternalKey* end_key,
+                                     SequenceNumber* seq) const;
+
    private:
     bool InStripe(SequenceNumber seq) const {
       return lower_bound_ <= seq && seq <= upper_bound_;
@@ -375,6 +384,15 @@ class ReadRangeDelAggregator final : public RangeDelAggregator {
 
   bool IsRangeOverlapped(const Slice& start, const Slice& end);
 
+  // After ShouldDelete() returned true for a key in kForwardTraversal mode,
+  // sets *end_key and *seq to the end key and sequence number of the newest
+  // tombstone covering that key. Every entry between that key and *end_key
+  // with a sequence number smaller than *seq is covered as well.
+  bool GetForwardCoveringTombstone(ParsedInternalKey* end_key,
+                                   SequenceNumber* seq) const {
+    return rep_.GetForwardCoveringTombstone(end_key, seq);
+  }
+
   void InvalidateRangeDelMapPositions() override { rep_.Invalidate(); }
 
   bool IsEmpty() const override { return rep_.IsEmpty(); }
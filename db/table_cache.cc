@@ -27,6 +27,7 @@
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
 #include "util/coding.h"
+#include "util/mutexlock.h"
 #include "util/stop_watch.h"
 
 namespace rocksdb {
@@ -150,6 +151,12 @@ Status TableCache::FindTable(const FileOptions& file_options,
     if (no_io) {  // Don't do IO and return a not-found status
       return Status::Incomplete("Table not found in table_cache, no_io is set");
     }
+    MutexLock load_lock(&loader_mutex_[number % kLoadConcurrency]);
+    // Another thread may have opened the file while we waited
+    *handle = cache_->Lookup(key);
+    if (*handle != nullptr) {
+      return s;
+    }
     std::unique_ptr<TableReader> table_reader;
     s = GetTableReader(file_options, internal_comparator, fd,
                        false /* sequential mode */, record_read_stats,
@@ -480,41 +487,11 @@ Status TableCache::MultiGet(const ReadOptions& options,
   // Check that table_range is not empty. Its possible all keys may have been
   // found in the row cache and thus the range may now be empty
   if (s.ok() && !table_range.empty()) {
-    if (t == nullptr) {
-      s = FindTable(
-          file_options_, internal_comparator, fd, &handle, prefix_extractor,
-          options.read_tier == kBlockCacheTier /* no_io */,
-          true /* record_read_stats */, file_read_hist, skip_filters, level);
-      if (s.ok()) {
-        t = GetTableReaderFromHandle(handle);
-        assert(t);
-      }
-    }
-    if (s.ok() && !options.ignore_range_deletions) {
-      std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
-          t->NewRangeTombstoneIterator(options));
-      if (range_del_iter != nullptr) {
-        for (auto iter = table_range.begin(); iter != table_range.end();
-             ++iter) {
-          SequenceNumber* max_covering_tombstone_seq =
-              iter->get_context->max_covering_tombstone_seq();
-          *max_covering_tombstone_seq =
-              std::max(*max_covering_tombstone_seq,
-                       range_del_iter->MaxCoveringTombstoneSeqnum(iter->ukey));
-        }
-      }
-    }
-    if (s.ok()) {
+    s = FindTableForMultiGet(options, internal_comparator, fd, &table_range,
+                             prefix_extractor, file_read_hist, skip_filters,
+                             level, &t, &handle);
+    if (s.ok() && t != nullptr) {
       t->MultiGet(options, &table_range, prefix_extractor, skip_filters);
-    } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
-      for (auto iter = table_range.begin(); iter != table_range.end(); ++iter) {
-        Status* status = iter->s;
-        if (status->IsIncomplete()) {
-          // Couldn't find Table in cache but treat as kFound if no_io set
-          iter->get_context->MarkKeyMayExist();
-          s = Status::OK();
-        }
-      }
     }
   }
 
@@ -551,6 +528,95 @@ Status TableCache::MultiGet(const ReadOptions& options,
   return s;
 }
 
+Status TableCache::StartMultiGet(
+    const ReadOptions& options,
+    const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, const MultiGetContext::Range* mget_range,
+    const SliceTransform* prefix_extractor, HistogramImpl* file_read_hist,
+    bool skip_filters, int level, std::vector<void*>* io_handles,
+    AsyncMultiGet* op) {
+#ifndef ROCKSDB_LITE
+  if (ioptions_.row_cache) {
+    return MultiGet(options, internal_comparator, file_meta, mget_range,
+                    prefix_extractor, file_read_hist, skip_filters, level);
+  }
+#endif  // ROCKSDB_LITE
+  MultiGetRange table_range(*mget_range, mget_range->begin(),
+                            mget_range->end());
+  Status s;
+  if (!table_range.empty()) {
+    op->table_reader = file_meta.fd.table_reader;
+    s = FindTableForMultiGet(options, internal_comparator, file_meta.fd,
+                             &table_range, prefix_extractor, file_read_hist,
+                             skip_filters, level, &op->table_reader,
+                             &op->handle);
+    if (s.ok() && op->table_reader != nullptr) {
+      op->state = op->table_reader->StartMultiGet(
+          options, &table_range, prefix_extractor, skip_filters, io_handles);
+    }
+  }
+  return s;
+}
+
+void TableCache::FinishMultiGet(AsyncMultiGet* op) {
+  if (op->state != nullptr) {
+    op->table_reader->FinishMultiGet(std::move(op->state));
+  }
+  if (op->handle != nullptr) {
+    ReleaseHandle(op->handle);
+    op->handle = nullptr;
+  }
+}
+
+void TableCache::AbandonMultiGet(AsyncMultiGet* op) {
+  op->state.release();
+  op->handle = nullptr;
+}
+
+Status TableCache::FindTableForMultiGet(
+    const ReadOptions& options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    const MultiGetContext::Range* mget_range,
+    const SliceTransform* prefix_extractor, HistogramImpl* file_read_hist,
+    bool skip_filters, int level, TableReader** t, Cache::Handle** handle) {
+  Status s;
+  if (*t == nullptr) {
+    s = FindTable(
+        file_options_, internal_comparator, fd, handle, prefix_extractor,
+        options.read_tier == kBlockCacheTier /* no_io */,
+        true /* record_read_stats */, file_read_hist, skip_filters, level);
+    if (s.ok()) {
+      *t = GetTableReaderFromHandle(*handle);
+      assert(*t);
+    }
+  }
+  if (s.ok() && !options.ignore_range_deletions) {
+    std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
+        (*t)->NewRangeTombstoneIterator(options));
+    if (range_del_iter != nullptr) {
+      for (auto iter = mget_range->begin(); iter != mget_range->end();
+           ++iter) {
+        SequenceNumber* max_covering_tombstone_seq =
+            iter->get_context->max_covering_tombstone_seq();
+        *max_covering_tombstone_seq =
+            std::max(*max_covering_tombstone_seq,
+                     range_del_iter->MaxCoveringTombstoneSeqnum(iter->ukey));
+      }
+    }
+  }
+  if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+    for (auto iter = mget_range->begin(); iter != mget_range->end(); ++iter) {
+      Status* status = iter->s;
+      if (status->IsIncomplete()) {
+        // Couldn't find Table in cache but treat as kFound if no_io set
+        iter->get_context->MarkKeyMayExist();
+        s = Status::OK();
+      }
+    }
+  }
+  return s;
+}
+
 Status TableCache::GetTableProperties(
     const FileOptions& file_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
@@ -659,4 +725,32 @@ uint64_t TableCache::ApproximateSize(
 
   return result;
 }
+
+Status TableCache::ApproximateKeyAnchors(
+    const ReadOptions& read_options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    size_t max_anchors, std::vector<std::string>* anchors,
+    const SliceTransform* prefix_extractor) {
+  Status s;
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* table_handle = nullptr;
+  if (table_reader == nullptr) {
+    s = FindTable(file_options_, internal_comparator, fd, &table_handle,
+                  prefix_extractor, false /* no_io */,
+                  false /* record_read_stats */);
+    if (s.ok()) {
+      table_reader = GetTableReaderFromHandle(table_handle);
+    }
+  }
+
+  if (s.ok()) {
+    s = table_reader->ApproximateKeyAnchors(read_options, max_anchors,
+                                            anchors);
+  }
+  if (table_handle != nullptr) {
+    ReleaseHandle(table_handle);
+  }
+
+  return s;
+}
 }  // namespace rocksdb
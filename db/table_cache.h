@@ -118,6 +118,36 @@ class TableCache {
                   HistogramImpl* file_read_hist = nullptr,
                   bool skip_filters = false, int level = -1);
 
+  // State of a MultiGet() started by StartMultiGet()
+  struct AsyncMultiGet {
+    TableReader* table_reader = nullptr;
+    Cache::Handle* handle = nullptr;
+    std::unique_ptr<TableReader::AsyncMultiGetState> state;
+  };
+
+  // Like MultiGet(), but any data block reads are left outstanding, with
+  // their IO handles appended to io_handles. Once those have been completed
+  // by FileSystem::Poll(), FinishMultiGet() must be called with *op to
+  // complete the lookup, even if this returns an error. If Poll() fails,
+  // the reads must be cancelled with FileSystem::AbortIO() first, or the
+  // lookup given up with AbandonMultiGet() if that fails too. When the row
+  // cache is in use, the lookup is done synchronously.
+  Status StartMultiGet(const ReadOptions& options,
+                       const InternalKeyComparator& internal_comparator,
+                       const FileMetaData& file_meta,
+                       const MultiGetContext::Range* mget_range,
+                       const SliceTransform* prefix_extractor,
+                       HistogramImpl* file_read_hist, bool skip_filters,
+                       int level, std::vector<void*>* io_handles,
+                       AsyncMultiGet* op);
+
+  void FinishMultiGet(AsyncMultiGet* op);
+
+  // Give up on a lookup whose reads may still be outstanding. Its state,
+  // which holds the buffers and IO handles of the reads, is leaked along with
+  // its reference to the table, as the reads may still write into them.
+  void AbandonMultiGet(AsyncMultiGet* op);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
@@ -174,6 +204,15 @@ class TableCache {
                            const InternalKeyComparator& internal_comparator,
                            const SliceTransform* prefix_extractor = nullptr);
 
+  // Appends to anchors at most max_anchors user keys that split the data of
+  // the file represented by fd into ranges of roughly equal size. See
+  // TableReader::ApproximateKeyAnchors().
+  Status ApproximateKeyAnchors(const ReadOptions& read_options,
+                               const InternalKeyComparator& internal_comparator,
+                               const FileDescriptor& fd, size_t max_anchors,
+                               std::vector<std::string>* anchors,
+                               const SliceTransform* prefix_extractor = nullptr);
+
   // Release the handle from a cache
   void ReleaseHandle(Cache::Handle* handle);
 
@@ -202,6 +241,19 @@ class TableCache {
                         bool skip_filters = false, int level = -1,
                         bool prefetch_index_and_filter_in_cache = true);
 
+  // Find the table reader for a MultiGet() and apply its range tombstones
+  // to the keys in mget_range. The table is returned in *t, and *handle
+  // must be released by the caller if set. *t is left null when the table
+  // is not open and IO is not allowed.
+  Status FindTableForMultiGet(const ReadOptions& options,
+                              const InternalKeyComparator& internal_comparator,
+                              const FileDescriptor& fd,
+                              const MultiGetContext::Range* mget_range,
+                              const SliceTransform* prefix_extractor,
+                              HistogramImpl* file_read_hist, bool skip_filters,
+                              int level, TableReader** t,
+                              Cache::Handle** handle);
+
   // Create a key prefix for looking up the row cache. The prefix is of the
   // format row_cache_id + fd_number + seq_no. Later, the user key can be
   // appended to form the full key
@@ -221,6 +273,11 @@ class TableCache {
   std::string row_cache_id_;
   bool immortal_tables_;
   BlockCacheTracer* const block_cache_tracer_;
+  // Serializes the opening of the same file by concurrent first accesses,
+  // which are common when files are not opened at DB open. Files are mapped
+  // to the mutexes by file number.
+  static const size_t kLoadConcurrency = 128;
+  port::Mutex loader_mutex_[kLoadConcurrency];
 };
 
 }  // namespace rocksdb
@@ -87,6 +87,8 @@ class VersionBuilder::Rep {
   Logger* info_log_;
   TableCache* table_cache_;
   VersionStorageInfo* base_vstorage_;
+  VersionSet* version_set_;
+  const ImmutableCFOptions* ioptions_;
   int num_levels_;
   LevelState* levels_;
   // Store states of levels larger than num_levels_. We do this instead of
@@ -99,15 +101,20 @@ class VersionBuilder::Rep {
   bool has_invalid_levels_;
   FileComparator level_zero_cmp_;
   FileComparator level_nonzero_cmp_;
+  // Blob files added or with more garbage since the base version, keyed by
+  // file number.
+  VersionStorageInfo::BlobFiles changed_blob_files_;
 
  public:
   Rep(const FileOptions& file_options, Logger* info_log,
-      TableCache* table_cache,
-      VersionStorageInfo* base_vstorage)
+      TableCache* table_cache, VersionStorageInfo* base_vstorage,
+      VersionSet* version_set, const ImmutableCFOptions* ioptions)
       : file_options_(file_options),
         info_log_(info_log),
         table_cache_(table_cache),
         base_vstorage_(base_vstorage),
+        version_set_(version_set),
+        ioptions_(ioptions),
         num_levels_(base_vstorage->num_levels()),
         has_invalid_levels_(false) {
     levels_ = new LevelState[num_levels_];
@@ -282,6 +289,79 @@ class VersionBuilder::Rep {
     return true;
   }
 
+  // Returns the metadata of a blob file as of the edits applied so far, or
+  // nullptr if the file is unknown.
+  std::shared_ptr<BlobFileMetaData> GetBlobFileMetaData(
+      uint64_t blob_file_number) const {
+    auto changed_it = changed_blob_files_.find(blob_file_number);
+    if (changed_it != changed_blob_files_.end()) {
+      return changed_it->second;
+    }
+    const auto& base_blob_files = base_vstorage_->GetBlobFiles();
+    auto base_it = base_blob_files.find(blob_file_number);
+    if (base_it != base_blob_files.end()) {
+      return base_it->second;
+    }
+    return nullptr;
+  }
+
+  Status ApplyBlobFileAddition(const BlobFileAddition& blob_file_addition) {
+    const uint64_t blob_file_number = blob_file_addition.GetBlobFileNumber();
+    if (GetBlobFileMetaData(blob_file_number) != nullptr) {
+      return Status::Corruption("Blob file #" +
+                                NumberToString(blob_file_number) +
+                                " already added");
+    }
+
+    std::shared_ptr<SharedBlobFileMetaData> shared_meta;
+    if (version_set_ != nullptr) {
+      assert(ioptions_ != nullptr);
+      VersionSet* const version_set = version_set_;
+      const std::string path = ioptions_->cf_paths.front().path;
+      shared_meta = SharedBlobFileMetaData::Create(
+          blob_file_number, blob_file_addition.GetTotalBlobCount(),
+          blob_file_addition.GetTotalBlobBytes(),
+          [version_set, path](SharedBlobFileMetaData* shared) {
+            version_set->AddObsoleteBlobFile(shared->GetBlobFileNumber(),
+                                             path);
+            delete shared;
+          });
+    } else {
+      shared_meta = SharedBlobFileMetaData::Create(
+          blob_file_number, blob_file_addition.GetTotalBlobCount(),
+          blob_file_addition.GetTotalBlobBytes());
+    }
+
+    changed_blob_files_[blob_file_number] = BlobFileMetaData::Create(
+        std::move(shared_meta), 0 /* garbage_blob_count */,
+        0 /* garbage_blob_bytes */);
+    return Status::OK();
+  }
+
+  Status ApplyBlobFileGarbage(const BlobFileGarbage& blob_file_garbage) {
+    const uint64_t blob_file_number = blob_file_garbage.GetBlobFileNumber();
+    std::shared_ptr<BlobFileMetaData> meta =
+        GetBlobFileMetaData(blob_file_number);
+    if (meta == nullptr) {
+      return Status::Corruption("Garbage for unknown blob file #" +
+                                NumberToString(blob_file_number));
+    }
+
+    const uint64_t garbage_blob_count =
+        meta->GetGarbageBlobCount() + blob_file_garbage.GetGarbageBlobCount();
+    const uint64_t garbage_blob_bytes =
+        meta->GetGarbageBlobBytes() + blob_file_garbage.GetGarbageBlobBytes();
+    if (garbage_blob_count > meta->GetTotalBlobCount() ||
+        garbage_blob_bytes > meta->GetTotalBlobBytes()) {
+      return Status::Corruption("More garbage than blobs in blob file #" +
+                                NumberToString(blob_file_number));
+    }
+
+    changed_blob_files_[blob_file_number] = BlobFileMetaData::Create(
+        meta->GetSharedMeta(), garbage_blob_count, garbage_blob_bytes);
+    return Status::OK();
+  }
+
   // Apply all of the edits in *edit to the current state.
   Status Apply(VersionEdit* edit) {
     Status s = CheckConsistency(base_vstorage_);
@@ -289,6 +369,20 @@ class VersionBuilder::Rep {
       return s;
     }
 
+    for (const auto& blob_file_addition : edit->GetBlobFileAdditions()) {
+      s = ApplyBlobFileAddition(blob_file_addition);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+
+    for (const auto& blob_file_garbage : edit->GetBlobFileGarbages()) {
+      s = ApplyBlobFileGarbage(blob_file_garbage);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+
     // Delete files
     const VersionEdit::DeletedFileSet& del = edit->GetDeletedFiles();
     for (const auto& del_file : del) {
@@ -390,10 +484,60 @@ class VersionBuilder::Rep {
       }
     }
 
+    SaveBlobFilesTo(vstorage);
+
     s = CheckConsistency(vstorage);
     return s;
   }
 
+  // Adds to *vstorage, whose SST files are already saved, the blob files that
+  // are still referenced. A blob file is not referenced anymore once all its
+  // blobs are garbage, or once no SST file refers to a blob file as old as it.
+  void SaveBlobFilesTo(VersionStorageInfo* vstorage) const {
+    uint64_t min_oldest_blob_file_number = kInvalidBlobFileNumber;
+    for (int level = 0; level < num_levels_; level++) {
+      for (const FileMetaData* f : vstorage->LevelFiles(level)) {
+        if (f->oldest_blob_file_number != kInvalidBlobFileNumber &&
+            (min_oldest_blob_file_number == kInvalidBlobFileNumber ||
+             f->oldest_blob_file_number < min_oldest_blob_file_number)) {
+          min_oldest_blob_file_number = f->oldest_blob_file_number;
+        }
+      }
+    }
+    if (min_oldest_blob_file_number == kInvalidBlobFileNumber) {
+      return;
+    }
+
+    auto save = [&](const std::shared_ptr<BlobFileMetaData>& meta) {
+      if (meta->GetBlobFileNumber() >= min_oldest_blob_file_number &&
+          !meta->IsFullyGarbage()) {
+        vstorage->AddBlobFile(meta);
+      }
+    };
+
+    // Merge the base blob files with the changed ones, which take
+    // precedence.
+    const auto& base_blob_files = base_vstorage_->GetBlobFiles();
+    auto base_it = base_blob_files.begin();
+    auto changed_it = changed_blob_files_.begin();
+    while (base_it != base_blob_files.end() ||
+           changed_it != changed_blob_files_.end()) {
+      if (changed_it == changed_blob_files_.end() ||
+          (base_it != base_blob_files.end() &&
+           base_it->first < changed_it->first)) {
+        save(base_it->second);
+        ++base_it;
+      } else {
+        if (base_it != base_blob_files.end() &&
+            base_it->first == changed_it->first) {
+          ++base_it;
+        }
+        save(changed_it->second);
+        ++changed_it;
+      }
+    }
+  }
+
   Status LoadTableHandlers(InternalStats* internal_stats, int max_threads,
                            bool prefetch_index_and_filter_in_cache,
                            bool is_initial_load,
@@ -504,8 +648,10 @@ class VersionBuilder::Rep {
 VersionBuilder::VersionBuilder(const FileOptions& file_options,
                                TableCache* table_cache,
                                VersionStorageInfo* base_vstorage,
-                               Logger* info_log)
-    : rep_(new Rep(file_options, info_log, table_cache, base_vstorage)) {}
+                               Logger* info_log, VersionSet* version_set,
+                               const ImmutableCFOptions* ioptions)
+    : rep_(new Rep(file_options, info_log, table_cache, base_vstorage,
+                   version_set, ioptions)) {}
 
 VersionBuilder::~VersionBuilder() { delete rep_; }
 
@@ -14,9 +14,11 @@
 namespace rocksdb {
 
 class TableCache;
+class VersionSet;
 class VersionStorageInfo;
 class VersionEdit;
 struct FileMetaData;
+struct ImmutableCFOptions;
 class InternalStats;
 
 // A helper class so we can efficiently apply a whole sequence
@@ -24,8 +26,14 @@ class InternalStats;
 // Versions that contain full copies of the intermediate state.
 class VersionBuilder {
  public:
+  // If "version_set" is not null, the blob files that the edits add are
+  // handed over to it for deletion (see VersionSet::AddObsoleteBlobFile) once
+  // they are no longer part of any Version. "ioptions" gives their location,
+  // and must be set along with "version_set".
   VersionBuilder(const FileOptions& file_options, TableCache* table_cache,
-                 VersionStorageInfo* base_vstorage, Logger* info_log = nullptr);
+                 VersionStorageInfo* base_vstorage, Logger* info_log = nullptr,
+                 VersionSet* version_set = nullptr,
+                 const ImmutableCFOptions* ioptions = nullptr);
   ~VersionBuilder();
   Status CheckConsistency(VersionStorageInfo* vstorage);
   Status CheckConsistencyForDeletes(VersionEdit* edit, uint64_t number,
@@ -50,6 +50,9 @@ enum Tag : uint32_t {
   kMaxColumnFamily = 203,
 
   kInAtomicGroup = 300,
+
+  kBlobFileAddition = 400,
+  kBlobFileGarbage = 401,
 };
 
 enum CustomTag : uint32_t {
@@ -137,6 +140,8 @@ void VersionEdit::Clear() {
   has_min_log_number_to_keep_ = false;
   deleted_files_.clear();
   new_files_.clear();
+  blob_file_additions_.clear();
+  blob_file_garbages_.clear();
   column_family_ = 0;
   is_column_family_add_ = 0;
   is_column_family_drop_ = 0;
@@ -255,6 +260,16 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
     PutVarint32(dst, CustomTag::kTerminate);
   }
 
+  for (const auto& blob_file_addition : blob_file_additions_) {
+    PutVarint32(dst, kBlobFileAddition);
+    blob_file_addition.EncodeTo(dst);
+  }
+
+  for (const auto& blob_file_garbage : blob_file_garbages_) {
+    PutVarint32(dst, kBlobFileGarbage);
+    blob_file_garbage.EncodeTo(dst);
+  }
+
   // 0 is default and does not need to be explicitly written
   if (column_family_ != 0) {
     PutVarint32Varint32(dst, kColumnFamily, column_family_);
@@ -554,6 +569,24 @@ Status VersionEdit::DecodeFrom(const Slice& src) {
         break;
       }
 
+      case kBlobFileAddition: {
+        BlobFileAddition blob_file_addition;
+        msg = blob_file_addition.DecodeFrom(&input);
+        if (msg == nullptr) {
+          AddBlobFile(blob_file_addition);
+        }
+        break;
+      }
+
+      case kBlobFileGarbage: {
+        BlobFileGarbage blob_file_garbage;
+        msg = blob_file_garbage.DecodeFrom(&input);
+        if (msg == nullptr) {
+          blob_file_garbages_.push_back(blob_file_garbage);
+        }
+        break;
+      }
+
       case kColumnFamily:
         if (!GetVarint32(&input, &column_family_)) {
           if (!msg) {
@@ -677,6 +710,14 @@ std::string VersionEdit::DebugString(bool hex_key) const {
     r.append(" file_creation_time:");
     AppendNumberTo(&r, f.file_creation_time);
   }
+  for (const auto& blob_file_addition : blob_file_additions_) {
+    r.append("\n  BlobFileAddition: ");
+    r.append(blob_file_addition.DebugString());
+  }
+  for (const auto& blob_file_garbage : blob_file_garbages_) {
+    r.append("\n  BlobFileGarbage: ");
+    r.append(blob_file_garbage.DebugString());
+  }
   r.append("\n  ColumnFamily: ");
   AppendNumberTo(&r, column_family_);
   if (is_column_family_add_) {
@@ -759,6 +800,36 @@ std::string VersionEdit::DebugJSON(int edit_num, bool hex_key) const {
     jw.EndArray();
   }
 
+  if (!blob_file_additions_.empty()) {
+    jw << "BlobFileAdditions";
+    jw.StartArray();
+
+    for (const auto& blob_file_addition : blob_file_additions_) {
+      jw.StartArrayedObject();
+      jw << "BlobFileNumber" << blob_file_addition.GetBlobFileNumber();
+      jw << "TotalBlobCount" << blob_file_addition.GetTotalBlobCount();
+      jw << "TotalBlobBytes" << blob_file_addition.GetTotalBlobBytes();
+      jw.EndArrayedObject();
+    }
+
+    jw.EndArray();
+  }
+
+  if (!blob_file_garbages_.empty()) {
+    jw << "BlobFileGarbages";
+    jw.StartArray();
+
+    for (const auto& blob_file_garbage : blob_file_garbages_) {
+      jw.StartArrayedObject();
+      jw << "BlobFileNumber" << blob_file_garbage.GetBlobFileNumber();
+      jw << "GarbageBlobCount" << blob_file_garbage.GetGarbageBlobCount();
+      jw << "GarbageBlobBytes" << blob_file_garbage.GetGarbageBlobBytes();
+      jw.EndArrayedObject();
+    }
+
+    jw.EndArray();
+  }
+
   jw << "ColumnFamily" << column_family_;
 
   if (is_column_family_add_) {
@@ -17,6 +17,8 @@
 #include "memory/arena.h"
 #include "rocksdb/cache.h"
 #include "table/table_reader.h"
+#include "db/blob/blob_file_addition.h"
+#include "db/blob/blob_file_garbage.h"
 #include "util/autovector.h"
 
 #include "lemma.h"
@@ -321,8 +323,30 @@ class VersionEdit {
     deleted_files_.insert({level, file});
   }
 
+  // Add a blob file written by a flush or compaction.
+  void AddBlobFile(uint64_t blob_file_number, uint64_t total_blob_count,
+                   uint64_t total_blob_bytes) {
+    blob_file_additions_.emplace_back(blob_file_number, total_blob_count,
+                                      total_blob_bytes);
+  }
+
+  void AddBlobFile(const BlobFileAddition& blob_file_addition) {
+    blob_file_additions_.push_back(blob_file_addition);
+  }
+
+  // Record blobs of an existing blob file that are no longer referenced.
+  void AddBlobFileGarbage(uint64_t blob_file_number,
+                          uint64_t garbage_blob_count,
+                          uint64_t garbage_blob_bytes) {
+    blob_file_garbages_.emplace_back(blob_file_number, garbage_blob_count,
+                                     garbage_blob_bytes);
+  }
+
   // Number of edits
-  size_t NumEntries() { return new_files_.size() + deleted_files_.size(); }
+  size_t NumEntries() {
+    return new_files_.size() + deleted_files_.size() +
+           blob_file_additions_.size() + blob_file_garbages_.size();
+  }
 
   bool IsColumnFamilyManipulation() {
     return is_column_family_add_ || is_column_family_drop_;
@@ -362,6 +386,14 @@ class VersionEdit {
     return new_files_;
   }
 
+  const std::vector<BlobFileAddition>& GetBlobFileAdditions() const {
+    return blob_file_additions_;
+  }
+
+  const std::vector<BlobFileGarbage>& GetBlobFileGarbages() const {
+    return blob_file_garbages_;
+  }
+
   void MarkAtomicGroup(uint32_t remaining_entries) {
     is_in_atomic_group_ = true;
     remaining_entries_ = remaining_entries;
@@ -402,6 +434,9 @@ class VersionEdit {
   DeletedFileSet deleted_files_;
   std::vector<std::pair<int, FileMetaData>> new_files_;
 
+  std::vector<BlobFileAddition> blob_file_additions_;
+  std::vector<BlobFileGarbage> blob_file_garbages_;
+
   // Each version edit record should have column_family_ set
   // If it's not set, it is default (0)
   uint32_t column_family_;
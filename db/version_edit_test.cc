@@ -270,6 +270,22 @@ TEST_F(VersionEditTest, DbId) {
   TestEncodeDecode(edit);
 }
 
+TEST_F(VersionEditTest, BlobFiles) {
+  VersionEdit edit;
+  edit.AddBlobFile(1234, 2, 4096);
+  edit.AddBlobFile(5678, 1, 1024);
+  edit.AddBlobFileGarbage(1234, 1, 2048);
+  TestEncodeDecode(edit);
+
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  VersionEdit parsed;
+  ASSERT_OK(parsed.DecodeFrom(encoded));
+  ASSERT_EQ(edit.GetBlobFileAdditions(), parsed.GetBlobFileAdditions());
+  ASSERT_EQ(edit.GetBlobFileGarbages(), parsed.GetBlobFileGarbages());
+  ASSERT_EQ(3, parsed.NumEntries());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -20,6 +20,10 @@
 #include <unordered_map>
 #include <vector>
 #include "compaction/compaction.h"
+#include "db/blob/blob_fetcher.h"
+#include "db/blob/blob_file_cache.h"
+#include "db/blob/blob_file_reader.h"
+#include "db/blob_index.h"
 #include "db/internal_stats.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
@@ -50,6 +54,7 @@
 #include "table/two_level_iterator.h"
 #include "test_util/sync_point.h"
 #include "util/coding.h"
+#include "util/mutexlock.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/user_comparator_wrapper.h"
@@ -531,34 +536,10 @@ class FilePickerMultiGet {
         batch_iter_prev_ = batch_iter_;
       }
 
-      MultiGetRange next_file_range(current_level_range_, batch_iter_prev_,
-                                    current_level_range_.end());
-      size_t curr_file_index =
-          (batch_iter_ != current_level_range_.end())
-              ? fp_ctx_array_[batch_iter_.index()].curr_index_in_curr_level
-              : curr_file_level_->num_files;
-      FdWithKeyRange* f;
-      bool is_last_key_in_file;
-      if (!GetNextFileInLevelWithKeys(&next_file_range, &curr_file_index, &f,
-                                      &is_last_key_in_file)) {
+      FdWithKeyRange* f = PickFileInCurrentLevel();
+      if (f == nullptr) {
         search_ended_ = !PrepareNextLevel();
       } else {
-        MultiGetRange::Iterator upper_key = batch_iter_;
-        if (is_last_key_in_file) {
-          // Since cmp_largest is 0, batch_iter_ still points to the last key
-          // that falls in this file, instead of the next one. Increment
-          // upper_key so we can set the range properly for SST MultiGet
-          ++upper_key;
-          ++(fp_ctx_array_[batch_iter_.index()].curr_index_in_curr_level);
-          maybe_repeat_key_ = true;
-        }
-        // Set the range for this file
-        current_file_range_ =
-            MultiGetRange(next_file_range, batch_iter_prev_, upper_key);
-        returned_file_level_ = curr_level_;
-        hit_file_level_ = curr_level_;
-        is_hit_file_last_in_level_ =
-            curr_file_index == curr_file_level_->num_files - 1;
         return f;
       }
     }
@@ -567,6 +548,24 @@ class FilePickerMultiGet {
     return nullptr;
   }
 
+  // Returns the next file in the current level that has keys from the
+  // batch, provided no key of the file returned last may also have to be
+  // looked up in it. Such a file can be looked up before the lookup in the
+  // previous one completes. Returns nullptr otherwise, in which case the
+  // next file is returned by GetNextFile() once the lookups are done.
+  // Never returns a level 0 file, as keys are looked up in each overlapping
+  // level 0 file in turn.
+  FdWithKeyRange* GetNextFileInCurrentLevel() {
+    if (search_ended_ || curr_level_ == 0 || maybe_repeat_key_ ||
+        batch_iter_ == current_level_range_.end()) {
+      return nullptr;
+    }
+    batch_iter_prev_ = batch_iter_;
+    // If no file is found, batch_iter_ is left at the end of the level, so
+    // that GetNextFile() moves on to the next level
+    return PickFileInCurrentLevel();
+  }
+
   // getter for current file level
   // for GET_HIT_L0, GET_HIT_L1 & GET_HIT_L2_AND_UP counts
   unsigned int GetHitFileLevel() { return hit_file_level_; }
@@ -617,6 +616,41 @@ class FilePickerMultiGet {
   const Comparator* user_comparator_;
   const InternalKeyComparator* internal_comparator_;
 
+  // Find the next file in the current level with keys from the batch,
+  // starting at batch_iter_prev_, and set up its key range. Returns nullptr
+  // if there is none, with batch_iter_ at the end of the level.
+  FdWithKeyRange* PickFileInCurrentLevel() {
+    MultiGetRange next_file_range(current_level_range_, batch_iter_prev_,
+                                  current_level_range_.end());
+    size_t curr_file_index =
+        (batch_iter_ != current_level_range_.end())
+            ? fp_ctx_array_[batch_iter_.index()].curr_index_in_curr_level
+            : curr_file_level_->num_files;
+    FdWithKeyRange* f;
+    bool is_last_key_in_file;
+    if (!GetNextFileInLevelWithKeys(&next_file_range, &curr_file_index, &f,
+                                    &is_last_key_in_file)) {
+      return nullptr;
+    }
+    MultiGetRange::Iterator upper_key = batch_iter_;
+    if (is_last_key_in_file) {
+      // Since cmp_largest is 0, batch_iter_ still points to the last key
+      // that falls in this file, instead of the next one. Increment
+      // upper_key so we can set the range properly for SST MultiGet
+      ++upper_key;
+      ++(fp_ctx_array_[batch_iter_.index()].curr_index_in_curr_level);
+      maybe_repeat_key_ = true;
+    }
+    // Set the range for this file
+    current_file_range_ =
+        MultiGetRange(next_file_range, batch_iter_prev_, upper_key);
+    returned_file_level_ = curr_level_;
+    hit_file_level_ = curr_level_;
+    is_hit_file_last_in_level_ =
+        curr_file_index == curr_file_level_->num_files - 1;
+    return f;
+  }
+
   // Setup local variables to search next level.
   // Returns false if there are no more levels to search.
   bool PrepareNextLevel() {
@@ -729,6 +763,23 @@ class FilePickerMultiGet {
     return false;
   }
 };
+
+// A file picked for a MultiGet() batch, along with the keys to look up in it
+struct FileLookup {
+  FileLookup(FdWithKeyRange* _f, const MultiGetRange& _file_range,
+             unsigned int _hit_file_level, bool _is_hit_file_last_in_level)
+      : f(_f),
+        file_range(_file_range),
+        hit_file_level(_hit_file_level),
+        is_hit_file_last_in_level(_is_hit_file_last_in_level) {}
+
+  FdWithKeyRange* f;
+  MultiGetRange file_range;
+  unsigned int hit_file_level;
+  bool is_hit_file_last_in_level;
+  TableCache::AsyncMultiGet async_op;
+  Status s;
+};
 }  // anonymous namespace
 
 VersionStorageInfo::~VersionStorageInfo() { delete[] files_; }
@@ -890,6 +941,7 @@ class LevelIterator final : public InternalIterator {
   void Next() final override;
   bool NextAndGetResult(IterateResult* result) override;
   void Prev() override;
+  bool SkipCoveredEntries(const Slice& end_key, SequenceNumber seq) override;
 
   bool Valid() const override { return file_iter_.Valid(); }
   Slice key() const override {
@@ -1126,6 +1178,26 @@ void LevelIterator::Prev() {
   SkipEmptyFileBackward();
 }
 
+bool LevelIterator::SkipCoveredEntries(const Slice& end_key,
+                                       SequenceNumber seq) {
+  assert(Valid());
+  if (prefix_extractor_ != nullptr && !read_options_.total_order_seek) {
+    // The file iterators may use their prefix filters to answer the seek.
+    return false;
+  }
+  // The covered entries can only come from the current file and the files
+  // up to the one that may contain end_key.
+  size_t end_index = FindFile(icomparator_, *flevel_, end_key);
+  for (size_t i = file_index_; i <= end_index && i < flevel_->num_files;
+       i++) {
+    if (flevel_->files[i].fd.largest_seqno >= seq) {
+      return false;
+    }
+  }
+  Seek(end_key);
+  return true;
+}
+
 bool LevelIterator::SkipEmptyFileForward() {
   bool seen_empty_file = false;
   while (file_iter_.iter() == nullptr ||
@@ -1210,7 +1282,8 @@ class BaseReferencedVersionBuilder {
   explicit BaseReferencedVersionBuilder(ColumnFamilyData* cfd)
       : version_builder_(new VersionBuilder(
             cfd->current()->version_set()->file_options(), cfd->table_cache(),
-            cfd->current()->storage_info(), cfd->ioptions()->info_log)),
+            cfd->current()->storage_info(), cfd->ioptions()->info_log,
+            cfd->current()->version_set(), cfd->ioptions())),
         version_(cfd->current()) {
     version_->Ref();
   }
@@ -1489,7 +1562,6 @@ void Version::GetCreationTimeOfOldestFile(uint64_t* creation_time) {
   uint64_t oldest_time = port::kMaxUint64;
   for (int level = 0; level < storage_info_.num_non_empty_levels_; level++) {
     for (FileMetaData* meta : storage_info_.LevelFiles(level)) {
-      assert(meta->fd.table_reader != nullptr);
       uint64_t file_creation_time = meta->TryGetFileCreationTime();
       if (file_creation_time == kUnknownFileCreationTime) {
         *creation_time = 0;
@@ -1591,7 +1663,8 @@ void Version::AddIteratorsForLevel(const ReadOptions& read_options,
           TableReaderCaller::kUserIterator, arena,
           /*skip_filters=*/false, /*level=*/0,
           /*smallest_compaction_key=*/nullptr,
-          /*largest_compaction_key=*/nullptr));
+          /*largest_compaction_key=*/nullptr),
+          file.fd.largest_seqno);
     }
     if (should_sample) {
       // Count ones for every L0 files. This is done per iterator creation
@@ -1774,13 +1847,20 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       vset_->block_cache_tracer_->is_tracing_enabled()) {
     tracing_get_id = vset_->block_cache_tracer_->NextGetId();
   }
+  // Blob indexes pointing to the blob files of this version are resolved
+  // here, unless the caller asked for the blob index itself.
+  BlobFetcher blob_fetcher(this, read_options);
+  const bool has_blob_files = !storage_info_.GetBlobFiles().empty();
+  bool is_blob_index = false;
+  bool* const is_blob_to_use =
+      (is_blob == nullptr && has_blob_files) ? &is_blob_index : is_blob;
   GetContext get_context(
       user_comparator(), merge_operator_, info_log_, db_statistics_,
       status->ok() ? GetContext::kNotFound : GetContext::kMerge, user_key,
       do_merge ? value : nullptr, value_found, merge_context, do_merge,
       max_covering_tombstone_seq, this->env_, seq,
-      merge_operator_ ? &pinned_iters_mgr : nullptr, callback, is_blob,
-      tracing_get_id);
+      merge_operator_ ? &pinned_iters_mgr : nullptr, callback, is_blob_to_use,
+      tracing_get_id, has_blob_files ? &blob_fetcher : nullptr);
 
   // Pin blocks that we read to hold merge operands
   if (merge_operator_) {
@@ -1846,6 +1926,13 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
         }
         PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
                                   fp.GetHitFileLevel());
+        if (is_blob_index && do_merge && value != nullptr) {
+          const std::string blob_index = value->ToString();
+          *status = GetBlob(read_options, user_key, blob_index, value);
+          if (status->IsIncomplete() && value_found != nullptr) {
+            *value_found = false;
+          }
+        }
         return;
       case GetContext::kDeleted:
         // Use empty error message for speed
@@ -1911,16 +1998,22 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
   // Even though we know the batch size won't be > MAX_BATCH_SIZE,
   // use autovector in order to avoid unnecessary construction of GetContext
   // objects, which is expensive
+  // Blob indexes are resolved as in Get() above.
+  BlobFetcher blob_fetcher(this, read_options);
+  const bool has_blob_files = !storage_info_.GetBlobFiles().empty();
+  const bool resolve_blobs = is_blob == nullptr && has_blob_files;
   autovector<GetContext, 16> get_ctx;
   for (auto iter = range->begin(); iter != range->end(); ++iter) {
     assert(iter->s->ok() || iter->s->IsMergeInProgress());
+    iter->is_blob_index = false;
     get_ctx.emplace_back(
         user_comparator(), merge_operator_, info_log_, db_statistics_,
         iter->s->ok() ? GetContext::kNotFound : GetContext::kMerge, iter->ukey,
         iter->value, nullptr, &(iter->merge_context), true,
         &iter->max_covering_tombstone_seq, this->env_, nullptr,
-        merge_operator_ ? &pinned_iters_mgr : nullptr, callback, is_blob,
-        tracing_mget_id);
+        merge_operator_ ? &pinned_iters_mgr : nullptr, callback,
+        resolve_blobs ? &iter->is_blob_index : is_blob, tracing_mget_id,
+        has_blob_files ? &blob_fetcher : nullptr);
   }
   int get_ctx_index = 0;
   for (auto iter = range->begin(); iter != range->end();
@@ -1934,93 +2027,149 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
       &storage_info_.level_files_brief_, storage_info_.num_non_empty_levels_,
       &storage_info_.file_indexer_, user_comparator(), internal_comparator());
   FdWithKeyRange* f = fp.GetNextFile();
+  std::vector<FileLookup> lookups;
 
   while (f != nullptr) {
-    MultiGetRange file_range = fp.CurrentFileRange();
+    // With async_io, collect the files of the level whose lookups can be
+    // done together, so that their data block reads are issued as a batch
+    lookups.clear();
+    int level = fp.GetCurrentLevel();
+    do {
+      lookups.emplace_back(f, fp.CurrentFileRange(), fp.GetHitFileLevel(),
+                           fp.IsHitFileLastInLevel());
+      f = read_options.async_io ? fp.GetNextFileInCurrentLevel() : nullptr;
+    } while (f != nullptr);
+
     bool timer_enabled =
         GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
         get_perf_context()->per_level_perf_context_enabled;
     StopWatchNano timer(env_, timer_enabled /* auto_start */);
-    Status s = table_cache_->MultiGet(
-        read_options, *internal_comparator(), *f->file_metadata, &file_range,
-        mutable_cf_options_.prefix_extractor.get(),
-        cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
-        IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
-                        fp.IsHitFileLastInLevel()),
-        fp.GetCurrentLevel());
+    if (lookups.size() == 1) {
+      FileLookup& lookup = lookups[0];
+      lookup.s = table_cache_->MultiGet(
+          read_options, *internal_comparator(), *lookup.f->file_metadata,
+          &lookup.file_range, mutable_cf_options_.prefix_extractor.get(),
+          cfd_->internal_stats()->GetFileReadHist(lookup.hit_file_level),
+          IsFilterSkipped(static_cast<int>(lookup.hit_file_level),
+                          lookup.is_hit_file_last_in_level),
+          level);
+    } else {
+      std::vector<void*> io_handles;
+      for (auto& lookup : lookups) {
+        lookup.s = table_cache_->StartMultiGet(
+            read_options, *internal_comparator(), *lookup.f->file_metadata,
+            &lookup.file_range, mutable_cf_options_.prefix_extractor.get(),
+            cfd_->internal_stats()->GetFileReadHist(lookup.hit_file_level),
+            IsFilterSkipped(static_cast<int>(lookup.hit_file_level),
+                            lookup.is_hit_file_last_in_level),
+            level, &io_handles, &lookup.async_op);
+      }
+      bool reads_abandoned = false;
+      if (!io_handles.empty()) {
+        FileSystem* fs = cfd_->ioptions()->fs;
+        Status poll_s = fs->Poll(io_handles, io_handles.size());
+        if (!poll_s.ok()) {
+          for (auto& lookup : lookups) {
+            lookup.s = poll_s;
+          }
+          // The reads that are still outstanding must not outlive the
+          // buffers and handles that FinishMultiGet() frees
+          reads_abandoned = !fs->AbortIO(io_handles).ok();
+        }
+      }
+      for (auto& lookup : lookups) {
+        if (reads_abandoned) {
+          table_cache_->AbandonMultiGet(&lookup.async_op);
+        } else {
+          table_cache_->FinishMultiGet(&lookup.async_op);
+        }
+      }
+    }
     // TODO: examine the behavior for corrupted key
     if (timer_enabled) {
       PERF_COUNTER_BY_LEVEL_ADD(get_from_table_nanos, timer.ElapsedNanos(),
-                                fp.GetCurrentLevel());
+                                level);
     }
-    if (!s.ok()) {
-      // TODO: Set status for individual keys appropriately
-      for (auto iter = file_range.begin(); iter != file_range.end(); ++iter) {
-        *iter->s = s;
-        file_range.MarkKeyDone(iter);
-      }
-      return;
-    }
-    uint64_t batch_size = 0;
-    for (auto iter = file_range.begin(); iter != file_range.end(); ++iter) {
-      GetContext& get_context = *iter->get_context;
-      Status* status = iter->s;
 
-      if (get_context.sample()) {
-        sample_file_read_inc(f->file_metadata);
-      }
-      batch_size++;
-      // report the counters before returning
-      if (get_context.State() != GetContext::kNotFound &&
-          get_context.State() != GetContext::kMerge &&
-          db_statistics_ != nullptr) {
-        get_context.ReportCounters();
-      } else {
-        if (iter->max_covering_tombstone_seq > 0) {
-          // The remaining files we look at will only contain covered keys, so
-          // we stop here for this key
-          file_picker_range.SkipKey(iter);
+    for (auto& lookup : lookups) {
+      MultiGetRange& file_range = lookup.file_range;
+      const Status& s = lookup.s;
+      if (!s.ok()) {
+        // TODO: Set status for individual keys appropriately
+        for (auto iter = file_range.begin(); iter != file_range.end();
+             ++iter) {
+          *iter->s = s;
+          file_range.MarkKeyDone(iter);
         }
+        return;
       }
-      switch (get_context.State()) {
-        case GetContext::kNotFound:
-          // Keep searching in other files
-          break;
-        case GetContext::kMerge:
-          // TODO: update per-level perfcontext user_key_return_count for kMerge
-          break;
-        case GetContext::kFound:
-          if (fp.GetHitFileLevel() == 0) {
-            RecordTick(db_statistics_, GET_HIT_L0);
-          } else if (fp.GetHitFileLevel() == 1) {
-            RecordTick(db_statistics_, GET_HIT_L1);
-          } else if (fp.GetHitFileLevel() >= 2) {
-            RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
+      uint64_t batch_size = 0;
+      for (auto iter = file_range.begin(); iter != file_range.end(); ++iter) {
+        GetContext& get_context = *iter->get_context;
+        Status* status = iter->s;
+
+        if (get_context.sample()) {
+          sample_file_read_inc(lookup.f->file_metadata);
+        }
+        batch_size++;
+        // report the counters before returning
+        if (get_context.State() != GetContext::kNotFound &&
+            get_context.State() != GetContext::kMerge &&
+            db_statistics_ != nullptr) {
+          get_context.ReportCounters();
+        } else {
+          if (iter->max_covering_tombstone_seq > 0) {
+            // The remaining files we look at will only contain covered keys,
+            // so we stop here for this key
+            file_picker_range.SkipKey(iter);
           }
-          PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
-                                    fp.GetHitFileLevel());
-          file_range.MarkKeyDone(iter);
-          continue;
-        case GetContext::kDeleted:
-          // Use empty error message for speed
-          *status = Status::NotFound();
-          file_range.MarkKeyDone(iter);
-          continue;
-        case GetContext::kCorrupt:
-          *status =
-              Status::Corruption("corrupted key for ", iter->lkey->user_key());
-          file_range.MarkKeyDone(iter);
-          continue;
-        case GetContext::kBlobIndex:
-          ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
-          *status = Status::NotSupported(
-              "Encounter unexpected blob index. Please open DB with "
-              "rocksdb::blob_db::BlobDB instead.");
-          file_range.MarkKeyDone(iter);
-          continue;
+        }
+        switch (get_context.State()) {
+          case GetContext::kNotFound:
+            // Keep searching in other files
+            break;
+          case GetContext::kMerge:
+            // TODO: update per-level perfcontext user_key_return_count for
+            // kMerge
+            break;
+          case GetContext::kFound:
+            if (lookup.hit_file_level == 0) {
+              RecordTick(db_statistics_, GET_HIT_L0);
+            } else if (lookup.hit_file_level == 1) {
+              RecordTick(db_statistics_, GET_HIT_L1);
+            } else if (lookup.hit_file_level >= 2) {
+              RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
+            }
+            PERF_COUNTER_BY_LEVEL_ADD(user_key_return_count, 1,
+                                      lookup.hit_file_level);
+            if (iter->is_blob_index && iter->value != nullptr) {
+              const std::string blob_index = iter->value->ToString();
+              *status = GetBlob(read_options, iter->ukey, blob_index,
+                                iter->value);
+            }
+            file_range.MarkKeyDone(iter);
+            continue;
+          case GetContext::kDeleted:
+            // Use empty error message for speed
+            *status = Status::NotFound();
+            file_range.MarkKeyDone(iter);
+            continue;
+          case GetContext::kCorrupt:
+            *status = Status::Corruption("corrupted key for ",
+                                         iter->lkey->user_key());
+            file_range.MarkKeyDone(iter);
+            continue;
+          case GetContext::kBlobIndex:
+            ROCKS_LOG_ERROR(info_log_, "Encounter unexpected blob index.");
+            *status = Status::NotSupported(
+                "Encounter unexpected blob index. Please open DB with "
+                "rocksdb::blob_db::BlobDB instead.");
+            file_range.MarkKeyDone(iter);
+            continue;
+        }
       }
+      RecordInHistogram(db_statistics_, SST_BATCH_SIZE, batch_size);
     }
-    RecordInHistogram(db_statistics_, SST_BATCH_SIZE, batch_size);
     if (file_picker_range.empty()) {
       break;
     }
@@ -2061,6 +2210,53 @@ void Version::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
   }
 }
 
+Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
+                        const Slice& blob_index_slice,
+                        PinnableSlice* value) const {
+  assert(value);
+
+#ifndef ROCKSDB_LITE
+  if (read_options.read_tier == kBlockCacheTier) {
+    return Status::Incomplete("Cannot read blob: no disk I/O allowed");
+  }
+
+  BlobIndex blob_index;
+  Status s = blob_index.DecodeFrom(blob_index_slice);
+  if (!s.ok()) {
+    return s;
+  }
+  if (blob_index.IsInlined() || blob_index.HasTTL()) {
+    return Status::Corruption("Unexpected TTL/inlined blob index");
+  }
+
+  const auto& blob_files = storage_info_.GetBlobFiles();
+  if (blob_files.find(blob_index.file_number()) == blob_files.end()) {
+    return Status::Corruption("Invalid blob file number");
+  }
+
+  BlobFileCache* const blob_file_cache = cfd_->blob_file_cache();
+  assert(blob_file_cache);
+  Cache::Handle* handle = nullptr;
+  s = blob_file_cache->GetBlobFileReader(blob_index.file_number(), &handle);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // blob_index_slice may point into *value, so decode it before resetting.
+  value->Reset();
+  s = blob_file_cache->GetReaderFromHandle(handle)->GetBlob(
+      read_options, user_key, blob_index.offset(), blob_index.size(),
+      blob_index.compression(), value);
+  blob_file_cache->ReleaseHandle(handle);
+  return s;
+#else   // ROCKSDB_LITE
+  (void)read_options;
+  (void)user_key;
+  (void)blob_index_slice;
+  return Status::NotSupported("Blob files are not supported in LITE mode");
+#endif  // ROCKSDB_LITE
+}
+
 bool Version::IsFilterSkipped(int level, bool is_file_last_in_level) {
   // Reaching the bottom level implies misses at all upper levels, so we'll
   // skip checking the filters when we predict a hit.
@@ -2167,9 +2363,11 @@ void Version::UpdateAccumulatedStats(bool update_stats) {
           // already been read, so MaybeInitializeFileMetaData() won't incur
           // any I/O cost. "max_open_files=-1" means that the table cache passed
           // to the VersionSet and then to the ColumnFamilySet has a size of
-          // TableCache::kInfiniteCapacity
+          // TableCache::kInfiniteCapacity. This does not hold for the files
+          // left unopened by skip_opening_sst_files_on_db_open.
           if (vset_->GetColumnFamilySet()->get_table_cache()->GetCapacity() ==
-              TableCache::kInfiniteCapacity) {
+                  TableCache::kInfiniteCapacity &&
+              file_meta->fd.table_reader != nullptr) {
             continue;
           }
           if (++init_count >= kMaxInitCount) {
@@ -3394,13 +3592,19 @@ bool VersionStorageInfo::RangeMightExistAfterSortedRun(
   return false;
 }
 
-void Version::AddLiveFiles(std::vector<FileDescriptor>* live) {
+void Version::AddLiveFiles(std::vector<FileDescriptor>* live,
+                           std::vector<uint64_t>* live_blob_files) {
   for (int level = 0; level < storage_info_.num_levels(); level++) {
     const std::vector<FileMetaData*>& files = storage_info_.files_[level];
     for (const auto& file : files) {
       live->push_back(file->fd);
     }
   }
+  if (live_blob_files != nullptr) {
+    for (const auto& pair : storage_info_.GetBlobFiles()) {
+      live_blob_files->push_back(pair.first);
+    }
+  }
 }
 
 std::string Version::DebugString(bool hex, bool print_stats) const {
@@ -3941,6 +4145,12 @@ Status VersionSet::ProcessManifestWrites(
         ColumnFamilyData* cfd = versions[i]->cfd_;
         AppendVersion(cfd, versions[i]);
       }
+
+      for (const auto& e : batch_edits) {
+        for (const auto& blob_file_addition : e->GetBlobFileAdditions()) {
+          RemoveUninstalledBlobFile(blob_file_addition.GetBlobFileNumber());
+        }
+      }
     }
     manifest_file_number_ = pending_manifest_file_number_;
     manifest_file_size_ = new_manifest_file_size;
@@ -4501,13 +4711,16 @@ Status VersionSet::Recover(
       assert(builders_iter != builders.end());
       auto builder = builders_iter->second->version_builder();
 
-      // unlimited table cache. Pre-load table handle now.
+      // unlimited table cache. Pre-load table handle now, unless the files
+      // are to be opened on first access.
       // Need to do it out of the mutex.
-      builder->LoadTableHandlers(
-          cfd->internal_stats(), db_options_->max_file_opening_threads,
-          false /* prefetch_index_and_filter_in_cache */,
-          true /* is_initial_load */,
-          cfd->GetLatestMutableCFOptions()->prefix_extractor.get());
+      if (!db_options_->skip_opening_sst_files_on_db_open) {
+        builder->LoadTableHandlers(
+            cfd->internal_stats(), db_options_->max_file_opening_threads,
+            false /* prefetch_index_and_filter_in_cache */,
+            true /* is_initial_load */,
+            cfd->GetLatestMutableCFOptions()->prefix_extractor.get());
+      }
 
       Version* v = new Version(cfd, this, file_options_,
                                *cfd->GetLatestMutableCFOptions(),
@@ -5000,6 +5213,19 @@ Status VersionSet::WriteCurrentStateToManifest(
                        f->oldest_ancester_time, f->file_creation_time);
         }
       }
+
+      for (const auto& pair :
+           cfd->current()->storage_info()->GetBlobFiles()) {
+        const auto& meta = pair.second;
+        edit.AddBlobFile(meta->GetBlobFileNumber(), meta->GetTotalBlobCount(),
+                         meta->GetTotalBlobBytes());
+        if (meta->GetGarbageBlobCount() > 0) {
+          edit.AddBlobFileGarbage(meta->GetBlobFileNumber(),
+                                  meta->GetGarbageBlobCount(),
+                                  meta->GetGarbageBlobBytes());
+        }
+      }
+
       const auto iter = curr_state.find(cfd->GetID());
       assert(iter != curr_state.end());
       uint64_t log_number = iter->second.log_number;
@@ -5216,7 +5442,8 @@ uint64_t VersionSet::ApproximateSize(Version* v, const FdWithKeyRange& f,
       v->GetMutableCFOptions().prefix_extractor.get());
 }
 
-void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
+void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list,
+                              std::vector<uint64_t>* live_blob_files) {
   // pre-calculate space requirement
   int64_t total_files = 0;
   for (auto cfd : *column_family_set_) {
@@ -5245,7 +5472,7 @@ void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
     Version* dummy_versions = cfd->dummy_versions();
     for (Version* v = dummy_versions->next_; v != dummy_versions;
          v = v->next_) {
-      v->AddLiveFiles(live_list);
+      v->AddLiveFiles(live_list, live_blob_files);
       if (v == current) {
         found_current = true;
       }
@@ -5253,7 +5480,7 @@ void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
     if (!found_current && current != nullptr) {
       // Should never happen unless it is a bug.
       assert(false);
-      current->AddLiveFiles(live_list);
+      current->AddLiveFiles(live_list, live_blob_files);
     }
   }
 }
@@ -5270,6 +5497,7 @@ InternalIterator* VersionSet::MakeInputIterator(
   // (a) concurrent compactions,
   // (b) CompactionFilter::Decision::kRemoveAndSkipUntil.
   read_options.total_order_seek = true;
+  read_options.async_io = db_options_->async_compaction_readahead;
 
   // Level-0 files have to be merged together.  For other levels,
   // we will make a concatenating iterator per level.
@@ -5431,6 +5659,7 @@ void VersionSet::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
 }
 
 void VersionSet::GetObsoleteFiles(std::vector<ObsoleteFileInfo>* files,
+                                  std::vector<ObsoleteBlobFileInfo>* blob_files,
                                   std::vector<std::string>* manifest_filenames,
                                   uint64_t min_pending_output) {
   assert(manifest_filenames->empty());
@@ -5444,6 +5673,26 @@ void VersionSet::GetObsoleteFiles(std::vector<ObsoleteFileInfo>* files,
     }
   }
   obsolete_files_.swap(pending_files);
+
+  std::vector<ObsoleteBlobFileInfo> pending_blob_files;
+  for (auto& blob_file : obsolete_blob_files_) {
+    if (blob_file.blob_file_number < min_pending_output) {
+      blob_files->push_back(std::move(blob_file));
+    } else {
+      pending_blob_files.push_back(std::move(blob_file));
+    }
+  }
+  obsolete_blob_files_.swap(pending_blob_files);
+}
+
+void VersionSet::AddUninstalledBlobFile(uint64_t blob_file_number) {
+  MutexLock l(&uninstalled_blob_files_mutex_);
+  uninstalled_blob_files_.insert(blob_file_number);
+}
+
+bool VersionSet::RemoveUninstalledBlobFile(uint64_t blob_file_number) {
+  MutexLock l(&uninstalled_blob_files_mutex_);
+  return uninstalled_blob_files_.erase(blob_file_number) > 0;
 }
 
 ColumnFamilyData* VersionSet::CreateColumnFamily(
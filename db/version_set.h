@@ -25,9 +25,11 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "db/blob/blob_file_meta.h"
 #include "db/column_family.h"
 #include "db/compaction/compaction.h"
 #include "db/compaction/compaction_picker.h"
@@ -118,6 +120,16 @@ class VersionStorageInfo {
 
   void AddFile(int level, FileMetaData* f, Logger* info_log = nullptr);
 
+  // Blob files, keyed by file number.
+  using BlobFiles = std::map<uint64_t, std::shared_ptr<BlobFileMetaData>>;
+
+  void AddBlobFile(std::shared_ptr<BlobFileMetaData> blob_file_meta) {
+    assert(blob_file_meta);
+    const uint64_t blob_file_number = blob_file_meta->GetBlobFileNumber();
+    assert(blob_files_.find(blob_file_number) == blob_files_.end());
+    blob_files_.emplace(blob_file_number, std::move(blob_file_meta));
+  }
+
   void SetFinalized();
 
   // Update num_non_empty_levels_.
@@ -278,6 +290,8 @@ class VersionStorageInfo {
     return files_[level];
   }
 
+  const BlobFiles& GetBlobFiles() const { return blob_files_; }
+
   const rocksdb::LevelFilesBrief& LevelFilesBrief(int level) const {
     assert(level < static_cast<int>(level_files_brief_.size()));
     return level_files_brief_[level];
@@ -452,6 +466,9 @@ class VersionStorageInfo {
   // in increasing order of keys
   std::vector<FileMetaData*>* files_;
 
+  // Blob files that the SST files of this version refer to.
+  BlobFiles blob_files_;
+
   // Level that L0 data should be compacted to. All levels < base_level_ should
   // be empty. -1 if it is not level-compaction so it's not applicable.
   int base_level_;
@@ -615,8 +632,17 @@ class Version {
   // and return true. Otherwise, return false.
   bool Unref();
 
-  // Add all files listed in the current version to *live.
-  void AddLiveFiles(std::vector<FileDescriptor>* live);
+  // Add all files listed in the current version to *live, and the numbers
+  // of its blob files to *live_blob_files if not null.
+  void AddLiveFiles(std::vector<FileDescriptor>* live,
+                    std::vector<uint64_t>* live_blob_files = nullptr);
+
+  // Reads the blob that a blob index of this version refers to. Only blob
+  // references to the blob files of this version are supported (see
+  // AdvancedColumnFamilyOptions::enable_blob_files), not the ones of the
+  // StackableDB BlobDB.
+  Status GetBlob(const ReadOptions& read_options, const Slice& user_key,
+                 const Slice& blob_index_slice, PinnableSlice* value) const;
 
   // Return a human readable string that describes this version's contents.
   std::string DebugString(bool hex = false, bool print_stats = false) const;
@@ -777,6 +803,16 @@ struct ObsoleteFileInfo {
   }
 };
 
+// A blob file that no longer belongs to any Version, and the directory it
+// is in.
+struct ObsoleteBlobFileInfo {
+  ObsoleteBlobFileInfo(uint64_t _blob_file_number, std::string _path)
+      : blob_file_number(_blob_file_number), path(std::move(_path)) {}
+
+  uint64_t blob_file_number;
+  std::string path;
+};
+
 class BaseReferencedVersionBuilder;
 
 class AtomicGroupReadBuffer {
@@ -1008,8 +1044,10 @@ class VersionSet {
       const Compaction* c, RangeDelAggregator* range_del_agg,
       const FileOptions& file_options_compactions);
 
-  // Add all files listed in any live version to *live.
-  void AddLiveFiles(std::vector<FileDescriptor>* live_list);
+  // Add all files listed in any live version to *live, and the numbers of
+  // their blob files to *live_blob_files if not null.
+  void AddLiveFiles(std::vector<FileDescriptor>* live_list,
+                    std::vector<uint64_t>* live_blob_files = nullptr);
 
   // Return the approximate size of data to be scanned for range [start, end)
   // in levels [start_level, end_level). If end_level == -1 it will search
@@ -1035,9 +1073,26 @@ class VersionSet {
   void GetLiveFilesMetaData(std::vector<LiveFileMetaData> *metadata);
 
   void GetObsoleteFiles(std::vector<ObsoleteFileInfo>* files,
+                        std::vector<ObsoleteBlobFileInfo>* blob_files,
                         std::vector<std::string>* manifest_filenames,
                         uint64_t min_pending_output);
 
+  // Called when the blob file is no longer part of any Version.
+  // REQUIRES: DB mutex held
+  void AddObsoleteBlobFile(uint64_t blob_file_number, std::string path) {
+    obsolete_blob_files_.emplace_back(blob_file_number, std::move(path));
+  }
+
+  // Called when a flush or compaction creates a blob file, before any
+  // Version lists it. The file stays recorded until a MANIFEST write installs
+  // it, so that if the job fails, the full scan of the DB directory can tell
+  // it apart from the blob files of a stacked BlobDB and delete it.
+  void AddUninstalledBlobFile(uint64_t blob_file_number);
+
+  // Forgets a blob file recorded by AddUninstalledBlobFile(). Returns false if
+  // this DB did not create the file or has installed it since.
+  bool RemoveUninstalledBlobFile(uint64_t blob_file_number);
+
   ColumnFamilySet* GetColumnFamilySet() { return column_family_set_.get(); }
   const FileOptions& file_options() { return file_options_; }
   void ChangeFileOptions(const MutableDBOptions& new_options) {
@@ -1156,8 +1211,14 @@ class VersionSet {
   uint64_t manifest_file_size_;
 
   std::vector<ObsoleteFileInfo> obsolete_files_;
+  std::vector<ObsoleteBlobFileInfo> obsolete_blob_files_;
   std::vector<std::string> obsolete_manifests_;
 
+  // Blob files written by flushes and compactions but not installed. Has
+  // its own mutex, since the jobs create blob files without the DB mutex.
+  port::Mutex uninstalled_blob_files_mutex_;
+  std::unordered_set<uint64_t> uninstalled_blob_files_;
+
   // env options for all reads and writes except compactions
   FileOptions file_options_;
 
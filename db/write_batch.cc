@@ -35,6 +35,7 @@
 
 #include "rocksdb/write_batch.h"
 
+#include <algorithm>
 #include <map>
 #include <stack>
 #include <stdexcept>
@@ -2044,6 +2045,83 @@ Status WriteBatchInternal::InsertInto(
   return s;
 }
 
+Status WriteBatchInternal::SplitIntoChunks(
+    const WriteBatch* batch, size_t num_chunks,
+    std::vector<WriteBatchChunk>* chunks) {
+  assert(num_chunks > 0);
+  assert(chunks != nullptr);
+  chunks->clear();
+  const std::string& rep = batch->rep_;
+  if (rep.size() < kHeader) {
+    return Status::Corruption("malformed WriteBatch (too small)");
+  }
+  const uint32_t count = Count(batch);
+  const uint32_t records_per_chunk = static_cast<uint32_t>(
+      std::max<size_t>((count + num_chunks - 1) / num_chunks, 1));
+
+  chunks->push_back({kHeader, rep.size(), 0});
+  Slice input(rep.data() + kHeader, rep.size() - kHeader);
+  Slice key, value, blob, xid;
+  char tag = 0;
+  uint32_t column_family = 0;
+  uint32_t found = 0;
+  while (!input.empty()) {
+    if (chunks->size() < num_chunks &&
+        found >= chunks->size() * records_per_chunk) {
+      const size_t offset = rep.size() - input.size();
+      chunks->back().end = offset;
+      chunks->push_back({offset, rep.size(), found});
+    }
+    Status s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key,
+                                        &value, &blob, &xid);
+    if (!s.ok()) {
+      return s;
+    }
+    // Same as the records WriteBatch::Iterate() counts.
+    switch (tag) {
+      case kTypeColumnFamilyValue:
+      case kTypeValue:
+      case kTypeColumnFamilyDeletion:
+      case kTypeDeletion:
+      case kTypeColumnFamilySingleDeletion:
+      case kTypeSingleDeletion:
+      case kTypeColumnFamilyRangeDeletion:
+      case kTypeRangeDeletion:
+      case kTypeColumnFamilyMerge:
+      case kTypeMerge:
+      case kTypeColumnFamilyBlobIndex:
+      case kTypeBlobIndex:
+        found++;
+        break;
+      default:
+        break;
+    }
+  }
+  if (found != count) {
+    return Status::Corruption("WriteBatch has wrong count");
+  }
+  return Status::OK();
+}
+
+Status WriteBatchInternal::InsertInto(
+    const WriteBatch* batch, const WriteBatchChunk& chunk,
+    SequenceNumber sequence, ColumnFamilyMemTables* memtables,
+    FlushScheduler* flush_scheduler,
+    TrimHistoryScheduler* trim_history_scheduler,
+    bool ignore_missing_column_families, uint64_t log_ref, DB* db,
+    bool hint_per_batch) {
+  MemTableInserter inserter(
+      sequence + chunk.first_record, memtables, flush_scheduler,
+      trim_history_scheduler, ignore_missing_column_families,
+      0 /*recovery_log_number*/, db, true /*concurrent_memtable_writes*/,
+      nullptr /*has_valid_writes*/, false /*seq_per_batch*/,
+      true /*batch_per_txn*/, hint_per_batch);
+  inserter.set_log_number_ref(log_ref);
+  Status s = Iterate(batch, &inserter, chunk.begin, chunk.end);
+  inserter.PostProcess();
+  return s;
+}
+
 Status WriteBatchInternal::SetContents(WriteBatch* b, const Slice& contents) {
   assert(contents.size() >= WriteBatchInternal::kHeader);
   b->rep_.assign(contents.data(), contents.size());
@@ -61,6 +61,16 @@ class ColumnFamilyMemTablesDefault : public ColumnFamilyMemTables {
   MemTable* mem_;
 };
 
+// A range of consecutive records of a WriteBatch, see
+// WriteBatchInternal::SplitIntoChunks().
+struct WriteBatchChunk {
+  // Offsets of the records in the contents of the batch, end exclusive.
+  size_t begin;
+  size_t end;
+  // Number of the records before the chunk that take a sequence number.
+  uint32_t first_record;
+};
+
 // WriteBatchInternal provides static methods for manipulating a
 // WriteBatch that we don't want in the public WriteBatch interface.
 class WriteBatchInternal {
@@ -191,6 +201,24 @@ class WriteBatchInternal {
                            bool batch_per_txn = true,
                            bool hint_per_batch = false);
 
+  // Splits the records of the batch into up to num_chunks chunks with about
+  // the same number of records each.
+  static Status SplitIntoChunks(const WriteBatch* batch, size_t num_chunks,
+                                std::vector<WriteBatchChunk>* chunks);
+
+  // Inserts the records of one chunk of the batch, with concurrent memtable
+  // writes, so that the chunks can be inserted by several threads at once.
+  // "sequence" is the sequence number of the first record of the batch, as
+  // set in the batch. The caller must make sure the memtables object is
+  // thread-local.
+  static Status InsertInto(
+      const WriteBatch* batch, const WriteBatchChunk& chunk,
+      SequenceNumber sequence, ColumnFamilyMemTables* memtables,
+      FlushScheduler* flush_scheduler,
+      TrimHistoryScheduler* trim_history_scheduler,
+      bool ignore_missing_column_families, uint64_t log_ref, DB* db,
+      bool hint_per_batch);
+
   static Status Append(WriteBatch* dst, const WriteBatch* src,
                        const bool WAL_only = false);
 
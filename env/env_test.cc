@@ -1159,6 +1159,147 @@ TEST_P(EnvPosixTestWithParam, MultiRead) {
   }
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+TEST_F(EnvPosixTest, ReadAsync) {
+  std::shared_ptr<FileSystem> fs = FileSystem::Default();
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+
+  const size_t kBlockSize = 4096;
+  const size_t kNumBlocks = 64;
+  {
+    std::unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, EnvOptions()));
+    for (size_t i = 0; i < kNumBlocks; ++i) {
+      std::string block(kBlockSize, static_cast<char>('a' + i % 26));
+      ASSERT_OK(wfile->Append(block));
+    }
+    ASSERT_OK(wfile->Close());
+  }
+  std::unique_ptr<FSRandomAccessFile> file;
+  ASSERT_OK(fs->NewRandomAccessFile(fname, FileOptions(), &file, nullptr));
+
+  struct BlockRead {
+    FSReadRequest req;
+    std::unique_ptr<char[]> scratch;
+    int callbacks = 0;
+    void* io_handle = nullptr;
+    IOHandleDeleter del_fn;
+  };
+  auto submit_reads = [&](std::vector<BlockRead>* reads,
+                          std::vector<void*>* io_handles) {
+    for (size_t i = 0; i < reads->size(); ++i) {
+      BlockRead& read = (*reads)[i];
+      read.scratch.reset(new char[kBlockSize]);
+      read.req.offset = i * kBlockSize;
+      read.req.len = kBlockSize;
+      read.req.scratch = read.scratch.get();
+      ASSERT_OK(file->ReadAsync(
+          read.req, IOOptions(),
+          [](const FSReadRequest& req, void* arg) {
+            BlockRead* r = static_cast<BlockRead*>(arg);
+            r->req.status = req.status;
+            r->req.result = req.result;
+            r->callbacks++;
+          },
+          &read, &read.io_handle, &read.del_fn, nullptr));
+      if (read.io_handle != nullptr) {
+        io_handles->push_back(read.io_handle);
+      }
+    }
+  };
+  auto check_reads = [&](std::vector<BlockRead>* reads) {
+    for (size_t i = 0; i < reads->size(); ++i) {
+      BlockRead& read = (*reads)[i];
+      ASSERT_EQ(1, read.callbacks);
+      ASSERT_OK(read.req.status);
+      ASSERT_EQ(std::string(kBlockSize, static_cast<char>('a' + i % 26)),
+                read.req.result.ToString());
+      if (read.io_handle != nullptr) {
+        read.del_fn(read.io_handle);
+      }
+    }
+  };
+  auto read_blocks = [&](std::vector<BlockRead>* reads) {
+    std::vector<void*> io_handles;
+    submit_reads(reads, &io_handles);
+    ASSERT_OK(fs->Poll(io_handles, io_handles.size()));
+    check_reads(reads);
+  };
+
+  std::vector<BlockRead> reads(kNumBlocks);
+  read_blocks(&reads);
+
+  // MultiRead() on the same thread, while reads are outstanding, neither
+  // reaps nor mistakes their completions
+  {
+    std::vector<BlockRead> async_reads(kNumBlocks);
+    std::vector<void*> io_handles;
+    submit_reads(&async_reads, &io_handles);
+    std::vector<FSReadRequest> reqs(4);
+    std::vector<std::unique_ptr<char[]>> scratches;
+    for (size_t i = 0; i < reqs.size(); ++i) {
+      scratches.emplace_back(new char[kBlockSize]);
+      reqs[i].offset = (kNumBlocks - 1 - i) * kBlockSize;
+      reqs[i].len = kBlockSize;
+      reqs[i].scratch = scratches.back().get();
+    }
+    ASSERT_OK(file->MultiRead(reqs.data(), reqs.size(), IOOptions(), nullptr));
+    for (size_t i = 0; i < reqs.size(); ++i) {
+      ASSERT_OK(reqs[i].status);
+      ASSERT_EQ(std::string(kBlockSize, static_cast<char>(
+                                            'a' + (kNumBlocks - 1 - i) % 26)),
+                reqs[i].result.ToString());
+    }
+    ASSERT_OK(fs->Poll(io_handles, io_handles.size()));
+    check_reads(&async_reads);
+  }
+
+  // Aborting reads completes each of them exactly once, cancelled or not,
+  // after which their buffers and handles may be freed
+  {
+    std::vector<BlockRead> async_reads(kNumBlocks);
+    std::vector<void*> io_handles;
+    submit_reads(&async_reads, &io_handles);
+    ASSERT_OK(fs->AbortIO(io_handles));
+    for (size_t i = 0; i < async_reads.size(); ++i) {
+      BlockRead& read = async_reads[i];
+      ASSERT_EQ(1, read.callbacks);
+      if (read.req.status.ok()) {
+        ASSERT_EQ(std::string(kBlockSize, static_cast<char>('a' + i % 26)),
+                  read.req.result.ToString());
+      }
+      if (read.io_handle != nullptr) {
+        read.del_fn(read.io_handle);
+      }
+    }
+    // The ring is still usable
+    std::vector<BlockRead> more_reads(8);
+    read_blocks(&more_reads);
+  }
+
+#ifndef NDEBUG
+  // A failed submission falls back to a synchronous read, and leaves the
+  // ring usable for the next reads
+  int failed_submits = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "PosixRandomAccessFile::ReadAsync:Submit", [&](void* arg) {
+        if (failed_submits < 2) {
+          *static_cast<int*>(arg) = -EBUSY;
+          failed_submits++;
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  std::vector<BlockRead> reads2(8);
+  read_blocks(&reads2);
+  ASSERT_EQ(2, failed_submits);
+  ASSERT_EQ(nullptr, reads2[0].io_handle);
+  ASSERT_EQ(nullptr, reads2[1].io_handle);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+#endif  // !NDEBUG
+}
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
 // Only works in linux platforms
 #ifdef OS_WIN
 TEST_P(EnvPosixTestWithParam, DISABLED_InvalidateCache) {
@@ -237,12 +237,14 @@ class PosixFileSystem : public FileSystem {
         }
 #endif
       }
-      result->reset(new PosixRandomAccessFile(fname, fd, options
+      result->reset(new PosixRandomAccessFile(
+          fname, fd, options
 #if defined(ROCKSDB_IOURING_PRESENT)
-                                              ,
-                                              thread_local_io_urings_.get()
+          ,
+          thread_local_io_urings_.get(),
+          thread_local_async_read_io_urings_.get()
 #endif
-                                                  ));
+          ));
     }
     return s;
   }
@@ -834,6 +836,83 @@ class PosixFileSystem : public FileSystem {
     return optimized;
   }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override {
+    size_t completed = 0;
+    for (void* h : io_handles) {
+      Posix_IOHandle* posix_handle = static_cast<Posix_IOHandle*>(h);
+      if (posix_handle == nullptr || posix_handle->is_finished) {
+        completed++;
+      }
+    }
+    for (void* h : io_handles) {
+      if (completed >= min_completions) {
+        break;
+      }
+      Posix_IOHandle* posix_handle = static_cast<Posix_IOHandle*>(h);
+      // Reap completions from the handle's ring until this one is done. The
+      // reaped completions can be for any read outstanding on this thread
+      while (posix_handle != nullptr && !posix_handle->is_finished) {
+        // Submit whatever is still queued in the ring, in case the read was
+        // never submitted, and wait for a completion
+        int ret = io_uring_submit_and_wait(posix_handle->iu, 1);
+        if (ret == -EINTR) {
+          continue;
+        }
+        if (ret < 0) {
+          return IOError("io_uring_submit_and_wait failed", "", -ret);
+        }
+        struct io_uring_cqe* cqe = nullptr;
+        ret = io_uring_peek_cqe(posix_handle->iu, &cqe);
+        if (ret == -EAGAIN) {
+          continue;
+        }
+        if (ret < 0) {
+          return IOError("io_uring_peek_cqe failed", "", -ret);
+        }
+        Posix_IOHandle* done =
+            static_cast<Posix_IOHandle*>(io_uring_cqe_get_data(cqe));
+        int res = cqe->res;
+        io_uring_cqe_seen(posix_handle->iu, cqe);
+        if (done == nullptr) {
+          // A no-op left by a failed submission in ReadAsync()
+          continue;
+        }
+        FinishPosixIOHandle(done, res);
+        done->is_finished = true;
+        done->cb(done->req, done->cb_arg);
+        completed++;
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    for (void* h : io_handles) {
+      Posix_IOHandle* posix_handle = static_cast<Posix_IOHandle*>(h);
+      if (posix_handle == nullptr || posix_handle->is_finished) {
+        continue;
+      }
+      struct io_uring_sqe* sqe = io_uring_get_sqe(posix_handle->iu);
+      if (sqe == nullptr) {
+        io_uring_submit(posix_handle->iu);
+        sqe = io_uring_get_sqe(posix_handle->iu);
+      }
+      // Without a cancellation the read still completes, only later
+      if (sqe != nullptr) {
+        io_uring_prep_cancel(sqe, posix_handle, 0);
+        // Like the no-ops of ReadAsync(), the cancellation's own completion
+        // carries no handle
+        io_uring_sqe_set_data(sqe, nullptr);
+      }
+    }
+    // Each read completes once, cancelled or not, so once all of them have
+    // been reaped none can write into its buffer any more
+    return Poll(io_handles, io_handles.size());
+  }
+#endif
+
  private:
   bool checkedDiskForMmap_;
   bool forceMmapOff_;  // do we override Env options?
@@ -872,6 +951,8 @@ class PosixFileSystem : public FileSystem {
 #if defined(ROCKSDB_IOURING_PRESENT)
   // io_uring instance
   std::unique_ptr<ThreadLocalPtr> thread_local_io_urings_;
+  // io_uring instance of the reads of ReadAsync(), which Poll() completes
+  std::unique_ptr<ThreadLocalPtr> thread_local_async_read_io_urings_;
 #endif
 
   size_t page_size_;
@@ -893,7 +974,9 @@ PosixFileSystem::PosixFileSystem()
   struct io_uring* new_io_uring = CreateIOUring();
   if (new_io_uring != nullptr) {
     thread_local_io_urings_.reset(new ThreadLocalPtr(DeleteIOUring));
-    delete new_io_uring;
+    thread_local_async_read_io_urings_.reset(
+        new ThreadLocalPtr(DeleteIOUring));
+    DeleteIOUring(new_io_uring);
   }
 #endif
 }
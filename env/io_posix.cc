@@ -418,7 +418,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
     const std::string& fname, int fd, const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
     ,
-    ThreadLocalPtr* thread_local_io_urings
+    ThreadLocalPtr* thread_local_io_urings,
+    ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
     )
     : filename_(fname),
@@ -427,7 +428,8 @@ PosixRandomAccessFile::PosixRandomAccessFile(
       logical_sector_size_(GetLogicalBufferSize(fd_))
 #if defined(ROCKSDB_IOURING_PRESENT)
       ,
-      thread_local_io_urings_(thread_local_io_urings)
+      thread_local_io_urings_(thread_local_io_urings),
+      thread_local_async_read_io_urings_(thread_local_async_read_io_urings)
 #endif
 {
   assert(!options.use_direct_reads || !options.use_mmap_reads);
@@ -569,6 +571,103 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs,
 #endif
 }
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+void FinishPosixIOHandle(Posix_IOHandle* handle, int res) {
+  FSReadRequest* req = &handle->req;
+  if (res < 0) {
+    req->result = Slice(req->scratch, 0);
+    req->status = IOError("Req failed", *handle->filename, -res);
+    return;
+  }
+  size_t done = static_cast<size_t>(res);
+  // The read may have been cut short without reaching the end of the file,
+  // so try to read the remainder synchronously
+  while (done < req->len) {
+    ssize_t r = pread(handle->fd, req->scratch + done, req->len - done,
+                      static_cast<off_t>(req->offset + done));
+    if (r <= 0) {
+      if (r == -1 && errno == EINTR) {
+        continue;
+      }
+      if (r == -1) {
+        req->status = IOError("While pread offset " +
+                                  ToString(req->offset + done) + " len " +
+                                  ToString(req->len - done),
+                              *handle->filename, errno);
+      }
+      break;
+    }
+    done += static_cast<size_t>(r);
+  }
+  req->result = Slice(req->scratch, done);
+}
+
+IOStatus PosixRandomAccessFile::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+  struct io_uring* iu = nullptr;
+  if (thread_local_async_read_io_urings_ && !use_direct_io()) {
+    iu = static_cast<struct io_uring*>(
+        thread_local_async_read_io_urings_->Get());
+    if (iu == nullptr) {
+      iu = CreateIOUring();
+      if (iu != nullptr) {
+        thread_local_async_read_io_urings_->Reset(iu);
+      }
+    }
+  }
+  struct io_uring_sqe* sqe = nullptr;
+  if (iu != nullptr) {
+    sqe = io_uring_get_sqe(iu);
+    if (sqe == nullptr) {
+      // Submission queue is full. Flush it and try once more
+      io_uring_submit(iu);
+      sqe = io_uring_get_sqe(iu);
+    }
+  }
+  // No io_uring or no room left in it. Fall back to a synchronous read
+  if (sqe == nullptr) {
+    return FSRandomAccessFile::ReadAsync(req, opts, cb, cb_arg, io_handle,
+                                         del_fn, dbg);
+  }
+
+  Posix_IOHandle* handle = new Posix_IOHandle();
+  handle->iu = iu;
+  handle->cb = cb;
+  handle->cb_arg = cb_arg;
+  handle->req = req;
+  handle->req.status = IOStatus::OK();
+  handle->fd = fd_;
+  handle->filename = &filename_;
+  handle->is_finished = false;
+  handle->iov.iov_base = req.scratch;
+  handle->iov.iov_len = req.len;
+  io_uring_prep_readv(sqe, fd_, &handle->iov, 1, req.offset);
+  io_uring_sqe_set_data(sqe, handle);
+
+  // Tests can fail the submission by setting a negative error here
+  int ret = 0;
+  TEST_SYNC_POINT_CALLBACK("PosixRandomAccessFile::ReadAsync:Submit", &ret);
+  if (ret >= 0) {
+    ret = io_uring_submit(iu);
+  }
+  if (ret < 0) {
+    // Nothing was submitted. Turn the queued entry into a no-op without a
+    // handle, which Poll() skips once a later submission carries it, and
+    // read synchronously instead
+    io_uring_prep_nop(sqe);
+    io_uring_sqe_set_data(sqe, nullptr);
+    delete handle;
+    return FSRandomAccessFile::ReadAsync(req, opts, cb, cb_arg, io_handle,
+                                         del_fn, dbg);
+  }
+  *io_handle = handle;
+  *del_fn = DeletePosixIOHandle;
+  return IOStatus::OK();
+}
+#endif  // defined(ROCKSDB_IOURING_PRESENT)
+
 IOStatus PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n,
                                          const IOOptions& /*opts*/,
                                          IODebugContext* /*dbg*/) {
@@ -97,6 +97,7 @@ const unsigned int kIoUringDepth = 256;
 
 inline void DeleteIOUring(void* p) {
   struct io_uring* iu = static_cast<struct io_uring*>(p);
+  io_uring_queue_exit(iu);
   delete iu;
 }
 
@@ -109,6 +110,29 @@ inline struct io_uring* CreateIOUring() {
   }
   return new_io_uring;
 }
+
+// State of a read submitted by PosixRandomAccessFile::ReadAsync() and
+// completed by PosixFileSystem::Poll(). These reads have a thread-local ring
+// of their own, separate from the one of MultiRead(), so that the reapers of
+// either ring only ever see completions of their own kind.
+struct Posix_IOHandle {
+  struct iovec iov;
+  struct io_uring* iu;
+  std::function<void(const FSReadRequest&, void*)> cb;
+  void* cb_arg;
+  FSReadRequest req;
+  int fd;
+  const std::string* filename;
+  bool is_finished;
+};
+
+inline void DeletePosixIOHandle(void* io_handle) {
+  delete static_cast<Posix_IOHandle*>(io_handle);
+}
+
+// Fill in the result of a completed async read, finishing a short read
+// with a synchronous pread()
+void FinishPosixIOHandle(Posix_IOHandle* handle, int res);
 #endif  // defined(ROCKSDB_IOURING_PRESENT)
 
 class PosixRandomAccessFile : public FSRandomAccessFile {
@@ -118,7 +142,9 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   bool use_direct_io_;
   size_t logical_sector_size_;
 #if defined(ROCKSDB_IOURING_PRESENT)
+  // Rings of MultiRead(), and of ReadAsync()
   ThreadLocalPtr* thread_local_io_urings_;
+  ThreadLocalPtr* thread_local_async_read_io_urings_;
 #endif
 
  public:
@@ -126,7 +152,8 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
                         const EnvOptions& options
 #if defined(ROCKSDB_IOURING_PRESENT)
                         ,
-                        ThreadLocalPtr* thread_local_io_urings
+                        ThreadLocalPtr* thread_local_io_urings,
+                        ThreadLocalPtr* thread_local_async_read_io_urings
 #endif
   );
   virtual ~PosixRandomAccessFile();
@@ -142,6 +169,16 @@ class PosixRandomAccessFile : public FSRandomAccessFile {
   virtual IOStatus Prefetch(uint64_t offset, size_t n, const IOOptions& opts,
                             IODebugContext* dbg) override;
 
+#if defined(ROCKSDB_IOURING_PRESENT)
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& opts,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) override;
+  virtual bool SupportsAsyncRead() const override {
+    return thread_local_async_read_io_urings_ != nullptr && !use_direct_io();
+  }
+#endif
+
 #if defined(OS_LINUX) || defined(OS_MACOSX) || defined(OS_AIX)
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
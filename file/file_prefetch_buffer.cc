@@ -9,8 +9,10 @@
 
 #include "file/file_prefetch_buffer.h"
 
+#include <string.h>
 #include <algorithm>
 #include <mutex>
+#include <vector>
 
 #include "file/random_access_file_reader.h"
 #include "monitoring/histogram.h"
@@ -113,17 +115,21 @@ bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
     if (readahead_size_ > 0) {
       assert(file_reader_ != nullptr);
       assert(max_readahead_size_ >= readahead_size_);
-      Status s;
-      if (for_compaction) {
-        s = Prefetch(file_reader_, offset, std::max(n, readahead_size_),
-                     for_compaction);
-      } else {
-        s = Prefetch(file_reader_, offset, n + readahead_size_, for_compaction);
-      }
-      if (!s.ok()) {
-        return false;
+      if (!TryReadFromAsyncBuffer(offset, n)) {
+        Status s;
+        if (for_compaction) {
+          s = Prefetch(file_reader_, offset, std::max(n, readahead_size_),
+                       for_compaction);
+        } else {
+          s = Prefetch(file_reader_, offset, n + readahead_size_,
+                       for_compaction);
+        }
+        if (!s.ok()) {
+          return false;
+        }
       }
       readahead_size_ = std::min(max_readahead_size_, readahead_size_ * 2);
+      ReadAheadAsync(for_compaction);
     } else {
       return false;
     }
@@ -133,4 +139,122 @@ bool FilePrefetchBuffer::TryReadFromCache(uint64_t offset, size_t n,
   *result = Slice(buffer_.BufferStart() + offset_in_buffer, n);
   return true;
 }
+
+void FilePrefetchBuffer::ReadAheadAsync(bool for_compaction) {
+  if (fs_ == nullptr || async_pending_ || buffer_.CurrentSize() == 0) {
+    return;
+  }
+  // A synchronous ReadAsync() would only read the next window ahead of time,
+  // on the critical path
+  if (!file_reader_->SupportsAsyncRead()) {
+    return;
+  }
+  if (async_read_ == nullptr) {
+    async_read_.reset(new AsyncRead());
+  }
+  AsyncRead* async_read = async_read_.get();
+  AlignedBuffer& async_buffer = async_read->buffer;
+  size_t alignment = file_reader_->file()->GetRequiredBufferAlignment();
+  size_t len = Roundup(readahead_size_, alignment);
+  async_buffer.Alignment(alignment);
+  if (async_buffer.Capacity() < len) {
+    async_buffer.AllocateNewBuffer(len);
+  }
+  async_buffer.Size(0);
+
+  FSReadRequest req;
+  req.offset = buffer_offset_ + buffer_.CurrentSize();
+  req.len = len;
+  req.scratch = async_buffer.BufferStart();
+  async_offset_ = req.offset;
+  async_pending_ = true;
+  async_read->done = false;
+  async_read->status = IOStatus::OK();
+  // Only touches *async_read, which outlives the read even if this buffer
+  // does not
+  auto read_done = [](const FSReadRequest& done_req, void* arg) {
+    AsyncRead* done_read = static_cast<AsyncRead*>(arg);
+    done_read->status = done_req.status;
+    if (done_req.status.ok()) {
+      if (done_req.result.data() != done_read->buffer.BufferStart()) {
+        memmove(done_read->buffer.BufferStart(), done_req.result.data(),
+                done_req.result.size());
+      }
+      done_read->buffer.Size(done_req.result.size());
+    }
+    done_read->done = true;
+  };
+  Status s = file_reader_->ReadAsync(req, read_done, async_read, &io_handle_,
+                                     &del_fn_, for_compaction);
+  if (!s.ok()) {
+    // Nothing is outstanding; the next miss reads synchronously.
+    async_pending_ = false;
+    io_handle_ = nullptr;
+  }
+}
+
+void FilePrefetchBuffer::WaitForAsyncRead() {
+  if (!async_pending_) {
+    return;
+  }
+  async_pending_ = false;
+  if (io_handle_ != nullptr) {
+    std::vector<void*> io_handles(1, io_handle_);
+    IOStatus s = fs_->Poll(io_handles, 1);
+    if (!s.ok() && !fs_->AbortIO(io_handles).ok()) {
+      // The read may still be outstanding
+      async_read_.release();
+      io_handle_ = nullptr;
+      return;
+    }
+    if (!s.ok()) {
+      async_read_->status = s;
+    }
+    del_fn_(io_handle_);
+    io_handle_ = nullptr;
+  }
+  if (!async_read_->done && async_read_->status.ok()) {
+    async_read_->status =
+        IOStatus::IOError("Asynchronous readahead did not finish");
+  }
+}
+
+bool FilePrefetchBuffer::TryReadFromAsyncBuffer(uint64_t offset, size_t n) {
+  if (!async_pending_) {
+    return false;
+  }
+  WaitForAsyncRead();
+  if (async_read_ == nullptr || !async_read_->status.ok()) {
+    return false;
+  }
+  AlignedBuffer& async_buffer = async_read_->buffer;
+  if (offset + n > async_offset_ + async_buffer.CurrentSize()) {
+    return false;
+  }
+  if (offset >= async_offset_) {
+    std::swap(buffer_, async_buffer);
+    buffer_offset_ = async_offset_;
+    return true;
+  }
+  if (offset < buffer_offset_ ||
+      buffer_offset_ + buffer_.CurrentSize() != async_offset_) {
+    return false;
+  }
+  // The read starts in buffer_ and ends in async_buffer: keep the tail of
+  // buffer_ from the read on, followed by async_buffer.
+  size_t alignment = buffer_.Alignment();
+  size_t chunk_offset =
+      Rounddown(static_cast<size_t>(offset - buffer_offset_), alignment);
+  size_t chunk_len = buffer_.CurrentSize() - chunk_offset;
+  size_t new_size = chunk_len + async_buffer.CurrentSize();
+  if (buffer_.Capacity() < new_size) {
+    buffer_.AllocateNewBuffer(new_size, true /* copy_data */, chunk_offset,
+                              chunk_len);
+  } else {
+    buffer_.RefitTail(chunk_offset, chunk_len);
+  }
+  buffer_.Append(async_buffer.BufferStart(), async_buffer.CurrentSize());
+  buffer_offset_ += chunk_offset;
+  return true;
+}
 }  // namespace rocksdb
@@ -9,6 +9,7 @@
 
 #pragma once
 #include <atomic>
+#include <memory>
 #include <sstream>
 #include <string>
 #include "file/random_access_file_reader.h"
@@ -36,6 +37,13 @@ class FilePrefetchBuffer {
   //   for the minimum offset if track_min_offset = true.
   // track_min_offset : Track the minimum offset ever read and collect stats on
   //   it. Used for adaptable readahead of the file footer/metadata.
+  // fs : if not nullptr, readahead is double buffered: every time the buffer
+  //   is refilled, the readahead window that follows it is submitted with
+  //   RandomAccessFileReader::ReadAsync(), and fs->Poll() only waits for it
+  //   once a read goes past the buffer. The buffer must then be used from a
+  //   single thread, as the outstanding read belongs to the thread that
+  //   submitted it. Only done if the file supports asynchronous reads (see
+  //   RandomAccessFileReader::SupportsAsyncRead()), as not with direct IO.
   //
   // Automatic readhead is enabled for a file if file_reader, readahead_size,
   // and max_readahead_size are passed in.
@@ -45,14 +53,21 @@ class FilePrefetchBuffer {
   // `Prefetch` to load data into the buffer.
   FilePrefetchBuffer(RandomAccessFileReader* file_reader = nullptr,
                      size_t readadhead_size = 0, size_t max_readahead_size = 0,
-                     bool enable = true, bool track_min_offset = false)
+                     bool enable = true, bool track_min_offset = false,
+                     FileSystem* fs = nullptr)
       : buffer_offset_(0),
         file_reader_(file_reader),
         readahead_size_(readadhead_size),
         max_readahead_size_(max_readahead_size),
         min_offset_read_(port::kMaxSizet),
         enable_(enable),
-        track_min_offset_(track_min_offset) {}
+        track_min_offset_(track_min_offset),
+        fs_(fs),
+        async_offset_(0),
+        async_pending_(false),
+        io_handle_(nullptr) {}
+
+  ~FilePrefetchBuffer() { WaitForAsyncRead(); }
 
   // Load data into the buffer from a file.
   // reader : the file reader.
@@ -79,6 +94,9 @@ class FilePrefetchBuffer {
   // tracked if track_min_offset = true.
   size_t min_offset_read() const { return min_offset_read_; }
 
+  // The readahead size used by the next prefetch from TryReadFromCache().
+  size_t readahead_size() const { return readahead_size_; }
+
  private:
   AlignedBuffer buffer_;
   uint64_t buffer_offset_;
@@ -93,5 +111,36 @@ class FilePrefetchBuffer {
   // If true, track minimum `offset` ever passed to TryReadFromCache(), which
   // can be fetched from min_offset_read().
   bool track_min_offset_;
+
+  // Submits an asynchronous read of the readahead window that follows
+  // buffer_ into async_read_->buffer, unless one is already outstanding.
+  void ReadAheadAsync(bool for_compaction);
+  // Waits for the asynchronous read, if any, and releases its handle. If it
+  // can neither be waited for nor aborted, async_read_ and the handle are
+  // leaked instead, since the read may still complete into them.
+  void WaitForAsyncRead();
+  // Waits for the asynchronous read, if any, and makes it part of buffer_
+  // if [offset, offset + n) is then in buffer_. Returns false if the caller
+  // has to read the data synchronously.
+  bool TryReadFromAsyncBuffer(uint64_t offset, size_t n);
+
+  // What an asynchronous read completes: the readahead window, read into
+  // buffer, and its status once done is set.
+  struct AsyncRead {
+    AlignedBuffer buffer;
+    bool done = false;
+    IOStatus status;
+  };
+
+  // Used to wait for asynchronous reads; nullptr if double buffering is off.
+  FileSystem* fs_;
+  // The last asynchronous read, of the window starting at async_offset_.
+  std::unique_ptr<AsyncRead> async_read_;
+  uint64_t async_offset_;
+  // True from the submission of an asynchronous read until it was waited
+  // for.
+  bool async_pending_;
+  void* io_handle_;
+  IOHandleDeleter del_fn_;
 };
 }  // namespace rocksdb
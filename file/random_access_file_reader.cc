@@ -186,4 +186,34 @@ Status RandomAccessFileReader::MultiRead(FSReadRequest* read_reqs,
 
   return s;
 }
+
+Status RandomAccessFileReader::ReadAsync(
+    FSReadRequest& req, std::function<void(const FSReadRequest&, void*)> cb,
+    void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+    bool for_compaction) const {
+  if (use_direct_io()) {
+    // Read() takes care of the alignment required by direct IO
+    Status s = Read(req.offset, req.len, &req.result, req.scratch,
+                    for_compaction);
+    req.status = s.ok() ? IOStatus::OK() : IOStatus::IOError(s.ToString());
+    *io_handle = nullptr;
+    *del_fn = nullptr;
+    cb(req, cb_arg);
+    return Status::OK();
+  }
+  if (for_compaction && rate_limiter_ != nullptr) {
+    size_t charged = 0;
+    while (charged < req.len) {
+      charged += rate_limiter_->RequestToken(
+          req.len - charged, 0 /* alignment */, Env::IOPriority::IO_LOW,
+          stats_, RateLimiter::OpType::kRead);
+    }
+  }
+  auto read_done = [cb](const FSReadRequest& done_req, void* arg) {
+    IOSTATS_ADD_IF_POSITIVE(bytes_read, done_req.result.size());
+    cb(done_req, arg);
+  };
+  return file_->ReadAsync(req, IOOptions(), read_done, cb_arg, io_handle,
+                          del_fn, nullptr);
+}
 }  // namespace rocksdb
@@ -107,6 +107,20 @@ class RandomAccessFileReader {
 
   Status MultiRead(FSReadRequest* reqs, size_t num_reqs) const;
 
+  // Start an asynchronous read. See FSRandomAccessFile::ReadAsync() for
+  // the contract. Direct IO reads are always done synchronously.
+  // for_compaction : charge the read to the rate limiter before it is
+  //   submitted.
+  Status ReadAsync(FSReadRequest& req,
+                   std::function<void(const FSReadRequest&, void*)> cb,
+                   void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                   bool for_compaction = false) const;
+
+  // Returns true if ReadAsync() can leave reads outstanding.
+  bool SupportsAsyncRead() const {
+    return !use_direct_io() && file_->SupportsAsyncRead();
+  }
+
   Status Prefetch(uint64_t offset, size_t n) const {
     return file_->Prefetch(offset, n, IOOptions(), nullptr);
   }
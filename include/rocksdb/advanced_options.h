@@ -128,21 +128,35 @@ struct CompressionOptions {
   // Default: false.
   bool enabled;
 
+  // Number of threads used to compress data blocks while building a
+  // block-based table. When greater than 1, data blocks are handed to a pool
+  // of `parallel_threads` compression threads and written back to the file in
+  // their original order, so the resulting file is identical to one built
+  // with serial compression. Useful with expensive compression settings such
+  // as high ZSTD levels, where flush and compaction are otherwise bound by a
+  // single core.
+  //
+  // Default: 1 (compression happens on the thread building the table).
+  uint32_t parallel_threads;
+
   CompressionOptions()
       : window_bits(-14),
         level(kDefaultCompressionLevel),
         strategy(0),
         max_dict_bytes(0),
         zstd_max_train_bytes(0),
-        enabled(false) {}
+        enabled(false),
+        parallel_threads(1) {}
   CompressionOptions(int wbits, int _lev, int _strategy, int _max_dict_bytes,
-                     int _zstd_max_train_bytes, bool _enabled)
+                     int _zstd_max_train_bytes, bool _enabled,
+                     uint32_t _parallel_threads = 1)
       : window_bits(wbits),
         level(_lev),
         strategy(_strategy),
         max_dict_bytes(_max_dict_bytes),
         zstd_max_train_bytes(_zstd_max_train_bytes),
-        enabled(_enabled) {}
+        enabled(_enabled),
+        parallel_threads(_parallel_threads) {}
 };
 
 enum UpdateStatus {    // Return status For inplace update callback
@@ -296,6 +310,23 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   bool memtable_whole_key_filtering = false;
 
+  // If not 0, each memtable keeps a hash index from user key to the newest
+  // entry of that key, with write_buffer_size *
+  // memtable_hash_index_size_ratio bytes of buckets plus 24 bytes for every
+  // distinct user key. Point lookups that find a Put or Delete no newer than
+  // their snapshot in the index, or find no entry at all, skip searching the
+  // memtable; other lookups and iterators search the memtable as before.
+  // If it is larger than 0.25, it is sanitized to 0.25.
+  //
+  // The index is not used with inplace_update_support, with user-defined
+  // timestamps, or with comparators that can consider keys with different
+  // bytes equal.
+  //
+  // Default: 0 (disable)
+  //
+  // Dynamically changeable through SetOptions() API
+  double memtable_hash_index_size_ratio = 0.0;
+
   // Page size for huge page for the arena used by the memtable. If <=0, it
   // won't allocate from huge page but from malloc.
   // Users are responsible to reserve huge pages for it to be allocated. For
@@ -699,6 +730,66 @@ struct AdvancedColumnFamilyOptions {
   // data is left uncompressed (unless compression is also requested).
   uint64_t sample_for_compression = 0;
 
+  // The following options control key-value separation ("blob files"). When
+  // enabled, flush and compaction write the values of at least min_blob_size
+  // bytes to separate blob files, and store in the SST files only a small
+  // reference to them. This reduces write amplification for large values,
+  // since compactions only rewrite the references. Blob files are tracked in
+  // the MANIFEST along with the SST files, and reads resolve references
+  // transparently. Not supported in ROCKSDB_LITE.
+  //
+  // NOTE: unlike the StackableDB BlobDB (utilities/blob_db), this does not
+  // need a special DB class, but it does not support TTL for blobs either.
+  // Compaction filters see the blob references of the values that were
+  // separated, as ValueType::kBlobIndex.
+
+  // Write large values to blob files in flush and compaction.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool enable_blob_files = false;
+
+  // Values smaller than this are stored in the SST files as usual.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through SetOptions() API
+  uint64_t min_blob_size = 0;
+
+  // A blob file is closed, and a new one started, once it reaches this size.
+  //
+  // Default: 256MB
+  //
+  // Dynamically changeable through SetOptions() API
+  uint64_t blob_file_size = 1ULL << 28;
+
+  // Compression applied to each blob.
+  //
+  // Default: no compression
+  //
+  // Dynamically changeable through SetOptions() API
+  CompressionType blob_compression_type;
+
+  // Relocate, in compaction, the blobs that are still referenced from the
+  // oldest blob files, so that these files get fully garbage and deleted.
+  // Without it, a blob file is only deleted once all its blobs have been
+  // overwritten or deleted.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool enable_blob_garbage_collection = false;
+
+  // The fraction of the blob files, by age, that are subject to garbage
+  // collection: with 0.25, the blobs of the oldest 25% of the blob files
+  // are relocated by the compactions that encounter them.
+  //
+  // Default: 0.25
+  //
+  // Dynamically changeable through SetOptions() API
+  double blob_garbage_collection_age_cutoff = 0.25;
+
   // Create ColumnFamilyOptions with default values for all fields
   AdvancedColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <functional>
 #include <memory>
 #include <string>
 #include "rocksdb/memory_allocator.h"
@@ -33,6 +34,7 @@
 namespace rocksdb {
 
 class Cache;
+class SecondaryCache;
 
 extern const bool kDefaultToAdaptiveMutex;
 
@@ -86,6 +88,13 @@ struct LRUCacheOptions {
   CacheMetadataChargePolicy metadata_charge_policy =
       kDefaultCacheMetadataChargePolicy;
 
+  // If non-nullptr, entries evicted from the cache for lack of capacity are
+  // handed to this secondary cache tier, and lookups that miss in the cache
+  // consult it before reporting a miss. Only entries inserted with a
+  // Cache::CacheItemHelper can be moved to and from the secondary cache.
+  // See rocksdb/secondary_cache.h.
+  std::shared_ptr<SecondaryCache> secondary_cache;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -121,15 +130,22 @@ extern std::shared_ptr<Cache> NewLRUCache(
 extern std::shared_ptr<Cache> NewLRUCache(const LRUCacheOptions& cache_opts);
 
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
-// better concurrent performance in some cases. See util/clock_cache.cc for
-// more detail.
+// better concurrent performance. Lookups and releases are lock-free. See
+// cache/clock_cache.h for more detail.
+//
+// Each shard keeps its entries in a hash table with a fixed number of slots,
+// sized from the capacity and estimated_entry_charge, the expected average
+// charge of an entry (4KB if 0, i.e. about one data block). If the entries
+// are much smaller than estimated, the table fills up before the capacity is
+// used, and entries get evicted early.
 //
-// Return nullptr if it is not supported.
+// Return nullptr if num_shard_bits is too large.
 extern std::shared_ptr<Cache> NewClockCache(
     size_t capacity, int num_shard_bits = -1,
     bool strict_capacity_limit = false,
     CacheMetadataChargePolicy metadata_charge_policy =
-        kDefaultCacheMetadataChargePolicy);
+        kDefaultCacheMetadataChargePolicy,
+    size_t estimated_entry_charge = 0);
 class Cache {
  public:
   // Depending on implementation, cache entries with high priority could be less
@@ -151,6 +167,40 @@ class Cache {
   // Opaque handle to an entry stored in the cache.
   struct Handle {};
 
+  // The following callbacks let the cache move an entry to and from a
+  // SecondaryCache, which stores entries as flat byte buffers.
+  //
+  // SizeCallback returns the number of bytes needed to serialize the object.
+  using SizeCallback = size_t (*)(void* obj);
+
+  // SaveToCallback copies `length` bytes of the serialized object, starting
+  // at `from_offset`, into the buffer `out`.
+  using SaveToCallback = Status (*)(void* from_obj, size_t from_offset,
+                                    size_t length, void* out);
+
+  // Same as the deleter passed to Insert().
+  using DeleterFn = void (*)(const Slice& key, void* value);
+
+  // A set of callbacks describing how to serialize and delete one type of
+  // cached object. Usually a single static instance exists per object type.
+  struct CacheItemHelper {
+    SizeCallback size_cb;
+    SaveToCallback saveto_cb;
+    DeleterFn del_cb;
+
+    CacheItemHelper() : size_cb(nullptr), saveto_cb(nullptr), del_cb(nullptr) {}
+    CacheItemHelper(SizeCallback _size_cb, SaveToCallback _saveto_cb,
+                    DeleterFn _del_cb)
+        : size_cb(_size_cb), saveto_cb(_saveto_cb), del_cb(_del_cb) {}
+  };
+
+  // Rebuilds an object from the buffer previously produced by a
+  // SaveToCallback. On success, sets *out_obj to the new object and *charge
+  // to its charge against the cache capacity. The buffer is only valid for
+  // the duration of the call.
+  using CreateCallback = std::function<Status(const void* buf, size_t size,
+                                              void** out_obj, size_t* charge)>;
+
   // The type of the Cache
   virtual const char* Name() const = 0;
 
@@ -174,6 +224,19 @@ class Cache {
                         Handle** handle = nullptr,
                         Priority priority = Priority::LOW) = 0;
 
+  // Same as Insert() above, but the entry can be moved to a secondary cache
+  // tier when it is evicted. The deleter is helper->del_cb. Caches without a
+  // secondary tier treat this as a plain Insert().
+  virtual Status Insert(const Slice& key, void* value,
+                        const CacheItemHelper* helper, size_t charge,
+                        Handle** handle = nullptr,
+                        Priority priority = Priority::LOW) {
+    if (helper == nullptr) {
+      return Status::InvalidArgument("Cache item helper must not be null");
+    }
+    return Insert(key, value, charge, helper->del_cb, handle, priority);
+  }
+
   // If the cache has no mapping for "key", returns nullptr.
   //
   // Else return a handle that corresponds to the mapping.  The caller
@@ -183,6 +246,30 @@ class Cache {
   // function.
   virtual Handle* Lookup(const Slice& key, Statistics* stats = nullptr) = 0;
 
+  // Same as Lookup() above, but on a miss the secondary cache tier, if any,
+  // is consulted. A hit there is rebuilt with create_cb and promoted back into
+  // this cache with the given priority.
+  //
+  // If wait is false, the secondary lookup may still be in progress when this
+  // returns. Such a handle must be passed to Wait() before Value() is called,
+  // and Value() returns nullptr if the secondary lookup ended up failing; the
+  // handle must be released either way. Handles of pending lookups cannot be
+  // passed to Ref().
+  virtual Handle* Lookup(const Slice& key, const CacheItemHelper* /*helper*/,
+                         const CreateCallback& /*create_cb*/,
+                         Priority /*priority*/, bool /*wait*/,
+                         Statistics* stats = nullptr) {
+    return Lookup(key, stats);
+  }
+
+  // Returns false if the handle came from a Lookup() with wait == false
+  // whose secondary cache lookup has not completed yet.
+  virtual bool IsReady(Handle* /*handle*/) { return true; }
+
+  // Blocks until the lookup that produced the handle is complete, and
+  // promotes the result into the cache.
+  virtual void Wait(Handle* /*handle*/) {}
+
   // Increments the reference count for the handle if it refers to an entry in
   // the cache. Returns true if refcount was incremented; otherwise, returns
   // false.
@@ -114,6 +114,11 @@ namespace rocksdb {
 //     [Example]:
 //     * {"memtable", "skip_list:5"} is equivalent to setting
 //       memtable to SkipListFactory(5).
+//   - BTree:
+//     Pass "btree" to config memtable to use BTreeRepFactory.
+//     [Example]:
+//     * {"memtable", "btree"} is equivalent to setting memtable to
+//       BTreeRepFactory().
 //   - PrefixHash:
 //     Pass "prfix_hash:<hash_bucket_count>" to config memtable
 //     to use PrefixHash, or simply "prefix_hash" to use the default
@@ -219,6 +219,22 @@ class DB {
       const std::vector<ColumnFamilyDescriptor>& column_families,
       std::vector<ColumnFamilyHandle*>* handles, DB** dbptr);
 
+  // Runs, typically in a worker process, a compaction that the DB "name"
+  // handed to its CompactionService (see DBOptions::compaction_service).
+  // "input" is the compaction input string the service got from the DB. The
+  // DB is opened as a secondary instance, the output files are written to
+  // output_directory (created if missing), and *output is set to the string
+  // the service must hand back to the DB, which tells the DB where the
+  // output files are and whether the compaction failed. The DB is closed
+  // before returning.
+  //
+  // Not supported in ROCKSDB_LITE, in which case the function will
+  // return Status::NotSupported.
+  static Status OpenAndCompact(
+      const std::string& name, const std::string& output_directory,
+      const std::string& input, std::string* output,
+      const CompactionServiceOptionsOverride& override_options);
+
   // Open DB with column families.
   // db_options specify database specific options
   // column_families is the vector of all column families in the database,
@@ -578,6 +594,31 @@ class DB {
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) = 0;
 
+  // Splits the keys of column_family in [options.iterate_lower_bound,
+  // options.iterate_upper_bound) (a nullptr bound leaves that side open) into
+  // at most num_shards consecutive ranges holding roughly the same amount of
+  // data, and returns in *iterators one iterator per range, in key order.
+  // Each iterator is bounded to its range, so that SeekToFirst() and
+  // SeekToLast() position it at the first and last key of the range. All the
+  // iterators read the same state of the column family, the one of
+  // options.snapshot if it is set, and each may be used from a different
+  // thread.
+  //
+  // The ranges are split at SST file boundaries and at keys sampled from the
+  // index of the SST files. Data in the memtables is accounted for in the
+  // sizes of the ranges but is not sampled, so fewer than num_shards
+  // iterators are returned when the files are too few or too small to split
+  // the range finely enough.
+  //
+  // Iterators are heap allocated and need to be deleted before the db is
+  // deleted.
+  virtual Status NewShardedIterators(const ReadOptions& /*options*/,
+                                     ColumnFamilyHandle* /*column_family*/,
+                                     size_t /*num_shards*/,
+                                     std::vector<Iterator*>* /*iterators*/) {
+    return Status::NotSupported("NewShardedIterators() not supported.");
+  }
+
   // Return a handle to the current DB state.  Iterators created with
   // this handle will all observe a stable snapshot of the current DB
   // state.  The caller must call ReleaseSnapshot(result) when the
@@ -786,6 +827,23 @@ class DB {
     //  "rocksdb.is-write-stopped" - Return 1 if write has been stopped.
     static const std::string kIsWriteStopped;
 
+    //  "rocksdb.secondary-seconds-since-catch-up" - returns the number of
+    //      seconds since TryCatchUpWithPrimary() last succeeded on a secondary
+    //      instance, or since it was opened. This is not the lag behind the
+    //      primary, which may have written more since. Only available for
+    //      secondary instances.
+    static const std::string kSecondarySecondsSinceCatchUp;
+
+    //  "rocksdb.secondary-replayed-wal-bytes" - returns the total size of the
+    //      WAL records a secondary instance has replayed since it was opened.
+    //      Only available for secondary instances.
+    static const std::string kSecondaryReplayedWalBytes;
+
+    //  "rocksdb.secondary-wal-dir-listings" - returns the number of times a
+    //      secondary instance has listed wal_dir to look for new WAL files.
+    //      Only available for secondary instances.
+    static const std::string kSecondaryWalDirListings;
+
     //  "rocksdb.estimate-oldest-key-time" - returns an estimation of
     //      oldest key timestamp in the DB. Currently only available for
     //      FIFO compaction with
@@ -858,6 +916,9 @@ class DB {
   //  "rocksdb.num-running-flushes"
   //  "rocksdb.actual-delayed-write-rate"
   //  "rocksdb.is-write-stopped"
+  //  "rocksdb.secondary-seconds-since-catch-up"
+  //  "rocksdb.secondary-replayed-wal-bytes"
+  //  "rocksdb.secondary-wal-dir-listings"
   //  "rocksdb.estimate-oldest-key-time"
   //  "rocksdb.block-cache-capacity"
   //  "rocksdb.block-cache-usage"
@@ -1163,7 +1224,8 @@ class DB {
 
   // GetLiveFiles followed by GetSortedWalFiles can generate a lossless backup
 
-  // Retrieve the list of all files in the database. The files are
+  // Retrieve the list of all files in the database, including the blob files
+  // of AdvancedColumnFamilyOptions::enable_blob_files. The files are
   // relative to the dbname and are not absolute paths. Despite being relative
   // paths, the file names begin with "/". The valid size of the manifest file
   // is returned in manifest_file_size. The manifest file is an ever growing
@@ -1228,7 +1290,7 @@ class DB {
   virtual Status DeleteFile(std::string name) = 0;
 
   // Returns a list of all table files with their level, start key
-  // and end key
+  // and end key. Blob files are not included; GetLiveFiles() lists them.
   virtual void GetLiveFilesMetaData(
       std::vector<LiveFileMetaData>* /*metadata*/) {}
 
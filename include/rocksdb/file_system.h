@@ -47,6 +47,9 @@ class RateLimiter;
 using AccessPattern = RandomAccessFile::AccessPattern;
 using FileAttributes = Env::FileAttributes;
 
+// Frees an IO handle returned by FSRandomAccessFile::ReadAsync()
+using IOHandleDeleter = std::function<void(void*)>;
+
 // Priority of an IO request. This is a hint and does not guarantee any
 // particular QoS.
 // IO_LOW - Typically background reads/writes such as compaction/flush
@@ -486,6 +489,34 @@ class FileSystem {
     return IOStatus::NotSupported();
   }
 
+  // Wait for the asynchronous reads identified by io_handles, as returned
+  // by FSRandomAccessFile::ReadAsync(), until at least min_completions of
+  // them have completed. The callback of each request is invoked from
+  // within Poll() as it completes. Handles are not freed by Poll(); that is
+  // up to the caller, using the deleter returned along with the handle.
+  // Must be called from the thread that issued the reads.
+  // The default implementation is a no-op, since the default ReadAsync()
+  // completes every read before returning.
+  virtual IOStatus Poll(std::vector<void*>& /*io_handles*/,
+                        size_t /*min_completions*/) {
+    return IOStatus::OK();
+  }
+
+  // Cancel the asynchronous reads identified by io_handles that have not
+  // completed yet, and wait until none of them can still write into its
+  // buffer. The callback of every read is invoked before this returns, with
+  // a non-ok status if the read was cancelled. Must be called from the
+  // thread that issued the reads.
+  // Only once this returns OK may the handles and the buffers of the reads
+  // be freed. Otherwise some reads may still be outstanding, and their
+  // handles and buffers must be left alone, even if that leaks them.
+  // The default implementation returns NotSupported, so that the reads of
+  // a file system that overrides Poll() but not this are never freed while
+  // they may still be outstanding.
+  virtual IOStatus AbortIO(std::vector<void*>& /*io_handles*/) {
+    return IOStatus::NotSupported("AbortIO");
+  }
+
   // If you're adding methods here, remember to add them to EnvWrapper too.
 
  private:
@@ -613,6 +644,36 @@ class FSRandomAccessFile {
     return IOStatus::OK();
   }
 
+  // Start reading req.len bytes at req.offset into req.scratch, and return
+  // without waiting for the data if the implementation supports it. Once
+  // the read is done, cb is invoked with the completed request (result and
+  // status filled in) and cb_arg. The request is copied, so req does not
+  // need to outlive this call, but req.scratch does.
+  //
+  // If the read was left outstanding, *io_handle identifies it and must be
+  // passed to FileSystem::Poll() to complete it, and then freed with
+  // *del_fn. Otherwise *io_handle is set to nullptr and cb has already been
+  // invoked when ReadAsync() returns.
+  //
+  // The default implementation performs a synchronous Read().
+  virtual IOStatus ReadAsync(
+      FSReadRequest& req, const IOOptions& opts,
+      std::function<void(const FSReadRequest&, void*)> cb, void* cb_arg,
+      void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+    req.status =
+        Read(req.offset, req.len, opts, &req.result, req.scratch, dbg);
+    *io_handle = nullptr;
+    *del_fn = nullptr;
+    cb(req, cb_arg);
+    return IOStatus::OK();
+  }
+
+  // Returns true if ReadAsync() can leave reads outstanding, rather than
+  // always completing them before it returns like the default
+  // implementation. Speculative reads, such as asynchronous readahead, are
+  // only issued when it does.
+  virtual bool SupportsAsyncRead() const { return false; }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
@@ -1149,6 +1210,13 @@ class FileSystemWrapper : public FileSystem {
                         uint64_t* diskfree, IODebugContext* dbg) override {
     return target_->GetFreeSpace(path, options, diskfree, dbg);
   }
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override {
+    return target_->Poll(io_handles, min_completions);
+  }
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    return target_->AbortIO(io_handles);
+  }
 
  private:
   FileSystem* target_;
@@ -1199,6 +1267,15 @@ class FSRandomAccessFileWrapper : public FSRandomAccessFile {
                     IODebugContext* dbg) override {
     return target_->Prefetch(offset, n, options, dbg);
   }
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override {
+    return target_->ReadAsync(req, opts, cb, cb_arg, io_handle, del_fn, dbg);
+  }
+  bool SupportsAsyncRead() const override {
+    return target_->SupportsAsyncRead();
+  }
   size_t GetUniqueId(char* id, size_t max_size) const override {
     return target_->GetUniqueId(id, max_size);
   };
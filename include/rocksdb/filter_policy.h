@@ -196,4 +196,25 @@ class FilterPolicy {
 // trailing spaces in keys.
 extern const FilterPolicy* NewBloomFilterPolicy(
     double bits_per_key, bool use_block_based_builder = false);
+
+// Return a new filter policy that uses a Ribbon filter, for full and
+// partitioned filters. A Ribbon filter takes about 25-30% less memory than
+// a Bloom filter with the same false positive rate, but takes several times
+// more CPU to build, and somewhat more to query (it reads 2-3 adjacent cache
+// lines instead of one). Useful when filters take a large share of the
+// block cache, and the saved memory is worth more than the CPU.
+//
+// bloom_equivalent_bits_per_key: the filter has about the false positive
+// rate of a Bloom filter (format_version >= 5) with this many bits per key,
+// e.g. ~1% for 10, in fewer bits per key.
+//
+// Filters built with either of NewBloomFilterPolicy() and
+// NewRibbonFilterPolicy() can be read with the other. Versions of RocksDB
+// without Ribbon support read Ribbon filters as filters that always match.
+//
+// Callers must delete the result after any database that is using the
+// result has been closed. The same note on custom comparators as for
+// NewBloomFilterPolicy() applies.
+extern const FilterPolicy* NewRibbonFilterPolicy(
+    double bloom_equivalent_bits_per_key);
 }  // namespace rocksdb
@@ -326,6 +326,24 @@ class SkipListFactory : public MemTableRepFactory {
   const size_t lookahead_;
 };
 
+// This creates MemTableReps that are backed by a B+-tree with nodes of up to
+// 32 entries. Compared to the skip list, searches and scans touch fewer
+// cache lines, which matters most with large write buffers. It supports
+// concurrent inserts; readers never block writers, and writers only wait
+// for each other when they modify the same nodes.
+class BTreeRepFactory : public MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+  virtual MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&,
+                                         Allocator*, const SliceTransform*,
+                                         Logger* logger) override;
+  virtual const char* Name() const override { return "BTreeRepFactory"; }
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 #ifndef ROCKSDB_LITE
 // This creates MemTableReps that are backed by an std::vector. On iteration,
 // the vector is sorted. This is useful for workloads where iteration is very
@@ -346,6 +346,45 @@ struct DbPath {
   DbPath(const std::string& p, uint64_t t) : path(p), target_size(t) {}
 };
 
+// The outcome of a compaction job handed to a CompactionService.
+enum class CompactionServiceJobStatus : char {
+  kSuccess,
+  kFailure,
+  // The service declines the job: the DB runs the compaction itself.
+  kUseLocal,
+};
+
+// Runs compactions outside of the DB process, e.g. in a worker process on
+// another host reading the same file system, to keep compaction CPU off the
+// machine serving the DB. For each compaction (or subcompaction) to run, the
+// DB calls Start() and then WaitForComplete() from its compaction thread.
+// The service passes the input string to DB::OpenAndCompact() in the worker,
+// and the output string of that call back to the DB, which then installs the
+// output files.
+//
+// The input files of the compaction, and the output directory given to
+// DB::OpenAndCompact(), must be accessible to both the DB and the worker,
+// and the output directory must be on the same file system as the DB, as
+// the output files are renamed into the DB.
+//
+// The service is called from several threads at the same time.
+class CompactionService {
+ public:
+  virtual ~CompactionService() {}
+
+  virtual const char* Name() const = 0;
+
+  // Starts the compaction job described by compaction_service_input. job_id
+  // is unique among the jobs of the DB in progress.
+  virtual CompactionServiceJobStatus Start(
+      const std::string& compaction_service_input, uint64_t job_id) = 0;
+
+  // Waits for the job started with job_id to finish, and sets
+  // *compaction_service_result to the output of DB::OpenAndCompact().
+  virtual CompactionServiceJobStatus WaitForComplete(
+      uint64_t job_id, std::string* compaction_service_result) = 0;
+};
+
 struct DBOptions {
   // The function recovers options to the option as in version 4.6.
   DBOptions* OldDefaults(int rocksdb_major_version = 4,
@@ -561,6 +600,10 @@ struct DBOptions {
   // This value represents the maximum number of threads that will
   // concurrently perform a compaction job by breaking it into multiple,
   // smaller ones that are run simultaneously.
+  // Level compactions from L0 and manual level compactions are split when
+  // their output level is not empty, as are universal compactions into a
+  // level other than L0. Compactions into L0 are not split, since every
+  // subcompaction would add an L0 file.
   // Default: 1 (i.e. no subcompactions)
   uint32_t max_subcompactions = 1;
 
@@ -935,14 +978,26 @@ struct DBOptions {
 
   // If true, allow multi-writers to update mem tables in parallel.
   // Only some memtable_factory-s support concurrent writes; currently it
-  // is implemented only for SkipListFactory.  Concurrent memtable writes
-  // are not compatible with inplace_update_support or filter_deletes.
+  // is implemented only for SkipListFactory and BTreeRepFactory.  Concurrent
+  // memtable writes are not compatible with inplace_update_support or
+  // filter_deletes.
   // It is strongly recommended to set enable_write_thread_adaptive_yield
   // if you are going to use this feature.
   //
   // Default: true
   bool allow_concurrent_memtable_write = true;
 
+  // If greater than 1, and allow_concurrent_memtable_write is true, the
+  // memtable inserts of a large WriteBatch are split into up to this many
+  // chunks of consecutive records, which are inserted concurrently by the
+  // writing thread and threads started for the write. Each chunk gets at
+  // least 1000 records, and the records keep the sequence numbers they would
+  // get from a serial insert. Batches with merge operands, transaction
+  // markers, or written with seq_per_batch, are always inserted serially.
+  //
+  // Default: 1
+  size_t max_memtable_insert_threads_per_batch = 1;
+
   // If true, threads synchronizing with the write batch group leader will
   // wait for up to write_thread_max_yield_usec before blocking on a mutex.
   // This can substantially improve throughput for concurrent workloads,
@@ -995,10 +1050,41 @@ struct DBOptions {
   // Default: false
   bool skip_checking_sst_file_sizes_on_db_open = false;
 
+  // If true, then DB::Open() will not open the sst files even when
+  // max_open_files is -1. The files are opened on first access instead, and
+  // their table readers are kept in the table cache from then on. Until
+  // then, the file boundaries and sizes recorded in the MANIFEST are all
+  // that is known about them. This makes opening a DB with many sst files
+  // take time proportional to the size of the MANIFEST, at the cost of a
+  // slower first access to each file. Set skip_stats_update_on_db_open and
+  // skip_checking_sst_file_sizes_on_db_open as well to avoid all the sst
+  // file I/O at open. Cannot be used with the ttl of FIFO compaction, which
+  // only sees the creation time of files that are open.
+  //
+  // Default: false
+  bool skip_opening_sst_files_on_db_open = false;
+
   // Recovery mode to control the consistency while replaying WAL
   // Default: kPointInTimeRecovery
   WALRecoveryMode wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
 
+  // If greater than 1, DB::Open() reads, checksums and uncompresses the
+  // records of each WAL file on a thread of its own, ahead of the thread
+  // inserting them into the memtables, so that reading goes on during the
+  // flushes recovery triggers. If greater than 2, and
+  // allow_concurrent_memtable_write is true, consecutive write batches are
+  // also inserted concurrently by the recovering thread and up to
+  // wal_recovery_threads - 2 more threads. Each record keeps its sequence
+  // number, so the recovered data is the same as with serial recovery, but
+  // a memtable may grow past write_buffer_size by up to 1MB of batches
+  // before it is flushed. Batches with merge operands or transaction markers
+  // are inserted serially, and so are all the batches of a DB with a
+  // wal_filter, or written with seq_per_batch. Secondary instances always
+  // recover serially.
+  //
+  // Default: 1
+  size_t wal_recovery_threads = 1;
+
   // if set to false then recovery will fail when a prepared
   // transaction is encountered in the WAL
   bool allow_2pc = false;
@@ -1083,6 +1169,16 @@ struct DBOptions {
   // file.
   bool manual_wal_flush = false;
 
+  // If not kNoCompression, the records of new WAL files are compressed with
+  // this compression type. A single compression context is used for all the
+  // records of a WAL file, so that small write batches also compress well.
+  // Only kZSTD and kZlibCompression are supported. WAL files record their
+  // compression type, so they can be read whatever this option is set to,
+  // but not by older versions of RocksDB.
+  //
+  // Default: kNoCompression
+  CompressionType wal_compression = kNoCompression;
+
   // If true, RocksDB supports flushing multiple column families and committing
   // their results atomically to MANIFEST. Note that it is not
   // necessary to set atomic_flush to true if WAL is always enabled since WAL
@@ -1122,6 +1218,42 @@ struct DBOptions {
   //
   // Default: 0
   size_t log_readahead_size = 0;
+
+  // Only used by secondary instances. If true, TryCatchUpWithPrimary() lists
+  // wal_dir to look for new WAL files only when the modification time of
+  // wal_dir has changed since the last listing, and otherwise just continues
+  // reading the latest WAL file. Requires an Env whose
+  // GetFileModificationTime() works on directories and reflects files being
+  // created, deleted and renamed in them, as is the case for POSIX file
+  // systems. Only modification times are compared, so the clocks of the
+  // primary and secondary hosts need not agree. wal_dir is still listed
+  // until the latest WAL file has been written to in a later second than
+  // the last change to wal_dir.
+  //
+  // Default: false
+  bool skip_listing_unchanged_wal_dir = false;
+
+  // If true, compactions read their input files through a double buffer when
+  // compaction_readahead_size is non-zero: while the current readahead is
+  // consumed, the next one is already being read asynchronously through
+  // FSRandomAccessFile::ReadAsync() (io_uring on Linux), and the compaction
+  // only waits if it catches up with it. See ReadOptions::async_io for user
+  // iterators. Has no effect unless the files support asynchronous reads
+  // (FSRandomAccessFile::SupportsAsyncRead()), which excludes direct IO and
+  // the Posix file system built without io_uring.
+  //
+  // Default: false
+  bool async_compaction_readahead = false;
+
+  // If set, compactions are handed to the service to run, typically in
+  // another process (see CompactionService). Not supported with
+  // enable_blob_files or with WritePrepared/WriteUnprepared transactions:
+  // these compactions are run locally.
+  //
+  // Not supported in ROCKSDB_LITE mode!
+  //
+  // Default: nullptr
+  std::shared_ptr<CompactionService> compaction_service = nullptr;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1158,6 +1290,22 @@ struct Options : public DBOptions, public ColumnFamilyOptions {
   Options* OptimizeForSmallDb();
 };
 
+// The options of a compaction run by DB::OpenAndCompact() that cannot be
+// carried in the compaction input string, as they are objects of the
+// application. They must match the options of the DB that handed out the
+// compaction. The table factory, if not set, is rebuilt from the options
+// string, which only works for the built-in table factories.
+struct CompactionServiceOptionsOverride {
+  Env* env = Env::Default();
+  // Default: the bytewise comparator
+  const Comparator* comparator = nullptr;
+  std::shared_ptr<MergeOperator> merge_operator = nullptr;
+  const CompactionFilter* compaction_filter = nullptr;
+  std::shared_ptr<CompactionFilterFactory> compaction_filter_factory = nullptr;
+  std::shared_ptr<const SliceTransform> prefix_extractor = nullptr;
+  std::shared_ptr<TableFactory> table_factory = nullptr;
+};
+
 //
 // An application can issue a read request (via Get/Iterators) and specify
 // if that read should process data that ALREADY resides on a specified cache
@@ -1319,6 +1467,31 @@ struct ReadOptions {
   // and the API is subject to change.
   const Slice* timestamp;
 
+  // If true, MultiGet() plans the lookups in all the files of a level
+  // (other than level 0) before doing any IO, and issues the data block
+  // reads for all of them as one batch of asynchronous reads. This cuts the
+  // latency of MultiGet() batches that span many files when the file system
+  // supports asynchronous reads (FSRandomAccessFile::ReadAsync()), such as
+  // the default Posix file system built with io_uring. Otherwise the reads
+  // are done synchronously, one file at a time.
+  // Iterators that read through a prefetch buffer (with readahead_size) also
+  // read the next readahead window asynchronously while the current one is
+  // consumed, if the file supports asynchronous reads
+  // (FSRandomAccessFile::SupportsAsyncRead(), never with direct IO). Such
+  // iterators must then be used from a single thread.
+  // Default: false
+  bool async_io;
+
+  // If true, iterators over a block-based table file start their implicit
+  // auto-readahead at the size the previous such iterator over the same file
+  // had reached, instead of at 8KB, and shrink it again after iterators that
+  // only read a few blocks. Each readahead is also issued when the iterator
+  // is half way through the previous one, so the next window is being read
+  // while the current one is consumed. Has no effect with an explicit
+  // readahead_size.
+  // Default: false
+  bool adaptive_readahead;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -0,0 +1,122 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// A SecondaryCache is a second tier below a block cache such as LRUCache. It
+// receives entries evicted from the primary cache for lack of capacity, and
+// is consulted when a lookup misses in the primary cache. Entries are moved
+// between the tiers as flat byte buffers through the Cache::CacheItemHelper
+// callbacks, so a secondary cache can keep them compressed in memory, on a
+// local flash device, or anywhere else that is cheaper than re-reading the
+// SST file.
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/cache.h"
+#include "rocksdb/memory_allocator.h"
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// The result of a SecondaryCache::Lookup(). The lookup may complete
+// asynchronously, in which case the object is not available until IsReady()
+// returns true or Wait() has returned.
+class SecondaryCacheResultHandle {
+ public:
+  virtual ~SecondaryCacheResultHandle() {}
+
+  // Returns whether the lookup is complete.
+  virtual bool IsReady() = 0;
+
+  // Blocks until the lookup is complete.
+  virtual void Wait() = 0;
+
+  // Returns the object built by the create callback, or nullptr if the
+  // lookup failed. Ownership passes to the caller.
+  // REQUIRES: IsReady() is true.
+  virtual void* Value() = 0;
+
+  // Returns the charge of the object, as reported by the create callback.
+  // REQUIRES: IsReady() is true.
+  virtual size_t Size() = 0;
+};
+
+// A secondary cache tier. Implementations must be thread-safe.
+class SecondaryCache {
+ public:
+  virtual ~SecondaryCache() {}
+
+  virtual const char* Name() const = 0;
+
+  // Saves the object, which is serialized with helper->size_cb and
+  // helper->saveto_cb. The object remains owned by the caller. A secondary
+  // cache is free to drop the entry, so failures are only informational.
+  virtual Status Insert(const Slice& key, void* value,
+                        const Cache::CacheItemHelper* helper) = 0;
+
+  // Looks up the key and, on a hit, rebuilds the object with create_cb.
+  // Returns nullptr if the key is known to be absent. If wait is false, the
+  // lookup may complete asynchronously, and the result handle must be waited
+  // on before the object is retrieved.
+  virtual std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CreateCallback& create_cb, bool wait) = 0;
+
+  // Removes the key, if present.
+  virtual void Erase(const Slice& key) = 0;
+
+  // Waits for all of the given lookups to complete.
+  virtual void WaitAll(std::vector<SecondaryCacheResultHandle*> handles) {
+    for (SecondaryCacheResultHandle* handle : handles) {
+      handle->Wait();
+    }
+  }
+
+  virtual std::string GetPrintableOptions() const { return ""; }
+};
+
+struct CompressedSecondaryCacheOptions {
+  // Capacity of the secondary cache, charged by compressed size.
+  size_t capacity = 0;
+
+  // The cache is sharded into 2^num_shard_bits shards, as for NewLRUCache().
+  int num_shard_bits = -1;
+
+  // Compression used for the cached entries. Entries are stored
+  // uncompressed if the compression is not supported or does not reduce
+  // their size.
+  CompressionType compression_type = kLZ4Compression;
+
+  // Compression format version passed to the compression library wrappers.
+  uint32_t compress_format_version = 2;
+
+  // If non-nullptr, used to allocate the decompressed buffers.
+  std::shared_ptr<MemoryAllocator> memory_allocator;
+
+  CompressedSecondaryCacheOptions() {}
+  CompressedSecondaryCacheOptions(
+      size_t _capacity, int _num_shard_bits = -1,
+      CompressionType _compression_type = kLZ4Compression,
+      uint32_t _compress_format_version = 2,
+      std::shared_ptr<MemoryAllocator> _memory_allocator = nullptr)
+      : capacity(_capacity),
+        num_shard_bits(_num_shard_bits),
+        compression_type(_compression_type),
+        compress_format_version(_compress_format_version),
+        memory_allocator(std::move(_memory_allocator)) {}
+};
+
+// Create a secondary cache that keeps evicted entries compressed in memory,
+// in an LRU order of its own. Entries found in it are removed on lookup,
+// since the caller promotes them back into the primary cache.
+extern std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
+    const CompressedSecondaryCacheOptions& opts);
+
+}  // namespace rocksdb
@@ -342,6 +342,15 @@ enum Tickers : uint32_t {
   BLOCK_CACHE_COMPRESSION_DICT_ADD,
   BLOCK_CACHE_COMPRESSION_DICT_BYTES_INSERT,
   BLOCK_CACHE_COMPRESSION_DICT_BYTES_EVICT,
+
+  // Write stalls caused by a WriteBufferManager with a hard limit, see
+  // WriteBufferManager::ShouldDelayWrites() and ShouldStopWrites().
+  // # of times the DB started delaying writes.
+  WRITE_BUFFER_MANAGER_DELAY_COUNT,
+  // # of times the DB stopped writes.
+  WRITE_BUFFER_MANAGER_STOP_COUNT,
+  // Time writers were delayed or stopped while the DB was under one of them.
+  WRITE_BUFFER_MANAGER_STALL_MICROS,
   TICKER_ENUM_MAX
 };
 
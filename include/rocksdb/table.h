@@ -135,6 +135,18 @@ struct BlockBasedTableOptions {
   // kDataBlockBinaryAndHash.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // If true, data blocks also store the first 8 bytes of the user key of each
+  // restart point in a fixed-width array, which Seek() and Get() search
+  // (with SIMD instructions where available) before comparing any full key.
+  // This saves most of the CPU of locating the restart interval, notably
+  // when the first 8 bytes of the keys mostly differ, at the cost of 8 bytes
+  // per restart point. Only used with BytewiseComparator, and only in data
+  // blocks smaller than 64KB.
+  //
+  // Files written with this option cannot be read by older versions of
+  // RocksDB.
+  bool data_block_restart_key_prefixes = false;
+
   // This option is now deprecated. No matter what value it is set to,
   // it will behave as if hash_index_allow_collision=true.
   bool hash_index_allow_collision = true;
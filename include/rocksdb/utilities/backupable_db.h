@@ -99,6 +99,25 @@ struct BackupableDBOptions {
   // Default: 1
   int max_background_operations;
 
+  // Files larger than this many bytes are split into chunks of this size
+  // that are read, checksummed and written by up to
+  // max_background_operations threads at once, for both CreateNewBackup()
+  // and RestoreDBFromBackup(). The per-chunk checksums are combined into
+  // the whole-file checksum, so the backup format does not change. Needs
+  // Env::NewRandomRWFile() on the destination; files are copied whole
+  // when it is not supported. If 0, files are always copied whole.
+  // Default: 0
+  uint64_t copy_chunk_size;
+
+  // If true, a shared table file that an existing backup already holds
+  // with the same name and size takes its checksum from the backup's
+  // metadata instead of being read again from the DB. Only used if
+  // share_table_files is true and share_files_with_checksum is false.
+  // This trusts the same assumption share_table_files makes: table files
+  // with the same name have the same contents.
+  // Default: false
+  bool reuse_backup_checksums;
+
   // During backup user can get callback every time next
   // callback_trigger_interval_size bytes being copied.
   // Default: 4194304
@@ -136,6 +155,8 @@ struct BackupableDBOptions {
         restore_rate_limit(_restore_rate_limit),
         share_files_with_checksum(false),
         max_background_operations(_max_background_operations),
+        copy_chunk_size(0),
+        reuse_backup_checksums(false),
         callback_trigger_interval_size(_callback_trigger_interval_size),
         max_valid_backups_to_open(_max_valid_backups_to_open) {
     assert(share_table_files || !share_files_with_checksum);
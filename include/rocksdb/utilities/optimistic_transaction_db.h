@@ -41,13 +41,22 @@ enum class OccValidationPolicy {
   // Validate parallelly before commit stage, BEFORE entering the write-group to
   // reduce mutex contention. Each txn acquires locks for its write-set
   // records in some well-defined order.
-  kValidateParallel = 1
+  kValidateParallel = 1,
+  // Validate before commit stage without looking up the keys in the DB.
+  // Each key hashes into a bucket of a table that records the sequence
+  // number of the last write to any key of that bucket. A txn fails to
+  // commit if the bucket of a key it tracks was written after the key was
+  // read; keys sharing a bucket can thus cause false conflicts. Writes made
+  // through GetBaseDB() bypass the table and are not detected as conflicts,
+  // and DeleteRange() is not supported. Memtable history is not needed.
+  kValidateSequenceTable = 2
 };
 
 struct OptimisticTransactionDBOptions {
   OccValidationPolicy validate_policy = OccValidationPolicy::kValidateParallel;
 
   // works only if validate_policy == OccValidationPolicy::kValidateParallel
+  // or OccValidationPolicy::kValidateSequenceTable
   uint32_t occ_lock_buckets = (1 << 20);
 };
 
@@ -193,6 +193,13 @@ class StackableDB : public DB {
     return db_->NewIterators(options, column_families, iterators);
   }
 
+  virtual Status NewShardedIterators(
+      const ReadOptions& options, ColumnFamilyHandle* column_family,
+      size_t num_shards, std::vector<Iterator*>* iterators) override {
+    return db_->NewShardedIterators(options, column_family, num_shards,
+                                    iterators);
+  }
+
   virtual const Snapshot* GetSnapshot() override { return db_->GetSnapshot(); }
 
   virtual void ReleaseSnapshot(const Snapshot* snapshot) override {
@@ -464,6 +464,22 @@ class Transaction {
                                 const Slice& key) = 0;
   virtual void UndoGetForUpdate(const Slice& key) = 0;
 
+  // Locks every key in [begin, end) of column_family, including the keys that
+  // do not exist yet, so that no other transaction can lock or write them
+  // until this transaction commits or rolls back.  If exclusive is false,
+  // other transactions can still take shared locks in the range.
+  //
+  // Returns the same errors as GetForUpdate() does when the lock cannot be
+  // acquired, and InvalidArgument if begin is not before end.
+  //
+  // Only supported by Transactions created by a TransactionDB.  Range locks
+  // are not released by RollbackToSavePoint().
+  virtual Status GetRangeLock(ColumnFamilyHandle* /*column_family*/,
+                              const Slice& /*begin*/, const Slice& /*end*/,
+                              bool /*exclusive*/) {
+    return Status::NotSupported("Range locks are not supported.");
+  }
+
   virtual Status RebuildFromWriteBatch(WriteBatch* src_batch) = 0;
 
   virtual WriteBatch* GetCommitTimeWriteBatch() = 0;
@@ -196,6 +196,10 @@ struct KeyLockInfo {
   std::string key;
   std::vector<TransactionID> ids;
   bool exclusive;
+  // Set for a lock taken with Transaction::GetRangeLock(), which covers the
+  // keys in [key, end_key).
+  bool is_range_lock = false;
+  std::string end_key;
 };
 
 struct DeadlockInfo {
@@ -287,7 +291,7 @@ class TransactionDB : public StackableDB {
   virtual Transaction* GetTransactionByName(const TransactionName& name) = 0;
   virtual void GetAllPreparedTransactions(std::vector<Transaction*>* trans) = 0;
 
-  // Returns set of all locks held.
+  // Returns set of all locks held, including range locks.
   //
   // The mapping is column family id -> KeyLockInfo
   virtual std::unordered_multimap<uint32_t, KeyLockInfo>
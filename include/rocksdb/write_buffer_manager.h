@@ -13,7 +13,9 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <mutex>
 #include "rocksdb/cache.h"
 
 namespace rocksdb {
@@ -24,8 +26,18 @@ class WriteBufferManager {
   // memory_usage() won't be valid and ShouldFlush() will always return true.
   // if `cache` is provided, we'll put dummy entries in the cache and cost
   // the memory allocated to the cache. It can be used even if _buffer_size = 0.
+  //
+  // Flushes alone do not bound memory_usage(): when they cannot keep up with
+  // the writes, the memtables keep growing. _stop_limit > 0 makes all the DBs
+  // sharing this manager throttle their writes in that case. Their writes are
+  // delayed at each DB's delayed_write_rate while memory_usage() is at least
+  // _buffer_size, and stopped while it is at least _stop_limit, until flushes
+  // free enough memory. A _stop_limit below _buffer_size is raised to
+  // _buffer_size, so that writes stop without being delayed first. Ignored
+  // if _buffer_size = 0.
   explicit WriteBufferManager(size_t _buffer_size,
-                              std::shared_ptr<Cache> cache = {});
+                              std::shared_ptr<Cache> cache = {},
+                              size_t _stop_limit = 0);
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
   WriteBufferManager& operator=(const WriteBufferManager&) = delete;
@@ -44,6 +56,22 @@ class WriteBufferManager {
     return memory_active_.load(std::memory_order_relaxed);
   }
   size_t buffer_size() const { return buffer_size_; }
+  // 0 if writes are never throttled.
+  size_t stop_limit() const { return stop_limit_; }
+
+  // Whether the DBs sharing this manager should delay their writes.
+  bool ShouldDelayWrites() const {
+    return stop_limit_ > 0 && memory_usage() >= buffer_size_;
+  }
+
+  // Whether the DBs sharing this manager should stop their writes.
+  bool ShouldStopWrites() const {
+    return stop_limit_ > 0 && memory_usage() >= stop_limit_;
+  }
+
+  // Waits up to timeout_micros for ShouldStopWrites() to turn false. Returns
+  // immediately if it already is.
+  void WaitWhileWritesStopped(uint64_t timeout_micros);
 
   // Should only be called from write thread
   bool ShouldFlush() const {
@@ -80,23 +108,32 @@ class WriteBufferManager {
     }
   }
   void FreeMem(size_t mem) {
+    bool was_stopped = ShouldStopWrites();
     if (cache_rep_ != nullptr) {
       FreeMemWithCache(mem);
     } else if (enabled()) {
       memory_used_.fetch_sub(mem, std::memory_order_relaxed);
     }
+    if (was_stopped && !ShouldStopWrites()) {
+      EndWriteStop();
+    }
   }
 
  private:
   const size_t buffer_size_;
   const size_t mutable_limit_;
+  const size_t stop_limit_;
   std::atomic<size_t> memory_used_;
   // Memory that hasn't been scheduled to free.
   std::atomic<size_t> memory_active_;
   struct CacheRep;
   std::unique_ptr<CacheRep> cache_rep_;
+  // Wakes up the writers in WaitWhileWritesStopped().
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
 
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
+  void EndWriteStop();
 };
 }  // namespace rocksdb
@@ -0,0 +1,675 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// BTree is an ordered set of keys stored in a B+-tree whose nodes hold up
+// to kMaxKeys key pointers each. Compared to InlineSkipList, a search
+// visits O(log_32 n) nodes whose key pointers sit in a few consecutive
+// cache lines, instead of O(log n) skip list nodes scattered over the
+// arena, and a scan walks arrays of consecutive keys linked leaf to leaf.
+//
+// Thread safety -------------
+//
+// Insert and InsertConcurrently can be called concurrently with each other
+// and with reads. Reads require a guarantee that the BTree will not be
+// destroyed while the read is in progress. Apart from that, reads progress
+// without taking locks.
+//
+// Writers synchronize with optimistic lock coupling: every node has a
+// version that is odd while a writer holds the node and advances each time
+// the writer releases it. Writers lock only the nodes they modify (a leaf,
+// or a full node and its parent when splitting). Readers record a node's
+// version, read the node, and start over from the root if the version
+// changed in between.
+//
+// Invariants:
+//
+// (1) Nodes and keys are never deleted until the BTree is destroyed, so a
+// reader that races with a writer may read outdated data, but never freed
+// memory.
+//
+// (2) Keys are never removed from the tree. A split moves the upper half
+// of a node to a new right sibling, so a key only ever moves right, and
+// leaves stay reachable from their left sibling through their next
+// pointers.
+//
+// (3) Full nodes are split on the way down, so the parent of a node being
+// split always has room for the new separator.
+
+#pragma once
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+#include "memory/allocator.h"
+#include "port/likely.h"
+#include "port/port.h"
+
+namespace rocksdb {
+
+template <class Comparator>
+class BTree {
+ private:
+  struct Node;
+  struct LeafNode;
+  struct InnerNode;
+
+ public:
+  using DecodedKey =
+      typename std::remove_reference<Comparator>::type::DecodedType;
+
+  // Maximum number of keys in a node. An inner node has one more child.
+  static const int kMaxKeys = 32;
+
+ private:
+  // A consistent copy of the keys of a leaf.
+  struct LeafCopy {
+    int count;
+    const LeafNode* next;
+    const char* keys[kMaxKeys];
+  };
+
+ public:
+  // Create a new BTree object that will use "cmp" for comparing keys, and
+  // will allocate memory using "*allocator". Objects allocated in the
+  // allocator must remain allocated for the lifetime of the tree object.
+  explicit BTree(Comparator cmp, Allocator* allocator);
+  // No copying allowed
+  BTree(const BTree&) = delete;
+  BTree& operator=(const BTree&) = delete;
+
+  // Allocates a key of key_size bytes, to be passed to Insert().
+  char* AllocateKey(size_t key_size);
+
+  // Inserts a key allocated by AllocateKey(). Returns false, without
+  // inserting the key, if a key that compares equal is already present.
+  bool Insert(const char* key) { return InsertConcurrently(key); }
+
+  // Like Insert(), but external synchronization is not needed. Writers only
+  // wait for each other when they modify the same nodes.
+  bool InsertConcurrently(const char* key);
+
+  // Returns true iff an entry that compares equal to key is in the tree.
+  bool Contains(const char* key) const;
+
+  // Iteration over the contents of a BTree. The iterator works on a copy of
+  // the keys of its current leaf, so entries inserted into that leaf after
+  // the iterator reached it are not returned.
+  class Iterator {
+   public:
+    // Initialize an iterator over the specified tree.
+    // The returned iterator is not valid.
+    explicit Iterator(const BTree* tree);
+
+    // Change the underlying tree used for this iterator.
+    // This enables us not changing the iterator without deallocating
+    // an old one and then allocating a new one.
+    void SetTree(const BTree* tree);
+
+    // Returns true iff the iterator is positioned at a valid node.
+    bool Valid() const { return pos_ >= 0 && pos_ < leaf_.count; }
+
+    // Returns the key at the current position.
+    // REQUIRES: Valid()
+    const char* key() const {
+      assert(Valid());
+      return leaf_.keys[pos_];
+    }
+
+    // Advances to the next position.
+    // REQUIRES: Valid()
+    void Next();
+
+    // Advances to the previous position.
+    // REQUIRES: Valid()
+    void Prev();
+
+    // Advance to the first entry with a key >= target
+    void Seek(const char* target);
+
+    // Retreat to the last entry with a key <= target
+    void SeekForPrev(const char* target);
+
+    // Position at the first entry in tree.
+    // Final state of iterator is Valid() iff tree is not empty.
+    void SeekToFirst();
+
+    // Position at the last entry in tree.
+    // Final state of iterator is Valid() iff tree is not empty.
+    void SeekToLast();
+
+   private:
+    // Returns the number of keys of leaf_ less than target, or also equal to
+    // target if upper is true.
+    int Search(const DecodedKey& target, bool upper) const;
+
+    // Moves to the following leaves while positioned past the last key.
+    void SkipEmptyLeaves();
+
+    const BTree* tree_;
+    int pos_;
+    LeafCopy leaf_;
+  };
+
+ private:
+  // How to choose the child of each inner node on the way to a leaf.
+  enum Descent {
+    kFirst,
+    kLast,
+    // The child that contains target, or would contain it.
+    kUpperBound,
+    // The child that contains the last key before target.
+    kLowerBound,
+  };
+
+  enum InsertResult {
+    kInserted,
+    kExists,
+    kRetry,
+  };
+
+  struct Node {
+    // Odd while a writer holds the node.
+    std::atomic<uint64_t> version;
+    std::atomic<int> count;
+    // Immutable once the node is published.
+    bool is_leaf;
+    std::atomic<const char*> keys[kMaxKeys];
+  };
+
+  struct LeafNode : public Node {
+    std::atomic<LeafNode*> next;
+  };
+
+  // children[i] holds the keys k with keys[i - 1] <= k < keys[i].
+  struct InnerNode : public Node {
+    std::atomic<Node*> children[kMaxKeys + 1];
+  };
+
+  template <class T>
+  T* NewNode();
+
+  static bool ReadLock(const Node* node, uint64_t* version) {
+    *version = node->version.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  // Returns true if node has not changed since its version was read.
+  static bool Validate(const Node* node, uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return node->version.load(std::memory_order_relaxed) == version;
+  }
+
+  static bool UpgradeToWriteLock(Node* node, uint64_t version) {
+    return node->version.compare_exchange_strong(version, version + 1,
+                                                 std::memory_order_acquire);
+  }
+
+  static void WriteUnlock(Node* node) {
+    node->version.fetch_add(1, std::memory_order_release);
+  }
+
+  // Returns the number of the first count keys of node that are less than
+  // target, or also equal to target if upper is true. Returns -1 if the
+  // node is being modified.
+  int Search(const Node* node, int count, const DecodedKey& target,
+             bool upper) const;
+
+  // Copies the leaf reached by descent into copy. Returns false if a
+  // concurrent writer got in the way.
+  bool TryDescend(Descent descent, const DecodedKey* target,
+                  LeafCopy* copy) const;
+  void Descend(Descent descent, const DecodedKey* target,
+               LeafCopy* copy) const;
+  bool TryCopyLeaf(const LeafNode* leaf, uint64_t version,
+                   LeafCopy* copy) const;
+  void CopyLeaf(const LeafNode* leaf, LeafCopy* copy) const;
+
+  InsertResult TryInsert(const char* key, const DecodedKey& decoded);
+
+  // Write locks parent, if not null, and node for a split.
+  static bool LockForSplit(InnerNode* parent, uint64_t parent_version,
+                           Node* node, uint64_t version);
+  // Splits a full node. With append, the key being inserted goes after all
+  // keys of the tree, and node keeps all but its last key(s) so that
+  // sequential inserts fill the nodes up.
+  void SplitLeaf(InnerNode* parent, LeafNode* leaf, bool append);
+  void SplitInner(InnerNode* parent, InnerNode* inner, bool append);
+  // Adds separator and right, the new right sibling of left, to parent, or
+  // grows the tree if left is the root.
+  void InsertIntoParent(InnerNode* parent, Node* left, const char* separator,
+                        Node* right);
+
+  Allocator* const allocator_;
+  Comparator const compare_;
+  std::atomic<Node*> root_;
+};
+
+// Implementation details follow
+
+template <class Comparator>
+BTree<Comparator>::BTree(const Comparator cmp, Allocator* allocator)
+    : allocator_(allocator), compare_(cmp) {
+  root_.store(NewNode<LeafNode>(), std::memory_order_relaxed);
+}
+
+template <class Comparator>
+template <class T>
+T* BTree<Comparator>::NewNode() {
+  // Align nodes on cache lines, so that a node spans as few as possible.
+  char* mem = allocator_->AllocateAligned(sizeof(T) + CACHE_LINE_SIZE - 1);
+  uintptr_t offset = reinterpret_cast<uintptr_t>(mem) % CACHE_LINE_SIZE;
+  if (offset > 0) {
+    mem += CACHE_LINE_SIZE - offset;
+  }
+  // Value-initialization zeroes the atomics.
+  T* node = new (mem) T();
+  node->is_leaf = std::is_same<T, LeafNode>::value;
+  return node;
+}
+
+template <class Comparator>
+char* BTree<Comparator>::AllocateKey(size_t key_size) {
+  return allocator_->Allocate(key_size);
+}
+
+template <class Comparator>
+int BTree<Comparator>::Search(const Node* node, int count,
+                              const DecodedKey& target, bool upper) const {
+  int lo = 0;
+  int hi = count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    const char* key = node->keys[mid].load(std::memory_order_acquire);
+    if (UNLIKELY(key == nullptr)) {
+      // Only seen by a reader that raced with a writer.
+      return -1;
+    }
+    int cmp = compare_(key, target);
+    if (cmp < 0 || (upper && cmp == 0)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+template <class Comparator>
+bool BTree<Comparator>::TryDescend(Descent descent, const DecodedKey* target,
+                                   LeafCopy* copy) const {
+  const Node* node = root_.load(std::memory_order_acquire);
+  uint64_t version;
+  if (!ReadLock(node, &version) ||
+      node != root_.load(std::memory_order_acquire)) {
+    return false;
+  }
+  while (!node->is_leaf) {
+    const InnerNode* inner = static_cast<const InnerNode*>(node);
+    int count = inner->count.load(std::memory_order_acquire);
+    if (count < 0 || count > kMaxKeys) {
+      return false;
+    }
+    int pos;
+    switch (descent) {
+      case kFirst:
+        pos = 0;
+        break;
+      case kLast:
+        pos = count;
+        break;
+      case kUpperBound:
+        pos = Search(inner, count, *target, true /* upper */);
+        break;
+      default:
+        pos = Search(inner, count, *target, false /* upper */);
+        break;
+    }
+    if (pos < 0) {
+      return false;
+    }
+    const Node* child = inner->children[pos].load(std::memory_order_acquire);
+    uint64_t child_version;
+    if (child == nullptr || !ReadLock(child, &child_version) ||
+        !Validate(inner, version)) {
+      return false;
+    }
+    node = child;
+    version = child_version;
+  }
+  return TryCopyLeaf(static_cast<const LeafNode*>(node), version, copy);
+}
+
+template <class Comparator>
+void BTree<Comparator>::Descend(Descent descent, const DecodedKey* target,
+                                LeafCopy* copy) const {
+  while (!TryDescend(descent, target, copy)) {
+    port::AsmVolatilePause();
+  }
+}
+
+template <class Comparator>
+bool BTree<Comparator>::TryCopyLeaf(const LeafNode* leaf, uint64_t version,
+                                    LeafCopy* copy) const {
+  int count = leaf->count.load(std::memory_order_acquire);
+  if (count < 0 || count > kMaxKeys) {
+    return false;
+  }
+  for (int i = 0; i < count; i++) {
+    copy->keys[i] = leaf->keys[i].load(std::memory_order_acquire);
+    if (copy->keys[i] == nullptr) {
+      return false;
+    }
+  }
+  copy->next = leaf->next.load(std::memory_order_acquire);
+  copy->count = count;
+  return Validate(leaf, version);
+}
+
+template <class Comparator>
+void BTree<Comparator>::CopyLeaf(const LeafNode* leaf, LeafCopy* copy) const {
+  while (true) {
+    uint64_t version;
+    if (ReadLock(leaf, &version) && TryCopyLeaf(leaf, version, copy)) {
+      return;
+    }
+    port::AsmVolatilePause();
+  }
+}
+
+template <class Comparator>
+bool BTree<Comparator>::InsertConcurrently(const char* key) {
+  DecodedKey decoded = compare_.decode_key(key);
+  while (true) {
+    InsertResult result = TryInsert(key, decoded);
+    if (result != kRetry) {
+      return result == kInserted;
+    }
+  }
+}
+
+template <class Comparator>
+typename BTree<Comparator>::InsertResult BTree<Comparator>::TryInsert(
+    const char* key, const DecodedKey& decoded) {
+  Node* node = root_.load(std::memory_order_acquire);
+  uint64_t version;
+  if (!ReadLock(node, &version) ||
+      node != root_.load(std::memory_order_acquire)) {
+    port::AsmVolatilePause();
+    return kRetry;
+  }
+  InnerNode* parent = nullptr;
+  uint64_t parent_version = 0;
+  // Whether node is the last node of its level.
+  bool rightmost = true;
+  while (!node->is_leaf) {
+    InnerNode* inner = static_cast<InnerNode*>(node);
+    int count = inner->count.load(std::memory_order_acquire);
+    if (count < 0 || count > kMaxKeys) {
+      return kRetry;
+    }
+    int pos = Search(inner, count, decoded, true /* upper */);
+    if (pos < 0) {
+      return kRetry;
+    }
+    if (count == kMaxKeys) {
+      if (!LockForSplit(parent, parent_version, inner, version)) {
+        return kRetry;
+      }
+      SplitInner(parent, inner, rightmost && pos == count);
+      WriteUnlock(inner);
+      if (parent != nullptr) {
+        WriteUnlock(parent);
+      }
+      return kRetry;
+    }
+    Node* child = inner->children[pos].load(std::memory_order_acquire);
+    uint64_t child_version;
+    if (child == nullptr || !ReadLock(child, &child_version) ||
+        !Validate(inner, version)) {
+      port::AsmVolatilePause();
+      return kRetry;
+    }
+    parent = inner;
+    parent_version = version;
+    node = child;
+    version = child_version;
+    rightmost = rightmost && pos == count;
+  }
+
+  LeafNode* leaf = static_cast<LeafNode*>(node);
+  int count = leaf->count.load(std::memory_order_acquire);
+  if (count == kMaxKeys) {
+    const char* last = leaf->keys[count - 1].load(std::memory_order_acquire);
+    if (last == nullptr ||
+        !LockForSplit(parent, parent_version, leaf, version)) {
+      return kRetry;
+    }
+    SplitLeaf(parent, leaf, rightmost && compare_(last, decoded) < 0);
+    WriteUnlock(leaf);
+    if (parent != nullptr) {
+      WriteUnlock(parent);
+    }
+    return kRetry;
+  }
+  if (!UpgradeToWriteLock(leaf, version)) {
+    return kRetry;
+  }
+  // The leaf may have been split before its version was read, in which case
+  // key may belong to its new sibling.
+  if (parent != nullptr && !Validate(parent, parent_version)) {
+    WriteUnlock(leaf);
+    return kRetry;
+  }
+  count = leaf->count.load(std::memory_order_relaxed);
+  int pos = Search(leaf, count, decoded, false /* upper */);
+  assert(pos >= 0);
+  if (pos < count &&
+      compare_(leaf->keys[pos].load(std::memory_order_relaxed), decoded) ==
+          0) {
+    WriteUnlock(leaf);
+    return kExists;
+  }
+  for (int i = count; i > pos; i--) {
+    leaf->keys[i].store(leaf->keys[i - 1].load(std::memory_order_relaxed),
+                        std::memory_order_release);
+  }
+  leaf->keys[pos].store(key, std::memory_order_release);
+  leaf->count.store(count + 1, std::memory_order_release);
+  WriteUnlock(leaf);
+  return kInserted;
+}
+
+template <class Comparator>
+bool BTree<Comparator>::LockForSplit(InnerNode* parent,
+                                     uint64_t parent_version, Node* node,
+                                     uint64_t version) {
+  if (parent != nullptr && !UpgradeToWriteLock(parent, parent_version)) {
+    return false;
+  }
+  if (!UpgradeToWriteLock(node, version)) {
+    if (parent != nullptr) {
+      WriteUnlock(parent);
+    }
+    return false;
+  }
+  return true;
+}
+
+template <class Comparator>
+void BTree<Comparator>::SplitLeaf(InnerNode* parent, LeafNode* leaf,
+                                  bool append) {
+  const int count = kMaxKeys;
+  assert(leaf->count.load(std::memory_order_relaxed) == count);
+  int split = append ? count - 1 : count / 2;
+  LeafNode* right = NewNode<LeafNode>();
+  for (int i = split; i < count; i++) {
+    right->keys[i - split].store(leaf->keys[i].load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+  }
+  right->count.store(count - split, std::memory_order_relaxed);
+  right->next.store(leaf->next.load(std::memory_order_relaxed),
+                    std::memory_order_relaxed);
+  // Readers that follow next pointers get the initialized sibling.
+  leaf->next.store(right, std::memory_order_release);
+  leaf->count.store(split, std::memory_order_release);
+  InsertIntoParent(parent, leaf,
+                   right->keys[0].load(std::memory_order_relaxed), right);
+}
+
+template <class Comparator>
+void BTree<Comparator>::SplitInner(InnerNode* parent, InnerNode* inner,
+                                   bool append) {
+  const int count = kMaxKeys;
+  assert(inner->count.load(std::memory_order_relaxed) == count);
+  int split = append ? count - 1 : count / 2;
+  const char* separator = inner->keys[split].load(std::memory_order_relaxed);
+  InnerNode* right = NewNode<InnerNode>();
+  for (int i = split + 1; i < count; i++) {
+    right->keys[i - split - 1].store(
+        inner->keys[i].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+  }
+  for (int i = split + 1; i <= count; i++) {
+    right->children[i - split - 1].store(
+        inner->children[i].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+  }
+  right->count.store(count - split - 1, std::memory_order_relaxed);
+  inner->count.store(split, std::memory_order_release);
+  InsertIntoParent(parent, inner, separator, right);
+}
+
+template <class Comparator>
+void BTree<Comparator>::InsertIntoParent(InnerNode* parent, Node* left,
+                                         const char* separator, Node* right) {
+  if (parent == nullptr) {
+    assert(root_.load(std::memory_order_relaxed) == left);
+    InnerNode* root = NewNode<InnerNode>();
+    root->keys[0].store(separator, std::memory_order_relaxed);
+    root->children[0].store(left, std::memory_order_relaxed);
+    root->children[1].store(right, std::memory_order_relaxed);
+    root->count.store(1, std::memory_order_relaxed);
+    root_.store(root, std::memory_order_release);
+    return;
+  }
+  int count = parent->count.load(std::memory_order_relaxed);
+  assert(count < kMaxKeys);
+  int pos = 0;
+  while (parent->children[pos].load(std::memory_order_relaxed) != left) {
+    pos++;
+    assert(pos <= count);
+  }
+  for (int i = count; i > pos; i--) {
+    parent->keys[i].store(parent->keys[i - 1].load(std::memory_order_relaxed),
+                          std::memory_order_release);
+    parent->children[i + 1].store(
+        parent->children[i].load(std::memory_order_relaxed),
+        std::memory_order_release);
+  }
+  parent->keys[pos].store(separator, std::memory_order_release);
+  parent->children[pos + 1].store(right, std::memory_order_release);
+  parent->count.store(count + 1, std::memory_order_release);
+}
+
+template <class Comparator>
+bool BTree<Comparator>::Contains(const char* key) const {
+  Iterator iter(this);
+  iter.Seek(key);
+  return iter.Valid() &&
+         compare_(iter.key(), compare_.decode_key(key)) == 0;
+}
+
+template <class Comparator>
+inline BTree<Comparator>::Iterator::Iterator(const BTree* tree) {
+  SetTree(tree);
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::SetTree(const BTree* tree) {
+  tree_ = tree;
+  pos_ = 0;
+  leaf_.count = 0;
+  leaf_.next = nullptr;
+}
+
+template <class Comparator>
+inline int BTree<Comparator>::Iterator::Search(const DecodedKey& target,
+                                               bool upper) const {
+  int lo = 0;
+  int hi = leaf_.count;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    int cmp = tree_->compare_(leaf_.keys[mid], target);
+    if (cmp < 0 || (upper && cmp == 0)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::SkipEmptyLeaves() {
+  // Keys of the following leaves are greater than those of leaf_, even if
+  // leaf_ was split since it was copied.
+  while (pos_ == leaf_.count && leaf_.next != nullptr) {
+    tree_->CopyLeaf(leaf_.next, &leaf_);
+    pos_ = 0;
+  }
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::Next() {
+  assert(Valid());
+  pos_++;
+  SkipEmptyLeaves();
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::Prev() {
+  assert(Valid());
+  if (pos_ > 0) {
+    pos_--;
+    return;
+  }
+  // Leaves are not linked backwards; search for the last key before the
+  // first one of leaf_.
+  DecodedKey target = tree_->compare_.decode_key(leaf_.keys[0]);
+  tree_->Descend(kLowerBound, &target, &leaf_);
+  pos_ = Search(target, false /* upper */) - 1;
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::Seek(const char* target) {
+  DecodedKey decoded = tree_->compare_.decode_key(target);
+  tree_->Descend(kUpperBound, &decoded, &leaf_);
+  pos_ = Search(decoded, false /* upper */);
+  SkipEmptyLeaves();
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::SeekForPrev(const char* target) {
+  DecodedKey decoded = tree_->compare_.decode_key(target);
+  // Unless it is the first leaf, the leaf that would contain target starts
+  // with a key <= target.
+  tree_->Descend(kUpperBound, &decoded, &leaf_);
+  pos_ = Search(decoded, true /* upper */) - 1;
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::SeekToFirst() {
+  tree_->Descend(kFirst, nullptr, &leaf_);
+  pos_ = 0;
+  SkipEmptyLeaves();
+}
+
+template <class Comparator>
+inline void BTree<Comparator>::Iterator::SeekToLast() {
+  tree_->Descend(kLast, nullptr, &leaf_);
+  pos_ = leaf_.count - 1;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,268 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "memtable/btree.h"
+#include <atomic>
+#include <set>
+#include <vector>
+#include "memory/concurrent_arena.h"
+#include "port/port.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace rocksdb {
+
+// Our test tree stores 8-byte unsigned integers
+typedef uint64_t Key;
+
+static const char* Encode(const uint64_t* key) {
+  return reinterpret_cast<const char*>(key);
+}
+
+static Key Decode(const char* key) {
+  Key rv;
+  memcpy(&rv, key, sizeof(Key));
+  return rv;
+}
+
+struct TestComparator {
+  typedef Key DecodedType;
+
+  static DecodedType decode_key(const char* b) { return Decode(b); }
+
+  int operator()(const char* a, const char* b) const {
+    return operator()(a, Decode(b));
+  }
+
+  int operator()(const char* a, const DecodedType b) const {
+    if (Decode(a) < b) {
+      return -1;
+    } else if (Decode(a) > b) {
+      return +1;
+    } else {
+      return 0;
+    }
+  }
+};
+
+typedef BTree<TestComparator> TestBTree;
+
+class BTreeTest : public testing::Test {
+ public:
+  bool Insert(TestBTree* tree, Key key) {
+    char* buf = tree->AllocateKey(sizeof(Key));
+    memcpy(buf, &key, sizeof(Key));
+    bool res = tree->Insert(buf);
+    keys_.insert(key);
+    return res;
+  }
+
+  void Validate(TestBTree* tree) {
+    // Check keys exist.
+    for (Key key : keys_) {
+      ASSERT_TRUE(tree->Contains(Encode(&key)));
+    }
+    // Iterate over the tree in both directions, make sure keys appear in
+    // order and no extra keys exist.
+    TestBTree::Iterator iter(tree);
+    ASSERT_FALSE(iter.Valid());
+    iter.SeekToFirst();
+    for (Key key : keys_) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(key, Decode(iter.key()));
+      iter.Next();
+    }
+    ASSERT_FALSE(iter.Valid());
+    iter.SeekToLast();
+    for (auto it = keys_.rbegin(); it != keys_.rend(); ++it) {
+      ASSERT_TRUE(iter.Valid());
+      ASSERT_EQ(*it, Decode(iter.key()));
+      iter.Prev();
+    }
+    ASSERT_FALSE(iter.Valid());
+  }
+
+ protected:
+  std::set<Key> keys_;
+};
+
+TEST_F(BTreeTest, Empty) {
+  Arena arena;
+  TestComparator cmp;
+  TestBTree tree(cmp, &arena);
+  Key key = 10;
+  ASSERT_TRUE(!tree.Contains(Encode(&key)));
+
+  TestBTree::Iterator iter(&tree);
+  ASSERT_TRUE(!iter.Valid());
+  iter.SeekToFirst();
+  ASSERT_TRUE(!iter.Valid());
+  key = 100;
+  iter.Seek(Encode(&key));
+  ASSERT_TRUE(!iter.Valid());
+  iter.SeekForPrev(Encode(&key));
+  ASSERT_TRUE(!iter.Valid());
+  iter.SeekToLast();
+  ASSERT_TRUE(!iter.Valid());
+}
+
+TEST_F(BTreeTest, InsertAndLookup) {
+  const int N = 2000;
+  const int R = 5000;
+  Random rnd(1000);
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestBTree tree(cmp, &arena);
+  for (int i = 0; i < N; i++) {
+    Key key = rnd.Next() % R;
+    bool present = keys_.count(key) > 0;
+    ASSERT_EQ(!present, Insert(&tree, key));
+  }
+
+  for (Key i = 0; i < R; i++) {
+    ASSERT_EQ(keys_.count(i) > 0, tree.Contains(Encode(&i)));
+  }
+
+  // Simple iterator tests
+  {
+    TestBTree::Iterator iter(&tree);
+    ASSERT_TRUE(!iter.Valid());
+
+    uint64_t zero = 0;
+    iter.Seek(Encode(&zero));
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys_.begin()), Decode(iter.key()));
+
+    uint64_t max_key = R - 1;
+    iter.SeekForPrev(Encode(&max_key));
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys_.rbegin()), Decode(iter.key()));
+
+    iter.SeekToFirst();
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys_.begin()), Decode(iter.key()));
+
+    iter.SeekToLast();
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(*(keys_.rbegin()), Decode(iter.key()));
+  }
+
+  // Forward iteration test
+  for (Key i = 0; i < R; i++) {
+    TestBTree::Iterator iter(&tree);
+    iter.Seek(Encode(&i));
+
+    // Compare against model iterator
+    std::set<Key>::iterator model_iter = keys_.lower_bound(i);
+    for (int j = 0; j < 3; j++) {
+      if (model_iter == keys_.end()) {
+        ASSERT_TRUE(!iter.Valid());
+        break;
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*model_iter, Decode(iter.key()));
+        ++model_iter;
+        iter.Next();
+      }
+    }
+  }
+
+  // Backward iteration test
+  for (Key i = 0; i < R; i++) {
+    TestBTree::Iterator iter(&tree);
+    iter.SeekForPrev(Encode(&i));
+
+    // Compare against model iterator
+    std::set<Key>::iterator model_iter = keys_.upper_bound(i);
+    for (int j = 0; j < 3; j++) {
+      if (model_iter == keys_.begin()) {
+        ASSERT_TRUE(!iter.Valid());
+        break;
+      } else {
+        ASSERT_TRUE(iter.Valid());
+        ASSERT_EQ(*--model_iter, Decode(iter.key()));
+        iter.Prev();
+      }
+    }
+  }
+  Validate(&tree);
+}
+
+TEST_F(BTreeTest, SequentialInsert) {
+  // Ascending keys take the append split path, descending keys always
+  // split the first leaf.
+  for (bool ascending : {true, false}) {
+    keys_.clear();
+    Arena arena;
+    TestComparator cmp;
+    TestBTree tree(cmp, &arena);
+    const Key N = 20000;
+    for (Key i = 0; i < N; i++) {
+      ASSERT_TRUE(Insert(&tree, ascending ? i : N - i));
+    }
+    Validate(&tree);
+  }
+}
+
+TEST_F(BTreeTest, ConcurrentInsert) {
+  const int kThreads = 4;
+  const int kKeysPerThread = 10000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  TestBTree tree(cmp, &arena);
+  std::atomic<bool> writers_done(false);
+
+  // Each writer inserts the keys congruent to its id modulo kThreads, in a
+  // shuffled order, so writers collide on the same leaves.
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&tree, t]() {
+      Random rnd(301 + t);
+      std::vector<Key> keys;
+      for (int i = 0; i < kKeysPerThread; i++) {
+        keys.push_back(static_cast<Key>(i) * kThreads + t);
+      }
+      for (size_t i = keys.size(); i > 1; i--) {
+        std::swap(keys[i - 1], keys[rnd.Uniform(static_cast<int>(i))]);
+      }
+      for (Key key : keys) {
+        char* buf = tree.AllocateKey(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        ASSERT_TRUE(tree.InsertConcurrently(buf));
+      }
+    });
+  }
+  // A reader that checks that iteration is always in order.
+  port::Thread reader([&tree, &writers_done]() {
+    while (!writers_done.load(std::memory_order_acquire)) {
+      TestBTree::Iterator iter(&tree);
+      bool first = true;
+      Key prev = 0;
+      for (iter.SeekToFirst(); iter.Valid(); iter.Next()) {
+        Key cur = Decode(iter.key());
+        ASSERT_TRUE(first || prev < cur);
+        first = false;
+        prev = cur;
+      }
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  writers_done.store(true, std::memory_order_release);
+  reader.join();
+
+  for (int i = 0; i < kThreads * kKeysPerThread; i++) {
+    keys_.insert(static_cast<Key>(i));
+  }
+  Validate(&tree);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// MemTableHashIndex maps every user key of a memtable to the newest entry
+// inserted for it, so that a point lookup can find that entry without
+// searching the memtable rep. It does not replace the rep: ordered access
+// and lookups of older versions still go through the rep.
+//
+// The index is a fixed array of buckets, each holding a singly-linked list
+// of nodes. Both the bucket array and the nodes are allocated from the
+// memtable's allocator and are never freed or unlinked before the memtable
+// is destroyed.
+//
+// Thread safety: Insert() may be called concurrently with other Insert()
+// and Get() calls without external synchronization. Get() returns an entry
+// that was completely inserted by some Insert() call that happened before
+// or concurrently with it.
+
+#pragma once
+
+#include <assert.h>
+#include <string.h>
+#include <atomic>
+
+#include "db/dbformat.h"
+#include "memory/allocator.h"
+#include "rocksdb/slice.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+class MemTableHashIndex {
+ public:
+  // Allocates num_buckets buckets (num_buckets > 0) from allocator.
+  MemTableHashIndex(Allocator* allocator, uint32_t num_buckets,
+                    size_t huge_page_tlb_size = 0, Logger* logger = nullptr);
+
+  // No copying allowed
+  MemTableHashIndex(const MemTableHashIndex&) = delete;
+  void operator=(const MemTableHashIndex&) = delete;
+
+  // Records entry, a memtable entry as encoded by MemTable::Add(), as the
+  // newest entry of its user key unless an entry with a larger sequence
+  // number has already been recorded. entry must outlive the index.
+  void Insert(const char* entry);
+
+  // Returns the newest entry recorded for user_key, or nullptr if no entry
+  // has been recorded for it.
+  const char* Get(const Slice& user_key) const;
+
+  // Decodes the user key and the packed sequence number and type of entry.
+  static Slice DecodeEntry(const char* entry, uint64_t* tag);
+
+ private:
+  struct Node {
+    std::atomic<const char*> entry;
+    // Immutable once the node is published in its bucket.
+    Node* next;
+    uint32_t hash;
+  };
+
+  std::atomic<Node*>* GetBucket(uint32_t hash) const {
+    return &buckets_[fastrange32(hash, num_buckets_)];
+  }
+
+  // Returns the node of user_key in the list starting at head, stopping
+  // before end.
+  static Node* FindNode(Node* head, Node* end, const Slice& user_key,
+                        uint32_t hash);
+
+  Allocator* const allocator_;
+  const uint32_t num_buckets_;
+  std::atomic<Node*>* buckets_;
+};
+
+inline MemTableHashIndex::MemTableHashIndex(Allocator* allocator,
+                                            uint32_t num_buckets,
+                                            size_t huge_page_tlb_size,
+                                            Logger* logger)
+    : allocator_(allocator), num_buckets_(num_buckets) {
+  assert(num_buckets_ > 0);
+  char* mem = allocator_->AllocateAligned(
+      sizeof(std::atomic<Node*>) * num_buckets_, huge_page_tlb_size, logger);
+  buckets_ = reinterpret_cast<std::atomic<Node*>*>(mem);
+  for (uint32_t i = 0; i < num_buckets_; i++) {
+    new (&buckets_[i]) std::atomic<Node*>(nullptr);
+  }
+}
+
+inline Slice MemTableHashIndex::DecodeEntry(const char* entry, uint64_t* tag) {
+  uint32_t key_length = 0;
+  const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+  assert(key_ptr != nullptr && key_length >= 8);
+  *tag = DecodeFixed64(key_ptr + key_length - 8);
+  return Slice(key_ptr, key_length - 8);
+}
+
+inline MemTableHashIndex::Node* MemTableHashIndex::FindNode(
+    Node* head, Node* end, const Slice& user_key, uint32_t hash) {
+  for (Node* node = head; node != end; node = node->next) {
+    if (node->hash != hash) {
+      continue;
+    }
+    uint64_t tag;
+    if (DecodeEntry(node->entry.load(std::memory_order_acquire), &tag) ==
+        user_key) {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+inline void MemTableHashIndex::Insert(const char* entry) {
+  uint64_t tag;
+  Slice user_key = DecodeEntry(entry, &tag);
+  SequenceNumber seq = tag >> 8;
+  uint32_t hash = GetSliceHash(user_key);
+  std::atomic<Node*>* bucket = GetBucket(hash);
+
+  Node* head = bucket->load(std::memory_order_acquire);
+  Node* end = nullptr;
+  Node* new_node = nullptr;
+  while (true) {
+    // Only the nodes published since the last scan need to be checked.
+    Node* node = FindNode(head, end, user_key, hash);
+    if (node != nullptr) {
+      // new_node, if any, stays unused in the allocator; this only happens
+      // when two writers race to add the same user key.
+      const char* cur = node->entry.load(std::memory_order_acquire);
+      uint64_t cur_tag;
+      DecodeEntry(cur, &cur_tag);
+      while ((cur_tag >> 8) < seq &&
+             !node->entry.compare_exchange_weak(cur, entry,
+                                                std::memory_order_release,
+                                                std::memory_order_acquire)) {
+        DecodeEntry(cur, &cur_tag);
+      }
+      return;
+    }
+    if (new_node == nullptr) {
+      char* mem = allocator_->AllocateAligned(sizeof(Node));
+      new_node = new (mem) Node();
+      new_node->entry.store(entry, std::memory_order_relaxed);
+      new_node->hash = hash;
+    }
+    new_node->next = head;
+    end = head;
+    if (bucket->compare_exchange_strong(head, new_node,
+                                        std::memory_order_release,
+                                        std::memory_order_acquire)) {
+      return;
+    }
+  }
+}
+
+inline const char* MemTableHashIndex::Get(const Slice& user_key) const {
+  uint32_t hash = GetSliceHash(user_key);
+  Node* node = FindNode(GetBucket(hash)->load(std::memory_order_acquire),
+                        nullptr, user_key, hash);
+  return node == nullptr ? nullptr
+                         : node->entry.load(std::memory_order_acquire);
+}
+
+}  // namespace rocksdb
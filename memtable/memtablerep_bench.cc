@@ -25,6 +25,7 @@ int main() {
 #include "db/dbformat.h"
 #include "db/memtable.h"
 #include "memory/arena.h"
+#include "memtable/memtable_hash_index.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/comparator.h"
@@ -58,6 +59,7 @@ DEFINE_string(memtablerep, "skiplist",
               "include/memtablerep.h for\n"
               "  more details. Options:\n"
               "\tskiplist            -- backed by a skiplist\n"
+              "\tbtree               -- backed by a B+-tree\n"
               "\tvector              -- backed by an std::vector\n"
               "\thashskiplist        -- backed by a hash skip list\n"
               "\thashlinklist        -- backed by a hash linked list\n"
@@ -91,6 +93,13 @@ DEFINE_int32(
     threshold_use_skiplist, 256,
     "threshold_use_skiplist parameter to pass into NewHashLinkListRepFactory");
 
+DEFINE_bool(hash_index, false,
+            "Also record every entry in a MemTableHashIndex with bucket_count "
+            "buckets, and serve random reads from it instead of the "
+            "memtablerep, as MemTable does with "
+            "memtable_hash_index_size_ratio. Only supported with the skiplist, "
+            "btree and vector memtablereps");
+
 DEFINE_int64(write_buffer_size, 256,
              "write_buffer_size parameter to pass into WriteBufferManager");
 
@@ -131,6 +140,48 @@ struct CallbackVerifyArgs {
 };
 }  // namespace
 
+// Forwards to a MemTableRep and records every inserted entry in a
+// MemTableHashIndex, which answers Get() without searching the rep.
+// Requires a rep whose KeyHandle is the entry buffer.
+class HashIndexedRep : public MemTableRep {
+ public:
+  HashIndexedRep(Allocator* allocator, MemTableRep* rep, uint32_t num_buckets)
+      : MemTableRep(allocator), rep_(rep), index_(allocator, num_buckets) {}
+
+  KeyHandle Allocate(const size_t len, char** buf) override {
+    KeyHandle handle = rep_->Allocate(len, buf);
+    assert(handle == static_cast<KeyHandle>(*buf));
+    return handle;
+  }
+
+  void Insert(KeyHandle handle) override {
+    rep_->Insert(handle);
+    index_.Insert(static_cast<const char*>(handle));
+  }
+
+  bool Contains(const char* key) const override { return rep_->Contains(key); }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    const char* entry = index_.Get(k.user_key());
+    if (entry != nullptr) {
+      callback_func(callback_args, entry);
+    }
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    return rep_->ApproximateMemoryUsage();
+  }
+
+  Iterator* GetIterator(Arena* arena) override {
+    return rep_->GetIterator(arena);
+  }
+
+ private:
+  std::unique_ptr<MemTableRep> rep_;
+  MemTableHashIndex index_;
+};
+
 // Helper for quickly generating random data.
 class RandomGenerator {
  private:
@@ -578,6 +629,8 @@ int main(int argc, char** argv) {
   std::unique_ptr<rocksdb::MemTableRepFactory> factory;
   if (FLAGS_memtablerep == "skiplist") {
     factory.reset(new rocksdb::SkipListFactory);
+  } else if (FLAGS_memtablerep == "btree") {
+    factory.reset(new rocksdb::BTreeRepFactory);
 #ifndef ROCKSDB_LITE
   } else if (FLAGS_memtablerep == "vector") {
     factory.reset(new rocksdb::VectorRepFactory);
@@ -599,6 +652,12 @@ int main(int argc, char** argv) {
     fprintf(stdout, "Unknown memtablerep: %s\n", FLAGS_memtablerep.c_str());
     exit(1);
   }
+  if (FLAGS_hash_index && FLAGS_memtablerep != "skiplist" &&
+      FLAGS_memtablerep != "btree" && FLAGS_memtablerep != "vector") {
+    fprintf(stdout, "hash_index is not supported with memtablerep %s\n",
+            FLAGS_memtablerep.c_str());
+    exit(1);
+  }
 
   rocksdb::InternalKeyComparator internal_key_comp(
       rocksdb::BytewiseComparator());
@@ -608,9 +667,14 @@ int main(int argc, char** argv) {
   uint64_t sequence;
   auto createMemtableRep = [&] {
     sequence = 0;
-    return factory->CreateMemTableRep(key_comp, &arena,
-                                      options.prefix_extractor.get(),
-                                      options.info_log.get());
+    rocksdb::MemTableRep* rep = factory->CreateMemTableRep(
+        key_comp, &arena, options.prefix_extractor.get(),
+        options.info_log.get());
+    if (FLAGS_hash_index) {
+      rep = new rocksdb::HashIndexedRep(
+          &arena, rep, static_cast<uint32_t>(FLAGS_bucket_count));
+    }
+    return rep;
   };
   std::unique_ptr<rocksdb::MemTableRep> memtablerep;
   rocksdb::Random64 rng(FLAGS_seed);
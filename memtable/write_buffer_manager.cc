@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+#include <algorithm>
+#include <chrono>
 #include <mutex>
 #include "util/coding.h"
 
@@ -49,9 +51,13 @@ struct WriteBufferManager::CacheRep {};
 #endif  // ROCKSDB_LITE
 
 WriteBufferManager::WriteBufferManager(size_t _buffer_size,
-                                       std::shared_ptr<Cache> cache)
+                                       std::shared_ptr<Cache> cache,
+                                       size_t _stop_limit)
     : buffer_size_(_buffer_size),
       mutable_limit_(buffer_size_ * 7 / 8),
+      stop_limit_(_buffer_size == 0 || _stop_limit == 0
+                      ? 0
+                      : std::max(_stop_limit, _buffer_size)),
       memory_used_(0),
       memory_active_(0),
       cache_rep_(nullptr) {
@@ -127,4 +133,17 @@ void WriteBufferManager::FreeMemWithCache(size_t mem) {
   (void)mem;
 #endif  // ROCKSDB_LITE
 }
+
+void WriteBufferManager::WaitWhileWritesStopped(uint64_t timeout_micros) {
+  std::unique_lock<std::mutex> lock(stop_mutex_);
+  // FreeMem() notifies under stop_mutex_ after updating memory_used_, so
+  // checking the condition under the lock cannot miss the wakeup.
+  stop_cv_.wait_for(lock, std::chrono::microseconds(timeout_micros),
+                    [this] { return !ShouldStopWrites(); });
+}
+
+void WriteBufferManager::EndWriteStop() {
+  std::lock_guard<std::mutex> lock(stop_mutex_);
+  stop_cv_.notify_all();
+}
 }  // namespace rocksdb
@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "rocksdb/write_buffer_manager.h"
+#include <atomic>
+#include "port/port.h"
 #include "test_util/testharness.h"
 
 namespace rocksdb {
@@ -50,6 +52,52 @@ TEST_F(WriteBufferManagerTest, ShouldFlush) {
   ASSERT_FALSE(wbf->ShouldFlush());
 }
 
+TEST_F(WriteBufferManagerTest, StopLimit) {
+  // No stop limit: writes are never throttled.
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(10 * 1024 * 1024));
+  wbf->ReserveMem(20 * 1024 * 1024);
+  ASSERT_EQ(0U, wbf->stop_limit());
+  ASSERT_FALSE(wbf->ShouldDelayWrites());
+  ASSERT_FALSE(wbf->ShouldStopWrites());
+
+  // A stop limit below the buffer size is raised to it.
+  wbf.reset(new WriteBufferManager(10 * 1024 * 1024, {}, 1024));
+  ASSERT_EQ(10U * 1024 * 1024, wbf->stop_limit());
+  // And ignored without a buffer size.
+  wbf.reset(new WriteBufferManager(0, {}, 1024));
+  ASSERT_EQ(0U, wbf->stop_limit());
+
+  wbf.reset(new WriteBufferManager(10 * 1024 * 1024, {}, 15 * 1024 * 1024));
+  wbf->ReserveMem(9 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldDelayWrites());
+  ASSERT_FALSE(wbf->ShouldStopWrites());
+  wbf->ReserveMem(1 * 1024 * 1024);
+  ASSERT_TRUE(wbf->ShouldDelayWrites());
+  ASSERT_FALSE(wbf->ShouldStopWrites());
+  // Scheduling a flush does not free memory yet.
+  wbf->ScheduleFreeMem(10 * 1024 * 1024);
+  wbf->ReserveMem(5 * 1024 * 1024);
+  ASSERT_TRUE(wbf->ShouldDelayWrites());
+  ASSERT_TRUE(wbf->ShouldStopWrites());
+
+  // A stopped writer is woken up when memory drops below the stop limit.
+  std::atomic<bool> woken(false);
+  port::Thread waiter([&]() {
+    wbf->WaitWhileWritesStopped(60 * 1000 * 1000);
+    woken.store(true);
+  });
+  wbf->FreeMem(512 * 1024);
+  wbf->FreeMem(512 * 1024);
+  waiter.join();
+  ASSERT_TRUE(woken.load());
+  ASSERT_FALSE(wbf->ShouldStopWrites());
+  ASSERT_TRUE(wbf->ShouldDelayWrites());
+
+  wbf->FreeMem(5 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldDelayWrites());
+}
+
 TEST_F(WriteBufferManagerTest, CacheCost) {
   LRUCacheOptions co;
   // 1GB cache
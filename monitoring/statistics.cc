@@ -176,6 +176,12 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
      "rocksdb.block.cache.compression.dict.bytes.insert"},
     {BLOCK_CACHE_COMPRESSION_DICT_BYTES_EVICT,
      "rocksdb.block.cache.compression.dict.bytes.evict"},
+    {WRITE_BUFFER_MANAGER_DELAY_COUNT,
+     "rocksdb.write.buffer.manager.delay.count"},
+    {WRITE_BUFFER_MANAGER_STOP_COUNT,
+     "rocksdb.write.buffer.manager.stop.count"},
+    {WRITE_BUFFER_MANAGER_STALL_MICROS,
+     "rocksdb.write.buffer.manager.stall.micros"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
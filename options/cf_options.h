@@ -135,6 +135,7 @@ struct MutableCFOptions {
         memtable_prefix_bloom_size_ratio(
             options.memtable_prefix_bloom_size_ratio),
         memtable_whole_key_filtering(options.memtable_whole_key_filtering),
+        memtable_hash_index_size_ratio(options.memtable_hash_index_size_ratio),
         memtable_huge_page_size(options.memtable_huge_page_size),
         max_successive_merges(options.max_successive_merges),
         inplace_update_num_locks(options.inplace_update_num_locks),
@@ -164,7 +165,14 @@ struct MutableCFOptions {
         paranoid_file_checks(options.paranoid_file_checks),
         report_bg_io_stats(options.report_bg_io_stats),
         compression(options.compression),
-        sample_for_compression(options.sample_for_compression) {
+        sample_for_compression(options.sample_for_compression),
+        enable_blob_files(options.enable_blob_files),
+        min_blob_size(options.min_blob_size),
+        blob_file_size(options.blob_file_size),
+        blob_compression_type(options.blob_compression_type),
+        enable_blob_garbage_collection(options.enable_blob_garbage_collection),
+        blob_garbage_collection_age_cutoff(
+            options.blob_garbage_collection_age_cutoff) {
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
   }
 
@@ -174,6 +182,7 @@ struct MutableCFOptions {
         arena_block_size(0),
         memtable_prefix_bloom_size_ratio(0),
         memtable_whole_key_filtering(false),
+        memtable_hash_index_size_ratio(0),
         memtable_huge_page_size(0),
         max_successive_merges(0),
         inplace_update_num_locks(0),
@@ -196,7 +205,13 @@ struct MutableCFOptions {
         paranoid_file_checks(false),
         report_bg_io_stats(false),
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
-        sample_for_compression(0) {}
+        sample_for_compression(0),
+        enable_blob_files(false),
+        min_blob_size(0),
+        blob_file_size(0),
+        blob_compression_type(kNoCompression),
+        enable_blob_garbage_collection(false),
+        blob_garbage_collection_age_cutoff(0.0) {}
 
   explicit MutableCFOptions(const Options& options);
 
@@ -223,6 +238,7 @@ struct MutableCFOptions {
   size_t arena_block_size;
   double memtable_prefix_bloom_size_ratio;
   bool memtable_whole_key_filtering;
+  double memtable_hash_index_size_ratio;
   size_t memtable_huge_page_size;
   size_t max_successive_merges;
   size_t inplace_update_num_locks;
@@ -253,6 +269,14 @@ struct MutableCFOptions {
   CompressionType compression;
   uint64_t sample_for_compression;
 
+  // Blob file related options
+  bool enable_blob_files;
+  uint64_t min_blob_size;
+  uint64_t blob_file_size;
+  CompressionType blob_compression_type;
+  bool enable_blob_garbage_collection;
+  double blob_garbage_collection_age_cutoff;
+
   // Derived options
   // Per-level target file size.
   std::vector<uint64_t> max_file_size;
@@ -14,6 +14,7 @@
 #include "rocksdb/file_system.h"
 #include "rocksdb/sst_file_manager.h"
 #include "rocksdb/wal_filter.h"
+#include "util/compression.h"
 
 namespace rocksdb {
 
@@ -69,6 +70,8 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       enable_pipelined_write(options.enable_pipelined_write),
       unordered_write(options.unordered_write),
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
+      max_memtable_insert_threads_per_batch(
+          options.max_memtable_insert_threads_per_batch),
       enable_write_thread_adaptive_yield(
           options.enable_write_thread_adaptive_yield),
       write_thread_max_yield_usec(options.write_thread_max_yield_usec),
@@ -76,7 +79,10 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       skip_checking_sst_file_sizes_on_db_open(
           options.skip_checking_sst_file_sizes_on_db_open),
+      skip_opening_sst_files_on_db_open(
+          options.skip_opening_sst_files_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
+      wal_recovery_threads(options.wal_recovery_threads),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
 #ifndef ROCKSDB_LITE
@@ -89,11 +95,15 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       preserve_deletes(options.preserve_deletes),
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
+      wal_compression(options.wal_compression),
       atomic_flush(options.atomic_flush),
       avoid_unnecessary_blocking_io(options.avoid_unnecessary_blocking_io),
       persist_stats_to_disk(options.persist_stats_to_disk),
       write_dbid_to_manifest(options.write_dbid_to_manifest),
-      log_readahead_size(options.log_readahead_size) {
+      log_readahead_size(options.log_readahead_size),
+      skip_listing_unchanged_wal_dir(options.skip_listing_unchanged_wal_dir),
+      async_compaction_readahead(options.async_compaction_readahead),
+      compaction_service(options.compaction_service) {
 }
 
 void ImmutableDBOptions::Dump(Logger* log) const {
@@ -193,6 +203,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       sst_file_manager ? sst_file_manager->GetDeleteRateBytesPerSecond() : 0);
   ROCKS_LOG_HEADER(log, "                      Options.wal_recovery_mode: %d",
                    static_cast<int>(wal_recovery_mode));
+  ROCKS_LOG_HEADER(
+      log, "                   Options.wal_recovery_threads: %" ROCKSDB_PRIszt,
+      wal_recovery_threads);
   ROCKS_LOG_HEADER(log, "                 Options.enable_thread_tracking: %d",
                    enable_thread_tracking);
   ROCKS_LOG_HEADER(log, "                 Options.enable_pipelined_write: %d",
@@ -201,6 +214,9 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    unordered_write);
   ROCKS_LOG_HEADER(log, "        Options.allow_concurrent_memtable_write: %d",
                    allow_concurrent_memtable_write);
+  ROCKS_LOG_HEADER(
+      log, "  Options.max_memtable_insert_threads_per_batch: %" ROCKSDB_PRIszt,
+      max_memtable_insert_threads_per_batch);
   ROCKS_LOG_HEADER(log, "     Options.enable_write_thread_adaptive_yield: %d",
                    enable_write_thread_adaptive_yield);
   ROCKS_LOG_HEADER(log,
@@ -233,6 +249,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    two_write_queues);
   ROCKS_LOG_HEADER(log, "            Options.manual_wal_flush: %d",
                    manual_wal_flush);
+  ROCKS_LOG_HEADER(log, "             Options.wal_compression: %s",
+                   CompressionTypeToString(wal_compression).c_str());
   ROCKS_LOG_HEADER(log, "            Options.atomic_flush: %d", atomic_flush);
   ROCKS_LOG_HEADER(log,
                    "            Options.avoid_unnecessary_blocking_io: %d",
@@ -244,6 +262,12 @@ void ImmutableDBOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, "                Options.log_readahead_size: %" ROCKSDB_PRIszt,
       log_readahead_size);
+  ROCKS_LOG_HEADER(log, "    Options.skip_listing_unchanged_wal_dir: %d",
+                   skip_listing_unchanged_wal_dir);
+  ROCKS_LOG_HEADER(log, "        Options.async_compaction_readahead: %d",
+                   async_compaction_readahead);
+  ROCKS_LOG_HEADER(log, "                Options.compaction_service: %s",
+                   compaction_service ? compaction_service->Name() : "None");
 }
 
 MutableDBOptions::MutableDBOptions()
@@ -64,12 +64,15 @@ struct ImmutableDBOptions {
   bool enable_pipelined_write;
   bool unordered_write;
   bool allow_concurrent_memtable_write;
+  size_t max_memtable_insert_threads_per_batch;
   bool enable_write_thread_adaptive_yield;
   uint64_t write_thread_max_yield_usec;
   uint64_t write_thread_slow_yield_usec;
   bool skip_stats_update_on_db_open;
   bool skip_checking_sst_file_sizes_on_db_open;
+  bool skip_opening_sst_files_on_db_open;
   WALRecoveryMode wal_recovery_mode;
+  size_t wal_recovery_threads;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
 #ifndef ROCKSDB_LITE
@@ -82,11 +85,15 @@ struct ImmutableDBOptions {
   bool preserve_deletes;
   bool two_write_queues;
   bool manual_wal_flush;
+  CompressionType wal_compression;
   bool atomic_flush;
   bool avoid_unnecessary_blocking_io;
   bool persist_stats_to_disk;
   bool write_dbid_to_manifest;
   size_t log_readahead_size;
+  bool skip_listing_unchanged_wal_dir;
+  bool async_compaction_readahead;
+  std::shared_ptr<CompactionService> compaction_service;
 };
 
 struct MutableDBOptions {
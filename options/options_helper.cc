@@ -109,6 +109,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.unordered_write = immutable_db_options.unordered_write;
   options.allow_concurrent_memtable_write =
       immutable_db_options.allow_concurrent_memtable_write;
+  options.max_memtable_insert_threads_per_batch =
+      immutable_db_options.max_memtable_insert_threads_per_batch;
   options.enable_write_thread_adaptive_yield =
       immutable_db_options.enable_write_thread_adaptive_yield;
   options.max_write_batch_group_size_bytes =
@@ -121,7 +123,10 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.skip_stats_update_on_db_open;
   options.skip_checking_sst_file_sizes_on_db_open =
       immutable_db_options.skip_checking_sst_file_sizes_on_db_open;
+  options.skip_opening_sst_files_on_db_open =
+      immutable_db_options.skip_opening_sst_files_on_db_open;
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
+  options.wal_recovery_threads = immutable_db_options.wal_recovery_threads;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
 #ifndef ROCKSDB_LITE
@@ -140,10 +145,16 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.preserve_deletes;
   options.two_write_queues = immutable_db_options.two_write_queues;
   options.manual_wal_flush = immutable_db_options.manual_wal_flush;
+  options.wal_compression = immutable_db_options.wal_compression;
   options.atomic_flush = immutable_db_options.atomic_flush;
   options.avoid_unnecessary_blocking_io =
       immutable_db_options.avoid_unnecessary_blocking_io;
   options.log_readahead_size = immutable_db_options.log_readahead_size;
+  options.skip_listing_unchanged_wal_dir =
+      immutable_db_options.skip_listing_unchanged_wal_dir;
+  options.async_compaction_readahead =
+      immutable_db_options.async_compaction_readahead;
+  options.compaction_service = immutable_db_options.compaction_service;
   return options;
 }
 
@@ -160,6 +171,8 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
       mutable_cf_options.memtable_prefix_bloom_size_ratio;
   cf_opts.memtable_whole_key_filtering =
       mutable_cf_options.memtable_whole_key_filtering;
+  cf_opts.memtable_hash_index_size_ratio =
+      mutable_cf_options.memtable_hash_index_size_ratio;
   cf_opts.memtable_huge_page_size = mutable_cf_options.memtable_huge_page_size;
   cf_opts.max_successive_merges = mutable_cf_options.max_successive_merges;
   cf_opts.inplace_update_num_locks =
@@ -209,6 +222,16 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.compression = mutable_cf_options.compression;
   cf_opts.sample_for_compression = mutable_cf_options.sample_for_compression;
 
+  // Blob file related options
+  cf_opts.enable_blob_files = mutable_cf_options.enable_blob_files;
+  cf_opts.min_blob_size = mutable_cf_options.min_blob_size;
+  cf_opts.blob_file_size = mutable_cf_options.blob_file_size;
+  cf_opts.blob_compression_type = mutable_cf_options.blob_compression_type;
+  cf_opts.enable_blob_garbage_collection =
+      mutable_cf_options.enable_blob_garbage_collection;
+  cf_opts.blob_garbage_collection_age_cutoff =
+      mutable_cf_options.blob_garbage_collection_age_cutoff;
+
   cf_opts.table_factory = options.table_factory;
   // TODO(yhchiang): find some way to handle the following derived options
   // * max_file_size
@@ -980,8 +1003,19 @@ Status ParseCompressionOptions(const std::string& value, const std::string& name
       return Status::InvalidArgument(
           "unable to parse the specified CF option " + name);
     }
+    end = value.find(':', start);
     compression_opts.enabled =
-        ParseBoolean("", value.substr(start, value.size() - start));
+        ParseBoolean("", value.substr(start, end - start));
+  }
+  // parallel_threads is optional for backwards compatibility
+  if (end != std::string::npos) {
+    start = end + 1;
+    if (start >= value.size()) {
+      return Status::InvalidArgument(
+          "unable to parse the specified CF option " + name);
+    }
+    compression_opts.parallel_threads =
+        ParseUint32(value.substr(start, value.size() - start));
   }
   return Status::OK();
 }
@@ -1478,6 +1512,9 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"skip_checking_sst_file_sizes_on_db_open",
          {offsetof(struct DBOptions, skip_checking_sst_file_sizes_on_db_open),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"skip_opening_sst_files_on_db_open",
+         {offsetof(struct DBOptions, skip_opening_sst_files_on_db_open),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"new_table_reader_for_compaction_inputs",
          {offsetof(struct DBOptions, new_table_reader_for_compaction_inputs),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -1608,10 +1645,16 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"allow_concurrent_memtable_write",
          {offsetof(struct DBOptions, allow_concurrent_memtable_write),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"max_memtable_insert_threads_per_batch",
+         {offsetof(struct DBOptions, max_memtable_insert_threads_per_batch),
+          OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
         {"wal_recovery_mode",
          {offsetof(struct DBOptions, wal_recovery_mode),
           OptionType::kWALRecoveryMode, OptionVerificationType::kNormal, false,
           0}},
+        {"wal_recovery_threads",
+         {offsetof(struct DBOptions, wal_recovery_threads), OptionType::kSizeT,
+          OptionVerificationType::kNormal, false, 0}},
         {"enable_write_thread_adaptive_yield",
          {offsetof(struct DBOptions, enable_write_thread_adaptive_yield),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -1663,6 +1706,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct DBOptions, manual_wal_flush), OptionType::kBoolean,
           OptionVerificationType::kNormal, false,
           offsetof(struct ImmutableDBOptions, manual_wal_flush)}},
+        {"wal_compression",
+         {offsetof(struct DBOptions, wal_compression),
+          OptionType::kCompressionType, OptionVerificationType::kNormal, false,
+          offsetof(struct ImmutableDBOptions, wal_compression)}},
         {"seq_per_batch",
          {0, OptionType::kBoolean, OptionVerificationType::kDeprecated, false,
           0}},
@@ -1680,6 +1727,12 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"log_readahead_size",
          {offsetof(struct DBOptions, log_readahead_size), OptionType::kSizeT,
           OptionVerificationType::kNormal, false, 0}},
+        {"skip_listing_unchanged_wal_dir",
+         {offsetof(struct DBOptions, skip_listing_unchanged_wal_dir),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"async_compaction_readahead",
+         {offsetof(struct DBOptions, async_compaction_readahead),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
 };
 
 std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
@@ -1940,6 +1993,10 @@ std::unordered_map<std::string, OptionTypeInfo>
          {offset_of(&ColumnFamilyOptions::memtable_whole_key_filtering),
           OptionType::kBoolean, OptionVerificationType::kNormal, true,
           offsetof(struct MutableCFOptions, memtable_whole_key_filtering)}},
+        {"memtable_hash_index_size_ratio",
+         {offset_of(&ColumnFamilyOptions::memtable_hash_index_size_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, memtable_hash_index_size_ratio)}},
         {"min_partial_merge_operands",
          {0, OptionType::kUInt32T, OptionVerificationType::kDeprecated, true,
           0}},
@@ -2043,7 +2100,32 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"sample_for_compression",
          {offset_of(&ColumnFamilyOptions::sample_for_compression),
           OptionType::kUInt64T, OptionVerificationType::kNormal, true,
-          offsetof(struct MutableCFOptions, sample_for_compression)}}};
+          offsetof(struct MutableCFOptions, sample_for_compression)}},
+        {"enable_blob_files",
+         {offset_of(&ColumnFamilyOptions::enable_blob_files),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, enable_blob_files)}},
+        {"min_blob_size",
+         {offset_of(&ColumnFamilyOptions::min_blob_size), OptionType::kUInt64T,
+          OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, min_blob_size)}},
+        {"blob_file_size",
+         {offset_of(&ColumnFamilyOptions::blob_file_size),
+          OptionType::kUInt64T, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, blob_file_size)}},
+        {"blob_compression_type",
+         {offset_of(&ColumnFamilyOptions::blob_compression_type),
+          OptionType::kCompressionType, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, blob_compression_type)}},
+        {"enable_blob_garbage_collection",
+         {offset_of(&ColumnFamilyOptions::enable_blob_garbage_collection),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, enable_blob_garbage_collection)}},
+        {"blob_garbage_collection_age_cutoff",
+         {offset_of(&ColumnFamilyOptions::blob_garbage_collection_age_cutoff),
+          OptionType::kDouble, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions,
+                   blob_garbage_collection_age_cutoff)}}};
 
 std::unordered_map<std::string, OptionTypeInfo>
     OptionsHelper::fifo_compaction_options_type_info = {
@@ -246,8 +246,14 @@ void DataBlockIter::Seek(const Slice& target) {
     return;
   }
   uint32_t index = 0;
-  bool ok = BinarySeek<DecodeKey>(seek_key, 0, num_restarts_ - 1, &index,
-                                  comparator_);
+  uint32_t left = 0;
+  uint32_t right = num_restarts_ - 1;
+  if (restart_key_prefixes_ != nullptr) {
+    restart_key_prefixes_->FindRestartRange(ExtractUserKey(seek_key), &left,
+                                            &right);
+  }
+  bool ok =
+      BinarySeek<DecodeKey>(seek_key, left, right, &index, comparator_);
 
   if (!ok) {
     return;
@@ -288,6 +294,9 @@ void DataBlockIter::Seek(const Slice& target) {
 bool DataBlockIter::SeekForGetImpl(const Slice& target) {
   Slice target_user_key = ExtractUserKey(target);
   uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
+  if (restart_key_prefixes_ != nullptr) {
+    map_offset += num_restarts_ * static_cast<uint32_t>(sizeof(uint64_t));
+  }
   uint8_t entry =
       data_block_hash_index_->Lookup(data_, map_offset, target_user_key);
 
@@ -431,8 +440,14 @@ void DataBlockIter::SeekForPrev(const Slice& target) {
     return;
   }
   uint32_t index = 0;
-  bool ok = BinarySeek<DecodeKey>(seek_key, 0, num_restarts_ - 1, &index,
-                                  comparator_);
+  uint32_t left = 0;
+  uint32_t right = num_restarts_ - 1;
+  if (restart_key_prefixes_ != nullptr) {
+    restart_key_prefixes_->FindRestartRange(ExtractUserKey(seek_key), &left,
+                                            &right);
+  }
+  bool ok =
+      BinarySeek<DecodeKey>(seek_key, left, right, &index, comparator_);
 
   if (!ok) {
     return;
@@ -868,6 +883,21 @@ BlockBasedTableOptions::DataBlockIndexType Block::IndexType() const {
   return index_type;
 }
 
+bool Block::HasRestartKeyPrefixes() const {
+  assert(size_ >= 2 * sizeof(uint32_t));
+  if (size_ > kMaxBlockSizeSupportedByHashIndex) {
+    // The check is for the same reason as that in NumRestarts()
+    return false;
+  }
+  uint32_t block_footer = DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  uint32_t num_restarts = block_footer;
+  BlockBasedTableOptions::DataBlockIndexType index_type;
+  bool has_restart_key_prefixes = false;
+  UnPackIndexTypeAndNumRestarts(block_footer, &index_type, &num_restarts,
+                                &has_restart_key_prefixes);
+  return has_restart_key_prefixes;
+}
+
 Block::~Block() {
   // This sync point can be re-enabled if RocksDB can control the
   // initialization order of any/all static options created by the user.
@@ -888,10 +918,22 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
   } else {
     // Should only decode restart points for uncompressed blocks
     num_restarts_ = NumRestarts();
+    // Restart key prefixes sit between the restart array and what follows
+    // it, if anything.
+    uint32_t prefixes_size = 0;
+    if (size_ >= 2 * sizeof(uint32_t) && HasRestartKeyPrefixes()) {
+      // A NumRestarts() too large for the block makes restart_offset_ wrap
+      // around below rather than the multiplication overflow.
+      prefixes_size = num_restarts_ <= size_ / sizeof(uint64_t)
+                          ? num_restarts_ *
+                                static_cast<uint32_t>(sizeof(uint64_t))
+                          : static_cast<uint32_t>(size_);
+    }
     switch (IndexType()) {
       case BlockBasedTableOptions::kDataBlockBinarySearch:
         restart_offset_ = static_cast<uint32_t>(size_) -
-                          (1 + num_restarts_) * sizeof(uint32_t);
+                          (1 + num_restarts_) * sizeof(uint32_t) -
+                          prefixes_size;
         if (restart_offset_ > size_ - sizeof(uint32_t)) {
           // The size is too small for NumRestarts() and therefore
           // restart_offset_ wrapped around.
@@ -913,7 +955,8 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
                                                  NUM_RESTARTS*/
             &map_offset);
 
-        restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t);
+        restart_offset_ =
+            map_offset - num_restarts_ * sizeof(uint32_t) - prefixes_size;
 
         if (restart_offset_ > map_offset) {
           // map_offset is too small for NumRestarts() and
@@ -925,6 +968,11 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
       default:
         size_ = 0;  // Error marker
     }
+    if (size_ != 0 && prefixes_size != 0) {
+      data_block_restart_key_prefixes_.Initialize(
+          data_ + restart_offset_ + num_restarts_ * sizeof(uint32_t),
+          num_restarts_);
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
@@ -954,7 +1002,10 @@ DataBlockIter* Block::NewDataIterator(const Comparator* cmp,
     ret_iter->Initialize(
         cmp, ucmp, data_, restart_offset_, num_restarts_, global_seqno_,
         read_amp_bitmap_.get(), block_contents_pinned,
-        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr);
+        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
+        data_block_restart_key_prefixes_.Valid()
+            ? &data_block_restart_key_prefixes_
+            : nullptr);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
@@ -22,6 +22,7 @@
 #include "rocksdb/table.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_hash_index.h"
+#include "table/block_based/data_block_restart_key_prefixes.h"
 #include "table/format.h"
 #include "table/internal_iterator.h"
 #include "test_util/sync_point.h"
@@ -231,6 +232,11 @@ class Block {
   const SequenceNumber global_seqno_;
 
   DataBlockHashIndex data_block_hash_index_;
+  DataBlockRestartKeyPrefixes data_block_restart_key_prefixes_;
+
+  // Whether the block ends with restart key prefixes. See
+  // data_block_restart_key_prefixes.h.
+  bool HasRestartKeyPrefixes() const;
 };
 
 template <class TValue>
@@ -371,11 +377,12 @@ class DataBlockIter final : public BlockIter<Slice> {
                 const char* data, uint32_t restarts, uint32_t num_restarts,
                 SequenceNumber global_seqno,
                 BlockReadAmpBitmap* read_amp_bitmap, bool block_contents_pinned,
-                DataBlockHashIndex* data_block_hash_index)
+                DataBlockHashIndex* data_block_hash_index,
+                const DataBlockRestartKeyPrefixes* restart_key_prefixes)
       : DataBlockIter() {
     Initialize(comparator, user_comparator, data, restarts, num_restarts,
                global_seqno, read_amp_bitmap, block_contents_pinned,
-               data_block_hash_index);
+               data_block_hash_index, restart_key_prefixes);
   }
   void Initialize(const Comparator* comparator,
                   const Comparator* user_comparator, const char* data,
@@ -383,7 +390,8 @@ class DataBlockIter final : public BlockIter<Slice> {
                   SequenceNumber global_seqno,
                   BlockReadAmpBitmap* read_amp_bitmap,
                   bool block_contents_pinned,
-                  DataBlockHashIndex* data_block_hash_index) {
+                  DataBlockHashIndex* data_block_hash_index,
+                  const DataBlockRestartKeyPrefixes* restart_key_prefixes) {
     InitializeBase(comparator, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned);
     user_comparator_ = user_comparator;
@@ -391,6 +399,7 @@ class DataBlockIter final : public BlockIter<Slice> {
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    restart_key_prefixes_ = restart_key_prefixes;
   }
 
   virtual Slice value() const override {
@@ -473,6 +482,7 @@ class DataBlockIter final : public BlockIter<Slice> {
   int32_t prev_entries_idx_ = -1;
 
   DataBlockHashIndex* data_block_hash_index_;
+  const DataBlockRestartKeyPrefixes* restart_key_prefixes_;
   const Comparator* user_comparator_;
 
   template <typename DecodeEntryFunc>
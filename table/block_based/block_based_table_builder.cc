@@ -11,6 +11,9 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <chrono>
+#include <deque>
+#include <future>
 #include <list>
 #include <map>
 #include <memory>
@@ -41,6 +44,8 @@
 #include "table/table_builder.h"
 
 #include "memory/memory_allocator.h"
+#include "port/port.h"
+#include "util/channel.h"
 #include "util/coding.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
@@ -275,6 +280,66 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
   bool prefix_filtering_;
 };
 
+// State of the parallel compression pipeline, used when
+// `CompressionOptions::parallel_threads > 1`. Finished data blocks are queued
+// to a pool of compression threads, and the thread building the table writes
+// them out in their original order as they complete. Keys of a data block are
+// only fed to the filter and index builders when the block is written, so
+// those builders see exactly the same sequence of calls as in a serial build
+// and the resulting file is identical.
+struct BlockBasedTableBuilder::ParallelCompressionRep {
+  // A data block travelling through the pipeline.
+  struct BlockRep {
+    std::string raw_contents;
+    std::vector<std::string> keys;
+    bool has_next_block = false;
+    std::string first_key_in_next_block;
+
+    // Set by the compression thread. `contents` points either into
+    // `raw_contents` or into `compressed_output`.
+    std::string compressed_output;
+    Slice contents;
+    CompressionType type = kNoCompression;
+    size_t sampled_output_fast_size = 0;
+    size_t sampled_output_slow_size = 0;
+    Status status;
+  };
+
+  struct CompressionWorkItem {
+    BlockRep* block = nullptr;
+    std::promise<void> done;
+  };
+
+  struct PendingBlock {
+    std::unique_ptr<BlockRep> block;
+    std::future<void> done;
+  };
+
+  // Number of blocks per compression thread allowed to be queued or in
+  // compression before the building thread waits for the oldest one.
+  static const size_t kMaxPendingBlocksPerThread = 2;
+
+  explicit ParallelCompressionRep(uint32_t parallel_threads)
+      : num_threads(parallel_threads),
+        max_pending_blocks(kMaxPendingBlocksPerThread * parallel_threads) {}
+
+  const uint32_t num_threads;
+  const size_t max_pending_blocks;
+  channel<CompressionWorkItem> compress_queue;
+  std::vector<port::Thread> threads;
+
+  // Blocks handed to the compression threads and not yet written, in file
+  // order. Only accessed by the thread building the table.
+  std::deque<PendingBlock> pending_blocks;
+  // Keys of the data block currently being built.
+  std::vector<std::string> curr_block_keys;
+
+  // Used to estimate the file size while blocks are still pending.
+  uint64_t pending_raw_bytes = 0;
+  uint64_t written_raw_bytes = 0;
+  uint64_t written_bytes = 0;
+};
+
 struct BlockBasedTableBuilder::Rep {
   const ImmutableCFOptions ioptions;
   const MutableCFOptions moptions;
@@ -355,6 +420,12 @@ struct BlockBasedTableBuilder::Rep {
 
   std::vector<std::unique_ptr<IntTblPropCollector>> table_properties_collectors;
 
+  // First key of the data block following the one being flushed, or nullptr
+  // when flushing the last data block. Only used by parallel compression,
+  // which adds index entries when blocks are written rather than in Add().
+  const Slice* first_key_in_next_block = nullptr;
+  std::unique_ptr<ParallelCompressionRep> pc_rep;
+
   Rep(const ImmutableCFOptions& _ioptions, const MutableCFOptions& _moptions,
       const BlockBasedTableOptions& table_opt,
       const InternalKeyComparator& icomparator,
@@ -382,7 +453,9 @@ struct BlockBasedTableBuilder::Rep {
                            ->CanKeysWithDifferentByteContentsBeEqual()
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
-                   table_options.data_block_hash_table_util_ratio),
+                   table_options.data_block_hash_table_util_ratio,
+                   table_options.data_block_restart_key_prefixes &&
+                       icomparator.user_comparator() == BytewiseComparator()),
         range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(_moptions.prefix_extractor.get()),
         compression_type(_compression_type),
@@ -443,6 +516,10 @@ struct BlockBasedTableBuilder::Rep {
       verify_ctx.reset(new UncompressionContext(UncompressionContext::NoCache(),
                                                 compression_type));
     }
+    if (compression_opts.parallel_threads > 1) {
+      pc_rep.reset(
+          new ParallelCompressionRep(compression_opts.parallel_threads));
+    }
   }
 
   Rep(const Rep&) = delete;
@@ -492,6 +569,11 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
         &rep_->compressed_cache_key_prefix[0],
         &rep_->compressed_cache_key_prefix_size);
   }
+  if (rep_->pc_rep != nullptr) {
+    for (uint32_t i = 0; i < rep_->pc_rep->num_threads; i++) {
+      rep_->pc_rep->threads.emplace_back([this]() { BGWorkCompression(); });
+    }
+  }
 }
 
 BlockBasedTableBuilder::~BlockBasedTableBuilder() {
@@ -515,6 +597,7 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     auto should_flush = r->flush_block_policy->Update(key, value);
     if (should_flush) {
       assert(!r->data_block.empty());
+      r->first_key_in_next_block = &key;
       Flush();
 
       if (r->state == Rep::State::kBuffered &&
@@ -530,14 +613,19 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       // "the r" as the key for the index block entry since it is >= all
       // entries in the first block and < all entries in subsequent
       // blocks.
-      if (ok() && r->state == Rep::State::kUnbuffered) {
+      //
+      // With parallel compression the block may not be written yet, so the
+      // entry is added when it is (see WriteCompressedDataBlock()).
+      if (ok() && r->state == Rep::State::kUnbuffered &&
+          r->pc_rep == nullptr) {
         r->index_builder->AddIndexEntry(&r->last_key, &key, r->pending_handle);
       }
     }
 
     // Note: PartitionedFilterBlockBuilder requires key being added to filter
     // builder after being added to index builder.
-    if (r->state == Rep::State::kUnbuffered && r->filter_builder != nullptr) {
+    if (r->state == Rep::State::kUnbuffered && r->pc_rep == nullptr &&
+        r->filter_builder != nullptr) {
       size_t ts_sz = r->internal_comparator.user_comparator()->timestamp_size();
       r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
     }
@@ -551,6 +639,9 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
         r->data_block_and_keys_buffers.emplace_back();
       }
       r->data_block_and_keys_buffers.back().second.emplace_back(key.ToString());
+    } else if (r->pc_rep != nullptr) {
+      // Replayed into the filter and index builders when the block is written.
+      r->pc_rep->curr_block_keys.emplace_back(key.ToString());
     } else {
       r->index_builder->OnKeyAdded(key);
     }
@@ -585,7 +676,17 @@ void BlockBasedTableBuilder::Flush() {
   assert(rep_->state != Rep::State::kClosed);
   if (!ok()) return;
   if (r->data_block.empty()) return;
-  WriteBlock(&r->data_block, &r->pending_handle, true /* is_data_block */);
+  if (r->pc_rep != nullptr && r->state == Rep::State::kUnbuffered) {
+    std::string raw_block_contents = r->data_block.Finish().ToString();
+    r->data_block.Reset();
+    std::vector<std::string> keys;
+    keys.swap(r->pc_rep->curr_block_keys);
+    EmitBlockForParallelCompression(std::move(raw_block_contents),
+                                    std::move(keys),
+                                    r->first_key_in_next_block);
+  } else {
+    WriteBlock(&r->data_block, &r->pending_handle, true /* is_data_block */);
+  }
 }
 
 void BlockBasedTableBuilder::WriteBlock(BlockBuilder* block,
@@ -605,15 +706,6 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   assert(ok());
   Rep* r = rep_;
 
-  auto type = r->compression_type;
-  uint64_t sample_for_compression = r->sample_for_compression;
-  Slice block_contents;
-  bool abort_compression = false;
-
-  StopWatchNano timer(
-      r->ioptions.env,
-      ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics));
-
   if (r->state == Rep::State::kBuffered) {
     assert(is_data_block);
     assert(!r->data_block_and_keys_buffers.empty());
@@ -622,6 +714,53 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
     return;
   }
 
+  Slice block_contents;
+  CompressionType type;
+  std::string sampled_output_fast;
+  std::string sampled_output_slow;
+  Status s = CompressAndVerifyBlock(
+      raw_block_contents, is_data_block, r->compression_ctx,
+      r->verify_ctx.get(), &r->compressed_output, &block_contents, &type,
+      &sampled_output_fast, &sampled_output_slow);
+  if (raw_block_contents.size() < kCompressionSizeLimit) {
+    // notify collectors on block add
+    NotifyCollectTableCollectorsOnBlockAdd(
+        r->table_properties_collectors, raw_block_contents.size(),
+        sampled_output_fast.size(), sampled_output_slow.size());
+  }
+  if (!s.ok()) {
+    r->status = s;
+    r->compressed_output.clear();
+    return;
+  }
+
+  WriteRawBlock(block_contents, type, handle, is_data_block);
+  r->compressed_output.clear();
+  if (is_data_block) {
+    if (r->filter_builder != nullptr) {
+      r->filter_builder->StartBlock(r->offset);
+    }
+    r->props.data_size = r->offset;
+    ++r->props.num_data_blocks;
+  }
+}
+
+Status BlockBasedTableBuilder::CompressAndVerifyBlock(
+    const Slice& raw_block_contents, bool is_data_block,
+    const CompressionContext& compression_ctx,
+    UncompressionContext* verify_ctx, std::string* compressed_output,
+    Slice* block_contents, CompressionType* type,
+    std::string* sampled_output_fast, std::string* sampled_output_slow) {
+  Rep* r = rep_;
+  Status status;
+  *type = r->compression_type;
+  uint64_t sample_for_compression = r->sample_for_compression;
+  bool abort_compression = false;
+
+  StopWatchNano timer(
+      r->ioptions.env,
+      ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics));
+
   if (raw_block_contents.size() < kCompressionSizeLimit) {
     const CompressionDict* compression_dict;
     if (!is_data_block || r->compression_dict == nullptr) {
@@ -630,26 +769,20 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
       compression_dict = r->compression_dict.get();
     }
     assert(compression_dict != nullptr);
-    CompressionInfo compression_info(r->compression_opts, r->compression_ctx,
-                                     *compression_dict, type,
+    CompressionInfo compression_info(r->compression_opts, compression_ctx,
+                                     *compression_dict, *type,
                                      sample_for_compression);
 
-    std::string sampled_output_fast;
-    std::string sampled_output_slow;
-    block_contents = CompressBlock(
-        raw_block_contents, compression_info, &type,
+    *block_contents = CompressBlock(
+        raw_block_contents, compression_info, type,
         r->table_options.format_version, is_data_block /* do_sample */,
-        &r->compressed_output, &sampled_output_fast, &sampled_output_slow);
-
-    // notify collectors on block add
-    NotifyCollectTableCollectorsOnBlockAdd(
-        r->table_properties_collectors, raw_block_contents.size(),
-        sampled_output_fast.size(), sampled_output_slow.size());
+        compressed_output, sampled_output_fast, sampled_output_slow);
 
     // Some of the compression algorithms are known to be unreliable. If
     // the verify_compression flag is set then try to de-compress the
     // compressed data and compare to the input.
-    if (type != kNoCompression && r->table_options.verify_compression) {
+    if (*type != kNoCompression && r->table_options.verify_compression) {
+      assert(verify_ctx != nullptr);
       // Retrieve the uncompressed contents into a new buffer
       const UncompressionDict* verify_dict;
       if (!is_data_block || r->verify_dict == nullptr) {
@@ -659,10 +792,10 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
       }
       assert(verify_dict != nullptr);
       BlockContents contents;
-      UncompressionInfo uncompression_info(*r->verify_ctx, *verify_dict,
+      UncompressionInfo uncompression_info(*verify_ctx, *verify_dict,
                                            r->compression_type);
       Status stat = UncompressBlockContentsForCompressionType(
-          uncompression_info, block_contents.data(), block_contents.size(),
+          uncompression_info, block_contents->data(), block_contents->size(),
           &contents, r->table_options.format_version, r->ioptions);
 
       if (stat.ok()) {
@@ -672,12 +805,12 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
           abort_compression = true;
           ROCKS_LOG_ERROR(r->ioptions.info_log,
                           "Decompressed block did not match raw block");
-          r->status =
+          status =
               Status::Corruption("Decompressed block did not match raw block");
         }
       } else {
         // Decompression reported an error. abort.
-        r->status = Status::Corruption("Could not decompress");
+        status = Status::Corruption("Could not decompress");
         abort_compression = true;
       }
     }
@@ -690,9 +823,9 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   // verification.
   if (abort_compression) {
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
-    type = kNoCompression;
-    block_contents = raw_block_contents;
-  } else if (type != kNoCompression) {
+    *type = kNoCompression;
+    *block_contents = raw_block_contents;
+  } else if (*type != kNoCompression) {
     if (ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics)) {
       RecordTimeToHistogram(r->ioptions.statistics, COMPRESSION_TIMES_NANOS,
                             timer.ElapsedNanos());
@@ -700,21 +833,146 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
     RecordInHistogram(r->ioptions.statistics, BYTES_COMPRESSED,
                       raw_block_contents.size());
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_COMPRESSED);
-  } else if (type != r->compression_type) {
+  } else if (*type != r->compression_type) {
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
   }
+  return status;
+}
 
-  WriteRawBlock(block_contents, type, handle, is_data_block);
-  r->compressed_output.clear();
-  if (is_data_block) {
+void BlockBasedTableBuilder::EmitBlockForParallelCompression(
+    std::string&& raw_block_contents, std::vector<std::string>&& keys,
+    const Slice* first_key_in_next_block) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc_rep = r->pc_rep.get();
+  assert(pc_rep != nullptr);
+  assert(!keys.empty());
+
+  ParallelCompressionRep::PendingBlock pending;
+  pending.block.reset(new ParallelCompressionRep::BlockRep());
+  ParallelCompressionRep::BlockRep* block = pending.block.get();
+  block->raw_contents = std::move(raw_block_contents);
+  block->keys = std::move(keys);
+  if (first_key_in_next_block != nullptr) {
+    block->has_next_block = true;
+    block->first_key_in_next_block = first_key_in_next_block->ToString();
+  }
+
+  ParallelCompressionRep::CompressionWorkItem work_item;
+  work_item.block = block;
+  pending.done = work_item.done.get_future();
+  pc_rep->pending_raw_bytes += block->raw_contents.size();
+  pc_rep->pending_blocks.push_back(std::move(pending));
+  pc_rep->compress_queue.write(std::move(work_item));
+
+  WritePendingBlocks(pc_rep->max_pending_blocks);
+}
+
+void BlockBasedTableBuilder::WritePendingBlocks(size_t max_pending_blocks) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc_rep = r->pc_rep.get();
+  auto& pending_blocks = pc_rep->pending_blocks;
+  // Blocks stay in `pending_blocks` until they are compressed, as compression
+  // threads still reference them. On error they are released by
+  // StopParallelCompression() once the threads are done.
+  while (ok() && !pending_blocks.empty()) {
+    auto& front = pending_blocks.front();
+    if (pending_blocks.size() <= max_pending_blocks &&
+        front.done.wait_for(std::chrono::seconds(0)) !=
+            std::future_status::ready) {
+      break;
+    }
+    front.done.wait();
+    pc_rep->pending_raw_bytes -= front.block->raw_contents.size();
+    WriteCompressedDataBlock();
+    pending_blocks.pop_front();
+  }
+}
+
+void BlockBasedTableBuilder::WriteCompressedDataBlock() {
+  Rep* r = rep_;
+  ParallelCompressionRep::BlockRep* block =
+      r->pc_rep->pending_blocks.front().block.get();
+  if (!block->status.ok()) {
+    r->status = block->status;
+    return;
+  }
+
+  for (const auto& key : block->keys) {
     if (r->filter_builder != nullptr) {
-      r->filter_builder->StartBlock(r->offset);
+      size_t ts_sz =
+          r->internal_comparator.user_comparator()->timestamp_size();
+      r->filter_builder->Add(ExtractUserKeyAndStripTimestamp(key, ts_sz));
     }
-    r->props.data_size = r->offset;
-    ++r->props.num_data_blocks;
+    r->index_builder->OnKeyAdded(key);
+  }
+  if (block->raw_contents.size() < kCompressionSizeLimit) {
+    NotifyCollectTableCollectorsOnBlockAdd(
+        r->table_properties_collectors, block->raw_contents.size(),
+        block->sampled_output_fast_size, block->sampled_output_slow_size);
+  }
+
+  uint64_t offset_before = r->offset;
+  WriteRawBlock(block->contents, block->type, &r->pending_handle,
+                true /* is_data_block */);
+  if (!ok()) {
+    return;
+  }
+  r->pc_rep->written_raw_bytes += block->raw_contents.size();
+  r->pc_rep->written_bytes += r->offset - offset_before;
+  if (r->filter_builder != nullptr) {
+    r->filter_builder->StartBlock(r->offset);
+  }
+  r->props.data_size = r->offset;
+  ++r->props.num_data_blocks;
+
+  if (block->has_next_block) {
+    Slice first_key_in_next_block(block->first_key_in_next_block);
+    r->index_builder->AddIndexEntry(&block->keys.back(),
+                                    &first_key_in_next_block,
+                                    r->pending_handle);
+  } else {
+    r->index_builder->AddIndexEntry(&block->keys.back(), nullptr,
+                                    r->pending_handle);
   }
 }
 
+void BlockBasedTableBuilder::BGWorkCompression() {
+  Rep* r = rep_;
+  CompressionContext compression_ctx(r->compression_type);
+  std::unique_ptr<UncompressionContext> verify_ctx;
+  if (r->table_options.verify_compression) {
+    verify_ctx.reset(new UncompressionContext(UncompressionContext::NoCache(),
+                                              r->compression_type));
+  }
+  ParallelCompressionRep::CompressionWorkItem work_item;
+  while (r->pc_rep->compress_queue.read(work_item)) {
+    ParallelCompressionRep::BlockRep* block = work_item.block;
+    std::string sampled_output_fast;
+    std::string sampled_output_slow;
+    block->status = CompressAndVerifyBlock(
+        block->raw_contents, true /* is_data_block */, compression_ctx,
+        verify_ctx.get(), &block->compressed_output, &block->contents,
+        &block->type, &sampled_output_fast, &sampled_output_slow);
+    block->sampled_output_fast_size = sampled_output_fast.size();
+    block->sampled_output_slow_size = sampled_output_slow.size();
+    work_item.done.set_value();
+  }
+}
+
+void BlockBasedTableBuilder::StopParallelCompression() {
+  ParallelCompressionRep* pc_rep = rep_->pc_rep.get();
+  if (pc_rep == nullptr) {
+    return;
+  }
+  pc_rep->compress_queue.sendEof();
+  for (auto& thread : pc_rep->threads) {
+    thread.join();
+  }
+  pc_rep->threads.clear();
+  pc_rep->pending_blocks.clear();
+  pc_rep->pending_raw_bytes = 0;
+}
+
 void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
                                            CompressionType type,
                                            BlockHandle* handle,
@@ -1101,11 +1359,24 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
                 r->compression_type == kZSTDNotFinalCompression));
 
   for (size_t i = 0; ok() && i < r->data_block_and_keys_buffers.size(); ++i) {
-    const auto& data_block = r->data_block_and_keys_buffers[i].first;
+    auto& data_block = r->data_block_and_keys_buffers[i].first;
     auto& keys = r->data_block_and_keys_buffers[i].second;
     assert(!data_block.empty());
     assert(!keys.empty());
 
+    if (r->pc_rep != nullptr) {
+      Slice first_key_in_next_block;
+      const Slice* first_key_in_next_block_ptr = r->first_key_in_next_block;
+      if (i + 1 < r->data_block_and_keys_buffers.size()) {
+        first_key_in_next_block =
+            r->data_block_and_keys_buffers[i + 1].second.front();
+        first_key_in_next_block_ptr = &first_key_in_next_block;
+      }
+      EmitBlockForParallelCompression(std::move(data_block), std::move(keys),
+                                      first_key_in_next_block_ptr);
+      continue;
+    }
+
     for (const auto& key : keys) {
       if (r->filter_builder != nullptr) {
         size_t ts_sz =
@@ -1130,13 +1401,18 @@ Status BlockBasedTableBuilder::Finish() {
   Rep* r = rep_;
   assert(r->state != Rep::State::kClosed);
   bool empty_data_block = r->data_block.empty();
+  r->first_key_in_next_block = nullptr;
   Flush();
   if (r->state == Rep::State::kBuffered) {
     EnterUnbuffered();
   }
-  // To make sure properties block is able to keep the accurate size of index
-  // block, we will finish writing all index entries first.
-  if (ok() && !empty_data_block) {
+  if (r->pc_rep != nullptr) {
+    // Writing the remaining data blocks also adds their index entries.
+    WritePendingBlocks(0 /* max_pending_blocks */);
+    StopParallelCompression();
+  } else if (ok() && !empty_data_block) {
+    // To make sure properties block is able to keep the accurate size of
+    // index block, we will finish writing all index entries first.
     r->index_builder->AddIndexEntry(
         &r->last_key, nullptr /* no next data block */, r->pending_handle);
   }
@@ -1170,6 +1446,7 @@ Status BlockBasedTableBuilder::Finish() {
 
 void BlockBasedTableBuilder::Abandon() {
   assert(rep_->state != Rep::State::kClosed);
+  StopParallelCompression();
   rep_->state = Rep::State::kClosed;
 }
 
@@ -1177,7 +1454,21 @@ uint64_t BlockBasedTableBuilder::NumEntries() const {
   return rep_->props.num_entries;
 }
 
-uint64_t BlockBasedTableBuilder::FileSize() const { return rep_->offset; }
+uint64_t BlockBasedTableBuilder::FileSize() const {
+  const ParallelCompressionRep* pc_rep = rep_->pc_rep.get();
+  if (pc_rep == nullptr || pc_rep->pending_raw_bytes == 0) {
+    return rep_->offset;
+  }
+  // Account for blocks still being compressed using the compression ratio
+  // observed so far, so callers deciding when to cut a file are not misled.
+  uint64_t pending_bytes = pc_rep->pending_raw_bytes;
+  if (pc_rep->written_raw_bytes > 0) {
+    pending_bytes = static_cast<uint64_t>(
+        static_cast<double>(pending_bytes) * pc_rep->written_bytes /
+        pc_rep->written_raw_bytes);
+  }
+  return rep_->offset + pending_bytes;
+}
 
 bool BlockBasedTableBuilder::NeedCompact() const {
   for (const auto& collector : rep_->table_properties_collectors) {
@@ -106,6 +106,17 @@ class BlockBasedTableBuilder : public TableBuilder {
   // Compress and write block content to the file.
   void WriteBlock(const Slice& block_contents, BlockHandle* handle,
                   bool is_data_block);
+  // Compress, and verify if requested, the block contents. Only reads state
+  // that is fixed while blocks are being compressed, so it is safe to call
+  // from parallel compression threads with their own contexts.
+  Status CompressAndVerifyBlock(const Slice& raw_block_contents,
+                                bool is_data_block,
+                                const CompressionContext& compression_ctx,
+                                UncompressionContext* verify_ctx,
+                                std::string* compressed_output,
+                                Slice* block_contents, CompressionType* type,
+                                std::string* sampled_output_fast,
+                                std::string* sampled_output_slow);
   // Directly write data to the file.
   void WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle,
                      bool is_data_block = false);
@@ -123,10 +134,28 @@ class BlockBasedTableBuilder : public TableBuilder {
                    BlockHandle& index_block_handle);
 
   struct Rep;
+  struct ParallelCompressionRep;
   class BlockBasedTablePropertiesCollectorFactory;
   class BlockBasedTablePropertiesCollector;
   Rep* rep_;
 
+  // Parallel compression (CompressionOptions::parallel_threads > 1).
+  //
+  // Queue a finished data block for compression. Its keys are added to the
+  // filter and index builders once the block is written.
+  void EmitBlockForParallelCompression(std::string&& raw_block_contents,
+                                       std::vector<std::string>&& keys,
+                                       const Slice* first_key_in_next_block);
+  // Write out compressed blocks in order, waiting for compression until at
+  // most `max_pending_blocks` blocks remain queued.
+  void WritePendingBlocks(size_t max_pending_blocks);
+  // Write the oldest pending block, which must have been compressed.
+  void WriteCompressedDataBlock();
+  // Body of the compression threads.
+  void BGWorkCompression();
+  // Stop and join the compression threads, dropping any unwritten block.
+  void StopParallelCompression();
+
   // Advanced operation: flush any buffered key/value pairs to file.
   // Can be used to ensure that two adjacent entries never live in
   // the same data block.  Most clients should not need to use this method.
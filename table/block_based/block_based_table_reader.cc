@@ -92,6 +92,10 @@ class BlocklikeTraits<BlockContents> {
   static uint32_t GetNumRestarts(const BlockContents& /* contents */) {
     return 0;
   }
+
+  static Slice GetContents(const BlockContents& contents) {
+    return contents.data;
+  }
 };
 
 template <>
@@ -109,6 +113,10 @@ class BlocklikeTraits<ParsedFullFilterBlock> {
   static uint32_t GetNumRestarts(const ParsedFullFilterBlock& /* block */) {
     return 0;
   }
+
+  static Slice GetContents(const ParsedFullFilterBlock& block) {
+    return block.GetBlockContentsData();
+  }
 };
 
 template <>
@@ -125,6 +133,10 @@ class BlocklikeTraits<Block> {
   static uint32_t GetNumRestarts(const Block& block) {
     return block.NumRestarts();
   }
+
+  static Slice GetContents(const Block& block) {
+    return Slice(block.data(), block.size());
+  }
 };
 
 template <>
@@ -143,6 +155,10 @@ class BlocklikeTraits<UncompressionDict> {
   static uint32_t GetNumRestarts(const UncompressionDict& /* dict */) {
     return 0;
   }
+
+  static Slice GetContents(const UncompressionDict& dict) {
+    return dict.GetRawDict();
+  }
 };
 
 namespace {
@@ -200,6 +216,33 @@ void DeleteCachedEntry(const Slice& /*key*/, void* value) {
   delete entry;
 }
 
+// Callbacks used to move a cached entry to the secondary cache of the block
+// cache, if any, which stores its uncompressed contents.
+template <class TBlocklike>
+size_t SizeOfCachedEntry(void* obj) {
+  return BlocklikeTraits<TBlocklike>::GetContents(
+             *reinterpret_cast<TBlocklike*>(obj))
+      .size();
+}
+
+template <class TBlocklike>
+Status SaveCachedEntryTo(void* from_obj, size_t from_offset, size_t length,
+                         void* out) {
+  Slice contents = BlocklikeTraits<TBlocklike>::GetContents(
+      *reinterpret_cast<TBlocklike*>(from_obj));
+  assert(from_offset + length <= contents.size());
+  memcpy(out, contents.data() + from_offset, length);
+  return Status::OK();
+}
+
+template <class TBlocklike>
+const Cache::CacheItemHelper* GetCacheItemHelper() {
+  static const Cache::CacheItemHelper helper(&SizeOfCachedEntry<TBlocklike>,
+                                             &SaveCachedEntryTo<TBlocklike>,
+                                             &DeleteCachedEntry<TBlocklike>);
+  return &helper;
+}
+
 // Release the cached entry and decrement its ref count.
 void ForceReleaseCachedEntry(void* arg, void* h) {
   Cache* cache = reinterpret_cast<Cache*>(arg);
@@ -960,8 +1003,12 @@ void BlockBasedTable::UpdateCacheInsertionMetrics(BlockType block_type,
 
 Cache::Handle* BlockBasedTable::GetEntryFromCache(
     Cache* block_cache, const Slice& key, BlockType block_type,
-    GetContext* get_context) const {
-  auto cache_handle = block_cache->Lookup(key, rep_->ioptions.statistics);
+    GetContext* get_context, const Cache::CacheItemHelper* cache_helper,
+    const Cache::CreateCallback& create_cb) const {
+  auto cache_handle =
+      block_cache->Lookup(key, cache_helper, create_cb,
+                          GetCachePriority(block_type), true /* wait */,
+                          rep_->ioptions.statistics);
 
   if (cache_handle != nullptr) {
     UpdateCacheHitMetrics(block_type, get_context,
@@ -973,6 +1020,40 @@ Cache::Handle* BlockBasedTable::GetEntryFromCache(
   return cache_handle;
 }
 
+Cache::Priority BlockBasedTable::GetCachePriority(BlockType block_type) const {
+  return rep_->table_options.cache_index_and_filter_blocks_with_high_priority &&
+                 (block_type == BlockType::kFilter ||
+                  block_type == BlockType::kCompressionDictionary ||
+                  block_type == BlockType::kIndex)
+             ? Cache::Priority::HIGH
+             : Cache::Priority::LOW;
+}
+
+template <typename TBlocklike>
+Cache::CreateCallback BlockBasedTable::GetCreateCallback(
+    BlockType block_type) const {
+  // Only capture what fits in std::function's inline storage, so that no
+  // allocation is needed on every block cache lookup.
+  return [this, block_type](const void* buf, size_t size, void** out_obj,
+                            size_t* charge) -> Status {
+    CacheAllocationPtr allocation =
+        AllocateBlock(size, GetMemoryAllocator(rep_->table_options));
+    memcpy(allocation.get(), buf, size);
+    const size_t read_amp_bytes_per_bit =
+        block_type == BlockType::kData
+            ? rep_->table_options.read_amp_bytes_per_bit
+            : 0;
+    TBlocklike* obj = BlocklikeTraits<TBlocklike>::Create(
+        BlockContents(std::move(allocation), size),
+        rep_->get_global_seqno(block_type), read_amp_bytes_per_bit,
+        rep_->ioptions.statistics, rep_->blocks_definitely_zstd_compressed,
+        rep_->table_options.filter_policy.get());
+    *charge = obj->ApproximateMemoryUsage();
+    *out_obj = obj;
+    return Status::OK();
+  };
+}
+
 // Helper function to setup the cache key's prefix for the Table.
 void BlockBasedTable::SetupCacheKeyPrefix(Rep* rep) {
   assert(kMaxCacheKeyPrefixSize >= 10);
@@ -1699,8 +1780,10 @@ Status BlockBasedTable::GetDataBlockFromCache(
 
   // Lookup uncompressed cache first
   if (block_cache != nullptr) {
-    auto cache_handle = GetEntryFromCache(block_cache, block_cache_key,
-                                          block_type, get_context);
+    auto cache_handle = GetEntryFromCache(
+        block_cache, block_cache_key, block_type, get_context,
+        GetCacheItemHelper<TBlocklike>(),
+        GetCreateCallback<TBlocklike>(block_type));
     if (cache_handle != nullptr) {
       block->SetCachedValue(
           reinterpret_cast<TBlocklike*>(block_cache->Value(cache_handle)),
@@ -1758,8 +1841,9 @@ Status BlockBasedTable::GetDataBlockFromCache(
         read_options.fill_cache) {
       size_t charge = block_holder->ApproximateMemoryUsage();
       Cache::Handle* cache_handle = nullptr;
-      s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                              &DeleteCachedEntry<TBlocklike>, &cache_handle);
+      s = block_cache->Insert(block_cache_key, block_holder.get(),
+                              GetCacheItemHelper<TBlocklike>(), charge,
+                              &cache_handle, GetCachePriority(block_type));
       if (s.ok()) {
         assert(cache_handle != nullptr);
         block->SetCachedValue(block_holder.release(), block_cache,
@@ -1794,13 +1878,7 @@ Status BlockBasedTable::PutDataBlockToCache(
       block_type == BlockType::kData
           ? rep_->table_options.read_amp_bytes_per_bit
           : 0;
-  const Cache::Priority priority =
-      rep_->table_options.cache_index_and_filter_blocks_with_high_priority &&
-              (block_type == BlockType::kFilter ||
-               block_type == BlockType::kCompressionDictionary ||
-               block_type == BlockType::kIndex)
-          ? Cache::Priority::HIGH
-          : Cache::Priority::LOW;
+  const Cache::Priority priority = GetCachePriority(block_type);
   assert(cached_block);
   assert(cached_block->IsEmpty());
 
@@ -1862,9 +1940,9 @@ Status BlockBasedTable::PutDataBlockToCache(
   if (block_cache != nullptr && block_holder->own_bytes()) {
     size_t charge = block_holder->ApproximateMemoryUsage();
     Cache::Handle* cache_handle = nullptr;
-    s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                            &DeleteCachedEntry<TBlocklike>, &cache_handle,
-                            priority);
+    s = block_cache->Insert(block_cache_key, block_holder.get(),
+                            GetCacheItemHelper<TBlocklike>(), charge,
+                            &cache_handle, priority);
     if (s.ok()) {
       assert(cache_handle != nullptr);
       cached_block->SetCachedValue(block_holder.release(), block_cache,
@@ -2302,11 +2380,7 @@ void BlockBasedTable::RetrieveMultipleBlocks(
     autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>* results,
     char* scratch, const UncompressionDict& uncompression_dict) const {
   RandomAccessFileReader* file = rep_->file.get();
-  const Footer& footer = rep_->footer;
   const ImmutableCFOptions& ioptions = rep_->ioptions;
-  SequenceNumber global_seqno = rep_->get_global_seqno(BlockType::kData);
-  size_t read_amp_bytes_per_bit = rep_->table_options.read_amp_bytes_per_bit;
-  MemoryAllocator* memory_allocator = GetMemoryAllocator(rep_->table_options);
 
   if (file->use_direct_io() || ioptions.allow_mmap_reads) {
     size_t idx_in_batch = 0;
@@ -2328,14 +2402,25 @@ void BlockBasedTable::RetrieveMultipleBlocks(
     return;
   }
 
-  autovector<FSReadRequest, MultiGetContext::MAX_BATCH_SIZE> read_reqs;
+  MultiBlockReads reads;
+  PrepareMultipleBlockReads(batch, handles, scratch, &reads);
+  file->MultiRead(&reads.read_reqs[0], reads.read_reqs.size());
+  FinishMultipleBlockReads(options, batch, handles, statuses, results, scratch,
+                           uncompression_dict, &reads);
+}
+
+void BlockBasedTable::PrepareMultipleBlockReads(
+    const MultiGetRange* batch,
+    const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+    char* scratch, MultiBlockReads* reads) const {
+  auto& read_reqs = reads->read_reqs;
+  auto& req_idx_for_block = reads->req_idx_for_block;
+  auto& req_offset_for_block = reads->req_offset_for_block;
   size_t buf_offset = 0;
   size_t idx_in_batch = 0;
 
   uint64_t prev_offset = 0;
   size_t prev_len = 0;
-  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_idx_for_block;
-  autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_offset_for_block;
   for (auto mget_iter = batch->begin(); mget_iter != batch->end();
        ++mget_iter, ++idx_in_batch) {
     const BlockHandle& handle = (*handles)[idx_in_batch];
@@ -2388,10 +2473,25 @@ void BlockBasedTable::RetrieveMultipleBlocks(
     req.status = IOStatus::OK();
     read_reqs.emplace_back(req);
   }
+}
 
-  file->MultiRead(&read_reqs[0], read_reqs.size());
+void BlockBasedTable::FinishMultipleBlockReads(
+    const ReadOptions& options, const MultiGetRange* batch,
+    const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+    autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses,
+    autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>* results,
+    char* scratch, const UncompressionDict& uncompression_dict,
+    MultiBlockReads* reads) const {
+  const Footer& footer = rep_->footer;
+  const ImmutableCFOptions& ioptions = rep_->ioptions;
+  SequenceNumber global_seqno = rep_->get_global_seqno(BlockType::kData);
+  size_t read_amp_bytes_per_bit = rep_->table_options.read_amp_bytes_per_bit;
+  MemoryAllocator* memory_allocator = GetMemoryAllocator(rep_->table_options);
+  auto& read_reqs = reads->read_reqs;
+  auto& req_idx_for_block = reads->req_idx_for_block;
+  auto& req_offset_for_block = reads->req_offset_for_block;
 
-  idx_in_batch = 0;
+  size_t idx_in_batch = 0;
   size_t valid_batch_idx = 0;
   for (auto mget_iter = batch->begin(); mget_iter != batch->end();
        ++mget_iter, ++idx_in_batch) {
@@ -3021,16 +3121,26 @@ void BlockBasedTableIterator<TBlockIter, TValue>::InitDataBlock() {
         num_file_reads_++;
         if (num_file_reads_ >
             BlockBasedTable::kMinNumFileReadsToStartAutoReadahead) {
+          size_t block_end = static_cast<size_t>(
+              data_block_handle.offset() + block_size(data_block_handle));
           if (!rep->file->use_direct_io() &&
-              (data_block_handle.offset() +
-                   static_cast<size_t>(block_size(data_block_handle)) >
-               readahead_limit_)) {
+              block_end > (UseAdaptiveReadahead() ? readahead_trigger_
+                                                  : readahead_limit_)) {
             // Buffered I/O
+            size_t readahead_offset =
+                static_cast<size_t>(data_block_handle.offset());
+            if (UseAdaptiveReadahead() && block_end <= readahead_limit_) {
+              // Still inside the previous readahead: continue right after it
+              // so that it is read while the rest of this one is consumed.
+              readahead_offset = readahead_limit_;
+            }
+            TEST_SYNC_POINT_CALLBACK("BlockBasedTableIterator:AutoReadahead",
+                                     &readahead_size_);
             // Discarding the return status of Prefetch calls intentionally, as
             // we can fallback to reading from disk if Prefetch fails.
-            rep->file->Prefetch(data_block_handle.offset(), readahead_size_);
-            readahead_limit_ = static_cast<size_t>(data_block_handle.offset() +
-                                                   readahead_size_);
+            rep->file->Prefetch(readahead_offset, readahead_size_);
+            readahead_limit_ = readahead_offset + readahead_size_;
+            readahead_trigger_ = readahead_offset + readahead_size_ / 2;
             // Keep exponentially increasing readahead size until
             // kMaxAutoReadaheadSize.
             readahead_size_ = std::min(BlockBasedTable::kMaxAutoReadaheadSize,
@@ -3039,8 +3149,8 @@ void BlockBasedTableIterator<TBlockIter, TValue>::InitDataBlock() {
             // Direct I/O
             // Let FilePrefetchBuffer take care of the readahead.
             rep->CreateFilePrefetchBuffer(
-                BlockBasedTable::kInitAutoReadaheadSize,
-                BlockBasedTable::kMaxAutoReadaheadSize, &prefetch_buffer_);
+                readahead_size_, BlockBasedTable::kMaxAutoReadaheadSize,
+                &prefetch_buffer_, read_options_.async_io);
           }
         }
       } else if (!prefetch_buffer_) {
@@ -3049,12 +3159,13 @@ void BlockBasedTableIterator<TBlockIter, TValue>::InitDataBlock() {
         // if (read_options_.readahead_size != 0 && !prefetch_buffer_)
         rep->CreateFilePrefetchBuffer(read_options_.readahead_size,
                                       read_options_.readahead_size,
-                                      &prefetch_buffer_);
+                                      &prefetch_buffer_,
+                                      read_options_.async_io);
       }
     } else if (!prefetch_buffer_) {
       rep->CreateFilePrefetchBuffer(compaction_readahead_size_,
                                     compaction_readahead_size_,
-                                    &prefetch_buffer_);
+                                    &prefetch_buffer_, read_options_.async_io);
     }
 
     Status s;
@@ -3068,6 +3179,30 @@ void BlockBasedTableIterator<TBlockIter, TValue>::InitDataBlock() {
   }
 }
 
+template <class TBlockIter, typename TValue>
+void BlockBasedTableIterator<TBlockIter, TValue>::SaveAutoReadaheadSizeHint() {
+  if (num_file_reads_ == 0) {
+    return;
+  }
+  size_t hint;
+  if (num_file_reads_ > BlockBasedTable::kMinNumFileReadsToStartAutoReadahead) {
+    // Long enough for auto-readahead to start: the next iterator starts from
+    // the size this one would have used next.
+    hint = prefetch_buffer_ ? prefetch_buffer_->readahead_size()
+                            : readahead_size_;
+  } else {
+    // Short scans let the hint decay back to the default.
+    hint = table_->get_rep()->auto_readahead_size_hint.load(
+               std::memory_order_relaxed) /
+           2;
+    if (hint < BlockBasedTable::kInitAutoReadaheadSize) {
+      hint = 0;
+    }
+  }
+  table_->get_rep()->auto_readahead_size_hint.store(hint,
+                                                    std::memory_order_relaxed);
+}
+
 template <class TBlockIter, typename TValue>
 bool BlockBasedTableIterator<TBlockIter, TValue>::MaterializeCurrentBlock() {
   assert(is_at_first_key_from_index_);
@@ -3482,68 +3617,193 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
 }
 
 using MultiGetRange = MultiGetContext::Range;
+
+struct BlockBasedTable::MultiGetState
+    : public TableReader::AsyncMultiGetState {
+  MultiGetState(const ReadOptions& _read_options,
+                const MultiGetRange* mget_range,
+                const SliceTransform* _prefix_extractor, bool _skip_filters)
+      : read_options(_read_options),
+        prefix_extractor(_prefix_extractor),
+        skip_filters(_skip_filters),
+        sst_file_range(*mget_range, mget_range->begin(), mget_range->end()),
+        tracing_mget_id(GetTracingMultiGetId(sst_file_range)),
+        lookup_context(
+            TableReaderCaller::kUserMultiGet, tracing_mget_id,
+            /*get_from_user_specified_snapshot=*/read_options.snapshot !=
+                nullptr) {}
+
+  ~MultiGetState() override {
+    for (auto& io_handle : io_handles) {
+      if (io_handle.second) {
+        io_handle.second(io_handle.first);
+      }
+    }
+  }
+
+  static uint64_t GetTracingMultiGetId(MultiGetRange& range) {
+    if (!range.empty() && range.begin()->get_context) {
+      return range.begin()->get_context->get_tracing_get_id();
+    }
+    return BlockCacheTraceHelper::kReservedGetId;
+  }
+
+  const UncompressionDict& dict() const {
+    return uncompression_dict.GetValue() ? *uncompression_dict.GetValue()
+                                         : UncompressionDict::GetEmptyDict();
+  }
+
+  const ReadOptions& read_options;
+  const SliceTransform* const prefix_extractor;
+  const bool skip_filters;
+  FilterBlockReader* filter = nullptr;
+  MultiGetRange sst_file_range;
+  MultiGetRange data_block_range;
+  const uint64_t tracing_mget_id;
+  BlockCacheLookupContext lookup_context;
+
+  IndexBlockIter iiter_on_stack;
+  InternalIteratorBase<IndexValue>* iiter = nullptr;
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+
+  CachableEntry<UncompressionDict> uncompression_dict;
+  autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE> block_handles;
+  autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE> results;
+  autovector<Status, MultiGetContext::MAX_BATCH_SIZE> statuses;
+
+  // Total size of the data blocks that need to be read from the file
+  size_t total_len = 0;
+  char* scratch = nullptr;
+  char stack_buf[kMultiGetReadStackBufSize];
+  std::unique_ptr<char[]> block_buf;
+
+  // Data block reads left outstanding by StartMultiGet()
+  MultiBlockReads reads;
+  autovector<std::pair<void*, IOHandleDeleter>,
+             MultiGetContext::MAX_BATCH_SIZE>
+      io_handles;
+  bool reads_pending = false;
+};
+
 void BlockBasedTable::MultiGet(const ReadOptions& read_options,
                                const MultiGetRange* mget_range,
                                const SliceTransform* prefix_extractor,
                                bool skip_filters) {
+  MultiGetState state(read_options, mget_range, prefix_extractor,
+                      skip_filters);
+  MultiGetLookupBlocks(&state);
+  if (state.total_len) {
+    RetrieveMultipleBlocks(read_options, &state.data_block_range,
+                           &state.block_handles, &state.statuses,
+                           &state.results, state.scratch, state.dict());
+  }
+  MultiGetSearchBlocks(&state);
+}
+
+std::unique_ptr<TableReader::AsyncMultiGetState> BlockBasedTable::StartMultiGet(
+    const ReadOptions& read_options, const MultiGetRange* mget_range,
+    const SliceTransform* prefix_extractor, bool skip_filters,
+    std::vector<void*>* io_handles) {
+  MultiGetState* state = new MultiGetState(read_options, mget_range,
+                                           prefix_extractor, skip_filters);
+  MultiGetLookupBlocks(state);
+  if (state->total_len) {
+    RandomAccessFileReader* file = rep_->file.get();
+    if (file->use_direct_io() || rep_->ioptions.allow_mmap_reads) {
+      RetrieveMultipleBlocks(read_options, &state->data_block_range,
+                             &state->block_handles, &state->statuses,
+                             &state->results, state->scratch, state->dict());
+    } else {
+      PrepareMultipleBlockReads(&state->data_block_range, &state->block_handles,
+                                state->scratch, &state->reads);
+      // The completed request is copied back into our own, as the file may
+      // have worked on a copy
+      auto read_done = [](const FSReadRequest& done_req, void* arg) {
+        FSReadRequest* req = static_cast<FSReadRequest*>(arg);
+        req->result = done_req.result;
+        req->status = done_req.status;
+      };
+      for (auto& req : state->reads.read_reqs) {
+        void* io_handle = nullptr;
+        IOHandleDeleter del_fn;
+        Status s = file->ReadAsync(req, read_done, &req, &io_handle, &del_fn);
+        if (!s.ok()) {
+          req.status = IOStatus::IOError(s.ToString());
+        }
+        if (io_handle != nullptr) {
+          state->io_handles.emplace_back(io_handle, std::move(del_fn));
+          io_handles->push_back(io_handle);
+        }
+      }
+      state->reads_pending = true;
+    }
+  }
+  return std::unique_ptr<AsyncMultiGetState>(state);
+}
+
+void BlockBasedTable::FinishMultiGet(
+    std::unique_ptr<AsyncMultiGetState>&& async_state) {
+  std::unique_ptr<MultiGetState> state(
+      static_cast<MultiGetState*>(async_state.release()));
+  if (state->reads_pending) {
+    FinishMultipleBlockReads(state->read_options, &state->data_block_range,
+                             &state->block_handles, &state->statuses,
+                             &state->results, state->scratch, state->dict(),
+                             &state->reads);
+  }
+  MultiGetSearchBlocks(state.get());
+}
+
+void BlockBasedTable::MultiGetLookupBlocks(MultiGetState* state) {
+  const ReadOptions& read_options = state->read_options;
+  const bool skip_filters = state->skip_filters;
+  MultiGetRange& sst_file_range = state->sst_file_range;
+  BlockCacheLookupContext& lookup_context = state->lookup_context;
   FilterBlockReader* const filter =
       !skip_filters ? rep_->filter.get() : nullptr;
-  MultiGetRange sst_file_range(*mget_range, mget_range->begin(),
-                               mget_range->end());
+  state->filter = filter;
 
   // First check the full filter
   // If full filter not useful, Then go into each block
   const bool no_io = read_options.read_tier == kBlockCacheTier;
-  uint64_t tracing_mget_id = BlockCacheTraceHelper::kReservedGetId;
-  if (!sst_file_range.empty() && sst_file_range.begin()->get_context) {
-    tracing_mget_id = sst_file_range.begin()->get_context->get_tracing_get_id();
-  }
-  BlockCacheLookupContext lookup_context{
-      TableReaderCaller::kUserMultiGet, tracing_mget_id,
-      /*get_from_user_specified_snapshot=*/read_options.snapshot != nullptr};
   FullFilterKeysMayMatch(read_options, filter, &sst_file_range, no_io,
-                         prefix_extractor, &lookup_context);
+                         state->prefix_extractor, &lookup_context);
 
   if (skip_filters || !sst_file_range.empty()) {
-    IndexBlockIter iiter_on_stack;
     // if prefix_extractor found in block differs from options, disable
     // BlockPrefixIndex. Only do this check when index_type is kHashSearch.
     bool need_upper_bound_check = false;
     if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
       need_upper_bound_check = PrefixExtractorChanged(
-          rep_->table_properties.get(), prefix_extractor);
+          rep_->table_properties.get(), state->prefix_extractor);
     }
-    auto iiter =
-        NewIndexIterator(read_options, need_upper_bound_check, &iiter_on_stack,
-                         sst_file_range.begin()->get_context, &lookup_context);
-    std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
-    if (iiter != &iiter_on_stack) {
-      iiter_unique_ptr.reset(iiter);
+    auto iiter = NewIndexIterator(
+        read_options, need_upper_bound_check, &state->iiter_on_stack,
+        sst_file_range.begin()->get_context, &lookup_context);
+    state->iiter = iiter;
+    if (iiter != &state->iiter_on_stack) {
+      state->iiter_unique_ptr.reset(iiter);
     }
 
     uint64_t offset = std::numeric_limits<uint64_t>::max();
-    autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE> block_handles;
-    autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE> results;
-    autovector<Status, MultiGetContext::MAX_BATCH_SIZE> statuses;
-    char stack_buf[kMultiGetReadStackBufSize];
-    std::unique_ptr<char[]> block_buf;
+    auto& block_handles = state->block_handles;
+    auto& results = state->results;
+    auto& statuses = state->statuses;
     {
-      MultiGetRange data_block_range(sst_file_range, sst_file_range.begin(),
-                                     sst_file_range.end());
+      state->data_block_range = MultiGetRange(
+          sst_file_range, sst_file_range.begin(), sst_file_range.end());
+      MultiGetRange& data_block_range = state->data_block_range;
 
-      CachableEntry<UncompressionDict> uncompression_dict;
       Status uncompression_dict_status;
       if (rep_->uncompression_dict_reader) {
         uncompression_dict_status =
             rep_->uncompression_dict_reader->GetOrReadUncompressionDictionary(
                 nullptr /* prefetch_buffer */, no_io,
                 sst_file_range.begin()->get_context, &lookup_context,
-                &uncompression_dict);
+                &state->uncompression_dict);
       }
 
-      const UncompressionDict& dict = uncompression_dict.GetValue()
-                                          ? *uncompression_dict.GetValue()
-                                          : UncompressionDict::GetEmptyDict();
+      const UncompressionDict& dict = state->dict();
 
       size_t total_len = 0;
       ReadOptions ro = read_options;
@@ -3611,7 +3871,6 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
       }
 
       if (total_len) {
-        char* scratch = nullptr;
         // If the blocks need to be uncompressed and we don't need the
         // compressed blocks, then we can use a contiguous block of
         // memory to read in all the blocks as it will be temporary
@@ -3624,17 +3883,30 @@ void BlockBasedTable::MultiGet(const ReadOptions& read_options,
         if (rep_->table_options.block_cache_compressed == nullptr &&
             rep_->blocks_maybe_compressed) {
           if (total_len <= kMultiGetReadStackBufSize) {
-            scratch = stack_buf;
+            state->scratch = state->stack_buf;
           } else {
-            scratch = new char[total_len];
-            block_buf.reset(scratch);
+            state->scratch = new char[total_len];
+            state->block_buf.reset(state->scratch);
           }
         }
-        RetrieveMultipleBlocks(read_options, &data_block_range, &block_handles,
-                               &statuses, &results, scratch, dict);
       }
+      state->total_len = total_len;
     }
+  }
+}
 
+void BlockBasedTable::MultiGetSearchBlocks(MultiGetState* state) {
+  const ReadOptions& read_options = state->read_options;
+  const bool skip_filters = state->skip_filters;
+  FilterBlockReader* const filter = state->filter;
+  MultiGetRange& sst_file_range = state->sst_file_range;
+  const uint64_t tracing_mget_id = state->tracing_mget_id;
+  auto iiter = state->iiter;
+  auto& block_handles = state->block_handles;
+  auto& results = state->results;
+  auto& statuses = state->statuses;
+
+  if (iiter != nullptr) {
     DataBlockIter first_biter;
     DataBlockIter next_biter;
     size_t idx_in_batch = 0;
@@ -4160,6 +4432,45 @@ uint64_t BlockBasedTable::ApproximateSize(const Slice& start, const Slice& end,
   return end_offset - start_offset;
 }
 
+Status BlockBasedTable::ApproximateKeyAnchors(
+    const ReadOptions& read_options, size_t max_anchors,
+    std::vector<std::string>* anchors) {
+  uint64_t num_blocks = rep_->table_properties != nullptr
+                            ? rep_->table_properties->num_data_blocks
+                            : 0;
+  if (max_anchors == 0 || num_blocks < 2) {
+    return Status::OK();
+  }
+  // Take the index key after every step-th data block, but not after the
+  // last one, which would not split anything.
+  uint64_t step = (num_blocks + max_anchors) / (max_anchors + 1);
+
+  BlockCacheLookupContext context(TableReaderCaller::kCompaction);
+  IndexBlockIter iiter_on_stack;
+  ReadOptions ro = read_options;
+  ro.total_order_seek = true;
+  auto index_iter =
+      NewIndexIterator(ro, /*disable_prefix_seek=*/true,
+                       /*input_iter=*/&iiter_on_stack, /*get_context=*/nullptr,
+                       /*lookup_context=*/&context);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (index_iter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(index_iter);
+  }
+
+  uint64_t block = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    if (++block % step != 0 || block >= num_blocks) {
+      continue;
+    }
+    Slice key = index_iter->key();
+    anchors->emplace_back(rep_->index_key_includes_seq
+                              ? ExtractUserKey(key).ToString()
+                              : key.ToString());
+  }
+  return index_iter->status();
+}
+
 bool BlockBasedTable::TEST_FilterBlockInCache() const {
   assert(rep_ != nullptr);
   return TEST_BlockInCache(rep_->filter_handle);
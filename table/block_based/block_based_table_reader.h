@@ -10,6 +10,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -151,6 +153,13 @@ class BlockBasedTable : public TableReader {
                 const SliceTransform* prefix_extractor,
                 bool skip_filters = false) override;
 
+  std::unique_ptr<AsyncMultiGetState> StartMultiGet(
+      const ReadOptions& readOptions, const MultiGetContext::Range* mget_range,
+      const SliceTransform* prefix_extractor, bool skip_filters,
+      std::vector<void*>* io_handles) override;
+
+  void FinishMultiGet(std::unique_ptr<AsyncMultiGetState>&& state) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
@@ -172,6 +181,12 @@ class BlockBasedTable : public TableReader {
   uint64_t ApproximateSize(const Slice& start, const Slice& end,
                            TableReaderCaller caller) override;
 
+  // Samples the anchors from the index, one every few data blocks, so that
+  // each range holds about the same number of data blocks.
+  Status ApproximateKeyAnchors(const ReadOptions& read_options,
+                               size_t max_anchors,
+                               std::vector<std::string>* anchors) override;
+
   bool TEST_BlockInCache(const BlockHandle& handle) const;
 
   // Returns true if the block for the specified key is in cache.
@@ -280,9 +295,18 @@ class BlockBasedTable : public TableReader {
                               GetContext* get_context) const;
   void UpdateCacheInsertionMetrics(BlockType block_type,
                                    GetContext* get_context, size_t usage) const;
-  Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
-                                   BlockType block_type,
-                                   GetContext* get_context) const;
+  // Looks up the block cache, and its secondary cache tier on a miss. A block
+  // found in the secondary cache is rebuilt with create_cb and promoted back
+  // into the block cache.
+  Cache::Handle* GetEntryFromCache(
+      Cache* block_cache, const Slice& key, BlockType block_type,
+      GetContext* get_context, const Cache::CacheItemHelper* cache_helper,
+      const Cache::CreateCallback& create_cb) const;
+  Cache::Priority GetCachePriority(BlockType block_type) const;
+  // Returns a callback that rebuilds a block of the given type from the
+  // uncompressed contents kept in a secondary cache.
+  template <typename TBlocklike>
+  Cache::CreateCallback GetCreateCallback(BlockType block_type) const;
 
   // Either Block::NewDataIterator() or Block::NewIndexIterator().
   template <typename TBlockIter>
@@ -327,6 +351,39 @@ class BlockBasedTable : public TableReader {
           results,
       char* scratch, const UncompressionDict& uncompression_dict) const;
 
+  // File reads of the data blocks needed by a MultiGet() batch. Adjacent
+  // blocks may share a read.
+  struct MultiBlockReads {
+    autovector<FSReadRequest, MultiGetContext::MAX_BATCH_SIZE> read_reqs;
+    // Index into read_reqs, and offset within it, of each non-null handle
+    autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_idx_for_block;
+    autovector<size_t, MultiGetContext::MAX_BATCH_SIZE> req_offset_for_block;
+  };
+
+  // The two halves of RetrieveMultipleBlocks() around the file reads, for
+  // buffered reads only.
+  void PrepareMultipleBlockReads(
+      const MultiGetRange* batch,
+      const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+      char* scratch, MultiBlockReads* reads) const;
+  void FinishMultipleBlockReads(
+      const ReadOptions& options, const MultiGetRange* batch,
+      const autovector<BlockHandle, MultiGetContext::MAX_BATCH_SIZE>* handles,
+      autovector<Status, MultiGetContext::MAX_BATCH_SIZE>* statuses,
+      autovector<CachableEntry<Block>, MultiGetContext::MAX_BATCH_SIZE>*
+          results,
+      char* scratch, const UncompressionDict& uncompression_dict,
+      MultiBlockReads* reads) const;
+
+  // MultiGet() is done in two steps around the reads of the data blocks,
+  // which StartMultiGet() leaves outstanding.
+  struct MultiGetState;
+  // Check the filter and index, and look up the data blocks in the block
+  // cache. Sets up the reads of the blocks that were not found.
+  void MultiGetLookupBlocks(MultiGetState* state);
+  // Search the data blocks for the keys, once they have been read.
+  void MultiGetSearchBlocks(MultiGetState* state);
+
   // Get the iterator from the index reader.
   //
   // If input_iter is not set, return a new Iterator.
@@ -582,6 +639,10 @@ struct BlockBasedTable::Rep {
 
   const bool immortal_table;
 
+  // Auto-readahead size reached by the last iterator over this file that
+  // was created with ReadOptions::adaptive_readahead, or 0.
+  mutable std::atomic<size_t> auto_readahead_size_hint{0};
+
   SequenceNumber get_global_seqno(BlockType block_type) const {
     return (block_type == BlockType::kFilter ||
             block_type == BlockType::kCompressionDictionary)
@@ -605,12 +666,16 @@ struct BlockBasedTable::Rep {
   uint64_t sst_number_for_tracing() const {
     return file ? TableFileNameToNumber(file->file_name()) : UINT64_MAX;
   }
-  void CreateFilePrefetchBuffer(
-      size_t readahead_size, size_t max_readahead_size,
-      std::unique_ptr<FilePrefetchBuffer>* fpb) const {
-    fpb->reset(new FilePrefetchBuffer(file.get(), readahead_size,
-                                      max_readahead_size,
-                                      !ioptions.allow_mmap_reads /* enable */));
+  // With async_io, the buffer reads the next readahead window
+  // asynchronously while the current one is consumed.
+  void CreateFilePrefetchBuffer(size_t readahead_size,
+                                size_t max_readahead_size,
+                                std::unique_ptr<FilePrefetchBuffer>* fpb,
+                                bool async_io = false) const {
+    fpb->reset(new FilePrefetchBuffer(
+        file.get(), readahead_size, max_readahead_size,
+        !ioptions.allow_mmap_reads /* enable */, false /* track_min_offset */,
+        async_io ? ioptions.fs : nullptr));
   }
 };
 
@@ -640,9 +705,20 @@ class BlockBasedTableIterator : public InternalIteratorBase<TValue> {
         prefix_extractor_(prefix_extractor),
         block_type_(block_type),
         lookup_context_(caller),
-        compaction_readahead_size_(compaction_readahead_size) {}
+        compaction_readahead_size_(compaction_readahead_size) {
+    if (UseAdaptiveReadahead()) {
+      readahead_size_ = std::max(
+          readahead_size_, table_->get_rep()->auto_readahead_size_hint.load(
+                               std::memory_order_relaxed));
+    }
+  }
 
-  ~BlockBasedTableIterator() { delete index_iter_; }
+  ~BlockBasedTableIterator() {
+    if (UseAdaptiveReadahead()) {
+      SaveAutoReadaheadSizeHint();
+    }
+    delete index_iter_;
+  }
 
   void Seek(const Slice& target) override;
   void SeekForPrev(const Slice& target) override;
@@ -780,6 +856,9 @@ class BlockBasedTableIterator : public InternalIteratorBase<TValue> {
 
   size_t readahead_size_ = BlockBasedTable::kInitAutoReadaheadSize;
   size_t readahead_limit_ = 0;
+  // With adaptive readahead, the next readahead is issued once a data block
+  // ends past this offset, half way through the previous readahead.
+  size_t readahead_trigger_ = 0;
   int64_t num_file_reads_ = 0;
   std::unique_ptr<FilePrefetchBuffer> prefetch_buffer_;
 
@@ -787,6 +866,14 @@ class BlockBasedTableIterator : public InternalIteratorBase<TValue> {
   void SeekImpl(const Slice* target);
 
   void InitDataBlock();
+  bool UseAdaptiveReadahead() const {
+    return read_options_.adaptive_readahead &&
+           read_options_.readahead_size == 0 &&
+           lookup_context_.caller != TableReaderCaller::kCompaction;
+  }
+  // Records the auto-readahead size this iterator reached in the table, for
+  // the next iterator with adaptive readahead.
+  void SaveAutoReadaheadSizeHint();
   bool MaterializeCurrentBlock();
   void FindKeyForward();
   void FindBlockForward();
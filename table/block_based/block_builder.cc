@@ -38,6 +38,7 @@
 #include "db/dbformat.h"
 #include "rocksdb/comparator.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/data_block_restart_key_prefixes.h"
 #include "util/coding.h"
 
 namespace rocksdb {
@@ -46,10 +47,11 @@ BlockBuilder::BlockBuilder(
     int block_restart_interval, bool use_delta_encoding,
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    double data_block_hash_table_util_ratio)
+    double data_block_hash_table_util_ratio, bool use_restart_key_prefixes)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
+      use_restart_key_prefixes_(use_restart_key_prefixes),
       restarts_(),
       counter_(0),
       finished_(false) {
@@ -66,13 +68,20 @@ BlockBuilder::BlockBuilder(
   assert(block_restart_interval_ >= 1);
   restarts_.push_back(0);  // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (use_restart_key_prefixes_) {
+    estimate_ += sizeof(uint64_t);
+  }
 }
 
 void BlockBuilder::Reset() {
   buffer_.clear();
   restarts_.clear();
   restarts_.push_back(0);  // First restart point is at offset 0
+  restart_key_prefixes_.clear();
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (use_restart_key_prefixes_) {
+    estimate_ += sizeof(uint64_t);
+  }
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
@@ -96,6 +105,9 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
 
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t);  // a new restart entry.
+    if (use_restart_key_prefixes_) {
+      estimate += sizeof(uint64_t);  // and its key prefix.
+    }
   }
 
   estimate += sizeof(int32_t);  // varint for shared prefix length.
@@ -116,6 +128,18 @@ Slice BlockBuilder::Finish() {
   }
 
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  // Like the hash index, restart key prefixes are flagged in the footer,
+  // which is only unambiguous for small blocks.
+  bool has_restart_key_prefixes = false;
+  if (use_restart_key_prefixes_ &&
+      CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex) {
+    assert(restart_key_prefixes_.size() == restarts_.size());
+    for (uint64_t prefix : restart_key_prefixes_) {
+      PutFixed64(&buffer_, prefix);
+    }
+    has_restart_key_prefixes = true;
+  }
+
   BlockBasedTableOptions::DataBlockIndexType index_type =
       BlockBasedTableOptions::kDataBlockBinarySearch;
   if (data_block_hash_index_builder_.Valid() &&
@@ -124,8 +148,10 @@ Slice BlockBuilder::Finish() {
     index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
   }
 
-  // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  // footer is a packed format of data_block_index_type, the restart key
+  // prefixes flag and num_restarts
+  uint32_t block_footer = PackIndexTypeAndNumRestarts(
+      index_type, num_restarts, has_restart_key_prefixes);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -142,6 +168,9 @@ void BlockBuilder::Add(const Slice& key, const Slice& value,
     // Restart compression
     restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
     estimate_ += sizeof(uint32_t);
+    if (use_restart_key_prefixes_) {
+      estimate_ += sizeof(uint64_t);
+    }
     counter_ = 0;
 
     if (use_delta_encoding_) {
@@ -162,6 +191,10 @@ void BlockBuilder::Add(const Slice& key, const Slice& value,
   const size_t non_shared = key.size() - shared;
   const size_t curr_size = buffer_.size();
 
+  if (use_restart_key_prefixes_ && counter_ == 0) {
+    restart_key_prefixes_.push_back(RestartKeyPrefix(ExtractUserKey(key)));
+  }
+
   if (use_value_delta_encoding_) {
     // Add "<shared><non_shared>" to buffer_
     PutVarint32Varint32(&buffer_, static_cast<uint32_t>(shared),
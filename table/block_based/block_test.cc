@@ -22,6 +22,7 @@
 #include "rocksdb/table.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/data_block_restart_key_prefixes.h"
 #include "table/format.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
@@ -619,6 +620,152 @@ INSTANTIATE_TEST_CASE_P(P, IndexBlockTest,
                                           std::make_tuple(true, false),
                                           std::make_tuple(true, true)));
 
+TEST_F(BlockTest, RestartKeyPrefixOrder) {
+  // Zero padding orders short keys before their extensions.
+  ASSERT_EQ(0U, RestartKeyPrefix(""));
+  ASSERT_LT(RestartKeyPrefix("a"), RestartKeyPrefix("a\x01"));
+  ASSERT_EQ(RestartKeyPrefix("a"), RestartKeyPrefix(std::string("a\0", 2)));
+  ASSERT_LT(RestartKeyPrefix("a\xff"), RestartKeyPrefix("b"));
+  ASSERT_EQ(RestartKeyPrefix("12345678"), RestartKeyPrefix("123456789"));
+  ASSERT_LT(RestartKeyPrefix("1234567\x7f"), RestartKeyPrefix("1234567\x80"));
+}
+
+class RestartKeyPrefixesTest
+    : public testing::Test,
+      public testing::WithParamInterface<std::tuple<int, bool>> {
+ public:
+  int restart_interval() const { return std::get<0>(GetParam()); }
+  BlockBasedTableOptions::DataBlockIndexType index_type() const {
+    return std::get<1>(GetParam())
+               ? BlockBasedTableOptions::kDataBlockBinaryAndHash
+               : BlockBasedTableOptions::kDataBlockBinarySearch;
+  }
+
+  BlockContents Build(std::unique_ptr<BlockBuilder> *builder,
+                      const std::vector<std::string> &keys,
+                      bool use_restart_key_prefixes) {
+    builder->reset(new BlockBuilder(restart_interval(),
+                                    true /* use_delta_encoding */,
+                                    false /* use_value_delta_encoding */,
+                                    index_type(), 0.75,
+                                    use_restart_key_prefixes));
+    for (const auto &key : keys) {
+      (*builder)->Add(key, "v" + key);
+    }
+    BlockContents contents;
+    contents.data = (*builder)->Finish();
+    return contents;
+  }
+};
+
+TEST_P(RestartKeyPrefixesTest, SeekMatchesPlainBlock) {
+  Random rnd(301);
+  InternalKeyComparator icmp(BytewiseComparator());
+  // User keys of all lengths up to 12 bytes over a small alphabet, so that
+  // many of them share their first 8 bytes, and some are shorter than that.
+  std::set<std::string> user_keys;
+  for (int i = 0; i < 1000; i++) {
+    std::string user_key;
+    int len = static_cast<int>(rnd.Uniform(13));
+    for (int j = 0; j < len; j++) {
+      user_key.push_back(static_cast<char>(rnd.Uniform(3) * 0x7f));
+    }
+    user_keys.insert(user_key);
+  }
+  std::vector<std::string> keys;
+  for (const auto &user_key : user_keys) {
+    keys.push_back(InternalKey(user_key, 100, kTypeValue).Encode().ToString());
+  }
+
+  std::unique_ptr<BlockBuilder> plain_builder;
+  std::unique_ptr<BlockBuilder> builder;
+  Block plain(Build(&plain_builder, keys, false), kDisableGlobalSequenceNumber);
+  Block block(Build(&builder, keys, true), kDisableGlobalSequenceNumber);
+  std::unique_ptr<DataBlockIter> plain_iter(
+      plain.NewDataIterator(&icmp, icmp.user_comparator()));
+  std::unique_ptr<DataBlockIter> iter(
+      block.NewDataIterator(&icmp, icmp.user_comparator()));
+  uint32_t num_restarts = (static_cast<uint32_t>(keys.size()) - 1) /
+                              static_cast<uint32_t>(restart_interval()) +
+                          1;
+  ASSERT_EQ(plain.size() + num_restarts * sizeof(uint64_t), block.size());
+
+  iter->SeekToFirst();
+  for (const auto &key : keys) {
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, iter->key().ToString());
+    iter->Next();
+  }
+  ASSERT_FALSE(iter->Valid());
+
+  for (int i = 0; i < 5000; i++) {
+    // Existing user keys, and ones in between and around them.
+    std::string user_key =
+        rnd.OneIn(2) ? ExtractUserKey(keys[rnd.Uniform(
+                                          static_cast<int>(keys.size()))])
+                           .ToString()
+                     : "";
+    int extra = static_cast<int>(rnd.Uniform(4));
+    for (int j = 0; j < extra; j++) {
+      user_key.push_back(static_cast<char>(rnd.Uniform(256)));
+    }
+    SequenceNumber seq = rnd.OneIn(2) ? 50 : 150;
+    std::string target = InternalKey(user_key, seq, kTypeValue).Encode()
+                             .ToString();
+
+    plain_iter->Seek(target);
+    iter->Seek(target);
+    ASSERT_EQ(plain_iter->Valid(), iter->Valid());
+    if (iter->Valid()) {
+      ASSERT_EQ(plain_iter->key().ToString(), iter->key().ToString());
+    }
+
+    plain_iter->SeekForPrev(target);
+    iter->SeekForPrev(target);
+    ASSERT_EQ(plain_iter->Valid(), iter->Valid());
+    if (iter->Valid()) {
+      ASSERT_EQ(plain_iter->key().ToString(), iter->key().ToString());
+    }
+
+    bool plain_may_exist = plain_iter->SeekForGet(target);
+    bool may_exist = iter->SeekForGet(target);
+    ASSERT_EQ(plain_may_exist, may_exist);
+    if (may_exist && iter->Valid()) {
+      ASSERT_EQ(plain_iter->Valid(), iter->Valid());
+      ASSERT_EQ(plain_iter->key().ToString(), iter->key().ToString());
+      ASSERT_EQ(plain_iter->value().ToString(), iter->value().ToString());
+    }
+  }
+}
+
+TEST_P(RestartKeyPrefixesTest, NotInLargeBlocks) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 10000; i++) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%08d", i);
+    keys.push_back(InternalKey(buf, 100, kTypeValue).Encode().ToString());
+  }
+  std::unique_ptr<BlockBuilder> plain_builder;
+  std::unique_ptr<BlockBuilder> builder;
+  Block plain(Build(&plain_builder, keys, false), kDisableGlobalSequenceNumber);
+  Block block(Build(&builder, keys, true), kDisableGlobalSequenceNumber);
+  ASSERT_GT(block.size(), kMaxBlockSizeSupportedByHashIndex);
+  ASSERT_EQ(plain.size(), block.size());
+
+  InternalKeyComparator icmp(BytewiseComparator());
+  std::unique_ptr<DataBlockIter> iter(
+      block.NewDataIterator(&icmp, icmp.user_comparator()));
+  for (const auto &key : keys) {
+    iter->Seek(key);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key, iter->key().ToString());
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(P, RestartKeyPrefixesTest,
+                        ::testing::Combine(::testing::Values(1, 4, 16),
+                                           ::testing::Bool()));
+
 }  // namespace rocksdb
 
 int main(int argc, char **argv) {
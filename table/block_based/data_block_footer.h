@@ -13,13 +13,15 @@
 
 namespace rocksdb {
 
+// has_restart_key_prefixes tells whether the block ends with restart key
+// prefixes (see data_block_restart_key_prefixes.h).
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool has_restart_key_prefixes = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts);
+    uint32_t* num_restarts, bool* has_restart_key_prefixes = nullptr);
 
 }  // namespace rocksdb
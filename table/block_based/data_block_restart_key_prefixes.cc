@@ -0,0 +1,97 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/data_block_restart_key_prefixes.h"
+
+#include <assert.h>
+#include <algorithm>
+
+#ifdef HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#include "util/coding.h"
+
+namespace rocksdb {
+
+// Below this many candidates, CountLess() compares every remaining prefix
+// instead of halving the range.
+static const uint32_t kLinearSearchLimit = 16;
+
+uint64_t RestartKeyPrefix(const Slice& user_key) {
+  uint64_t prefix = 0;
+  size_t len = std::min(user_key.size(), sizeof(uint64_t));
+  for (size_t i = 0; i < len; i++) {
+    prefix |= static_cast<uint64_t>(static_cast<unsigned char>(user_key[i]))
+              << (56 - 8 * i);
+  }
+  return prefix;
+}
+
+void DataBlockRestartKeyPrefixes::FindRestartRange(const Slice& user_key,
+                                                   uint32_t* left,
+                                                   uint32_t* right) const {
+  assert(Valid());
+  assert(*left == 0 && *right + 1 == num_restarts_);
+  uint64_t prefix = RestartKeyPrefix(user_key);
+  uint32_t num_less = CountLess(prefix, false /* or_equal */);
+  uint32_t num_less_or_equal = CountLess(prefix, true /* or_equal */);
+  // The restart keys before num_less are smaller than user_key, and the ones
+  // from num_less_or_equal on are larger.
+  *left = num_less > 0 ? num_less - 1 : 0;
+  *right = num_less_or_equal > 0 ? num_less_or_equal - 1 : 0;
+}
+
+uint32_t DataBlockRestartKeyPrefixes::CountLess(uint64_t prefix,
+                                                bool or_equal) const {
+  uint32_t lo = 0;
+  uint32_t hi = num_restarts_;
+  while (hi - lo > kLinearSearchLimit) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    uint64_t mid_prefix = DecodeFixed64(prefixes_ + mid * sizeof(uint64_t));
+    if (mid_prefix < prefix || (or_equal && mid_prefix == prefix)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  uint32_t count = lo;
+  uint32_t i = lo;
+#ifdef HAVE_AVX2
+  // AVX2 only compares signed 64-bit integers, so flip the sign bits to
+  // compare the prefixes as unsigned.
+  const __m256i sign = _mm256_set1_epi64x(static_cast<int64_t>(1ull << 63));
+  const __m256i target =
+      _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(prefix)), sign);
+  for (; i + 4 <= hi; i += 4) {
+    __m256i prefixes = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+            prefixes_ + i * sizeof(uint64_t))),
+        sign);
+    __m256i less = _mm256_cmpgt_epi64(target, prefixes);
+    if (or_equal) {
+      less = _mm256_or_si256(less, _mm256_cmpeq_epi64(target, prefixes));
+    }
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(less));
+    count += static_cast<uint32_t>(__builtin_popcount(mask));
+    if (mask != 0xf) {
+      // Sorted, so the rest are not less either.
+      return count;
+    }
+  }
+#endif
+  for (; i < hi; i++) {
+    uint64_t p = DecodeFixed64(prefixes_ + i * sizeof(uint64_t));
+    if (p < prefix || (or_equal && p == prefix)) {
+      count++;
+    } else {
+      break;
+    }
+  }
+  return count;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,74 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+// Restart key prefixes speed up the binary search over the restart points of
+// a data block for tables using BytewiseComparator. They are only used in
+// data blocks, and not in meta-data blocks or per-table index blocks.
+//
+// With BlockBasedTableOptions::data_block_restart_key_prefixes, an array of
+// fixed-width prefixes of the restart keys is appended to the data block,
+// right after the restart array:
+//
+// DATA_BLOCK: [RI RI RI ... RI RI_IDX PREFIXES (HASH_IDX) FOOTER]
+//
+// RI:       Restart Interval (the same as the default data-block format)
+// RI_IDX:   Restart Interval index (the same as the default data-block format)
+// PREFIXES: fixed64[num_restarts]. The ith entry is the restart key prefix
+//           (see RestartKeyPrefix()) of the user key of the ith restart point.
+// HASH_IDX: The optional data-block hash index (see data_block_hash_index.h).
+// FOOTER:   A 32bit block footer, which is NUM_RESTARTS with bit 30 as the
+//           flag indicating that PREFIXES is present (see
+//           data_block_footer.h).
+//
+// Since restart keys are sorted, so are their prefixes. A seek first locates
+// the restart points whose prefix equals the prefix of the target with a
+// search over the array, vectorized with AVX2 when available, and only
+// compares full keys among those. When the prefixes of the restart keys are
+// distinct, as is common with fixed-size keys, a seek decodes no restart key
+// at all.
+//
+// Like the hash index, the prefixes are only written in blocks smaller than
+// kMaxBlockSizeSupportedByHashIndex, where the flag cannot be mistaken for a
+// bit of a legacy NUM_RESTARTS.
+
+// Returns the first 8 bytes of user_key, padded with zeros, as a big-endian
+// number, so that prefixes of keys order like the keys themselves under
+// BytewiseComparator.
+uint64_t RestartKeyPrefix(const Slice& user_key);
+
+class DataBlockRestartKeyPrefixes {
+ public:
+  DataBlockRestartKeyPrefixes() : prefixes_(nullptr), num_restarts_(0) {}
+
+  void Initialize(const char* prefixes, uint32_t num_restarts) {
+    prefixes_ = prefixes;
+    num_restarts_ = num_restarts;
+  }
+
+  bool Valid() const { return prefixes_ != nullptr; }
+
+  // Narrows [*left, *right], initially all the restart points, to those a
+  // binary search for user_key has to compare keys with: the last restart
+  // point with a smaller prefix, if any, and the ones with an equal prefix.
+  void FindRestartRange(const Slice& user_key, uint32_t* left,
+                        uint32_t* right) const;
+
+ private:
+  // Returns the number of prefixes less than prefix, or less than or equal to
+  // it if or_equal is true.
+  uint32_t CountLess(uint64_t prefix, bool or_equal) const;
+
+  const char* prefixes_;
+  uint32_t num_restarts_;
+};
+
+}  // namespace rocksdb
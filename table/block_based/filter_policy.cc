@@ -7,6 +7,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
+#include <algorithm>
 #include <array>
 #include <deque>
 
@@ -20,6 +21,7 @@
 #include "util/bloom_impl.h"
 #include "util/coding.h"
 #include "util/hash.h"
+#include "util/ribbon_impl.h"
 
 namespace rocksdb {
 
@@ -97,6 +99,13 @@ class FastLocalBloomBitsBuilder : public BuiltinFilterBitsBuilder {
                                                num_probes_, /*hash bits*/ 64);
   }
 
+  // Takes the key hashes collected by another builder using the same hash
+  // (GetSliceHash64), for building a Bloom filter in its place.
+  void TakeHashEntries(std::deque<uint64_t>* hash_entries) {
+    assert(hash_entries_.empty());
+    hash_entries_.swap(*hash_entries);
+  }
+
  private:
   void AddAllEntries(char* data, uint32_t len) {
     // Simple version without prefetching:
@@ -195,6 +204,184 @@ class FastLocalBloomBitsReader : public FilterBitsReader {
   const uint32_t len_bytes_;
 };
 
+// See description in StandardRibbonImpl
+class StandardRibbonBitsBuilder : public BuiltinFilterBitsBuilder {
+ public:
+  explicit StandardRibbonBitsBuilder(const int millibits_per_key)
+      : num_result_bits_(
+            StandardRibbonImpl::ChooseNumResultBits(millibits_per_key)),
+        bloom_fallback_(millibits_per_key) {}
+
+  // No Copy allowed
+  StandardRibbonBitsBuilder(const StandardRibbonBitsBuilder&) = delete;
+  void operator=(const StandardRibbonBitsBuilder&) = delete;
+
+  ~StandardRibbonBitsBuilder() override {}
+
+  virtual void AddKey(const Slice& key) override {
+    uint64_t hash = GetSliceHash64(key);
+    if (hash_entries_.empty() || hash != hash_entries_.back()) {
+      hash_entries_.push_back(hash);
+    }
+  }
+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    const uint32_t num_entries = static_cast<uint32_t>(hash_entries_.size());
+    const uint32_t num_slots = StandardRibbonImpl::GetNumSlots(num_entries);
+
+    std::unique_ptr<uint64_t[]> coeff_rows(new uint64_t[num_slots]);
+    std::unique_ptr<uint32_t[]> result_rows(new uint32_t[num_slots]);
+    for (uint32_t seed = 0; seed < kMaxSeeds; ++seed) {
+      if (TryBanding(seed, num_slots, coeff_rows.get(), result_rows.get())) {
+        return FinishRibbon(seed, num_slots, coeff_rows.get(),
+                            result_rows.get(), buf);
+      }
+    }
+    // Extremely unlikely, unless the keys have many distinct hashes that
+    // only differ after remixing (not with a good hash function). Build a
+    // Bloom filter instead, which the reader recognizes by its metadata.
+    coeff_rows.reset();
+    result_rows.reset();
+    bloom_fallback_.TakeHashEntries(&hash_entries_);
+    return bloom_fallback_.Finish(buf);
+  }
+
+  int CalculateNumEntry(const uint32_t bytes) override {
+    uint32_t bytes_no_meta = bytes >= 5u ? bytes - 5u : 0;
+    uint32_t max_slots = bytes_no_meta / (num_result_bits_ * 8) *
+                         StandardRibbonImpl::kCoeffBits;
+    // Largest number of keys that fits in max_slots (GetNumSlots is
+    // monotonic)
+    uint32_t low = 0;
+    uint32_t high = max_slots;
+    while (low < high) {
+      uint32_t mid = low + (high - low + 1) / 2;
+      if (StandardRibbonImpl::GetNumSlots(mid) <= max_slots) {
+        low = mid;
+      } else {
+        high = mid - 1;
+      }
+    }
+    return static_cast<int>(low);
+  }
+
+  uint32_t CalculateSpace(const int num_entry) override {
+    uint32_t num_slots = StandardRibbonImpl::GetNumSlots(
+        static_cast<uint32_t>(std::max(num_entry, 0)));
+    return num_slots / StandardRibbonImpl::kCoeffBits * num_result_bits_ * 8 +
+           /*metadata*/ 5;
+  }
+
+  double EstimatedFpRate(size_t keys, size_t /*bytes*/) override {
+    return StandardRibbonImpl::EstimatedFpRate(keys, num_result_bits_);
+  }
+
+ private:
+  // Seeds are stored in one byte of metadata
+  static constexpr uint32_t kMaxSeeds = 256;
+
+  bool TryBanding(uint32_t seed, uint32_t num_slots, uint64_t* coeff_rows,
+                  uint32_t* result_rows) {
+    std::fill(coeff_rows, coeff_rows + num_slots, uint64_t{0});
+    std::fill(result_rows, result_rows + num_slots, uint32_t{0});
+    for (uint64_t h : hash_entries_) {
+      uint32_t start;
+      uint64_t coeff_row;
+      uint32_t result;
+      StandardRibbonImpl::PrepareHash(h, seed, num_slots, num_result_bits_,
+                                      &start, &coeff_row, &result);
+      if (!StandardRibbonImpl::BandingAdd(coeff_rows, result_rows, start,
+                                          coeff_row, result)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  Slice FinishRibbon(uint32_t seed, uint32_t num_slots,
+                     const uint64_t* coeff_rows, const uint32_t* result_rows,
+                     std::unique_ptr<const char[]>* buf) {
+    uint32_t len_with_metadata =
+        CalculateSpace(static_cast<int>(hash_entries_.size()));
+    char* data = new char[len_with_metadata];
+    memset(data, 0, len_with_metadata);
+
+    uint32_t len = len_with_metadata - 5;
+    if (len > 0) {
+      StandardRibbonImpl::BackSubstitute(coeff_rows, result_rows, num_slots,
+                                         num_result_bits_, data);
+    }
+
+    // See BloomFilterPolicy::GetRibbonBitsReader re: metadata
+    // -2 = Marker for Standard Ribbon
+    data[len] = static_cast<char>(-2);
+    data[len + 1] = static_cast<char>(seed);
+    data[len + 2] = static_cast<char>(num_result_bits_);
+    // rest of metadata stays zero
+
+    const char* const_data = data;
+    buf->reset(const_data);
+    hash_entries_.clear();
+
+    return Slice(data, len_with_metadata);
+  }
+
+  int num_result_bits_;
+  // A deque avoids unnecessary copying of already-saved values
+  // and has near-minimal peak memory use.
+  std::deque<uint64_t> hash_entries_;
+  // In case no seed leads to a successful banding
+  FastLocalBloomBitsBuilder bloom_fallback_;
+};
+
+// See description in StandardRibbonImpl
+class StandardRibbonBitsReader : public FilterBitsReader {
+ public:
+  StandardRibbonBitsReader(const char* data, uint32_t seed,
+                           int num_result_bits, uint32_t num_slots)
+      : data_(data),
+        seed_(seed),
+        num_result_bits_(num_result_bits),
+        num_slots_(num_slots) {}
+
+  // No Copy allowed
+  StandardRibbonBitsReader(const StandardRibbonBitsReader&) = delete;
+  void operator=(const StandardRibbonBitsReader&) = delete;
+
+  ~StandardRibbonBitsReader() override {}
+
+  bool MayMatch(const Slice& key) override {
+    return StandardRibbonImpl::HashMayMatch(GetSliceHash64(key), seed_,
+                                            num_slots_, num_result_bits_,
+                                            data_);
+  }
+
+  virtual void MayMatch(int num_keys, Slice** keys, bool* may_match) override {
+    std::array<uint32_t, MultiGetContext::MAX_BATCH_SIZE> starts;
+    std::array<uint64_t, MultiGetContext::MAX_BATCH_SIZE> coeff_rows;
+    std::array<uint32_t, MultiGetContext::MAX_BATCH_SIZE> results;
+    std::array<uint32_t, MultiGetContext::MAX_BATCH_SIZE> byte_offsets;
+    for (int i = 0; i < num_keys; ++i) {
+      StandardRibbonImpl::PrepareHash(GetSliceHash64(*keys[i]), seed_,
+                                      num_slots_, num_result_bits_,
+                                      &starts[i], &coeff_rows[i], &results[i]);
+      StandardRibbonImpl::PrepareQuery(starts[i], num_result_bits_, data_,
+                                       /*out*/ &byte_offsets[i]);
+    }
+    for (int i = 0; i < num_keys; ++i) {
+      may_match[i] = StandardRibbonImpl::QueryPrepared(
+          starts[i], coeff_rows[i], results[i], num_result_bits_,
+          data_ + byte_offsets[i]);
+    }
+  }
+
+ private:
+  const char* data_;
+  const uint32_t seed_;
+  const int num_result_bits_;
+  const uint32_t num_slots_;
+};
+
 using LegacyBloomImpl = LegacyLocalityBloomImpl</*ExtraRotates*/ false>;
 
 class LegacyBloomBitsBuilder : public BuiltinFilterBitsBuilder {
@@ -449,11 +636,13 @@ const std::vector<BloomFilterPolicy::Mode> BloomFilterPolicy::kAllFixedImpls = {
     kLegacyBloom,
     kDeprecatedBlock,
     kFastLocalBloom,
+    kStandardRibbon,
 };
 
 const std::vector<BloomFilterPolicy::Mode> BloomFilterPolicy::kAllUserModes = {
     kDeprecatedBlock,
     kAuto,
+    kStandardRibbon,
 };
 
 BloomFilterPolicy::BloomFilterPolicy(double bits_per_key, Mode mode)
@@ -564,6 +753,8 @@ FilterBitsBuilder* BloomFilterPolicy::GetBuilderWithContext(
         return nullptr;
       case kFastLocalBloom:
         return new FastLocalBloomBitsBuilder(millibits_per_key_);
+      case kStandardRibbon:
+        return new StandardRibbonBitsBuilder(millibits_per_key_);
       case kLegacyBloom:
         if (whole_bits_per_key_ >= 14 && context.info_log &&
             !warned_.load(std::memory_order_relaxed)) {
@@ -636,6 +827,10 @@ FilterBitsReader* BloomFilterPolicy::GetFilterBitsReader(
       // Marker for newer Bloom implementations
       return GetBloomBitsReader(contents);
     }
+    if (raw_num_probes == -2) {
+      // Marker for Standard Ribbon
+      return GetRibbonBitsReader(contents);
+    }
     // otherwise
     // Treat as zero probes (always FP) for now.
     return new AlwaysTrueFilter();
@@ -736,6 +931,57 @@ FilterBitsReader* BloomFilterPolicy::GetBloomBitsReader(
   return new AlwaysTrueFilter();
 }
 
+// For Standard Ribbon filters
+FilterBitsReader* BloomFilterPolicy::GetRibbonBitsReader(
+    const Slice& contents) const {
+  uint32_t len_with_meta = static_cast<uint32_t>(contents.size());
+  uint32_t len = len_with_meta - 5;
+
+  assert(len > 0);  // precondition
+
+  // Standard Ribbon filter data:
+  //             0 +-----------------------------------+
+  //               | Interleaved solution, in blocks   |
+  //               |   of num_result_bits 64-bit words |
+  //               | ...                               |
+  //           len +-----------------------------------+
+  //               | char{-2} byte -> Standard Ribbon  |
+  //         len+1 +-----------------------------------+
+  //               | byte for hash seed                |
+  //         len+2 +-----------------------------------+
+  //               | byte for num_result_bits          |
+  //               |   1 to 32 supported               |
+  //         len+3 +-----------------------------------+
+  //               | two bytes reserved                |
+  // len_with_meta +-----------------------------------+
+
+  uint32_t seed = static_cast<uint8_t>(contents.data()[len_with_meta - 4]);
+  int num_result_bits =
+      static_cast<uint8_t>(contents.data()[len_with_meta - 3]);
+  if (num_result_bits < 1 ||
+      num_result_bits > StandardRibbonImpl::kMaxResultBits) {
+    // Reserved / future safe
+    return new AlwaysTrueFilter();
+  }
+
+  uint16_t rest = DecodeFixed16(contents.data() + len_with_meta - 2);
+  if (rest != 0) {
+    // Reserved
+    // Future safe
+    return new AlwaysTrueFilter();
+  }
+
+  uint32_t block_bytes = static_cast<uint32_t>(num_result_bits) * 8;
+  if (len % block_bytes != 0) {
+    // Invalid (not a whole number of blocks)
+    // Treat as zero probes (always FP) for now.
+    return new AlwaysTrueFilter();
+  }
+  uint32_t num_slots = len / block_bytes * StandardRibbonImpl::kCoeffBits;
+  return new StandardRibbonBitsReader(contents.data(), seed, num_result_bits,
+                                      num_slots);
+}
+
 const FilterPolicy* NewBloomFilterPolicy(double bits_per_key,
                                          bool use_block_based_builder) {
   BloomFilterPolicy::Mode m;
@@ -750,6 +996,12 @@ const FilterPolicy* NewBloomFilterPolicy(double bits_per_key,
   return new BloomFilterPolicy(bits_per_key, m);
 }
 
+const FilterPolicy* NewRibbonFilterPolicy(
+    double bloom_equivalent_bits_per_key) {
+  return new BloomFilterPolicy(bloom_equivalent_bits_per_key,
+                               BloomFilterPolicy::kStandardRibbon);
+}
+
 FilterBuildingContext::FilterBuildingContext(
     const BlockBasedTableOptions& _table_options)
     : table_options(_table_options) {}
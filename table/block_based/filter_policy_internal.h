@@ -64,6 +64,12 @@ class BloomFilterPolicy : public FilterPolicy {
     // FastLocalBloomImpl.
     // NOTE: TESTING ONLY as this mode does not check format_version
     kFastLocalBloom = 2,
+    // A Standard Ribbon filter, a static function filter that takes about
+    // 25-30% less space than kFastLocalBloom for the same FP rate, but is
+    // several times more expensive to build. See StandardRibbonImpl.
+    // NOTE: user exposed through NewRibbonFilterPolicy, and it does not
+    // check format_version (older versions read it as always-true).
+    kStandardRibbon = 3,
     // Automatically choose from the above (except kDeprecatedBlock) based on
     // context at build time, including compatibility with format_version.
     // NOTE: This is currently the only recommended mode that is user exposed.
@@ -137,6 +143,9 @@ class BloomFilterPolicy : public FilterPolicy {
 
   // For newer Bloom filter implementation(s)
   FilterBitsReader* GetBloomBitsReader(const Slice& contents) const;
+
+  // For Ribbon filter implementation(s)
+  FilterBitsReader* GetRibbonBitsReader(const Slice& contents) const;
 };
 
 }  // namespace rocksdb
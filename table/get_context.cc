@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include "table/get_context.h"
+#include "db/blob/blob_fetcher.h"
 #include "db/merge_helper.h"
 #include "db/pinned_iterators_manager.h"
 #include "db/read_callback.h"
@@ -44,7 +45,8 @@ GetContext::GetContext(
     PinnableSlice* pinnable_val, bool* value_found, MergeContext* merge_context,
     bool do_merge, SequenceNumber* _max_covering_tombstone_seq, Env* env,
     SequenceNumber* seq, PinnedIteratorsManager* _pinned_iters_mgr,
-    ReadCallback* callback, bool* is_blob_index, uint64_t tracing_get_id)
+    ReadCallback* callback, bool* is_blob_index, uint64_t tracing_get_id,
+    BlobFetcher* blob_fetcher)
     : ucmp_(ucmp),
       merge_operator_(merge_operator),
       logger_(logger),
@@ -62,6 +64,7 @@ GetContext::GetContext(
       callback_(callback),
       do_merge_(do_merge),
       is_blob_index_(is_blob_index),
+      blob_fetcher_(blob_fetcher),
       tracing_get_id_(tracing_get_id) {
   if (seq_) {
     *seq_ = kMaxSequenceNumber;
@@ -74,6 +77,21 @@ GetContext::GetContext(
 // case we can't guarantee that key does not exist and are not permitted to do
 // IO to be certain.Set the status=kFound and value_found=false to let the
 // caller know that key may exist but is not there in memory
+bool GetContext::GetBlobValue(const Slice& blob_index,
+                              PinnableSlice* blob_value) {
+  assert(blob_fetcher_ != nullptr);
+  Status status = blob_fetcher_->FetchBlob(user_key_, blob_index, blob_value);
+  if (!status.ok()) {
+    if (status.IsIncomplete()) {
+      MarkKeyMayExist();
+    } else {
+      state_ = kCorrupt;
+    }
+    return false;
+  }
+  return true;
+}
+
 void GetContext::MarkKeyMayExist() {
   state_ = kFound;
   if (value_found_ != nullptr) {
@@ -207,13 +225,27 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
     }
     switch (type) {
       case kTypeValue:
-      case kTypeBlobIndex:
+      case kTypeBlobIndex: {
         assert(state_ == kNotFound || state_ == kMerge);
         if (type == kTypeBlobIndex && is_blob_index_ == nullptr) {
           // Blob value not supported. Stop.
           state_ = kBlobIndex;
           return false;
         }
+        // A blob index found on its own is handed back to the caller, but
+        // merges and GetMergeOperands need the blob itself.
+        PinnableSlice blob_value;
+        Slice value_to_use = value;
+        Cleanable* value_pinner_to_use = value_pinner;
+        if (type == kTypeBlobIndex && blob_fetcher_ != nullptr &&
+            (kMerge == state_ || !do_merge_)) {
+          if (!GetBlobValue(value, &blob_value)) {
+            return false;
+          }
+          value_to_use = blob_value;
+          value_pinner_to_use = nullptr;
+          type = kTypeValue;
+        }
         if (kNotFound == state_) {
           state_ = kFound;
           if (do_merge_) {
@@ -233,7 +265,7 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
             // It means this function is called as part of DB GetMergeOperands
             // API and the current value should be part of
             // merge_context_->operand_list
-            push_operand(value, value_pinner);
+            push_operand(value_to_use, value_pinner_to_use);
           }
         } else if (kMerge == state_) {
           assert(merge_operator_ != nullptr);
@@ -241,7 +273,7 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
           if (do_merge_) {
             if (LIKELY(pinnable_val_ != nullptr)) {
               Status merge_status = MergeHelper::TimedFullMerge(
-                  merge_operator_, user_key_, &value,
+                  merge_operator_, user_key_, &value_to_use,
                   merge_context_->GetOperands(), pinnable_val_->GetSelf(),
                   logger_, statistics_, env_);
               pinnable_val_->PinSelf();
@@ -253,13 +285,14 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
             // It means this function is called as part of DB GetMergeOperands
             // API and the current value should be part of
             // merge_context_->operand_list
-            push_operand(value, value_pinner);
+            push_operand(value_to_use, value_pinner_to_use);
           }
         }
         if (is_blob_index_ != nullptr) {
           *is_blob_index_ = (type == kTypeBlobIndex);
         }
         return false;
+      }
 
       case kTypeDeletion:
       case kTypeSingleDeletion:
@@ -14,6 +14,7 @@
 #include "table/block_based/block.h"
 
 namespace rocksdb {
+class BlobFetcher;
 class MergeContext;
 class PinnedIteratorsManager;
 
@@ -81,6 +82,9 @@ class GetContext {
   //                 for visibility of a key
   // @param is_blob_index If non-nullptr, will be used to indicate if a found
   //                      key is of type blob index
+  // @param blob_fetcher If non-nullptr, used to read the blob that a blob
+  //                     index refers to whenever it has to be merged with
+  //                     merge operands or returned as a merge operand itself
   // @param do_merge True if value associated with user_key has to be returned
   // and false if all the merge operands associated with user_key has to be
   // returned. Id do_merge=false then all the merge operands are stored in
@@ -93,7 +97,7 @@ class GetContext {
              SequenceNumber* seq = nullptr,
              PinnedIteratorsManager* _pinned_iters_mgr = nullptr,
              ReadCallback* callback = nullptr, bool* is_blob_index = nullptr,
-             uint64_t tracing_get_id = 0);
+             uint64_t tracing_get_id = 0, BlobFetcher* blob_fetcher = nullptr);
 
   GetContext() = delete;
 
@@ -150,6 +154,11 @@ class GetContext {
   void push_operand(const Slice& value, Cleanable* value_pinner);
 
  private:
+  // Reads the blob a blob index refers to. On failure, the lookup ends in
+  // kCorrupt, or kFound with *value_found_ = false if the blob could not be
+  // read without IO.
+  bool GetBlobValue(const Slice& blob_index, PinnableSlice* blob_value);
+
   const Comparator* ucmp_;
   const MergeOperator* merge_operator_;
   // the merge operations encountered;
@@ -176,6 +185,7 @@ class GetContext {
   // are never merged.
   bool do_merge_;
   bool* is_blob_index_;
+  BlobFetcher* blob_fetcher_;
   // Used for block cache tracing only. A tracing get id uniquely identifies a
   // Get or a MultiGet.
   const uint64_t tracing_get_id_;
@@ -122,6 +122,19 @@ class InternalIteratorBase : public Cleanable {
   // iterate_upper_bound.
   virtual bool MayBeOutOfUpperBound() { return true; }
 
+  // Used by DBIter to step over entries covered by a range tombstone. The
+  // iterator may drop any entries between the current position and the
+  // internal key end_key (exclusive) that it knows to have a sequence number
+  // smaller than seq, without reading them. Returns true iff the current
+  // entry was dropped, in which case the iterator is positioned at the next
+  // entry that was not. Otherwise the current entry stays the same.
+  // Iterators that cannot cheaply prove the bound keep the default.
+  // REQUIRES: Valid() and the last positioning call was not backward.
+  virtual bool SkipCoveredEntries(const Slice& /*end_key*/,
+                                  SequenceNumber /*seq*/) {
+    return false;
+  }
+
   // Pass the PinnedIteratorsManager to the Iterator, most Iterators dont
   // communicate with PinnedIteratorsManager so default implementation is no-op
   // but for Iterators that need to communicate with PinnedIteratorsManager
@@ -86,6 +86,15 @@ class IteratorWrapperBase {
   void SeekToFirst()        { assert(iter_); iter_->SeekToFirst(); Update(); }
   void SeekToLast()         { assert(iter_); iter_->SeekToLast();  Update(); }
 
+  bool SkipCoveredEntries(const Slice& end_key, SequenceNumber seq) {
+    assert(Valid());
+    if (!iter_->SkipCoveredEntries(end_key, seq)) {
+      return false;
+    }
+    Update();
+    return true;
+  }
+
   bool MayBeOutOfLowerBound() {
     assert(Valid());
     return iter_->MayBeOutOfLowerBound();
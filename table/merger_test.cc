@@ -24,8 +24,9 @@ class MergerTest : public testing::Test {
     std::vector<std::string> ret;
 
     for (size_t i = 0; i < len; ++i) {
-      InternalKey ik(test::RandomHumanReadableString(&rnd_, string_len), 0,
-                     ValueType::kTypeValue);
+      InternalKey ik(
+          key_prefix_ + test::RandomHumanReadableString(&rnd_, string_len), 0,
+          ValueType::kTypeValue);
       ret.push_back(ik.Encode().ToString(false));
     }
     return ret;
@@ -44,8 +45,8 @@ class MergerTest : public testing::Test {
   }
 
   void SeekToRandom() {
-    InternalKey ik(test::RandomHumanReadableString(&rnd_, 5), 0,
-                   ValueType::kTypeValue);
+    InternalKey ik(key_prefix_ + test::RandomHumanReadableString(&rnd_, 5),
+                   0, ValueType::kTypeValue);
     Seek(ik.Encode().ToString(false));
   }
 
@@ -113,6 +114,8 @@ class MergerTest : public testing::Test {
 
   InternalKeyComparator icomp_;
   Random rnd_;
+  // Prepended to every generated key.
+  std::string key_prefix_;
   std::unique_ptr<InternalIterator> merging_iterator_;
   std::unique_ptr<InternalIterator> single_iterator_;
   std::vector<std::string> all_keys_;
@@ -172,6 +175,22 @@ TEST_F(MergerTest, SeekToLastTest) {
   }
 }
 
+TEST_F(MergerTest, SharedKeyPrefixTest) {
+  // The keys share their first 7 bytes, so the merge has to fall back to the
+  // comparator whenever the 8th byte is the same.
+  key_prefix_ = "shared.";
+  Generate(200, 50, 10);
+  for (int i = 0; i < 3; ++i) {
+    SeekToRandom();
+    AssertEquivalence();
+    NextAndPrev(5000);
+  }
+  SeekToFirst();
+  Next(50000);
+  SeekToLast();
+  Prev(50000);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "table/merging_iterator.h"
+#include <string.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include "db/dbformat.h"
@@ -18,22 +20,36 @@
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
 #include "table/internal_iterator.h"
-#include "table/iter_heap.h"
 #include "table/iterator_wrapper.h"
 #include "test_util/sync_point.h"
 #include "util/autovector.h"
-#include "util/heap.h"
 #include "util/stop_watch.h"
 
 namespace rocksdb {
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
-typedef BinaryHeap<IteratorWrapper*, MaxIteratorComparator> MergerMaxIterHeap;
-typedef BinaryHeap<IteratorWrapper*, MinIteratorComparator> MergerMinIterHeap;
+// Returns the first 8 bytes of the user key of `internal_key`, zero padded,
+// as a big-endian integer. When the prefixes of two keys differ, they order
+// the keys the same way BytewiseComparator() does.
+uint64_t UserKeyPrefix(const Slice& internal_key) {
+  Slice user_key = ExtractUserKey(internal_key);
+  unsigned char buf[sizeof(uint64_t)] = {0};
+  memcpy(buf, user_key.data(), std::min(user_key.size(), sizeof(buf)));
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    prefix = (prefix << 8) | buf[i];
+  }
+  return prefix;
+}
 }  // namespace
 
 const size_t kNumIterReserve = 4;
 
+// Merges the children with a tournament ("loser") tree. Every step replays
+// only the matches on the path of the child that moved, i.e. log2(n)
+// comparisons. With a bytewise user comparator each child also caches the
+// first 8 bytes of its user key as an integer, so most of those comparisons
+// are a single integer compare and the comparator only breaks ties.
 class MergingIterator : public InternalIterator {
  public:
   MergingIterator(const InternalKeyComparator* comparator,
@@ -41,19 +57,29 @@ class MergingIterator : public InternalIterator {
                   bool prefix_seek_mode)
       : is_arena_mode_(is_arena_mode),
         comparator_(comparator),
+        use_key_prefixes_(false),
+        key_prefix_mask_(0),
         current_(nullptr),
         direction_(kForward),
-        minHeap_(comparator_),
         prefix_seek_mode_(prefix_seek_mode),
         pinned_iters_mgr_(nullptr) {
+    const Comparator* user_comparator = comparator_->user_comparator();
+    if (user_comparator == BytewiseComparator()) {
+      use_key_prefixes_ = true;
+    } else if (user_comparator == ReverseBytewiseComparator()) {
+      // Flipping every bit reverses the order of the prefixes.
+      use_key_prefixes_ = true;
+      key_prefix_mask_ = ~static_cast<uint64_t>(0);
+    }
     children_.resize(n);
+    prefixes_.resize(n);
+    largest_seqnos_.resize(n);
+    tree_.resize(n);
     for (int i = 0; i < n; i++) {
       children_[i].Set(children[i]);
+      largest_seqnos_[i] = kMaxSequenceNumber;
     }
-    for (auto& child : children_) {
-      AddToMinHeapOrCheckStatus(&child);
-    }
-    current_ = CurrentForward();
+    current_ = BuildTree();
   }
 
   void considerStatus(Status s) {
@@ -62,16 +88,24 @@ class MergingIterator : public InternalIterator {
     }
   }
 
-  virtual void AddIterator(InternalIterator* iter) {
+  virtual void AddIterator(InternalIterator* iter,
+                           SequenceNumber largest_seqno) {
     assert(direction_ == kForward);
     children_.emplace_back(iter);
+    prefixes_.push_back(0);
+    largest_seqnos_.push_back(largest_seqno);
+    tree_.push_back(0);
     if (pinned_iters_mgr_) {
       iter->SetPinnedItersMgr(pinned_iters_mgr_);
     }
-    auto new_wrapper = children_.back();
-    AddToMinHeapOrCheckStatus(&new_wrapper);
-    if (new_wrapper.Valid()) {
-      current_ = CurrentForward();
+    if (current_ == nullptr && !children_.back().Valid()) {
+      // Every child is exhausted or unpositioned, as when the
+      // MergeIteratorBuilder adds them one at a time. The tree is rebuilt
+      // by the next seek.
+      considerStatus(children_.back().status());
+    } else {
+      // children_ may have moved, so play all the matches again.
+      current_ = BuildTree();
     }
   }
 
@@ -86,30 +120,24 @@ class MergingIterator : public InternalIterator {
   Status status() const override { return status_; }
 
   void SeekToFirst() override {
-    ClearHeaps();
     status_ = Status::OK();
     for (auto& child : children_) {
       child.SeekToFirst();
-      AddToMinHeapOrCheckStatus(&child);
     }
     direction_ = kForward;
-    current_ = CurrentForward();
+    current_ = BuildTree();
   }
 
   void SeekToLast() override {
-    ClearHeaps();
-    InitMaxHeap();
     status_ = Status::OK();
     for (auto& child : children_) {
       child.SeekToLast();
-      AddToMaxHeapOrCheckStatus(&child);
     }
     direction_ = kReverse;
-    current_ = CurrentReverse();
+    current_ = BuildTree();
   }
 
   void Seek(const Slice& target) override {
-    ClearHeaps();
     status_ = Status::OK();
     for (auto& child : children_) {
       {
@@ -118,23 +146,15 @@ class MergingIterator : public InternalIterator {
       }
 
       PERF_COUNTER_ADD(seek_child_seek_count, 1);
-      {
-        // Strictly, we timed slightly more than min heap operation,
-        // but these operations are very cheap.
-        PERF_TIMER_GUARD(seek_min_heap_time);
-        AddToMinHeapOrCheckStatus(&child);
-      }
     }
     direction_ = kForward;
     {
       PERF_TIMER_GUARD(seek_min_heap_time);
-      current_ = CurrentForward();
+      current_ = BuildTree();
     }
   }
 
   void SeekForPrev(const Slice& target) override {
-    ClearHeaps();
-    InitMaxHeap();
     status_ = Status::OK();
 
     for (auto& child : children_) {
@@ -143,16 +163,11 @@ class MergingIterator : public InternalIterator {
         child.SeekForPrev(target);
       }
       PERF_COUNTER_ADD(seek_child_seek_count, 1);
-
-      {
-        PERF_TIMER_GUARD(seek_max_heap_time);
-        AddToMaxHeapOrCheckStatus(&child);
-      }
     }
     direction_ = kReverse;
     {
       PERF_TIMER_GUARD(seek_max_heap_time);
-      current_ = CurrentReverse();
+      current_ = BuildTree();
     }
   }
 
@@ -167,27 +182,23 @@ class MergingIterator : public InternalIterator {
       SwitchToForward();
       // The loop advanced all non-current children to be > key() so current_
       // should still be strictly the smallest key.
-      assert(current_ == CurrentForward());
+      assert(current_ == Winner());
     }
 
-    // For the heap modifications below to be correct, current_ must be the
-    // current top of the heap.
-    assert(current_ == CurrentForward());
+    // For the replay below to be correct, current_ must be the winner of the
+    // tree.
+    assert(current_ == Winner());
 
     // as the current points to the current record. move the iterator forward.
     current_->Next();
     if (current_->Valid()) {
-      // current is still valid after the Next() call above.  Call
-      // replace_top() to restore the heap property.  When the same child
-      // iterator yields a sequence of keys, this is cheap.
+      // current is still valid after the Next() call above.
       assert(current_->status().ok());
-      minHeap_.replace_top(current_);
     } else {
-      // current stopped being valid, remove it from the heap.
+      // current stopped being valid, it loses every match from now on.
       considerStatus(current_->status());
-      minHeap_.pop();
     }
-    current_ = CurrentForward();
+    current_ = ReplayWinner();
   }
 
   bool NextAndGetResult(IterateResult* result) override {
@@ -212,23 +223,19 @@ class MergingIterator : public InternalIterator {
       SwitchToBackward();
     }
 
-    // For the heap modifications below to be correct, current_ must be the
-    // current top of the heap.
-    assert(current_ == CurrentReverse());
+    // For the replay below to be correct, current_ must be the winner of the
+    // tree.
+    assert(current_ == Winner());
 
     current_->Prev();
     if (current_->Valid()) {
-      // current is still valid after the Prev() call above.  Call
-      // replace_top() to restore the heap property.  When the same child
-      // iterator yields a sequence of keys, this is cheap.
+      // current is still valid after the Prev() call above.
       assert(current_->status().ok());
-      maxHeap_->replace_top(current_);
     } else {
-      // current stopped being valid, remove it from the heap.
+      // current stopped being valid, it loses every match from now on.
       considerStatus(current_->status());
-      maxHeap_->pop();
     }
-    current_ = CurrentReverse();
+    current_ = ReplayWinner();
   }
 
   Slice key() const override {
@@ -241,6 +248,40 @@ class MergingIterator : public InternalIterator {
     return current_->value();
   }
 
+  // A child whose entries are all older than seq is moved to end_key with
+  // a plain Seek(); any other child is asked to skip on its own. Children
+  // positioned at or past end_key are left alone. Not done in prefix seek
+  // mode, where a child may use its prefix filter to answer the seek.
+  bool SkipCoveredEntries(const Slice& end_key, SequenceNumber seq) override {
+    assert(Valid());
+    if (direction_ != kForward || prefix_seek_mode_) {
+      return false;
+    }
+    bool moved = false;
+    bool current_moved = false;
+    for (size_t i = 0; i < children_.size(); i++) {
+      IteratorWrapper& child = children_[i];
+      if (!child.Valid() || comparator_->Compare(child.key(), end_key) >= 0) {
+        continue;
+      }
+      bool skipped;
+      if (largest_seqnos_[i] < seq) {
+        child.Seek(end_key);
+        skipped = true;
+      } else {
+        skipped = child.SkipCoveredEntries(end_key, seq);
+      }
+      if (skipped) {
+        moved = true;
+        current_moved |= (&child == current_);
+      }
+    }
+    if (moved) {
+      current_ = BuildTree();
+    }
+    return current_moved;
+  }
+
   // Here we simply relay MayBeOutOfLowerBound/MayBeOutOfUpperBound result
   // from current child iterator. Potentially as long as one of child iterator
   // report out of bound is not possible, we know current key is within bound.
@@ -275,19 +316,26 @@ class MergingIterator : public InternalIterator {
   }
 
  private:
-  // Clears heaps for both directions, used when changing direction or seeking
-  void ClearHeaps();
-  // Ensures that maxHeap_ is initialized when starting to go in the reverse
-  // direction
-  void InitMaxHeap();
-
   bool is_arena_mode_;
   const InternalKeyComparator* comparator_;
+  // Whether prefixes_ can order the keys. Only true for the bytewise user
+  // comparators, whose prefixes are XORed with key_prefix_mask_.
+  bool use_key_prefixes_;
+  uint64_t key_prefix_mask_;
   autovector<IteratorWrapper, kNumIterReserve> children_;
+  // Cached key prefix of each valid child, indexed like children_.
+  autovector<uint64_t, kNumIterReserve> prefixes_;
+  // Upper bound on the sequence numbers of each child's entries, used by
+  // SkipCoveredEntries(). kMaxSequenceNumber if unknown.
+  autovector<SequenceNumber, kNumIterReserve> largest_seqnos_;
+  // Tournament tree over the indexes of children_. tree_[0] holds the
+  // winner, the child that is next in the current direction, and
+  // tree_[1..n-1] the loser of the match played at each internal node.
+  // Child i is the leaf at node n + i and the parent of node k is k / 2.
+  autovector<size_t, kNumIterReserve> tree_;
 
   // Cached pointer to child iterator with the current key, or nullptr if no
-  // child iterators are valid.  This is the top of minHeap_ or maxHeap_
-  // depending on the direction.
+  // child iterators are valid.  This is the winner of tree_.
   IteratorWrapper* current_;
   // If any of the children have non-ok status, this is one of them.
   Status status_;
@@ -297,62 +345,104 @@ class MergingIterator : public InternalIterator {
     kReverse
   };
   Direction direction_;
-  MergerMinIterHeap minHeap_;
   bool prefix_seek_mode_;
-
-  // Max heap is used for reverse iteration, which is way less common than
-  // forward.  Lazily initialize it to save memory.
-  std::unique_ptr<MergerMaxIterHeap> maxHeap_;
   PinnedIteratorsManager* pinned_iters_mgr_;
 
-  // In forward direction, process a child that is not in the min heap.
-  // If valid, add to the min heap. Otherwise, check status.
-  void AddToMinHeapOrCheckStatus(IteratorWrapper*);
+  uint64_t KeyPrefix(const IteratorWrapper& child) const {
+    return use_key_prefixes_ ? UserKeyPrefix(child.key()) ^ key_prefix_mask_
+                             : 0;
+  }
+
+  // Returns true if child `a` comes before child `b` in the current
+  // direction. Exhausted children lose every match.
+  bool Beats(size_t a, size_t b) const {
+    if (!children_[a].Valid()) {
+      return false;
+    }
+    if (!children_[b].Valid()) {
+      return true;
+    }
+    if (prefixes_[a] != prefixes_[b]) {
+      return (prefixes_[a] < prefixes_[b]) == (direction_ == kForward);
+    }
+    int cmp = comparator_->Compare(children_[a].key(), children_[b].key());
+    return direction_ == kForward ? cmp < 0 : cmp > 0;
+  }
+
+  // Plays the matches of the subtree rooted at `node` and returns the index
+  // of its winner.
+  size_t PlayMatches(size_t node);
+
+  // Plays every match again after the children were repositioned, and
+  // records the status of the invalid ones. Returns the new winner.
+  IteratorWrapper* BuildTree();
 
-  // In backward direction, process a child that is not in the max heap.
-  // If valid, add to the min heap. Otherwise, check status.
-  void AddToMaxHeapOrCheckStatus(IteratorWrapper*);
+  // Plays again the matches on the path of the winner after it moved, and
+  // returns the new winner.
+  IteratorWrapper* ReplayWinner();
+
+  IteratorWrapper* Winner() {
+    if (tree_.empty() || !children_[tree_[0]].Valid()) {
+      return nullptr;
+    }
+    return &children_[tree_[0]];
+  }
 
   void SwitchToForward();
 
   // Switch the direction from forward to backward without changing the
   // position. Iterator should still be valid.
   void SwitchToBackward();
+};
 
-  IteratorWrapper* CurrentForward() const {
-    assert(direction_ == kForward);
-    return !minHeap_.empty() ? minHeap_.top() : nullptr;
+size_t MergingIterator::PlayMatches(size_t node) {
+  const size_t n = children_.size();
+  if (node >= n) {
+    return node - n;
   }
-
-  IteratorWrapper* CurrentReverse() const {
-    assert(direction_ == kReverse);
-    assert(maxHeap_);
-    return !maxHeap_->empty() ? maxHeap_->top() : nullptr;
+  size_t left = PlayMatches(2 * node);
+  size_t right = PlayMatches(2 * node + 1);
+  if (Beats(right, left)) {
+    tree_[node] = left;
+    return right;
   }
-};
+  tree_[node] = right;
+  return left;
+}
 
-void MergingIterator::AddToMinHeapOrCheckStatus(IteratorWrapper* child) {
-  if (child->Valid()) {
-    assert(child->status().ok());
-    minHeap_.push(child);
-  } else {
-    considerStatus(child->status());
+IteratorWrapper* MergingIterator::BuildTree() {
+  if (children_.empty()) {
+    return nullptr;
   }
+  for (size_t i = 0; i < children_.size(); i++) {
+    if (children_[i].Valid()) {
+      assert(children_[i].status().ok());
+      prefixes_[i] = KeyPrefix(children_[i]);
+    } else {
+      considerStatus(children_[i].status());
+    }
+  }
+  tree_[0] = PlayMatches(1);
+  return Winner();
 }
 
-void MergingIterator::AddToMaxHeapOrCheckStatus(IteratorWrapper* child) {
-  if (child->Valid()) {
-    assert(child->status().ok());
-    maxHeap_->push(child);
-  } else {
-    considerStatus(child->status());
+IteratorWrapper* MergingIterator::ReplayWinner() {
+  size_t winner = tree_[0];
+  if (children_[winner].Valid()) {
+    prefixes_[winner] = KeyPrefix(children_[winner]);
+  }
+  for (size_t node = (children_.size() + winner) / 2; node > 0; node /= 2) {
+    if (Beats(tree_[node], winner)) {
+      std::swap(tree_[node], winner);
+    }
   }
+  tree_[0] = winner;
+  return Winner();
 }
 
 void MergingIterator::SwitchToForward() {
   // Otherwise, advance the non-current children.  We advance current_
   // just after the if-block.
-  ClearHeaps();
   Slice target = key();
   for (auto& child : children_) {
     if (&child != current_) {
@@ -362,14 +452,12 @@ void MergingIterator::SwitchToForward() {
         child.Next();
       }
     }
-    AddToMinHeapOrCheckStatus(&child);
   }
   direction_ = kForward;
+  BuildTree();
 }
 
 void MergingIterator::SwitchToBackward() {
-  ClearHeaps();
-  InitMaxHeap();
   Slice target = key();
   for (auto& child : children_) {
     if (&child != current_) {
@@ -380,30 +468,17 @@ void MergingIterator::SwitchToBackward() {
         child.Prev();
       }
     }
-    AddToMaxHeapOrCheckStatus(&child);
   }
   direction_ = kReverse;
+  IteratorWrapper* winner = BuildTree();
   if (!prefix_seek_mode_) {
-    // Note that we don't do assert(current_ == CurrentReverse()) here
+    // Note that we don't do assert(current_ == winner) here
     // because it is possible to have some keys larger than the seek-key
     // inserted between Seek() and SeekToLast(), which makes current_ not
-    // equal to CurrentReverse().
-    current_ = CurrentReverse();
-  }
-  assert(current_ == CurrentReverse());
-}
-
-void MergingIterator::ClearHeaps() {
-  minHeap_.clear();
-  if (maxHeap_) {
-    maxHeap_->clear();
-  }
-}
-
-void MergingIterator::InitMaxHeap() {
-  if (!maxHeap_) {
-    maxHeap_.reset(new MergerMaxIterHeap(comparator_));
+    // equal to the winner.
+    current_ = winner;
   }
+  assert(current_ == winner);
 }
 
 InternalIterator* NewMergingIterator(const InternalKeyComparator* cmp,
@@ -426,7 +501,10 @@ InternalIterator* NewMergingIterator(const InternalKeyComparator* cmp,
 
 MergeIteratorBuilder::MergeIteratorBuilder(
     const InternalKeyComparator* comparator, Arena* a, bool prefix_seek_mode)
-    : first_iter(nullptr), use_merging_iter(false), arena(a) {
+    : first_iter(nullptr),
+      first_iter_largest_seqno(kMaxSequenceNumber),
+      use_merging_iter(false),
+      arena(a) {
   auto mem = arena->AllocateAligned(sizeof(MergingIterator));
   merge_iter =
       new (mem) MergingIterator(comparator, nullptr, 0, true, prefix_seek_mode);
@@ -441,16 +519,18 @@ MergeIteratorBuilder::~MergeIteratorBuilder() {
   }
 }
 
-void MergeIteratorBuilder::AddIterator(InternalIterator* iter) {
+void MergeIteratorBuilder::AddIterator(InternalIterator* iter,
+                                       SequenceNumber largest_seqno) {
   if (!use_merging_iter && first_iter != nullptr) {
-    merge_iter->AddIterator(first_iter);
+    merge_iter->AddIterator(first_iter, first_iter_largest_seqno);
     use_merging_iter = true;
     first_iter = nullptr;
   }
   if (use_merging_iter) {
-    merge_iter->AddIterator(iter);
+    merge_iter->AddIterator(iter, largest_seqno);
   } else {
     first_iter = iter;
+    first_iter_largest_seqno = largest_seqno;
   }
 }
 
@@ -44,8 +44,11 @@ class MergeIteratorBuilder {
                                 Arena* arena, bool prefix_seek_mode = false);
   ~MergeIteratorBuilder();
 
-  // Add iter to the merging iterator.
-  void AddIterator(InternalIterator* iter);
+  // Add iter to the merging iterator. largest_seqno, if known, bounds the
+  // sequence numbers of iter's entries and lets the merging iterator skip
+  // ranges of iter covered by newer range tombstones without reading them.
+  void AddIterator(InternalIterator* iter,
+                   SequenceNumber largest_seqno = kMaxSequenceNumber);
 
   // Get arena used to build the merging iterator. It is called one a child
   // iterator needs to be allocated.
@@ -57,6 +60,7 @@ class MergeIteratorBuilder {
  private:
   MergingIterator* merge_iter;
   InternalIterator* first_iter;
+  SequenceNumber first_iter_largest_seqno;
   bool use_merging_iter;
   Arena* arena;
 };
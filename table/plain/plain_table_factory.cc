@@ -120,6 +120,15 @@ Status GetMemTableRepFactoryFromString(
     } else if (1 == len) {
       mem_factory = new SkipListFactory();
     }
+  } else if (opts_list[0] == "btree") {
+    // Expecting format
+    // btree
+    if (1 == len) {
+      mem_factory = new BTreeRepFactory();
+    } else {
+      return Status::InvalidArgument("Can't parse memtable_factory option ",
+                                     opts_str);
+    }
   } else if (opts_list[0] == "prefix_hash") {
     // Expecting format
     // prfix_hash:<hash_bucket_count>
@@ -9,6 +9,8 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
 #include "db/range_tombstone_fragmenter.h"
 #include "rocksdb/slice_transform.h"
 #include "table/get_context.h"
@@ -72,6 +74,16 @@ class TableReader {
   virtual uint64_t ApproximateSize(const Slice& start, const Slice& end,
                                    TableReaderCaller caller) = 0;
 
+  // Appends to anchors at most max_anchors user keys of the table, in
+  // ascending order, that split its data into ranges of roughly equal size.
+  // Used to pick subcompaction boundaries inside large input files. Returns
+  // Status::NotSupported() if the table cannot find them cheaply.
+  virtual Status ApproximateKeyAnchors(const ReadOptions& /*read_options*/,
+                                       size_t /*max_anchors*/,
+                                       std::vector<std::string>* /*anchors*/) {
+    return Status::NotSupported("ApproximateKeyAnchors() not supported.");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -110,6 +122,37 @@ class TableReader {
     }
   }
 
+  // State of a MultiGet() that was split into StartMultiGet() and
+  // FinishMultiGet(), so that its reads can be batched with those of other
+  // tables.
+  class AsyncMultiGetState {
+   public:
+    virtual ~AsyncMultiGetState() {}
+  };
+
+  // Start a MultiGet() for the keys in mget_range. Reads that are needed
+  // are submitted without waiting for them, and their IO handles appended
+  // to io_handles; see FSRandomAccessFile::ReadAsync(). Once those handles
+  // have been completed with FileSystem::Poll(), the lookup is finished by
+  // passing the returned state to FinishMultiGet(). A nullptr return means
+  // the lookup has already been completed.
+  //
+  // The default implementation performs a synchronous MultiGet().
+  virtual std::unique_ptr<AsyncMultiGetState> StartMultiGet(
+      const ReadOptions& readOptions, const MultiGetContext::Range* mget_range,
+      const SliceTransform* prefix_extractor, bool skip_filters,
+      std::vector<void*>* /*io_handles*/) {
+    MultiGet(readOptions, mget_range, prefix_extractor, skip_filters);
+    return nullptr;
+  }
+
+  // Complete a lookup started by StartMultiGet(). The key range passed to
+  // StartMultiGet() must still be valid.
+  virtual void FinishMultiGet(std::unique_ptr<AsyncMultiGetState>&& state) {
+    assert(state == nullptr);
+    (void)state;
+  }
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
@@ -2315,6 +2315,151 @@ TEST_P(BlockBasedTableTest, NumBlockStat) {
   c.ResetTableReader();
 }
 
+TEST_P(BlockBasedTableTest, ApproximateKeyAnchors) {
+  const int kNumKeys = 100;
+  TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key_ */);
+  Options options;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.block_size = 1000;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  // Each block holds exactly one key/value pair.
+  char key[16];
+  for (int i = 0; i < kNumKeys; ++i) {
+    snprintf(key, sizeof(key), "k%03d", i);
+    c.Add(key, std::string(900, 'v'));
+  }
+
+  std::vector<std::string> ks;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  const MutableCFOptions moptions(options);
+  c.Finish(options, ioptions, moptions, table_options,
+           GetPlainInternalComparator(options.comparator), &ks, &kvmap);
+  ASSERT_EQ(static_cast<uint64_t>(kNumKeys),
+            c.GetTableReader()->GetTableProperties()->num_data_blocks);
+
+  std::vector<std::string> anchors;
+  ASSERT_OK(c.GetTableReader()->ApproximateKeyAnchors(ReadOptions(), 0,
+                                                      &anchors));
+  ASSERT_TRUE(anchors.empty());
+
+  // Nine anchors split the hundred blocks into ten ranges of ten blocks.
+  ASSERT_OK(c.GetTableReader()->ApproximateKeyAnchors(ReadOptions(), 9,
+                                                      &anchors));
+  ASSERT_EQ(9U, anchors.size());
+  for (size_t i = 0; i < anchors.size(); ++i) {
+    int block = static_cast<int>(i + 1) * 10;
+    snprintf(key, sizeof(key), "k%03d", block - 1);
+    ASSERT_GE(anchors[i], std::string(key));
+    snprintf(key, sizeof(key), "k%03d", block);
+    ASSERT_LT(anchors[i], std::string(key));
+  }
+
+  // There is at most one anchor between each pair of blocks.
+  anchors.clear();
+  ASSERT_OK(c.GetTableReader()->ApproximateKeyAnchors(ReadOptions(), 1000,
+                                                      &anchors));
+  ASSERT_EQ(static_cast<size_t>(kNumKeys - 1), anchors.size());
+  c.ResetTableReader();
+}
+
+// Builds the same table with serial and parallel compression and checks that
+// the resulting files are byte-identical and readable, across compression
+// types and the table features that depend on the order blocks are written
+// in (filters, partitioned index, compression dictionary).
+TEST_P(BlockBasedTableTest, ParallelCompression) {
+  std::vector<CompressionType> compression_types{kNoCompression};
+  if (Snappy_Supported()) {
+    compression_types.push_back(kSnappyCompression);
+  }
+  if (Zlib_Supported()) {
+    compression_types.push_back(kZlibCompression);
+  }
+  if (LZ4_Supported()) {
+    compression_types.push_back(kLZ4Compression);
+  }
+  if (ZSTD_Supported()) {
+    compression_types.push_back(kZSTD);
+  }
+
+  enum FilterType { kNoFilter, kBlockFilter, kFullFilter, kPartitionedFilter };
+
+  Random rnd(301);
+  stl_wrappers::KVMap input;
+  std::string tmp;
+  for (int i = 0; i < 2000; ++i) {
+    input[RandomString(&rnd, 16)] =
+        test::CompressibleString(&rnd, 0.25, 1 + rnd.Uniform(300), &tmp)
+            .ToString();
+  }
+
+  for (auto compression_type : compression_types) {
+    for (auto filter_type :
+         {kNoFilter, kBlockFilter, kFullFilter, kPartitionedFilter}) {
+      for (bool use_dict : {false, true}) {
+        Options options;
+        options.compression = compression_type;
+        options.compression_opts.max_dict_bytes = use_dict ? 4096 : 0;
+        BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+        table_options.block_size = 1024;
+        table_options.metadata_block_size = 512;
+        table_options.verify_compression = true;
+        if (filter_type != kNoFilter) {
+          table_options.filter_policy.reset(
+              NewBloomFilterPolicy(10, filter_type == kBlockFilter));
+        }
+        if (filter_type == kPartitionedFilter) {
+          table_options.partition_filters = true;
+          table_options.index_type =
+              BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+        }
+        options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+        std::string contents[2];
+        uint64_t num_data_blocks[2];
+        for (int parallel = 0; parallel < 2; ++parallel) {
+          options.compression_opts.parallel_threads = parallel ? 4 : 1;
+          TableConstructor c(BytewiseComparator(),
+                             true /* convert_to_internal_key_ */);
+          for (const auto& kv : input) {
+            c.Add(kv.first, kv.second);
+          }
+          std::vector<std::string> keys;
+          stl_wrappers::KVMap kvmap;
+          const ImmutableCFOptions ioptions(options);
+          const MutableCFOptions moptions(options);
+          c.Finish(options, ioptions, moptions, table_options,
+                   GetPlainInternalComparator(options.comparator), &keys,
+                   &kvmap);
+          contents[parallel] = c.TEST_GetSink()->contents();
+          num_data_blocks[parallel] =
+              c.GetTableReader()->GetTableProperties()->num_data_blocks;
+
+          std::unique_ptr<InternalIterator> iter(c.NewIterator(nullptr));
+          auto expected = kvmap.begin();
+          for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+            ASSERT_TRUE(expected != kvmap.end());
+            ASSERT_EQ(expected->first, iter->key().ToString());
+            ASSERT_EQ(expected->second, iter->value().ToString());
+            ++expected;
+          }
+          ASSERT_OK(iter->status());
+          ASSERT_TRUE(expected == kvmap.end());
+          iter.reset();
+          c.ResetTableReader();
+        }
+        ASSERT_GT(num_data_blocks[0], 1);
+        ASSERT_EQ(num_data_blocks[0], num_data_blocks[1]);
+        ASSERT_TRUE(contents[0] == contents[1])
+            << "compression type " << compression_type << ", filter type "
+            << filter_type << ", use_dict " << use_dict;
+      }
+    }
+  }
+}
+
 TEST_P(BlockBasedTableTest, TracingGetTest) {
   TableConstructor c(BytewiseComparator());
   Options options;
@@ -5,14 +5,16 @@
 if [ $# -ne 1 ]; then
   echo -n "./benchmark.sh [bulkload/fillseq/overwrite/filluniquerandom/"
   echo    "readrandom/readwhilewriting/readwhilemerging/updaterandom/"
-  echo    "mergerandom/randomtransaction/compact]"
+  echo    "mergerandom/randomtransaction/compact/universal_compaction/"
+  echo    "level_compaction]"
   exit 0
 fi
 
 # Make it easier to run only the compaction test. Getting valid data requires
 # a number of iterations and having an ability to run the test separately from
 # rest of the benchmarks helps.
-if [ "$COMPACTION_TEST" == "1" -a "$1" != "universal_compaction" ]; then
+if [ "$COMPACTION_TEST" == "1" -a "$1" != "universal_compaction" -a \
+     "$1" != "level_compaction" ]; then
   echo "Skipping $1 because it's not a compaction test."
   exit 0
 fi
@@ -216,15 +218,17 @@ function run_manual_compaction_worker {
   # load after a crash. I think this is a good way to load.
   echo "Bulk loading $num_keys random keys for manual compaction."
 
-  fillrandom_output_file=$output_dir/benchmark_man_compact_fillrandom_$3.log
-  man_compact_output_log=$output_dir/benchmark_man_compact_$3.log
-
   if [ "$2" == "1" ]; then
     extra_params=$params_univ_compact
+    style_name=univ
   else
     extra_params=$params_level_compact
+    style_name=level
   fi
 
+  fillrandom_output_file=$output_dir/benchmark_man_compact_fillrandom_${style_name}_$3.log
+  man_compact_output_log=$output_dir/benchmark_man_compact_${style_name}_$3.log
+
   # Make sure that fillrandom uses the same compaction options as compact.
   cmd="./db_bench --benchmarks=fillrandom \
        --use_existing_db=0 \
@@ -245,7 +249,7 @@ function run_manual_compaction_worker {
   echo $cmd | tee $fillrandom_output_file
   eval $cmd
 
-  summarize_result $fillrandom_output_file man_compact_fillrandom_$3 fillrandom
+  summarize_result $fillrandom_output_file man_compact_fillrandom_${style_name}_$3 fillrandom
 
   echo "Compacting with $3 subcompactions specified ..."
 
@@ -273,12 +277,17 @@ function run_manual_compaction_worker {
   # "grep real" on the resulting log files.
 }
 
-function run_univ_compaction {
+#
+# Parameter description:
+#
+# $1 - compaction type to use (level=0, universal=1).
+#
+function run_compaction_with_subcompactions {
   # Always ask for I/O statistics to be measured.
   io_stats=1
 
   # Values: kCompactionStyleLevel = 0x0, kCompactionStyleUniversal = 0x1.
-  compaction_style=1
+  compaction_style=$1
 
   # Define a set of benchmarks.
   subcompactions=(1 2 4 8 16)
@@ -505,7 +514,9 @@ for job in ${jobs[@]}; do
   elif [ $job = randomtransaction ]; then
     run_randomtransaction
   elif [ $job = universal_compaction ]; then
-    run_univ_compaction
+    run_compaction_with_subcompactions 1
+  elif [ $job = level_compaction ]; then
+    run_compaction_with_subcompactions 0
   elif [ $job = debug ]; then
     num_keys=1000; # debug
     echo "Setting num_keys to $num_keys"
@@ -47,9 +47,11 @@
 #include "rocksdb/perf_context.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/rate_limiter.h"
+#include "rocksdb/secondary_cache.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/stats_history.h"
+#include "rocksdb/utilities/backupable_db.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "rocksdb/utilities/options_util.h"
@@ -194,6 +196,9 @@ DEFINE_string(
     "\tsstables    -- Print sstable info\n"
     "\theapprofile -- Dump a heap profile (if supported by this port)\n"
     "\treplay      -- replay the trace file specified with trace_file\n"
+    "\tbackup      -- back up the DB into backup_dir and report MB/s\n"
+    "\trestore     -- restore the latest backup in backup_dir into "
+    "restore_dir and report MB/s\n"
     "\tgetmergeoperands -- Insert lots of merge records which are a list of "
     "sorted ints for a key and then compare performance of lookup for another "
     "key "
@@ -308,6 +313,11 @@ DEFINE_int64(db_write_buffer_size, rocksdb::Options().db_write_buffer_size,
 DEFINE_bool(cost_write_buffer_to_cache, false,
             "The usage of memtable is costed to the block cache");
 
+DEFINE_int64(db_write_buffer_stop_limit, 0,
+             "If non-zero, writes are delayed once all memtables use "
+             "--db_write_buffer_size bytes, and stopped once they use this "
+             "many bytes, until flushes free memory");
+
 DEFINE_int64(write_buffer_size, rocksdb::Options().write_buffer_size,
              "Number of bytes to buffer in memtable before compacting");
 
@@ -380,8 +390,8 @@ DEFINE_int32(max_background_compactions,
 DEFINE_int32(base_background_compactions, -1, "DEPRECATED");
 
 DEFINE_uint64(subcompactions, 1,
-              "Maximum number of subcompactions to divide L0-L1 compactions "
-              "into.");
+              "Maximum number of subcompactions to divide L0-L1 and "
+              "universal compactions into.");
 static const bool FLAGS_subcompactions_dummy
     __attribute__((__unused__)) = RegisterFlagValidator(&FLAGS_subcompactions,
                                                     &ValidateUint32Range);
@@ -435,6 +445,13 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_bool(use_clock_cache, false,
             "Replace default LRU block cache with clock cache.");
 
+DEFINE_int64(secondary_cache_size, 0,
+             "If positive, blocks evicted from the LRU block cache are kept "
+             "compressed in a secondary cache of this many bytes.");
+
+DEFINE_string(secondary_cache_compression_type, "lz4",
+              "Algorithm used to compress the entries of the secondary cache");
+
 DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
@@ -503,6 +520,11 @@ DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(data_block_restart_key_prefixes,
+            rocksdb::BlockBasedTableOptions().data_block_restart_key_prefixes,
+            "Store restart key prefixes in data blocks to speed up seeks "
+            "within them. Only used with the bytewise comparator");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -518,11 +540,21 @@ DEFINE_int32(file_opening_threads, rocksdb::Options().max_file_opening_threads,
              "If open_files is set to -1, this option set the number of "
              "threads that will be used to open files during DB::Open()");
 
+DEFINE_bool(skip_opening_sst_files_on_db_open,
+            rocksdb::Options().skip_opening_sst_files_on_db_open,
+            "If true, sst files are opened on first access instead of during "
+            "DB::Open(), even if open_files is set to -1");
+
 DEFINE_bool(new_table_reader_for_compaction_inputs, true,
              "If true, uses a separate file handle for compaction inputs");
 
 DEFINE_int32(compaction_readahead_size, 0, "Compaction readahead size");
 
+DEFINE_bool(async_compaction_readahead,
+            rocksdb::Options().async_compaction_readahead,
+            "Read the next compaction readahead window asynchronously while "
+            "the current one is consumed");
+
 DEFINE_int32(random_access_max_buffer_size, 1024 * 1024,
              "Maximum windows randomaccess buffer size");
 
@@ -536,6 +568,9 @@ DEFINE_double(memtable_bloom_size_ratio, 0,
               "filter.");
 DEFINE_bool(memtable_whole_key_filtering, false,
             "Try to use whole key bloom filter in memtables.");
+DEFINE_double(memtable_hash_index_size_ratio, 0,
+              "Ratio of memtable size used for the buckets of the memtable "
+              "hash index. 0 means no hash index.");
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
 
@@ -719,6 +754,16 @@ DEFINE_int32(transaction_sleep, 0,
 DEFINE_uint64(transaction_lock_timeout, 100,
               "If using a transaction_db, specifies the lock wait timeout in"
               " milliseconds before failing a transaction waiting on a lock");
+
+DEFINE_int32(occ_validate_policy, 1,
+             "If using an optimistic_transaction_db, how transactions are "
+             "validated at commit: 0 = serially in the write group, 1 = in "
+             "parallel with per-key lookups, 2 = in parallel against a table "
+             "of the last write sequence number of each key hash bucket.");
+
+DEFINE_int32(occ_lock_buckets, (1 << 20),
+             "If using an optimistic_transaction_db with "
+             "occ_validate_policy 1 or 2, the number of key hash buckets.");
 DEFINE_string(
     options_file, "",
     "The path to a RocksDB options file.  If specified, then db_bench will "
@@ -786,6 +831,36 @@ DEFINE_uint64(blob_db_file_size,
               rocksdb::blob_db::BlobDBOptions().blob_file_size,
               "Target size of each blob file.");
 
+// Integrated BlobDB Options
+DEFINE_bool(enable_blob_files,
+            rocksdb::AdvancedColumnFamilyOptions().enable_blob_files,
+            "Write large values to blob files in flush and compaction.");
+
+DEFINE_uint64(min_blob_size,
+              rocksdb::AdvancedColumnFamilyOptions().min_blob_size,
+              "Smallest value to write to a blob file when "
+              "--enable_blob_files is set.");
+
+DEFINE_uint64(blob_file_size,
+              rocksdb::AdvancedColumnFamilyOptions().blob_file_size,
+              "Target size of each blob file when --enable_blob_files is set.");
+
+DEFINE_string(blob_compression_type, "none",
+              "Algorithm to use to compress the blobs written to blob files.");
+static enum rocksdb::CompressionType FLAGS_blob_compression_type_e =
+    rocksdb::kNoCompression;
+
+DEFINE_bool(enable_blob_garbage_collection,
+            rocksdb::AdvancedColumnFamilyOptions()
+                .enable_blob_garbage_collection,
+            "Relocate the blobs of the oldest blob files in compaction.");
+
+DEFINE_double(blob_garbage_collection_age_cutoff,
+              rocksdb::AdvancedColumnFamilyOptions()
+                  .blob_garbage_collection_age_cutoff,
+              "Fraction of the blob files, oldest first, subject to garbage "
+              "collection.");
+
 // Secondary DB instance Options
 DEFINE_bool(use_secondary_db, false,
             "Open a RocksDB secondary instance. A primary instance can be "
@@ -799,6 +874,11 @@ DEFINE_int32(secondary_update_interval, 5,
              "Secondary instance attempts to catch up with the primary every "
              "secondary_update_interval seconds.");
 
+DEFINE_bool(skip_listing_unchanged_wal_dir,
+            rocksdb::Options().skip_listing_unchanged_wal_dir,
+            "Secondary instance only lists the WAL directory to catch up "
+            "when its modification time has changed.");
+
 #endif  // ROCKSDB_LITE
 
 DEFINE_bool(report_bg_io_stats, false,
@@ -824,6 +904,23 @@ DEFINE_string(block_cache_trace_file, "", "Block cache trace file path.");
 DEFINE_int32(trace_replay_threads, 1,
              "The number of threads to replay, must >=1.");
 
+#ifndef ROCKSDB_LITE
+DEFINE_string(backup_dir, "",
+              "Directory the backup benchmark writes backups to and the "
+              "restore benchmark reads them from.");
+DEFINE_string(restore_dir, "",
+              "Directory the restore benchmark restores the DB into.");
+DEFINE_int32(backup_max_background_operations, 1,
+             "BackupableDBOptions::max_background_operations for the "
+             "backup and restore benchmarks.");
+DEFINE_uint64(backup_copy_chunk_size, 0,
+              "BackupableDBOptions::copy_chunk_size for the backup and "
+              "restore benchmarks.");
+DEFINE_bool(backup_reuse_checksums, false,
+            "BackupableDBOptions::reuse_backup_checksums for the backup "
+            "benchmark.");
+#endif  // ROCKSDB_LITE
+
 static enum rocksdb::CompressionType StringToCompressionType(const char* ctype) {
   assert(ctype);
 
@@ -863,6 +960,14 @@ DEFINE_string(compression_type, "snappy",
 static enum rocksdb::CompressionType FLAGS_compression_type_e =
     rocksdb::kSnappyCompression;
 
+DEFINE_string(wal_compression, "none",
+              "Algorithm to use to compress the WAL records (none, zlib or "
+              "zstd)");
+
+DEFINE_uint64(wal_recovery_threads, rocksdb::Options().wal_recovery_threads,
+              "Number of threads DB::Open() uses to replay the WAL files. Use "
+              "with --use_existing_db to measure recovery time.");
+
 DEFINE_int64(sample_for_compression, 0, "Sample every N block for compression");
 
 DEFINE_int32(compression_level, rocksdb::CompressionOptions().level,
@@ -880,6 +985,11 @@ DEFINE_int32(compression_zstd_max_train_bytes,
              "Maximum size of training data passed to zstd's dictionary "
              "trainer.");
 
+DEFINE_int32(compression_parallel_threads,
+             rocksdb::CompressionOptions().parallel_threads,
+             "Number of threads used to compress data blocks when building "
+             "SST files. Values greater than 1 enable parallel compression.");
+
 DEFINE_int32(min_level_to_compress, -1, "If non-negative, compression starts"
              " from this level. Levels with number < min_level_to_compress are"
              " not compressed. Otherwise, apply compression_type to "
@@ -962,6 +1072,11 @@ DEFINE_bool(unordered_write, false,
 DEFINE_bool(allow_concurrent_memtable_write, true,
             "Allow multi-writers to update mem tables in parallel.");
 
+DEFINE_uint64(max_memtable_insert_threads_per_batch,
+              rocksdb::Options().max_memtable_insert_threads_per_batch,
+              "Split the memtable inserts of a large write batch across up to "
+              "this many threads. Use with --batch_size.");
+
 DEFINE_bool(inplace_update_support, rocksdb::Options().inplace_update_support,
             "Support in-place memtable update for smaller or same-size values");
 
@@ -1125,6 +1240,10 @@ static auto FLAGS_compaction_fadvice_e =
 DEFINE_bool(use_tailing_iterator, false,
             "Use tailing iterator to access a series of keys instead of get");
 
+DEFINE_int32(scan_shards, 0,
+             "If positive, readseq splits the DB into this many shards with "
+             "DB::NewShardedIterators() and scans them on as many threads.");
+
 DEFINE_bool(use_adaptive_mutex, rocksdb::Options().use_adaptive_mutex,
             "Use adaptive mutex");
 
@@ -1212,12 +1331,17 @@ DEFINE_uint64(stats_history_buffer_size,
 DEFINE_int64(multiread_stride, 0,
              "Stride length for the keys in a MultiGet batch");
 DEFINE_bool(multiread_batched, false, "Use the new MultiGet API");
+DEFINE_bool(async_io, false,
+            "Batch the reads of the batched MultiGet API across the files "
+            "of a level, and double buffer the readahead of seekrandom "
+            "iterators, using asynchronous IO where supported");
 
 enum RepFactory {
   kSkipList,
   kPrefixHash,
   kVectorRep,
   kHashLinkedList,
+  kBTree,
 };
 
 static enum RepFactory StringToRepFactory(const char* ctype) {
@@ -1231,6 +1355,8 @@ static enum RepFactory StringToRepFactory(const char* ctype) {
     return kVectorRep;
   else if (!strcasecmp(ctype, "hash_linkedlist"))
     return kHashLinkedList;
+  else if (!strcasecmp(ctype, "btree"))
+    return kBTree;
 
   fprintf(stdout, "Cannot parse memreptable %s\n", ctype);
   return kSkipList;
@@ -1249,6 +1375,10 @@ DEFINE_bool(use_hash_search, false, "if use kHashSearch "
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(use_ribbon_filter, false,
+            "Use a Ribbon filter instead of a Bloom filter, with the FP rate "
+            "of a Bloom filter with --bloom_bits bits per key. Ignores "
+            "--use_block_based_filter.");
 DEFINE_string(merge_operator, "", "The merge operator to use with the database."
               "If a new merge operator is specified, be sure to use fresh"
               " database The possible merge operators are defined in"
@@ -1259,6 +1389,9 @@ DEFINE_int32(skip_list_lookahead, 0, "Used with skip_list memtablerep; try "
 DEFINE_bool(report_file_operations, false, "if report number of file "
             "operations");
 DEFINE_int32(readahead_size, 0, "Iterator readahead size");
+DEFINE_bool(adaptive_readahead, false,
+            "Start the auto-readahead of iterators at the size reached by "
+            "the previous iterator over the same file");
 
 static const bool FLAGS_soft_rate_limit_dummy __attribute__((__unused__)) =
     RegisterFlagValidator(&FLAGS_soft_rate_limit, &ValidateRateLimit);
@@ -2312,6 +2445,9 @@ class Benchmark {
       case kHashLinkedList:
         fprintf(stdout, "Memtablerep: hash_linkedlist\n");
         break;
+      case kBTree:
+        fprintf(stdout, "Memtablerep: btree\n");
+        break;
     }
     fprintf(stdout, "Perf Level: %d\n", FLAGS_perf_level);
 
@@ -2449,33 +2585,50 @@ class Benchmark {
     const char* Name() const override { return "KeepFilter"; }
   };
 
-  std::shared_ptr<Cache> NewCache(int64_t capacity) {
+  static const FilterPolicy* NewFilterPolicy() {
+    if (FLAGS_use_ribbon_filter) {
+      return NewRibbonFilterPolicy(FLAGS_bloom_bits);
+    }
+    return NewBloomFilterPolicy(FLAGS_bloom_bits,
+                                FLAGS_use_block_based_filter);
+  }
+
+  std::shared_ptr<Cache> NewCache(int64_t capacity,
+                                  int64_t secondary_capacity = 0) {
     if (capacity <= 0) {
       return nullptr;
     }
     if (FLAGS_use_clock_cache) {
-      auto cache = NewClockCache(static_cast<size_t>(capacity),
-                                 FLAGS_cache_numshardbits);
+      auto cache = NewClockCache(
+          static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
+          false /*strict_capacity_limit*/, kDefaultCacheMetadataChargePolicy,
+          static_cast<size_t>(FLAGS_block_size) /*estimated_entry_charge*/);
       if (!cache) {
         fprintf(stderr, "Clock cache not supported.");
         exit(1);
       }
       return cache;
     } else {
-      return NewLRUCache(
+      LRUCacheOptions opts(
           static_cast<size_t>(capacity), FLAGS_cache_numshardbits,
           false /*strict_capacity_limit*/, FLAGS_cache_high_pri_pool_ratio);
+      if (secondary_capacity > 0) {
+        opts.secondary_cache =
+            NewCompressedSecondaryCache(CompressedSecondaryCacheOptions(
+                static_cast<size_t>(secondary_capacity),
+                FLAGS_cache_numshardbits,
+                StringToCompressionType(
+                    FLAGS_secondary_cache_compression_type.c_str())));
+      }
+      return NewLRUCache(opts);
     }
   }
 
  public:
   Benchmark()
-      : cache_(NewCache(FLAGS_cache_size)),
+      : cache_(NewCache(FLAGS_cache_size, FLAGS_secondary_cache_size)),
         compressed_cache_(NewCache(FLAGS_compressed_cache_size)),
-        filter_policy_(FLAGS_bloom_bits >= 0
-                           ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
-                           : nullptr),
+        filter_policy_(FLAGS_bloom_bits >= 0 ? NewFilterPolicy() : nullptr),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
         value_size_(FLAGS_value_size),
@@ -2946,6 +3099,27 @@ class Benchmark {
           exit(1);
         }
         method = &Benchmark::Replay;
+#ifndef ROCKSDB_LITE
+      } else if (name == "backup" || name == "restore") {
+        if (num_threads > 1) {
+          fprintf(stderr, "Multi-threaded %s is not supported\n",
+                  name.c_str());
+          exit(1);
+        }
+        if (FLAGS_backup_dir.empty()) {
+          fprintf(stderr, "Please set --backup_dir\n");
+          exit(1);
+        }
+        if (name == "backup") {
+          method = &Benchmark::Backup;
+        } else {
+          if (FLAGS_restore_dir.empty()) {
+            fprintf(stderr, "Please set --restore_dir\n");
+            exit(1);
+          }
+          method = &Benchmark::Restore;
+        }
+#endif  // ROCKSDB_LITE
       } else if (name == "getmergeoperands") {
         method = &Benchmark::GetMergeOperands;
       } else if (!name.empty()) {  // No error message for empty name
@@ -3437,7 +3611,8 @@ class Benchmark {
     options.max_open_files = FLAGS_open_files;
     if (FLAGS_cost_write_buffer_to_cache || FLAGS_db_write_buffer_size != 0) {
       options.write_buffer_manager.reset(
-          new WriteBufferManager(FLAGS_db_write_buffer_size, cache_));
+          new WriteBufferManager(FLAGS_db_write_buffer_size, cache_,
+                                 FLAGS_db_write_buffer_stop_limit));
     }
     options.write_buffer_size = FLAGS_write_buffer_size;
     options.max_write_buffer_number = FLAGS_max_write_buffer_number;
@@ -3481,6 +3656,8 @@ class Benchmark {
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
     options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
+    options.memtable_hash_index_size_ratio =
+        FLAGS_memtable_hash_index_size_ratio;
     if (FLAGS_memtable_insert_with_hint_prefix_size > 0) {
       options.memtable_insert_with_hint_prefix_extractor.reset(
           NewCappedPrefixTransform(
@@ -3488,9 +3665,12 @@ class Benchmark {
     }
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
+    options.skip_opening_sst_files_on_db_open =
+        FLAGS_skip_opening_sst_files_on_db_open;
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
+    options.async_compaction_readahead = FLAGS_async_compaction_readahead;
     options.random_access_max_buffer_size = FLAGS_random_access_max_buffer_size;
     options.writable_file_max_buffer_size = FLAGS_writable_file_max_buffer_size;
     options.use_fsync = FLAGS_use_fsync;
@@ -3513,6 +3693,9 @@ class Benchmark {
         options.memtable_factory.reset(new SkipListFactory(
             FLAGS_skip_list_lookahead));
         break;
+      case kBTree:
+        options.memtable_factory.reset(new BTreeRepFactory());
+        break;
 #ifndef ROCKSDB_LITE
       case kPrefixHash:
         options.memtable_factory.reset(
@@ -3529,7 +3712,7 @@ class Benchmark {
         break;
 #else
       default:
-        fprintf(stderr, "Only skip list is supported in lite mode\n");
+        fprintf(stderr, "Only skip list and btree are supported in lite mode\n");
         exit(1);
 #endif  // ROCKSDB_LITE
     }
@@ -3636,6 +3819,8 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
+      block_based_options.data_block_restart_key_prefixes =
+          FLAGS_data_block_restart_key_prefixes;
       if (FLAGS_read_cache_path != "") {
 #ifndef ROCKSDB_LITE
         Status rc_status;
@@ -3696,6 +3881,14 @@ class Benchmark {
       FLAGS_level0_slowdown_writes_trigger;
     options.compression = FLAGS_compression_type_e;
     options.sample_for_compression = FLAGS_sample_for_compression;
+    options.enable_blob_files = FLAGS_enable_blob_files;
+    options.min_blob_size = FLAGS_min_blob_size;
+    options.blob_file_size = FLAGS_blob_file_size;
+    options.blob_compression_type = FLAGS_blob_compression_type_e;
+    options.enable_blob_garbage_collection =
+        FLAGS_enable_blob_garbage_collection;
+    options.blob_garbage_collection_age_cutoff =
+        FLAGS_blob_garbage_collection_age_cutoff;
     options.WAL_ttl_seconds = FLAGS_wal_ttl_seconds;
     options.WAL_size_limit_MB = FLAGS_wal_size_limit_MB;
     options.max_total_wal_size = FLAGS_max_total_wal_size;
@@ -3720,6 +3913,8 @@ class Benchmark {
     options.delayed_write_rate = FLAGS_delayed_write_rate;
     options.allow_concurrent_memtable_write =
         FLAGS_allow_concurrent_memtable_write;
+    options.max_memtable_insert_threads_per_batch =
+        static_cast<size_t>(FLAGS_max_memtable_insert_threads_per_batch);
     options.inplace_update_support = FLAGS_inplace_update_support;
     options.inplace_update_num_locks = FLAGS_inplace_update_num_locks;
     options.enable_write_thread_adaptive_yield =
@@ -3741,6 +3936,10 @@ class Benchmark {
     options.use_adaptive_mutex = FLAGS_use_adaptive_mutex;
     options.bytes_per_sync = FLAGS_bytes_per_sync;
     options.wal_bytes_per_sync = FLAGS_wal_bytes_per_sync;
+    options.wal_compression =
+        StringToCompressionType(FLAGS_wal_compression.c_str());
+    options.wal_recovery_threads =
+        static_cast<size_t>(FLAGS_wal_recovery_threads);
 
     // merge operator options
     options.merge_operator = MergeOperators::CreateFromStringId(
@@ -3790,6 +3989,8 @@ class Benchmark {
       fprintf(stderr, "Cannot use use_secondary_db flag with transaction_db\n");
       exit(1);
     }
+    options.skip_listing_unchanged_wal_dir =
+        FLAGS_skip_listing_unchanged_wal_dir;
 #endif  // ROCKSDB_LITE
 
   }
@@ -3814,6 +4015,8 @@ class Benchmark {
     options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
     options.compression_opts.zstd_max_train_bytes =
         FLAGS_compression_zstd_max_train_bytes;
+    options.compression_opts.parallel_threads =
+        static_cast<uint32_t>(FLAGS_compression_parallel_threads);
     // If this is a block based table, set some related options
     if (options.table_factory->Name() == BlockBasedTableFactory::kName &&
         options.table_factory->GetOptions() != nullptr) {
@@ -3824,8 +4027,7 @@ class Benchmark {
         table_options->block_cache = cache_;
       }
       if (FLAGS_bloom_bits >= 0) {
-        table_options->filter_policy.reset(NewBloomFilterPolicy(
-            FLAGS_bloom_bits, FLAGS_use_block_based_filter));
+        table_options->filter_policy.reset(NewFilterPolicy());
       }
     }
     if (FLAGS_row_cache_size) {
@@ -3909,6 +4111,22 @@ class Benchmark {
     InitializeOptionsGeneral(opts);
   }
 
+#ifndef ROCKSDB_LITE
+  OptimisticTransactionDBOptions GetOccOptions() {
+    if (FLAGS_occ_validate_policy < 0 || FLAGS_occ_validate_policy > 2) {
+      fprintf(stderr, "Invalid occ_validate_policy %d\n",
+              FLAGS_occ_validate_policy);
+      exit(1);
+    }
+    OptimisticTransactionDBOptions occ_options;
+    occ_options.validate_policy =
+        static_cast<OccValidationPolicy>(FLAGS_occ_validate_policy);
+    occ_options.occ_lock_buckets =
+        static_cast<uint32_t>(FLAGS_occ_lock_buckets);
+    return occ_options;
+  }
+#endif  // ROCKSDB_LITE
+
   void OpenDb(Options options, const std::string& db_name,
       DBWithColumnFamilies* db) {
     Status s;
@@ -3953,8 +4171,9 @@ class Benchmark {
         s = DB::OpenForReadOnly(options, db_name, column_families,
             &db->cfh, &db->db);
       } else if (FLAGS_optimistic_transaction_db) {
-        s = OptimisticTransactionDB::Open(options, db_name, column_families,
-                                          &db->cfh, &db->opt_txn_db);
+        s = OptimisticTransactionDB::Open(options, GetOccOptions(), db_name,
+                                          column_families, &db->cfh,
+                                          &db->opt_txn_db);
         if (s.ok()) {
           db->db = db->opt_txn_db->GetBaseDB();
         }
@@ -3985,8 +4204,16 @@ class Benchmark {
     } else if (FLAGS_readonly) {
       s = DB::OpenForReadOnly(options, db_name, &db->db);
     } else if (FLAGS_optimistic_transaction_db) {
-      s = OptimisticTransactionDB::Open(options, db_name, &db->opt_txn_db);
+      std::vector<ColumnFamilyDescriptor> column_families;
+      column_families.push_back(ColumnFamilyDescriptor(
+          kDefaultColumnFamilyName, ColumnFamilyOptions(options)));
+      std::vector<ColumnFamilyHandle*> handles;
+      s = OptimisticTransactionDB::Open(options, GetOccOptions(), db_name,
+                                        column_families, &handles,
+                                        &db->opt_txn_db);
       if (s.ok()) {
+        // DBImpl holds a reference to the default column family
+        delete handles[0];
         db->db = db->opt_txn_db->GetBaseDB();
       }
     } else if (FLAGS_transaction_db) {
@@ -4656,6 +4883,10 @@ class Benchmark {
   void ReadSequential(ThreadState* thread, DB* db) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
+    if (FLAGS_scan_shards > 0) {
+      ReadSequentialSharded(thread, db, options);
+      return;
+    }
 
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
@@ -4681,6 +4912,46 @@ class Benchmark {
     }
   }
 
+  void ReadSequentialSharded(ThreadState* thread, DB* db,
+                             const ReadOptions& options) {
+    std::vector<Iterator*> iters;
+    Status s = db->NewShardedIterators(options, db->DefaultColumnFamily(),
+                                       static_cast<size_t>(FLAGS_scan_shards),
+                                       &iters);
+    if (!s.ok()) {
+      fprintf(stderr, "NewShardedIterators() failed: %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+
+    std::vector<int64_t> reads(iters.size(), 0);
+    std::vector<int64_t> bytes(iters.size(), 0);
+    std::vector<port::Thread> scanners;
+    for (size_t i = 0; i < iters.size(); i++) {
+      scanners.emplace_back([&, i]() {
+        Iterator* iter = iters[i];
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+          bytes[i] += iter->key().size() + iter->value().size();
+          ++reads[i];
+        }
+      });
+    }
+    int64_t total_reads = 0;
+    int64_t total_bytes = 0;
+    for (size_t i = 0; i < iters.size(); i++) {
+      scanners[i].join();
+      delete iters[i];
+      total_reads += reads[i];
+      total_bytes += bytes[i];
+    }
+
+    thread->stats.FinishedOps(nullptr, db, total_reads, kRead);
+    thread->stats.AddBytes(total_bytes);
+    char msg[100];
+    snprintf(msg, sizeof(msg), "(%" ROCKSDB_PRIszt " shards)", iters.size());
+    thread->stats.AddMessage(msg);
+  }
+
   void ReadToRowCache(ThreadState* thread) {
     int64_t read = 0;
     int64_t found = 0;
@@ -4924,6 +5195,7 @@ class Benchmark {
     int64_t num_multireads = 0;
     int64_t found = 0;
     ReadOptions options(FLAGS_verify_checksum, true);
+    options.async_io = FLAGS_async_io;
     std::vector<Slice> keys;
     std::vector<std::unique_ptr<const char[]> > key_guards;
     std::vector<std::string> values(entries_per_batch_);
@@ -5447,6 +5719,8 @@ class Benchmark {
     options.prefix_same_as_start = FLAGS_prefix_same_as_start;
     options.tailing = FLAGS_use_tailing_iterator;
     options.readahead_size = FLAGS_readahead_size;
+    options.adaptive_readahead = FLAGS_adaptive_readahead;
+    options.async_io = FLAGS_async_io;
 
     Iterator* single_iter = nullptr;
     std::vector<Iterator*> multi_iters;
@@ -6650,6 +6924,65 @@ class Benchmark {
     db->CompactRange(cro, nullptr, nullptr);
   }
 
+#ifndef ROCKSDB_LITE
+  BackupableDBOptions BenchmarkBackupOptions() {
+    BackupableDBOptions backup_options(FLAGS_backup_dir);
+    backup_options.max_background_operations =
+        FLAGS_backup_max_background_operations;
+    backup_options.copy_chunk_size = FLAGS_backup_copy_chunk_size;
+    backup_options.reuse_backup_checksums = FLAGS_backup_reuse_checksums;
+    return backup_options;
+  }
+
+  // Backs up the DB. The bytes reported are the size of the new backup, so
+  // files shared with earlier backups count even though they are not
+  // copied again.
+  void Backup(ThreadState* thread) {
+    DB* db = SelectDB(thread);
+    BackupEngine* backup_engine_ptr = nullptr;
+    Status s = BackupEngine::Open(FLAGS_env, BenchmarkBackupOptions(),
+                                  &backup_engine_ptr);
+    std::unique_ptr<BackupEngine> backup_engine(backup_engine_ptr);
+    if (s.ok()) {
+      s = backup_engine->CreateNewBackup(db);
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "backup error: %s\n", s.ToString().c_str());
+      exit(1);
+    }
+    std::vector<BackupInfo> backup_infos;
+    backup_engine->GetBackupInfo(&backup_infos);
+    assert(!backup_infos.empty());
+    thread->stats.FinishedOps(nullptr, db, 1, kOthers);
+    thread->stats.AddBytes(static_cast<int64_t>(backup_infos.back().size));
+  }
+
+  // Restores the latest backup in --backup_dir into --restore_dir.
+  void Restore(ThreadState* thread) {
+    BackupEngineReadOnly* backup_engine_ptr = nullptr;
+    Status s = BackupEngineReadOnly::Open(FLAGS_env, BenchmarkBackupOptions(),
+                                          &backup_engine_ptr);
+    std::unique_ptr<BackupEngineReadOnly> backup_engine(backup_engine_ptr);
+    std::vector<BackupInfo> backup_infos;
+    if (s.ok()) {
+      backup_engine->GetBackupInfo(&backup_infos);
+      if (backup_infos.empty()) {
+        s = Status::NotFound("No backup in " + FLAGS_backup_dir);
+      }
+    }
+    if (s.ok()) {
+      s = backup_engine->RestoreDBFromLatestBackup(FLAGS_restore_dir,
+                                                   FLAGS_restore_dir);
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "restore error: %s\n", s.ToString().c_str());
+      exit(1);
+    }
+    thread->stats.FinishedOps(nullptr, nullptr, 1, kOthers);
+    thread->stats.AddBytes(static_cast<int64_t>(backup_infos.back().size));
+  }
+#endif  // ROCKSDB_LITE
+
   void CompactAll() {
     if (db_.db != nullptr) {
       db_.db->CompactRange(CompactRangeOptions(), nullptr, nullptr);
@@ -6804,6 +7137,8 @@ int db_bench_tool(int argc, char** argv) {
 
   FLAGS_compression_type_e =
     StringToCompressionType(FLAGS_compression_type.c_str());
+  FLAGS_blob_compression_type_e =
+      StringToCompressionType(FLAGS_blob_compression_type.c_str());
 
 #ifndef ROCKSDB_LITE
   if (!FLAGS_hdfs.empty() && !FLAGS_env_uri.empty()) {
@@ -265,10 +265,11 @@ for num_thr in "${nthreads[@]}" ; do
   fi
 done
 
-###### Universal compaction tests.
+###### Universal and level compaction tests.
 
 # Use a single thread to reduce the variability in the benchmark.
 env $ARGS COMPACTION_TEST=1 NUM_THREADS=1 ./tools/benchmark.sh universal_compaction
+env $ARGS COMPACTION_TEST=1 NUM_THREADS=1 ./tools/benchmark.sh level_compaction
 
 if [[ $skip_low_pri_tests != 1 ]]; then
   echo bulkload > $output_dir/report2.txt
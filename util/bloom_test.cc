@@ -379,6 +379,7 @@ class FullBloomTest : public testing::TestWithParam<BloomFilterPolicy::Mode> {
       case BloomFilterPolicy::kFastLocalBloom:
         return for_fast_local_bloom;
       case BloomFilterPolicy::kDeprecatedBlock:
+      case BloomFilterPolicy::kStandardRibbon:
       case BloomFilterPolicy::kAuto:
           /* N/A */;
     }
@@ -523,6 +524,10 @@ inline uint32_t SelectByCacheLineSize(uint32_t for64, uint32_t for128,
 // ability to read filters generated using other cache line sizes.
 // See RawSchema.
 TEST_P(FullBloomTest, Schema) {
+  if (GetParam() == BloomFilterPolicy::kStandardRibbon) {
+    // See RibbonSchema
+    return;
+  }
   char buffer[sizeof(int)];
 
   // Use enough keys so that changing bits / key by 1 is guaranteed to
@@ -729,6 +734,103 @@ TEST_P(FullBloomTest, Schema) {
   ResetPolicy();
 }
 
+// Like Schema, for the Standard Ribbon filter.
+TEST_P(FullBloomTest, RibbonSchema) {
+  if (GetParam() != BloomFilterPolicy::kStandardRibbon) {
+    return;
+  }
+  char buffer[sizeof(int)];
+
+  ResetPolicy(10);  // num_result_bits = 7
+  for (int key = 0; key < 2087; key++) {
+    Add(Key(key, buffer));
+  }
+  Build();
+  // Marker, seed and num_result_bits
+  EXPECT_EQ(static_cast<int8_t>(FilterData()[FilterSize() - 5]), -2);
+  EXPECT_EQ(static_cast<uint8_t>(FilterData()[FilterSize() - 4]), 0);
+  EXPECT_EQ(static_cast<uint8_t>(FilterData()[FilterSize() - 3]), 7);
+  // 2087 keys -> 2304 slots -> 36 blocks of 7 words
+  EXPECT_EQ(FilterSize(), 36 * 7 * 8 + 5);
+  EXPECT_EQ(BloomHash(FilterData()), 1693515989U);
+  EXPECT_EQ("105,108,130,260,427,616,1034,1115,1291,1480", FirstFPs(10));
+
+  // Corrupt metadata -> always match, for safety
+  std::string corrupt = FilterData().ToString();
+  corrupt[corrupt.size() - 3] = 0;  // num_result_bits = 0
+  OpenRaw(corrupt);
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  corrupt[corrupt.size() - 3] = 33;  // num_result_bits too large
+  OpenRaw(corrupt);
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  corrupt[corrupt.size() - 3] = 5;  // not a whole number of blocks
+  OpenRaw(corrupt);
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  corrupt[corrupt.size() - 3] = 7;
+  corrupt[corrupt.size() - 1] = 1;  // reserved
+  OpenRaw(corrupt);
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+
+  ResetPolicy(16);  // num_result_bits = 10
+  for (int key = 0; key < 2087; key++) {
+    Add(Key(key, buffer));
+  }
+  Build();
+  EXPECT_EQ(static_cast<uint8_t>(FilterData()[FilterSize() - 3]), 10);
+  EXPECT_EQ(FilterSize(), 36 * 10 * 8 + 5);
+  EXPECT_EQ(BloomHash(FilterData()), 3615524786U);
+  EXPECT_EQ("260,427,616,2427,3342,3701,7540,9159,9183,9639", FirstFPs(10));
+
+  ResetPolicy();
+}
+
+TEST_P(FullBloomTest, RibbonSpaceVsBloom) {
+  if (GetParam() != BloomFilterPolicy::kStandardRibbon) {
+    return;
+  }
+  char buffer[sizeof(int)];
+  const int kNumKeys = 100000;
+
+  for (double bpk : {6.0, 10.0, 16.0}) {
+    ResetPolicy(bpk);
+    for (int key = 0; key < kNumKeys; key++) {
+      Add(Key(key, buffer));
+    }
+    Build();
+    for (int key = 0; key < kNumKeys; key++) {
+      ASSERT_TRUE(Matches(Key(key, buffer)));
+    }
+    size_t ribbon_size = FilterSize();
+    double ribbon_fp_rate = FalsePositiveRate();
+
+    BloomFilterPolicy bloom_policy(bpk, BloomFilterPolicy::kFastLocalBloom);
+    BlockBasedTableOptions bloom_table_options;
+    std::unique_ptr<BuiltinFilterBitsBuilder> bloom_builder(
+        static_cast<BuiltinFilterBitsBuilder*>(
+            bloom_policy.GetBuilderWithContext(
+                FilterBuildingContext(bloom_table_options))));
+    size_t bloom_size = bloom_builder->CalculateSpace(kNumKeys);
+    double bloom_fp_rate =
+        bloom_builder->EstimatedFpRate(kNumKeys, bloom_size);
+
+    if (kVerbose >= 1) {
+      fprintf(stderr,
+              "%4.1f bits/key: Ribbon %6d bytes, FP %6.3f%%; "
+              "Bloom %6d bytes, FP %6.3f%%\n",
+              bpk, static_cast<int>(ribbon_size), ribbon_fp_rate * 100.0,
+              static_cast<int>(bloom_size), bloom_fp_rate * 100.0);
+    }
+    // At least 20% smaller, for a comparable FP rate
+    EXPECT_LE(ribbon_size, bloom_size * 8 / 10);
+    EXPECT_LE(ribbon_fp_rate, bloom_fp_rate * 1.5);
+  }
+  ResetPolicy();
+}
+
 // A helper class for testing custom or corrupt filter bits as read by
 // built-in FilterBitsReaders.
 struct RawFilterTester {
@@ -898,7 +1000,8 @@ TEST_P(FullBloomTest, CorruptFilters) {
 
 INSTANTIATE_TEST_CASE_P(Full, FullBloomTest,
                         testing::Values(BloomFilterPolicy::kLegacyBloom,
-                                        BloomFilterPolicy::kFastLocalBloom));
+                                        BloomFilterPolicy::kFastLocalBloom,
+                                        BloomFilterPolicy::kStandardRibbon));
 
 }  // namespace rocksdb
 
@@ -0,0 +1,263 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/compression.h"
+
+#include <string.h>
+
+namespace rocksdb {
+
+namespace {
+
+// Size of the chunks the streaming contexts write their output into.
+const size_t kStreamingOutputChunkSize = 16 << 10;
+
+#ifdef ZLIB
+// Raw deflate stream, flushed with Z_SYNC_FLUSH after each record.
+class ZlibStreamingCompress : public StreamingCompress {
+ public:
+  ZlibStreamingCompress() : ok_(false) {
+    memset(&stream_, 0, sizeof(stream_));
+    // Negative window bits for a raw stream: the records carry their own
+    // checksums.
+    ok_ = deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                       -15 /* window_bits */, 8 /* mem_level */,
+                       Z_DEFAULT_STRATEGY) == Z_OK;
+  }
+
+  ~ZlibStreamingCompress() override {
+    if (ok_) {
+      deflateEnd(&stream_);
+    }
+  }
+
+  bool Compress(const Slice& input, std::string* output) override {
+    if (!ok_) {
+      return false;
+    }
+    if (input.empty()) {
+      // Nothing to flush: a second Z_SYNC_FLUSH in a row makes no progress.
+      return true;
+    }
+    stream_.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream_.avail_in = static_cast<uInt>(input.size());
+    do {
+      size_t old_size = output->size();
+      output->resize(old_size + kStreamingOutputChunkSize);
+      stream_.next_out = reinterpret_cast<Bytef*>(&(*output)[old_size]);
+      stream_.avail_out = static_cast<uInt>(kStreamingOutputChunkSize);
+      int st = deflate(&stream_, Z_SYNC_FLUSH);
+      output->resize(old_size + kStreamingOutputChunkSize - stream_.avail_out);
+      if (st != Z_OK && st != Z_BUF_ERROR) {
+        ok_ = false;
+        return false;
+      }
+    } while (stream_.avail_out == 0);
+    assert(stream_.avail_in == 0);
+    return true;
+  }
+
+ private:
+  z_stream stream_;
+  bool ok_;
+};
+
+class ZlibStreamingUncompress : public StreamingUncompress {
+ public:
+  ZlibStreamingUncompress() : ok_(false) {
+    memset(&stream_, 0, sizeof(stream_));
+    ok_ = inflateInit2(&stream_, -15 /* window_bits */) == Z_OK;
+  }
+
+  ~ZlibStreamingUncompress() override {
+    if (ok_) {
+      inflateEnd(&stream_);
+    }
+  }
+
+  bool Uncompress(const Slice& input, std::string* output) override {
+    if (!ok_) {
+      return false;
+    }
+    if (input.empty()) {
+      return true;
+    }
+    stream_.next_in =
+        reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream_.avail_in = static_cast<uInt>(input.size());
+    do {
+      size_t old_size = output->size();
+      output->resize(old_size + kStreamingOutputChunkSize);
+      stream_.next_out = reinterpret_cast<Bytef*>(&(*output)[old_size]);
+      stream_.avail_out = static_cast<uInt>(kStreamingOutputChunkSize);
+      int st = inflate(&stream_, Z_SYNC_FLUSH);
+      output->resize(old_size + kStreamingOutputChunkSize - stream_.avail_out);
+      if (st == Z_BUF_ERROR && stream_.avail_in > 0 &&
+          stream_.avail_out > 0) {
+        // No progress possible with input left.
+        st = Z_DATA_ERROR;
+      }
+      if (st != Z_OK && st != Z_BUF_ERROR) {
+        // The writer never ends the stream, so Z_STREAM_END is an error too.
+        ok_ = false;
+        return false;
+      }
+    } while (stream_.avail_in > 0 || stream_.avail_out == 0);
+    return true;
+  }
+
+ private:
+  z_stream stream_;
+  bool ok_;
+};
+#endif  // ZLIB
+
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 800
+// ZSTD stream, flushed with ZSTD_flushStream() after each record.
+class ZSTDStreamingCompress : public StreamingCompress {
+ public:
+  ZSTDStreamingCompress() : stream_(ZSTD_createCStream()), ok_(false) {
+    if (stream_ != nullptr) {
+      // 3 is the value of ZSTD_CLEVEL_DEFAULT (not exposed publicly).
+      ok_ = !ZSTD_isError(ZSTD_initCStream(stream_, 3 /* level */));
+    }
+  }
+
+  ~ZSTDStreamingCompress() override {
+    if (stream_ != nullptr) {
+      ZSTD_freeCStream(stream_);
+    }
+  }
+
+  bool Compress(const Slice& input, std::string* output) override {
+    if (!ok_) {
+      return false;
+    }
+    ZSTD_inBuffer in = {input.data(), input.size(), 0};
+    size_t remaining;
+    do {
+      size_t old_size = output->size();
+      output->resize(old_size + kStreamingOutputChunkSize);
+      ZSTD_outBuffer out = {&(*output)[old_size], kStreamingOutputChunkSize,
+                            0};
+      if (in.pos < in.size) {
+        remaining = ZSTD_compressStream(stream_, &out, &in);
+        // Keep going until all of input is consumed.
+        if (!ZSTD_isError(remaining)) {
+          remaining = 1;
+        }
+      } else {
+        remaining = ZSTD_flushStream(stream_, &out);
+      }
+      output->resize(old_size + out.pos);
+      if (ZSTD_isError(remaining)) {
+        ok_ = false;
+        return false;
+      }
+    } while (remaining > 0);
+    return true;
+  }
+
+ private:
+  ZSTD_CStream* stream_;
+  bool ok_;
+};
+
+class ZSTDStreamingUncompress : public StreamingUncompress {
+ public:
+  ZSTDStreamingUncompress() : stream_(ZSTD_createDStream()), ok_(false) {
+    if (stream_ != nullptr) {
+      ok_ = !ZSTD_isError(ZSTD_initDStream(stream_));
+    }
+  }
+
+  ~ZSTDStreamingUncompress() override {
+    if (stream_ != nullptr) {
+      ZSTD_freeDStream(stream_);
+    }
+  }
+
+  bool Uncompress(const Slice& input, std::string* output) override {
+    if (!ok_) {
+      return false;
+    }
+    ZSTD_inBuffer in = {input.data(), input.size(), 0};
+    bool output_full;
+    do {
+      size_t old_size = output->size();
+      output->resize(old_size + kStreamingOutputChunkSize);
+      ZSTD_outBuffer out = {&(*output)[old_size], kStreamingOutputChunkSize,
+                            0};
+      size_t ret = ZSTD_decompressStream(stream_, &out, &in);
+      output->resize(old_size + out.pos);
+      if (ZSTD_isError(ret)) {
+        ok_ = false;
+        return false;
+      }
+      // A full output buffer may leave flushed data inside the context.
+      output_full = out.pos == out.size;
+    } while (in.pos < in.size || output_full);
+    return true;
+  }
+
+ private:
+  ZSTD_DStream* stream_;
+  bool ok_;
+};
+#endif  // defined(ZSTD) && ZSTD_VERSION_NUMBER >= 800
+
+}  // namespace
+
+bool StreamingCompressionTypeSupported(CompressionType compression_type) {
+  switch (compression_type) {
+    case kZlibCompression:
+      return Zlib_Supported();
+    case kZSTD:
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 800
+      return ZSTD_Supported();
+#else
+      return false;
+#endif
+    default:
+      return false;
+  }
+}
+
+std::unique_ptr<StreamingCompress> NewStreamingCompress(
+    CompressionType compression_type) {
+  switch (compression_type) {
+#ifdef ZLIB
+    case kZlibCompression:
+      return std::unique_ptr<StreamingCompress>(new ZlibStreamingCompress());
+#endif  // ZLIB
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 800
+    case kZSTD:
+      return std::unique_ptr<StreamingCompress>(new ZSTDStreamingCompress());
+#endif  // defined(ZSTD) && ZSTD_VERSION_NUMBER >= 800
+    default:
+      return nullptr;
+  }
+}
+
+std::unique_ptr<StreamingUncompress> NewStreamingUncompress(
+    CompressionType compression_type) {
+  switch (compression_type) {
+#ifdef ZLIB
+    case kZlibCompression:
+      return std::unique_ptr<StreamingUncompress>(
+          new ZlibStreamingUncompress());
+#endif  // ZLIB
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 800
+    case kZSTD:
+      return std::unique_ptr<StreamingUncompress>(
+          new ZSTDStreamingUncompress());
+#endif  // defined(ZSTD) && ZSTD_VERSION_NUMBER >= 800
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace rocksdb
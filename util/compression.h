@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <memory>
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
 #ifdef OS_FREEBSD
 #include <malloc_np.h>
@@ -1406,4 +1407,42 @@ inline std::string ZSTD_TrainDictionary(const std::string& samples,
 #endif  // ZSTD_VERSION_NUMBER >= 10103
 }
 
+// Compresses a stream of records, such as the records of a WAL file, with
+// a single compression context, so that each record benefits from the
+// history of the ones before it. The output for a record can only be
+// uncompressed by a StreamingUncompress that has uncompressed the output for
+// all the preceding records, in order.
+class StreamingCompress {
+ public:
+  virtual ~StreamingCompress() {}
+
+  // Appends the compressed form of input to *output. The output is flushed,
+  // so that all of input can be uncompressed from the output so far.
+  // Returns false on failure, after which the stream is unusable.
+  virtual bool Compress(const Slice& input, std::string* output) = 0;
+};
+
+// Uncompresses the records written by a StreamingCompress of the same
+// compression type.
+class StreamingUncompress {
+ public:
+  virtual ~StreamingUncompress() {}
+
+  // Appends to *output what the StreamingCompress had compressed into input.
+  // Returns false if input is corrupted, after which the stream is unusable.
+  virtual bool Uncompress(const Slice& input, std::string* output) = 0;
+};
+
+// Returns whether compression_type can be used for streaming compression.
+// Only kZSTD and kZlibCompression can, when they are compiled in.
+extern bool StreamingCompressionTypeSupported(
+    CompressionType compression_type);
+
+// Return nullptr if compression_type is not supported for streaming
+// compression.
+extern std::unique_ptr<StreamingCompress> NewStreamingCompress(
+    CompressionType compression_type);
+extern std::unique_ptr<StreamingUncompress> NewStreamingUncompress(
+    CompressionType compression_type);
+
 }  // namespace rocksdb
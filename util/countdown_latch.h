@@ -0,0 +1,57 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <assert.h>
+#include <stddef.h>
+
+#include "port/port.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+// Lets a thread wait until a number of jobs, typically submitted to a
+// ThreadPool, have called CountDown().
+//
+// Typical usage:
+//
+//   CountDownLatch latch(n);
+//   for (size_t i = 0; i < n; i++) {
+//     thread_pool->SubmitJob([&latch]() { ...; latch.CountDown(); });
+//   }
+//   latch.Wait();
+class CountDownLatch {
+ public:
+  explicit CountDownLatch(size_t count) : cv_(&mu_), count_(count) {}
+  // No copying allowed
+  CountDownLatch(const CountDownLatch&) = delete;
+  void operator=(const CountDownLatch&) = delete;
+
+  void CountDown() {
+    // Signal with the mutex held, so that the waiter cannot destroy the latch
+    // before SignalAll() returns
+    MutexLock l(&mu_);
+    assert(count_ > 0);
+    if (--count_ == 0) {
+      cv_.SignalAll();
+    }
+  }
+
+  // Blocks until CountDown() was called count times.
+  void Wait() {
+    MutexLock l(&mu_);
+    while (count_ > 0) {
+      cv_.Wait();
+    }
+  }
+
+ private:
+  port::Mutex mu_;
+  port::CondVar cv_;
+  size_t count_;
+};
+
+}  // namespace rocksdb
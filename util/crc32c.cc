@@ -1250,6 +1250,65 @@ uint32_t Extend(uint32_t crc, const char* buf, size_t size) {
   return ChosenExtend(crc, buf, size);
 }
 
+namespace {
+// Multiplies the 32x32 GF(2) matrix `mat` by the vector `vec`.
+uint32_t GF2MatrixTimes(const uint32_t* mat, uint32_t vec) {
+  uint32_t sum = 0;
+  while (vec) {
+    if (vec & 1) {
+      sum ^= *mat;
+    }
+    vec >>= 1;
+    mat++;
+  }
+  return sum;
+}
+
+void GF2MatrixSquare(uint32_t* square, const uint32_t* mat) {
+  for (int n = 0; n < 32; n++) {
+    square[n] = GF2MatrixTimes(mat, mat[n]);
+  }
+}
+}  // namespace
+
+// Same approach as zlib's crc32_combine(): apply len2 zero bytes to crc1
+// by repeated squaring of the one-zero-bit operator, then xor in crc2.
+uint32_t Crc32cCombine(uint32_t crc1, uint32_t crc2, size_t len2) {
+  if (len2 == 0) {
+    return crc1;
+  }
+  uint32_t even[32];  // operator for an even power-of-two zero bits
+  uint32_t odd[32];   // operator for an odd power-of-two zero bits
+
+  // Operator for one zero bit, using the reflected CRC-32C polynomial.
+  odd[0] = 0x82f63b78;
+  uint32_t row = 1;
+  for (int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+  GF2MatrixSquare(even, odd);  // two zero bits
+  GF2MatrixSquare(odd, even);  // four zero bits
+
+  // The first squaring below puts the operator for one zero byte in even.
+  do {
+    GF2MatrixSquare(even, odd);
+    if (len2 & 1) {
+      crc1 = GF2MatrixTimes(even, crc1);
+    }
+    len2 >>= 1;
+    if (len2 == 0) {
+      break;
+    }
+    GF2MatrixSquare(odd, even);
+    if (len2 & 1) {
+      crc1 = GF2MatrixTimes(odd, crc1);
+    }
+    len2 >>= 1;
+  } while (len2 != 0);
+  return crc1 ^ crc2;
+}
+
 
 }  // namespace crc32c
 }  // namespace rocksdb
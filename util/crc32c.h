@@ -27,6 +27,11 @@ inline uint32_t Value(const char* data, size_t n) {
   return Extend(0, data, n);
 }
 
+// Return the crc32c of concat(A, B) where crc1 is the crc32c of A and
+// crc2 is the crc32c of B, which is len2 bytes long.  Lets checksums of
+// separately processed pieces of a stream be stitched together.
+extern uint32_t Crc32cCombine(uint32_t crc1, uint32_t crc2, size_t len2);
+
 static const uint32_t kMaskDelta = 0xa282ead8ul;
 
 // Return a masked representation of crc.
@@ -129,6 +129,20 @@ TEST(CRC, Extend) {
             Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, Combine) {
+  const char* data = "hello world, this string is split in two";
+  const size_t n = strlen(data);
+  for (size_t i = 0; i <= n; i++) {
+    ASSERT_EQ(Value(data, n),
+              Crc32cCombine(Value(data, i), Value(data + i, n - i), n - i));
+  }
+  // Large second halves exercise more squarings.
+  ASSERT_EQ(Value(buffer, BUFFER_SIZE),
+            Crc32cCombine(Value(buffer, 12345),
+                          Value(buffer + 12345, BUFFER_SIZE - 12345),
+                          BUFFER_SIZE - 12345));
+}
+
 TEST(CRC, Mask) {
   uint32_t crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
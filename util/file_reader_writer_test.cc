@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <vector>
 #include "env/composite_env_wrapper.h"
+#include "file/file_prefetch_buffer.h"
 #include "file/random_access_file_reader.h"
 #include "file/readahead_raf.h"
 #include "file/sequence_file_reader.h"
@@ -435,6 +436,163 @@ INSTANTIATE_TEST_CASE_P(
 INSTANTIATE_TEST_CASE_P(
     ReadExceedsReadaheadSize, ReadaheadSequentialFileTest,
     ::testing::ValuesIn(ReadaheadSequentialFileTest::GetReadaheadSizeList()));
+
+namespace {
+class DeferredReadFile;
+
+struct DeferredRead {
+  const DeferredReadFile* file;
+  FSReadRequest req;
+  std::function<void(const FSReadRequest&, void*)> cb;
+  void* cb_arg;
+  bool done;
+};
+
+// Leaves asynchronous reads outstanding until they are polled.
+class DeferredReadFile : public FSRandomAccessFile {
+ public:
+  explicit DeferredReadFile(const std::string& contents)
+      : contents_(contents), num_async_reads_(0) {}
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& /*options*/,
+                Slice* result, char* scratch,
+                IODebugContext* /*dbg*/) const override {
+    offset = std::min<uint64_t>(offset, contents_.size());
+    n = std::min<size_t>(n, contents_.size() - offset);
+    memcpy(scratch, contents_.data() + offset, n);
+    *result = Slice(scratch, n);
+    return IOStatus::OK();
+  }
+
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& /*opts*/,
+                     std::function<void(const FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* /*dbg*/) override {
+    *io_handle = new DeferredRead{this, req, cb, cb_arg, false};
+    *del_fn = [](void* handle) { delete static_cast<DeferredRead*>(handle); };
+    num_async_reads_++;
+    return IOStatus::OK();
+  }
+
+  bool SupportsAsyncRead() const override { return true; }
+
+  int num_async_reads() const { return num_async_reads_; }
+
+ private:
+  std::string contents_;
+  int num_async_reads_;
+};
+
+class DeferredReadFileSystem : public FileSystemWrapper {
+ public:
+  DeferredReadFileSystem()
+      : FileSystemWrapper(FileSystem::Default().get()),
+        fail_poll_(false),
+        num_polled_reads_(0),
+        num_aborted_reads_(0) {}
+
+  const char* Name() const override { return "DeferredReadFileSystem"; }
+
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t /*min_completions*/) override {
+    if (fail_poll_) {
+      return IOStatus::IOError("Injected poll failure");
+    }
+    for (void* handle : io_handles) {
+      DeferredRead* read = static_cast<DeferredRead*>(handle);
+      if (!read->done) {
+        read->req.status =
+            read->file->Read(read->req.offset, read->req.len, IOOptions(),
+                             &read->req.result, read->req.scratch, nullptr);
+        read->done = true;
+        read->cb(read->req, read->cb_arg);
+        num_polled_reads_++;
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  IOStatus AbortIO(std::vector<void*>& io_handles) override {
+    for (void* handle : io_handles) {
+      DeferredRead* read = static_cast<DeferredRead*>(handle);
+      if (!read->done) {
+        read->req.status = IOStatus::IOError("Read cancelled");
+        read->done = true;
+        read->cb(read->req, read->cb_arg);
+        num_aborted_reads_++;
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  void SetFailPoll(bool fail) { fail_poll_ = fail; }
+  int num_polled_reads() const { return num_polled_reads_; }
+  int num_aborted_reads() const { return num_aborted_reads_; }
+
+ private:
+  bool fail_poll_;
+  int num_polled_reads_;
+  int num_aborted_reads_;
+};
+}  // namespace
+
+TEST(FilePrefetchBufferTest, AsyncReadahead) {
+  Random rng(42);
+  std::string contents = test::RandomHumanReadableString(&rng, 100000);
+  DeferredReadFile* file = new DeferredReadFile(contents);
+  RandomAccessFileReader reader(std::unique_ptr<FSRandomAccessFile>(file),
+                                "deferred");
+  DeferredReadFileSystem fs;
+  {
+    FilePrefetchBuffer buffer(&reader, 4096, 16384, true /* enable */,
+                              false /* track_min_offset */, &fs);
+    size_t offset = 0;
+    while (offset < contents.size()) {
+      size_t n = std::min<size_t>(1000 + rng.Uniform(3000),
+                                  contents.size() - offset);
+      Slice result;
+      ASSERT_TRUE(buffer.TryReadFromCache(offset, n, &result));
+      ASSERT_EQ(contents.substr(offset, n), result.ToString());
+      offset += n;
+      if (offset >= 50000 && offset < 60000) {
+        // Skipping ahead of the outstanding readahead discards it.
+        offset = 80000;
+      }
+    }
+  }
+  ASSERT_GT(file->num_async_reads(), 1);
+  // The buffer waited for every read it submitted, at the latest when it
+  // was destroyed.
+  ASSERT_EQ(file->num_async_reads(), fs.num_polled_reads());
+}
+
+TEST(FilePrefetchBufferTest, AsyncReadaheadPollFailure) {
+  Random rng(301);
+  std::string contents = test::RandomHumanReadableString(&rng, 100000);
+  DeferredReadFile* file = new DeferredReadFile(contents);
+  RandomAccessFileReader reader(std::unique_ptr<FSRandomAccessFile>(file),
+                                "deferred");
+  DeferredReadFileSystem fs;
+  fs.SetFailPoll(true);
+  {
+    FilePrefetchBuffer buffer(&reader, 4096, 16384, true /* enable */,
+                              false /* track_min_offset */, &fs);
+    size_t offset = 0;
+    while (offset < contents.size()) {
+      size_t n = std::min<size_t>(1000 + rng.Uniform(3000),
+                                  contents.size() - offset);
+      Slice result;
+      // Reads that cannot be waited for are cancelled, and the data is read
+      // synchronously instead.
+      ASSERT_TRUE(buffer.TryReadFromCache(offset, n, &result));
+      ASSERT_EQ(contents.substr(offset, n), result.ToString());
+      offset += n;
+    }
+  }
+  ASSERT_GT(file->num_async_reads(), 1);
+  ASSERT_EQ(0, fs.num_polled_reads());
+  ASSERT_EQ(file->num_async_reads(), fs.num_aborted_reads());
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -69,8 +69,9 @@ DEFINE_bool(new_builder, false,
 
 DEFINE_uint32(impl, 0,
               "Select filter implementation. Without -use_plain_table_bloom:"
-              "0 = full filter, 1 = block-based filter. With "
-              "-use_plain_table_bloom: 0 = no locality, 1 = locality.");
+              "0 = legacy full Bloom filter, 1 = block-based filter, "
+              "2 = format_version 5 Bloom filter, 3 = Standard Ribbon filter. "
+              "With -use_plain_table_bloom: 0 = no locality, 1 = locality.");
 
 DEFINE_bool(net_includes_hashing, false,
             "Whether query net ns/op times should include hashing. "
@@ -285,9 +286,9 @@ void FilterBench::Go() {
       throw std::runtime_error(
           "Block-based filter not currently supported by filter_bench");
     }
-    if (FLAGS_impl > 2) {
+    if (FLAGS_impl > 3) {
       throw std::runtime_error(
-          "-impl must currently be 0 or 2 for Block-based table");
+          "-impl must currently be 0, 2 or 3 for Block-based table");
     }
   }
 
@@ -317,6 +318,9 @@ void FilterBench::Go() {
 #endif
 
   rocksdb::StopWatchNano timer(rocksdb::Env::Default(), true);
+  // Time spent in FilterBitsBuilder::Finish, where most of the construction
+  // work happens for some implementations (e.g. Ribbon)
+  uint64_t finish_nanos = 0;
 
   while (total_memory_used < 1024 * 1024 * FLAGS_working_mem_size_mb) {
     uint32_t filter_id = random_.Next();
@@ -344,7 +348,9 @@ void FilterBench::Go() {
       for (uint32_t i = 0; i < keys_to_add; ++i) {
         builder->AddKey(kms_[0].Get(filter_id, i));
       }
+      rocksdb::StopWatchNano finish_timer(rocksdb::Env::Default(), true);
       info.filter_ = builder->Finish(&info.owner_);
+      finish_nanos += finish_timer.ElapsedNanos();
 #ifdef PREDICT_FP_RATE
       weighted_predicted_fp_rate +=
           keys_to_add *
@@ -370,6 +376,10 @@ void FilterBench::Go() {
   uint64_t elapsed_nanos = timer.ElapsedNanos();
   double ns = double(elapsed_nanos) / total_keys_added;
   std::cout << "Build avg ns/key: " << ns << std::endl;
+  if (!FLAGS_use_plain_table_bloom) {
+    std::cout << "  of which Finish avg ns/key: "
+              << double(finish_nanos) / total_keys_added << std::endl;
+  }
   std::cout << "Number of filters: " << infos_.size() << std::endl;
   std::cout << "Total memory (MB): " << total_memory_used / 1024.0 / 1024.0
             << std::endl;
@@ -685,6 +695,9 @@ int main(int argc, char **argv) {
         << std::endl
         << "  \"ns/op\" - nanoseconds per operation (key query or add)"
         << std::endl
+        << "  \"Finish\" - part of the build time spent computing the filter"
+        << "\n     from the added keys (FilterBitsBuilder::Finish)."
+        << std::endl
         << "  \"Single filter\" - essentially minimum cost, assuming filter"
         << "\n     fits easily in L1 CPU cache." << std::endl
         << "  \"Batched, prepared\" - several queries at once against a"
@@ -11,12 +11,18 @@ int main() {
 }
 #else
 
+#include <algorithm>
+#include <cinttypes>
+#include <vector>
+
+#include "db/log_writer.h"
 #include "file/writable_file_writer.h"
 #include "monitoring/histogram.h"
 #include "rocksdb/env.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/gflags_compat.h"
+#include "util/random.h"
 
 using GFLAGS_NAMESPACE::ParseCommandLineFlags;
 using GFLAGS_NAMESPACE::SetUsageMessage;
@@ -28,8 +34,28 @@ DEFINE_int32(record_size, 249, "Size of each record.");
 DEFINE_int32(record_interval, 10000, "Interval between records (microSec)");
 DEFINE_int32(bytes_per_sync, 0, "bytes_per_sync parameter in EnvOptions");
 DEFINE_bool(enable_sync, false, "sync after each write.");
+DEFINE_bool(use_log_writer, false,
+            "Write the records as WAL records with log::Writer instead of "
+            "appending them to the file as they are.");
+DEFINE_string(wal_compression, "none",
+              "Compression of the WAL records (none, zlib or zstd). Implies "
+              "--use_log_writer.");
+DEFINE_double(compression_ratio, 0.5,
+              "Fraction of its size a record compresses to on its own.");
 
 namespace rocksdb {
+CompressionType ParseWALCompression(const std::string& name) {
+  if (name == "zlib") {
+    return kZlibCompression;
+  } else if (name == "zstd") {
+    return kZSTD;
+  } else if (name != "none") {
+    fprintf(stderr, "Unknown --wal_compression '%s', using none\n",
+            name.c_str());
+  }
+  return kNoCompression;
+}
+
 void RunBenchmark() {
   std::string file_name = test::PerThreadDBPath("log_write_benchmark.log");
   DBOptions options;
@@ -42,19 +68,47 @@ void RunBenchmark() {
   writer.reset(new WritableFileWriter(std::move(file), file_name, env_options,
                                       env, nullptr /* stats */,
                                       options.listeners));
+  WritableFileWriter* file_writer = writer.get();
 
-  std::string record;
-  record.assign(FLAGS_record_size, 'X');
+  CompressionType compression_type = ParseWALCompression(FLAGS_wal_compression);
+  std::unique_ptr<log::Writer> log_writer;
+  if (FLAGS_use_log_writer || compression_type != kNoCompression) {
+    log_writer.reset(new log::Writer(std::move(writer), 0 /* log_number */,
+                                     false /* recycle_log_files */,
+                                     false /* manual_flush */,
+                                     compression_type));
+    if (compression_type != kNoCompression) {
+      Status s = log_writer->AddCompressionTypeRecord();
+      if (!s.ok()) {
+        fprintf(stderr, "%s\n", s.ToString().c_str());
+        return;
+      }
+    }
+  }
+
+  // A pool of distinct records, so that compression cannot simply repeat
+  // the previous record.
+  Random rnd(301);
+  std::vector<std::string> records(100);
+  for (auto& record : records) {
+    test::CompressibleString(&rnd, FLAGS_compression_ratio,
+                             FLAGS_record_size, &record);
+  }
 
   HistogramImpl hist;
 
   uint64_t start_time = env->NowMicros();
   for (int i = 0; i < FLAGS_num_records; i++) {
+    const std::string& record = records[i % records.size()];
     uint64_t start_nanos = env->NowNanos();
-    writer->Append(record);
-    writer->Flush();
+    if (log_writer) {
+      log_writer->AddRecord(record);
+    } else {
+      writer->Append(record);
+      writer->Flush();
+    }
     if (FLAGS_enable_sync) {
-      writer->Sync(false);
+      file_writer->Sync(false);
     }
     hist.Add(env->NowNanos() - start_nanos);
 
@@ -69,8 +123,21 @@ void RunBenchmark() {
     }
   }
 
+  uint64_t elapsed_micros =
+      std::max<uint64_t>(env->NowMicros() - start_time, 1);
+  uint64_t record_bytes = static_cast<uint64_t>(FLAGS_num_records) *
+                          static_cast<uint64_t>(FLAGS_record_size);
+  uint64_t file_bytes = file_writer->GetFileSize();
   fprintf(stderr, "Distribution of latency of append+flush: \n%s",
           hist.ToString().c_str());
+  fprintf(stderr,
+          "Wrote %" PRIu64 " bytes of records as %" PRIu64
+          " bytes of file (%.1f%%) in %.3f seconds: %.1f MB/s of records\n",
+          record_bytes, file_bytes,
+          100.0 * static_cast<double>(file_bytes) /
+              static_cast<double>(std::max<uint64_t>(record_bytes, 1)),
+          elapsed_micros / 1000000.0,
+          static_cast<double>(record_bytes) / elapsed_micros);
 }
 }  // namespace rocksdb
 
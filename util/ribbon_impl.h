@@ -0,0 +1,255 @@
+//  Copyright (c) 2020-present, Facebook, Inc. All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// Implementation details of the Ribbon filter used in RocksDB, a static
+// ("build once from a known set of keys") alternative to Bloom filters.
+// See StandardRibbonImpl.
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <cmath>
+
+#include "port/port.h"
+#include "util/bloom_impl.h"
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+// A Ribbon ("Rapid Incremental Boolean Banding ON the fly") filter is a
+// static function filter: each key is mapped to a "start" slot, a 64-bit
+// "coefficient row" covering the 64 slots from start, and an r-bit "result".
+// Construction solves the linear system over GF(2) where, for every added
+// key, the XOR of the r-bit slot values selected by its coefficient row
+// equals its result. A query recomputes that XOR and compares it to the
+// result, which for a key that was not added matches with probability
+// 2^-r. With m slots for n keys, the filter uses r * m / n bits per key, vs.
+// about 1.44 * r for a Bloom filter with the same FP rate, so the filter
+// saves space as long as m / n stays well under 1.44.
+//
+// Because the coefficient rows are confined to a band of 64 slots, the
+// system can be solved by Gaussian elimination on the fly as keys are added
+// ("banding"), in time linear in the number of keys, then by back
+// substitution. With m / n close to 1, banding fails with a small
+// probability, in which case it is retried with another hash seed. The
+// needed overhead grows slowly with n; m / n is about 1.07 for a thousand
+// keys, 1.1 for ten thousand and 1.14 for a million.
+//
+// The solution is stored "interleaved", in blocks of 64 slots: a block is r
+// 64-bit words, where word j holds bit j of the values of the 64 slots. A
+// query thus reads r words from one block or two adjacent blocks (128 to
+// 256 bytes at typical FP rates), and computes each result bit with an
+// AND and a parity.
+//
+// This implementation uses a 64-bit key hash, so that the FP rate from hash
+// collisions is negligible for any practical number of keys.
+class StandardRibbonImpl {
+ public:
+  // Number of slots covered by a coefficient row.
+  static constexpr uint32_t kCoeffBits = 64;
+
+  // Largest supported number of result bits per slot.
+  static constexpr int kMaxResultBits = 32;
+
+  // Number of slots (a multiple of kCoeffBits) to allocate for num_keys
+  // keys. Sized so that a banding attempt fails with a probability of
+  // roughly 1% or less. Non-decreasing in num_keys.
+  static inline uint32_t GetNumSlots(uint32_t num_keys) {
+    if (num_keys == 0) {
+      return 0;
+    }
+    int log2_keys = 0;
+    while ((num_keys >> log2_keys) > 0) {
+      ++log2_keys;
+    }
+    uint64_t slots =
+        uint64_t{num_keys} + uint64_t{num_keys} * log2_keys * 7 / 1000;
+    slots = (slots + kCoeffBits - 1) / kCoeffBits * kCoeffBits;
+    return static_cast<uint32_t>(slots);
+  }
+
+  // Number of result bits that gives about the FP rate of a FastLocalBloom
+  // filter with the given bits per key, i.e. the same accuracy in roughly
+  // 70% to 80% of the space.
+  static inline int ChooseNumResultBits(int millibits_per_key) {
+    double bloom_fp_rate = BloomMath::CacheLocalFpRate(
+        millibits_per_key / 1000.0,
+        FastLocalBloomImpl::ChooseNumProbes(millibits_per_key),
+        /*cache line bits*/ 512);
+    int num_result_bits =
+        static_cast<int>(std::floor(-std::log2(bloom_fp_rate) + 0.5));
+    if (num_result_bits < 1) {
+      return 1;
+    } else if (num_result_bits > kMaxResultBits) {
+      return kMaxResultBits;
+    }
+    return num_result_bits;
+  }
+
+  // NOTE: this has only been validated to enough accuracy for producing
+  // reasonable warnings / user feedback, not for making functional decisions.
+  static double EstimatedFpRate(size_t keys, int num_result_bits) {
+    return BloomMath::IndependentProbabilitySum(
+        std::pow(0.5, num_result_bits),
+        BloomMath::FingerprintFpRate(keys, /*hash bits*/ 64));
+  }
+
+  // Derives the start slot, coefficient row and result of a key, from its
+  // 64-bit hash and the hash seed. The coefficient row always has its
+  // lowest bit set, for the start slot itself.
+  static inline void PrepareHash(uint64_t h, uint32_t seed,
+                                 uint32_t num_slots, int num_result_bits,
+                                 uint32_t* start, uint64_t* coeff_row,
+                                 uint32_t* result) {
+    // Remix with the seed (the murmur3 64-bit finalizer)
+    uint64_t a = h + seed * uint64_t{0x9e3779b97f4a7c15};
+    a ^= a >> 33;
+    a *= uint64_t{0xff51afd7ed558ccd};
+    a ^= a >> 33;
+    a *= uint64_t{0xc4ceb9fe1a85ec53};
+    a ^= a >> 33;
+    *start = fastrange32(num_slots - kCoeffBits + 1, Upper32of64(a));
+    uint64_t b = a * uint64_t{0x9e3779b97f4a7c15};
+    *coeff_row = (b ^ (b >> 32)) | 1;
+    *result = Upper32of64(a * uint64_t{0xc2b2ae3d27d4eb4f}) >>
+              (32 - num_result_bits);
+  }
+
+  // Adds one equation to the banding, represented by one coefficient row
+  // and one result per slot, all zero initially. Returns false if the
+  // equation is inconsistent with the ones already added, in which case
+  // the whole banding has to be retried with another seed.
+  static inline bool BandingAdd(uint64_t* coeff_rows, uint32_t* result_rows,
+                                uint32_t start, uint64_t coeff_row,
+                                uint32_t result) {
+    uint32_t i = start;
+    for (;;) {
+      if (coeff_rows[i] == 0) {
+        coeff_rows[i] = coeff_row;
+        result_rows[i] = result;
+        return true;
+      }
+      coeff_row ^= coeff_rows[i];
+      result ^= result_rows[i];
+      if (coeff_row == 0) {
+        // Redundant (e.g. a duplicate hash) if the results agree
+        return result == 0;
+      }
+      int shift = CountTrailingZeros(coeff_row);
+      i += shift;
+      coeff_row >>= shift;
+    }
+  }
+
+  // Solves a successful banding of num_slots slots, and writes the
+  // solution in interleaved form to data, which must have room for
+  // num_slots / kCoeffBits * num_result_bits 64-bit words.
+  static inline void BackSubstitute(const uint64_t* coeff_rows,
+                                    const uint32_t* result_rows,
+                                    uint32_t num_slots, int num_result_bits,
+                                    char* data) {
+    assert(num_slots % kCoeffBits == 0);
+    assert(num_result_bits <= kMaxResultBits);
+    // Bit k of state[j] is bit j of the solution value of slot i + k
+    uint64_t state[kMaxResultBits] = {};
+    for (uint32_t i = num_slots; i > 0;) {
+      --i;
+      uint64_t coeff_row = coeff_rows[i];
+      uint32_t result = result_rows[i];
+      for (int j = 0; j < num_result_bits; ++j) {
+        // The lowest bit of the shifted state is 0, so this is the parity
+        // of the values already solved. (Free variables, for empty slots,
+        // are set to 0.)
+        uint64_t bit =
+            Parity(coeff_row & (state[j] << 1)) ^ ((result >> j) & 1);
+        state[j] = (state[j] << 1) | bit;
+      }
+      if (i % kCoeffBits == 0) {
+        char* block = data + size_t{i / kCoeffBits} * num_result_bits * 8;
+        for (int j = 0; j < num_result_bits; ++j) {
+          EncodeFixed64(block + j * 8, state[j]);
+        }
+      }
+    }
+  }
+
+  static inline void PrepareQuery(uint32_t start, int num_result_bits,
+                                  const char* data,
+                                  uint32_t /*out*/* byte_offset) {
+    *byte_offset = start / kCoeffBits * num_result_bits * 8;
+    PREFETCH(data + *byte_offset, 0 /* rw */, 1 /* locality */);
+    PREFETCH(data + *byte_offset + num_result_bits * 8 * 2 - 1, 0 /* rw */,
+             1 /* locality */);
+  }
+
+  static inline bool QueryPrepared(uint32_t start, uint64_t coeff_row,
+                                   uint32_t result, int num_result_bits,
+                                   const char* data_at_block) {
+    uint32_t offset = start % kCoeffBits;
+    uint32_t expected = 0;
+    if (offset == 0) {
+      for (int j = 0; j < num_result_bits; ++j) {
+        uint64_t word = DecodeFixed64(data_at_block + j * 8);
+        expected |= static_cast<uint32_t>(Parity(coeff_row & word)) << j;
+      }
+    } else {
+      // The row spans this block and the next one
+      const char* next_block = data_at_block + num_result_bits * 8;
+      for (int j = 0; j < num_result_bits; ++j) {
+        uint64_t word = (DecodeFixed64(data_at_block + j * 8) >> offset) |
+                        (DecodeFixed64(next_block + j * 8)
+                         << (kCoeffBits - offset));
+        expected |= static_cast<uint32_t>(Parity(coeff_row & word)) << j;
+      }
+    }
+    return expected == result;
+  }
+
+  static inline bool HashMayMatch(uint64_t h, uint32_t seed,
+                                  uint32_t num_slots, int num_result_bits,
+                                  const char* data) {
+    uint32_t start;
+    uint64_t coeff_row;
+    uint32_t result;
+    PrepareHash(h, seed, num_slots, num_result_bits, &start, &coeff_row,
+                &result);
+    uint32_t byte_offset;
+    PrepareQuery(start, num_result_bits, data, &byte_offset);
+    return QueryPrepared(start, coeff_row, result, num_result_bits,
+                         data + byte_offset);
+  }
+
+ private:
+  static inline int CountTrailingZeros(uint64_t v) {
+    assert(v != 0);
+#ifdef __GNUC__
+    return __builtin_ctzll(v);
+#else
+    int n = 0;
+    while ((v & 1) == 0) {
+      v >>= 1;
+      ++n;
+    }
+    return n;
+#endif
+  }
+
+  static inline uint64_t Parity(uint64_t v) {
+#ifdef __GNUC__
+    return static_cast<uint64_t>(__builtin_parityll(v));
+#else
+    v ^= v >> 32;
+    v ^= v >> 16;
+    v ^= v >> 8;
+    v ^= v >> 4;
+    v ^= v >> 2;
+    v ^= v >> 1;
+    return v & 1;
+#endif
+  }
+};
+
+}  // namespace rocksdb
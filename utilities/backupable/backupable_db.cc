@@ -27,6 +27,7 @@
 
 #include "env/composite_env_wrapper.h"
 #include "file/filename.h"
+#include "file/random_access_file_reader.h"
 #include "file/sequence_file_reader.h"
 #include "file/writable_file_writer.h"
 #include "logging/logging.h"
@@ -83,6 +84,10 @@ void BackupableDBOptions::Dump(Logger* logger) const {
                  restore_rate_limit);
   ROCKS_LOG_INFO(logger, "Options.max_background_operations: %d",
                  max_background_operations);
+  ROCKS_LOG_INFO(logger, "          Options.copy_chunk_size: %" PRIu64,
+                 copy_chunk_size);
+  ROCKS_LOG_INFO(logger, "   Options.reuse_backup_checksums: %d",
+                 static_cast<int>(reuse_backup_checksums));
 }
 
 // -------- BackupEngineImpl class ---------
@@ -321,6 +326,31 @@ class BackupEngineImpl : public BackupEngine {
     Status status;
   };
 
+  // State shared by the threads copying the chunks of one file larger than
+  // options_.copy_chunk_size. Threads claim chunks through next_chunk and
+  // write them through their own RandomRWFile on dst_path; the one that
+  // accounts for the last chunk sets result.
+  struct ChunkedCopy {
+    std::unique_ptr<RandomAccessFileReader> src_reader;
+    std::string dst_path;
+    Env* dst_env;
+    EnvOptions dst_env_options;
+    bool sync;
+    RateLimiter* rate_limiter;
+    std::function<void()> progress_callback;
+    uint64_t file_size;
+    uint64_t chunk_size;
+    uint64_t num_chunks;
+    std::atomic<uint64_t> next_chunk{0};
+    std::atomic<uint64_t> chunks_done{0};
+    std::atomic<bool> failed{false};
+    // crc32c of each chunk, combined in order once all are written.
+    std::vector<uint32_t> chunk_checksums;
+    std::mutex status_mutex;
+    Status status;
+    std::promise<CopyOrCreateResult> result;
+  };
+
   // Exactly one of src_path and contents must be non-empty. If src_path is
   // non-empty, the file is copied from this pathname. Otherwise, if contents is
   // non-empty, the file will be created at dst_path with these contents.
@@ -336,6 +366,9 @@ class BackupEngineImpl : public BackupEngine {
     uint64_t size_limit;
     std::promise<CopyOrCreateResult> result;
     std::function<void()> progress_callback;
+    // If set, this item only helps copy the chunks of a file another
+    // thread has started copying; all other fields are unused.
+    std::shared_ptr<ChunkedCopy> chunked_copy;
 
     CopyOrCreateWorkItem()
         : src_path(""),
@@ -367,6 +400,7 @@ class BackupEngineImpl : public BackupEngine {
       size_limit = o.size_limit;
       result = std::move(o.result);
       progress_callback = std::move(o.progress_callback);
+      chunked_copy = std::move(o.chunked_copy);
       return *this;
     }
 
@@ -385,8 +419,25 @@ class BackupEngineImpl : public BackupEngine {
           rate_limiter(_rate_limiter),
           size_limit(_size_limit),
           progress_callback(_progress_callback) {}
+
+    explicit CopyOrCreateWorkItem(std::shared_ptr<ChunkedCopy> _chunked_copy)
+        : CopyOrCreateWorkItem() {
+      chunked_copy = std::move(_chunked_copy);
+    }
   };
 
+  // Sets up *copy if work_item copies a file larger than
+  // options_.copy_chunk_size. Returns NotSupported if the file should be
+  // copied whole with CopyOrCreateFile() instead.
+  Status StartChunkedCopy(CopyOrCreateWorkItem& work_item,
+                          std::shared_ptr<ChunkedCopy>* copy);
+
+  // Copies chunks of copy until none are left to claim.
+  void CopyChunks(ChunkedCopy* copy);
+
+  Status CopyChunk(ChunkedCopy* copy, uint64_t chunk, RandomRWFile* dst_file,
+                   char* buf, uint64_t* processed_buffer_size);
+
   struct BackupAfterCopyOrCreateWorkItem {
     std::future<CopyOrCreateResult> result;
     bool shared;
@@ -739,6 +790,33 @@ Status BackupEngineImpl::Initialize() {
 #endif
       CopyOrCreateWorkItem work_item;
       while (files_to_copy_or_create_.read(work_item)) {
+        if (work_item.chunked_copy != nullptr) {
+          CopyChunks(work_item.chunked_copy.get());
+          continue;
+        }
+        std::shared_ptr<ChunkedCopy> chunked_copy;
+        Status s = StartChunkedCopy(work_item, &chunked_copy);
+        if (s.ok()) {
+          // Let idle threads help out, and copy chunks here meanwhile, so the
+          // file finishes even if no other thread picks up a helper item.
+          uint64_t num_helpers =
+              std::min(chunked_copy->num_chunks,
+                       static_cast<uint64_t>(
+                           options_.max_background_operations)) -
+              1;
+          for (uint64_t i = 0; i < num_helpers; ++i) {
+            files_to_copy_or_create_.write(CopyOrCreateWorkItem(chunked_copy));
+          }
+          CopyChunks(chunked_copy.get());
+          continue;
+        } else if (!s.IsNotSupported()) {
+          CopyOrCreateResult result;
+          result.size = 0;
+          result.checksum_value = 0;
+          result.status = s;
+          work_item.result.set_value(std::move(result));
+          continue;
+        }
         CopyOrCreateResult result;
         result.status = CopyOrCreateFile(
             work_item.src_path, work_item.dst_path, work_item.contents,
@@ -836,9 +914,12 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
             return Status::OK();
           }
           Log(options_.info_log, "add file for backup %s", fname.c_str());
+          // Blob files are immutable like table files, so they are shared
+          // between backups the same way
+          bool shareable = type == kTableFile || type == kBlobFile;
           uint64_t size_bytes = 0;
           Status st;
-          if (type == kTableFile) {
+          if (shareable) {
             st = db_env_->GetFileSize(src_dirname + fname, &size_bytes);
           }
           EnvOptions src_env_options;
@@ -865,10 +946,9 @@ Status BackupEngineImpl::CreateNewBackupWithMetadata(
           if (st.ok()) {
             st = AddBackupFileWorkItem(
                 live_dst_paths, backup_items_to_finish, new_backup_id,
-                options_.share_table_files && type == kTableFile, src_dirname,
-                fname, src_env_options, rate_limiter, size_bytes,
-                size_limit_bytes,
-                options_.share_files_with_checksum && type == kTableFile,
+                options_.share_table_files && shareable, src_dirname, fname,
+                src_env_options, rate_limiter, size_bytes, size_limit_bytes,
+                options_.share_files_with_checksum && shareable,
                 progress_callback);
           }
           return st;
@@ -1357,6 +1437,184 @@ Status BackupEngineImpl::CopyOrCreateFile(
   return s;
 }
 
+Status BackupEngineImpl::StartChunkedCopy(CopyOrCreateWorkItem& work_item,
+                                          std::shared_ptr<ChunkedCopy>* copy) {
+  if (options_.copy_chunk_size == 0 || work_item.src_path.empty() ||
+      work_item.size_limit != 0) {
+    return Status::NotSupported();
+  }
+  uint64_t file_size = 0;
+  Status s = work_item.src_env->GetFileSize(work_item.src_path, &file_size);
+  if (!s.ok()) {
+    return s;
+  }
+  if (file_size <= options_.copy_chunk_size) {
+    return Status::NotSupported();
+  }
+
+  // RandomRWFile neither creates nor truncates the file on every Env, so
+  // (re)create it empty first.
+  EnvOptions dst_env_options;
+  dst_env_options.use_mmap_writes = false;
+  std::unique_ptr<WritableFile> empty_file;
+  s = work_item.dst_env->NewWritableFile(work_item.dst_path, &empty_file,
+                                         dst_env_options);
+  if (s.ok()) {
+    s = empty_file->Close();
+  }
+  if (s.ok()) {
+    // Each copying thread opens its own handle; this only checks that the
+    // Env supports them, otherwise the file is copied whole.
+    std::unique_ptr<RandomRWFile> dst_file;
+    s = work_item.dst_env->NewRandomRWFile(work_item.dst_path, &dst_file,
+                                           dst_env_options);
+  }
+  std::unique_ptr<RandomAccessFile> src_file;
+  if (s.ok()) {
+    s = work_item.src_env->NewRandomAccessFile(
+        work_item.src_path, &src_file, work_item.src_env_options);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::shared_ptr<ChunkedCopy> c = std::make_shared<ChunkedCopy>();
+  c->src_reader.reset(new RandomAccessFileReader(
+      NewLegacyRandomAccessFileWrapper(src_file), work_item.src_path));
+  c->dst_path = work_item.dst_path;
+  c->dst_env = work_item.dst_env;
+  c->dst_env_options = dst_env_options;
+  c->sync = work_item.sync;
+  c->rate_limiter = work_item.rate_limiter;
+  c->progress_callback = std::move(work_item.progress_callback);
+  c->file_size = file_size;
+  c->chunk_size = options_.copy_chunk_size;
+  c->num_chunks = (file_size + c->chunk_size - 1) / c->chunk_size;
+  c->chunk_checksums.resize(static_cast<size_t>(c->num_chunks));
+  c->result = std::move(work_item.result);
+  *copy = std::move(c);
+  return Status::OK();
+}
+
+void BackupEngineImpl::CopyChunks(ChunkedCopy* copy) {
+  std::unique_ptr<char[]> buf;
+  std::unique_ptr<RandomRWFile> dst_file;
+  uint64_t processed_buffer_size = 0;
+  uint64_t num_claimed = 0;
+  Status s;
+  while (true) {
+    uint64_t chunk = copy->next_chunk.fetch_add(1);
+    if (chunk >= copy->num_chunks) {
+      break;
+    }
+    ++num_claimed;
+    // After a failure the remaining chunks are only accounted for.
+    if (!s.ok() || copy->failed.load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (dst_file == nullptr) {
+      buf.reset(new char[copy_file_buffer_size_]);
+      s = copy->dst_env->NewRandomRWFile(copy->dst_path, &dst_file,
+                                         copy->dst_env_options);
+    }
+    if (s.ok()) {
+      s = CopyChunk(copy, chunk, dst_file.get(), buf.get(),
+                    &processed_buffer_size);
+    }
+    if (!s.ok()) {
+      copy->failed.store(true, std::memory_order_release);
+    }
+  }
+  if (num_claimed == 0) {
+    return;
+  }
+  // Chunks only count as done once they are durable and the file handle that
+  // wrote them is closed.
+  if (dst_file != nullptr) {
+    if (s.ok() && copy->sync) {
+      s = dst_file->Sync();
+    }
+    Status close_status = dst_file->Close();
+    if (s.ok()) {
+      s = close_status;
+    }
+  }
+  if (!s.ok()) {
+    std::lock_guard<std::mutex> lock(copy->status_mutex);
+    if (copy->status.ok()) {
+      copy->status = s;
+    }
+    copy->failed.store(true, std::memory_order_release);
+  }
+  if (copy->chunks_done.fetch_add(num_claimed) + num_claimed <
+      copy->num_chunks) {
+    return;
+  }
+
+  CopyOrCreateResult result;
+  result.size = 0;
+  result.checksum_value = 0;
+  {
+    std::lock_guard<std::mutex> lock(copy->status_mutex);
+    result.status = copy->status;
+  }
+  if (result.status.ok()) {
+    result.size = copy->file_size;
+    result.checksum_value = copy->chunk_checksums[0];
+    for (uint64_t i = 1; i < copy->num_chunks; ++i) {
+      uint64_t chunk_len =
+          std::min(copy->chunk_size, copy->file_size - i * copy->chunk_size);
+      result.checksum_value = crc32c::Crc32cCombine(
+          result.checksum_value, copy->chunk_checksums[i],
+          static_cast<size_t>(chunk_len));
+    }
+  }
+  copy->result.set_value(std::move(result));
+}
+
+Status BackupEngineImpl::CopyChunk(ChunkedCopy* copy, uint64_t chunk,
+                                   RandomRWFile* dst_file, char* buf,
+                                   uint64_t* processed_buffer_size) {
+  uint64_t offset = chunk * copy->chunk_size;
+  uint64_t end = std::min(offset + copy->chunk_size, copy->file_size);
+  uint32_t checksum_value = 0;
+  while (offset < end) {
+    if (stop_backup_.load(std::memory_order_acquire)) {
+      return Status::Incomplete("Backup stopped");
+    }
+    size_t buffer_to_read = static_cast<size_t>(
+        std::min<uint64_t>(copy_file_buffer_size_, end - offset));
+    Slice data;
+    Status s = copy->src_reader->Read(offset, buffer_to_read, &data, buf);
+    if (!s.ok()) {
+      return s;
+    }
+    if (data.size() != buffer_to_read) {
+      return Status::IOError("File shrank while being copied: " +
+                             copy->src_reader->file_name());
+    }
+    checksum_value = crc32c::Extend(checksum_value, data.data(), data.size());
+    s = dst_file->Write(offset, data);
+    if (!s.ok()) {
+      return s;
+    }
+    if (copy->rate_limiter != nullptr) {
+      copy->rate_limiter->Request(data.size(), Env::IO_LOW,
+                                  nullptr /* stats */,
+                                  RateLimiter::OpType::kWrite);
+    }
+    offset += data.size();
+    *processed_buffer_size += data.size();
+    if (*processed_buffer_size > options_.callback_trigger_interval_size) {
+      *processed_buffer_size -= options_.callback_trigger_interval_size;
+      std::lock_guard<std::mutex> lock(byte_report_mutex_);
+      copy->progress_callback();
+    }
+  }
+  copy->chunk_checksums[static_cast<size_t>(chunk)] = checksum_value;
+  return Status::OK();
+}
+
 // fname will always start with "/"
 Status BackupEngineImpl::AddBackupFileWorkItem(
     std::unordered_set<std::string>& live_dst_paths,
@@ -1450,10 +1708,21 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
       backup_env_->DeleteFile(final_dest_path);
     } else {
       // the file is present and referenced by a backup
-      ROCKS_LOG_INFO(options_.info_log,
-                     "%s already present, calculate checksum", fname.c_str());
-      s = CalculateChecksum(src_dir + fname, db_env_, src_env_options,
-                            size_limit, &checksum_value);
+      auto backuped_file = backuped_file_infos_.find(dst_relative);
+      if (options_.reuse_backup_checksums &&
+          backuped_file != backuped_file_infos_.end() &&
+          backuped_file->second->size == size_bytes && size_limit == 0) {
+        checksum_value = backuped_file->second->checksum_value;
+        ROCKS_LOG_INFO(options_.info_log,
+                       "%s already present, reusing checksum %u",
+                       fname.c_str(), checksum_value);
+      } else {
+        ROCKS_LOG_INFO(options_.info_log,
+                       "%s already present, calculate checksum",
+                       fname.c_str());
+        s = CalculateChecksum(src_dir + fname, db_env_, src_env_options,
+                              size_limit, &checksum_value);
+      }
     }
   }
   live_dst_paths.insert(final_dest_path);
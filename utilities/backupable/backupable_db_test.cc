@@ -1239,6 +1239,42 @@ TEST_F(BackupableDBTest, ShareTableFilesWithChecksums) {
   }
 }
 
+// Verify that blob files are backed up as shared files and restored
+TEST_F(BackupableDBTest, ShareBlobFiles) {
+  const int keys_iteration = 1000;
+  options_.enable_blob_files = true;
+  options_.min_blob_size = 0;
+  for (ShareOption shared_option : {kShareNoChecksum, kShareWithChecksum}) {
+    ASSERT_OK(DestroyDB(dbname_, options_));
+    OpenDBAndBackupEngine(true /* destroy_old_data */, false /* dummy */,
+                          shared_option);
+    for (int i = 0; i < 2; ++i) {
+      FillDB(db_.get(), keys_iteration * i, keys_iteration * (i + 1));
+      ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+    }
+    CloseDBAndBackupEngine();
+
+    std::vector<std::string> shared_files;
+    ASSERT_OK(backup_chroot_env_->GetChildren(
+        backupdir_ + (shared_option == kShareWithChecksum ? "/shared_checksum"
+                                                          : "/shared"),
+        &shared_files));
+    size_t num_blob_files = 0;
+    for (const auto& shared_file : shared_files) {
+      if (shared_file.size() > 5 &&
+          shared_file.compare(shared_file.size() - 5, 5, ".blob") == 0) {
+        num_blob_files++;
+      }
+    }
+    ASSERT_GE(num_blob_files, 2U);
+
+    for (int i = 0; i < 2; ++i) {
+      AssertBackupConsistency(i + 1, 0, keys_iteration * (i + 1),
+                              keys_iteration * 3);
+    }
+  }
+}
+
 // Verify that you can backup and restore using share_files_with_checksum set to
 // false and then transition this option to true
 TEST_F(BackupableDBTest, ShareTableFilesWithChecksumsTransition) {
@@ -1472,6 +1508,51 @@ TEST_F(BackupableDBTest, ReadOnlyBackupEngine) {
   delete db;
 }
 
+TEST_F(BackupableDBTest, ChunkedCopy) {
+  const int keys_iteration = 5000;
+  // Small enough that every table file is split into many chunks.
+  backupable_options_->copy_chunk_size = 4096;
+  OpenDBAndBackupEngine(true);
+  for (int i = 0; i < 5; ++i) {
+    FillDB(db_.get(), keys_iteration * i, keys_iteration * (i + 1));
+    test_db_env_->ClearFileOpenCounters();
+    ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+    // Large files are read through random access files, one per file.
+    ASSERT_GT(test_db_env_->num_rand_readers(), 0);
+    ASSERT_OK(backup_engine_->VerifyBackup(i + 1));
+  }
+  CloseDBAndBackupEngine();
+
+  // Restores are chunked too, and fail on any checksum mismatch.
+  for (int i = 0; i < 5; ++i) {
+    AssertBackupConsistency(i + 1, 0, keys_iteration * (i + 1),
+                            keys_iteration * 6);
+  }
+}
+
+TEST_F(BackupableDBTest, ReuseBackupChecksums) {
+  OpenDBAndBackupEngine(true);
+  FillDB(db_.get(), 0, 5000);
+  ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+
+  // The table files are already backed up, so the second backup only reads
+  // them to compute their checksums.
+  test_db_env_->ClearFileOpenCounters();
+  ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), false));
+  int seq_readers_without_reuse = test_db_env_->num_seq_readers();
+
+  CloseBackupEngine();
+  backupable_options_->reuse_backup_checksums = true;
+  OpenBackupEngine();
+  test_db_env_->ClearFileOpenCounters();
+  ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), false));
+  ASSERT_LT(test_db_env_->num_seq_readers(), seq_readers_without_reuse);
+  ASSERT_OK(backup_engine_->VerifyBackup(3));
+  CloseDBAndBackupEngine();
+
+  AssertBackupConsistency(3, 0, 5000, 10000);
+}
+
 TEST_F(BackupableDBTest, ProgressCallbackDuringBackup) {
   DestroyDB(dbname_, options_);
   OpenDBAndBackupEngine(true);
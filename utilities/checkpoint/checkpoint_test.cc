@@ -17,6 +17,7 @@
 #include <thread>
 #include <utility>
 #include "db/db_impl/db_impl.h"
+#include "file/filename.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/db.h"
@@ -747,6 +748,64 @@ TEST_F(CheckpointTest, CheckpointWithUnsyncedDataDropped) {
   db_ = nullptr;
 }
 
+TEST_F(CheckpointTest, CheckpointWithBlobFiles) {
+  Options options = CurrentOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  Reopen(options);
+
+  ASSERT_OK(Put("key1", "blob1"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("key2", "blob2"));
+
+  std::vector<std::string> live_files;
+  uint64_t manifest_file_size = 0;
+  ASSERT_OK(db_->GetLiveFiles(live_files, &manifest_file_size,
+                              false /* flush_memtable */));
+  size_t num_blob_files = 0;
+  for (const auto& live_file : live_files) {
+    uint64_t number = 0;
+    FileType type;
+    ASSERT_TRUE(ParseFileName(live_file, &number, &type));
+    if (type == kBlobFile) {
+      num_blob_files++;
+    }
+  }
+  ASSERT_EQ(1U, num_blob_files);
+
+  // The checkpoint flushes key2 into a second blob file
+  Checkpoint* checkpoint;
+  ASSERT_OK(Checkpoint::Create(db_, &checkpoint));
+  ASSERT_OK(checkpoint->CreateCheckpoint(snapshot_name_));
+  delete checkpoint;
+  delete db_;
+  db_ = nullptr;
+  ASSERT_OK(DestroyDB(dbname_, options));
+
+  std::vector<std::string> snapshot_files;
+  ASSERT_OK(env_->GetChildren(snapshot_name_, &snapshot_files));
+  num_blob_files = 0;
+  for (const auto& snapshot_file : snapshot_files) {
+    uint64_t number = 0;
+    FileType type;
+    if (ParseFileName(snapshot_file, &number, &type) && type == kBlobFile) {
+      num_blob_files++;
+    }
+  }
+  ASSERT_EQ(2U, num_blob_files);
+
+  options.create_if_missing = false;
+  DB* snapshot_db;
+  ASSERT_OK(DB::Open(options, snapshot_name_, &snapshot_db));
+  ReadOptions read_opts;
+  std::string get_result;
+  ASSERT_OK(snapshot_db->Get(read_opts, "key1", &get_result));
+  ASSERT_EQ("blob1", get_result);
+  ASSERT_OK(snapshot_db->Get(read_opts, "key2", &get_result));
+  ASSERT_EQ("blob2", get_result);
+  delete snapshot_db;
+}
+
 TEST_F(CheckpointTest, CheckpointReadOnlyDB) {
   ASSERT_OK(Put("foo", "foo_value"));
   ASSERT_OK(Flush());
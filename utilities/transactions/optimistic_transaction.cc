@@ -64,6 +64,8 @@ Status OptimisticTransaction::Commit() {
     return CommitWithParallelValidate();
   } else if (policy == OccValidationPolicy::kValidateSerial) {
     return CommitWithSerialValidate();
+  } else if (policy == OccValidationPolicy::kValidateSequenceTable) {
+    return CommitWithSequenceTableValidate();
   } else {
     assert(0);
   }
@@ -123,6 +125,18 @@ Status OptimisticTransaction::CommitWithParallelValidate() {
   return s;
 }
 
+Status OptimisticTransaction::CommitWithSequenceTableValidate() {
+  auto txn_db_impl = static_cast_with_check<OptimisticTransactionDBImpl,
+                                            OptimisticTransactionDB>(txn_db_);
+  assert(txn_db_impl);
+  Status s = txn_db_impl->WriteWithSequenceTable(
+      write_options_, GetWriteBatch()->GetWriteBatch(), &GetTrackedKeys());
+  if (s.ok()) {
+    Clear();
+  }
+  return s;
+}
+
 Status OptimisticTransaction::Rollback() {
   Clear();
   return Status::OK();
@@ -78,6 +78,8 @@ class OptimisticTransaction : public TransactionBaseImpl {
   Status CommitWithSerialValidate();
 
   Status CommitWithParallelValidate();
+
+  Status CommitWithSequenceTableValidate();
 };
 
 // Used at commit time to trigger transaction validation
@@ -7,17 +7,72 @@
 
 #include "utilities/transactions/optimistic_transaction_db_impl.h"
 
+#include <map>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "db/db_impl/db_impl.h"
+#include "db/write_batch_internal.h"
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
+#include "util/cast_util.h"
+#include "util/hash.h"
 #include "utilities/transactions/optimistic_transaction.h"
 
 namespace rocksdb {
 
+namespace {
+struct SeqTableBucket {
+  // Smallest sequence number any key of the bucket was tracked at, or
+  // kMaxSequenceNumber if no key of the bucket is tracked.
+  SequenceNumber tracked_seq = kMaxSequenceNumber;
+  // Whether the write batch has a key in the bucket.
+  bool written = false;
+  // Value of the bucket when it was taken, without the lock bit.
+  uint64_t last_write_seq = 0;
+};
+
+size_t SeqTableBucketIndex(uint32_t cf_id, const Slice& key, size_t space) {
+  return fastrange64(NPHash64(key.data(), key.size(), cf_id), space);
+}
+
+// Collects the sequence table buckets of the keys written by a batch.
+class SeqTableKeyCollector : public WriteBatch::Handler {
+ public:
+  SeqTableKeyCollector(size_t space, std::map<size_t, SeqTableBucket>* buckets)
+      : space_(space), buckets_(buckets) {}
+
+  Status PutCF(uint32_t cf, const Slice& key, const Slice& /*val*/) override {
+    return AddKey(cf, key);
+  }
+  Status DeleteCF(uint32_t cf, const Slice& key) override {
+    return AddKey(cf, key);
+  }
+  Status SingleDeleteCF(uint32_t cf, const Slice& key) override {
+    return AddKey(cf, key);
+  }
+  Status MergeCF(uint32_t cf, const Slice& key, const Slice& /*val*/) override {
+    return AddKey(cf, key);
+  }
+  Status DeleteRangeCF(uint32_t /*cf*/, const Slice& /*begin_key*/,
+                       const Slice& /*end_key*/) override {
+    return Status::NotSupported(
+        "DeleteRange is not supported with kValidateSequenceTable");
+  }
+
+ private:
+  Status AddKey(uint32_t cf, const Slice& key) {
+    (*buckets_)[SeqTableBucketIndex(cf, key, space_)].written = true;
+    return Status::OK();
+  }
+
+  const size_t space_;
+  std::map<size_t, SeqTableBucket>* buckets_;
+};
+}  // namespace
+
 Transaction* OptimisticTransactionDBImpl::BeginTransaction(
     const WriteOptions& write_options,
     const OptimisticTransactionOptions& txn_options, Transaction* old_txn) {
@@ -35,6 +90,151 @@ std::unique_lock<std::mutex> OptimisticTransactionDBImpl::LockBucket(
   return std::unique_lock<std::mutex>(*bucketed_locks_[idx]);
 }
 
+Status OptimisticTransactionDBImpl::Put(const WriteOptions& options,
+                                        ColumnFamilyHandle* column_family,
+                                        const Slice& key, const Slice& val) {
+  if (validate_policy_ != OccValidationPolicy::kValidateSequenceTable) {
+    return StackableDB::Put(options, column_family, key, val);
+  }
+  WriteBatch batch;
+  Status s = batch.Put(column_family, key, val);
+  if (s.ok()) {
+    s = Write(options, &batch);
+  }
+  return s;
+}
+
+Status OptimisticTransactionDBImpl::Delete(const WriteOptions& wopts,
+                                           ColumnFamilyHandle* column_family,
+                                           const Slice& key) {
+  if (validate_policy_ != OccValidationPolicy::kValidateSequenceTable) {
+    return StackableDB::Delete(wopts, column_family, key);
+  }
+  WriteBatch batch;
+  Status s = batch.Delete(column_family, key);
+  if (s.ok()) {
+    s = Write(wopts, &batch);
+  }
+  return s;
+}
+
+Status OptimisticTransactionDBImpl::SingleDelete(
+    const WriteOptions& wopts, ColumnFamilyHandle* column_family,
+    const Slice& key) {
+  if (validate_policy_ != OccValidationPolicy::kValidateSequenceTable) {
+    return StackableDB::SingleDelete(wopts, column_family, key);
+  }
+  WriteBatch batch;
+  Status s = batch.SingleDelete(column_family, key);
+  if (s.ok()) {
+    s = Write(wopts, &batch);
+  }
+  return s;
+}
+
+Status OptimisticTransactionDBImpl::Merge(const WriteOptions& options,
+                                          ColumnFamilyHandle* column_family,
+                                          const Slice& key,
+                                          const Slice& value) {
+  if (validate_policy_ != OccValidationPolicy::kValidateSequenceTable) {
+    return StackableDB::Merge(options, column_family, key, value);
+  }
+  WriteBatch batch;
+  Status s = batch.Merge(column_family, key, value);
+  if (s.ok()) {
+    s = Write(options, &batch);
+  }
+  return s;
+}
+
+Status OptimisticTransactionDBImpl::DeleteRange(
+    const WriteOptions& options, ColumnFamilyHandle* column_family,
+    const Slice& begin_key, const Slice& end_key) {
+  if (validate_policy_ != OccValidationPolicy::kValidateSequenceTable) {
+    return StackableDB::DeleteRange(options, column_family, begin_key,
+                                    end_key);
+  }
+  return Status::NotSupported(
+      "DeleteRange is not supported with kValidateSequenceTable");
+}
+
+Status OptimisticTransactionDBImpl::Write(const WriteOptions& opts,
+                                          WriteBatch* updates) {
+  if (validate_policy_ != OccValidationPolicy::kValidateSequenceTable) {
+    return StackableDB::Write(opts, updates);
+  }
+  return WriteWithSequenceTable(opts, updates, nullptr /* tracked_keys */);
+}
+
+Status OptimisticTransactionDBImpl::WriteWithSequenceTable(
+    const WriteOptions& write_options, WriteBatch* updates,
+    const TransactionKeyMap* tracked_keys) {
+  assert(validate_policy_ == OccValidationPolicy::kValidateSequenceTable);
+  const size_t space = seq_table_.size();
+  std::map<size_t, SeqTableBucket> buckets;
+  if (tracked_keys != nullptr) {
+    for (auto& cfit : *tracked_keys) {
+      for (auto& keyit : cfit.second) {
+        SeqTableBucket& bucket =
+            buckets[SeqTableBucketIndex(cfit.first, keyit.first, space)];
+        bucket.tracked_seq = std::min(bucket.tracked_seq, keyit.second.seq);
+      }
+    }
+  }
+  SeqTableKeyCollector collector(space, &buckets);
+  Status s = updates->Iterate(&collector);
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Take the buckets in index order. A bucket written after one of its keys
+  // was tracked fails the validation.
+  auto it = buckets.begin();
+  for (; it != buckets.end(); ++it) {
+    std::atomic<uint64_t>& slot = seq_table_[it->first];
+    uint64_t cur = slot.load(std::memory_order_acquire);
+    while ((cur & kSeqTableLockBit) != 0 ||
+           !slot.compare_exchange_weak(cur, cur | kSeqTableLockBit,
+                                       std::memory_order_acquire,
+                                       std::memory_order_acquire)) {
+      if ((cur & kSeqTableLockBit) != 0) {
+        std::this_thread::yield();
+        cur = slot.load(std::memory_order_acquire);
+      }
+    }
+    it->second.last_write_seq = cur;
+    if (cur > it->second.tracked_seq) {
+      s = Status::Busy();
+      ++it;
+      break;
+    }
+  }
+
+  SequenceNumber last_seq = 0;
+  if (s.ok()) {
+    DBImpl* db_impl = static_cast_with_check<DBImpl, DB>(GetRootDB());
+    uint64_t seq_used = kMaxSequenceNumber;
+    s = db_impl->WriteImpl(write_options, updates, nullptr /* callback */,
+                           nullptr /* log_used */, 0 /* log_ref */,
+                           false /* disable_memtable */, &seq_used);
+    if (s.ok() && WriteBatchInternal::Count(updates) > 0) {
+      assert(seq_used != kMaxSequenceNumber);
+      last_seq = seq_used + WriteBatchInternal::Count(updates) - 1;
+    }
+  }
+
+  // Release the taken buckets, recording the write in the written ones.
+  // Only the holder of a bucket modifies it, so a plain store is enough.
+  for (auto rit = buckets.begin(); rit != it; ++rit) {
+    uint64_t value = rit->second.last_write_seq;
+    if (rit->second.written) {
+      value = std::max(value, last_seq);
+    }
+    seq_table_[rit->first].store(value, std::memory_order_release);
+  }
+  return s;
+}
+
 Status OptimisticTransactionDB::Open(const Options& options,
                                      const std::string& dbname,
                                      OptimisticTransactionDB** dbptr) {
@@ -77,11 +277,15 @@ Status OptimisticTransactionDB::Open(
 
   std::vector<ColumnFamilyDescriptor> column_families_copy = column_families;
 
-  // Enable MemTable History if not already enabled
+  // Enable MemTable History if not already enabled. It is only used to
+  // look up the keys at validation, which kValidateSequenceTable does not
+  // do.
   for (auto& column_family : column_families_copy) {
     ColumnFamilyOptions* options = &column_family.options;
 
-    if (options->max_write_buffer_size_to_maintain == 0 &&
+    if (occ_options.validate_policy !=
+            OccValidationPolicy::kValidateSequenceTable &&
+        options->max_write_buffer_size_to_maintain == 0 &&
         options->max_write_buffer_number_to_maintain == 0) {
       // Setting to -1 will set the History size to
       // max_write_buffer_number * write_buffer_size.
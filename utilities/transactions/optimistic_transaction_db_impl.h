@@ -6,6 +6,7 @@
 #pragma once
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <mutex>
 #include <vector>
 #include <algorithm>
@@ -13,6 +14,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/options.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
+#include "utilities/transactions/transaction_util.h"
 
 namespace rocksdb {
 
@@ -31,6 +33,13 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
         bucketed_locks_.emplace_back(
             std::unique_ptr<std::mutex>(new std::mutex));
       }
+    } else if (validate_policy_ ==
+               OccValidationPolicy::kValidateSequenceTable) {
+      uint32_t bucket_size = std::max(16u, occ_options.occ_lock_buckets);
+      seq_table_ = std::vector<std::atomic<uint64_t>>(bucket_size);
+      for (auto& bucket : seq_table_) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
     }
   }
 
@@ -52,11 +61,59 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
 
   std::unique_lock<std::mutex> LockBucket(size_t idx);
 
+  // Writes with OccValidationPolicy::kValidateSequenceTable go through the
+  // sequence table so that they are seen by the validation of concurrent
+  // transactions.
+  using StackableDB::Put;
+  virtual Status Put(const WriteOptions& options,
+                     ColumnFamilyHandle* column_family, const Slice& key,
+                     const Slice& val) override;
+
+  using StackableDB::Delete;
+  virtual Status Delete(const WriteOptions& wopts,
+                        ColumnFamilyHandle* column_family,
+                        const Slice& key) override;
+
+  using StackableDB::SingleDelete;
+  virtual Status SingleDelete(const WriteOptions& wopts,
+                              ColumnFamilyHandle* column_family,
+                              const Slice& key) override;
+
+  using StackableDB::Merge;
+  virtual Status Merge(const WriteOptions& options,
+                       ColumnFamilyHandle* column_family, const Slice& key,
+                       const Slice& value) override;
+
+  using StackableDB::DeleteRange;
+  virtual Status DeleteRange(const WriteOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Slice& begin_key,
+                             const Slice& end_key) override;
+
+  virtual Status Write(const WriteOptions& opts, WriteBatch* updates) override;
+
+  // Used with OccValidationPolicy::kValidateSequenceTable. Checks that no
+  // key in tracked_keys (may be nullptr) was written after the sequence
+  // number it was tracked at, and if so writes updates to the base DB. The
+  // sequence table buckets of the checked and written keys are held from
+  // the check until the write is recorded in the table.
+  Status WriteWithSequenceTable(const WriteOptions& write_options,
+                                WriteBatch* updates,
+                                const TransactionKeyMap* tracked_keys);
+
  private:
   // NOTE: used in validation phase. Each key is hashed into some
   // bucket. We then take the lock in the hash value order to avoid deadlock.
   std::vector<std::unique_ptr<std::mutex>> bucketed_locks_;
 
+  // NOTE: used in validation phase with
+  // OccValidationPolicy::kValidateSequenceTable. Each bucket holds the
+  // sequence number of the last write to a key hashed into it, with
+  // kSeqTableLockBit set while a writer holds the bucket. Buckets are taken
+  // in index order to avoid deadlock.
+  std::vector<std::atomic<uint64_t>> seq_table_;
+  static const uint64_t kSeqTableLockBit = 1ull << 63;
+
   bool db_owner_;
 
   const OccValidationPolicy validate_policy_;
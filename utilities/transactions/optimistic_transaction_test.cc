@@ -317,11 +317,19 @@ TEST_P(OptimisticTransactionTest, FlushTest2) {
   txn_db->Flush(flush_ops);
 
   s = txn->Commit();
-  // txn should not commit since MemTableList History is not large enough
-  ASSERT_TRUE(s.IsTryAgain());
+  if (GetParam() == OccValidationPolicy::kValidateSequenceTable) {
+    // txn commits since validation does not need MemTableList History
+    ASSERT_OK(s);
 
-  txn_db->Get(read_options, "foo", &value);
-  ASSERT_EQ(value, "bar");
+    txn_db->Get(read_options, "foo", &value);
+    ASSERT_EQ(value, "bar2");
+  } else {
+    // txn should not commit since MemTableList History is not large enough
+    ASSERT_TRUE(s.IsTryAgain());
+
+    txn_db->Get(read_options, "foo", &value);
+    ASSERT_EQ(value, "bar");
+  }
 
   delete txn;
 }
@@ -342,6 +350,9 @@ TEST_P(OptimisticTransactionTest, CheckKeySkipOldMemtable) {
     ReadOptions snapshot_read_options2;
     string value;
     Status s;
+    // kValidateSequenceTable does not look up the keys at validation.
+    const bool lookup_keys =
+        GetParam() != OccValidationPolicy::kValidateSequenceTable;
 
     ASSERT_OK(txn_db->Put(write_options, Slice("foo"), Slice("bar")));
     ASSERT_OK(txn_db->Put(write_options, Slice("foo2"), Slice("bar")));
@@ -410,7 +421,8 @@ TEST_P(OptimisticTransactionTest, CheckKeySkipOldMemtable) {
     get_perf_context()->Reset();
     s = txn->Commit();
     // We should have checked two memtables
-    ASSERT_EQ(2, get_perf_context()->get_from_memtable_count);
+    ASSERT_EQ(lookup_keys ? 2 : 0,
+              get_perf_context()->get_from_memtable_count);
     // txn should fail because of conflict, even if the memtable
     // has flushed, because it is still preserved in history.
     ASSERT_TRUE(s.IsBusy());
@@ -418,7 +430,8 @@ TEST_P(OptimisticTransactionTest, CheckKeySkipOldMemtable) {
     get_perf_context()->Reset();
     s = txn2->Commit();
     // We should have checked two memtables
-    ASSERT_EQ(2, get_perf_context()->get_from_memtable_count);
+    ASSERT_EQ(lookup_keys ? 2 : 0,
+              get_perf_context()->get_from_memtable_count);
     ASSERT_TRUE(s.ok());
 
     txn3->Put(Slice("foo2"), Slice("bar2"));
@@ -426,7 +439,8 @@ TEST_P(OptimisticTransactionTest, CheckKeySkipOldMemtable) {
     s = txn3->Commit();
     // txn3 is created after the active memtable is created, so that is the only
     // memtable to check.
-    ASSERT_EQ(1, get_perf_context()->get_from_memtable_count);
+    ASSERT_EQ(lookup_keys ? 1 : 0,
+              get_perf_context()->get_from_memtable_count);
     ASSERT_TRUE(s.ok());
 
     TEST_SYNC_POINT("OptimisticTransactionTest.CheckKeySkipOldMemtable");
@@ -1510,10 +1524,53 @@ TEST_P(OptimisticTransactionTest, SequenceNumberAfterRecoverTest) {
   delete transaction;
 }
 
+TEST_P(OptimisticTransactionTest, NonTransactionalWriteConflictTest) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  string value;
+  Status s;
+
+  ASSERT_OK(txn_db->Put(write_options, "foo", "bar"));
+
+  Transaction* txn = txn_db->BeginTransaction(write_options);
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo", &value));
+  ASSERT_OK(txn->Put("foo2", "bar2"));
+
+  // A write batch written outside of the transaction conflicts with it
+  WriteBatch batch;
+  ASSERT_OK(batch.Put("foo3", "bar3"));
+  ASSERT_OK(batch.Merge("foo4", "bar3"));
+  ASSERT_OK(batch.Put("foo", "bar3"));
+  ASSERT_OK(txn_db->Write(write_options, &batch));
+
+  s = txn->Commit();
+  ASSERT_TRUE(s.IsBusy());
+  s = txn_db->Get(read_options, "foo2", &value);
+  ASSERT_TRUE(s.IsNotFound());
+  delete txn;
+
+  // So does a single delete
+  txn = txn_db->BeginTransaction(write_options);
+  ASSERT_OK(txn->GetForUpdate(read_options, "foo3", &value));
+  ASSERT_OK(txn_db->SingleDelete(write_options, "foo3"));
+  s = txn->Commit();
+  ASSERT_TRUE(s.IsBusy());
+  delete txn;
+
+  s = txn_db->DeleteRange(write_options, txn_db->DefaultColumnFamily(), "a",
+                          "z");
+  if (GetParam() == OccValidationPolicy::kValidateSequenceTable) {
+    ASSERT_TRUE(s.IsNotSupported());
+  } else {
+    ASSERT_OK(s);
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(
     InstanceOccGroup, OptimisticTransactionTest,
     testing::Values(OccValidationPolicy::kValidateSerial,
-                    OccValidationPolicy::kValidateParallel));
+                    OccValidationPolicy::kValidateParallel,
+                    OccValidationPolicy::kValidateSequenceTable));
 
 }  // namespace rocksdb
 
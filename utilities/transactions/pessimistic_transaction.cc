@@ -92,6 +92,7 @@ void PessimisticTransaction::Initialize(const TransactionOptions& txn_options) {
 
 PessimisticTransaction::~PessimisticTransaction() {
   txn_db_impl_->UnLock(this, &GetTrackedKeys());
+  UnLockRanges();
   if (expiration_time_ > 0) {
     txn_db_impl_->RemoveExpirableTransaction(txn_id_);
   }
@@ -102,9 +103,18 @@ PessimisticTransaction::~PessimisticTransaction() {
 
 void PessimisticTransaction::Clear() {
   txn_db_impl_->UnLock(this, &GetTrackedKeys());
+  UnLockRanges();
   TransactionBaseImpl::Clear();
 }
 
+void PessimisticTransaction::UnLockRanges() {
+  for (const auto& range : tracked_ranges_) {
+    txn_db_impl_->UnLockRange(this, range.column_family_id, range.begin,
+                              range.end);
+  }
+  tracked_ranges_.clear();
+}
+
 void PessimisticTransaction::Reinitialize(
     TransactionDB* txn_db, const WriteOptions& write_options,
     const TransactionOptions& txn_options) {
@@ -693,6 +703,25 @@ bool PessimisticTransaction::TryStealingLocks() {
                                              LOCKS_STOLEN);
 }
 
+Status PessimisticTransaction::GetRangeLock(ColumnFamilyHandle* column_family,
+                                            const Slice& begin,
+                                            const Slice& end, bool exclusive) {
+  if (UNLIKELY(skip_concurrency_control_)) {
+    return Status::OK();
+  }
+  uint32_t cfh_id = GetColumnFamilyID(column_family);
+  std::string begin_str = begin.ToString();
+  std::string end_str = end.ToString();
+
+  Status s =
+      txn_db_impl_->TryRangeLock(this, cfh_id, begin_str, end_str, exclusive);
+  if (s.ok()) {
+    tracked_ranges_.push_back({cfh_id, std::move(begin_str),
+                               std::move(end_str)});
+  }
+  return s;
+}
+
 void PessimisticTransaction::UnlockGetForUpdate(
     ColumnFamilyHandle* column_family, const Slice& key) {
   txn_db_impl_->UnLock(this, GetColumnFamilyID(column_family), key.ToString());
@@ -116,6 +116,9 @@ class PessimisticTransaction : public TransactionBaseImpl {
 
   int64_t GetDeadlockDetectDepth() const { return deadlock_detect_depth_; }
 
+  Status GetRangeLock(ColumnFamilyHandle* column_family, const Slice& begin,
+                      const Slice& end, bool exclusive) override;
+
  protected:
   // Refer to
   // TransactionOptions::use_only_the_last_commit_time_batch_for_recovery
@@ -144,6 +147,9 @@ class PessimisticTransaction : public TransactionBaseImpl {
 
   void Clear() override;
 
+  // Releases the locks taken by GetRangeLock().
+  void UnLockRanges();
+
   PessimisticTransactionDB* txn_db_impl_;
   DBImpl* db_impl_;
 
@@ -190,6 +196,15 @@ class PessimisticTransaction : public TransactionBaseImpl {
   // Refer to TransactionOptions::skip_concurrency_control
   bool skip_concurrency_control_;
 
+  struct TrackedRange {
+    uint32_t column_family_id;
+    std::string begin;
+    std::string end;
+  };
+
+  // Ranges locked by GetRangeLock(), in locking order.
+  std::vector<TrackedRange> tracked_ranges_;
+
   virtual Status ValidateSnapshot(ColumnFamilyHandle* column_family,
                                   const Slice& key,
                                   SequenceNumber* tracked_at_seq);
@@ -359,7 +359,7 @@ Status TransactionDB::WrapStackableDB(
 // allocate a LockMap for it.
 void PessimisticTransactionDB::AddColumnFamily(
     const ColumnFamilyHandle* handle) {
-  lock_mgr_.AddColumnFamily(handle->GetID());
+  lock_mgr_.AddColumnFamily(handle);
 }
 
 Status PessimisticTransactionDB::CreateColumnFamily(
@@ -373,7 +373,7 @@ Status PessimisticTransactionDB::CreateColumnFamily(
 
   s = db_->CreateColumnFamily(options, column_family_name, handle);
   if (s.ok()) {
-    lock_mgr_.AddColumnFamily((*handle)->GetID());
+    lock_mgr_.AddColumnFamily(*handle);
     UpdateCFComparatorMap(*handle);
   }
 
@@ -411,6 +411,21 @@ void PessimisticTransactionDB::UnLock(PessimisticTransaction* txn,
   lock_mgr_.UnLock(txn, cfh_id, key, GetEnv());
 }
 
+Status PessimisticTransactionDB::TryRangeLock(PessimisticTransaction* txn,
+                                              uint32_t cfh_id,
+                                              const std::string& begin,
+                                              const std::string& end,
+                                              bool exclusive) {
+  return lock_mgr_.TryRangeLock(txn, cfh_id, begin, end, GetEnv(), exclusive);
+}
+
+void PessimisticTransactionDB::UnLockRange(PessimisticTransaction* txn,
+                                           uint32_t cfh_id,
+                                           const std::string& begin,
+                                           const std::string& end) {
+  lock_mgr_.UnLockRange(txn, cfh_id, begin, end);
+}
+
 // Used when wrapping DB write operations in a transaction
 Transaction* PessimisticTransactionDB::BeginInternalTransaction(
     const WriteOptions& options) {
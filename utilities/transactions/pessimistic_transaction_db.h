@@ -104,6 +104,12 @@ class PessimisticTransactionDB : public TransactionDB {
   void UnLock(PessimisticTransaction* txn, uint32_t cfh_id,
               const std::string& key);
 
+  Status TryRangeLock(PessimisticTransaction* txn, uint32_t cfh_id,
+                      const std::string& begin, const std::string& end,
+                      bool exclusive);
+  void UnLockRange(PessimisticTransaction* txn, uint32_t cfh_id,
+                   const std::string& begin, const std::string& end);
+
   void AddColumnFamily(const ColumnFamilyHandle* handle);
 
   static TransactionDBOptions ValidateTxnDBOptions(
@@ -12,11 +12,13 @@
 #include <algorithm>
 #include <condition_variable>
 #include <functional>
+#include <map>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include "monitoring/perf_context_imp.h"
+#include "rocksdb/comparator.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/utilities/transaction_db_mutex.h"
 #include "test_util/sync_point.h"
@@ -42,10 +44,40 @@ struct LockInfo {
       : exclusive(lock_info.exclusive),
         txn_ids(lock_info.txn_ids),
         expiration_time(lock_info.expiration_time) {}
+  LockInfo& operator=(const LockInfo& lock_info) = default;
+};
+
+// A lock on all the keys in [begin, end), held by a single transaction.
+struct RangeLockInfo {
+  RangeLockInfo(const std::string& _begin, const std::string& _end,
+                const LockInfo& _lock_info)
+      : begin(_begin), end(_end), lock_info(_lock_info), pending(true) {}
+
+  std::string begin;
+  std::string end;
+  LockInfo lock_info;
+  // True while the point locks in the range are being checked.  A pending
+  // range lock already keeps new point locks out of the range, but it may
+  // still be given up.
+  bool pending;
+};
+
+// Orders pointers to keys as the column family's comparator orders the keys.
+struct KeyPtrComparator {
+  explicit KeyPtrComparator(const Comparator* _comparator)
+      : comparator(_comparator) {}
+
+  bool operator()(const std::string* a, const std::string* b) const {
+    return comparator->Compare(*a, *b) < 0;
+  }
+
+  const Comparator* comparator;
 };
 
 struct LockMapStripe {
-  explicit LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory) {
+  LockMapStripe(std::shared_ptr<TransactionDBMutexFactory> factory,
+                const Comparator* comparator)
+      : ordered_keys(KeyPtrComparator(comparator)) {
     stripe_mutex = factory->AllocateMutex();
     stripe_cv = factory->AllocateCondVar();
     assert(stripe_mutex);
@@ -58,21 +90,52 @@ struct LockMapStripe {
   // Condition Variable per stripe for waiting on a lock
   std::shared_ptr<TransactionDBCondVar> stripe_cv;
 
+  // Number of threads waiting on stripe_cv.  Only modified while holding
+  // stripe_mutex, so that an unlock that reads zero after releasing the mutex
+  // can skip notifying stripe_cv.
+  std::atomic<int> num_waiters{0};
+
+  // Number of the threads waiting on stripe_cv that found a range lock in
+  // their way.  Only incremented while holding both stripe_mutex and
+  // LockMap::range_mutex, so that granting or removing a range lock only has
+  // to signal the stripes where this is not zero.
+  std::atomic<int> num_range_waiters{0};
+
   // Locked keys mapped to the info about the transactions that locked them.
   // TODO(agiardullo): Explore performance of other data structures.
   std::unordered_map<std::string, LockInfo> keys;
+
+  // The entries of keys in key order, so that a range lock only looks at the
+  // locked keys in its range.  Only maintained once a range lock has been
+  // checked against this stripe, as indicated by ordered_keys_valid.
+  std::map<const std::string*, LockInfo*, KeyPtrComparator> ordered_keys;
+  bool ordered_keys_valid = false;
+
+  // Starts maintaining ordered_keys, if it was not maintained yet.
+  void IndexKeys() {
+    if (!ordered_keys_valid) {
+      for (auto& it : keys) {
+        ordered_keys.emplace(&it.first, &it.second);
+      }
+      ordered_keys_valid = true;
+    }
+  }
 };
 
 // Map of #num_stripes LockMapStripes
 struct LockMap {
-  explicit LockMap(size_t num_stripes,
+  explicit LockMap(size_t num_stripes, const Comparator* comparator,
                    std::shared_ptr<TransactionDBMutexFactory> factory)
-      : num_stripes_(num_stripes) {
+      : num_stripes_(num_stripes), comparator_(comparator) {
     lock_map_stripes_.reserve(num_stripes);
     for (size_t i = 0; i < num_stripes; i++) {
-      LockMapStripe* stripe = new LockMapStripe(factory);
+      LockMapStripe* stripe = new LockMapStripe(factory, comparator);
       lock_map_stripes_.push_back(stripe);
     }
+    range_mutex = factory->AllocateMutex();
+    range_cv = factory->AllocateCondVar();
+    assert(range_mutex);
+    assert(range_cv);
   }
 
   ~LockMap() {
@@ -90,6 +153,34 @@ struct LockMap {
 
   std::vector<LockMapStripe*> lock_map_stripes_;
 
+  // Orders the keys of the range locks.
+  const Comparator* comparator_;
+
+  // Must be held before accessing range_locks.
+  std::shared_ptr<TransactionDBMutex> range_mutex;
+
+  // Condition Variable for waiting on a range lock, used with range_mutex.
+  std::shared_ptr<TransactionDBCondVar> range_cv;
+
+  // Range locks of this column family, pending ones included.  Point locks
+  // are expected to vastly outnumber them, so a linear scan is good enough.
+  std::vector<RangeLockInfo> range_locks;
+
+  // Number of entries in range_locks.  A range lock is added as pending
+  // before the stripes are checked for point locks in its range, so a point
+  // lock that reads zero while holding its stripe mutex is found by that
+  // check.
+  std::atomic<size_t> num_range_locks{0};
+
+  // Number of threads that wait, or are about to wait, on range_cv.  Point
+  // unlocks only signal range_cv when this is not zero.
+  std::atomic<int> num_range_waiters{0};
+
+  // Incremented under range_mutex whenever a point unlock signals range_cv,
+  // so that a range lock that found a point lock in its way while holding a
+  // stripe mutex can tell whether it missed the unlock.
+  std::atomic<uint64_t> range_cv_seq{0};
+
   size_t GetStripe(const std::string& key) const;
 };
 
@@ -182,12 +273,17 @@ size_t LockMap::GetStripe(const std::string& key) const {
   return fastrange64(GetSliceNPHash64(key), num_stripes_);
 }
 
-void TransactionLockMgr::AddColumnFamily(uint32_t column_family_id) {
+void TransactionLockMgr::AddColumnFamily(
+    const ColumnFamilyHandle* column_family) {
   InstrumentedMutexLock l(&lock_map_mutex_);
 
+  uint32_t column_family_id = column_family->GetID();
   if (lock_maps_.find(column_family_id) == lock_maps_.end()) {
-    lock_maps_.emplace(column_family_id,
-                       std::make_shared<LockMap>(default_num_stripes_, mutex_factory_));
+    lock_maps_.emplace(
+        column_family_id,
+        std::make_shared<LockMap>(default_num_stripes_,
+                                  column_family->GetComparator(),
+                                  mutex_factory_));
   } else {
     // column_family already exists in lock map
     assert(false);
@@ -336,8 +432,9 @@ Status TransactionLockMgr::AcquireWithTimeout(
   // Acquire lock if we are able to
   uint64_t expire_time_hint = 0;
   autovector<TransactionID> wait_ids;
+  bool range_conflict = false;
   result = AcquireLocked(lock_map, stripe, key, env, std::move(lock_info),
-                         &expire_time_hint, &wait_ids);
+                         &expire_time_hint, &wait_ids, &range_conflict);
 
   if (!result.ok() && timeout != 0) {
     PERF_TIMER_GUARD(key_lock_wait_time);
@@ -358,7 +455,8 @@ Status TransactionLockMgr::AcquireWithTimeout(
         cv_end_time = end_time;
       }
 
-      assert(result.IsBusy() || wait_ids.size() != 0);
+      // A pending range lock is not held by any transaction yet.
+      assert(result.IsBusy() || wait_ids.size() != 0 || range_conflict);
 
       // We are dependent on a transaction to finish, so perform deadlock
       // detection.
@@ -367,6 +465,9 @@ Status TransactionLockMgr::AcquireWithTimeout(
           if (IncrementWaiters(txn, wait_ids, key, column_family_id,
                                lock_info.exclusive, env)) {
             result = Status::Busy(Status::SubCode::kDeadlock);
+            if (range_conflict) {
+              stripe->num_range_waiters--;
+            }
             stripe->stripe_mutex->UnLock();
             return result;
           }
@@ -377,12 +478,16 @@ Status TransactionLockMgr::AcquireWithTimeout(
       TEST_SYNC_POINT("TransactionLockMgr::AcquireWithTimeout:WaitingTxn");
       if (cv_end_time < 0) {
         // Wait indefinitely
+        stripe->num_waiters++;
         result = stripe->stripe_cv->Wait(stripe->stripe_mutex);
+        stripe->num_waiters--;
       } else {
         uint64_t now = env->NowMicros();
         if (static_cast<uint64_t>(cv_end_time) > now) {
+          stripe->num_waiters++;
           result = stripe->stripe_cv->WaitFor(stripe->stripe_mutex,
                                               cv_end_time - now);
+          stripe->num_waiters--;
         }
       }
 
@@ -392,6 +497,10 @@ Status TransactionLockMgr::AcquireWithTimeout(
           DecrementWaiters(txn, wait_ids);
         }
       }
+      if (range_conflict) {
+        stripe->num_range_waiters--;
+        range_conflict = false;
+      }
 
       if (result.IsTimedOut()) {
           timed_out = true;
@@ -402,11 +511,14 @@ Status TransactionLockMgr::AcquireWithTimeout(
 
       if (result.ok() || result.IsTimedOut()) {
         result = AcquireLocked(lock_map, stripe, key, env, std::move(lock_info),
-                               &expire_time_hint, &wait_ids);
+                               &expire_time_hint, &wait_ids, &range_conflict);
       }
     } while (!result.ok() && !timed_out);
   }
 
+  if (range_conflict) {
+    stripe->num_range_waiters--;
+  }
   stripe->stripe_mutex->UnLock();
 
   return result;
@@ -415,25 +527,33 @@ Status TransactionLockMgr::AcquireWithTimeout(
 void TransactionLockMgr::DecrementWaiters(
     const PessimisticTransaction* txn,
     const autovector<TransactionID>& wait_ids) {
-  std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
-  DecrementWaitersImpl(txn, wait_ids);
-}
-
-void TransactionLockMgr::DecrementWaitersImpl(
-    const PessimisticTransaction* txn,
-    const autovector<TransactionID>& wait_ids) {
   auto id = txn->GetID();
-  assert(wait_txn_map_.Contains(id));
-  wait_txn_map_.Delete(id);
+  {
+    WaitTxnShard& shard = GetWaitTxnShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    assert(shard.wait_txn_map.Contains(id));
+    shard.wait_txn_map.Delete(id);
+  }
 
   for (auto wait_id : wait_ids) {
-    rev_wait_txn_map_.Get(wait_id)--;
-    if (rev_wait_txn_map_.Get(wait_id) == 0) {
-      rev_wait_txn_map_.Delete(wait_id);
+    WaitTxnShard& shard = GetWaitTxnShard(wait_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.rev_wait_txn_map.Get(wait_id)--;
+    if (shard.rev_wait_txn_map.Get(wait_id) == 0) {
+      shard.rev_wait_txn_map.Delete(wait_id);
     }
   }
 }
 
+// Adds the edges from txn to wait_ids to the wait-for graph, and searches
+// the graph for a cycle back to txn.  Only one shard of the graph is locked
+// at a time, so the search can see edges that never coexisted, or miss ones
+// added meanwhile.  A cycle is still always found: each waiter adds its own
+// edges, then counts itself as a waiter of the transactions it waits for,
+// and only then checks whether anyone waits for it.  The last waiter of a
+// cycle to count itself thus sees the count of the waiter before it, and
+// searches once all the edges of the cycle are in, none of which is removed
+// before the cycle is broken.
 bool TransactionLockMgr::IncrementWaiters(
     const PessimisticTransaction* txn,
     const autovector<TransactionID>& wait_ids, const std::string& key,
@@ -441,24 +561,39 @@ bool TransactionLockMgr::IncrementWaiters(
   auto id = txn->GetID();
   std::vector<int> queue_parents(static_cast<size_t>(txn->GetDeadlockDetectDepth()));
   std::vector<TransactionID> queue_values(static_cast<size_t>(txn->GetDeadlockDetectDepth()));
-  std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
-  assert(!wait_txn_map_.Contains(id));
 
-  wait_txn_map_.Insert(id, {wait_ids, cf_id, exclusive, key});
+  {
+    WaitTxnShard& shard = GetWaitTxnShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    assert(!shard.wait_txn_map.Contains(id));
+    shard.wait_txn_map.Insert(id, {wait_ids, cf_id, exclusive, key});
+  }
 
   for (auto wait_id : wait_ids) {
-    if (rev_wait_txn_map_.Contains(wait_id)) {
-      rev_wait_txn_map_.Get(wait_id)++;
+    WaitTxnShard& shard = GetWaitTxnShard(wait_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.rev_wait_txn_map.Contains(wait_id)) {
+      shard.rev_wait_txn_map.Get(wait_id)++;
     } else {
-      rev_wait_txn_map_.Insert(wait_id, 1);
+      shard.rev_wait_txn_map.Insert(wait_id, 1);
     }
   }
 
-  // No deadlock if nobody is waiting on self.
-  if (!rev_wait_txn_map_.Contains(id)) {
+  // No deadlock if nobody is waiting on self.  A transaction that starts
+  // waiting on self later finds the edges added above in its own search.
+  bool has_waiters;
+  {
+    WaitTxnShard& shard = GetWaitTxnShard(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    has_waiters = shard.rev_wait_txn_map.Contains(id);
+  }
+  if (!has_waiters) {
     return false;
   }
 
+  // Copy of the edges of the transaction last taken from the queue, as they
+  // can change once its shard is unlocked
+  autovector<TransactionID> neighbors;
   const auto* next_ids = &wait_ids;
   int parent = -1;
   int64_t deadlock_time = 0;
@@ -482,50 +617,75 @@ bool TransactionLockMgr::IncrementWaiters(
     auto next = queue_values[head];
     if (next == id) {
       std::vector<DeadlockInfo> path;
-      while (head != -1) {
-        assert(wait_txn_map_.Contains(queue_values[head]));
-
-        auto extracted_info = wait_txn_map_.Get(queue_values[head]);
-        path.push_back({queue_values[head], extracted_info.m_cf_id,
+      bool broken = false;
+      for (int j = head; j != -1; j = queue_parents[j]) {
+        WaitTxnShard& shard = GetWaitTxnShard(queue_values[j]);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!shard.wait_txn_map.Contains(queue_values[j])) {
+          // A transaction of the cycle stopped waiting meanwhile
+          broken = true;
+          break;
+        }
+        auto& extracted_info = shard.wait_txn_map.Get(queue_values[j]);
+        path.push_back({queue_values[j], extracted_info.m_cf_id,
                         extracted_info.m_exclusive,
                         extracted_info.m_waiting_key});
-        head = queue_parents[head];
+      }
+      if (broken) {
+        next_ids = nullptr;
+        continue;
       }
       env->GetCurrentTime(&deadlock_time);
       std::reverse(path.begin(), path.end());
       dlock_buffer_.AddNewPath(DeadlockPath(path, deadlock_time));
       deadlock_time = 0;
-      DecrementWaitersImpl(txn, wait_ids);
+      DecrementWaiters(txn, wait_ids);
       return true;
-    } else if (!wait_txn_map_.Contains(next)) {
+    }
+
+    WaitTxnShard& shard = GetWaitTxnShard(next);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (!shard.wait_txn_map.Contains(next)) {
       next_ids = nullptr;
-      continue;
     } else {
       parent = head;
-      next_ids = &(wait_txn_map_.Get(next).m_neighbors);
+      neighbors = shard.wait_txn_map.Get(next).m_neighbors;
+      next_ids = &neighbors;
     }
   }
 
   // Wait cycle too big, just assume deadlock.
   env->GetCurrentTime(&deadlock_time);
   dlock_buffer_.AddNewPath(DeadlockPath(deadlock_time, true));
-  DecrementWaitersImpl(txn, wait_ids);
+  DecrementWaiters(txn, wait_ids);
   return true;
 }
 
 // Try to lock this key after we have acquired the mutex.
 // Sets *expire_time to the expiration time in microseconds
 //  or 0 if no expiration.
+// Sets *range_conflict if a range lock is in the way, see CheckRangeLocks().
 // REQUIRED:  Stripe mutex must be held.
 Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
                                          LockMapStripe* stripe,
                                          const std::string& key, Env* env,
                                          LockInfo&& txn_lock_info,
                                          uint64_t* expire_time,
-                                         autovector<TransactionID>* txn_ids) {
+                                         autovector<TransactionID>* txn_ids,
+                                         bool* range_conflict) {
   assert(txn_lock_info.txn_ids.size() == 1);
 
   Status result;
+  // Check if this key is covered by a range lock.  A range lock that was
+  // added after this read checks this stripe for the key later on.
+  if (lock_map->num_range_locks.load(std::memory_order_acquire) > 0) {
+    result = CheckRangeLocks(lock_map, stripe, key, env, txn_lock_info,
+                             expire_time, txn_ids, range_conflict);
+    if (!result.ok()) {
+      return result;
+    }
+  }
+
   // Check if this key is already locked
   auto stripe_iter = stripe->keys.find(key);
   if (stripe_iter != stripe->keys.end()) {
@@ -572,7 +732,11 @@ Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
       result = Status::Busy(Status::SubCode::kLockLimit);
     } else {
       // acquire lock
-      stripe->keys.emplace(key, std::move(txn_lock_info));
+      auto added = stripe->keys.emplace(key, std::move(txn_lock_info));
+      if (stripe->ordered_keys_valid) {
+        stripe->ordered_keys.emplace(&added.first->first,
+                                     &added.first->second);
+      }
 
       // Maintain lock count if there is a limit on the number of locks
       if (max_num_locks_) {
@@ -584,6 +748,194 @@ Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
   return result;
 }
 
+// Check if a range lock of another transaction covers this key.
+// Sets *expire_time and *txn_ids like AcquireLocked().  A pending range lock
+// is waited for without a transaction to wait for in *txn_ids, as it is not
+// held yet.  If a range lock is in the way, sets *range_conflict and counts
+// the caller in stripe->num_range_waiters, which the caller has to undo.
+// REQUIRED:  Stripe mutex of the key must be held.
+Status TransactionLockMgr::CheckRangeLocks(LockMap* lock_map,
+                                           LockMapStripe* stripe,
+                                           const std::string& key, Env* env,
+                                           const LockInfo& txn_lock_info,
+                                           uint64_t* expire_time,
+                                           autovector<TransactionID>* txn_ids,
+                                           bool* range_conflict) {
+  const Comparator* cmp = lock_map->comparator_;
+  TransactionID txn_id = txn_lock_info.txn_ids[0];
+
+  Status result = lock_map->range_mutex->Lock();
+  if (!result.ok()) {
+    return result;
+  }
+
+  for (const auto& range : lock_map->range_locks) {
+    const LockInfo& lock_info = range.lock_info;
+    if (lock_info.txn_ids[0] == txn_id ||
+        (!lock_info.exclusive && !txn_lock_info.exclusive) ||
+        cmp->Compare(key, range.begin) < 0 ||
+        cmp->Compare(key, range.end) >= 0) {
+      continue;
+    }
+    if (range.pending) {
+      result = Status::TimedOut(Status::SubCode::kLockTimeout);
+      txn_ids->clear();
+      break;
+    }
+    if (!IsLockExpired(txn_id, lock_info, env, expire_time)) {
+      result = Status::TimedOut(Status::SubCode::kLockTimeout);
+      *txn_ids = lock_info.txn_ids;
+      break;
+    }
+  }
+  if (!result.ok()) {
+    // Counted while holding range_mutex, so that the range lock is not
+    // granted or removed without signaling this stripe
+    stripe->num_range_waiters++;
+    *range_conflict = true;
+  }
+
+  lock_map->range_mutex->UnLock();
+  return result;
+}
+
+// Returns true if lock_info, the lock of other transactions, conflicts with
+// txn_lock_info and has not expired.  Sets *txn_ids to the other
+// transactions, and *expire_time like AcquireLocked().
+bool TransactionLockMgr::IsConflictingLock(const LockInfo& txn_lock_info,
+                                           const LockInfo& lock_info, Env* env,
+                                           uint64_t* expire_time,
+                                           autovector<TransactionID>* txn_ids) {
+  if (!lock_info.exclusive && !txn_lock_info.exclusive) {
+    return false;
+  }
+  TransactionID txn_id = txn_lock_info.txn_ids[0];
+  txn_ids->clear();
+  for (auto id : lock_info.txn_ids) {
+    if (id != txn_id) {
+      txn_ids->push_back(id);
+    }
+  }
+  return !txn_ids->empty() &&
+         !IsLockExpired(txn_id, lock_info, env, expire_time);
+}
+
+// Add [begin, end) as a pending range lock, unless an overlapping range lock
+// of another transaction conflicts with it.  Sets *expire_time and *txn_ids
+// like AcquireLocked(), with *txn_ids left empty if the conflicting range
+// lock is pending.
+// REQUIRED:  range_mutex must be held.
+Status TransactionLockMgr::AddPendingRangeLocked(
+    LockMap* lock_map, const std::string& begin, const std::string& end,
+    Env* env, const LockInfo& txn_lock_info, uint64_t* expire_time,
+    autovector<TransactionID>* txn_ids) {
+  const Comparator* cmp = lock_map->comparator_;
+  TransactionID txn_id = txn_lock_info.txn_ids[0];
+
+  for (const auto& range : lock_map->range_locks) {
+    if (cmp->Compare(range.begin, end) >= 0 ||
+        cmp->Compare(begin, range.end) >= 0) {
+      continue;
+    }
+    if (range.pending) {
+      if (range.lock_info.txn_ids[0] != txn_id &&
+          (range.lock_info.exclusive || txn_lock_info.exclusive)) {
+        txn_ids->clear();
+        return Status::TimedOut(Status::SubCode::kLockTimeout);
+      }
+    } else if (IsConflictingLock(txn_lock_info, range.lock_info, env,
+                                 expire_time, txn_ids)) {
+      return Status::TimedOut(Status::SubCode::kLockTimeout);
+    }
+  }
+
+  txn_ids->clear();
+  lock_map->range_locks.emplace_back(begin, end, txn_lock_info);
+  lock_map->num_range_locks.fetch_add(1, std::memory_order_release);
+  return Status::OK();
+}
+
+// Check the point locks in [begin, end) for a pending range lock, one
+// stripe at a time, looking only at the keys in the range.  Sets
+// *expire_time and *txn_ids like AcquireLocked(), and on a conflict,
+// *range_cv_seq to LockMap::range_cv_seq as of finding it.  Expired point
+// locks are left in place; a transaction that steals them later will find
+// the range lock instead.
+// REQUIRED:  No mutex of lock_map may be held.
+Status TransactionLockMgr::CheckPointLocksInRange(
+    LockMap* lock_map, const std::string& begin, const std::string& end,
+    Env* env, const LockInfo& txn_lock_info, uint64_t* expire_time,
+    autovector<TransactionID>* txn_ids, uint64_t* range_cv_seq) {
+  const Comparator* cmp = lock_map->comparator_;
+
+  for (auto stripe : lock_map->lock_map_stripes_) {
+    Status s = stripe->stripe_mutex->Lock();
+    if (!s.ok()) {
+      return s;
+    }
+    stripe->IndexKeys();
+    for (auto it = stripe->ordered_keys.lower_bound(&begin);
+         it != stripe->ordered_keys.end() && cmp->Compare(*it->first, end) < 0;
+         ++it) {
+      if (IsConflictingLock(txn_lock_info, *it->second, env, expire_time,
+                            txn_ids)) {
+        // The unlock of this key signals range_cv only after taking the
+        // stripe mutex, and so after this read
+        *range_cv_seq = lock_map->range_cv_seq.load();
+        stripe->stripe_mutex->UnLock();
+        return Status::TimedOut(Status::SubCode::kLockTimeout);
+      }
+    }
+    stripe->stripe_mutex->UnLock();
+  }
+
+  txn_ids->clear();
+  return Status::OK();
+}
+
+// Signal the threads waiting on a key of this stripe, or on a range of this
+// column family, to retry locking.
+// REQUIRED:  No mutex of lock_map may be held.
+void TransactionLockMgr::NotifyWaiters(LockMap* lock_map,
+                                       LockMapStripe* stripe) {
+  if (stripe->num_waiters.load(std::memory_order_acquire) > 0) {
+    stripe->stripe_cv->NotifyAll();
+  }
+  if (lock_map->num_range_waiters.load(std::memory_order_acquire) > 0) {
+    // Taking range_mutex makes sure that a range waiter which found the key
+    // before registering the sequence number is told about this unlock.
+    lock_map->range_mutex->Lock();
+    lock_map->range_cv_seq++;
+    lock_map->range_cv->NotifyAll();
+    lock_map->range_mutex->UnLock();
+  }
+}
+
+// Signal the threads waiting for a range lock that was just granted or
+// removed, and unlock range_mutex.  A point waiter that found the range lock
+// counted itself in its stripe's num_range_waiters under range_mutex, and
+// only releases the stripe mutex once waiting, so taking the stripe mutex
+// before signaling makes sure that it is signaled.
+// REQUIRED:  range_mutex must be held, and no stripe mutex of lock_map.
+void TransactionLockMgr::NotifyRangeChangeAndUnLock(LockMap* lock_map) {
+  if (lock_map->num_range_waiters.load(std::memory_order_acquire) > 0) {
+    lock_map->range_cv->NotifyAll();
+  }
+  autovector<LockMapStripe*> stripes;
+  for (auto stripe : lock_map->lock_map_stripes_) {
+    if (stripe->num_range_waiters.load(std::memory_order_acquire) > 0) {
+      stripes.push_back(stripe);
+    }
+  }
+  lock_map->range_mutex->UnLock();
+
+  for (auto stripe : stripes) {
+    stripe->stripe_mutex->Lock();
+    stripe->stripe_mutex->UnLock();
+    stripe->stripe_cv->NotifyAll();
+  }
+}
+
 void TransactionLockMgr::UnLockKey(const PessimisticTransaction* txn,
                                    const std::string& key,
                                    LockMapStripe* stripe, LockMap* lock_map,
@@ -600,6 +952,9 @@ void TransactionLockMgr::UnLockKey(const PessimisticTransaction* txn,
     // Found the key we locked.  unlock it.
     if (txn_it != txns.end()) {
       if (txns.size() == 1) {
+        if (stripe->ordered_keys_valid) {
+          stripe->ordered_keys.erase(&stripe_iter->first);
+        }
         stripe->keys.erase(stripe_iter);
       } else {
         auto last_it = txns.end() - 1;
@@ -643,7 +998,7 @@ void TransactionLockMgr::UnLock(PessimisticTransaction* txn,
   stripe->stripe_mutex->UnLock();
 
   // Signal waiting threads to retry locking
-  stripe->stripe_cv->NotifyAll();
+  NotifyWaiters(lock_map, stripe);
 }
 
 void TransactionLockMgr::UnLock(const PessimisticTransaction* txn,
@@ -660,39 +1015,212 @@ void TransactionLockMgr::UnLock(const PessimisticTransaction* txn,
       return;
     }
 
-    // Bucket keys by lock_map_ stripe
-    std::unordered_map<size_t, std::vector<const std::string*>> keys_by_stripe(
-        std::max(keys.size(), lock_map->num_stripes_));
+    // Bucket keys by lock_map_ stripe.  Sorting a flat vector needs a single
+    // allocation, unlike a map of per-stripe vectors.
+    std::vector<std::pair<size_t, const std::string*>> keys_by_stripe;
+    keys_by_stripe.reserve(keys.size());
 
     for (auto& key_iter : keys) {
       const std::string& key = key_iter.first;
-
-      size_t stripe_num = lock_map->GetStripe(key);
-      keys_by_stripe[stripe_num].push_back(&key);
+      keys_by_stripe.emplace_back(lock_map->GetStripe(key), &key);
     }
+    std::sort(keys_by_stripe.begin(), keys_by_stripe.end());
 
     // For each stripe, grab the stripe mutex and unlock all keys in this stripe
-    for (auto& stripe_iter : keys_by_stripe) {
-      size_t stripe_num = stripe_iter.first;
-      auto& stripe_keys = stripe_iter.second;
+    for (size_t i = 0; i < keys_by_stripe.size();) {
+      size_t stripe_num = keys_by_stripe[i].first;
 
       assert(lock_map->lock_map_stripes_.size() > stripe_num);
       LockMapStripe* stripe = lock_map->lock_map_stripes_.at(stripe_num);
 
       stripe->stripe_mutex->Lock();
 
-      for (const std::string* key : stripe_keys) {
-        UnLockKey(txn, *key, stripe, lock_map, env);
+      for (; i < keys_by_stripe.size() && keys_by_stripe[i].first == stripe_num;
+           i++) {
+        UnLockKey(txn, *keys_by_stripe[i].second, stripe, lock_map, env);
       }
 
       stripe->stripe_mutex->UnLock();
 
       // Signal waiting threads to retry locking
-      stripe->stripe_cv->NotifyAll();
+      NotifyWaiters(lock_map, stripe);
     }
   }
 }
 
+Status TransactionLockMgr::TryRangeLock(PessimisticTransaction* txn,
+                                        uint32_t column_family_id,
+                                        const std::string& begin,
+                                        const std::string& end, Env* env,
+                                        bool exclusive) {
+  // Lookup lock map for this column family id
+  std::shared_ptr<LockMap> lock_map_ptr = GetLockMap(column_family_id);
+  LockMap* lock_map = lock_map_ptr.get();
+  if (lock_map == nullptr) {
+    char msg[255];
+    snprintf(msg, sizeof(msg), "Column family id not found: %" PRIu32,
+             column_family_id);
+
+    return Status::InvalidArgument(msg);
+  }
+  if (lock_map->comparator_->Compare(begin, end) >= 0) {
+    return Status::InvalidArgument("Range lock must have begin < end");
+  }
+
+  LockInfo lock_info(txn->GetID(), txn->GetExpirationTime(), exclusive);
+  int64_t timeout = txn->GetLockTimeout();
+  uint64_t end_time = 0;
+
+  if (timeout > 0) {
+    uint64_t start_time = env->NowMicros();
+    end_time = start_time + timeout;
+  }
+
+  // The range lock is first added as pending, which keeps new point locks out
+  // of the range, and then the stripes are checked one at a time for point
+  // locks in the range.  If one is in the way, the range lock is removed
+  // again, and the wait happens on range_cv, which point unlocks in this
+  // column family signal while there are range waiters.
+  Status result;
+  bool timed_out = false;
+  while (true) {
+    result = lock_map->range_mutex->Lock();
+    if (!result.ok()) {
+      return result;
+    }
+
+    bool may_wait = timeout != 0 && !timed_out;
+    if (may_wait) {
+      // Register before looking for point locks, so that no unlock of one
+      // can miss us.
+      lock_map->num_range_waiters++;
+    }
+    uint64_t expire_time_hint = 0;
+    autovector<TransactionID> wait_ids;
+    uint64_t wait_seq = lock_map->range_cv_seq.load();
+    result = AddPendingRangeLocked(lock_map, begin, end, env, lock_info,
+                                   &expire_time_hint, &wait_ids);
+    if (result.ok()) {
+      lock_map->range_mutex->UnLock();
+      TEST_SYNC_POINT("TransactionLockMgr::TryRangeLock:Pending");
+      result = CheckPointLocksInRange(lock_map, begin, end, env, lock_info,
+                                      &expire_time_hint, &wait_ids,
+                                      &wait_seq);
+
+      // Grant the pending range lock, or give it up
+      lock_map->range_mutex->Lock();
+      auto& range_locks = lock_map->range_locks;
+      for (auto it = range_locks.begin(); it != range_locks.end(); ++it) {
+        if (it->pending && it->lock_info.txn_ids[0] == txn->GetID() &&
+            it->begin == begin && it->end == end) {
+          if (result.ok()) {
+            it->pending = false;
+          } else {
+            range_locks.erase(it);
+            lock_map->num_range_locks.fetch_sub(1, std::memory_order_release);
+          }
+          break;
+        }
+      }
+      NotifyRangeChangeAndUnLock(lock_map);
+      lock_map->range_mutex->Lock();
+    }
+
+    // Only a lock in the way is waited out, not a failure to lock a mutex.
+    if (result.ok() || !may_wait || !result.IsTimedOut()) {
+      if (may_wait) {
+        lock_map->num_range_waiters--;
+      }
+      lock_map->range_mutex->UnLock();
+      break;
+    }
+
+    PERF_COUNTER_ADD(key_lock_wait_count, 1);
+
+    // Decide how long to wait
+    int64_t cv_end_time = -1;
+    if (expire_time_hint > 0 &&
+        (timeout < 0 || (timeout > 0 && expire_time_hint < end_time))) {
+      cv_end_time = expire_time_hint;
+    } else if (timeout >= 0) {
+      cv_end_time = end_time;
+    }
+
+    // A pending range lock is not held by any transaction yet.
+    if (wait_ids.size() != 0) {
+      if (txn->IsDeadlockDetect() &&
+          IncrementWaiters(txn, wait_ids, begin, column_family_id, exclusive,
+                           env)) {
+        lock_map->num_range_waiters--;
+        lock_map->range_mutex->UnLock();
+        return Status::Busy(Status::SubCode::kDeadlock);
+      }
+      txn->SetWaitingTxn(wait_ids, column_family_id, &begin);
+    }
+
+    TEST_SYNC_POINT("TransactionLockMgr::TryRangeLock:WaitingTxn");
+    Status wait_result;
+    if (lock_map->range_cv_seq.load() != wait_seq) {
+      // A point unlock signaled range_cv since the point lock in the way was
+      // found, so retry right away.
+    } else if (cv_end_time < 0) {
+      // Wait indefinitely
+      wait_result = lock_map->range_cv->Wait(lock_map->range_mutex);
+    } else {
+      uint64_t now = env->NowMicros();
+      if (static_cast<uint64_t>(cv_end_time) > now) {
+        wait_result = lock_map->range_cv->WaitFor(lock_map->range_mutex,
+                                                  cv_end_time - now);
+      } else {
+        wait_result = Status::TimedOut(Status::SubCode::kLockTimeout);
+      }
+    }
+    lock_map->num_range_waiters--;
+
+    if (wait_ids.size() != 0) {
+      txn->ClearWaitingTxn();
+      if (txn->IsDeadlockDetect()) {
+        DecrementWaiters(txn, wait_ids);
+      }
+    }
+    lock_map->range_mutex->UnLock();
+
+    if (wait_result.IsTimedOut()) {
+      // Make one more attempt, as for point locks.
+      timed_out = true;
+    } else if (!wait_result.ok()) {
+      return wait_result;
+    }
+  }
+
+  return result;
+}
+
+void TransactionLockMgr::UnLockRange(const PessimisticTransaction* txn,
+                                     uint32_t column_family_id,
+                                     const std::string& begin,
+                                     const std::string& end) {
+  std::shared_ptr<LockMap> lock_map_ptr = GetLockMap(column_family_id);
+  LockMap* lock_map = lock_map_ptr.get();
+  if (lock_map == nullptr) {
+    // Column Family must have been dropped.
+    return;
+  }
+
+  lock_map->range_mutex->Lock();
+  auto& range_locks = lock_map->range_locks;
+  for (auto it = range_locks.begin(); it != range_locks.end(); ++it) {
+    if (!it->pending && it->lock_info.txn_ids[0] == txn->GetID() &&
+        it->begin == begin && it->end == end) {
+      range_locks.erase(it);
+      lock_map->num_range_locks.fetch_sub(1, std::memory_order_release);
+      break;
+    }
+  }
+  // Signal waiting threads to retry locking
+  NotifyRangeChangeAndUnLock(lock_map);
+}
+
 TransactionLockMgr::LockStatusData TransactionLockMgr::GetLockStatusData() {
   LockStatusData data;
   // Lock order here is important. The correct order is lock_map_mutex_, then
@@ -721,6 +1249,24 @@ TransactionLockMgr::LockStatusData TransactionLockMgr::GetLockStatusData() {
         data.insert({i, info});
       }
     }
+    // range_mutex comes after the stripe mutexes of its column family.
+    LockMap* lock_map = lock_maps_[i].get();
+    lock_map->range_mutex->Lock();
+    for (const auto& range_lock : lock_map->range_locks) {
+      if (range_lock.pending) {
+        continue;
+      }
+      struct KeyLockInfo info;
+      info.exclusive = range_lock.lock_info.exclusive;
+      info.key = range_lock.begin;
+      info.is_range_lock = true;
+      info.end_key = range_lock.end;
+      for (const auto& id : range_lock.lock_info.txn_ids) {
+        info.ids.push_back(id);
+      }
+      data.insert({i, info});
+    }
+    lock_map->range_mutex->UnLock();
   }
 
   // Unlock everything. Unlocking order is not important.
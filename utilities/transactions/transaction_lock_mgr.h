@@ -65,7 +65,7 @@ class TransactionLockMgr {
 
   // Creates a new LockMap for this column family.  Caller should guarantee
   // that this column family does not already exist.
-  void AddColumnFamily(uint32_t column_family_id);
+  void AddColumnFamily(const ColumnFamilyHandle* column_family);
 
   // Deletes the LockMap for this column family.  Caller should guarantee that
   // this column family is no longer in use.
@@ -83,6 +83,20 @@ class TransactionLockMgr {
   void UnLock(PessimisticTransaction* txn, uint32_t column_family_id,
               const std::string& key, Env* env);
 
+  // Attempt to lock all the keys in [begin, end), as ordered by the column
+  // family's comparator, including the keys that do not exist yet.  Conflicts
+  // with the point and range locks of other transactions that overlap the
+  // range.  If OK status is returned, the caller is responsible for calling
+  // UnLockRange() with the same range.
+  Status TryRangeLock(PessimisticTransaction* txn, uint32_t column_family_id,
+                      const std::string& begin, const std::string& end,
+                      Env* env, bool exclusive);
+
+  // Unlock a range locked by TryRangeLock().
+  void UnLockRange(const PessimisticTransaction* txn,
+                   uint32_t column_family_id, const std::string& begin,
+                   const std::string& end);
+
   using LockStatusData = std::unordered_multimap<uint32_t, KeyLockInfo>;
   LockStatusData GetLockStatusData();
   std::vector<DeadlockPath> GetDeadlockInfoBuffer();
@@ -101,7 +115,8 @@ class TransactionLockMgr {
   // ourselves.
   //   - lock_map_mutex_
   //   - stripe mutexes in ascending cf id, ascending stripe order
-  //   - wait_txn_map_mutex_
+  //   - LockMap::range_mutex
+  //   - the mutex of a single WaitTxnShard
   //
   // Must be held when accessing/modifying lock_maps_.
   InstrumentedMutex lock_map_mutex_;
@@ -114,13 +129,19 @@ class TransactionLockMgr {
   // to avoid acquiring a mutex in order to look up a LockMap
   std::unique_ptr<ThreadLocalPtr> lock_maps_cache_;
 
-  // Must be held when modifying wait_txn_map_ and rev_wait_txn_map_.
-  std::mutex wait_txn_map_mutex_;
-
-  // Maps from waitee -> number of waiters.
-  HashMap<TransactionID, int> rev_wait_txn_map_;
-  // Maps from waiter -> waitee.
-  HashMap<TransactionID, TrackedTrxInfo> wait_txn_map_;
+  // A partition of the wait-for graph, holding the transactions whose id maps
+  // to it.  Deadlock detection only ever holds one partition's mutex, so
+  // waiters in different partitions do not contend.
+  struct WaitTxnShard {
+    // Must be held when accessing wait_txn_map and rev_wait_txn_map.
+    std::mutex mutex;
+    // Maps from waitee -> number of waiters.
+    HashMap<TransactionID, int, 31> rev_wait_txn_map;
+    // Maps from waiter -> waitee.
+    HashMap<TransactionID, TrackedTrxInfo, 31> wait_txn_map;
+  };
+  static const size_t kNumWaitTxnShards = 16;
+  WaitTxnShard wait_txn_shards_[kNumWaitTxnShards];
   DeadlockInfoBuffer dlock_buffer_;
 
   // Used to allocate mutexes/condvars to use when locking keys
@@ -129,6 +150,10 @@ class TransactionLockMgr {
   bool IsLockExpired(TransactionID txn_id, const LockInfo& lock_info, Env* env,
                      uint64_t* wait_time);
 
+  WaitTxnShard& GetWaitTxnShard(TransactionID txn_id) {
+    return wait_txn_shards_[txn_id % kNumWaitTxnShards];
+  }
+
   std::shared_ptr<LockMap> GetLockMap(uint32_t column_family_id);
 
   Status AcquireWithTimeout(PessimisticTransaction* txn, LockMap* lock_map,
@@ -139,19 +164,44 @@ class TransactionLockMgr {
   Status AcquireLocked(LockMap* lock_map, LockMapStripe* stripe,
                        const std::string& key, Env* env,
                        LockInfo&& lock_info, uint64_t* wait_time,
-                       autovector<TransactionID>* txn_ids);
+                       autovector<TransactionID>* txn_ids,
+                       bool* range_conflict);
+
+  Status CheckRangeLocks(LockMap* lock_map, LockMapStripe* stripe,
+                         const std::string& key, Env* env,
+                         const LockInfo& lock_info, uint64_t* wait_time,
+                         autovector<TransactionID>* txn_ids,
+                         bool* range_conflict);
+
+  bool IsConflictingLock(const LockInfo& txn_lock_info,
+                         const LockInfo& lock_info, Env* env,
+                         uint64_t* wait_time,
+                         autovector<TransactionID>* txn_ids);
+
+  Status AddPendingRangeLocked(LockMap* lock_map, const std::string& begin,
+                              const std::string& end, Env* env,
+                              const LockInfo& lock_info, uint64_t* wait_time,
+                              autovector<TransactionID>* txn_ids);
+
+  Status CheckPointLocksInRange(LockMap* lock_map, const std::string& begin,
+                                const std::string& end, Env* env,
+                                const LockInfo& lock_info, uint64_t* wait_time,
+                                autovector<TransactionID>* txn_ids,
+                                uint64_t* range_cv_seq);
+
+  void NotifyRangeChangeAndUnLock(LockMap* lock_map);
 
   void UnLockKey(const PessimisticTransaction* txn, const std::string& key,
                  LockMapStripe* stripe, LockMap* lock_map, Env* env);
 
+  void NotifyWaiters(LockMap* lock_map, LockMapStripe* stripe);
+
   bool IncrementWaiters(const PessimisticTransaction* txn,
                         const autovector<TransactionID>& wait_ids,
                         const std::string& key, const uint32_t& cf_id,
                         const bool& exclusive, Env* const env);
   void DecrementWaiters(const PessimisticTransaction* txn,
                         const autovector<TransactionID>& wait_ids);
-  void DecrementWaitersImpl(const PessimisticTransaction* txn,
-                            const autovector<TransactionID>& wait_ids);
 };
 
 }  //  namespace rocksdb
@@ -0,0 +1,199 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#if !defined(GFLAGS) || defined(ROCKSDB_LITE)
+#include <cstdio>
+int main() {
+#ifndef GFLAGS
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+#else
+  fprintf(stderr, "Transactions are not supported in ROCKSDB_LITE\n");
+#endif
+  return 1;
+}
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/utilities/transaction_db.h"
+#include "util/gflags_compat.h"
+#include "util/string_util.h"
+#include "utilities/transactions/pessimistic_transaction.h"
+#include "utilities/transactions/transaction_db_mutex_impl.h"
+#include "utilities/transactions/transaction_lock_mgr.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_string(db, "", "Directory of the TransactionDB whose transactions "
+              "take the locks; a test directory by default");
+
+DEFINE_string(threads, "1,2,4,8,16",
+              "Comma-separated numbers of threads to measure");
+
+DEFINE_string(workload, "distinct",
+              "distinct: each thread locks keys of its own; "
+              "shared_hot: all threads take a shared lock on one key; "
+              "exclusive_hot: all threads take an exclusive lock on one key, "
+              "waiting for each other");
+
+DEFINE_int32(locks_per_thread, 200000,
+             "Number of lock/unlock pairs done by each thread");
+
+DEFINE_int32(keys_per_thread, 100,
+             "Number of distinct keys locked by each thread in the distinct "
+             "workload");
+
+DEFINE_int32(range_lock_every, 0,
+             "If positive, each thread also takes and releases a range lock "
+             "over its own keys every this many point locks");
+
+DEFINE_int32(num_stripes, 16, "Number of lock stripes of the column family");
+
+DEFINE_int64(lock_timeout_ms, 1000, "Lock timeout of the transactions");
+
+DEFINE_bool(deadlock_detect, false,
+            "Enable deadlock detection for the transactions");
+
+namespace rocksdb {
+
+namespace {
+
+struct Result {
+  uint64_t elapsed_micros = 0;
+  uint64_t num_locks = 0;
+  uint64_t num_failed = 0;
+};
+
+Result Run(TransactionDB* db, TransactionLockMgr* lock_mgr, int num_threads) {
+  Env* env = Env::Default();
+  TransactionOptions txn_opt;
+  txn_opt.lock_timeout = FLAGS_lock_timeout_ms;
+  txn_opt.deadlock_detect = FLAGS_deadlock_detect;
+
+  bool hot = FLAGS_workload != "distinct";
+  bool exclusive = FLAGS_workload != "shared_hot";
+  std::vector<std::unique_ptr<Transaction>> txns;
+  std::vector<std::vector<std::string>> keys(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    txns.emplace_back(db->BeginTransaction(WriteOptions(), txn_opt));
+    for (int j = 0; j < (hot ? 1 : FLAGS_keys_per_thread); j++) {
+      // Fixed width, so that the keys of a thread are in [prefix, prefix~)
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%06d_%08d", hot ? 0 : i, j);
+      keys[i].push_back(buf);
+    }
+  }
+
+  std::atomic<uint64_t> num_failed(0);
+  uint64_t start = env->NowMicros();
+  std::vector<port::Thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i]() {
+      auto txn = reinterpret_cast<PessimisticTransaction*>(txns[i].get());
+      const std::vector<std::string>& thread_keys = keys[i];
+      std::string range_begin = thread_keys[0].substr(0, 6) + "_";
+      std::string range_end = thread_keys[0].substr(0, 6) + "~";
+      uint64_t failed = 0;
+      for (int j = 0; j < FLAGS_locks_per_thread; j++) {
+        const std::string& key = thread_keys[j % thread_keys.size()];
+        if (lock_mgr->TryLock(txn, 0, key, env, exclusive).ok()) {
+          lock_mgr->UnLock(txn, 0, key, env);
+        } else {
+          failed++;
+        }
+        if (FLAGS_range_lock_every > 0 &&
+            (j + 1) % FLAGS_range_lock_every == 0) {
+          if (lock_mgr->TryRangeLock(txn, 0, range_begin, range_end, env,
+                                     exclusive)
+                  .ok()) {
+            lock_mgr->UnLockRange(txn, 0, range_begin, range_end);
+          } else {
+            failed++;
+          }
+        }
+      }
+      num_failed += failed;
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  Result result;
+  result.elapsed_micros = std::max<uint64_t>(env->NowMicros() - start, 1);
+  result.num_locks =
+      static_cast<uint64_t>(num_threads) * FLAGS_locks_per_thread;
+  result.num_failed = num_failed.load();
+  return result;
+}
+
+}  // anonymous namespace
+
+int TransactionLockMgrBench() {
+  Env* env = Env::Default();
+  std::string db_path = FLAGS_db;
+  if (db_path.empty()) {
+    env->GetTestDirectory(&db_path);
+    db_path += "/transaction_lock_mgr_bench";
+  }
+  Options options;
+  options.create_if_missing = true;
+  TransactionDB* db = nullptr;
+  Status s = TransactionDB::Open(options, TransactionDBOptions(), db_path, &db);
+  if (!s.ok()) {
+    fprintf(stderr, "Failed to open %s: %s\n", db_path.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+
+  {
+    // A lock manager of its own, so that only the locks of the benchmark are
+    // in it
+    TransactionLockMgr lock_mgr(
+        db, FLAGS_num_stripes, 0 /* max_num_locks */,
+        0 /* max_num_deadlocks */,
+        std::make_shared<TransactionDBMutexFactoryImpl>());
+    lock_mgr.AddColumnFamily(db->DefaultColumnFamily());
+
+    fprintf(stdout, "workload: %s, stripes: %d, range lock every: %d\n",
+            FLAGS_workload.c_str(), FLAGS_num_stripes,
+            FLAGS_range_lock_every);
+    fprintf(stdout, "%8s %16s %12s %10s\n", "threads", "lock+unlock/s",
+            "micros/op", "failed");
+    for (const std::string& threads : StringSplit(FLAGS_threads, ',')) {
+      int num_threads = std::max(ParseInt(threads), 1);
+      Result result = Run(db, &lock_mgr, num_threads);
+      fprintf(stdout, "%8d %16.0f %12.3f %10" PRIu64 "\n", num_threads,
+              result.num_locks * 1000000.0 / result.elapsed_micros,
+              result.elapsed_micros * static_cast<double>(num_threads) /
+                  result.num_locks,
+              result.num_failed);
+    }
+  }
+
+  delete db;
+  DestroyDB(db_path, options);
+  return 0;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::TransactionLockMgrBench();
+}
+
+#endif  // !defined(GFLAGS) || defined(ROCKSDB_LITE)
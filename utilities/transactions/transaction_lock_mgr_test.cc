@@ -0,0 +1,375 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "utilities/transactions/transaction_lock_mgr.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "port/stack_trace.h"
+#include "rocksdb/utilities/transaction_db.h"
+#include "test_util/sync_point.h"
+#include "test_util/testharness.h"
+#include "test_util/testutil.h"
+#include "utilities/transactions/pessimistic_transaction_db.h"
+#include "utilities/transactions/transaction_db_mutex_impl.h"
+
+namespace rocksdb {
+
+class TransactionLockMgrTest : public testing::Test {
+ public:
+  void SetUp() override {
+    env_ = Env::Default();
+    db_dir_ = test::PerThreadDBPath("transaction_lock_mgr_test");
+    ASSERT_OK(DestroyDB(db_dir_, Options()));
+
+    Options opt;
+    opt.create_if_missing = true;
+    TransactionDBOptions txn_opt;
+    txn_opt.transaction_lock_timeout = 0;
+    ASSERT_OK(TransactionDB::Open(opt, txn_opt, db_dir_, &db_));
+
+    locker_.reset(new TransactionLockMgr(
+        db_, 16 /* default_num_stripes */, 0 /* max_num_locks */,
+        0 /* max_num_deadlocks */,
+        std::make_shared<TransactionDBMutexFactoryImpl>()));
+    locker_->AddColumnFamily(db_->DefaultColumnFamily());
+  }
+
+  void TearDown() override {
+    SyncPoint::GetInstance()->DisableProcessing();
+    SyncPoint::GetInstance()->ClearAllCallBacks();
+    locker_.reset();
+    delete db_;
+    EXPECT_OK(DestroyDB(db_dir_, Options()));
+  }
+
+  PessimisticTransaction* NewTxn(
+      const TransactionOptions& txn_opt = TransactionOptions()) {
+    Transaction* txn = db_->BeginTransaction(WriteOptions(), txn_opt);
+    return reinterpret_cast<PessimisticTransaction*>(txn);
+  }
+
+ protected:
+  Env* env_;
+  std::unique_ptr<TransactionLockMgr> locker_;
+  TransactionDB* db_;
+  std::string db_dir_;
+};
+
+TEST_F(TransactionLockMgrTest, PointLockBlockedByRangeLock) {
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn();
+
+  ASSERT_OK(locker_->TryRangeLock(txn1, 0, "b", "d", env_, true));
+  ASSERT_TRUE(locker_->TryLock(txn2, 0, "b", env_, true).IsTimedOut());
+  ASSERT_TRUE(locker_->TryLock(txn2, 0, "c", env_, false).IsTimedOut());
+  ASSERT_OK(locker_->TryLock(txn2, 0, "a", env_, true));
+  ASSERT_OK(locker_->TryLock(txn2, 0, "d", env_, true));
+  // A transaction can lock the keys in its own range.
+  ASSERT_OK(locker_->TryLock(txn1, 0, "c", env_, true));
+
+  locker_->UnLockRange(txn1, 0, "b", "d");
+  ASSERT_OK(locker_->TryLock(txn2, 0, "b", env_, true));
+  ASSERT_TRUE(locker_->TryLock(txn2, 0, "c", env_, true).IsTimedOut());
+  locker_->UnLock(txn1, 0, "c", env_);
+  ASSERT_OK(locker_->TryLock(txn2, 0, "c", env_, true));
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, RangeLockBlockedByPointLock) {
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn();
+
+  ASSERT_OK(locker_->TryLock(txn1, 0, "c", env_, true));
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, "a", "z", env_, true).IsTimedOut());
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, "a", "z", env_, false).IsTimedOut());
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "a", "c", env_, true));
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "d", "z", env_, true));
+  ASSERT_TRUE(locker_->TryLock(txn1, 0, "e", env_, false).IsTimedOut());
+
+  locker_->UnLock(txn1, 0, "c", env_);
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "c", "d", env_, true));
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, SharedRangeLocks) {
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn();
+
+  ASSERT_OK(locker_->TryRangeLock(txn1, 0, "a", "m", env_, false));
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "f", "z", env_, false));
+  ASSERT_OK(locker_->TryLock(txn2, 0, "b", env_, false));
+  ASSERT_TRUE(locker_->TryLock(txn2, 0, "b", env_, true).IsTimedOut());
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, "f", "g", env_, true).IsTimedOut());
+  // Only the part of txn2's range that txn1 does not share can be taken
+  // exclusively.
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "m", "z", env_, true));
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, RangeLockBounds) {
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn();
+
+  ASSERT_OK(locker_->TryRangeLock(txn1, 0, "b", "d", env_, true));
+  // The end of a range is exclusive.
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "d", "f", env_, true));
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "a", "b", env_, true));
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, "a", "c", env_, true).IsTimedOut());
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, "c", "c", env_, true).IsInvalidArgument());
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, "e", "a", env_, true).IsInvalidArgument());
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 1, "a", "b", env_, true).IsInvalidArgument());
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, RangeLockWaitsForPointUnlock) {
+  TransactionOptions txn_opt;
+  txn_opt.lock_timeout = 10000;
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn(txn_opt);
+
+  ASSERT_OK(locker_->TryLock(txn1, 0, "c", env_, true));
+
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"TransactionLockMgr::TryRangeLock:WaitingTxn",
+        "TransactionLockMgrTest::RangeLockWaits:UnLock"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  port::Thread t([&]() {
+    ASSERT_OK(locker_->TryRangeLock(txn2, 0, "a", "z", env_, true));
+  });
+  TEST_SYNC_POINT("TransactionLockMgrTest::RangeLockWaits:UnLock");
+  locker_->UnLock(txn1, 0, "c", env_);
+  t.join();
+
+  ASSERT_TRUE(locker_->TryLock(txn1, 0, "c", env_, true).IsTimedOut());
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, PointLockWaitsForRangeUnlock) {
+  TransactionOptions txn_opt;
+  txn_opt.lock_timeout = 10000;
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn(txn_opt);
+
+  ASSERT_OK(locker_->TryRangeLock(txn1, 0, "a", "z", env_, true));
+
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"TransactionLockMgr::AcquireWithTimeout:WaitingTxn",
+        "TransactionLockMgrTest::PointLockWaits:UnLock"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  port::Thread t(
+      [&]() { ASSERT_OK(locker_->TryLock(txn2, 0, "c", env_, true)); });
+  TEST_SYNC_POINT("TransactionLockMgrTest::PointLockWaits:UnLock");
+  locker_->UnLockRange(txn1, 0, "a", "z");
+  t.join();
+
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn1, 0, "a", "z", env_, true).IsTimedOut());
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, RangeLockDeadlock) {
+  TransactionOptions txn_opt;
+  txn_opt.lock_timeout = 10000;
+  txn_opt.deadlock_detect = true;
+  PessimisticTransaction* txn1 = NewTxn(txn_opt);
+  PessimisticTransaction* txn2 = NewTxn(txn_opt);
+
+  ASSERT_OK(locker_->TryLock(txn1, 0, "a", env_, true));
+  ASSERT_OK(locker_->TryLock(txn2, 0, "m", env_, true));
+
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"TransactionLockMgr::TryRangeLock:WaitingTxn",
+        "TransactionLockMgrTest::RangeLockDeadlock:Lock"}});
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // txn1 waits for txn2 to release "m".
+  port::Thread t([&]() {
+    ASSERT_OK(locker_->TryRangeLock(txn1, 0, "l", "n", env_, true));
+  });
+  TEST_SYNC_POINT("TransactionLockMgrTest::RangeLockDeadlock:Lock");
+  // txn2 waiting for txn1 would close the cycle.
+  Status s = locker_->TryLock(txn2, 0, "a", env_, true);
+  ASSERT_TRUE(s.IsBusy());
+  ASSERT_EQ(Status::SubCode::kDeadlock, s.subcode());
+
+  locker_->UnLock(txn2, 0, "m", env_);
+  t.join();
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, TransactionGetRangeLock) {
+  Transaction* txn1 = db_->BeginTransaction(WriteOptions());
+  Transaction* txn2 = db_->BeginTransaction(WriteOptions());
+
+  ASSERT_OK(txn1->GetRangeLock(db_->DefaultColumnFamily(), "b", "d", true));
+  ASSERT_TRUE(txn2->Put("c", "txn2").IsTimedOut());
+  ASSERT_OK(txn2->Put("d", "txn2"));
+  ASSERT_TRUE(txn1->GetRangeLock(db_->DefaultColumnFamily(), "c", "e", true)
+                  .IsTimedOut());
+  ASSERT_OK(txn1->Put("c", "txn1"));
+
+  // The range lock is held until the transaction ends.
+  txn1->SetSavePoint();
+  ASSERT_OK(txn1->RollbackToSavePoint());
+  ASSERT_TRUE(txn2->Put("b", "txn2").IsTimedOut());
+  ASSERT_OK(txn1->Commit());
+
+  ASSERT_OK(txn2->Put("b", "txn2"));
+  ASSERT_OK(txn2->Put("c", "txn2"));
+  ASSERT_OK(txn2->Commit());
+
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "c", &value));
+  ASSERT_EQ("txn2", value);
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, LockStatusDataIncludesRangeLocks) {
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn();
+
+  ASSERT_OK(locker_->TryLock(txn1, 0, "a", env_, true));
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "c", "f", env_, false));
+
+  auto data = locker_->GetLockStatusData();
+  ASSERT_EQ(2U, data.size());
+  for (const auto& it : data) {
+    ASSERT_EQ(0U, it.first);
+    const KeyLockInfo& info = it.second;
+    ASSERT_EQ(1U, info.ids.size());
+    if (info.is_range_lock) {
+      ASSERT_EQ("c", info.key);
+      ASSERT_EQ("f", info.end_key);
+      ASSERT_FALSE(info.exclusive);
+      ASSERT_EQ(txn2->GetID(), info.ids[0]);
+    } else {
+      ASSERT_EQ("a", info.key);
+      ASSERT_TRUE(info.end_key.empty());
+      ASSERT_TRUE(info.exclusive);
+      ASSERT_EQ(txn1->GetID(), info.ids[0]);
+    }
+  }
+
+  locker_->UnLockRange(txn2, 0, "c", "f");
+  data = locker_->GetLockStatusData();
+  ASSERT_EQ(1U, data.size());
+  ASSERT_FALSE(data.begin()->second.is_range_lock);
+
+  delete txn2;
+  delete txn1;
+}
+
+TEST_F(TransactionLockMgrTest, PendingRangeLock) {
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn();
+
+  // While the point locks in its range are being checked, a range lock
+  // already keeps new point locks out of the range, and is not reported yet.
+  SyncPoint::GetInstance()->SetCallBack(
+      "TransactionLockMgr::TryRangeLock:Pending", [&](void* /*arg*/) {
+        ASSERT_TRUE(locker_->TryLock(txn2, 0, "c", env_, true).IsTimedOut());
+        ASSERT_TRUE(
+            locker_->TryRangeLock(txn2, 0, "e", "g", env_, false).IsTimedOut());
+        ASSERT_OK(locker_->TryLock(txn2, 0, "x", env_, true));
+        ASSERT_EQ(1U, locker_->GetLockStatusData().size());
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(locker_->TryRangeLock(txn1, 0, "a", "m", env_, true));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(2U, locker_->GetLockStatusData().size());
+  locker_->UnLockRange(txn1, 0, "a", "m");
+
+  // A range lock that finds a point lock in its way is given up again.
+  ASSERT_OK(locker_->TryLock(txn2, 0, "d", env_, true));
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn1, 0, "a", "m", env_, true).IsTimedOut());
+  ASSERT_OK(locker_->TryLock(txn2, 0, "c", env_, true));
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, "b", "e", env_, true));
+  ASSERT_EQ(4U, locker_->GetLockStatusData().size());
+
+  delete txn2;
+  delete txn1;
+}
+
+namespace {
+std::string Key(int i) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "key%04d", i);
+  return buf;
+}
+}  // anonymous namespace
+
+TEST_F(TransactionLockMgrTest, RangeLockFindsPointLocksInItsRange) {
+  PessimisticTransaction* txn1 = NewTxn();
+  PessimisticTransaction* txn2 = NewTxn();
+
+  for (int i = 0; i < 100; i += 2) {
+    ASSERT_OK(locker_->TryLock(txn1, 0, Key(i), env_, true));
+  }
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, Key(10) + "a", Key(12), env_, true));
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, Key(11), Key(13), env_, true).IsTimedOut());
+  // Point locks taken and released after the first range lock are found too
+  locker_->UnLock(txn1, 0, Key(30), env_);
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, Key(29), Key(32), env_, true));
+  ASSERT_OK(locker_->TryLock(txn1, 0, Key(51), env_, true));
+  ASSERT_TRUE(
+      locker_->TryRangeLock(txn2, 0, Key(51), Key(52), env_, true).IsTimedOut());
+  ASSERT_OK(locker_->TryRangeLock(txn2, 0, Key(53), Key(54), env_, true));
+
+  delete txn2;
+  delete txn1;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int /*argc*/, char** /*argv*/) {
+  fprintf(stderr,
+          "SKIPPED as Transactions are not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
@@ -105,6 +105,15 @@ class WritePreparedTxnDB : public PessimisticTransactionDB {
       const std::vector<ColumnFamilyHandle*>& column_families,
       std::vector<Iterator*>* iterators) override;
 
+  // Not supported, since the shards would have to share the commit map
+  // state of one snapshot.
+  virtual Status NewShardedIterators(
+      const ReadOptions& /*options*/, ColumnFamilyHandle* /*column_family*/,
+      size_t /*num_shards*/, std::vector<Iterator*>* /*iterators*/) override {
+    return Status::NotSupported(
+        "NewShardedIterators() is not supported by WritePreparedTxnDB.");
+  }
+
   // Check whether the transaction that wrote the value with sequence number seq
   // is visible to the snapshot with sequence number snapshot_seq.
   // Returns true if commit_seq <= snapshot_seq
@@ -694,6 +694,7 @@ void WriteUnpreparedTxn::Clear() {
   if (!recovered_txn_) {
     txn_db_impl_->UnLock(this, &GetTrackedKeys());
   }
+  UnLockRanges();
   unprep_seqs_.clear();
   flushed_save_points_.reset(nullptr);
   unflushed_save_points_.reset(nullptr);